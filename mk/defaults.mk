@@ -115,3 +115,4 @@ LEGACY_LINUX ?= 0
 LEGACY_GCC ?= 0
 NO_EVENTFD ?= 0
 NO_EPOLL ?= 0
+NO_IO_URING ?= 0
@@ -176,11 +176,11 @@
             <xsl:choose>
               <xsl:when test="/config/unittest">
                 <xsl:message>UNIT</xsl:message>
-                <xsl:attribute name="Exclude">src\main.cc</xsl:attribute>
+                <xsl:attribute name="Exclude">src\main.cc;src\bench\**\*.cc</xsl:attribute>
               </xsl:when>
               <xsl:otherwise>
                 <xsl:message>NOUNIT</xsl:message>
-                <xsl:attribute name="Exclude">src\unittest\**\*.cc</xsl:attribute>
+                <xsl:attribute name="Exclude">src\unittest\**\*.cc;src\bench\**\*.cc</xsl:attribute>
               </xsl:otherwise>
             </xsl:choose>
           </ClCompile>
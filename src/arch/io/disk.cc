@@ -24,6 +24,7 @@
 #include "arch/io/disk/pool.hpp"
 #include "arch/io/disk/conflict_resolving.hpp"
 #include "arch/io/disk/stats.hpp"
+#include "arch/io/disk/uring.hpp"
 #include "arch/io/disk/accounting.hpp"
 #include "backtrace.hpp"
 #include "config/args.hpp"
@@ -50,14 +51,35 @@ public:
     linux_disk_manager_t(linux_event_queue_t *queue,
                          int batch_factor,
                          int max_concurrent_io_requests,
+                         disk_backend_t disk_backend,
                          perfmon_collection_t *stats) :
         stack_stats(stats, "stack"),
         conflict_resolver(stats),
-        accounter(batch_factor),
+        accounter(batch_factor, stats),
         backend_stats(stats, "backend", accounter.producer),
-        backend(queue, backend_stats.producer, max_concurrent_io_requests),
         outstanding_txn(0)
     {
+        switch (disk_backend) {
+        case disk_backend_t::io_uring:
+#if USE_IO_URING
+            uring_backend.init(new uring_diskmgr_t(queue, backend_stats.producer,
+                                                   max_concurrent_io_requests));
+            uring_backend->done_fun = std::bind(&stats_diskmgr_2_t::done,
+                                                &backend_stats, ph::_1);
+            break;
+#else
+            unreachable("io_uring is not supported on this platform");
+#endif
+        case disk_backend_t::blocker_pool:
+            pool_backend.init(new pool_diskmgr_t(queue, backend_stats.producer,
+                                                 max_concurrent_io_requests));
+            pool_backend->done_fun = std::bind(&stats_diskmgr_2_t::done,
+                                               &backend_stats, ph::_1);
+            break;
+        default:
+            unreachable();
+        }
+
         /* Hook up the `submit_fun`s of the parts of the IO stack that are above the
         queue. (The parts below the queue use the `passive_producer_t` interface instead
         of a callback function.) */
@@ -66,8 +88,7 @@ public:
         conflict_resolver.submit_fun = std::bind(&accounting_diskmgr_t::submit,
                                                  &accounter, ph::_1);
 
-        /* Hook up everything's `done_fun`. */
-        backend.done_fun = std::bind(&stats_diskmgr_2_t::done, &backend_stats, ph::_1);
+        /* Hook up everything's `done_fun`.  (The backend's was set above.) */
         backend_stats.done_fun = std::bind(&accounting_diskmgr_t::done, &accounter, ph::_1);
         accounter.done_fun = std::bind(&conflict_resolving_diskmgr_t::done,
                                        &conflict_resolver, ph::_1);
@@ -187,13 +208,18 @@ private:
     will tell you how many IO operations are queued. The "backend stats" will tell you
     how long the OS takes to perform the operations. Note that it's not perfect, because
     it counts operations that have been queued by the backend but not sent to the OS yet
-    as having been sent to the OS. */
+    as having been sent to the OS.
+
+    Exactly one of the backends is initialized, depending on the `disk_backend_t`. */
 
     stats_diskmgr_t stack_stats;
     conflict_resolving_diskmgr_t conflict_resolver;
     accounting_diskmgr_t accounter;
     stats_diskmgr_2_t backend_stats;
-    pool_diskmgr_t backend;
+    scoped_ptr_t<pool_diskmgr_t> pool_backend;
+#if USE_IO_URING
+    scoped_ptr_t<uring_diskmgr_t> uring_backend;
+#endif
 
 
     intptr_t outstanding_txn;
@@ -201,18 +227,41 @@ private:
     DISABLE_COPYING(linux_disk_manager_t);
 };
 
+disk_backend_t choose_disk_backend(disk_backend_t desired) {
+    if (desired == disk_backend_t::io_uring) {
+#if USE_IO_URING
+        static const bool supported = uring_diskmgr_t::is_supported();
+        if (!supported) {
+            logWRN("io_uring is not available on this system, using the thread pool "
+                   "disk backend instead.");
+            return disk_backend_t::blocker_pool;
+        }
+#else
+        logWRN("This build does not support io_uring, using the thread pool disk "
+               "backend instead.");
+        return disk_backend_t::blocker_pool;
+#endif
+    }
+    return desired;
+}
+
 io_backender_t::io_backender_t(file_direct_io_mode_t _direct_io_mode,
-                               int max_concurrent_io_requests)
+                               int max_concurrent_io_requests,
+                               disk_backend_t _disk_backend)
     : direct_io_mode(_direct_io_mode),
+      disk_backend(choose_disk_backend(_disk_backend)),
       diskmgr(new linux_disk_manager_t(&linux_thread_pool_t::get_thread()->queue,
                                        DEFAULT_IO_BATCH_FACTOR,
                                        max_concurrent_io_requests,
+                                       disk_backend,
                                        &stats)) { }
 
 io_backender_t::~io_backender_t() { }
 
 file_direct_io_mode_t io_backender_t::get_direct_io_mode() const { return direct_io_mode; }
 
+disk_backend_t io_backender_t::get_disk_backend() const { return disk_backend; }
+
 
 /* Disk file object */
 
@@ -356,6 +405,19 @@ void linux_file_t::writev_async(int64_t offset, size_t length,
 
 }
 
+void linux_file_t::datasync_async(file_account_t *account,
+                                  linux_iocallback_t *callback) {
+    rassert(diskmgr != nullptr,
+            "No diskmgr has been constructed (are we running without an event queue?)");
+    // A resize that doesn't change the size is a datasync that also keeps later
+    // operations from overtaking it.
+    diskmgr->submit_resize(fd.get(), file_size, file_size,
+                           account == DEFAULT_DISK_ACCOUNT
+                           ? default_account->get_account()
+                           : account->get_account(),
+                           callback, datasync_op::datasync_after);
+}
+
 bool linux_file_t::coop_lock_and_check() {
 #ifdef _WIN32
     // TODO WINDOWS
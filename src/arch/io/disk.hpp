@@ -29,13 +29,17 @@ public:
     // stops us from specifying this on a file-by-file basis, but right now there's no desire for
     // that.  See https://github.com/rethinkdb/rethinkdb/issues/97#issuecomment-19778177 .
     io_backender_t(file_direct_io_mode_t direct_io_mode,
-                   int max_concurrent_io_requests = DEFAULT_MAX_CONCURRENT_IO_REQUESTS);
+                   int max_concurrent_io_requests = DEFAULT_MAX_CONCURRENT_IO_REQUESTS,
+                   disk_backend_t disk_backend = disk_backend_t::blocker_pool);
     ~io_backender_t();
     linux_disk_manager_t *get_diskmgr_ptr() { return diskmgr.get(); }
     file_direct_io_mode_t get_direct_io_mode() const;
+    // The backend actually in use, which might differ from the one that was asked for.
+    disk_backend_t get_disk_backend() const;
 
 protected:
     const file_direct_io_mode_t direct_io_mode;
+    const disk_backend_t disk_backend;
     perfmon_collection_t stats;
     scoped_ptr_t<linux_disk_manager_t> diskmgr;
 
@@ -83,6 +87,8 @@ public:
     void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                       file_account_t *account, linux_iocallback_t *cb);
 
+    void datasync_async(file_account_t *account, linux_iocallback_t *cb);
+
     bool coop_lock_and_check();
 
     void *create_account(int priority, int outstanding_requests_limit);
@@ -1,6 +1,9 @@
 #include "arch/io/disk/accounting.hpp"
 
+#include <vector>
+
 #include "containers/printf_buffer.hpp"
+#include "rdb_protocol/datum.hpp"
 
 /* Each account on the `accounting_diskmgr_t` has its own
    `unlimited_fifo_queue_t` associated with it. Operations for that account
@@ -104,14 +107,178 @@ accounting_diskmgr_t::~accounting_diskmgr_t() {
 }
 
 void accounting_diskmgr_t::submit(action_t *a) {
+    account_stats.on_submit(a);
     a->account->push(a);
 }
 
 void accounting_diskmgr_t::done(accounting_payload_t *p) {
     // p really is an action_t...
     action_t *a = static_cast<action_t *>(p);
+    account_stats.on_done(a);
     a->account->get_outstanding_requests_limiter()->unlock(1);
     a->account_acq.reset();
     done_fun(static_cast<action_t *>(p));
 }
 
+struct accounting_diskmgr_stats_t::priority_stats_t {
+    priority_stats_t()
+        : read_latency(secs_to_ticks(1)),
+          write_latency(secs_to_ticks(1)),
+          queue_time(secs_to_ticks(1)),
+          queue_depth(secs_to_ticks(1), false),
+          outstanding(0) { }
+
+    perfmon_histogram_t read_latency;
+    perfmon_histogram_t write_latency;
+    perfmon_histogram_t queue_time;
+    perfmon_sampler_t queue_depth;
+    int64_t outstanding;
+};
+
+struct accounting_diskmgr_stats_t::stats_ctx_t {
+    struct priority_ctx_t {
+        int priority;
+        priority_stats_t *stats;
+        void *read_latency;
+        void *write_latency;
+        void *queue_time;
+        void *queue_depth;
+        int64_t outstanding;
+    };
+    std::vector<priority_ctx_t> priorities;
+    std::vector<slow_io_t> slow_ios;
+};
+
+const double accounting_diskmgr_stats_t::SLOW_IO_SECS = 0.1;
+const size_t accounting_diskmgr_stats_t::MAX_SLOW_IOS;
+
+accounting_diskmgr_stats_t::~accounting_diskmgr_stats_t() {
+    for (const auto &pair : priorities) {
+        delete pair.second;
+    }
+}
+
+accounting_diskmgr_stats_t::priority_stats_t *
+accounting_diskmgr_stats_t::get_priority_stats(int priority) {
+    auto it = priorities.find(priority);
+    if (it != priorities.end()) {
+        return it->second;
+    }
+    priority_stats_t *stats = new priority_stats_t();
+    spinlock_acq_t acq(&lock);
+    priorities.insert(std::make_pair(priority, stats));
+    return stats;
+}
+
+void accounting_diskmgr_stats_t::on_submit(accounting_diskmgr_action_t *action) {
+    assert_thread();
+    action->submit_time = get_ticks();
+    priority_stats_t *stats = get_priority_stats(action->account->get_priority());
+    ++stats->outstanding;
+    stats->queue_depth.record(stats->outstanding);
+}
+
+void accounting_diskmgr_stats_t::on_done(accounting_diskmgr_action_t *action) {
+    assert_thread();
+    const ticks_t now = get_ticks();
+    const int priority = action->account->get_priority();
+    priority_stats_t *stats = get_priority_stats(priority);
+    --stats->outstanding;
+
+    const double latency_secs =
+        ticks_to_secs(ticks_t{now.nanos - action->submit_time.nanos});
+    const double queue_secs =
+        ticks_to_secs(ticks_t{action->start_time.nanos - action->submit_time.nanos});
+    if (action->get_is_read()) {
+        stats->read_latency.record(latency_secs);
+    } else {
+        stats->write_latency.record(latency_secs);
+    }
+    stats->queue_time.record(queue_secs);
+
+    if (latency_secs >= SLOW_IO_SECS) {
+        spinlock_acq_t acq(&lock);
+        if (slow_ios.size() == MAX_SLOW_IOS) {
+            slow_ios.pop_front();
+        }
+        slow_ios.push_back(slow_io_t{priority,
+                                     action->get_is_read(),
+                                     action->get_offset(),
+                                     action->get_count(),
+                                     queue_secs,
+                                     latency_secs,
+                                     now});
+    }
+}
+
+void *accounting_diskmgr_stats_t::begin_stats() {
+    stats_ctx_t *ctx = new stats_ctx_t;
+    spinlock_acq_t acq(&lock);
+    for (const auto &pair : priorities) {
+        priority_stats_t *stats = pair.second;
+        ctx->priorities.push_back(stats_ctx_t::priority_ctx_t{
+            pair.first,
+            stats,
+            stats->read_latency.begin_stats(),
+            stats->write_latency.begin_stats(),
+            stats->queue_time.begin_stats(),
+            stats->queue_depth.begin_stats(),
+            0});
+    }
+    ctx->slow_ios.assign(slow_ios.begin(), slow_ios.end());
+    return ctx;
+}
+
+void accounting_diskmgr_stats_t::visit_stats(void *_ctx) {
+    stats_ctx_t *ctx = static_cast<stats_ctx_t *>(_ctx);
+    for (auto &p : ctx->priorities) {
+        p.stats->read_latency.visit_stats(p.read_latency);
+        p.stats->write_latency.visit_stats(p.write_latency);
+        p.stats->queue_time.visit_stats(p.queue_time);
+        p.stats->queue_depth.visit_stats(p.queue_depth);
+        if (get_thread_id() == home_thread()) {
+            p.outstanding = p.stats->outstanding;
+        }
+    }
+}
+
+ql::datum_t accounting_diskmgr_stats_t::end_stats(void *_ctx) {
+    scoped_ptr_t<stats_ctx_t> ctx(static_cast<stats_ctx_t *>(_ctx));
+    ql::datum_object_builder_t builder;
+    for (auto &p : ctx->priorities) {
+        ql::datum_object_builder_t priority_builder;
+        priority_builder.overwrite("read_latency",
+                                   p.stats->read_latency.end_stats(p.read_latency));
+        priority_builder.overwrite("write_latency",
+                                   p.stats->write_latency.end_stats(p.write_latency));
+        priority_builder.overwrite("queue_time",
+                                   p.stats->queue_time.end_stats(p.queue_time));
+        priority_builder.overwrite("queue_depth",
+                                   p.stats->queue_depth.end_stats(p.queue_depth));
+        priority_builder.overwrite("outstanding",
+                                   ql::datum_t(static_cast<double>(p.outstanding)));
+        builder.overwrite(strprintf("priority_%d", p.priority).c_str(),
+                          std::move(priority_builder).to_datum());
+    }
+
+    const ticks_t now = get_ticks();
+    ql::datum_array_builder_t slow_ios_builder(ql::configured_limits_t::unlimited);
+    for (const slow_io_t &slow_io : ctx->slow_ios) {
+        ql::datum_object_builder_t io_builder;
+        io_builder.overwrite("priority",
+                             ql::datum_t(static_cast<double>(slow_io.priority)));
+        io_builder.overwrite("type",
+                             ql::datum_t(slow_io.is_read ? "read" : "write"));
+        io_builder.overwrite("offset",
+                             ql::datum_t(static_cast<double>(slow_io.offset)));
+        io_builder.overwrite("size",
+                             ql::datum_t(static_cast<double>(slow_io.count)));
+        io_builder.overwrite("queue_time", ql::datum_t(slow_io.queue_secs));
+        io_builder.overwrite("latency", ql::datum_t(slow_io.latency_secs));
+        io_builder.overwrite("age",
+            ql::datum_t(ticks_to_secs(ticks_t{now.nanos - slow_io.done_time.nanos})));
+        slow_ios_builder.add(std::move(io_builder).to_datum());
+    }
+    builder.overwrite("slow_ios", std::move(slow_ios_builder).to_datum());
+    return std::move(builder).to_datum();
+}
@@ -2,8 +2,11 @@
 #ifndef ARCH_IO_DISK_ACCOUNTING_HPP_
 #define ARCH_IO_DISK_ACCOUNTING_HPP_
 
+#include <deque>
 #include <functional>
+#include <map>
 
+#include "arch/spinlock.hpp"
 #include "containers/intrusive_list.hpp"
 #include "containers/scoped.hpp"
 #include "concurrency/auto_drainer.hpp"
@@ -55,6 +58,8 @@ struct accounting_diskmgr_account_t {
     void on_semaphore_available();
     co_semaphore_t *get_outstanding_requests_limiter();
 
+    int get_priority() const { return pri; }
+
 private:
     typedef accounting_diskmgr_eager_account_t eager_account_t;
 
@@ -75,18 +80,71 @@ struct accounting_diskmgr_action_t
       public accounting_payload_t {
     accounting_diskmgr_account_t *account;
     auto_drainer_t::lock_t account_acq;
+    // When the action was submitted to the `accounting_diskmgr_t`.  The inherited
+    // `start_time` is when it left the queue for the disk.
+    ticks_t submit_time;
 };
 
 void debug_print(printf_buffer_t *buf,
                  const accounting_diskmgr_action_t &action);
 
+/* `accounting_diskmgr_stats_t` breaks the disk latency down by account, so that tail
+latency can be attributed to GC, backfills, index writes or queries.  Accounts don't
+have names, but each kind of account uses its own I/O priority (see `config/args.hpp`
+and `page_cache_t::create_cache_account()`), so the stats are grouped by priority.
+
+For every priority it reports histograms of the read and write latencies and of the
+time spent in the queue, and samples the queue depth whenever an operation arrives.
+It also keeps the most recent operations that took longer than `SLOW_IO_SECS`.  All
+the recording happens on the disk manager's thread. */
+class accounting_diskmgr_stats_t : public perfmon_t, public home_thread_mixin_t {
+public:
+    accounting_diskmgr_stats_t() { }
+    ~accounting_diskmgr_stats_t();
+
+    void on_submit(accounting_diskmgr_action_t *action);
+    void on_done(accounting_diskmgr_action_t *action);
+
+    void *begin_stats();
+    void visit_stats(void *ctx);
+    ql::datum_t end_stats(void *ctx);
+
+    static const double SLOW_IO_SECS;
+    static const size_t MAX_SLOW_IOS = 100;
+
+private:
+    struct priority_stats_t;
+    struct slow_io_t {
+        int priority;
+        bool is_read;
+        int64_t offset;
+        size_t count;
+        double queue_secs;
+        double latency_secs;
+        ticks_t done_time;
+    };
+    struct stats_ctx_t;
+
+    priority_stats_t *get_priority_stats(int priority);
+
+    // Only the home thread modifies these, and it holds `lock` while it changes the
+    // structure of `priorities` or changes `slow_ios`, so that `begin_stats()` can
+    // run on other threads.  Entries in `priorities` are never removed.
+    spinlock_t lock;
+    std::map<int, priority_stats_t *> priorities;
+    std::deque<slow_io_t> slow_ios;
+
+    DISABLE_COPYING(accounting_diskmgr_stats_t);
+};
+
 class accounting_diskmgr_t : public home_thread_mixin_t {
 public:
-    explicit accounting_diskmgr_t(int batch_factor)
+    accounting_diskmgr_t(int batch_factor, perfmon_collection_t *stats)
         : producer(&caster),
           queue(batch_factor),
           caster(&queue),
-          auto_drainer(new auto_drainer_t()) { }
+          auto_drainer(new auto_drainer_t()),
+          account_stats_membership(stats, &account_stats, "accounts") { }
 
     ~accounting_diskmgr_t();
 
@@ -112,6 +170,9 @@ private:
     casting_passive_producer_t<action_t *, accounting_payload_t *> caster;
     scoped_ptr_t<auto_drainer_t> auto_drainer;
 
+    accounting_diskmgr_stats_t account_stats;
+    perfmon_membership_t account_stats_membership;
+
     DISABLE_COPYING(accounting_diskmgr_t);
 };
 
@@ -37,13 +37,15 @@ pool_diskmgr_t::pool_diskmgr_t(linux_event_queue_t *queue,
     : queue_depth(blocker_pool_queue_depth(max_concurrent_io_requests)),
       source(_source),
       blocker_pool(max_concurrent_io_requests, queue),
-      n_pending(0) {
+      n_pending(0),
+      next_action(nullptr) {
     if (source->available->get()) { pump(); }
     source->available->set_callback(this);
 }
 
 pool_diskmgr_t::~pool_diskmgr_t() {
     assert_thread();
+    rassert(next_action == nullptr);
     source->available->unset_callback();
 }
 
@@ -218,13 +220,125 @@ void pool_diskmgr_t::on_source_availability_changed() {
     if (source->available->get()) pump();
 }
 
+// The largest request we create by merging adjacent ones.
+static const size_t max_merged_action_size = 1 * MEGABYTE;
+
+class pool_diskmgr_t::merged_action_t : public blocker_pool_t::job_t {
+public:
+    merged_action_t(pool_diskmgr_t *_parent, std::vector<action_t *> &&_actions)
+        : parent(_parent), actions(std::move(_actions)) { }
+
+    void run() {
+        size_t num_vecs = 0;
+        for (action_t *a : actions) {
+            iovec *vecs;
+            size_t vecs_len;
+            a->get_bufs(&vecs, &vecs_len);
+            num_vecs += vecs_len;
+        }
+        // `perform_read_write()` modifies the io vectors, so these are copies.
+        scoped_array_t<iovec> all_vecs(num_vecs);
+        size_t i = 0;
+        int64_t total_bytes = 0;
+        for (action_t *a : actions) {
+            iovec *vecs;
+            size_t vecs_len;
+            a->get_bufs(&vecs, &vecs_len);
+            for (size_t j = 0; j < vecs_len; ++j) {
+                all_vecs[i++] = vecs[j];
+            }
+            total_bytes += a->get_count();
+        }
+
+        // The range starts at the first action's offset.
+        const int64_t res =
+            actions.front()->perform_read_write(all_vecs.data(), all_vecs.size());
+        if (res == total_bytes) {
+            for (action_t *a : actions) {
+                a->io_result = a->get_count();
+            }
+        } else {
+            // Retry the actions one by one, so that each gets its own result.
+            for (action_t *a : actions) {
+                a->run();
+            }
+        }
+    }
+
+    void done() {
+        parent->assert_thread();
+        parent->n_pending--;
+        parent->pump();
+        for (action_t *a : actions) {
+            parent->done_fun(a);
+        }
+        delete this;
+    }
+
+private:
+    pool_diskmgr_t *parent;
+    std::vector<action_t *> actions;
+};
+
+pool_diskmgr_t::action_t *pool_diskmgr_t::pop_next_action() {
+    if (next_action != nullptr) {
+        action_t *a = next_action;
+        next_action = nullptr;
+        return a;
+    }
+    return source->pop();
+}
+
+bool pool_diskmgr_t::can_merge(const std::vector<action_t *> &group,
+                               const action_t *next) {
+    /* The conflict resolving disk manager never lets overlapping actions be
+    outstanding at the same time, so any two queued actions can be run together. We
+    only merge plain reads or writes that continue exactly where the group ends. */
+    if (!USE_WRITEV) {
+        // Without `preadv()`/`pwritev()`, actions can only have a single buffer.
+        return false;
+    }
+    const action_t *last = group.back();
+    if (next->get_is_resize()
+        || next->get_is_read() != last->get_is_read()
+        || next->fd != last->fd
+        || next->ds_op != datasync_op::no_datasyncs
+        || last->ds_op != datasync_op::no_datasyncs
+        || next->offset != last->offset + static_cast<int64_t>(last->get_count())) {
+        return false;
+    }
+    size_t total_size = next->get_count();
+    for (const action_t *a : group) {
+        total_size += a->get_count();
+    }
+    return total_size <= max_merged_action_size;
+}
+
 void pool_diskmgr_t::pump() {
     assert_thread();
-    while (source->available->get() && n_pending < queue_depth) {
-        action_t *a = source->pop();
-        a->parent = this;
+    while ((next_action != nullptr || source->available->get())
+           && n_pending < queue_depth) {
+        /* Under load, the actions that are waiting for us are often adjacent, for
+        example the blocks of a flush or a large sequential read. Running them as one
+        request saves system calls and gives the device larger requests. We only merge
+        actions that are already queued, so this never delays anything. */
+        std::vector<action_t *> group(1, pop_next_action());
+        while (!group.front()->get_is_resize() && source->available->get()) {
+            action_t *a = source->pop();
+            if (!can_merge(group, a)) {
+                next_action = a;
+                break;
+            }
+            group.push_back(a);
+        }
+
         n_pending++;
-        blocker_pool.do_job(a);
+        if (group.size() == 1) {
+            group.front()->parent = this;
+            blocker_pool.do_job(group.front());
+        } else {
+            blocker_pool.do_job(new merged_action_t(this, std::move(group)));
+        }
     }
 }
 
@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "arch/runtime/event_queue.hpp"
 #include "arch/io/blocker_pool.hpp"
@@ -23,6 +24,9 @@ struct iovec;
 class pool_diskmgr_t;
 class printf_buffer_t;
 
+// How many actions a disk manager lets run at once, given --io-threads.
+int blocker_pool_queue_depth(int max_concurrent_io_requests);
+
 /* The pool disk manager uses a thread pool in conjunction with synchronous
 (blocking) IO calls to asynchronously run IO requests. */
 
@@ -103,6 +107,7 @@ struct pool_diskmgr_action_t
 
 private:
     friend class pool_diskmgr_t;
+    friend class uring_diskmgr_t;
     pool_diskmgr_t *parent;
 
     enum action_type_t {ACTION_READ, ACTION_WRITE, ACTION_RESIZE};
@@ -151,6 +156,10 @@ public:
     ~pool_diskmgr_t();
 
 private:
+    /* Runs several queued actions that cover a contiguous range of the same file as a
+    single vectored read or write. */
+    class merged_action_t;
+
     const int queue_depth;
     passive_producer_t<action_t *> *source;
     blocker_pool_t blocker_pool;
@@ -159,6 +168,12 @@ private:
     int n_pending;
     void pump();
 
+    /* When `pump()` pops an action that can't be merged into the one before it, the
+    action waits here to be dispatched next. */
+    action_t *next_action;
+    action_t *pop_next_action();
+    static bool can_merge(const std::vector<action_t *> &group, const action_t *next);
+
     DISABLE_COPYING(pool_diskmgr_t);
 };
 
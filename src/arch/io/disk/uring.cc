@@ -0,0 +1,296 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/io/disk/uring.hpp"
+
+#if USE_IO_URING
+
+#include <limits.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "arch/io/disk.hpp"
+#include "logger.hpp"
+
+// The kernel limits the size of a ring; we don't need anything close to that.
+const unsigned URING_MAX_ENTRIES = 4096;
+
+// Number of blocker threads for the actions that we don't send through the ring.
+const int URING_FALLBACK_THREADS = 4;
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                   nullptr, 0);
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+template <class T>
+T *ring_field(void *ring, uint32_t offset) {
+    return static_cast<T *>(static_cast<void *>(static_cast<char *>(ring) + offset));
+}
+
+void *map_ring(int fd, size_t size, off_t offset) {
+    void *res = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, offset);
+    guarantee_err(res != MAP_FAILED, "Could not map io_uring ring");
+    return res;
+}
+
+}  // namespace
+
+/* A `request_t` tracks a read or write while it's in the ring.  The kernel may
+complete it partially, in which case we advance `vecs` and submit the rest. */
+struct uring_diskmgr_t::request_t {
+    explicit request_t(action_t *_action)
+        : action(_action), bytes_done(0) {
+        action->copy_vectors(&vectors);
+        vecs = vectors.data();
+        vecs_len = vectors.size();
+        total_bytes = 0;
+        for (size_t i = 0; i < vecs_len; ++i) {
+            total_bytes += vecs[i].iov_len;
+        }
+    }
+
+    action_t *action;
+    scoped_array_t<iovec> vectors;
+    iovec *vecs;
+    size_t vecs_len;
+    int64_t bytes_done;
+    int64_t total_bytes;
+
+    DISABLE_COPYING(request_t);
+};
+
+bool uring_diskmgr_t::is_supported() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = sys_io_uring_setup(1, &params);
+    if (fd < 0) {
+        return false;
+    }
+    // Registering an eventfd is newer than io_uring itself, so check it, too.
+    system_event_t event;
+    int event_fd = event.get_notify_fd();
+    int res = sys_io_uring_register(fd, IORING_REGISTER_EVENTFD, &event_fd, 1);
+    ::close(fd);
+    return res == 0;
+}
+
+uring_diskmgr_t::uring_diskmgr_t(linux_event_queue_t *_queue,
+                                 passive_producer_t<action_t *> *_source,
+                                 int max_concurrent_io_requests)
+    : queue(_queue),
+      source(_source),
+      queue_depth(std::min<int>(blocker_pool_queue_depth(max_concurrent_io_requests),
+                                URING_MAX_ENTRIES)),
+      n_pending(0),
+      ring_fd(-1),
+      n_to_submit(0),
+      fallback(_queue, &fallback_queue,
+               std::min(max_concurrent_io_requests, URING_FALLBACK_THREADS)) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd = sys_io_uring_setup(queue_depth, &params);
+    guarantee_err(ring_fd >= 0, "Could not set up io_uring");
+    sq_entries = params.sq_entries;
+    cq_entries = params.cq_entries;
+    // We never have more than `queue_depth` requests in the ring, so neither of the
+    // queues can overflow.
+    guarantee(sq_entries >= static_cast<unsigned>(queue_depth));
+    guarantee(cq_entries >= sq_entries);
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        sq_ring = map_ring(ring_fd, sq_ring_size, IORING_OFF_SQ_RING);
+        cq_ring = sq_ring;
+    } else {
+        sq_ring = map_ring(ring_fd, sq_ring_size, IORING_OFF_SQ_RING);
+        cq_ring = map_ring(ring_fd, cq_ring_size, IORING_OFF_CQ_RING);
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(map_ring(ring_fd, sqes_size, IORING_OFF_SQES));
+
+    sq_head = ring_field<unsigned>(sq_ring, params.sq_off.head);
+    sq_tail = ring_field<unsigned>(sq_ring, params.sq_off.tail);
+    sq_mask = ring_field<unsigned>(sq_ring, params.sq_off.ring_mask);
+    sq_array = ring_field<unsigned>(sq_ring, params.sq_off.array);
+    cq_head = ring_field<unsigned>(cq_ring, params.cq_off.head);
+    cq_tail = ring_field<unsigned>(cq_ring, params.cq_off.tail);
+    cq_mask = ring_field<unsigned>(cq_ring, params.cq_off.ring_mask);
+    cqes = ring_field<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+
+    int event_fd = completion_event.get_notify_fd();
+    int res = sys_io_uring_register(ring_fd, IORING_REGISTER_EVENTFD, &event_fd, 1);
+    guarantee_err(res == 0, "Could not register eventfd with io_uring");
+    queue->watch_event(&completion_event, this);
+
+    fallback.done_fun = std::bind(&uring_diskmgr_t::on_fallback_done, this, ph::_1);
+
+    if (source->available->get()) { pump(); }
+    source->available->set_callback(this);
+}
+
+uring_diskmgr_t::~uring_diskmgr_t() {
+    assert_thread();
+    rassert(n_pending == 0);
+    source->available->unset_callback();
+    queue->forget_event(&completion_event, this);
+
+    munmap(sqes, sqes_size);
+    if (cq_ring != sq_ring) {
+        munmap(cq_ring, cq_ring_size);
+    }
+    munmap(sq_ring, sq_ring_size);
+    ::close(ring_fd);
+}
+
+void uring_diskmgr_t::on_source_availability_changed() {
+    assert_thread();
+    if (source->available->get()) pump();
+}
+
+void uring_diskmgr_t::pump() {
+    assert_thread();
+    while (source->available->get() && n_pending < queue_depth) {
+        action_t *a = source->pop();
+        n_pending++;
+        if (a->type == action_t::ACTION_RESIZE
+            || a->ds_op != datasync_op::no_datasyncs) {
+            fallback_queue.push(a);
+        } else {
+            prepare_sqe(new request_t(a));
+        }
+    }
+    flush_submissions();
+}
+
+void uring_diskmgr_t::prepare_sqe(request_t *req) {
+    const unsigned tail = *sq_tail;
+    DEBUG_VAR const unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    rassert(tail - head < sq_entries);
+    const unsigned index = tail & *sq_mask;
+
+    io_uring_sqe *sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = req->action->type == action_t::ACTION_READ
+        ? IORING_OP_READV
+        : IORING_OP_WRITEV;
+    sqe->fd = req->action->fd;
+    sqe->off = req->action->offset + req->bytes_done;
+    sqe->addr = reinterpret_cast<uintptr_t>(req->vecs);
+    sqe->len = std::min<size_t>(req->vecs_len, IOV_MAX);
+    sqe->user_data = reinterpret_cast<uintptr_t>(req);
+
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++n_to_submit;
+}
+
+void uring_diskmgr_t::flush_submissions() {
+    while (n_to_submit > 0) {
+        int res = sys_io_uring_enter(ring_fd, n_to_submit, 0, 0);
+        if (res < 0) {
+            // `EAGAIN` means the kernel couldn't allocate memory for the requests
+            // right now.  We can't overflow the completion queue, so just retry.
+            guarantee_err(get_errno() == EINTR || get_errno() == EAGAIN,
+                          "io_uring_enter failed");
+            continue;
+        }
+        n_to_submit -= res;
+    }
+}
+
+void uring_diskmgr_t::on_event(DEBUG_VAR int events) {
+    assert_thread();
+    rassert(events == poll_event_in);
+    completion_event.consume_wakey_wakeys();
+    reap_completions();
+}
+
+void uring_diskmgr_t::reap_completions() {
+    std::vector<request_t *> finished;
+
+    unsigned head = *cq_head;
+    const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const io_uring_cqe *cqe = &cqes[head & *cq_mask];
+        request_t *req = reinterpret_cast<request_t *>(cqe->user_data);
+        const int res = cqe->res;
+        action_t *action = req->action;
+
+        if (res == -EINTR || res == -EAGAIN) {
+            prepare_sqe(req);
+        } else if (res < 0) {
+            action->io_result = res;
+            finished.push_back(req);
+        } else if (res == 0) {
+            // See `pool_diskmgr_t::action_t::perform_read_write` for why these get
+            // turned into ENOSPC and EINVAL respectively.
+            if (action->type == action_t::ACTION_WRITE) {
+                logERR("Failed I/O: vectored write of %" PRIi64 " bytes stopped after "
+                       "%" PRIi64 " bytes. Assuming we ran out of disk space.",
+                       req->total_bytes, req->bytes_done);
+                action->io_result = -ENOSPC;
+            } else {
+                logERR("Failed I/O: we tried to read from behind the end of the file. "
+                       "Either the file got truncated, or there is a bug in "
+                       "RethinkDB.");
+                action->io_result = -EINVAL;
+            }
+            finished.push_back(req);
+        } else {
+            req->bytes_done += res;
+            if (req->bytes_done < req->total_bytes) {
+                action_t::advance_vector(&req->vecs, &req->vecs_len, res);
+                prepare_sqe(req);
+            } else {
+                action->io_result = req->total_bytes;
+                finished.push_back(req);
+            }
+        }
+    }
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+    flush_submissions();
+
+    // Like `pool_diskmgr_t`, refill the ring before handing the results back up the
+    // stack.
+    std::vector<action_t *> actions;
+    actions.reserve(finished.size());
+    for (request_t *req : finished) {
+        actions.push_back(req->action);
+        delete req;
+    }
+    n_pending -= actions.size();
+    pump();
+    for (action_t *a : actions) {
+        done_fun(a);
+    }
+}
+
+void uring_diskmgr_t::on_fallback_done(action_t *action) {
+    assert_thread();
+    n_pending--;
+    pump();
+    done_fun(action);
+}
+
+#endif  // USE_IO_URING
@@ -0,0 +1,110 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef ARCH_IO_DISK_URING_HPP_
+#define ARCH_IO_DISK_URING_HPP_
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <functional>
+
+#include "arch/io/disk/pool.hpp"
+#include "arch/runtime/event_queue.hpp"
+#include "arch/runtime/system_event.hpp"
+#include "concurrency/queue/passive_producer.hpp"
+#include "concurrency/queue/unlimited_fifo.hpp"
+#include "containers/scoped.hpp"
+
+// io_uring needs an eventfd to signal completions through the event queue.
+#if defined(__linux__) && defined(__NR_io_uring_setup) && !defined(NO_EVENTFD) \
+    && !defined(LEGACY_LINUX) && !defined(NO_IO_URING)
+#define USE_IO_URING 1
+#else
+#define USE_IO_URING 0
+#endif
+
+#if USE_IO_URING
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/* The uring disk manager accepts the same actions as `pool_diskmgr_t`, but submits
+reads and writes to the kernel through an io_uring instance instead of running
+blocking syscalls on a thread pool.  All actions that are available from `source`
+are submitted together with a single `io_uring_enter()` call, and completions are
+reaped on the event queue thread when the ring's eventfd fires.
+
+Resizes and operations that need datasyncs are rare and are simply handed to an
+internal `pool_diskmgr_t`. */
+
+class uring_diskmgr_t :
+    private availability_callback_t,
+    private linux_event_callback_t,
+    public home_thread_mixin_debug_only_t {
+public:
+    typedef pool_diskmgr_action_t action_t;
+
+    /* Like `pool_diskmgr_t`, the `uring_diskmgr_t` draws actions from `source` and
+    calls `done_fun` on each one once it's complete. */
+    uring_diskmgr_t(linux_event_queue_t *queue, passive_producer_t<action_t *> *source,
+                    int max_concurrent_io_requests);
+    ~uring_diskmgr_t();
+
+    std::function<void(action_t *)> done_fun;
+
+    /* Returns false if the running kernel doesn't support io_uring (or we aren't
+    allowed to use it, e.g. because of a seccomp filter). */
+    static bool is_supported();
+
+private:
+    struct request_t;
+
+    void on_source_availability_changed();
+    void on_event(int events);
+    void pump();
+
+    // Puts the next chunk of `req` into a submission queue entry.
+    void prepare_sqe(request_t *req);
+    // Tells the kernel about all prepared submission queue entries.
+    void flush_submissions();
+    void reap_completions();
+    void on_fallback_done(action_t *action);
+
+    linux_event_queue_t *const queue;
+    passive_producer_t<action_t *> *const source;
+
+    const int queue_depth;
+    int n_pending;
+
+    int ring_fd;
+    unsigned sq_entries;
+    unsigned cq_entries;
+    unsigned n_to_submit;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    io_uring_cqe *cqes;
+
+    system_event_t completion_event;
+
+    unlimited_fifo_queue_t<action_t *> fallback_queue;
+    pool_diskmgr_t fallback;
+
+    DISABLE_COPYING(uring_diskmgr_t);
+};
+
+#endif  // USE_IO_URING
+
+#endif  // ARCH_IO_DISK_URING_HPP_
@@ -268,6 +268,8 @@ private:
 
     static const size_t WRITE_QUEUE_MAX_SIZE = 128 * KILOBYTE;
     static const size_t WRITE_CHUNK_SIZE = 8 * KILOBYTE;
+    // The most queued writes the write coroutine hands to a single `writev()`.
+    static const int WRITE_MAX_IOVECS = 64;
 
     /* Structs to avoid over-using dynamic allocation */
     struct write_buffer_t : public intrusive_list_node_t<write_buffer_t> {
@@ -289,6 +291,8 @@ private:
     private:
         linux_tcp_conn_t *parent;
         void coro_pool_callback(write_queue_op_t *operation, signal_t *interruptor);
+        // Releases the operation's buffer and wakes up whoever waits for it.
+        void finish_op(write_queue_op_t *operation);
     } write_handler;
 
     template <class T>
@@ -345,6 +349,14 @@ private:
     /* Used to actually perform a write. If the write end of the connection is open, then
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
+
+#ifndef _WIN32
+protected:
+    /* Like `perform_write()`, but writes the given buffers one after the other, with
+    as few system calls as possible.  At most `WRITE_MAX_IOVECS` buffers. Protected so
+    that `linux_secure_tcp_conn_t` can use it once the kernel does the encryption. */
+    virtual void perform_writev(const struct iovec *iov, int iovcnt);
+#endif
 };
 
 #ifdef ENABLE_TLS
@@ -409,6 +421,10 @@ private:
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
 
+#ifndef _WIN32
+    virtual void perform_writev(const struct iovec *iov, int iovcnt);
+#endif
+
     void shutdown();
     void shutdown_socket();
 
@@ -14,6 +14,7 @@
 #include "rethinkdb_backtrace.hpp"
 #include "containers/scoped.hpp"
 #include "logger.hpp"
+#include "random.hpp"
 
 coro_profiler_t &coro_profiler_t::get_global_profiler() {
     // Singleton implementation after Scott Meyers.
@@ -123,6 +124,16 @@ void coro_profiler_t::record_coro_resume() {
 void coro_profiler_t::record_coro_yield(size_t levels_to_strip_from_backtrace) {
     rassert(coro_t::self());
 
+    per_thread_samples_t &thread_samples =
+        per_thread_samples[get_thread_id().threadnum].value;
+    if (thread_samples.yields_until_sample > 0) {
+        --thread_samples.yields_until_sample;
+        return;
+    }
+    // Uniform in [0, 2 * interval - 2], so we skip `interval - 1` yields on average.
+    thread_samples.yields_until_sample =
+        randint(2 * CORO_PROFILER_YIELD_SAMPLE_INTERVAL - 1);
+
     record_sample(1 + levels_to_strip_from_backtrace);
 }
 
@@ -27,6 +27,15 @@
 /* How frequently should the coro profiler aggregate data and generate a report? */
 #define CORO_PROFILER_REPORTING_INTERVAL        (secs_to_ticks(1.0) * 5)
 
+/* The coro profiler takes a sample at one in this many coroutine yields on each
+ * thread, on average.  The yields in between are skipped at random, so that the
+ * samples don't line up with periodic behavior.  Taking a backtrace on every yield
+ * slows the server down so much that it distorts what is being measured; set this
+ * to 1 to get a sample at every yield anyway. */
+#ifndef CORO_PROFILER_YIELD_SAMPLE_INTERVAL
+#define CORO_PROFILER_YIELD_SAMPLE_INTERVAL     16
+#endif
+
 /* If you set CORO_PROFILER_ADDRESS_TO_LINE to 1, the coro profiler prints
  * the filename and line number of the source file in/at which a sample was recorded.
  * Unfortunately that conversion is pretty slow. */
@@ -44,7 +53,9 @@
  * Keep in mind though that backtraces can be unreliable in release.
  *
  * The coro profiler records a sample whenever it encounters a `PROFILER_RECORD_SAMPLE`
- * and also every time a coroutine yields.
+ * and also at a random one in `CORO_PROFILER_YIELD_SAMPLE_INTERVAL` coroutine yields.
+ * So the sample counts of yield points are that many times smaller than how often
+ * they were reached.
  *
  * The following data is aggregated:
  *      - How often a certain recording point has been reached within the past
@@ -101,13 +112,17 @@ private:
         std::vector<coro_sample_t> samples;
     };
     struct per_thread_samples_t {
-        per_thread_samples_t() : ticks_at_last_report(get_ticks()) { }
+        per_thread_samples_t()
+            : ticks_at_last_report(get_ticks()), yields_until_sample(0) { }
         std::map<coro_execution_point_key_t, per_execution_point_samples_t> per_execution_point_samples;
         spinlock_t spinlock;
         // This field is a duplicate of the global `ticks_at_last_report` in
         // `coro_profiler_t`. We copy it in each thread in order to avoid having
         // to lock and access the global field from different threads.
         ticks_t ticks_at_last_report;
+        // Counts down the yields to skip before the next sample.  Only used on
+        // the thread itself, so it's not protected by `spinlock`.
+        int yields_until_sample;
     };
 
     // Represents the distribution of data points as a normal distribution,
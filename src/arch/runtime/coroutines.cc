@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <functional>
 #ifndef NDEBUG
 #include <map>
@@ -19,6 +20,7 @@
 #include "debug.hpp"
 #include "do_on_thread.hpp"
 #include "logger.hpp"
+#include "memory_accounting.hpp"
 #include "perfmon/perfmon.hpp"
 #include "rethinkdb_backtrace.hpp"
 #include "thread_local.hpp"
@@ -27,10 +29,19 @@
 //Default, can be set through `set_coro_stack_size()`
 size_t coro_stack_size = COROUTINE_STACK_SIZE;
 
-// How many unused coroutine stacks to keep around (at most), before they are
+// How many unused coroutine stacks to keep around (at least), before they are
 // freed. This value is per thread.
 const size_t COROUTINE_FREE_LIST_SIZE = 64;
 
+// A thread that keeps spawning more coroutines than the free list holds gets a
+// bigger free list, up to this many.  Only the stack pages that the coroutines
+// actually touched stay resident, so a big free list costs little memory.
+const size_t COROUTINE_MAX_FREE_LIST_SIZE = 4096;
+
+// The free list's capacity is brought down to what was actually used after every
+// this many coroutines have been returned to it.
+const size_t COROUTINE_FREE_LIST_ADJUST_INTERVAL = 16384;
+
 // In debug mode, we print a warning if more than this many coroutines have been
 // allocated on one thread.
 #ifndef NDEBUG
@@ -71,6 +82,16 @@ struct coro_globals_t {
     /* A list of coro_t objects that are not in use. */
     intrusive_list_t<coro_t> free_coros;
 
+    /* How many coro_t objects `free_coros` may hold. It doubles whenever a coroutine
+    has to be allocated because `free_coros` is empty, and shrinks by how many of the
+    free coroutines went unused over the last `COROUTINE_FREE_LIST_ADJUST_INTERVAL`
+    returns, so a burst of spawns doesn't have to allocate a stack every time. */
+    size_t free_list_capacity;
+    /* The smallest size of `free_coros` since `free_list_capacity` was last
+    adjusted. */
+    size_t free_list_low_water;
+    size_t returns_since_adjustment;
+
     /* A list of coroutines that currently have protected stacks. The least recently
     used protected coroutine is always at the front of the list. */
     intrusive_list_t<coro_lru_entry_t> protected_coros_lru;
@@ -103,6 +124,9 @@ struct coro_globals_t {
     coro_globals_t()
         : current_coro(nullptr)
         , prev_coro(nullptr)
+        , free_list_capacity(COROUTINE_FREE_LIST_SIZE)
+        , free_list_low_water(0)
+        , returns_since_adjustment(0)
 #ifndef NDEBUG
         , coro_count(0)
         , printed_high_coro_count_warning(false)
@@ -167,6 +191,10 @@ coro_t::coro_t() :
     current_thread_(linux_thread_pool_t::get_thread_id()),
     notified_(false),
     waiting_(false),
+    time_accounting_(false),
+    running_nanos_(0),
+    waiting_nanos_(0),
+    last_switch_nanos_(0),
     protected_stack_lru_entry_(this)
 #ifndef NDEBUG
     , selfname_number(get_thread_id().threadnum + MAX_THREADS *
@@ -180,6 +208,8 @@ coro_t::coro_t() :
 #endif
 {
     ++pm_allocated_coroutines;
+    // This counts the whole stack, while only the pages it touched are resident.
+    add_tagged_memory(memory_tag_t::COROUTINE_STACKS, coro_stack_size);
 
 #ifndef NDEBUG
     TLS_get_cglobals()->coro_count++;
@@ -199,12 +229,19 @@ void coro_t::return_coro_to_free_list(coro_t *coro) {
     // This is important because when we call `return_coro_to_free_list` in
     // `coro_t::run`, that coroutine is still active and must not be deleted yet.
     static_assert(COROUTINE_FREE_LIST_SIZE > 0, "COROUTINE_FREE_LIST_SIZE cannot be 0");
-    if (cglobals->free_coros.size() >= COROUTINE_FREE_LIST_SIZE) {
+    if (++cglobals->returns_since_adjustment >= COROUTINE_FREE_LIST_ADJUST_INTERVAL) {
+        cglobals->free_list_capacity = std::max(
+            COROUTINE_FREE_LIST_SIZE,
+            cglobals->free_list_capacity - cglobals->free_list_low_water);
+        cglobals->free_list_low_water = cglobals->free_coros.size();
+        cglobals->returns_since_adjustment = 0;
+    }
+    while (cglobals->free_coros.size() >= cglobals->free_list_capacity) {
         coro_t *coro_to_delete = cglobals->free_coros.tail();
         cglobals->free_coros.remove(coro_to_delete);
         delete coro_to_delete;
     }
-    rassert(cglobals->free_coros.size() < COROUTINE_FREE_LIST_SIZE);
+    rassert(cglobals->free_coros.size() < cglobals->free_list_capacity);
     cglobals->free_coros.push_back(coro);
 }
 
@@ -216,6 +253,8 @@ coro_t::~coro_t() {
     TLS_get_cglobals()->coro_count--;
 #endif
     --pm_allocated_coroutines;
+    add_tagged_memory(memory_tag_t::COROUTINE_STACKS,
+                      -static_cast<int64_t>(coro_stack_size));
 }
 
 /* Helper function for switching into a new context and making sure that the new context
@@ -273,6 +312,7 @@ void coro_t::run() {
         TLS_get_cglobals()->total_coroutine_counts[coro->coroutine_type]++;
         TLS_get_cglobals()->active_coroutines.insert(coro);
 #endif
+        coro->note_switched_in();
         PROFILER_CORO_RESUME;
         coro->action_wrapper.run();
         PROFILER_CORO_YIELD(0);
@@ -361,12 +401,14 @@ void coro_t::wait() {   /* class method */
     self()->waiting_ = true;
 
     PROFILER_CORO_YIELD(1);
+    self()->note_switched_out();
     if (TLS_get_cglobals()->prev_coro) {
         TLS_get_cglobals()->prev_coro->switch_to_coro_with_protection(
             &self()->stack.context);
     } else {
         switch_to_scheduler(&self()->stack.context, &TLS_get_cglobals()->scheduler);
     }
+    self()->note_switched_in();
     PROFILER_CORO_RESUME;
 
     rassert(self());
@@ -374,6 +416,33 @@ void coro_t::wait() {   /* class method */
     self()->waiting_ = false;
 }
 
+void coro_t::enable_time_accounting() {
+    if (!time_accounting_) {
+        time_accounting_ = true;
+        running_nanos_ = 0;
+        waiting_nanos_ = 0;
+        last_switch_nanos_ = get_ticks().nanos;
+    }
+}
+
+ticks_t coro_t::get_running_time() const {
+    rassert(time_accounting_);
+    int64_t nanos = running_nanos_;
+    if (self() == this) {
+        nanos += get_ticks().nanos - last_switch_nanos_;
+    }
+    return ticks_t{nanos};
+}
+
+ticks_t coro_t::get_waiting_time() const {
+    rassert(time_accounting_);
+    int64_t nanos = waiting_nanos_;
+    if (self() != this) {
+        nanos += get_ticks().nanos - last_switch_nanos_;
+    }
+    return ticks_t{nanos};
+}
+
 void coro_t::yield() {  /* class method */
     rassert(self(), "Not in a coroutine context");
     self()->notify_sometime();
@@ -404,6 +473,7 @@ void coro_t::notify_now_deprecated() {
 
     if (coro_t::self() != nullptr) {
         PROFILER_CORO_YIELD(1);
+        coro_t::self()->note_switched_out();
     }
     coro_t *prev_prev_coro = TLS_get_cglobals()->prev_coro;
     TLS_get_cglobals()->prev_coro = TLS_get_cglobals()->current_coro;
@@ -419,6 +489,7 @@ void coro_t::notify_now_deprecated() {
     TLS_get_cglobals()->current_coro = TLS_get_cglobals()->prev_coro;
     TLS_get_cglobals()->prev_coro = prev_prev_coro;
     if (coro_t::self() != nullptr) {
+        coro_t::self()->note_switched_in();
         PROFILER_CORO_RESUME;
     }
 
@@ -518,11 +589,16 @@ coro_t * coro_t::get_coro() {
     rassert(coroutines_have_been_initialized());
     coro_t *coro;
 
-    if (TLS_get_cglobals()->free_coros.size() == 0) {
+    coro_globals_t *cglobals = TLS_get_cglobals();
+    if (cglobals->free_coros.size() == 0) {
         coro = new coro_t();
+        cglobals->free_list_capacity = std::min(
+            COROUTINE_MAX_FREE_LIST_SIZE, cglobals->free_list_capacity * 2);
     } else {
-        coro = TLS_get_cglobals()->free_coros.tail();
-        TLS_get_cglobals()->free_coros.remove(coro);
+        coro = cglobals->free_coros.tail();
+        cglobals->free_coros.remove(coro);
+        cglobals->free_list_low_water = std::min(
+            cglobals->free_list_low_water, cglobals->free_coros.size());
     }
 
     rassert(!coro->intrusive_list_node_t<coro_t>::in_a_list());
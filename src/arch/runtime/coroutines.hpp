@@ -159,6 +159,16 @@ public:
         return linux_thread_message_t::get_priority();
     }
 
+    /* Once `enable_time_accounting()` has been called on a coroutine, it keeps
+    track of how much time it has spent running and how much it has spent waiting to
+    be resumed, from then on until it finishes.  This costs two clock reads per
+    context switch, so it's off unless somebody asks for it.  The accessors include
+    the time since the coroutine was last switched in or out; they must not be called
+    after the coroutine has finished. */
+    void enable_time_accounting();
+    ticks_t get_running_time() const;
+    ticks_t get_waiting_time() const;
+
     /* Copies the backtrace from the time of spawning the coroutine into
     `buffer_out`, which has to be allocated before calling the function.
     `size` must contain the maximum number of entries to store.
@@ -192,6 +202,7 @@ private:
 #endif
         coro->grab_spawn_backtrace();
         coro->action_wrapper.reset(std::forward<callable_t>(action));
+        coro->time_accounting_ = false;
 
         // If we were called from a coroutine, the new coroutine inherits our
         // caller's priority.
@@ -205,6 +216,22 @@ private:
         return coro;
     }
 
+    // Called by the coroutine itself whenever it stops or starts running.
+    void note_switched_out() {
+        if (time_accounting_) {
+            const int64_t now = get_ticks().nanos;
+            running_nanos_ += now - last_switch_nanos_;
+            last_switch_nanos_ = now;
+        }
+    }
+    void note_switched_in() {
+        if (time_accounting_) {
+            const int64_t now = get_ticks().nanos;
+            waiting_nanos_ += now - last_switch_nanos_;
+            last_switch_nanos_ = now;
+        }
+    }
+
     static coro_t *get_coro();
 
     static void return_coro_to_free_list(coro_t *coro);
@@ -225,6 +252,12 @@ private:
     bool notified_;
     bool waiting_;
 
+    // See `enable_time_accounting()`.
+    bool time_accounting_;
+    int64_t running_nanos_;
+    int64_t waiting_nanos_;
+    int64_t last_switch_nanos_;
+
     callable_action_wrapper_t action_wrapper;
 
     /* Used to eventually unprotect the coroutine if it has been inactive for a while. */
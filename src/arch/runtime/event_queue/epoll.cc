@@ -18,6 +18,7 @@
 #include "arch/runtime/event_queue.hpp"
 #include "arch/runtime/thread_pool.hpp"
 #include "perfmon/perfmon.hpp"
+#include "time.hpp"
 
 int user_to_epoll(int mode) {
 
@@ -56,10 +57,18 @@ epoll_event_queue_t::epoll_event_queue_t(linux_queue_parent_t *_parent)
 void epoll_event_queue_t::run() {
     int res;
 
+    // While `get_ticks()` is before this, we poll without blocking.  See
+    // `EVENT_LOOP_BUSY_POLL_NSECS`.
+    ticks_t busy_poll_deadline = ticks_t{0};
+
     // Now, start the loop
     while (!parent->should_shut_down()) {
+        const bool busy_polling = EVENT_LOOP_BUSY_POLL_NSECS > 0
+            && get_ticks().nanos < busy_poll_deadline.nanos;
+
         // Grab the events from the kernel!
-        res = epoll_wait(epoll_fd, events, MAX_IO_EVENT_PROCESSING_BATCH_SIZE, -1);
+        res = epoll_wait(epoll_fd, events, MAX_IO_EVENT_PROCESSING_BATCH_SIZE,
+                         busy_polling ? 0 : -1);
 
         // epoll_wait might return with EINTR in some cases (in
         // particular under GDB), we just need to retry.
@@ -116,6 +125,10 @@ void epoll_event_queue_t::run() {
             }
         }
 
+        if (nevents > 0 && EVENT_LOOP_BUSY_POLL_NSECS > 0) {
+            busy_poll_deadline.nanos = get_ticks().nanos + EVENT_LOOP_BUSY_POLL_NSECS;
+        }
+
         nevents = 0;
 
         parent->pump();
@@ -24,6 +24,7 @@ linux_message_hub_t::linux_message_hub_t(linux_event_queue_t *queue,
     : queue_(queue),
       thread_pool_(thread_pool),
       is_woken_up_(false),
+      incoming_messages_(nullptr),
       current_thread_(current_thread) {
 
 #ifndef NDEBUG
@@ -47,7 +48,7 @@ linux_message_hub_t::~linux_message_hub_t() {
         guarantee(get_priority_msg_list(p).empty());
     }
 
-    guarantee(incoming_messages_.empty());
+    guarantee(incoming_messages_.load() == nullptr);
 }
 
 void linux_message_hub_t::do_store_message(threadnum_t nthread, linux_thread_message_t *msg) {
@@ -94,19 +95,38 @@ void linux_message_hub_t::store_message_sometime(threadnum_t nthread, linux_thre
 
 
 void linux_message_hub_t::insert_external_message(linux_thread_message_t *msg) {
-    bool do_wake_up;
-    {
-        spinlock_acq_t acq(&incoming_messages_lock_);
-        do_wake_up = !check_and_set_is_woken_up();
-        incoming_messages_.push_back(msg);
-    }
+    push_incoming_messages(msg, msg);
+}
 
-    // Wakey wakey eggs and bakey
-    if (do_wake_up) {
+void linux_message_hub_t::push_incoming_messages(linux_thread_message_t *first,
+                                                 linux_thread_message_t *last) {
+    linux_thread_message_t *top = incoming_messages_.load();
+    do {
+        last->incoming_next = top;
+    } while (!incoming_messages_.compare_exchange_weak(top, first));
+
+    // We only need to do a wake up if we're the first people to do a wake up.  The
+    // flag is checked after the push, and `pop_incoming_messages()` clears it before
+    // it takes the messages, so no message can be left without a wake up.
+    if (!check_and_set_is_woken_up()) {
+        // Wakey wakey eggs and bakey
         event_.wakey_wakey();
     }
 }
 
+void linux_message_hub_t::pop_incoming_messages(msg_list_t *messages_out) {
+    is_woken_up_.store(false);
+    linux_thread_message_t *m = incoming_messages_.exchange(nullptr);
+    // The stack is newest first, so pushing each message to the front puts them
+    // back in the order they were sent.
+    while (m != nullptr) {
+        linux_thread_message_t *next = m->incoming_next;
+        m->incoming_next = nullptr;
+        messages_out->push_front(m);
+        m = next;
+    }
+}
+
 linux_message_hub_t::msg_list_t &linux_message_hub_t::get_priority_msg_list(int priority) {
     rassert(priority >= MESSAGE_SCHEDULER_MIN_PRIORITY);
     rassert(priority <= MESSAGE_SCHEDULER_MAX_PRIORITY);
@@ -178,12 +198,7 @@ void linux_message_hub_t::on_event(int events) {
             // Place wakey_wakey and then yield to the event processing.
             // It will wake us up again immediately, but can handle a few
             // OS events (such as timers, network messages etc.) in the meantime.
-            bool do_wake_up;
-            {
-                spinlock_acq_t acq(&incoming_messages_lock_);
-                do_wake_up = !check_and_set_is_woken_up();
-            }
-            if (do_wake_up) {
+            if (!check_and_set_is_woken_up()) {
                 event_.wakey_wakey();
             }
             break;
@@ -192,18 +207,9 @@ void linux_message_hub_t::on_event(int events) {
 }
 
 void linux_message_hub_t::sort_incoming_messages_by_priority() {
-    // We do this in two steps to release the spinlock faster.
-    // append_and_clear is a very cheap operation, while
-    // assigning each message to a different priority queue
-    // is more expensive.
-
     // 1. Pull the messages
     msg_list_t new_messages;
-    {
-        spinlock_acq_t acq(&incoming_messages_lock_);
-        new_messages.append_and_clear(&incoming_messages_);
-        is_woken_up_ = false;
-    }
+    pop_incoming_messages(&new_messages);
 
     // 2. Sort the messages into their respective priority queues
     while (linux_thread_message_t *m = new_messages.head()) {
@@ -222,9 +228,7 @@ void linux_message_hub_t::sort_incoming_messages_by_priority() {
 }
 
 bool linux_message_hub_t::check_and_set_is_woken_up() {
-    const bool was_woken_up = is_woken_up_;
-    is_woken_up_ = true;
-    return was_woken_up;
+    return is_woken_up_.exchange(true);
 }
 
 // Pushes messages collected locally global lists available to all
@@ -235,24 +239,20 @@ void linux_message_hub_t::push_messages() {
         // message list.
         thread_queue_t *queue = &queues_[i];
         if (!queue->msg_local_list.empty()) {
-            // Transfer messages to the other core
-
-            bool do_wake_up;
-            {
-                spinlock_acq_t acq(&thread_pool_->threads[i]->message_hub.incoming_messages_lock_);
-
-                // We only need to do a wake up if we're the first people to do a
-                // wake up.
-                do_wake_up =
-                    !thread_pool_->threads[i]->message_hub.check_and_set_is_woken_up();
-
-                thread_pool_->threads[i]->message_hub.incoming_messages_.append_and_clear(&queue->msg_local_list);
-            }
-
-            // Wakey wakey, perhaps eggs and bakey
-            if (do_wake_up) {
-                thread_pool_->threads[i]->message_hub.event_.wakey_wakey();
+            // Transfer messages to the other core.  We link them up newest first
+            // here, so that the other thread's hub takes them with a single
+            // compare-and-swap.
+            linux_thread_message_t *first = nullptr;
+            linux_thread_message_t *last = nullptr;
+            while (linux_thread_message_t *m = queue->msg_local_list.head()) {
+                queue->msg_local_list.remove(m);
+                m->incoming_next = first;
+                first = m;
+                if (last == nullptr) {
+                    last = m;
+                }
             }
+            thread_pool_->threads[i]->message_hub.push_incoming_messages(first, last);
         }
     }
 }
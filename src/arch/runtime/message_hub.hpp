@@ -4,6 +4,8 @@
 
 #include <pthread.h>
 
+#include <atomic>
+
 #include "arch/runtime/event_queue.hpp"
 #include "arch/runtime/runtime_utils.hpp"
 #include "arch/runtime/system_event.hpp"
@@ -73,11 +75,20 @@ private:
         msg_list_t msg_local_list;
     } queues_[MAX_THREADS];
 
-    // Must only be used with acquired incoming_messages_lock_
+    // Sets `is_woken_up_` and returns whether it was already set.
     bool check_and_set_is_woken_up();
-    bool is_woken_up_;
-    msg_list_t incoming_messages_;
-    spinlock_t incoming_messages_lock_;
+    std::atomic<bool> is_woken_up_;
+
+    // Other threads push their messages onto `incoming_messages_` without taking a
+    // lock: it's a stack of the messages, newest first, linked through
+    // `linux_thread_message_t::incoming_next`.  `first` to `last` must be linked in
+    // that order already (i.e. `first` is the newest message of the chain).
+    void push_incoming_messages(linux_thread_message_t *first,
+                                linux_thread_message_t *last);
+    // Takes all of `incoming_messages_` and returns them oldest first.  Only this
+    // hub's thread pops.
+    void pop_incoming_messages(msg_list_t *messages_out);
+    std::atomic<linux_thread_message_t *> incoming_messages_;
 
     // Use `sort_incoming_messages_by_priority()` to sort incoming_messages_ into
     // these lists.
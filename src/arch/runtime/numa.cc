@@ -0,0 +1,138 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/runtime/numa.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#endif
+
+#include <map>
+#include <utility>
+
+#include "arch/runtime/runtime_utils.hpp"
+#include "errors.hpp"
+
+namespace {
+
+// Sysfs files are tiny, we don't need anything fancy to read them.
+bool read_small_file(const std::string &path, std::string *out) {
+    FILE *file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        return false;
+    }
+    char buf[4096];
+    size_t n = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+    out->assign(buf, n);
+    return true;
+}
+
+bool parse_cpu_number(const std::string &s, int *out) {
+    if (s.empty() || s.size() > 6) {
+        return false;
+    }
+    int res = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        res = res * 10 + (c - '0');
+    }
+    *out = res;
+    return true;
+}
+
+}  // namespace
+
+bool parse_cpu_list(const std::string &list, std::vector<int> *cpus_out) {
+    std::vector<int> cpus;
+    size_t end = list.find_last_not_of(" \n");
+    std::string trimmed = end == std::string::npos ? "" : list.substr(0, end + 1);
+    size_t pos = 0;
+    while (pos < trimmed.size()) {
+        size_t comma = trimmed.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = trimmed.size();
+        }
+        std::string range = trimmed.substr(pos, comma - pos);
+        size_t dash = range.find('-');
+        int first, last;
+        if (dash == std::string::npos) {
+            if (!parse_cpu_number(range, &first)) {
+                return false;
+            }
+            last = first;
+        } else if (!parse_cpu_number(range.substr(0, dash), &first)
+                   || !parse_cpu_number(range.substr(dash + 1), &last)
+                   || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        pos = comma + 1;
+    }
+    *cpus_out = std::move(cpus);
+    return true;
+}
+
+numa_topology_t::numa_topology_t(std::vector<std::vector<int> > &&node_cpus)
+    : node_cpus_(std::move(node_cpus)) {
+    guarantee(!node_cpus_.empty());
+}
+
+numa_topology_t numa_topology_t::get() {
+    // Sorted by node number, which can have gaps.
+    std::map<int, std::vector<int> > nodes;
+#ifdef __linux__
+    const std::string dir_path = "/sys/devices/system/node";
+    DIR *dir = opendir(dir_path.c_str());
+    if (dir != nullptr) {
+        while (struct dirent *entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            int node;
+            if (name.compare(0, 4, "node") != 0
+                || !parse_cpu_number(name.substr(4), &node)) {
+                continue;
+            }
+            std::string contents;
+            std::vector<int> cpus;
+            if (!read_small_file(dir_path + "/" + name + "/cpulist", &contents)
+                || !parse_cpu_list(contents, &cpus)) {
+                nodes.clear();
+                break;
+            }
+            // Memory-only nodes have no CPUs.
+            if (!cpus.empty()) {
+                nodes[node] = std::move(cpus);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::vector<std::vector<int> > node_cpus;
+    for (auto &&pair : nodes) {
+        node_cpus.push_back(std::move(pair.second));
+    }
+    if (node_cpus.empty()) {
+        std::vector<int> all_cpus;
+        for (int i = 0; i < get_cpu_count(); ++i) {
+            all_cpus.push_back(i);
+        }
+        node_cpus.push_back(std::move(all_cpus));
+    }
+    return numa_topology_t(std::move(node_cpus));
+}
+
+const std::vector<int> &numa_topology_t::cpus_of_node(int node) const {
+    guarantee(node >= 0 && node < num_nodes());
+    return node_cpus_[node];
+}
+
+int numa_topology_t::node_of_thread(int thread, int num_threads) const {
+    guarantee(thread >= 0 && thread < num_threads);
+    return static_cast<int>(static_cast<int64_t>(thread) * num_nodes() / num_threads);
+}
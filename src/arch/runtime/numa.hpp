@@ -0,0 +1,36 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef ARCH_RUNTIME_NUMA_HPP_
+#define ARCH_RUNTIME_NUMA_HPP_
+
+#include <string>
+#include <vector>
+
+/* The NUMA topology of the machine, as far as the thread pool cares about it: which
+CPUs belong to which memory node.  We read it from sysfs rather than linking against
+libnuma.  Memory placement then follows from the kernel's first-touch policy: a
+thread that stays on one node gets its cache pages and i/o buffers from that node's
+memory. */
+class numa_topology_t {
+public:
+    // Reads the topology of this machine.  If we can't tell, or on non-Linux systems,
+    // all CPUs end up in a single node.
+    static numa_topology_t get();
+
+    explicit numa_topology_t(std::vector<std::vector<int> > &&node_cpus);
+
+    int num_nodes() const { return static_cast<int>(node_cpus_.size()); }
+    const std::vector<int> &cpus_of_node(int node) const;
+
+    // Spreads `num_threads` threads over the nodes in contiguous blocks, so that
+    // neighbouring thread numbers share a node.  Returns the node of `thread`.
+    int node_of_thread(int thread, int num_threads) const;
+
+private:
+    std::vector<std::vector<int> > node_cpus_;
+};
+
+/* Parses a Linux cpu list such as "0-3,8,10-11\n".  Returns false if the list is
+malformed. */
+bool parse_cpu_list(const std::string &list, std::vector<int> *cpus_out);
+
+#endif  // ARCH_RUNTIME_NUMA_HPP_
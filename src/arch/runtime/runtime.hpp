@@ -11,6 +11,9 @@ threadnum_t get_thread_id();
 
 int get_num_threads();
 
+// The NUMA node the given thread runs on.  0 for everything on non-NUMA machines.
+int get_thread_numa_node(threadnum_t thread);
+
 #ifndef NDEBUG
 bool in_thread_pool();
 void assert_good_thread_id(threadnum_t thread);
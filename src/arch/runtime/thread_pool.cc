@@ -15,6 +15,7 @@
 #include "arch/os_signal.hpp"
 #include "arch/io/timer_provider.hpp"
 #include "arch/runtime/event_queue.hpp"
+#include "arch/runtime/numa.hpp"
 #include "arch/runtime/runtime.hpp"
 #include "arch/timing.hpp"
 #include "errors.hpp"
@@ -69,11 +70,16 @@ linux_thread_pool_t::linux_thread_pool_t(int worker_threads, bool _do_set_affini
       interrupt_message(nullptr),
       generic_blocker_pool(nullptr),
       n_threads(worker_threads + 1),    // we create an extra utility thread
-      do_set_affinity(_do_set_affinity)
+      do_set_affinity(_do_set_affinity),
+      num_numa_nodes(1)
 {
     rassert(n_threads > 1);             // we want at least one non-utility thread
     rassert(n_threads <= MAX_THREADS);
 
+    for (int i = 0; i < n_threads; ++i) {
+        numa_nodes[i] = 0;
+    }
+
     int res;
 
     res = pthread_cond_init(&shutdown_cond, nullptr);
@@ -215,6 +221,12 @@ void linux_thread_pool_t::run_thread_pool(linux_thread_message_t *initial_messag
     // Start child threads
     thread_barrier_t barrier(n_threads + 1);
 
+    const numa_topology_t numa_topology = numa_topology_t::get();
+    num_numa_nodes = numa_topology.num_nodes();
+    for (int i = 0; i < n_threads - 1; ++i) {
+        numa_nodes[i] = numa_topology.node_of_thread(i, n_threads - 1);
+    }
+
     for (int i = 0; i < n_threads; i++) {
         bool is_utility_thread = (i == n_threads - 1);
         thread_data_t *tdata = new thread_data_t();
@@ -238,6 +250,24 @@ void linux_thread_pool_t::run_thread_pool(linux_thread_message_t *initial_messag
             CPU_SET(i % ncpus, &mask);
             res = pthread_setaffinity_np(pthreads[i], sizeof(cpu_set_t), &mask);
             guarantee_xerr(res == 0, res, "Could not set thread affinity");
+#endif
+        } else if (num_numa_nodes > 1 && !is_utility_thread) {
+#ifdef _GNU_SOURCE
+            // Let the thread move between the CPUs of its node, but not off it.
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            for (int cpu : numa_topology.cpus_of_node(numa_nodes[i])) {
+                if (cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &mask);
+                }
+            }
+            res = pthread_setaffinity_np(pthreads[i], sizeof(cpu_set_t), &mask);
+            if (res != 0) {
+                // We might be restricted to a subset of the CPUs by a cpuset.  That's
+                // fine, we just don't get the NUMA locality.
+                logWRN("Could not bind thread %d to NUMA node %d: %s", i,
+                       numa_nodes[i], errno_string(res).c_str());
+            }
 #endif
         }
     }
@@ -103,6 +103,13 @@ public:
     int n_threads;
     bool do_set_affinity;
 
+    // The NUMA node that each thread runs on.  On machines with more than one node,
+    // the db threads are bound to the CPUs of their node, so that the memory they
+    // touch first (their cache pages and i/o buffers) stays local.  The utility
+    // thread floats.
+    int numa_nodes[MAX_THREADS];
+    int num_numa_nodes;
+
 #ifdef _WIN32
     static linux_thread_pool_t *get_global_thread_pool();
 #endif
@@ -7,13 +7,13 @@
 #include "time.hpp"
 #include "utils.hpp"
 
-class timer_token_t : public intrusive_priority_queue_node_t<timer_token_t> {
+class timer_token_t : public intrusive_list_node_t<timer_token_t> {
     friend class timer_handler_t;
 
 private:
-    timer_token_t() : interval_nanos(-1), next_time_in_nanos(-1), callback(nullptr) { }
-
-    friend bool left_is_higher_priority(const timer_token_t *left, const timer_token_t *right);
+    timer_token_t()
+        : interval_nanos(-1), next_time_in_nanos(-1), callback(nullptr),
+          level(-1), slot(nullptr) { }
 
     // The time between rings, if a repeating timer, otherwise zero.
     int64_t interval_nanos;
@@ -24,51 +24,198 @@ private:
     // The callback we call upon each 'ring'.
     timer_callback_t *callback;
 
+    // The wheel level and slot that the token is in.  While `on_oneshot()` goes
+    // through a slot, `slot` is its local list and `level` is -1.
+    int level;
+    intrusive_list_t<timer_token_t> *slot;
+
     DISABLE_COPYING(timer_token_t);
 };
 
-bool left_is_higher_priority(const timer_token_t *left, const timer_token_t *right) {
-    return left->next_time_in_nanos < right->next_time_in_nanos;
-}
-
 timer_handler_t::timer_handler_t(linux_event_queue_t *queue)
     : timer_provider(queue),
-      expected_oneshot_time_in_nanos(0) {
+      expected_oneshot_time_in_nanos(0),
+      scheduled_oneshot_in_nanos(-1),
+      wheel_time(get_ticks().nanos >> WHEEL_TICK_SHIFT) {
     // Right now, we have no tokens.  So we don't ask the timer provider to do anything for us.
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        tokens_per_level[level] = 0;
+    }
 }
 
 timer_handler_t::~timer_handler_t() {
-    guarantee(token_queue.empty());
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        guarantee(tokens_per_level[level] == 0);
+    }
 }
 
-void timer_handler_t::on_oneshot() {
-    // If the timer_provider tends to return its callback a touch early, we don't want to make a
-    // bunch of calls to it, returning a tad early over and over again, leading up to a ticks
-    // threshold.  So we bump the real time up to the threshold when processing the priority queue.
-    int64_t real_ticks = get_ticks().nanos;
-    int64_t ticks = std::max(real_ticks, expected_oneshot_time_in_nanos);
+void timer_handler_t::insert_token(timer_token_t *token) {
+    // A timer that is already due goes into the current slot.
+    int64_t time = std::max(token->next_time_in_nanos >> WHEEL_TICK_SHIFT, wheel_time);
+    int level = 0;
+    while ((time - wheel_time) >> (WHEEL_SLOT_BITS * (level + 1)) != 0) {
+        if (level == WHEEL_LEVELS - 1) {
+            // The timer is further out than the whole wheel reaches, so it goes into
+            // the furthest slot, and gets put back when that's cascaded.
+            time = wheel_time + (int64_t(1) << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1;
+            break;
+        }
+        ++level;
+    }
+    token->level = level;
+    token->slot =
+        &wheel[level][(time >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1)];
+    token->slot->push_back(token);
+    ++tokens_per_level[level];
+}
 
-    while (!token_queue.empty() && token_queue.peek()->next_time_in_nanos <= ticks) {
-        timer_token_t *token = token_queue.pop();
+void timer_handler_t::remove_token(timer_token_t *token) {
+    token->slot->remove(token);
+    if (token->level != -1) {
+        --tokens_per_level[token->level];
+    }
+    token->level = -1;
+    token->slot = nullptr;
+}
+
+void timer_handler_t::cascade(int level) {
+    intrusive_list_t<timer_token_t> *slot =
+        &wheel[level][(wheel_time >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1)];
+    while (timer_token_t *token = slot->head()) {
+        remove_token(token);
+        insert_token(token);
+    }
+}
+
+void timer_handler_t::ring_current_slot(int64_t now_nanos) {
+    // The callbacks can add and cancel timers, including the ones in this slot, so
+    // we first move the slot into a local list and take the tokens off it one by one.
+    intrusive_list_t<timer_token_t> ringing;
+    {
+        intrusive_list_t<timer_token_t> *slot = &wheel[0][wheel_time & (WHEEL_SLOTS - 1)];
+        while (timer_token_t *token = slot->head()) {
+            remove_token(token);
+            ringing.push_back(token);
+            token->slot = &ringing;
+        }
+    }
+    while (timer_token_t *token = ringing.head()) {
+        remove_token(token);
+        if (token->next_time_in_nanos > now_nanos) {
+            insert_token(token);
+            continue;
+        }
 
-        // Put the repeating timer back on the queue before the callback can be called (so that it
-        // may be canceled).
-        if (token->interval_nanos != 0) {
+        // Put the repeating timer back on the wheel before the callback can be called
+        // (so that it may be canceled).
+        const bool repeating = token->interval_nanos != 0;
+        const int64_t real_ticks = get_ticks().nanos;
+        if (repeating) {
             token->next_time_in_nanos = real_ticks + token->interval_nanos;
-            token_queue.push(token);
+            insert_token(token);
         }
 
         token->callback->on_timer(ticks_t{real_ticks});
 
         // Delete nonrepeating timer tokens.
-        if (token->interval_nanos == 0) {
+        if (!repeating) {
             delete token;
         }
     }
+}
+
+void timer_handler_t::on_oneshot() {
+    scheduled_oneshot_in_nanos = -1;
+
+    // If the timer_provider tends to return its callback a touch early, we don't want to make a
+    // bunch of calls to it, returning a tad early over and over again, leading up to a ticks
+    // threshold.  So we bump the real time up to the threshold when processing the wheel.
+    const int64_t real_ticks = get_ticks().nanos;
+    const int64_t ticks = std::max(real_ticks, expected_oneshot_time_in_nanos);
+    const int64_t now = ticks >> WHEEL_TICK_SHIFT;
+
+    for (;;) {
+        ring_current_slot(ticks);
+        if (wheel_time >= now) {
+            break;
+        }
+
+        // Move on to the next slot.  If the lowest levels are empty, we jump right to
+        // the next slot of the lowest level that has timers, since there is nothing to
+        // cascade or ring in between.
+        int lowest_level = 0;
+        while (lowest_level < WHEEL_LEVELS && tokens_per_level[lowest_level] == 0) {
+            ++lowest_level;
+        }
+        if (lowest_level == WHEEL_LEVELS) {
+            wheel_time = now;
+            break;
+        } else if (lowest_level == 0) {
+            ++wheel_time;
+        } else {
+            const int shift = WHEEL_SLOT_BITS * lowest_level;
+            wheel_time = std::min(now, ((wheel_time >> shift) + 1) << shift);
+        }
+
+        for (int level = WHEEL_LEVELS - 1; level > 0; --level) {
+            const int64_t mask = (int64_t(1) << (WHEEL_SLOT_BITS * level)) - 1;
+            if ((wheel_time & mask) == 0) {
+                cascade(level);
+            }
+        }
+    }
 
     // We've processed young tokens.  Now schedule a new one-shot (if necessary).
-    if (!token_queue.empty()) {
-        timer_provider.schedule_oneshot(token_queue.peek()->next_time_in_nanos, this);
+    reschedule_oneshot();
+}
+
+int64_t timer_handler_t::next_wakeup_in_nanos() const {
+    int64_t soonest = INT64_MAX;
+    for (int64_t i = 0; i < WHEEL_SLOTS && tokens_per_level[0] != 0; ++i) {
+        const intrusive_list_t<timer_token_t> &slot =
+            wheel[0][(wheel_time + i) & (WHEEL_SLOTS - 1)];
+        if (!slot.empty()) {
+            // All of level 0 is within the next `WHEEL_SLOTS` slots, so the first
+            // slot with timers has the soonest one.
+            for (timer_token_t *token = slot.head();
+                 token != nullptr;
+                 token = slot.next(token)) {
+                soonest = std::min(soonest, token->next_time_in_nanos);
+            }
+            break;
+        }
+    }
+    // The timers on higher levels don't have to ring before their slot is cascaded,
+    // but that can come before the soonest timer of a lower level.
+    for (int level = 1; level < WHEEL_LEVELS; ++level) {
+        if (tokens_per_level[level] == 0) {
+            continue;
+        }
+        const int shift = WHEEL_SLOT_BITS * level;
+        // The current slot of this level was cascaded already, so anything in it
+        // belongs to the next time around, which is why we go all the way to
+        // `WHEEL_SLOTS`.
+        for (int64_t i = 1; i <= WHEEL_SLOTS; ++i) {
+            const int64_t slot_time = (wheel_time >> shift) + i;
+            if (!wheel[level][slot_time & (WHEEL_SLOTS - 1)].empty()) {
+                soonest = std::min(soonest, (slot_time << shift) << WHEEL_TICK_SHIFT);
+                break;
+            }
+        }
+    }
+    return soonest == INT64_MAX ? -1 : soonest;
+}
+
+void timer_handler_t::reschedule_oneshot() {
+    const int64_t next_wakeup = next_wakeup_in_nanos();
+    if (next_wakeup == -1) {
+        if (scheduled_oneshot_in_nanos != -1) {
+            timer_provider.unschedule_oneshot();
+            scheduled_oneshot_in_nanos = -1;
+        }
+    } else if (next_wakeup != scheduled_oneshot_in_nanos) {
+        timer_provider.schedule_oneshot(next_wakeup, this);
+        scheduled_oneshot_in_nanos = next_wakeup;
     }
 }
 
@@ -82,23 +229,28 @@ timer_token_t *timer_handler_t::add_timer_internal(
     token->interval_nanos = interval_ms * MILLION;
     token->next_time_in_nanos = next_time.nanos;
     token->callback = callback;
+    insert_token(token);
 
-    const timer_token_t *top_entry = token_queue.peek();
-    token_queue.push(token);
-
-    if (top_entry == nullptr || next_time.nanos < top_entry->next_time_in_nanos) {
+    if (scheduled_oneshot_in_nanos == -1
+        || next_time.nanos < scheduled_oneshot_in_nanos) {
         timer_provider.schedule_oneshot(next_time.nanos, this);
+        scheduled_oneshot_in_nanos = next_time.nanos;
     }
 
     return token;
 }
 
 void timer_handler_t::cancel_timer(timer_token_t *token) {
-    token_queue.remove(token);
+    remove_token(token);
     delete token;
 
-    if (token_queue.empty()) {
+    bool empty = true;
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        empty = empty && tokens_per_level[level] == 0;
+    }
+    if (empty && scheduled_oneshot_in_nanos != -1) {
         timer_provider.unschedule_oneshot();
+        scheduled_oneshot_in_nanos = -1;
     }
 }
 
@@ -3,7 +3,7 @@
 #define ARCH_TIMER_HPP_
 
 #include "arch/io/timer_provider.hpp"
-#include "containers/intrusive_priority_queue.hpp"
+#include "containers/intrusive_list.hpp"
 #include "time.hpp"
 
 class timer_token_t;
@@ -18,7 +18,16 @@ struct timer_callback_t {
 /* This timer class uses the underlying OS timer provider to get one-shot timing
  * events. It then manages a list of application timers based on that lower level
  * interface. Everyone who needs a timer should use this class (through the thread
- * pool). */
+ * pool).
+ *
+ * The application timers are kept in a hierarchical timing wheel, so that adding
+ * and canceling a timer takes constant time no matter how many there are.  (Most
+ * timers, like query timeouts, get canceled long before they ring.)  Level 0 has one
+ * slot per `1 << WHEEL_TICK_SHIFT` nanoseconds (about a millisecond); each slot of
+ * level `l` covers all the slots of level `l - 1`.  A timer goes into the lowest
+ * level whose range reaches its ring time, and moves down a level whenever the
+ * wheel gets to the start of its slot.  The timers in a slot keep their exact ring
+ * times, so they still ring no earlier than they are due. */
 class timer_handler_t : private timer_provider_callback_t {
 public:
     explicit timer_handler_t(linux_event_queue_t *queue);
@@ -30,8 +39,26 @@ public:
     void cancel_timer(timer_token_t *timer);
 
 private:
+    static const int WHEEL_TICK_SHIFT = 20;
+    static const int WHEEL_LEVELS = 4;
+    static const int WHEEL_SLOT_BITS = 6;
+    static const int64_t WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
+
     void on_oneshot();
 
+    // Puts `token` into the slot for its ring time.
+    void insert_token(timer_token_t *token);
+    void remove_token(timer_token_t *token);
+    // Moves the timers of the current slot of `level` down to the lower levels.
+    void cascade(int level);
+    // Rings the timers of level 0's current slot that are due at `now_nanos`.
+    void ring_current_slot(int64_t now_nanos);
+    // Returns the soonest time that a timer may have to ring, or -1 if there are no
+    // timers.  This is the start of a slot if the soonest timers are on a higher
+    // level, so that they can be cascaded in time.
+    int64_t next_wakeup_in_nanos() const;
+    void reschedule_oneshot();
+
     // The timer provider, a platform-dependent typedef for interfacing with the OS.
     timer_provider_t timer_provider;
 
@@ -39,8 +66,15 @@ private:
     // than this time, we pretend that it had arrived on time.
     int64_t expected_oneshot_time_in_nanos;
 
-    // A priority queue of timer tokens, ordered by the soonest.
-    intrusive_priority_queue_t<timer_token_t> token_queue;
+    // The oneshot that we asked the timer provider for, or -1.
+    int64_t scheduled_oneshot_in_nanos;
+
+    // The level 0 slot (in units of `1 << WHEEL_TICK_SHIFT` nanoseconds) that the wheel
+    // is at.  All the slots before it have been rung.
+    int64_t wheel_time;
+
+    intrusive_list_t<timer_token_t> wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+    size_t tokens_per_level[WHEEL_LEVELS];
 
     DISABLE_COPYING(timer_handler_t);
 };
@@ -105,6 +105,13 @@ enum class file_direct_io_mode_t {
     buffered_desired
 };
 
+// Which disk manager runs I/O requests: blocking syscalls on a thread pool, or
+// io_uring (Linux only; falls back to the thread pool if the kernel lacks support).
+enum class disk_backend_t {
+    blocker_pool,
+    io_uring
+};
+
 enum class datasync_op { no_datasyncs, wrap_in_datasyncs, datasync_after };
 
 // A linux file.  It expects reads and writes and buffers to have an
@@ -126,6 +133,8 @@ public:
     // writev_async doesn't provide the atomicity guarantees of writev.
     virtual void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                               file_account_t *account, linux_iocallback_t *cb) = 0;
+    // Makes the writes that have completed so far durable.
+    virtual void datasync_async(file_account_t *account, linux_iocallback_t *cb) = 0;
 
     virtual void *create_account(int priority, int outstanding_requests_limit) = 0;
     virtual void destroy_account(void *account) = 0;
@@ -0,0 +1,105 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "bench/bench.hpp"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "arch/runtime/coroutines.hpp"
+#include "utils.hpp"
+
+namespace bench {
+
+state_t::state_t(int64_t iterations)
+    : iterations_(iterations),
+      started_(get_ticks()),
+      elapsed_nanos_(0),
+      paused_(false) { }
+
+void state_t::pause_timing() {
+    guarantee(!paused_);
+    elapsed_nanos_ += get_ticks().nanos - started_.nanos;
+    paused_ = true;
+}
+
+void state_t::resume_timing() {
+    guarantee(paused_);
+    started_ = get_ticks();
+    paused_ = false;
+}
+
+int64_t state_t::finish() {
+    if (!paused_) {
+        pause_timing();
+    }
+    return elapsed_nanos_;
+}
+
+struct benchmark_t {
+    std::string name;
+    benchmark_fn_t fn;
+};
+
+// A function-local static, so that it's constructed before the first registration no
+// matter in which order the static initializers run.
+static std::vector<benchmark_t> *benchmarks() {
+    static std::vector<benchmark_t> all;
+    return &all;
+}
+
+int register_benchmark(const char *group, const char *name, benchmark_fn_t fn) {
+    benchmarks()->push_back(
+        benchmark_t{strprintf("%s.%s", group, name), std::move(fn)});
+    return 0;
+}
+
+void do_not_optimize(UNUSED const void *value) { }
+
+static const int64_t max_iterations = 1000000000;
+
+void run_benchmarks(const std::string &filter, double min_secs) {
+    std::vector<benchmark_t> selected;
+    for (const benchmark_t &b : *benchmarks()) {
+        if (b.name.find(filter) != std::string::npos) {
+            selected.push_back(b);
+        }
+    }
+    std::sort(selected.begin(), selected.end(),
+              [](const benchmark_t &a, const benchmark_t &b) { return a.name < b.name; });
+
+    const int64_t min_nanos = static_cast<int64_t>(min_secs * BILLION);
+    for (const benchmark_t &b : selected) {
+        // Start with a single iteration and grow the count until a run takes long
+        // enough, aiming a bit above `min_nanos` so that we usually need one more run.
+        int64_t iterations = 1;
+        int64_t elapsed_nanos;
+        for (;;) {
+            state_t state(iterations);
+            b.fn(&state);
+            elapsed_nanos = state.finish();
+            if (elapsed_nanos >= min_nanos || iterations >= max_iterations) {
+                break;
+            }
+            double factor = elapsed_nanos <= 0
+                ? 100.0
+                : 1.2 * min_nanos / elapsed_nanos;
+            factor = std::min(100.0, std::max(2.0, factor));
+            iterations = std::min(max_iterations,
+                                  static_cast<int64_t>(iterations * factor));
+            // Don't let a benchmark's leftovers affect the next run.
+            coro_t::yield();
+        }
+
+        printf("{\"benchmark\":\"%s\",\"version\":\"%s\",\"iterations\":%" PRIi64
+               ",\"ns_per_op\":%.3f}\n",
+               b.name.c_str(),
+               RETHINKDB_VERSION,
+               iterations,
+               static_cast<double>(elapsed_nanos) / iterations);
+        fflush(stdout);
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,63 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef BENCH_BENCH_HPP_
+#define BENCH_BENCH_HPP_
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+
+#include "errors.hpp"
+#include "time.hpp"
+
+namespace bench {
+
+/* Passed to every benchmark.  A benchmark runs the operation it measures
+`iterations()` times; the harness picks the count so that a run takes long enough to
+time reliably.  Setup that shouldn't be measured goes between `pause_timing()` and
+`resume_timing()`. */
+class state_t {
+public:
+    explicit state_t(int64_t iterations);
+
+    int64_t iterations() const { return iterations_; }
+
+    void pause_timing();
+    void resume_timing();
+
+    // The time spent between construction and `finish()`, except for pauses.
+    int64_t finish();
+
+private:
+    const int64_t iterations_;
+    ticks_t started_;
+    int64_t elapsed_nanos_;
+    bool paused_;
+
+    DISABLE_COPYING(state_t);
+};
+
+typedef std::function<void(state_t *)> benchmark_fn_t;
+
+// Returns a dummy value, so that registration can happen in a static initializer.
+int register_benchmark(const char *group, const char *name, benchmark_fn_t fn);
+
+/* Runs every benchmark whose `group.name` contains `filter` and prints one JSON
+object per line to stdout.  Has to be called from within a thread pool with at least
+two threads, for the cross-thread benchmarks. */
+void run_benchmarks(const std::string &filter, double min_secs);
+
+// Keeps the compiler from optimizing away the computation of the pointee.  It's
+// defined in a separate translation unit, so the compiler can't see that it doesn't do
+// anything.
+void do_not_optimize(const void *value);
+
+}  // namespace bench
+
+#define BENCHMARK(group, name)                                                   \
+    void bench_##group##_##name(::bench::state_t *state);                       \
+    UNUSED static const int bench_##group##_##name##_registered =               \
+        ::bench::register_benchmark(#group, #name, &bench_##group##_##name);    \
+    void bench_##group##_##name(::bench::state_t *state)
+
+#endif  // BENCH_BENCH_HPP_
@@ -0,0 +1,89 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bench/bench.hpp"
+#include "containers/archive/string_stream.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
+
+namespace bench {
+
+// A row that looks like something a user might store.
+static ql::datum_t make_row(int i) {
+    std::vector<ql::datum_t> tags;
+    for (int j = 0; j < 5; ++j) {
+        tags.push_back(ql::datum_t(datum_string_t(strprintf("tag%d", j))));
+    }
+    std::map<datum_string_t, ql::datum_t> address;
+    address[datum_string_t("city")] = ql::datum_t(datum_string_t("Mountain View"));
+    address[datum_string_t("zip")] = ql::datum_t(94040.0);
+    std::map<datum_string_t, ql::datum_t> row;
+    row[datum_string_t("id")] =
+        ql::datum_t(datum_string_t(strprintf("%08x-4b1c-9d2e-%012x", i, i * 7)));
+    row[datum_string_t("name")] = ql::datum_t(datum_string_t("Jane Doe"));
+    row[datum_string_t("score")] = ql::datum_t(i * 1.5);
+    row[datum_string_t("active")] = ql::datum_t::boolean(i % 2 == 0);
+    row[datum_string_t("tags")] =
+        ql::datum_t(std::move(tags), ql::configured_limits_t::unlimited);
+    row[datum_string_t("address")] = ql::datum_t(std::move(address));
+    return ql::datum_t(std::move(row));
+}
+
+static std::string serialize_row(const ql::datum_t &row) {
+    string_stream_t stream;
+    write_message_t wm;
+    ql::datum_serialize(&wm, row, ql::check_datum_serialization_errors_t::NO);
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    return std::move(stream.str());
+}
+
+BENCHMARK(Datum, Serialize) {
+    state->pause_timing();
+    ql::datum_t row = make_row(1);
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        std::string serialized = serialize_row(row);
+        do_not_optimize(&serialized);
+    }
+}
+
+BENCHMARK(Datum, Deserialize) {
+    state->pause_timing();
+    std::string serialized = serialize_row(make_row(1));
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        state->pause_timing();
+        std::string copy = serialized;
+        state->resume_timing();
+        string_read_stream_t stream(std::move(copy), 0);
+        ql::datum_t row;
+        archive_result_t res = ql::datum_deserialize(&stream, &row);
+        guarantee_deserialization(res, "benchmark row");
+        do_not_optimize(&row);
+    }
+}
+
+// Encodes a batch of rows the way the JSON protocol encodes a response.
+BENCHMARK(Datum, WriteJsonBatch) {
+    state->pause_timing();
+    std::vector<ql::datum_t> rows;
+    for (int i = 0; i < 100; ++i) {
+        rows.push_back(make_row(i));
+    }
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartArray();
+        for (const ql::datum_t &row : rows) {
+            row.write_json(&writer);
+        }
+        writer.EndArray();
+        do_not_optimize(buffer.GetString());
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,88 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <inttypes.h>
+
+#include <vector>
+
+#include "bench/bench.hpp"
+#include "btree/leaf_node.hpp"
+#include "btree/node.hpp"
+#include "containers/scoped.hpp"
+#include "repli_timestamp.hpp"
+#include "unittest/btree_utils.hpp"
+
+namespace bench {
+
+class bench_leaf_t {
+public:
+    bench_leaf_t()
+        : sizer(max_block_size_t::unsafe_make(4096)),
+          node(sizer.block_size().value()),
+          tstamp(repli_timestamp_t::distant_past) {
+        leaf::init(&sizer, node.get());
+    }
+
+    // Returns false if the node is full.
+    bool insert(const store_key_t &key, short_value_buffer_t *value) {
+        if (leaf::is_full(&sizer, node.get(), key.btree_key(), value->data())) {
+            return false;
+        }
+        repli_timestamp_t next = tstamp.next();
+        leaf::insert(&sizer, node.get(), key.btree_key(), value->data(), next, tstamp,
+                     key_modification_proof_t::real_proof());
+        tstamp = next;
+        return true;
+    }
+
+    short_value_sizer_t sizer;
+    scoped_malloc_t<leaf_node_t> node;
+    repli_timestamp_t tstamp;
+
+    DISABLE_COPYING(bench_leaf_t);
+};
+
+// Keys in no particular order, like the generated ids of a table.
+static std::vector<store_key_t> make_keys(size_t count) {
+    std::vector<store_key_t> keys;
+    keys.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        keys.emplace_back(strprintf("%016" PRIx64, i * UINT64_C(0x9e3779b97f4a7c15)));
+    }
+    return keys;
+}
+
+BENCHMARK(LeafNode, Insert) {
+    state->pause_timing();
+    std::vector<store_key_t> keys = make_keys(1000);
+    short_value_buffer_t value(std::string(32, 'v'));
+    scoped_ptr_t<bench_leaf_t> leaf = make_scoped<bench_leaf_t>();
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        const store_key_t &key = keys[i % keys.size()];
+        if (!leaf->insert(key, &value)) {
+            state->pause_timing();
+            leaf = make_scoped<bench_leaf_t>();
+            state->resume_timing();
+            leaf->insert(key, &value);
+        }
+    }
+}
+
+BENCHMARK(LeafNode, Lookup) {
+    state->pause_timing();
+    std::vector<store_key_t> keys = make_keys(1000);
+    short_value_buffer_t value(std::string(32, 'v'));
+    bench_leaf_t leaf;
+    size_t num_keys = 0;
+    while (num_keys < keys.size() && leaf.insert(keys[num_keys], &value)) {
+        ++num_keys;
+    }
+    char value_out[256];
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        bool found = leaf::lookup(&leaf.sizer, leaf.node.get(),
+                                  keys[i % num_keys].btree_key(), value_out);
+        do_not_optimize(&found);
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,48 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "arch/runtime/starter.hpp"
+#include "bench/bench.hpp"
+#include "extproc/extproc_spawner.hpp"
+#include "utils.hpp"
+
+/* Microbenchmarks for the storage engine and the runtime.  Usage:
+
+    rethinkdb-bench [--filter <substring>] [--min-time <seconds>]
+
+Prints one JSON object per benchmark and line, so that the results can be collected
+and compared across releases. */
+
+int main(int argc, char **argv) {
+
+#ifdef _WIN32
+    extproc_maybe_run_worker(argc, argv);
+#endif
+
+    std::string filter;
+    double min_secs = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_secs = atof(argv[++i]);
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--filter <substring>] [--min-time <seconds>]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    startup_shutdown_t startup_shutdown;
+
+    run_in_thread_pool([&]() {
+        bench::run_benchmarks(filter, min_secs);
+    }, 2);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string.h>
+
+#include <vector>
+
+#include "bench/bench.hpp"
+#include "buffer_cache/alt.hpp"
+#include "buffer_cache/cache_balancer.hpp"
+#include "serializer/log/log_serializer.hpp"
+#include "unittest/mock_file.hpp"
+
+namespace bench {
+
+// A cache on top of an in-memory file, with `num_blocks` blocks in it.
+class bench_cache_t {
+public:
+    explicit bench_cache_t(int num_blocks)
+        : balancer(GIGABYTE) {
+        log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+        serializer.init(new log_serializer_t(
+            log_serializer_t::dynamic_config_t(),
+            &file_opener,
+            &get_global_perfmon_collection()));
+        cache.init(new cache_t(serializer.get(), &balancer,
+                               &get_global_perfmon_collection(),
+                               which_cpu_shard_t{0, 1}));
+        conn.init(new cache_conn_t(cache.get()));
+
+        txn_t txn(conn.get(), write_durability_t::SOFT, num_blocks);
+        for (int i = 0; i < num_blocks; ++i) {
+            buf_lock_t lock(buf_parent_t(&txn), alt_create_t::create);
+            buf_write_t write(&lock);
+            memset(write.get_data_write(), i, cache->max_block_size().value());
+            block_ids.push_back(lock.block_id());
+        }
+        txn.commit();
+    }
+
+    unittest::mock_file_opener_t file_opener;
+    scoped_ptr_t<log_serializer_t> serializer;
+    dummy_cache_balancer_t balancer;
+    scoped_ptr_t<cache_t> cache;
+    scoped_ptr_t<cache_conn_t> conn;
+    std::vector<block_id_t> block_ids;
+
+    DISABLE_COPYING(bench_cache_t);
+};
+
+BENCHMARK(PageCache, AcquireForRead) {
+    state->pause_timing();
+    bench_cache_t bc(64);
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        txn_t txn(bc.conn.get(), read_access_t::read);
+        buf_lock_t lock(buf_parent_t(&txn), bc.block_ids[i % bc.block_ids.size()],
+                        access_t::read);
+        buf_read_t read(&lock);
+        do_not_optimize(read.get_data_read());
+    }
+    state->pause_timing();
+}
+
+BENCHMARK(PageCache, AcquireForWrite) {
+    state->pause_timing();
+    bench_cache_t bc(64);
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        txn_t txn(bc.conn.get(), write_durability_t::SOFT, 1);
+        buf_lock_t lock(buf_parent_t(&txn), bc.block_ids[i % bc.block_ids.size()],
+                        access_t::write);
+        buf_write_t write(&lock);
+        static_cast<char *>(write.get_data_write())[0] = static_cast<char>(i);
+    }
+    // Flushing the soft durability writes isn't part of the measurement.
+    state->pause_timing();
+}
+
+}  // namespace bench
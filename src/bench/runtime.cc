@@ -0,0 +1,35 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/runtime/coroutines.hpp"
+#include "arch/runtime/runtime.hpp"
+#include "bench/bench.hpp"
+#include "threading.hpp"
+
+namespace bench {
+
+// Spawns a coroutine that runs to completion right away, so this measures taking a
+// coroutine from the pool and switching into and out of it.
+BENCHMARK(Coroutines, SpawnNow) {
+    int64_t count = 0;
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        coro_t::spawn_now_dangerously([&count]() { ++count; });
+    }
+    do_not_optimize(&count);
+}
+
+// A round trip through the thread's message queue, with two context switches.
+BENCHMARK(Coroutines, Yield) {
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        coro_t::yield();
+    }
+}
+
+// Moves the coroutine to another thread and back, which is what `on_thread_t` costs
+// in the cross-thread parts of the query and storage paths.
+BENCHMARK(Threads, OnThreadRoundTrip) {
+    const threadnum_t other((get_thread_id().threadnum + 1) % get_num_threads());
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        on_thread_t thread_switcher(other);
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,79 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <vector>
+
+#include "bench/bench.hpp"
+#include "containers/archive/buffer_stream.hpp"
+#include "containers/archive/varint.hpp"
+#include "utils.hpp"
+
+namespace bench {
+
+static const int varints_per_batch = 1000;
+
+// Mostly string lengths and element counts, which are small.
+static std::vector<uint64_t> make_values(uint64_t max) {
+    std::vector<uint64_t> values;
+    for (int i = 0; i < varints_per_batch; ++i) {
+        values.push_back((static_cast<uint64_t>(i) * 2654435761u) % max);
+    }
+    return values;
+}
+
+static std::vector<char> encode_values(const std::vector<uint64_t> &values) {
+    std::vector<char> encoded;
+    for (uint64_t value : values) {
+        uint8_t buf[16];
+        size_t size = serialize_varint_uint64_into_buf(value, buf);
+        encoded.insert(encoded.end(), buf, buf + size);
+    }
+    return encoded;
+}
+
+static void encode_batch(state_t *state, uint64_t max) {
+    state->pause_timing();
+    std::vector<uint64_t> values = make_values(max);
+    std::vector<uint8_t> out(values.size() * 10);
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        uint8_t *p = out.data();
+        for (uint64_t value : values) {
+            p += serialize_varint_uint64_into_buf(value, p);
+        }
+        do_not_optimize(out.data());
+    }
+}
+
+static void decode_batch(state_t *state, uint64_t max) {
+    state->pause_timing();
+    std::vector<char> encoded = encode_values(make_values(max));
+    state->resume_timing();
+    for (int64_t i = 0; i < state->iterations(); ++i) {
+        buffer_read_stream_t stream(encoded.data(), encoded.size());
+        uint64_t sum = 0;
+        for (int j = 0; j < varints_per_batch; ++j) {
+            uint64_t value;
+            archive_result_t res = deserialize_varint_uint64(&stream, &value);
+            guarantee_deserialization(res, "benchmark varint");
+            sum += value;
+        }
+        do_not_optimize(&sum);
+    }
+}
+
+BENCHMARK(Varint, EncodeSmall) {
+    encode_batch(state, 128);
+}
+
+BENCHMARK(Varint, EncodeMedium) {
+    encode_batch(state, 1 << 20);
+}
+
+BENCHMARK(Varint, DecodeSmall) {
+    decode_batch(state, 128);
+}
+
+BENCHMARK(Varint, DecodeMedium) {
+    decode_batch(state, 1 << 20);
+}
+
+}  // namespace bench
@@ -0,0 +1,188 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "btree/bulk_load.hpp"
+
+#include "btree/internal_node.hpp"
+#include "btree/leaf_node.hpp"
+#include "btree/node.hpp"
+#include "btree/operations.hpp"
+
+btree_bulk_appender_t::btree_bulk_appender_t(value_sizer_t *sizer,
+                                             superblock_t *superblock,
+                                             repli_timestamp_t tstamp)
+    : sizer_(sizer), superblock_(superblock), tstamp_(tstamp),
+      has_last_key_(false), num_appended_(0) {
+    right_edge_.push_back(get_root(sizer_, superblock_));
+    for (;;) {
+        buf_lock_t *buf = &right_edge_.back();
+        block_id_t child_id;
+        {
+            buf_read_t read(buf);
+            const node_t *node = static_cast<const node_t *>(read.get_data_read());
+            if (node::is_leaf(node)) {
+                leaf::visit_entries(
+                    sizer_, reinterpret_cast<const leaf_node_t *>(node),
+                    buf->get_recency(),
+                    [&](const btree_key_t *key, UNUSED repli_timestamp_t tstamp,
+                        UNUSED const void *value) {
+                        if (!has_last_key_
+                            || btree_key_cmp(key, last_key_.btree_key()) > 0) {
+                            last_key_.assign(key);
+                            has_last_key_ = true;
+                        }
+                        return continue_bool_t::CONTINUE;
+                    });
+                break;
+            }
+            const internal_node_t *internal =
+                reinterpret_cast<const internal_node_t *>(node);
+            child_id = internal_node::get_pair_by_index(
+                internal, internal->npairs - 1)->lnode;
+        }
+        // Same as in `find_keyvalue_location_for_write()`: every node's recency must be
+        // at least that of anything below it.
+        buf->set_recency(superceding_recency(buf->get_recency(), tstamp_));
+        right_edge_.push_back(buf_lock_t(buf, child_id, access_t::write));
+    }
+}
+
+btree_bulk_appender_t::~btree_bulk_appender_t() {
+    const block_id_t stat_block_id = superblock_->get_stat_block_id();
+    if (num_appended_ == 0 || stat_block_id == NULL_BLOCK_ID) {
+        return;
+    }
+    // See `apply_keyvalue_change()` for why the stat block's parent is the txn.
+    buf_lock_t stat_block(buf_parent_t(right_edge_.back().txn()),
+                          stat_block_id, access_t::write);
+    buf_write_t stat_block_write(&stat_block);
+    auto stat_block_buf = static_cast<btree_statblock_t *>(
+        stat_block_write.get_data_write(BTREE_STATBLOCK_SIZE));
+    stat_block_buf->population += num_appended_;
+}
+
+void btree_bulk_appender_t::append(const btree_key_t *key, const void *value) {
+    append(key, value, tstamp_);
+}
+
+void btree_bulk_appender_t::append(const btree_key_t *key,
+                                   const void *value,
+                                   repli_timestamp_t tstamp) {
+    // The nodes on the right edge got `tstamp_` as their recency.
+    rassert(tstamp <= tstamp_);
+    guarantee(!has_last_key_ || btree_key_cmp(key, last_key_.btree_key()) > 0,
+              "btree_bulk_appender_t got its keys out of order");
+
+    bool full;
+    {
+        buf_read_t read(&right_edge_.back());
+        full = leaf::is_full(
+            sizer_, static_cast<const leaf_node_t *>(read.get_data_read()), key, value);
+    }
+    if (full) {
+        rassert(has_last_key_);
+        store_key_t separator;
+        leaf::shortest_separator(last_key_.btree_key(), key, separator.writable_btree_key());
+        add_right_sibling(0, separator.btree_key());
+    }
+
+    buf_lock_t *leaf_buf = &right_edge_.back();
+    const repli_timestamp_t previous_leaf_recency = leaf_buf->get_recency();
+    leaf_buf->set_recency(superceding_recency(tstamp, previous_leaf_recency));
+    {
+        buf_write_t write(leaf_buf);
+        leaf::insert(sizer_, static_cast<leaf_node_t *>(write.get_data_write()),
+                     key, value, tstamp, previous_leaf_recency,
+                     key_modification_proof_t::real_proof());
+    }
+
+    last_key_.assign(key);
+    has_last_key_ = true;
+    ++num_appended_;
+}
+
+bool btree_bulk_appender_t::can_append(const btree_key_t *key) const {
+    if (has_last_key_) {
+        return btree_key_cmp(key, last_key_.btree_key()) > 0;
+    }
+    // An empty last leaf only tells us something if it's the root.  Otherwise the
+    // leaves to its left could have larger keys than `key`.
+    return right_edge_.size() == 1;
+}
+
+buf_parent_t btree_bulk_appender_t::last_leaf() {
+    return buf_parent_t(&right_edge_.back());
+}
+
+buf_lock_t *btree_bulk_appender_t::right_edge_at(int level) {
+    rassert(level >= 0 && static_cast<size_t>(level) < right_edge_.size());
+    return &right_edge_[right_edge_.size() - 1 - level];
+}
+
+void btree_bulk_appender_t::add_right_sibling(int level, const btree_key_t *key) {
+    if (static_cast<size_t>(level) == right_edge_.size() - 1) {
+        // We're at the root, so the btree gets a new root above it, like in
+        // `check_and_handle_split()`.
+        buf_lock_t *old_root = right_edge_at(level);
+        superblock_->expose_buf().detach_child(old_root->block_id());
+        buf_lock_t new_root(superblock_->expose_buf(), alt_create_t::create);
+        {
+            buf_write_t write(&new_root);
+            internal_node::init(
+                sizer_->block_size(),
+                static_cast<internal_node_t *>(write.get_data_write()));
+        }
+        new_root.set_recency(old_root->get_recency());
+        insert_root(new_root.block_id(), superblock_);
+        right_edge_.push_front(std::move(new_root));
+    } else {
+        buf_lock_t *parent = right_edge_at(level + 1);
+        bool parent_full;
+        {
+            buf_read_t read(parent);
+            parent_full = internal_node::is_full(
+                static_cast<const internal_node_t *>(read.get_data_read()));
+        }
+        if (parent_full) {
+            // A new parent with just the new node as its child would be an internal
+            // node with a single child.  So the node at `level` moves to the new
+            // parent too, and the parent's second to last key separates the two
+            // parents.
+            store_key_t parent_key;
+            {
+                buf_write_t write(parent);
+                auto node = static_cast<internal_node_t *>(write.get_data_write());
+                rassert(node->npairs >= 2);
+                parent_key.assign(
+                    &internal_node::get_pair_by_index(node, node->npairs - 2)->key);
+                // `key` sorts after every key in the node, so this removes the last
+                // child.
+                internal_node::remove(sizer_->block_size(), node, key);
+            }
+            parent->detach_child(right_edge_at(level)->block_id());
+            add_right_sibling(level + 1, parent_key.btree_key());
+        }
+    }
+
+    buf_lock_t *buf = right_edge_at(level);
+    buf_lock_t *parent = right_edge_at(level + 1);
+    buf_lock_t sibling(parent, alt_create_t::create);
+    {
+        buf_write_t write(&sibling);
+        if (level == 0) {
+            leaf::init(sizer_, static_cast<leaf_node_t *>(write.get_data_write()));
+        } else {
+            internal_node::init(
+                sizer_->block_size(),
+                static_cast<internal_node_t *>(write.get_data_write()));
+        }
+    }
+    sibling.set_recency(buf->get_recency());
+    {
+        // If `parent` is new, this gives it its first two children.
+        buf_write_t write(parent);
+        DEBUG_VAR bool success = internal_node::insert(
+            static_cast<internal_node_t *>(write.get_data_write()),
+            key, buf->block_id(), sibling.block_id());
+        rassert(success, "could not insert internal btree node");
+    }
+    *buf = std::move(sibling);
+}
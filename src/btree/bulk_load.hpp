@@ -0,0 +1,85 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef BTREE_BULK_LOAD_HPP_
+#define BTREE_BULK_LOAD_HPP_
+
+#include <deque>
+
+#include "btree/keys.hpp"
+#include "buffer_cache/alt.hpp"
+#include "repli_timestamp.hpp"
+
+class superblock_t;
+class value_sizer_t;
+
+/* `btree_bulk_appender_t` adds key/value pairs that arrive in ascending order, and
+that all come after the largest key in the btree, without going through
+`find_keyvalue_location_for_write()` for each one.  It keeps the right edge of the
+btree (the last child of every node from the root down to the last leaf) locked for
+write, and appends to the last leaf until it's full.  Then it starts a new leaf to its
+right, instead of splitting the full one in half, so the leaves that it fills stay
+full and each one gets written once.  Internal nodes on the right edge fill up the same
+way.
+
+The btree is valid after every call to `append()`, so a long load can be broken into
+one appender per transaction.  The last leaf and its ancestors on the right edge can be
+less than half full when the appender is destroyed; the usual merging and leveling
+takes care of them if they ever get in the way.
+
+Values are copied into the leaves as they are.  If a value refers to blocks of its own
+(like a blob), the caller must already have made them part of the transaction.  The
+appender holds on to `superblock` for its whole lifetime, because it may have to give
+the btree a new root. */
+class btree_bulk_appender_t {
+public:
+    btree_bulk_appender_t(value_sizer_t *sizer,
+                          superblock_t *superblock,
+                          repli_timestamp_t tstamp);
+    // Updates the population in the stat block, if the superblock has one.
+    ~btree_bulk_appender_t();
+
+    // `key` must be larger than any key that has been appended before, and than any
+    // key (or deletion entry) that was in the btree's last leaf.
+    void append(const btree_key_t *key, const void *value);
+    // Like the above, but gives the entry its own timestamp, which must not be later
+    // than the one that the appender was constructed with.
+    void append(const btree_key_t *key, const void *value, repli_timestamp_t tstamp);
+
+    // True if `key` sorts after every key and deletion entry in the btree, so that
+    // it's safe to `append()` it.  Unlike the precondition of `append()`, this
+    // doesn't assume anything about the btree.
+    bool can_append(const btree_key_t *key) const;
+
+    // The leaf that the next `append()` goes to, unless it's full.  Blocks that a
+    // value refers to can be created as children of it, just like blocks that get
+    // created for a value in a leaf that's later split.
+    buf_parent_t last_leaf();
+
+    int64_t num_appended() const { return num_appended_; }
+
+private:
+    // Level 0 is the last leaf; the highest level is the root.
+    buf_lock_t *right_edge_at(int level);
+    // Makes an empty node right of the node at `level` of the right edge, with `key`
+    // separating them, and replaces the node on the right edge with it.  This never
+    // leaves an internal node with a single child behind, because an internal node
+    // only ever gets added to the right edge just before its first two children.
+    void add_right_sibling(int level, const btree_key_t *key);
+
+    value_sizer_t *const sizer_;
+    superblock_t *const superblock_;
+    const repli_timestamp_t tstamp_;
+
+    // The root comes first.  This is a deque so that pushing a new root to the front
+    // leaves the other locks where they are.
+    std::deque<buf_lock_t> right_edge_;
+
+    // The largest key in the last leaf, if it has any.
+    store_key_t last_key_;
+    bool has_last_key_;
+
+    int64_t num_appended_;
+
+    DISABLE_COPYING(btree_bulk_appender_t);
+};
+
+#endif  // BTREE_BULK_LOAD_HPP_
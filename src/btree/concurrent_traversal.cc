@@ -33,6 +33,7 @@ static const int initial_semaphore_capacity = 3;
 static const int min_semaphore_capacity = 2;
 static const int max_semaphore_capacity = 30;
 static const int yield_interval = 100;
+static const size_t max_read_ahead_children = 4;
 }  // namespace concurrent_traversal
 
 class concurrent_traversal_adapter_t : public depth_first_traversal_callback_t {
@@ -55,6 +56,15 @@ public:
         return continue_bool_t::CONTINUE;
     }
 
+    size_t read_ahead_limit() {
+        return cb_->read_ahead_ok() ? concurrent_traversal::max_read_ahead_children : 0;
+    }
+
+    bool skip_read_ahead(const btree_key_t *left_excl_or_null,
+                         const btree_key_t *right_incl) {
+        return cb_->skip_read_ahead(left_excl_or_null, right_incl);
+    }
+
     void handle_pair_coro(scoped_key_value_t *fragile_keyvalue,
                           semaphore_acq_t *fragile_acq,
                           fifo_enforcer_write_token_t token,
@@ -82,6 +92,13 @@ public:
     }
 
     virtual continue_bool_t handle_pair(scoped_key_value_t &&keyvalue, signal_t *) {
+        bool skip;
+        cb_->filter_key(keyvalue.key(), &skip);
+        if (skip) {
+            return failure_cond_->is_pulsed()
+                ? continue_bool_t::ABORT : continue_bool_t::CONTINUE;
+        }
+
         // First thing first: Get in line with the token enforcer.
 
         fifo_enforcer_write_token_t token = source_.enter_write();
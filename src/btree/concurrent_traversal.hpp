@@ -44,6 +44,25 @@ public:
         *skip_out = false;
     }
 
+    /* Called for every key/value pair before `handle_pair()`. If it sets `*skip_out`
+    to `true`, the traversal moves on to the next pair without calling `handle_pair()`
+    for it, which is a lot cheaper than returning from `handle_pair()` right away. */
+    virtual void filter_key(UNUSED const btree_key_t *key, bool *skip_out) {
+        *skip_out = false;
+    }
+
+    /* Whether the traversal should load blocks ahead of the scan (see
+    `depth_first_traversal_callback_t::read_ahead_limit()`).  You might not want that
+    if `filter_range()` skips most of the btree, unless `skip_read_ahead()` skips the
+    same ranges. */
+    virtual bool read_ahead_ok() { return true; }
+
+    /* See `depth_first_traversal_callback_t::skip_read_ahead()`. */
+    virtual bool skip_read_ahead(UNUSED const btree_key_t *left_excl_or_null,
+                                 UNUSED const btree_key_t *right_incl) {
+        return false;
+    }
+
     // Passes a keyvalue and a callback.  waiter.wait_interruptible() must be called to
     // begin the region of "exclusive access", which only handle_pair implementation
     // can enters at a time.  (This should happen after loading the value from disk
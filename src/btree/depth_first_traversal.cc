@@ -1,8 +1,15 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "btree/depth_first_traversal.hpp"
 
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <utility>
+
+#include "arch/runtime/coroutines.hpp"
 #include "btree/internal_node.hpp"
 #include "btree/operations.hpp"
+#include "concurrency/auto_drainer.hpp"
 #include "concurrency/interruptor.hpp"
 #include "rdb_protocol/profile.hpp"
 
@@ -35,6 +42,16 @@ void scoped_key_value_t::reset() {
 }
 
 
+/* Loads the block of `block` into the cache, so that the traversal doesn't have to wait
+for it once it gets there. */
+void read_ahead_block(counted_t<counted_buf_lock_and_read_t> block,
+                      UNUSED auto_drainer_t::lock_t keepalive) {
+    if (!block->read.has()) {
+        block->read.init(new buf_read_t(&block->lock));
+    }
+    block->read->get_data_read();
+}
+
 /* Returns `true` if we reached the end of the subtree or range, and `false` if
 `cb->handle_value()` returned `false`. */
 continue_bool_t btree_depth_first_traversal(
@@ -163,7 +180,10 @@ continue_bool_t btree_depth_first_traversal(
     if (skip) {
         return continue_bool_t::CONTINUE;
     }
-    block->read.init(new buf_read_t(&block->lock));
+    // The block might have been loaded ahead by `read_ahead_block()`.
+    if (!block->read.has()) {
+        block->read.init(new buf_read_t(&block->lock));
+    }
     const node_t *node = static_cast<const node_t *>(block->read->get_data_read());
     if (node::is_internal(node)) {
         if (continue_bool_t::ABORT == cb->handle_pre_internal(
@@ -180,10 +200,29 @@ continue_bool_t btree_depth_first_traversal(
             r.decrement();
             end_index = internal_node::get_offset_index(inode, r.btree_key()) + 1;
         }
+        auto index_of = [&](int i) {
+            return direction == FORWARD ? start_index + i : (end_index - 1) - i;
+        };
+
+        // The children we've started to load ahead, by `i`.  `read_ahead_drainer` is
+        // destroyed first, so that the blocks have finished loading before we let go
+        // of them and of `block`.
+        std::deque<std::pair<int, counted_t<counted_buf_lock_and_read_t> > > read_ahead;
+        int read_ahead_end = 0;
+        const size_t read_ahead_limit =
+            access == access_t::read ? cb->read_ahead_limit() : 0;
+        auto_drainer_t read_ahead_drainer;
+
         for (int i = 0; i < end_index - start_index; ++i) {
-            int true_index = (direction == FORWARD ? start_index + i : (end_index - 1) - i);
+            int true_index = index_of(i);
             const btree_internal_pair *pair = internal_node::get_pair_by_index(inode, true_index);
 
+            counted_t<counted_buf_lock_and_read_t> read_ahead_lock;
+            if (!read_ahead.empty() && read_ahead.front().first == i) {
+                read_ahead_lock = std::move(read_ahead.front().second);
+                read_ahead.pop_front();
+            }
+
             // Get the child key range
             const btree_key_t *child_left_excl_or_null;
             const btree_key_t *child_right_incl;
@@ -202,10 +241,62 @@ continue_bool_t btree_depth_first_traversal(
                         cb->get_trace() != nullptr,
                         "Acquire block for read.",
                         cb->get_trace());
-                    lock = make_counted<counted_buf_lock_and_read_t>(
-                        &block->lock, pair->lnode, access);
+                    if (read_ahead_lock.has()) {
+                        lock = std::move(read_ahead_lock);
+                    } else {
+                        lock = make_counted<counted_buf_lock_and_read_t>(
+                            &block->lock, pair->lnode, access);
+                    }
                     wait_interruptible(lock->lock.read_acq_signal(), interruptor);
                 }
+
+                // Having come this far into the node, the traversal will probably
+                // go on for a while.  Start loading the next few children, more of
+                // them the further we get.
+                const int read_ahead_window =
+                    std::min<int>(read_ahead_limit, i);
+                read_ahead_end = std::max(read_ahead_end, i + 1);
+                while (read_ahead_end <= i + read_ahead_window
+                       && read_ahead_end < end_index - start_index) {
+                    const btree_key_t *ahead_left_excl_or_null;
+                    const btree_key_t *ahead_right_incl;
+                    get_child_key_range(inode, index_of(read_ahead_end),
+                                        left_excl_or_null, right_incl,
+                                        &ahead_left_excl_or_null, &ahead_right_incl);
+                    if (!cb->skip_read_ahead(ahead_left_excl_or_null,
+                                             ahead_right_incl)) {
+                        const btree_internal_pair *ahead_pair =
+                            internal_node::get_pair_by_index(
+                                inode, index_of(read_ahead_end));
+                        auto ahead_lock = make_counted<counted_buf_lock_and_read_t>(
+                            &block->lock, ahead_pair->lnode, access);
+                        coro_t::spawn_sometime(std::bind(&read_ahead_block,
+                                                         ahead_lock,
+                                                         read_ahead_drainer.lock()));
+                        read_ahead.emplace_back(read_ahead_end, std::move(ahead_lock));
+                    }
+                    ++read_ahead_end;
+                }
+
+                // Once the last child that we're going to visit is acquired, this
+                // node isn't needed anymore, so we let go of it before descending
+                // instead of after.  In a snapshotted traversal that drops the old
+                // version of the node, so writes below it that come after this
+                // point don't have to preserve the old versions of the siblings
+                // we have already visited.  The child's key range points into the
+                // node, so it gets copied first.
+                store_key_t child_left_excl_buf;
+                store_key_t child_right_incl_buf;
+                if (access == access_t::read && i + 1 == end_index - start_index) {
+                    if (child_left_excl_or_null != nullptr) {
+                        child_left_excl_buf.assign(child_left_excl_or_null);
+                        child_left_excl_or_null = child_left_excl_buf.btree_key();
+                    }
+                    child_right_incl_buf.assign(child_right_incl);
+                    child_right_incl = child_right_incl_buf.btree_key();
+                    block.reset();
+                }
+
                 if (continue_bool_t::ABORT == btree_depth_first_traversal(
                         std::move(lock), range, cb, access, direction,
                         child_left_excl_or_null, child_right_incl, interruptor)) {
@@ -126,6 +126,25 @@ public:
     resulting key ranges would be contiguous and non-overlapping, and they would together
     cover the full range of the traversal. */
 
+    /* While the traversal descends into one child of an internal node, it can
+    already load the children that come after it, so that a long scan doesn't wait for
+    one leaf after the other.  This is the maximum number of children to load ahead.
+    Within each internal node, the traversal only ramps up to it as the scan moves past
+    the node's first children, so short range reads don't load blocks they don't need.
+    Blocks are loaded ahead before `filter_range()` is called on them, so if that
+    skips a lot of ranges, you probably don't want this unless you also implement
+    `skip_read_ahead()`.  Ignored for write traversals. */
+    virtual size_t read_ahead_limit() { return 0; }
+
+    /* Called for a child's key range before loading it ahead.  If it returns `true`,
+    the child doesn't get loaded ahead.  This is only a hint, unlike `filter_range()`
+    the traversal may call it any number of times for the same range, so it must not
+    have side effects. */
+    virtual bool skip_read_ahead(UNUSED const btree_key_t *left_excl_or_null,
+                                 UNUSED const btree_key_t *right_incl) {
+        return false;
+    }
+
     virtual profile::trace_t *get_trace() THROWS_NOTHING { return nullptr; }
 protected:
     virtual ~depth_first_traversal_callback_t() { }
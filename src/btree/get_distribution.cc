@@ -2,6 +2,7 @@
 #include "btree/get_distribution.hpp"
 
 #include "btree/internal_node.hpp"
+#include "btree/operations.hpp"
 #include "btree/node.hpp"
 #include "btree/leaf_node.hpp"
 #include "btree/parallel_traversal.hpp"
@@ -98,3 +99,76 @@ void get_btree_key_distribution(superblock_t *superblock, int depth_limit,
     btree_parallel_traversal(superblock, &helper, &non_interruptor);
     *key_count_out = helper.key_count;
 }
+
+// Returns -1 if the btree has no stat block.
+static int64_t get_btree_population(superblock_t *superblock) {
+    const block_id_t stat_block_id = superblock->get_stat_block_id();
+    if (stat_block_id == NULL_BLOCK_ID) {
+        return -1;
+    }
+    buf_lock_t stat_block(buf_parent_t(superblock->expose_buf().txn()),
+                          stat_block_id, access_t::read);
+    buf_read_t read(&stat_block);
+    uint16_t sb_size;
+    const btree_statblock_t *sb_data =
+        static_cast<const btree_statblock_t *>(read.get_data_read(&sb_size));
+    guarantee(sb_size == BTREE_STATBLOCK_SIZE);
+    return sb_data->population;
+}
+
+key_distribution_cache_t::key_distribution_cache_t()
+    : has_keys_(false), depth_limit_(0), keys_population_(0), computed_at_({0}) { }
+
+void key_distribution_cache_t::get(superblock_t *superblock, int depth_limit,
+                                   int64_t *key_count_out,
+                                   std::vector<store_key_t> *keys_out) {
+    rassert(keys_out->empty(), "Why is this output parameter not an empty vector\n");
+    const int64_t population = get_btree_population(superblock);
+    const ticks_t now = get_ticks();
+    const int64_t drift = population > keys_population_
+        ? population - keys_population_
+        : keys_population_ - population;
+    const bool fresh = has_keys_
+        && population >= 0
+        && depth_limit == depth_limit_
+        && drift <= keys_population_ / MAX_POPULATION_DRIFT_DENOMINATOR
+        && now.nanos - computed_at_.nanos < secs_to_ticks(MAX_AGE_SECS).nanos;
+    if (fresh) {
+        *key_count_out = population;
+    } else {
+        // Another `get()` can run while this one waits for the traversal, so the
+        // members are only updated once it's done.
+        int64_t key_count;
+        get_btree_key_distribution(superblock, depth_limit, &key_count, keys_out);
+        has_keys_ = true;
+        depth_limit_ = depth_limit;
+        keys_population_ = key_count;
+        computed_at_ = now;
+        keys_ = *keys_out;
+        *key_count_out = key_count;
+        return;
+    }
+    *keys_out = keys_;
+}
+
+write_key_sample_t::write_key_sample_t() : writes_(0) { }
+
+void write_key_sample_t::record(const store_key_t &key) {
+    if (writes_++ % SAMPLE_INTERVAL != 0) {
+        return;
+    }
+    if (samples_.size() < MAX_SAMPLES) {
+        samples_.push_back(key);
+    } else {
+        samples_[(writes_ / SAMPLE_INTERVAL) % MAX_SAMPLES] = key;
+    }
+}
+
+void write_key_sample_t::get(const key_range_t &range,
+                             std::map<store_key_t, int64_t> *counts_out) const {
+    for (const store_key_t &key : samples_) {
+        if (range.contains_key(key)) {
+            ++(*counts_out)[key];
+        }
+    }
+}
@@ -2,10 +2,12 @@
 #ifndef BTREE_GET_DISTRIBUTION_HPP_
 #define BTREE_GET_DISTRIBUTION_HPP_
 
+#include <map>
 #include <vector>
 
 #include "btree/keys.hpp"
 #include "buffer_cache/types.hpp"
+#include "time.hpp"
 
 class superblock_t;
 
@@ -13,4 +15,64 @@ void get_btree_key_distribution(superblock_t *superblock, int depth_limit,
                                 int64_t *key_count_out,
                                 std::vector<store_key_t> *keys_out);
 
+/* The key count of a distribution comes from the stat block and is cheap to get, but
+the split points take a traversal of the top `depth_limit` levels of the btree.  The
+split points only move when nodes split or merge, so `key_distribution_cache_t` keeps
+the ones it found last and gets a new key count every time.  It traverses the btree
+again when the depth limit is different, when the population has changed by more than
+`MAX_POPULATION_DRIFT_DENOMINATOR`-th of what it was, or when the split points are
+older than `MAX_AGE_SECS`, so that a table that changes in place without its population
+changing is still covered. */
+class key_distribution_cache_t {
+public:
+    key_distribution_cache_t();
+
+    // Returns the same results as `get_btree_key_distribution()`, except that the
+    // split points may be a little out of date.
+    void get(superblock_t *superblock, int depth_limit,
+             int64_t *key_count_out,
+             std::vector<store_key_t> *keys_out);
+
+    // Makes the next `get()` traverse the btree.
+    void invalidate() { has_keys_ = false; }
+
+private:
+    static const int64_t MAX_POPULATION_DRIFT_DENOMINATOR = 8;
+    static const time_t MAX_AGE_SECS = 30;
+
+    bool has_keys_;
+    int depth_limit_;
+    // The population when `keys_` were found.
+    int64_t keys_population_;
+    ticks_t computed_at_;
+    std::vector<store_key_t> keys_;
+
+    DISABLE_COPYING(key_distribution_cache_t);
+};
+
+/* `write_key_sample_t` remembers a sample of the keys that were recently written to. The
+distribution only says where the keys are; the sample says where the writes go, so that
+split points can put a hot key range (for example the end of a table with increasing
+primary keys) into a shard of its own. */
+class write_key_sample_t {
+public:
+    write_key_sample_t();
+
+    void record(const store_key_t &key);
+
+    // Adds the number of sampled writes to every sampled key in `range`.
+    void get(const key_range_t &range, std::map<store_key_t, int64_t> *counts_out) const;
+
+private:
+    // We keep one of every `SAMPLE_INTERVAL` writes, and at most `MAX_SAMPLES` of them.
+    static const uint64_t SAMPLE_INTERVAL = 16;
+    static const size_t MAX_SAMPLES = 1024;
+
+    uint64_t writes_;
+    // Once it's full, new samples overwrite the oldest ones.
+    std::vector<store_key_t> samples_;
+
+    DISABLE_COPYING(write_key_sample_t);
+};
+
 #endif /* BTREE_GET_DISTRIBUTION_HPP_ */
@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include <string>
+#include <utility>
 
 #include "arch/compiler.hpp"
 #include "config/args.hpp"
@@ -35,8 +36,16 @@ bool is_better(const T &a, const T &b, sorting_t sorting) {
     }
 }
 
-// Fast string compare
-int sized_strcmp(const uint8_t *str1, int len1, const uint8_t *str2, int len2);
+// Fast string compare.  This is inline because btree searches call it for every
+// key they probe.
+inline int sized_strcmp(const uint8_t *str1, int len1,
+                        const uint8_t *str2, int len2) {
+    int res = memcmp(str1, str2, len1 < len2 ? len1 : len2);
+    if (res == 0) {
+        res = len1 - len2;
+    }
+    return res;
+}
 
 // Note: Changing this struct changes the format of the data stored on disk.
 // If you change this struct, previous stored data will be misinterpreted.
@@ -52,43 +61,85 @@ inline int btree_key_cmp(const btree_key_t *left, const btree_key_t *right) {
     return sized_strcmp(left->contents, left->size, right->contents, right->size);
 }
 
+/* `store_key_t` is the in-memory representation of a key. Keys get copied around a lot
+(in `key_range_t`, `region_t`, range read results, changefeed stamps, backfill items,
+...), and most of them are short, so short keys are stored inline and only keys longer
+than `inline_key_size` get a separate buffer. That buffer is big enough for any key, so
+once a key has one it never needs to reallocate. */
 struct store_key_t {
 public:
-    store_key_t() {
+    store_key_t() : heap_buffer(nullptr) {
         set_size(0);
     }
 
-    store_key_t(int sz, const uint8_t *buf) {
+    store_key_t(int sz, const uint8_t *buf) : heap_buffer(nullptr) {
         assign(sz, buf);
     }
 
-    store_key_t(const store_key_t &_key) {
+    store_key_t(const store_key_t &_key) : heap_buffer(nullptr) {
         assign(_key.size(), _key.contents());
     }
 
-    explicit store_key_t(const btree_key_t *key) {
+    store_key_t(store_key_t &&movee) : heap_buffer(nullptr) {
+        *this = std::move(movee);
+    }
+
+    explicit store_key_t(const btree_key_t *key) : heap_buffer(nullptr) {
         assign(key->size, key->contents);
     }
 
-    explicit store_key_t(const std::string &s) {
+    explicit store_key_t(const std::string &s) : heap_buffer(nullptr) {
         assign(s.size(), reinterpret_cast<const uint8_t *>(s.data()));
     }
 
-    btree_key_t *btree_key() { return reinterpret_cast<btree_key_t *>(buffer); }
+    ~store_key_t() {
+        delete[] heap_buffer;
+    }
+
+    store_key_t &operator=(const store_key_t &other) {
+        if (this != &other) {
+            assign(other.size(), other.contents());
+        }
+        return *this;
+    }
+
+    store_key_t &operator=(store_key_t &&movee) {
+        if (this != &movee) {
+            if (movee.heap_buffer != nullptr && movee.size() > inline_key_size) {
+                delete[] heap_buffer;
+                heap_buffer = movee.heap_buffer;
+                movee.heap_buffer = nullptr;
+                movee.set_size(0);
+            } else {
+                assign(movee.size(), movee.contents());
+            }
+        }
+        return *this;
+    }
+
     const btree_key_t *btree_key() const {
-        return reinterpret_cast<const btree_key_t *>(buffer);
+        return reinterpret_cast<const btree_key_t *>(buffer());
+    }
+    /* For passing the key as an output parameter to functions that write a
+    `btree_key_t` of any size into it. */
+    btree_key_t *writable_btree_key() {
+        reserve(MAX_KEY_SIZE);
+        return reinterpret_cast<btree_key_t *>(buffer());
     }
+    /* Changing the size keeps the first `std::min(old_size, new_size)` bytes of the
+    contents. */
     void set_size(int s) {
         rassert(s <= MAX_KEY_SIZE);
-        btree_key()->size = s;
+        reserve(s);
+        reinterpret_cast<btree_key_t *>(buffer())->size = s;
     }
     int size() const { return btree_key()->size; }
-    uint8_t *contents() { return btree_key()->contents; }
+    uint8_t *contents() { return reinterpret_cast<btree_key_t *>(buffer())->contents; }
     const uint8_t *contents() const { return btree_key()->contents; }
 
     void assign(int sz, const uint8_t *buf) {
         set_size(sz);
-        memcpy(contents(), buf, sz);
+        memmove(contents(), buf, sz);
     }
 
     void assign(const btree_key_t *key) {
@@ -109,8 +160,8 @@ public:
 
     bool increment() {
         if (size() < MAX_KEY_SIZE) {
-            contents()[size()] = 0;
             set_size(size() + 1);
+            contents()[size() - 1] = 0;
             return true;
         }
         while (size() > 0 && contents()[size()-1] == 255) {
@@ -130,11 +181,12 @@ public:
         if (size() == 0) {
             return false;
         } else if ((reinterpret_cast<uint8_t *>(contents()))[size()-1] > 0) {
-            (reinterpret_cast<uint8_t *>(contents()))[size()-1]--;
-            for (int i = size(); i < MAX_KEY_SIZE; i++) {
+            int old_size = size();
+            set_size(MAX_KEY_SIZE);
+            (reinterpret_cast<uint8_t *>(contents()))[old_size-1]--;
+            for (int i = old_size; i < MAX_KEY_SIZE; i++) {
                 contents()[i] = 255;
             }
-            set_size(MAX_KEY_SIZE);
             return true;
         } else {
             set_size(size() - 1);
@@ -157,15 +209,17 @@ public:
         uint8_t sz;
         archive_result_t res = deserialize_universal(s, &sz);
         if (bad(res)) { return res; }
+        set_size(sz);
         int64_t num_read = force_read(s, contents(), sz);
         if (num_read == -1) {
+            set_size(0);
             return archive_result_t::SOCK_ERROR;
         }
         if (num_read < sz) {
+            set_size(0);
             return archive_result_t::SOCK_EOF;
         }
         rassert(num_read == sz);
-        set_size(sz);
         return archive_result_t::SUCCESS;
     }
 
@@ -180,7 +234,26 @@ public:
     }
 
 private:
-    char buffer[sizeof(btree_key_t) + MAX_KEY_SIZE];
+    /* Primary keys made from UUIDs take 37 bytes. */
+    static const int inline_key_size = 47;
+
+    uint8_t *buffer() {
+        return heap_buffer != nullptr ? heap_buffer : inline_buffer;
+    }
+    const uint8_t *buffer() const {
+        return heap_buffer != nullptr ? heap_buffer : inline_buffer;
+    }
+
+    void reserve(int sz) {
+        if (sz > inline_key_size && heap_buffer == nullptr) {
+            heap_buffer = new uint8_t[sizeof(btree_key_t) + MAX_KEY_SIZE];
+            memcpy(heap_buffer, inline_buffer, sizeof(inline_buffer));
+        }
+    }
+
+    /* `nullptr` unless the key has ever been longer than `inline_key_size`. */
+    uint8_t *heap_buffer;
+    uint8_t inline_buffer[sizeof(btree_key_t) + inline_key_size];
 };
 
 static const store_key_t store_key_max = store_key_t::max();
@@ -960,6 +960,27 @@ void move_elements(value_sizer_t *sizer, leaf_node_t *fro, int beg, int end,
     validate(sizer, tow);
 }
 
+// The result is a prefix of `right`, or `left` itself if no prefix of `right` is
+// shorter than `left`.  This is the "simple prefix B-tree" technique.
+void shortest_separator(const btree_key_t *left, const btree_key_t *right,
+                        btree_key_t *out) {
+    rassert(btree_key_cmp(left, right) < 0);
+    int common = 0;
+    while (common < left->size && common < right->size
+           && left->contents[common] == right->contents[common]) {
+        ++common;
+    }
+    // If `left` is a prefix of `right`, nothing shorter than `left` is >= it.
+    // Otherwise `right` has the greater byte at `common`, so its prefix of length
+    // `common + 1` is > `left`, and it is < `right` unless it's all of `right`.
+    if (common + 1 < left->size && common + 1 < right->size) {
+        out->size = common + 1;
+        memcpy(out->contents, right->contents, common + 1);
+    } else {
+        keycpy(out, left);
+    }
+}
+
 void split(value_sizer_t *sizer, leaf_node_t *node, leaf_node_t *rnode, btree_key_t *median_out) {
     int tstamp_back_offset;
     int mandatory = mandatory_cost(sizer, node, MANDATORY_TIMESTAMPS, &tstamp_back_offset);
@@ -1033,7 +1054,9 @@ void split(value_sizer_t *sizer, leaf_node_t *node, leaf_node_t *rnode, btree_ke
     move_elements(sizer, node, s, node->num_pairs, 0, rnode, node_copysize,
                   tstamp_back_offset, nullptr);
 
-    keycpy(median_out, entry_key(get_entry(node, node->pair_offsets[s - 1])));
+    shortest_separator(entry_key(get_entry(node, node->pair_offsets[s - 1])),
+                       entry_key(get_entry(rnode, rnode->pair_offsets[0])),
+                       median_out);
 }
 
 void merge(value_sizer_t *sizer, leaf_node_t *left, leaf_node_t *right) {
@@ -1180,7 +1203,17 @@ bool is_mergable(value_sizer_t *sizer, const leaf_node_t *node, const leaf_node_
 // Sets *index_out to the index for the live entry or deletion entry
 // for the key, or to the index the key would have if it were
 // inserted.  Returns true if the key at said index is actually equal.
+// The first eight bytes of a key, zero-padded, as an integer that orders like them.
+// Comparing these decides most probes of a binary search without a `memcmp` call,
+// since keys in the same node usually only share a short prefix.
+inline uint64_t key_prefix_word(const btree_key_t *key) {
+    uint64_t word = 0;
+    memcpy(&word, key->contents, std::min<size_t>(key->size, sizeof(word)));
+    return __builtin_bswap64(word);
+}
+
 bool find_key(const leaf_node_t *node, const btree_key_t *key, int *index_out) {
+    const uint64_t key_word = key_prefix_word(key);
     int beg = 0;
     int end = node->num_pairs;
 
@@ -1191,9 +1224,24 @@ bool find_key(const leaf_node_t *node, const btree_key_t *key, int *index_out) {
         // when (end - beg) > 0, (end - beg) / 2 is always less than (end - beg).  So beg <= test_point < end.
         int test_point = beg + (end - beg) / 2;
 
+        // Whichever way this probe goes, the next one is at one of these two points.
+        // Entries are scattered around the node, so fetching both ahead of time hides
+        // a cache miss per probe.
+        __builtin_prefetch(get_entry(
+            node, node->pair_offsets[beg + (test_point - beg) / 2]));
+        if (test_point + 1 < end) {
+            __builtin_prefetch(get_entry(
+                node, node->pair_offsets[test_point + 1 + (end - test_point - 1) / 2]));
+        }
+
         const btree_key_t *ek = entry_key(get_entry(node, node->pair_offsets[test_point]));
 
-        int res = btree_key_cmp(key, ek);
+        // Zero-padding makes keys that differ only in length (or in trailing zero
+        // bytes) have equal words, so equal words need the full comparison.
+        const uint64_t ek_word = key_prefix_word(ek);
+        int res = key_word != ek_word
+            ? (key_word < ek_word ? -1 : 1)
+            : btree_key_cmp(key, ek);
 
         if (res < 0) {
             // key < *test_point.
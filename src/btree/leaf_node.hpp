@@ -128,6 +128,12 @@ bool is_full(value_sizer_t *sizer, const leaf_node_t *node, const btree_key_t *k
 
 bool is_underfull(value_sizer_t *sizer, const leaf_node_t *node);
 
+// Sets `out` to the shortest key `k` with `left <= k < right`.  `split` uses this for
+// the key that goes into the parent:  any such key separates the two nodes, and
+// shorter separators let internal nodes hold more of them.
+void shortest_separator(const btree_key_t *left, const btree_key_t *right,
+                        btree_key_t *out);
+
 void split(value_sizer_t *sizer, leaf_node_t *node, leaf_node_t *sibling,
            btree_key_t *median_out);
 
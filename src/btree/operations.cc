@@ -104,7 +104,7 @@ void check_and_handle_split(value_sizer_t *sizer,
     buf_lock_t rbuf(last_buf->empty() ? sb->expose_buf() : buf_parent_t(last_buf),
                     alt_create_t::create);
     store_key_t median_buffer;
-    btree_key_t *median = median_buffer.btree_key();
+    btree_key_t *median = median_buffer.writable_btree_key();
 
     {
         buf_write_t buf_write(buf);
@@ -172,7 +172,8 @@ void check_and_handle_underfull(value_sizer_t *sizer,
                                 buf_lock_t *last_buf,
                                 superblock_t *sb,
                                 const btree_key_t *key,
-                                const value_deleter_t *detacher) {
+                                const value_deleter_t *detacher,
+                                bool merge_if_possible) {
     bool node_is_underfull;
     {
         if (last_buf->empty()) {
@@ -184,7 +185,7 @@ void check_and_handle_underfull(value_sizer_t *sizer,
             node_is_underfull = node::is_underfull(sizer, node);
         }
     }
-    if (node_is_underfull) {
+    if (node_is_underfull || (merge_if_possible && !last_buf->empty())) {
         // Acquire a sibling to merge or level with.
         store_key_t key_in_middle;
         block_id_t sib_node_id;
@@ -292,10 +293,10 @@ void check_and_handle_underfull(value_sizer_t *sizer,
                 last_buf->mark_deleted();
                 insert_root(buf->block_id(), sb);
             }
-        } else {
+        } else if (node_is_underfull) {
             // Level.
             store_key_t replacement_key_buffer;
-            btree_key_t *replacement_key = replacement_key_buffer.btree_key();
+            btree_key_t *replacement_key = replacement_key_buffer.writable_btree_key();
 
             bool leveled;
             {
@@ -473,6 +474,30 @@ void find_keyvalue_location_for_write(
     keyvalue_location_out->buf.swap(buf);
 }
 
+bool merge_leaf_if_possible(
+        value_sizer_t *sizer,
+        superblock_t *superblock,
+        const btree_key_t *key,
+        const value_deleter_t *detacher,
+        store_key_t *last_key_out,
+        promise_t<superblock_t *> *pass_back_superblock) {
+    keyvalue_location_t kv_location;
+    find_keyvalue_location_for_write(
+        sizer, superblock, key, repli_timestamp_t::distant_past, detacher,
+        &kv_location, nullptr, pass_back_superblock);
+    check_and_handle_underfull(sizer, &kv_location.buf, &kv_location.last_buf,
+                               kv_location.superblock, key, detacher, true);
+
+    buf_read_t read(&kv_location.buf);
+    const leaf_node_t *node = static_cast<const leaf_node_t *>(read.get_data_read());
+    auto it = leaf::rbegin(*node);
+    if (it == leaf::rend(*node)) {
+        return false;
+    }
+    last_key_out->assign((*it).first);
+    return true;
+}
+
 void find_keyvalue_location_for_read(
         value_sizer_t *sizer,
         superblock_t *superblock, const btree_key_t *key,
@@ -499,18 +524,15 @@ void find_keyvalue_location_for_read(
         buf = std::move(tmp);
     }
 
-#ifndef NDEBUG
-    {
-        buf_read_t read(&buf);
-        node::validate(sizer, static_cast<const node_t *>(read.get_data_read()));
-    }
-#endif  // NDEBUG
-
-    for (;;) {
+    for (int depth = 0; ; ++depth) {
         block_id_t node_id;
         {
             buf_read_t read(&buf);
             const void *data = read.get_data_read();
+            stats->record_node_read(depth, read.was_cached());
+#ifndef NDEBUG
+            node::validate(sizer, static_cast<const node_t *>(data));
+#endif  // NDEBUG
             if (!node::is_internal(static_cast<const node_t *>(data))) {
                 break;
             }
@@ -527,13 +549,6 @@ void find_keyvalue_location_for_read(
             buf.reset_buf_lock();
             buf = std::move(tmp);
         }
-
-#ifndef NDEBUG
-        {
-            buf_read_t read(&buf);
-            node::validate(sizer, static_cast<const node_t *>(read.get_data_read()));
-        }
-#endif  // NDEBUG
     }
 
     // Got down to the leaf, now probe it.
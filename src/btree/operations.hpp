@@ -68,6 +68,14 @@ public:
               &pm_total_keys_read, "total_keys_read",
               &pm_keys_set, "keys_set",
               &pm_total_keys_set, "total_keys_set") {
+        for (int i = 0; i < TRACKED_DEPTHS; ++i) {
+            pm_depth_memberships[2 * i].init(new perfmon_membership_t(
+                &btree_collection, &pm_depth_cache_hits[i],
+                strprintf("cache_hits_depth_%d", i)));
+            pm_depth_memberships[2 * i + 1].init(new perfmon_membership_t(
+                &btree_collection, &pm_depth_cache_misses[i],
+                strprintf("cache_misses_depth_%d", i)));
+        }
         if (parent != nullptr) {
             rename(parent, identifier);
         }
@@ -86,6 +94,17 @@ public:
             "btree-" + identifier));
     }
 
+    // Records a node read during a key lookup.  The root is at depth 0; nodes below
+    // the deepest depth we track are counted with it.
+    void record_node_read(int depth, bool was_cached) {
+        depth = std::min(depth, TRACKED_DEPTHS - 1);
+        if (was_cached) {
+            ++pm_depth_cache_hits[depth];
+        } else {
+            ++pm_depth_cache_misses[depth];
+        }
+    }
+
     perfmon_collection_t btree_collection;
     scoped_ptr_t<perfmon_membership_t> btree_collection_membership;
     perfmon_rate_monitor_t
@@ -95,6 +114,13 @@ public:
         pm_total_keys_read,
         pm_total_keys_set;
     perfmon_multi_membership_t pm_keys_membership;
+
+    // Cache hits and misses of node reads by depth, see `record_node_read`.  Deep
+    // trees are rare, a table with billions of documents has a depth of about 4.
+    static const int TRACKED_DEPTHS = 5;
+    perfmon_counter_t pm_depth_cache_hits[TRACKED_DEPTHS];
+    perfmon_counter_t pm_depth_cache_misses[TRACKED_DEPTHS];
+    scoped_ptr_t<perfmon_membership_t> pm_depth_memberships[2 * TRACKED_DEPTHS];
 };
 
 class keyvalue_location_t {
@@ -178,12 +204,15 @@ void check_and_handle_split(value_sizer_t *sizer,
                             const btree_key_t *key, void *new_value,
                             const value_deleter_t *detacher);
 
+/* If `merge_if_possible` is true, the node also gets merged with its sibling if the
+two fit into one node, even if it isn't underfull. */
 void check_and_handle_underfull(value_sizer_t *sizer,
                                 buf_lock_t *buf,
                                 buf_lock_t *last_buf,
                                 superblock_t *sb,
                                 const btree_key_t *key,
-                                const value_deleter_t *detacher);
+                                const value_deleter_t *detacher,
+                                bool merge_if_possible = false);
 
 /* Set sb to have root id as its root block and release sb */
 void insert_root(block_id_t root_id, superblock_t *sb);
@@ -205,6 +234,20 @@ void find_keyvalue_location_for_write(
         profile::trace_t *trace,
         promise_t<superblock_t *> *pass_back_superblock = nullptr) THROWS_NOTHING;
 
+/* Merges the leaf that `key` belongs to with one of its siblings if the two fit into
+a single leaf, even if neither of them is underfull.  Leaves only get merged on their
+own once they are underfull, so this is for compacting a btree whose leaves are all
+about half full.  Sets `*last_key_out` to the largest key in the leaf afterwards, or
+returns false if the leaf is empty.  `pass_back_superblock` works like for
+`find_keyvalue_location_for_write()`. */
+bool merge_leaf_if_possible(
+        value_sizer_t *sizer,
+        superblock_t *superblock,
+        const btree_key_t *key,
+        const value_deleter_t *detacher,
+        store_key_t *last_key_out,
+        promise_t<superblock_t *> *pass_back_superblock = nullptr);
+
 void find_keyvalue_location_for_read(
         value_sizer_t *sizer,
         superblock_t *superblock,
@@ -298,7 +298,6 @@ void set_superblock_metainfo(real_superblock_t *superblock,
 
     blob_t blob(superblock->get()->cache()->max_block_size(),
                 data->metainfo_blob, reql_btree_superblock_t::METAINFO_BLOB_MAXREFLEN);
-    blob.clear(buf_parent_t(superblock->get()));
 
     std::vector<char> metainfo;
 
@@ -324,7 +323,13 @@ void set_superblock_metainfo(real_superblock_t *superblock,
             static_cast<const uint8_t *>(value_it->data()) + value_it->size());
     }
 
-    blob.append_region(buf_parent_t(superblock->get()), metainfo.size());
+    /* Every write sets the metainfo, and usually only the versions in it change, so
+    the size stays the same.  In that case we overwrite the blob in place instead of
+    freeing its blocks and allocating new ones. */
+    if (blob.valuesize() != static_cast<int64_t>(metainfo.size())) {
+        blob.clear(buf_parent_t(superblock->get()));
+        blob.append_region(buf_parent_t(superblock->get()), metainfo.size());
+    }
 
     {
         blob_acq_t acq;
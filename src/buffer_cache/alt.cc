@@ -141,6 +141,18 @@ void cache_t::configure_flush_interval(flush_interval_t interval) {
         clamp_ring_length(which_cpu_shard_, interval.millis));
 }
 
+void cache_t::configure_cache_priority(double priority) {
+    page_cache_.evicter().set_cache_priority(priority);
+}
+
+std::vector<block_id_t> cache_t::warm_block_ids() const {
+    return page_cache_.warm_block_ids();
+}
+
+void cache_t::warm_up(std::vector<block_id_t> &&block_ids) {
+    page_cache_.warm_up(std::move(block_ids));
+}
+
 cache_account_t cache_t::create_cache_account(int priority) {
     return page_cache_.create_cache_account(priority);
 }
@@ -817,7 +829,7 @@ page_t *buf_lock_t::get_held_page_for_write() {
 }
 
 buf_read_t::buf_read_t(buf_lock_t *lock)
-    : lock_(lock) {
+    : lock_(lock), was_cached_(false) {
     guarantee(!lock_->empty());
     lock_->access_ref_count_++;
 }
@@ -832,6 +844,13 @@ const void *buf_read_t::get_data_read(uint16_t *block_size_out) {
     if (!page_acq_.has()) {
         page_acq_.init(page, &lock_->cache()->page_cache_,
                        lock_->txn()->account());
+        // The signal gets pulsed right away if the page is loaded.
+        was_cached_ = page_acq_.buf_ready_signal()->is_pulsed();
+        if (was_cached_) {
+            ++lock_->cache()->stats_->pm_reads_hit;
+        } else {
+            ++lock_->cache()->stats_->pm_reads_missed;
+        }
     }
     page_acq_.buf_ready_signal()->wait();
     *block_size_out = page_acq_.get_buf_size().value();
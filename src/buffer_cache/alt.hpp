@@ -64,6 +64,13 @@ public:
 
     void configure_flush_interval(flush_interval_t interval);
 
+    // See `evicter_t::set_cache_priority()`.
+    void configure_cache_priority(double priority);
+
+    // See `page_cache_t::warm_block_ids()` and `page_cache_t::warm_up()`.
+    std::vector<block_id_t> warm_block_ids() const;
+    void warm_up(std::vector<block_id_t> &&block_ids);
+
 private:
     friend class txn_t;
     friend class buf_read_t;
@@ -338,9 +345,17 @@ public:
         return data;
     }
 
+    // Whether the block was already in memory when `get_data_read` was first
+    // called, as opposed to having to be loaded from disk.
+    bool was_cached() const {
+        guarantee(page_acq_.has());
+        return was_cached_;
+    }
+
 private:
     buf_lock_t *lock_;
     alt::page_acq_t page_acq_;
+    bool was_cached_;
 
     DISABLE_COPYING(buf_read_t);
 };
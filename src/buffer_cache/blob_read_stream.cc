@@ -0,0 +1,81 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "buffer_cache/blob_read_stream.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+
+// How many leaf blocks a chunk spans at most.  Exposing several leaves at once lets
+// their reads go out together, while still bounding how much of a large value is
+// pinned at a time.
+const int64_t BLOB_READ_STREAM_CHUNK_LEAVES = 16;
+
+blob_read_stream_t::blob_read_stream_t(buf_parent_t parent,
+                                       max_block_size_t block_size,
+                                       const char *ref, int maxreflen)
+    : parent_(parent),
+      block_size_(block_size),
+      blob_(block_size, const_cast<char *>(ref), maxreflen),
+      value_size_(blob_.valuesize()),
+      chunk_end_(0),
+      bufnum_(0),
+      bufpos_(0) { }
+
+blob_read_stream_t::~blob_read_stream_t() { }
+
+bool blob_read_stream_t::expose_next_chunk() {
+    // Release the previous chunk's blocks before acquiring the next ones.
+    chunk_group_.reset();
+    chunk_acq_.reset();
+    if (chunk_end_ == value_size_) {
+        return false;
+    }
+
+    // Chunks end on leaf boundaries, so that no leaf is acquired twice.
+    const int64_t leaf_size = blob::stepsize(block_size_, 1);
+    const int64_t offset = chunk_end_;
+    const int64_t end = std::min(
+        value_size_,
+        (offset / leaf_size + BLOB_READ_STREAM_CHUNK_LEAVES) * leaf_size);
+
+    chunk_group_.init(new buffer_group_t());
+    chunk_acq_.init(new blob_acq_t());
+    blob_.expose_region(parent_, access_t::read, offset, end - offset,
+                        chunk_group_.get(), chunk_acq_.get());
+    chunk_end_ = end;
+    bufnum_ = 0;
+    bufpos_ = 0;
+    return true;
+}
+
+int64_t blob_read_stream_t::read(void *p, int64_t n) {
+    char *v = static_cast<char *>(p);
+    const int64_t original_n = n;
+
+    while (n > 0) {
+        if (!chunk_group_.has() || bufnum_ == chunk_group_->num_buffers()) {
+            if (!expose_next_chunk()) {
+                break;
+            }
+            continue;
+        }
+        buffer_group_t::buffer_t buf = chunk_group_->get_buffer(bufnum_);
+        int64_t bytes_to_copy = std::min(buf.size - bufpos_, n);
+        memcpy(v, static_cast<const char *>(buf.data) + bufpos_, bytes_to_copy);
+        n -= bytes_to_copy;
+        v += bytes_to_copy;
+        bufpos_ += bytes_to_copy;
+
+        if (bufpos_ == buf.size) {
+            ++bufnum_;
+            bufpos_ = 0;
+        }
+    }
+
+    return original_n - n;
+}
+
+bool blob_read_stream_t::entire_stream_consumed() const {
+    return chunk_end_ == value_size_
+        && (!chunk_group_.has() || bufnum_ == chunk_group_->num_buffers());
+}
@@ -0,0 +1,49 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef BUFFER_CACHE_BLOB_READ_STREAM_HPP_
+#define BUFFER_CACHE_BLOB_READ_STREAM_HPP_
+
+#include "buffer_cache/alt.hpp"
+#include "buffer_cache/blob.hpp"
+#include "containers/archive/archive.hpp"
+#include "containers/buffer_group.hpp"
+#include "containers/scoped.hpp"
+
+/* Reads a blob's contents a few leaf blocks at a time.  `expose_all` acquires every
+block of the blob before you can read the first byte, which for a large value means
+waiting for all of its blocks to be loaded and keeping them pinned in the cache until
+the whole value has been deserialized.  This stream only holds on to the blocks of
+the chunk it's reading from, and releases them before it acquires the next chunk.
+
+The blob must not be modified while the stream is reading it. */
+class blob_read_stream_t : public read_stream_t {
+public:
+    blob_read_stream_t(buf_parent_t parent, max_block_size_t block_size,
+                       const char *ref, int maxreflen);
+    virtual ~blob_read_stream_t();
+
+    virtual MUST_USE int64_t read(void *p, int64_t n);
+
+    bool entire_stream_consumed() const;
+
+private:
+    // Releases the current chunk and exposes the next one.  Returns false at the end
+    // of the blob.
+    bool expose_next_chunk();
+
+    buf_parent_t parent_;
+    const max_block_size_t block_size_;
+    // `blob_t` wants a non-const ref, but we only ever read through it.
+    blob_t blob_;
+    const int64_t value_size_;
+
+    // Where in the blob the current chunk ends.
+    int64_t chunk_end_;
+    scoped_ptr_t<blob_acq_t> chunk_acq_;
+    scoped_ptr_t<buffer_group_t> chunk_group_;
+    size_t bufnum_;
+    int64_t bufpos_;
+
+    DISABLE_COPYING(blob_read_stream_t);
+};
+
+#endif  // BUFFER_CACHE_BLOB_READ_STREAM_HPP_
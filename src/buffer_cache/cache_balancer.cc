@@ -21,7 +21,8 @@ alt_cache_balancer_t::cache_data_t::cache_data_t(alt::evicter_t *_evicter) :
     evictable_disk_backed_size(evicter->evictable_disk_backed_size()),
     evictable_unbacked_size(evicter->evictable_unbacked_size()),
     bytes_loaded(evicter->get_bytes_loaded()),
-    access_count(evicter->access_count()) { }
+    access_count(evicter->access_count()),
+    priority(evicter->cache_priority()) { }
 
 alt_cache_balancer_t::alt_cache_balancer_t(
         clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable) :
@@ -120,12 +121,16 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
     // Sum up the number of evicters, bytes loaded, and access counts
     size_t total_evicters = 0;
     uint64_t total_bytes_loaded = 0;
+    double total_weighted_bytes_loaded = 0;
     uint64_t total_access_count = 0;
     for (size_t i = 0; i < num_threads; ++i) {
         total_evicters += cache_data[i].size();
         all_zero_access_counts &= zero_access_counts[i];
         for (size_t j = 0; j < cache_data[i].size(); ++j) {
-            total_bytes_loaded += std::max<int64_t>(0, cache_data[i][j].bytes_loaded);
+            const uint64_t bytes_loaded
+                = std::max<int64_t>(0, cache_data[i][j].bytes_loaded);
+            total_bytes_loaded += bytes_loaded;
+            total_weighted_bytes_loaded += cache_data[i][j].priority * bytes_loaded;
             total_access_count += cache_data[i][j].access_count;
         }
     }
@@ -161,14 +166,8 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
                 cache_data_t *data = &cache_data[i][j];
 
                 if (total_cache_size > 0) {
-                    double temp = data->old_size;
-                    temp /= static_cast<double>(total_cache_size);
-                    temp *= static_cast<double>(total_bytes_loaded);
-
-                    int64_t new_size = std::max<int64_t>(0, data->bytes_loaded);
-                    new_size -= static_cast<int64_t>(temp);
-                    new_size += data->old_size;
-                    new_size = std::max<int64_t>(new_size, 0);
+                    int64_t new_size = compute_new_size(
+                        *data, total_cache_size, total_weighted_bytes_loaded);
 
                     int64_t existing_unevictable
                         = data->unevictable_size + data->evictable_unbacked_size;
@@ -262,6 +261,25 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
     }
 }
 
+int64_t alt_cache_balancer_t::compute_new_size(const cache_data_t &data,
+                                               uint64_t total_cache_size,
+                                               double total_weighted_bytes_loaded) {
+    // Every cache gives up memory in proportion to its current size, and gets
+    // memory in proportion to how much it loaded since the last rebalance.  With
+    // priorities, a cache with twice the priority gets twice as much memory for the
+    // same amount of loading, so it ends up larger when caches compete for memory.
+    double temp = data.old_size;
+    temp /= static_cast<double>(total_cache_size);
+    temp *= total_weighted_bytes_loaded;
+
+    const double weighted_bytes_loaded
+        = data.priority * std::max<int64_t>(0, data.bytes_loaded);
+    int64_t new_size = static_cast<int64_t>(weighted_bytes_loaded);
+    new_size -= static_cast<int64_t>(temp);
+    new_size += data.old_size;
+    return std::max<int64_t>(new_size, 0);
+}
+
 void alt_cache_balancer_t::collect_stats_from_thread(
         int index,
         scoped_array_t<std::vector<cache_data_t> > *data_out,
@@ -149,8 +149,17 @@ private:
 
         int64_t bytes_loaded;
         uint64_t access_count;
+
+        double priority;
     };
 
+    // The new size of one cache, given its share of the demand.  The caches' new
+    // sizes add up to the total cache size, before rounding and before caches get
+    // clamped to their unevictable size.
+    static int64_t compute_new_size(const cache_data_t &data,
+                                    uint64_t total_cache_size,
+                                    double total_weighted_bytes_loaded);
+
     // Helper function to collect stats from each thread so we don't need
     //  atomic variables slowing down normal operations
     void collect_stats_from_thread(int index,
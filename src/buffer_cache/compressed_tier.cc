@@ -0,0 +1,112 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "buffer_cache/compressed_tier.hpp"
+
+#include <iterator>
+
+#include "serializer/log/block_compression.hpp"
+
+namespace alt {
+
+// Roughly what an entry costs besides its buffer: the list node, the hash table node
+// and the block token it keeps alive.
+const uint64_t COMPRESSED_TIER_ENTRY_OVERHEAD = 64 + sizeof(block_token_t);
+
+compressed_tier_t::compressed_tier_t() : size_(0) { }
+
+compressed_tier_t::~compressed_tier_t() {
+    rassert(entries_.empty() == (size_ == 0));
+}
+
+uint64_t compressed_tier_t::entry_usage(const entry_t &entry) {
+    return entry.compressed.aligned_block_size() + COMPRESSED_TIER_ENTRY_OVERHEAD;
+}
+
+bool compressed_tier_t::insert(block_id_t block_id,
+                               const counted_t<block_token_t> &token,
+                               const ser_buffer_t *buf, block_size_t block_size,
+                               uint64_t capacity) {
+    rassert(token.has());
+    remove(block_id);
+
+    // `compress_block` only succeeds if the result takes at least one device block
+    // less than the original, which is exactly when it saves memory.
+    buf_ptr_t compressed = compress_block(buf, block_size);
+    if (!compressed.has()) {
+        return false;
+    }
+    entry_t entry(block_id, token, std::move(compressed));
+    const uint64_t usage = entry_usage(entry);
+    if (usage > capacity) {
+        return false;
+    }
+    // The block we're adding was used more recently than anything that is already
+    // in the tier, so it's fine to drop the oldest entries to make room for it.
+    shrink_to(capacity - usage);
+
+    entries_.push_back(std::move(entry));
+    index_.insert(std::make_pair(block_id, std::prev(entries_.end())));
+    size_ += usage;
+    return true;
+}
+
+bool compressed_tier_t::take(block_id_t block_id,
+                             counted_t<block_token_t> *token_out,
+                             buf_ptr_t *compressed_out) {
+    auto it = index_.find(block_id);
+    if (it == index_.end()) {
+        return false;
+    }
+    *token_out = it->second->token;
+    erase(it->second, compressed_out);
+    return true;
+}
+
+bool compressed_tier_t::take_matching(block_id_t block_id,
+                                      const counted_t<block_token_t> &token,
+                                      buf_ptr_t *compressed_out) {
+    auto it = index_.find(block_id);
+    if (it == index_.end() || it->second->token.get() != token.get()) {
+        return false;
+    }
+    erase(it->second, compressed_out);
+    return true;
+}
+
+void compressed_tier_t::remove(block_id_t block_id) {
+    auto it = index_.find(block_id);
+    if (it != index_.end()) {
+        erase(it->second, nullptr);
+    }
+}
+
+bool compressed_tier_t::remove_oldest() {
+    if (entries_.empty()) {
+        return false;
+    }
+    erase(entries_.begin(), nullptr);
+    return true;
+}
+
+void compressed_tier_t::shrink_to(uint64_t capacity) {
+    while (size_ > capacity && remove_oldest()) { }
+}
+
+buf_ptr_t compressed_tier_t::inflate(const buf_ptr_t &compressed,
+                                     block_size_t block_size) {
+    return decompress_block(compressed.ser_buffer(), compressed.block_size(),
+                            block_size);
+}
+
+void compressed_tier_t::erase(std::list<entry_t>::iterator it,
+                              buf_ptr_t *compressed_out) {
+    const uint64_t usage = entry_usage(*it);
+    rassert(size_ >= usage);
+    size_ -= usage;
+    if (compressed_out != nullptr) {
+        *compressed_out = std::move(it->compressed);
+    }
+    index_.erase(it->block_id);
+    entries_.erase(it);
+}
+
+}  // namespace alt
@@ -0,0 +1,92 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef BUFFER_CACHE_COMPRESSED_TIER_HPP_
+#define BUFFER_CACHE_COMPRESSED_TIER_HPP_
+
+#include <stdint.h>
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "errors.hpp"
+#include "containers/counted.hpp"
+#include "serializer/buf_ptr.hpp"
+#include "serializer/types.hpp"
+
+namespace alt {
+
+/* The compressed tier keeps deflated copies of recently evicted pages, so that
+reloading them costs a decompression instead of a disk read.  It is owned by the
+`evicter_t`, which counts its size against the cache's memory limit, and which drops
+its oldest entries whenever it needs to free memory.
+
+Entries are keyed by block id, because evicting a page usually destroys its
+`current_page_t` and `page_t` too.  Each entry also holds the block token of the
+version it's a copy of.  That keeps the block's data alive on disk, so a block token
+for the block's current version (from `index_read`) refers to the same offset if and
+only if the entry is still up to date.  Entries for blocks that have changed since
+are just wasted memory until they get dropped. */
+class compressed_tier_t {
+public:
+    compressed_tier_t();
+    ~compressed_tier_t();
+
+    // Keeps a compressed copy of the block, replacing any older copy and dropping
+    // the oldest entries if that's necessary to stay within `capacity` bytes.
+    // Returns false (and doesn't add anything) if the block doesn't compress well
+    // enough to save memory.
+    bool insert(block_id_t block_id, const counted_t<block_token_t> &token,
+                const ser_buffer_t *buf, block_size_t block_size, uint64_t capacity);
+
+    // Removes the entry for `block_id`, if there is one, and gives back its token
+    // and compressed buf.  Use `inflate` to get the block's contents.
+    bool take(block_id_t block_id, counted_t<block_token_t> *token_out,
+              buf_ptr_t *compressed_out);
+
+    // Like `take`, but only if the entry is a copy of the version of the block that
+    // `token` refers to.
+    bool take_matching(block_id_t block_id, const counted_t<block_token_t> &token,
+                       buf_ptr_t *compressed_out);
+
+    // Forgets about `block_id`, if it has an entry.
+    void remove(block_id_t block_id);
+
+    // Drops the oldest entry.  Returns false if the tier is empty.
+    bool remove_oldest();
+
+    // Drops the oldest entries until the tier uses at most `capacity` bytes.
+    void shrink_to(uint64_t capacity);
+
+    // How many bytes of memory the tier uses.
+    uint64_t size() const { return size_; }
+    size_t num_entries() const { return index_.size(); }
+
+    // Turns a compressed buf given out by `take` back into the block's contents.
+    static buf_ptr_t inflate(const buf_ptr_t &compressed, block_size_t block_size);
+
+private:
+    struct entry_t {
+        entry_t(block_id_t _block_id, const counted_t<block_token_t> &_token,
+                buf_ptr_t &&_compressed)
+            : block_id(_block_id), token(_token),
+              compressed(std::move(_compressed)) { }
+        block_id_t block_id;
+        counted_t<block_token_t> token;
+        buf_ptr_t compressed;
+    };
+
+    static uint64_t entry_usage(const entry_t &entry);
+    // Moves the entry's compressed buf to `compressed_out`, unless that is null.
+    void erase(std::list<entry_t>::iterator it, buf_ptr_t *compressed_out);
+
+    // Oldest entries first.
+    std::list<entry_t> entries_;
+    std::unordered_map<block_id_t, std::list<entry_t>::iterator> index_;
+    uint64_t size_;
+
+    DISABLE_COPYING(compressed_tier_t);
+};
+
+}  // namespace alt
+
+#endif  // BUFFER_CACHE_COMPRESSED_TIER_HPP_
@@ -1,5 +1,7 @@
 #include "buffer_cache/evicter.hpp"
 
+#include <algorithm>
+
 #include "arch/runtime/coroutines.hpp"
 #include "buffer_cache/alt.hpp"
 #include "buffer_cache/page.hpp"
@@ -8,17 +10,41 @@
 
 namespace alt {
 
+// The compressed tier may use up to this fraction of the cache's memory limit.
+const double COMPRESSED_TIER_RATIO = 0.25;
+
+// Once dirty pages take up this fraction of the memory limit, we start writing them
+// back without waiting for the soft durability flush interval.  Writers aren't
+// slowed down by this.
+const double DIRTY_WRITE_BACK_RATIO = 0.2;
+
+// Once they take up this fraction, we force all pending txns to be flushed.  That
+// makes their dirty pages count against the `alt_txn_throttler_t`, so new write
+// transactions get throttled until the write-back catches up.
+const double DIRTY_FORCE_FLUSH_RATIO = 0.4;
+
+// Both kinds of flushes are rate limited, so that we don't write back every txn on
+// its own.  The interval between forced flushes shrinks from the maximum to the
+// minimum as dirty pages go from `DIRTY_FORCE_FLUSH_RATIO` to the whole memory limit,
+// so that writers are pushed back harder the closer the cache gets to being full of
+// pages it can't evict.
+const int64_t MAX_FORCE_FLUSH_INTERVAL_NANOS = 5 * BILLION;
+const int64_t MIN_WRITE_BACK_INTERVAL_NANOS = 50 * MILLION;
+
 evicter_t::evicter_t()
     : initialized_(false),
       page_cache_(nullptr),
       balancer_(nullptr),
       balancer_notify_activity_boolean_(nullptr),
       throttler_(nullptr),
+      cache_priority_(1.0),
       bytes_loaded_counter_(0),
       access_count_counter_(0),
       access_time_counter_(INITIAL_ACCESS_TIME),
       evict_if_necessary_active_(false),
-      last_force_flush_time_(ticks_t{0}) { }
+      last_write_back_time_(ticks_t{0}),
+      last_force_flush_time_(ticks_t{0}),
+      memory_reporter_(memory_tag_t::PAGE_CACHE) { }
 
 evicter_t::~evicter_t() {
     assert_thread();
@@ -60,12 +86,19 @@ void evicter_t::update_memory_limit(uint64_t new_memory_limit,
     bytes_loaded_counter_ -= bytes_loaded_accounted_for;
     access_count_counter_ -= access_count_accounted_for;
     memory_limit_ = new_memory_limit;
+    compressed_tier_.shrink_to(compressed_tier_capacity());
     evict_if_necessary();
 
     throttler_->inform_memory_limit_change(memory_limit_,
                                            page_cache_->max_block_size());
 }
 
+void evicter_t::set_cache_priority(double priority) {
+    guarantee_initialized();
+    guarantee(priority > 0);
+    cache_priority_ = priority;
+}
+
 void wake_up_balancer(cache_balancer_t *balancer,
                       UNUSED auto_drainer_t::lock_t drainer_lock) {
     on_thread_t th(balancer->home_thread());
@@ -177,7 +210,12 @@ uint64_t evicter_t::in_memory_size() const {
     guarantee_initialized();
     return unevictable_.size()
         + evictable_disk_backed_.size()
-        + evictable_unbacked_.size();
+        + evictable_unbacked_.size()
+        + compressed_tier_.size();
+}
+
+uint64_t evicter_t::compressed_tier_capacity() const {
+    return static_cast<uint64_t>(memory_limit_ * COMPRESSED_TIER_RATIO);
 }
 
 void evicter_t::evict_if_necessary() THROWS_NOTHING {
@@ -196,28 +234,65 @@ void evicter_t::evict_if_necessary() THROWS_NOTHING {
 
     evict_if_necessary_active_ = true;
     page_t *page;
-    while (in_memory_size() > memory_limit_
-           && eviction_bag_t::select_oldish(
+    while (in_memory_size() > memory_limit_) {
+        if (!eviction_bag_t::select_oldish(
                 &evictable_disk_backed_, access_time_counter_, &page)) {
+            // The compressed copies are the last thing we give up, after all the
+            // pages we're able to evict.
+            if (!compressed_tier_.remove_oldest()) {
+                break;
+            }
+            continue;
+        }
         uint32_t mem_usage = page->hypothetical_memory_usage(page_cache_);
         evictable_disk_backed_.remove(page, mem_usage);
         evicted_.add(page, mem_usage);
+        // This only succeeds if the copy is smaller than the page, so every
+        // iteration frees some memory.
+        compressed_tier_.insert(page->block_id(), page->block_token(),
+                                page->get_loaded_ser_buffer(),
+                                page->get_page_buf_size(),
+                                compressed_tier_capacity());
         page->evict_self(page_cache_);
         page_cache_->consider_evicting_current_page(page->block_id());
     }
 
-    if (in_memory_size() > memory_limit_) {
-        // This is pretty lame and hackish -- we'd like something better tuned.
-        // Basically we force a fast flush once every 5 seconds if we've got many
-        // unaccounted for dirty pages.
+    write_back_if_necessary();
+    memory_reporter_.set(in_memory_size());
+
+    evict_if_necessary_active_ = false;
+}
+
+void evicter_t::write_back_if_necessary() {
+    const double dirty_ratio = memory_limit_ == 0
+        ? 1.0
+        : static_cast<double>(evictable_unbacked_.size()) / memory_limit_;
+    const bool over_limit = in_memory_size() > memory_limit_;
+
+    if (!over_limit && dirty_ratio < DIRTY_FORCE_FLUSH_RATIO) {
         ticks_t ticks = get_ticks();
-        if (ticks.nanos - last_force_flush_time_.nanos > 5 * BILLION) {
-            last_force_flush_time_ = ticks;
-            page_cache_->begin_flush_pending_txns(true, ticks_t{0});
+        if (dirty_ratio >= DIRTY_WRITE_BACK_RATIO
+            && ticks.nanos - last_write_back_time_.nanos
+               > MIN_WRITE_BACK_INTERVAL_NANOS) {
+            last_write_back_time_ = ticks;
+            // This does nothing if a soft durability flush is already running.
+            page_cache_->soft_durability_interval_flush(ticks_t{0});
         }
+        return;
     }
 
-    evict_if_necessary_active_ = false;
+    // If we're over the limit because of clean pages that we can't evict right now
+    // (or because of a small limit), this falls back to the maximum interval.
+    const double pressure = std::min(1.0, std::max(0.0,
+        (dirty_ratio - DIRTY_FORCE_FLUSH_RATIO) / (1.0 - DIRTY_FORCE_FLUSH_RATIO)));
+    const int64_t interval = MAX_FORCE_FLUSH_INTERVAL_NANOS
+        - static_cast<int64_t>(
+            pressure * (MAX_FORCE_FLUSH_INTERVAL_NANOS - MIN_WRITE_BACK_INTERVAL_NANOS));
+    ticks_t ticks = get_ticks();
+    if (ticks.nanos - last_force_flush_time_.nanos > interval) {
+        last_force_flush_time_ = ticks;
+        page_cache_->begin_flush_pending_txns(true, ticks_t{0});
+    }
 }
 
 usage_adjuster_t::usage_adjuster_t(page_cache_t *page_cache, page_t *page)
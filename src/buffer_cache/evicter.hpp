@@ -5,10 +5,12 @@
 
 #include <functional>
 
+#include "buffer_cache/compressed_tier.hpp"
 #include "buffer_cache/eviction_bag.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/cache_line_padded.hpp"
 #include "concurrency/pubsub.hpp"
+#include "memory_accounting.hpp"
 #include "threading.hpp"
 #include "time.hpp"
 
@@ -35,6 +37,12 @@ public:
     void remove_page(page_t *page);
     void reloading_page(page_t *page);
 
+    // Access to the compressed copies of evicted pages.  See `compressed_tier_t`.
+    compressed_tier_t *compressed_tier() {
+        guarantee_initialized();
+        return &compressed_tier_;
+    }
+
     // Evicter will be unusable until initialize is called
     evicter_t();
     ~evicter_t();
@@ -52,10 +60,24 @@ public:
         return ++access_time_counter_;
     }
 
+    // The access time of the most recently accessed page.
+    uint64_t current_access_time() const {
+        guarantee_initialized();
+        return access_time_counter_;
+    }
+
     uint64_t memory_limit() const {
         guarantee_initialized();
         return memory_limit_;
     }
+
+    // The cache balancer hands memory to caches in proportion to their recent
+    // demand, multiplied by this priority.  The default is 1.
+    void set_cache_priority(double priority);
+    double cache_priority() const {
+        guarantee_initialized();
+        return cache_priority_;
+    }
     uint64_t access_count() const {
         guarantee_initialized();
         return access_count_counter_;
@@ -79,6 +101,7 @@ public:
     }
 
 
+    // Includes the compressed tier.
     uint64_t in_memory_size() const;
 
     // This is decremented past UINT64_MAX to force code to be aware of access time
@@ -99,6 +122,13 @@ private:
     // Evicts any evictable pages until under the memory limit
     void evict_if_necessary() THROWS_NOTHING;
 
+    // Starts writing back dirty pages early if they take up too much of the memory
+    // limit, since they can't be evicted until they've been written.
+    void write_back_if_necessary();
+
+    // How much of the memory limit the compressed tier may use.
+    uint64_t compressed_tier_capacity() const;
+
     bool initialized_;
     page_cache_t *page_cache_;
     cache_balancer_t *balancer_;
@@ -108,6 +138,8 @@ private:
 
     uint64_t memory_limit_;
 
+    double cache_priority_;
+
     // These are updated every time a page is loaded, created, or destroyed, and
     // cleared when cache memory limits are re-evaluated.  This value can go
     // negative, if you keep deleting blocks or suddenly drop a snapshot.
@@ -127,8 +159,17 @@ private:
     eviction_bag_t evictable_unbacked_;
     eviction_bag_t evicted_;
 
+    // Compressed copies of recently evicted blocks.
+    compressed_tier_t compressed_tier_;
+
+    // When `write_back_if_necessary()` last started a background write-back, and
+    // when it last forced pending txns to be flushed.
+    ticks_t last_write_back_time_;
     ticks_t last_force_flush_time_;
 
+    // Reports `in_memory_size()` after every eviction.
+    tagged_memory_reporter_t memory_reporter_;
+
     auto_drainer_t drainer_;
 
     DISABLE_COPYING(evicter_t);
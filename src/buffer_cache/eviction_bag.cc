@@ -38,6 +38,23 @@ bool eviction_bag_t::has_page(page_t *page) const {
     return bag_.has_element(page);
 }
 
+// Pages that have only been acquired once look this many times older than they
+// are.  A scan over more data than fits in the cache then mostly evicts its own
+// pages, instead of pushing out the pages that get used over and over.
+const uint64_t UNREUSED_PAGE_AGE_FACTOR = 4;
+
+// We compare ages relative to the access time offset, so that in the unlikely event
+// of a 64-bit overflow, performance degradation is "smooth".
+static uint64_t eviction_age(page_t *page, uint64_t access_time_offset) {
+    const uint64_t age = access_time_offset - page->access_time();
+    if (page->is_reused()) {
+        return age;
+    }
+    return age > UINT64_MAX / UNREUSED_PAGE_AGE_FACTOR
+        ? UINT64_MAX
+        : age * UNREUSED_PAGE_AGE_FACTOR;
+}
+
 bool eviction_bag_t::select_oldish(eviction_bag_t *eb, uint64_t access_time_offset,
                                    page_t **page_out) {
     if (eb->bag_.size() == 0) {
@@ -47,10 +64,8 @@ bool eviction_bag_t::select_oldish(eviction_bag_t *eb, uint64_t access_time_offs
     page_t *oldest = eb->bag_.access_random(randsize(eb->bag_.size()));
     for (size_t i = 1; i < num_randoms; ++i) {
         page_t *page = eb->bag_.access_random(randsize(eb->bag_.size()));
-        // We compare relative to the access time offset, so that in the unlikely
-        // event of a 64-bit overflow, performance degradation is "smooth".
-        if (access_time_offset - page->access_time() >
-            access_time_offset - oldest->access_time()) {
+        if (eviction_age(page, access_time_offset) >
+            eviction_age(oldest, access_time_offset)) {
             oldest = page;
         }
     }
@@ -81,10 +96,8 @@ bool eviction_bag_t::select_oldish2(eviction_bag_t *eb1, eviction_bag_t *eb2,
     page_t *oldest = access_random2(eb1->bag_, eb2->bag_, randsize(total_size));
     for (size_t i = 1; i < num_randoms; ++i) {
         page_t *page = access_random2(eb1->bag_, eb2->bag_, randsize(total_size));
-        // We compare relative to the access time offset, so that in the unlikely
-        // event of a 64-bit overflow, performance degradation is "smooth".
-        if (access_time_offset - page->access_time() >
-            access_time_offset - oldest->access_time()) {
+        if (eviction_age(page, access_time_offset) >
+            eviction_age(oldest, access_time_offset)) {
             oldest = page;
         }
     }
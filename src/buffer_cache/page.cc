@@ -56,6 +56,7 @@ page_t::page_t(block_id_t _block_id, page_cache_t *page_cache)
     : block_id_(_block_id),
       loader_(nullptr),
       access_time_(page_cache->evicter().next_access_time()),
+      num_acquisitions_(0),
       snapshot_refcount_(0) {
     page_cache->evicter().add_deferred_loaded(this);
 
@@ -70,6 +71,7 @@ page_t::page_t(block_id_t _block_id, page_cache_t *page_cache,
     : block_id_(_block_id),
       loader_(nullptr),
       access_time_(page_cache->evicter().next_access_time()),
+      num_acquisitions_(0),
       snapshot_refcount_(0) {
     page_cache->evicter().add_not_yet_loaded(this);
 
@@ -86,6 +88,7 @@ page_t::page_t(block_id_t _block_id, buf_ptr_t buf,
       loader_(nullptr),
       buf_(std::move(buf)),
       access_time_(page_cache->evicter().next_access_time()),
+      num_acquisitions_(0),
       snapshot_refcount_(0) {
     rassert(buf_.has());
     page_cache->evicter().add_to_evictable_unbacked(this);
@@ -100,6 +103,7 @@ page_t::page_t(block_id_t _block_id,
       buf_(std::move(buf)),
       block_token_(_block_token),
       access_time_(READ_AHEAD_ACCESS_TIME),
+      num_acquisitions_(0),
       snapshot_refcount_(0) {
     rassert(buf_.has());
     page_cache->evicter().add_to_evictable_disk_backed(this);
@@ -109,6 +113,7 @@ page_t::page_t(page_t *copyee, page_cache_t *page_cache, cache_account_t *accoun
     : block_id_(copyee->block_id_),
       loader_(nullptr),
       access_time_(page_cache->evicter().next_access_time()),
+      num_acquisitions_(0),
       snapshot_refcount_(0) {
     page_cache->evicter().add_not_yet_loaded(this);
     coro_t::spawn_now_dangerously(std::bind(&page_t::load_from_copyee,
@@ -349,13 +354,27 @@ void page_t::load_with_block_id(page_t *page, block_id_t block_id,
     buf_ptr_t buf;
     counted_t<block_token_t> block_token;
 
+    // The compressed tier might have a copy of the block.  We can only tell whether
+    // it's a copy of the current version once we have the block token.
+    counted_t<block_token_t> copy_token;
+    buf_ptr_t compressed_copy;
+    page_cache->evicter().compressed_tier()->take(block_id, &copy_token,
+                                                  &compressed_copy);
+    bool use_copy = false;
+
     {
         serializer_t *const serializer = page_cache->serializer();
         on_thread_t th(serializer->home_thread());
         block_token = serializer->index_read(block_id);
         rassert(block_token.has());
-        buf = serializer->block_read(block_token,
-                                     account->get());
+        // Offsets change during GC, so we can only compare them on the serializer
+        // thread.
+        use_copy = copy_token.has() && copy_token->offset() == block_token->offset();
+        copy_token.reset();
+        if (!use_copy) {
+            buf = serializer->block_read(block_token,
+                                         account->get());
+        }
     }
 
     ASSERT_FINITE_CORO_WAITING;
@@ -363,6 +382,10 @@ void page_t::load_with_block_id(page_t *page, block_id_t block_id,
         return;
     }
 
+    if (use_copy) {
+        buf = compressed_tier_t::inflate(compressed_copy, block_token->block_size());
+    }
+
     page_t::finish_load_with_block_id(page, page_cache,
                                       std::move(block_token),
                                       std::move(buf));
@@ -413,6 +436,9 @@ void page_t::pulse_waiters_or_make_evictable(page_cache_t *page_cache) {
 void page_t::add_waiter(page_acq_t *acq, cache_account_t *account) {
     eviction_bag_t *old_bag
         = acq->page_cache()->evicter().correct_eviction_category(this);
+    if (num_acquisitions_ < 2) {
+        ++num_acquisitions_;
+    }
     waiters_.push_front(acq);
     acq->page_cache()->evicter().change_to_correct_eviction_bag(old_bag, this);
     if (buf_.has()) {
@@ -446,7 +472,11 @@ void page_t::load_using_block_token(page_t *page, page_cache_t *page_cache,
     rassert(block_token.has());
 
     buf_ptr_t buf;
-    {
+    buf_ptr_t compressed_copy;
+    if (page_cache->evicter().compressed_tier()->take_matching(
+            page->block_id_, block_token, &compressed_copy)) {
+        buf = compressed_tier_t::inflate(compressed_copy, block_token->block_size());
+    } else {
         serializer_t *const serializer = page_cache->serializer();
 
         on_thread_t th(serializer->home_thread());
@@ -521,7 +551,7 @@ void *page_t::get_page_buf(page_cache_t *page_cache) {
     return buf_.cache_data();
 }
 
-void page_t::reset_block_token(DEBUG_VAR page_cache_t *page_cache) {
+void page_t::reset_block_token(page_cache_t *page_cache) {
     // The page is supposed to have its buffer acquired in reset_block_token -- it's
     // the thing modifying the page.  We thus assume that the page is unevictable and
     // resetting block_token_ doesn't change that.
@@ -529,6 +559,8 @@ void page_t::reset_block_token(DEBUG_VAR page_cache_t *page_cache) {
     rassert(buf_.has());
     if (block_token_.has()) {
         rassert(buf_.block_size() == block_token_->block_size());
+        // Any compressed copy of the block is about to be out of date.
+        page_cache->evicter().compressed_tier()->remove(block_id_);
 #ifndef NDEBUG
         const uint32_t usage_before = hypothetical_memory_usage(page_cache);
 #endif
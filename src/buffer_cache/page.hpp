@@ -55,6 +55,10 @@ public:
 
     uint32_t hypothetical_memory_usage(page_cache_t *page_cache) const;
     uint64_t access_time() const { return access_time_; }
+    // True once the page has been acquired a second time since it was created.  The
+    // evicter protects such pages against pages that were only touched once, which
+    // is what a large scan produces.
+    bool is_reused() const { return num_acquisitions_ >= 2; }
 
     bool is_loading() const {
         return loader_ != nullptr && page_t::loader_is_loading(loader_);
@@ -132,6 +136,11 @@ private:
 
     uint64_t access_time_;
 
+    // How many times `add_waiter()` was called, saturating at 2.  Survives
+    // eviction, so that a page that gets reloaded after being evicted counts as
+    // reused.
+    uint8_t num_acquisitions_;
+
     // How many page_ptr_t's point at this page, expecting nothing to modify it,
     // other than themselves.
     size_t snapshot_refcount_;
@@ -11,6 +11,7 @@
 #include "arch/runtime/runtime_utils.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/new_mutex.hpp"
+#include "concurrency/pmap.hpp"
 #include "buffer_cache/cache_balancer.hpp"
 #include "do_on_thread.hpp"
 #include "serializer/serializer.hpp"
@@ -134,7 +135,7 @@ void page_cache_t::consider_evicting_current_page(block_id_t block_id) {
     // We can't do anything until read-ahead is done, because it uses the existence
     // of a current_page_t entry to figure out whether the read-ahead page could be
     // out of date.
-    if (read_ahead_cb_ != nullptr) {
+    if (read_ahead_cb_ != nullptr || warm_ups_in_progress_ > 0) {
         return;
     }
 
@@ -227,6 +228,97 @@ void page_cache_t::consider_evicting_all_current_pages(page_cache_t *page_cache,
 }
 
 
+std::vector<block_id_t> page_cache_t::warm_block_ids() const {
+    assert_thread();
+    const uint64_t now = evicter_.current_access_time();
+    std::vector<std::pair<uint64_t, block_id_t> > by_age;
+    for (const auto &pair : current_pages_) {
+        const current_page_t *cp = pair.second;
+        if (cp->is_deleted_ || !cp->page_.has()) {
+            continue;
+        }
+        const page_t *page = cp->page_.get_page_for_read();
+        if (page->is_loaded()) {
+            // Unsigned subtraction takes care of access time rollovers.
+            by_age.push_back(std::make_pair(now - page->access_time(), pair.first));
+        }
+    }
+    std::sort(by_age.begin(), by_age.end());
+
+    std::vector<block_id_t> ret;
+    ret.reserve(by_age.size());
+    for (const auto &pair : by_age) {
+        ret.push_back(pair.second);
+    }
+    return ret;
+}
+
+// How many blocks a warm-up reads at a time.
+const size_t WARM_UP_BATCH_SIZE = 64;
+
+void page_cache_t::warm_up(std::vector<block_id_t> &&block_ids) {
+    assert_thread();
+    if (block_ids.empty()) {
+        return;
+    }
+    ++warm_ups_in_progress_;
+    coro_t::spawn_sometime(std::bind(&page_cache_t::do_warm_up,
+                                     this,
+                                     std::move(block_ids),
+                                     drainer_->lock()));
+}
+
+void page_cache_t::do_warm_up(page_cache_t *page_cache,
+                              const std::vector<block_id_t> &block_ids,
+                              auto_drainer_t::lock_t lock) {
+    const uint64_t batch_memory =
+        WARM_UP_BATCH_SIZE * page_cache->max_block_size().ser_value();
+    for (size_t i = 0; i < block_ids.size(); i += WARM_UP_BATCH_SIZE) {
+        // We only fill up free memory, so that warming up never evicts the pages the
+        // workload has loaded in the meantime.
+        if (lock.get_drain_signal()->is_pulsed()
+            || page_cache->evicter_.in_memory_size() + batch_memory
+               > page_cache->evicter_.memory_limit()) {
+            break;
+        }
+        const size_t batch_size = std::min(WARM_UP_BATCH_SIZE, block_ids.size() - i);
+        std::vector<counted_t<block_token_t> > tokens(batch_size);
+        std::vector<buf_ptr_t> bufs(batch_size);
+        {
+            serializer_t *const serializer = page_cache->serializer_;
+            on_thread_t th(serializer->home_thread());
+            for (size_t j = 0; j < batch_size; ++j) {
+                // This is empty if the block has been deleted since the manifest was
+                // written.
+                tokens[j] = serializer->index_read(block_ids[i + j]);
+            }
+            pmap(batch_size, [&](int64_t j) {
+                if (tokens[j].has()) {
+                    bufs[j] = serializer->block_read(
+                        tokens[j], page_cache->default_reads_account_.get());
+                }
+            });
+        }
+
+        for (size_t j = 0; j < batch_size; ++j) {
+            const block_id_t block_id = block_ids[i + j];
+            // If a current_page_t for the block exists, or existed at any point since
+            // we read the block token, the block might have changed.
+            if (bufs[j].has() && page_cache->current_pages_.count(block_id) == 0) {
+                page_cache->current_pages_[block_id] = new current_page_t(
+                    block_id, std::move(bufs[j]), tokens[j], page_cache);
+            }
+        }
+    }
+
+    --page_cache->warm_ups_in_progress_;
+    if (page_cache->warm_ups_in_progress_ == 0
+        && page_cache->read_ahead_cb_ == nullptr
+        && !lock.get_drain_signal()->is_pulsed()) {
+        consider_evicting_all_current_pages(page_cache, std::move(lock));
+    }
+}
+
 void page_cache_t::read_ahead_cb_is_destroyed() {
     assert_thread();
     read_ahead_cb_existence_.reset();
@@ -244,12 +336,15 @@ page_cache_t::page_cache_t(serializer_t *_serializer,
                            cache_balancer_t *balancer,
                            alt_txn_throttler_t *throttler)
     : max_block_size_(_serializer->max_block_size()),
+      num_active_asap_false_flushes_(0),
+      soft_durability_flush_requested_(false),
       serializer_(_serializer),
       // Start the counter at 1 so we can distinguish empty values.
       next_block_version_(block_version_t().subsequent()),
       free_list_(_serializer),
       evicter_(),
       read_ahead_cb_(nullptr),
+      warm_ups_in_progress_(0),
       drainer_(make_scoped<auto_drainer_t>()) {
 
     const bool start_read_ahead = balancer->read_ahead_ok_at_start();
@@ -338,9 +433,12 @@ void page_cache_t::begin_flush_pending_txns(bool asap, ticks_t soft_deadline) {
 }
 
 void page_cache_t::soft_durability_interval_flush(ticks_t soft_deadline) {
-    // We only start a soft durability flush if one isn't already running.
+    // We only start a soft durability flush if one isn't already running.  Otherwise
+    // the changes that came in since it started get flushed once it's done.
     if (num_active_asap_false_flushes_ == 0) {
         begin_flush_pending_txns(false, soft_deadline);
+    } else {
+        soft_durability_flush_requested_ = true;
     }
 }
 
@@ -573,7 +671,11 @@ current_page_acq_t::~current_page_acq_t() {
             snapshotted_page_.reset_page_ptr(page_cache_);
             current_page_->remove_keepalive();
         }
-        page_cache_->consider_evicting_current_page(block_id_);
+        // Most of the time the page is still loaded, and we can tell that without
+        // looking the block up in `current_pages_`.
+        if (current_page_->should_be_evicted()) {
+            page_cache_->consider_evicting_current_page(block_id_);
+        }
     }
 }
 
@@ -737,11 +839,15 @@ current_page_help_t current_page_acq_t::help() const {
 void current_page_acq_t::pulse_read_available() {
     assert_thread();
     read_cond_.pulse_if_not_already_pulsed();
+    if (access_ == access_t::read) {
+        wait_timer_.finish(lock_kind_t::page_acq);
+    }
 }
 
 void current_page_acq_t::pulse_write_available() {
     assert_thread();
     write_cond_.pulse_if_not_already_pulsed();
+    wait_timer_.finish(lock_kind_t::page_acq);
 }
 
 current_page_t::current_page_t(block_id_t block_id, page_cache_t *page_cache)
@@ -879,13 +985,32 @@ void current_page_t::add_acquirer(current_page_acq_t *acq) {
     } else {
         rassert(acq->the_txn_ == nullptr);
         acq->block_version_ = prev_version;
+
+        // The common case for reads:  There is no write acquirer in line, so the
+        // reader can have the page right away.  This is what `pulse_pulsables` would
+        // do, without looking at the rest of the queue.  (A new acquirer can't be
+        // declared snapshotted yet, so it stays in the queue.)
+        current_page_acq_t *const last = acquirers_.tail();
+        if (last == nullptr
+            || (last->access_ == access_t::read && last->read_cond_.is_pulsed())) {
+            rassert(!acq->declared_snapshotted_);
+            acquirers_.push_back(acq);
+            acq->pulse_read_available();
+            return;
+        }
     }
 
     acquirers_.push_back(acq);
     pulse_pulsables(acq);
+    if (!(acq->access_ == access_t::read
+          ? acq->read_cond_.is_pulsed()
+          : acq->write_cond_.is_pulsed())) {
+        acq->wait_timer_.start(lock_kind_t::page_acq, acquirers_.size() - 1);
+    }
 }
 
 void current_page_t::remove_acquirer(current_page_acq_t *acq) {
+    acq->wait_timer_.cancel();
     current_page_acq_t *next = acquirers_.next(acq);
     acquirers_.remove(acq);
     if (next != nullptr) {
@@ -1856,6 +1981,13 @@ void page_cache_t::do_flush_txn_set(
 
     page_cache->num_active_asap_false_flushes_ -= (asap ? 0 : 1);
 
+    if (page_cache->num_active_asap_false_flushes_ == 0
+        && page_cache->soft_durability_flush_requested_) {
+        page_cache->soft_durability_flush_requested_ = false;
+        // We're already late, so there's no point in smearing this one.
+        page_cache->begin_flush_pending_txns(false, ticks_t{0});
+    }
+
     // Flush complete.
     page_cache_t::pulse_flush_complete(std::move(coltx));
 }
@@ -19,6 +19,7 @@
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/cond_var.hpp"
 #include "concurrency/fifo_enforcer.hpp"
+#include "concurrency/lock_contention.hpp"
 #include "concurrency/new_semaphore.hpp"
 #include "containers/backindex_bag.hpp"
 #include "containers/intrusive_list.hpp"
@@ -293,6 +294,7 @@ private:
     timestamped_page_ptr_t snapshotted_page_;
     cond_t read_cond_;
     cond_t write_cond_;
+    lock_wait_timer_t wait_timer_;
 
     // The block version for our acquisition of the page -- every write acquirer sees
     // a greater block version than the previous acquirer.  The current page's block
@@ -442,7 +444,8 @@ public:
 
     // Begins to flush pending txn's.
     void begin_flush_pending_txns(bool asap, ticks_t soft_deadline /* 0 is okay */);
-    // Starts an official soft durability interval flush, if one isn't running already.
+    // Starts an official soft durability interval flush, or if one is running already,
+    // starts another once it's done.
     void soft_durability_interval_flush(ticks_t soft_deadline);
 
     // Takes a txn to be flushed.  Pulses on_complete_or_null when done.
@@ -482,6 +485,15 @@ public:
 
     void have_read_ahead_cb_destroyed();
 
+    // The blocks that are currently loaded, most recently used first.  This is what
+    // goes into a warm-up manifest.
+    std::vector<block_id_t> warm_block_ids() const;
+
+    // Reads the given blocks into the cache in the background, stopping early once
+    // the cache is full.  Blocks that have been loaded (or deleted) in the meantime
+    // are left alone.
+    void warm_up(std::vector<block_id_t> &&block_ids);
+
     evicter_t &evicter() { return evicter_; }
 
     auto_drainer_t::lock_t drainer_lock() { return drainer_->lock(); }
@@ -584,6 +596,10 @@ private:
     static void consider_evicting_all_current_pages(page_cache_t *page_cache,
                                                     auto_drainer_t::lock_t lock);
 
+    static void do_warm_up(page_cache_t *page_cache,
+                           const std::vector<block_id_t> &block_ids,
+                           auto_drainer_t::lock_t lock);
+
     // Returns next_block_version_ and increments it.
     block_version_t gen_block_version();
 
@@ -610,7 +626,11 @@ private:
     // than an ongoing write, the ongoing write becomes "asap" too.)
     state_timestamp_t ser_thread_max_asap_write_token_timestamp_;
     // Number of flushes started, not yet completed, that are asap=false.
-    bool num_active_asap_false_flushes_;
+    int64_t num_active_asap_false_flushes_;
+    // True if a soft durability interval flush was asked for while another one was
+    // still running.  It starts once the running flushes complete, so a slow flush
+    // doesn't stretch the window of unflushed writes to several intervals.
+    bool soft_durability_flush_requested_;
 
     scoped_ptr_t<page_cache_index_write_sink_t> index_write_sink_;
 
@@ -650,6 +670,11 @@ private:
     // destroyed and all possible read-ahead operations have completed.
     auto_drainer_t::lock_t read_ahead_cb_existence_;
 
+    // Like read-ahead, a warm-up uses the absence of a current_page_t to tell that
+    // the block it has read can't be out of date.  So as long as this is non-zero,
+    // we don't destroy any current_page_t's either.
+    int warm_ups_in_progress_;
+
     scoped_ptr_t<auto_drainer_t> drainer_;
 
     DISABLE_COPYING(page_cache_t);
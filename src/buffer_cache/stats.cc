@@ -11,7 +11,9 @@ alt_cache_stats_t::alt_cache_stats_t(alt::page_cache_t *_page_cache,
     in_use_bytes(this),
     in_use_bytes_membership(&cache_collection,
                             &in_use_bytes, "in_use_bytes"),
-    cache_collection_membership(&cache_collection) { }
+    cache_collection_membership(&cache_collection,
+                                &pm_reads_hit, "reads_hit",
+                                &pm_reads_missed, "reads_missed") { }
 
 alt_cache_stats_t::perfmon_value_t::perfmon_value_t(alt_cache_stats_t *_parent) :
     parent(_parent) { }
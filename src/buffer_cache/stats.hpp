@@ -28,6 +28,10 @@ public:
     perfmon_value_t in_use_bytes;
     perfmon_membership_t in_use_bytes_membership;
 
+    // Counts block reads by whether the block was already in memory.  See
+    // `buf_read_t::was_cached()`.
+    perfmon_counter_t pm_reads_hit;
+    perfmon_counter_t pm_reads_missed;
 
     perfmon_multi_membership_t cache_collection_membership;
 };
@@ -0,0 +1,105 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "buffer_cache/warm_up_manifest.hpp"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "arch/io/io_utils.hpp"
+#include "arch/runtime/thread_pool.hpp"
+#include "arch/types.hpp"
+#include "logger.hpp"
+#include "paths.hpp"
+#include "utils.hpp"
+
+// Identifies the file format.  The block ids follow in host byte order, because
+// the manifest never leaves the machine it was written on.
+static const char WARM_UP_MANIFEST_MAGIC[8] = { 'w', 'a', 'r', 'm', 'u', 'p', '0', '1' };
+
+static bool write_manifest_blocking(const std::string &path,
+                                    const std::vector<block_id_t> &block_ids,
+                                    std::string *error_out) {
+    std::string contents(WARM_UP_MANIFEST_MAGIC, sizeof(WARM_UP_MANIFEST_MAGIC));
+    contents.append(reinterpret_cast<const char *>(block_ids.data()),
+                    block_ids.size() * sizeof(block_id_t));
+
+    // We write to a temporary file first, so that a crash can't leave a truncated
+    // manifest behind.
+    const std::string tmp_path = path + ".tmp";
+    scoped_fd_t fd;
+    {
+        int res;
+        do {
+            res = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res == -1) {
+            *error_out = errno_string(get_errno());
+            return false;
+        }
+        fd.reset(res);
+    }
+    size_t written = 0;
+    while (written < contents.size()) {
+        ssize_t res;
+        do {
+            res = write(fd.get(), contents.data() + written, contents.size() - written);
+        } while (res == -1 && get_errno() == EINTR);
+        if (res == -1) {
+            *error_out = errno_string(get_errno());
+            unlink(tmp_path.c_str());
+            return false;
+        }
+        written += res;
+    }
+    fd.reset();
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        *error_out = errno_string(get_errno());
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void save_warm_up_manifest(const std::string &path,
+                           const std::vector<block_id_t> &block_ids) {
+    bool ok;
+    std::string error;
+    thread_pool_t::run_in_blocker_pool([&]() {
+        ok = write_manifest_blocking(path, block_ids, &error);
+    });
+    if (!ok) {
+        logWRN("Could not write cache warm-up manifest %s (%s).  The cache will "
+               "start out cold the next time this table is loaded.",
+               path.c_str(), error.c_str());
+    }
+}
+
+std::vector<block_id_t> take_warm_up_manifest(const std::string &path) {
+    bool found;
+    std::string contents;
+    thread_pool_t::run_in_blocker_pool([&]() {
+        found = blocking_read_file(path.c_str(), &contents);
+        if (found) {
+            unlink(path.c_str());
+        }
+    });
+
+    std::vector<block_id_t> block_ids;
+    if (!found) {
+        return block_ids;
+    }
+    if (contents.size() < sizeof(WARM_UP_MANIFEST_MAGIC)
+        || memcmp(contents.data(), WARM_UP_MANIFEST_MAGIC,
+                  sizeof(WARM_UP_MANIFEST_MAGIC)) != 0
+        || (contents.size() - sizeof(WARM_UP_MANIFEST_MAGIC))
+            % sizeof(block_id_t) != 0) {
+        logWRN("Ignoring invalid cache warm-up manifest %s.", path.c_str());
+        return block_ids;
+    }
+    block_ids.resize((contents.size() - sizeof(WARM_UP_MANIFEST_MAGIC))
+                     / sizeof(block_id_t));
+    memcpy(block_ids.data(), contents.data() + sizeof(WARM_UP_MANIFEST_MAGIC),
+           block_ids.size() * sizeof(block_id_t));
+    return block_ids;
+}
@@ -0,0 +1,28 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef BUFFER_CACHE_WARM_UP_MANIFEST_HPP_
+#define BUFFER_CACHE_WARM_UP_MANIFEST_HPP_
+
+#include <string>
+#include <vector>
+
+#include "serializer/types.hpp"
+
+/* A warm-up manifest lists the blocks that were in a cache when it was shut down,
+hottest first.  When the cache is created again, it reads those blocks back in the
+background (see `page_cache_t::warm_up()`), so that a restarted server doesn't have
+to fault its working set in one random read at a time.
+
+The manifest is only a hint.  Blocks that have been deleted or changed in the
+meantime are found out when they are read.  Both functions do their file i/o in the
+blocker pool and only log a warning if it fails. */
+
+// Writes `block_ids` to `path`, replacing any previous manifest.
+void save_warm_up_manifest(const std::string &path,
+                           const std::vector<block_id_t> &block_ids);
+
+// Reads the manifest at `path` and removes the file, so that the manifest can't
+// outlive the run that follows it.  Returns an empty vector if there is no
+// (valid) manifest.
+std::vector<block_id_t> take_warm_up_manifest(const std::string &path);
+
+#endif  // BUFFER_CACHE_WARM_UP_MANIFEST_HPP_
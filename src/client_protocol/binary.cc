@@ -0,0 +1,228 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "client_protocol/binary.hpp"
+
+#include <string.h>
+
+#include <cmath>
+
+#include "arch/io/network.hpp"
+#include "arch/runtime/coroutines.hpp"
+#include "client_protocol/protocols.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/error.hpp"
+#include "rdb_protocol/query_params.hpp"
+#include "rdb_protocol/rdb_backtrace.hpp"
+#include "rdb_protocol/response.hpp"
+#include "rdb_protocol/term_storage.hpp"
+
+// See `MIN_DATUM_RECURSION_STACK_SPACE` in `rdb_protocol/datum.cc`.
+static const size_t MIN_BINARY_WRITE_STACK_SPACE = 16 * KILOBYTE;
+
+enum class binary_tag_t : uint8_t {
+    NULL_VALUE = 0x00,
+    FALSE_VALUE = 0x01,
+    TRUE_VALUE = 0x02,
+    INTEGER = 0x03,
+    DOUBLE = 0x04,
+    STRING = 0x05,
+    ARRAY = 0x06,
+    OBJECT = 0x07,
+    END = 0x08,
+    BINARY = 0x09
+};
+
+static void write_tag(binary_tag_t tag, std::string *out) {
+    out->push_back(static_cast<char>(tag));
+}
+
+static void write_varint(uint64_t value, std::string *out) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+static void write_bytes(const char *data, size_t size, std::string *out) {
+    write_varint(size, out);
+    out->append(data, size);
+}
+
+static void write_integer(int64_t value, std::string *out) {
+    write_tag(binary_tag_t::INTEGER, out);
+    write_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63),
+                 out);
+}
+
+static void write_number(double d, std::string *out) {
+    // Like `datum_t::write_json()`, we send integers as such, except for -0.0.
+    int64_t i;
+    if (!(d == 0.0 && std::signbit(d)) && ql::number_as_integer(d, &i)) {
+        write_integer(i, out);
+        return;
+    }
+    write_tag(binary_tag_t::DOUBLE, out);
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(d), "double must be 64 bits");
+    memcpy(&bits, &d, sizeof(bits));
+    for (int shift = 0; shift < 64; shift += 8) {
+        out->push_back(static_cast<char>((bits >> shift) & 0xff));
+    }
+}
+
+static void write_string(binary_tag_t tag, const datum_string_t &str, std::string *out) {
+    write_tag(tag, out);
+    write_bytes(str.data(), str.size(), out);
+}
+
+void binary_protocol_t::write_datum(const ql::datum_t &datum, std::string *out) {
+    switch (datum.get_type()) {
+    case ql::datum_t::MINVAL:
+        rfail_datum(ql::base_exc_t::LOGIC, "Cannot send `r.minval` to a client.");
+    case ql::datum_t::MAXVAL:
+        rfail_datum(ql::base_exc_t::LOGIC, "Cannot send `r.maxval` to a client.");
+    case ql::datum_t::R_NULL:
+        write_tag(binary_tag_t::NULL_VALUE, out);
+        break;
+    case ql::datum_t::R_BOOL:
+        write_tag(datum.as_bool() ? binary_tag_t::TRUE_VALUE : binary_tag_t::FALSE_VALUE,
+                  out);
+        break;
+    case ql::datum_t::R_NUM:
+        write_number(datum.as_num(), out);
+        break;
+    case ql::datum_t::R_STR:
+        write_string(binary_tag_t::STRING, datum.as_str(), out);
+        break;
+    case ql::datum_t::R_BINARY:
+        write_string(binary_tag_t::BINARY, datum.as_binary(), out);
+        break;
+    case ql::datum_t::R_ARRAY:
+        write_tag(binary_tag_t::ARRAY, out);
+        call_with_enough_stack([&]() {
+            const size_t sz = datum.arr_size();
+            for (size_t i = 0; i < sz; ++i) {
+                write_datum(datum.get(i), out);
+            }
+        }, MIN_BINARY_WRITE_STACK_SPACE);
+        write_tag(binary_tag_t::END, out);
+        break;
+    case ql::datum_t::R_OBJECT:
+        write_tag(binary_tag_t::OBJECT, out);
+        call_with_enough_stack([&]() {
+            const size_t sz = datum.obj_size();
+            for (size_t i = 0; i < sz; ++i) {
+                auto pair = datum.get_pair(i);
+                write_bytes(pair.first.data(), pair.first.size(), out);
+                write_datum(pair.second, out);
+            }
+        }, MIN_BINARY_WRITE_STACK_SPACE);
+        write_tag(binary_tag_t::END, out);
+        break;
+    case ql::datum_t::UNINITIALIZED: // fallthru
+    default:
+        unreachable();
+    }
+}
+
+static void write_key(const char *key, std::string *out) {
+    write_bytes(key, strlen(key), out);
+}
+
+static void write_response_payload(ql::response_t *response, std::string *out) {
+    write_tag(binary_tag_t::OBJECT, out);
+    write_key("t", out);
+    write_integer(response->type(), out);
+    if (response->type() == Response::RUNTIME_ERROR && response->error_type()) {
+        write_key("e", out);
+        write_integer(*response->error_type(), out);
+    }
+    write_key("r", out);
+    write_tag(binary_tag_t::ARRAY, out);
+    for (const auto &item : response->data()) {
+        binary_protocol_t::write_datum(item, out);
+    }
+    write_tag(binary_tag_t::END, out);
+    if (response->backtrace()) {
+        write_key("b", out);
+        binary_protocol_t::write_datum(*response->backtrace(), out);
+    }
+    if (response->profile()) {
+        write_key("p", out);
+        binary_protocol_t::write_datum(*response->profile(), out);
+    }
+    if (response->type() == Response::SUCCESS_PARTIAL ||
+        response->type() == Response::SUCCESS_SEQUENCE) {
+        write_key("n", out);
+        write_tag(binary_tag_t::ARRAY, out);
+        for (const auto &note : response->notes()) {
+            write_integer(note, out);
+        }
+        write_tag(binary_tag_t::END, out);
+    }
+    write_tag(binary_tag_t::END, out);
+}
+
+void binary_protocol_t::write_response(ql::response_t *response,
+                                       int64_t token,
+                                       std::string *out) {
+    const size_t prefix_size = sizeof(int64_t) + sizeof(uint32_t);
+    out->assign(prefix_size, '\0');
+    try {
+        write_response_payload(response, out);
+    } catch (const ql::base_exc_t &ex) {
+        out->resize(prefix_size);
+        response->fill_error(Response::RUNTIME_ERROR, Response::QUERY_LOGIC,
+                             ex.what(), ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        write_response_payload(response, out);
+    }
+
+    const size_t payload_size = out->size() - prefix_size;
+    if (payload_size >= wire_protocol_t::TOO_LARGE_RESPONSE_SIZE) {
+        response->fill_error(Response::RUNTIME_ERROR,
+                             Response::RESOURCE_LIMIT,
+                             wire_protocol_t::too_large_response_message(payload_size),
+                             ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        write_response(response, token, out);
+        return;
+    }
+
+    // The token and the size are little-endian, like in `json_protocol_t`.
+    const uint64_t utoken = static_cast<uint64_t>(token);
+    for (size_t i = 0; i < sizeof(utoken); ++i) {
+        (*out)[i] = static_cast<char>((utoken >> (8 * i)) & 0xff);
+    }
+    const uint32_t usize = static_cast<uint32_t>(payload_size);
+    for (size_t i = 0; i < sizeof(usize); ++i) {
+        (*out)[sizeof(utoken) + i] = static_cast<char>((usize >> (8 * i)) & 0xff);
+    }
+}
+
+scoped_ptr_t<ql::query_params_t> binary_protocol_t::parse_query(
+        tcp_conn_t *conn,
+        signal_t *interruptor,
+        ql::query_cache_t *query_cache) {
+    return json_protocol_t::parse_query(conn, interruptor, query_cache);
+}
+
+void binary_protocol_t::send_response(ql::response_t *response,
+                                      int64_t token,
+                                      tcp_conn_t *conn,
+                                      signal_t *interruptor) {
+    std::string buffer;
+    write_response(response, token, &buffer);
+    conn->write(buffer.data(), buffer.size(), interruptor);
+}
+
+void binary_protocol_t::send_response_buffered(ql::response_t *response,
+                                               int64_t token,
+                                               tcp_conn_t *conn,
+                                               signal_t *interruptor) {
+    std::string buffer;
+    write_response(response, token, &buffer);
+    if (buffer.size() <= json_protocol_t::MAX_BUFFERED_RESPONSE_SIZE) {
+        conn->write_buffered(buffer.data(), buffer.size(), interruptor);
+    } else {
+        conn->write(buffer.data(), buffer.size(), interruptor);
+    }
+}
@@ -0,0 +1,61 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLIENT_PROTOCOL_BINARY_HPP_
+#define CLIENT_PROTOCOL_BINARY_HPP_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "client_protocol/json.hpp"
+
+namespace ql {
+class datum_t;
+}
+
+/* The binary wire protocol, which clients get by asking for `protocol_version` 1 in
+the V1_0 handshake.  Queries are the same JSON as in `json_protocol_t`, because they
+are small and the server doesn't spend much time parsing them.  Responses keep the
+same framing (an 8 byte token and a 4 byte little-endian size), but the payload is
+the response object in the following binary encoding instead of JSON:
+
+    0x00                          null
+    0x01 / 0x02                   false / true
+    0x03 <varint>                 a number that is an integer, zigzag-encoded
+    0x04 <8 bytes>                any other number, as a little-endian IEEE double
+    0x05 <varint n> <n bytes>     a UTF-8 string
+    0x06 <values...> 0x08         an array
+    0x07 <keys and values...> 0x08  an object; each key is <varint n> <n bytes>
+    0x09 <varint n> <n bytes>     binary data (`r.binary`), not base64-encoded
+
+Varints are unsigned LEB128.  Other pseudotypes, like times and geometry, are
+objects with a `$reql_type$` field, the same as in JSON.  Numbers don't go through
+decimal conversions, strings need no escaping, and binary data isn't inflated by
+base64, so responses are smaller and cheaper to produce. */
+class binary_protocol_t {
+public:
+    static scoped_ptr_t<ql::query_params_t> parse_query(tcp_conn_t *conn,
+                                                        signal_t *interruptor,
+                                                        ql::query_cache_t *query_cache);
+
+    static void send_response(ql::response_t *response,
+                              int64_t token,
+                              tcp_conn_t *conn,
+                              signal_t *interruptor);
+
+    // See `json_protocol_t::send_response_buffered()`.
+    static void send_response_buffered(ql::response_t *response,
+                                       int64_t token,
+                                       tcp_conn_t *conn,
+                                       signal_t *interruptor);
+
+    // Appends the binary encoding of `datum` to `out`.  Throws `ql::base_exc_t` for
+    // datums that can't be sent to a client, like `r.minval`.
+    static void write_datum(const ql::datum_t &datum, std::string *out);
+
+    // Serializes `response` with its framing, replacing the contents of `out`.
+    static void write_response(ql::response_t *response,
+                               int64_t token,
+                               std::string *out);
+};
+
+#endif  // CLIENT_PROTOCOL_BINARY_HPP_
@@ -1,6 +1,8 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "client_protocol/json.hpp"
 
+#include <string.h>
+
 #include "arch/io/network.hpp"
 #include "arch/timing.hpp"
 #include "client_protocol/protocols.hpp"
@@ -11,6 +13,7 @@
 #include "rapidjson/writer.h"
 #include "rdb_protocol/rdb_backtrace.hpp"
 #include "rdb_protocol/ql2proto.hpp"
+#include "rdb_protocol/query_cache.hpp"
 #include "rdb_protocol/query_params.hpp"
 #include "rdb_protocol/response.hpp"
 #include "rdb_protocol/term_storage.hpp"
@@ -20,6 +23,14 @@ scoped_ptr_t<ql::query_params_t> json_protocol_t::parse_query_from_buffer(
         scoped_array_t<char> &&buffer, size_t offset,
         ql::query_cache_t *query_cache, int64_t token,
         ql::response_t *error_out) {
+    // Small queries are likely to be repeated, so we keep their text around as a
+    // key for the query cache's compiled queries.  Parsing in-situ destroys it.
+    optional<std::string> query_text;
+    const size_t query_size = strlen(buffer.data() + offset);
+    if (query_size <= ql::query_cache_t::MAX_COMPILED_QUERY_SIZE) {
+        query_text.set(std::string(buffer.data() + offset, query_size));
+    }
+
     rapidjson::Document doc;
     doc.ParseInsitu(buffer.data() + offset);
 
@@ -28,7 +39,9 @@ scoped_ptr_t<ql::query_params_t> json_protocol_t::parse_query_from_buffer(
         try {
             res = make_scoped<ql::query_params_t>(token, query_cache,
                     scoped_ptr_t<ql::term_storage_t>(
-                        new ql::json_term_storage_t(std::move(buffer), std::move(doc))));
+                        new ql::json_term_storage_t(std::move(buffer),
+                                                    std::move(doc),
+                                                    std::move(query_text))));
         } catch (const ql::bt_exc_t &ex) {
             error_out->fill_error(Response::CLIENT_ERROR,
                                   ex.error_type,
@@ -201,19 +214,19 @@ void json_protocol_t::write_response_to_buffer(ql::response_t *response,
 #endif
 }
 
-void json_protocol_t::send_response(ql::response_t *response,
-                                    int64_t token,
-                                    tcp_conn_t *conn,
-                                    signal_t *interruptor) {
+// Serializes `response` together with the token and size prefix into `buffer`, which
+// must be empty.
+static void serialize_response(ql::response_t *response,
+                               int64_t token,
+                               rapidjson::StringBuffer *buffer) {
     uint32_t data_size; // filled in below
     const size_t prefix_size = sizeof(token) + sizeof(data_size);
 
     // Reserve space for the token and the size
-    rapidjson::StringBuffer buffer;
-    buffer.Push(prefix_size);
+    buffer->Push(prefix_size);
 
-    write_response_to_buffer(response, &buffer);
-    int64_t payload_size = buffer.GetSize() - prefix_size;
+    json_protocol_t::write_response_to_buffer(response, buffer);
+    int64_t payload_size = buffer->GetSize() - prefix_size;
     guarantee(payload_size > 0);
 
     static_assert(std::is_same<decltype(wire_protocol_t::TOO_LARGE_RESPONSE_SIZE),
@@ -225,12 +238,13 @@ void json_protocol_t::send_response(ql::response_t *response,
                              Response::RESOURCE_LIMIT,
                              wire_protocol_t::too_large_response_message(payload_size),
                              ql::backtrace_registry_t::EMPTY_BACKTRACE);
-        send_response(response, token, conn, interruptor);
+        buffer->Clear();
+        serialize_response(response, token, buffer);
         return;
     }
 
     // Fill in the token and size
-    char *mutable_buffer = buffer.GetMutableBuffer();
+    char *mutable_buffer = buffer->GetMutableBuffer();
 #ifdef __s390x__
     token = __builtin_bswap64(token);
 #endif
@@ -246,7 +260,30 @@ void json_protocol_t::send_response(ql::response_t *response,
         mutable_buffer[i + sizeof(token)] =
             reinterpret_cast<const char *>(&data_size)[i];
     }
+}
 
+void json_protocol_t::send_response(ql::response_t *response,
+                                    int64_t token,
+                                    tcp_conn_t *conn,
+                                    signal_t *interruptor) {
+    rapidjson::StringBuffer buffer;
+    serialize_response(response, token, &buffer);
     conn->write(buffer.GetString(), buffer.GetSize(), interruptor);
 }
 
+void json_protocol_t::send_response_buffered(ql::response_t *response,
+                                             int64_t token,
+                                             tcp_conn_t *conn,
+                                             signal_t *interruptor) {
+    rapidjson::StringBuffer buffer;
+    serialize_response(response, token, &buffer);
+    if (buffer.GetSize() <= MAX_BUFFERED_RESPONSE_SIZE) {
+        conn->write_buffered(buffer.GetString(), buffer.GetSize(), interruptor);
+    } else {
+        // Copying a large response into the write buffer would cost more than the
+        // extra system call that we save.  `write()` sends whatever is buffered
+        // first.
+        conn->write(buffer.GetString(), buffer.GetSize(), interruptor);
+    }
+}
+
@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "arch/types.hpp"
+#include "config/args.hpp"
 #include "containers/scoped.hpp"
 #include "rapidjson/stringbuffer.h"
 
@@ -37,6 +38,16 @@ public:
                               int64_t token,
                               tcp_conn_t *conn,
                               signal_t *interruptor);
+
+    // Like `send_response()`, but a small response only goes into the connection's
+    // write buffer, so that the responses to pipelined queries can share a write.
+    // The caller must flush the buffer eventually.
+    static void send_response_buffered(ql::response_t *response,
+                                       int64_t token,
+                                       tcp_conn_t *conn,
+                                       signal_t *interruptor);
+
+    static const size_t MAX_BUFFERED_RESPONSE_SIZE = 16 * KILOBYTE;
 };
 
 #endif // CLIENT_PROTOCOL_JSON_HPP_
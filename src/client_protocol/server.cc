@@ -18,6 +18,7 @@
 
 #include "arch/arch.hpp"
 #include "arch/io/network.hpp"
+#include "client_protocol/binary.hpp"
 #include "client_protocol/client_server_error.hpp"
 #include "client_protocol/protocols.hpp"
 #include "clustering/administration/auth/authentication_error.hpp"
@@ -197,8 +198,12 @@ query_server_t::query_server_t(rdb_context_t *_rdb_ctx,
         rdb_ctx(_rdb_ctx),
         handler(_handler),
         http_conn_cache(http_timeout_sec),
+        connections_per_thread(get_num_db_threads()),
         next_thread(0) {
     rassert(rdb_ctx != nullptr);
+    for (auto &&count : connections_per_thread) {
+        count.value.store(0);
+    }
     try {
         tcp_listener.init(new tcp_listener_t(local_addresses, port,
             std::bind(&query_server_t::handle_conn,
@@ -211,6 +216,22 @@ query_server_t::query_server_t(rdb_context_t *_rdb_ctx,
 
 query_server_t::~query_server_t() { }
 
+query_server_t::user_query_slots_t *query_server_t::get_user_query_slots(
+        const auth::username_t &username) {
+    // The admin user is exempt, so that an operator can always get in to find and
+    // stop the queries that are hogging the server.
+    if (rdb_ctx->max_concurrent_queries_per_user == 0 || username.is_admin()) {
+        return nullptr;
+    }
+    spinlock_acq_t acq(&user_query_slots_lock);
+    scoped_ptr_t<user_query_slots_t> *slots = &user_query_slots[username];
+    if (!slots->has()) {
+        slots->init(new user_query_slots_t(
+            static_cast<size_t>(rdb_ctx->max_concurrent_queries_per_user)));
+    }
+    return slots->get();
+}
+
 int query_server_t::get_port() const {
     return tcp_listener->get_port();
 }
@@ -250,10 +271,40 @@ ql::datum_t read_datum(tcp_conn_t *connection, signal_t *interruptor) {
     }
 }
 
+threadnum_t query_server_t::choose_thread() {
+    // Among the threads with the fewest connections we still go round-robin, so
+    // that an even spread stays even.
+    const int num_threads = get_num_db_threads();
+    int chosen = next_thread;
+    int64_t chosen_count = connections_per_thread[chosen].value.load();
+    for (int i = 1; i < num_threads && chosen_count != 0; ++i) {
+        const int thread = (next_thread + i) % num_threads;
+        const int64_t count = connections_per_thread[thread].value.load();
+        if (count < chosen_count) {
+            chosen = thread;
+            chosen_count = count;
+        }
+    }
+    next_thread = (chosen + 1) % num_threads;
+    ++connections_per_thread[chosen].value;
+    return threadnum_t(chosen);
+}
+
+/* Takes a client connection off the count of the thread it was handled on. */
+class thread_connection_count_t {
+public:
+    explicit thread_connection_count_t(std::atomic<int64_t> *count) : count_(count) { }
+    ~thread_connection_count_t() { --*count_; }
+private:
+    std::atomic<int64_t> *count_;
+    DISABLE_COPYING(thread_connection_count_t);
+};
+
 void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn,
                                  auto_drainer_t::lock_t keepalive) {
-    threadnum_t chosen_thread = threadnum_t(next_thread);
-    next_thread = (next_thread + 1) % get_num_db_threads();
+    threadnum_t chosen_thread = choose_thread();
+    thread_connection_count_t connection_count(
+        &connections_per_thread[chosen_thread.threadnum].value);
 
     cross_thread_signal_t ct_keepalive(keepalive.get_drain_signal(), chosen_thread);
     on_thread_t rethreader(chosen_thread);
@@ -272,6 +323,7 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
     }
 
     uint8_t version = 0;
+    bool binary_responses = false;
     std::unique_ptr<auth::base_authenticator_t> authenticator;
     uint32_t error_code = 0;
     std::string error_message;
@@ -367,7 +419,8 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
             {
                 ql::datum_object_builder_t datum_object_builder;
                 datum_object_builder.overwrite("success", ql::datum_t::boolean(true));
-                datum_object_builder.overwrite("max_protocol_version", ql::datum_t(0.0));
+                // Protocol version 1 has binary responses, see `binary_protocol_t`.
+                datum_object_builder.overwrite("max_protocol_version", ql::datum_t(1.0));
                 datum_object_builder.overwrite("min_protocol_version", ql::datum_t(0.0));
                 datum_object_builder.overwrite(
                     "server_version", ql::datum_t(RETHINKDB_VERSION));
@@ -387,7 +440,9 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
                     throw client_protocol::client_server_error_t(
                         1, "Expected a number for `protocol_version`.");
                 }
-                if (protocol_version.as_num() != 0.0) {
+                if (protocol_version.as_num() == 1.0) {
+                    binary_responses = true;
+                } else if (protocol_version.as_num() != 0.0) {
                     throw client_protocol::client_server_error_t(
                         2, "Unsupported `protocol_version`.");
                 }
@@ -451,21 +506,26 @@ void query_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &ncon
         UNUSED bool peer_res = conn->getpeername(&client_addr_port);
 
         guarantee(authenticator != nullptr);
+        auth::username_t username = authenticator->get_authenticated_username();
         ql::query_cache_t query_cache(
             rdb_ctx,
             client_addr_port,
             (version < 4)
                 ? ql::return_empty_normal_batches_t::YES
                 : ql::return_empty_normal_batches_t::NO,
-            auth::user_context_t(authenticator->get_authenticated_username()));
-
-        connection_loop<json_protocol_t>(
-            conn.get(),
-            (version < 4)
-                ? 1
-                : 1024,
-            &query_cache,
-            &ct_keepalive);
+            auth::user_context_t(username));
+
+        const size_t max_concurrent_queries = (version < 4) ? 1 : 1024;
+        user_query_slots_t *user_slots = get_user_query_slots(username);
+        if (binary_responses) {
+            connection_loop<binary_protocol_t>(
+                conn.get(), max_concurrent_queries, user_slots, &query_cache,
+                &ct_keepalive);
+        } else {
+            connection_loop<json_protocol_t>(
+                conn.get(), max_concurrent_queries, user_slots, &query_cache,
+                &ct_keepalive);
+        }
     } catch (client_protocol::client_server_error_t const &error) {
         // We can't write the response here due to coroutine switching inside an
         // exception handler
@@ -562,6 +622,7 @@ void save_exception(std::exception_ptr *err,
 template <class protocol_t>
 void query_server_t::connection_loop(tcp_conn_t *conn,
                                      size_t max_concurrent_queries,
+                                     user_query_slots_t *user_query_slots,
                                      ql::query_cache_t *query_cache,
                                      signal_t *drain_signal) {
     std::exception_ptr err;
@@ -579,6 +640,10 @@ void query_server_t::connection_loop(tcp_conn_t *conn,
 #endif  // __linux
 
     new_semaphore_t sem(max_concurrent_queries);
+    // The number of query coroutines that are about to send a response.  While
+    // there are more to come, a response is only buffered; the last one out flushes
+    // them all, so that pipelined responses share their system calls and packets.
+    int64_t responses_to_send = 0;
     auto_drainer_t coro_drainer;
     while (!err) {
         scoped_ptr_t<ql::query_params_t> outer_query =
@@ -587,22 +652,47 @@ void query_server_t::connection_loop(tcp_conn_t *conn,
             outer_query->throttler.init(&sem, 1);
             wait_interruptible(outer_query->throttler.acquisition_signal(),
                                &interruptor);
+            // Only new queries count against the user's limit.  `CONTINUE` and
+            // `STOP` must get through, or a user whose slots are all taken by
+            // changefeeds waiting for changes could never stop them.
+            scoped_ptr_t<user_query_slots_t::lock_t> outer_user_slot;
+            if (user_query_slots != nullptr && outer_query->type == Query::START) {
+                outer_user_slot.init(
+                    new user_query_slots_t::lock_t(user_query_slots, &interruptor));
+            }
             coro_t::spawn_now_dangerously([&]() {
-                // We grab this right away while it's still valid.
+                // We grab these right away while they're still valid.
                 scoped_ptr_t<ql::query_params_t> query = std::move(outer_query);
+                scoped_ptr_t<user_query_slots_t::lock_t> user_slot =
+                    std::move(outer_user_slot);
                 // Since we `spawn_now_dangerously` it's always safe to acquire this.
                 auto_drainer_t::lock_t coro_drainer_lock(&coro_drainer);
                 wait_any_t cb_interruptor(coro_drainer_lock.get_drain_signal(),
                                           &interruptor);
+                with_priority_t p(CORO_PRIORITY_CLIENT_QUERY);
                 ql::response_t response;
                 bool replied = false;
 
                 save_exception(&err, &err_str, &abort, [&]() {
                     handler->run_query(query.get(), &response, &cb_interruptor);
+                    user_slot.reset();
                     if (!query->noreply) {
-                        new_mutex_acq_t send_lock(&send_mutex, &cb_interruptor);
-                        protocol_t::send_response(&response, query->token,
-                                                  conn, &cb_interruptor);
+                        ++responses_to_send;
+                        bool counted = true;
+                        try {
+                            new_mutex_acq_t send_lock(&send_mutex, &cb_interruptor);
+                            protocol_t::send_response_buffered(
+                                &response, query->token, conn, &cb_interruptor);
+                            counted = false;
+                            if (--responses_to_send == 0) {
+                                conn->flush_buffer_eventually(&cb_interruptor);
+                            }
+                        } catch (...) {
+                            if (counted) {
+                                --responses_to_send;
+                            }
+                            throw;
+                        }
                         replied = true;
                     }
                 });
@@ -703,54 +793,107 @@ void query_server_t::handle(const http_req_t &req,
                 return;
             }
 
-            wait_any_t true_interruptor(interruptor, conn->get_interruptor(),
-                                        drainer.get_drain_signal());
+            run_http_query(conn, query.get(), &response, interruptor);
+        }
+    }
 
-            try {
-                ticks_t start = get_ticks();
-                // We don't throttle HTTP queries.
-                handler->run_query(query.get(), &response, &true_interruptor);
-                ticks_t ticks = ticks_t{get_ticks().nanos - start.nanos};
-
-                if (!response.profile()) {
-                    ql::datum_array_builder_t array_builder(
-                        ql::configured_limits_t::unlimited);
-                    ql::datum_object_builder_t object_builder;
-                    object_builder.overwrite("duration(ms)",
-                        ql::datum_t(static_cast<double>(ticks.nanos) / MILLION));
-                    array_builder.add(std::move(object_builder).to_datum());
-                    response.set_profile(std::move(array_builder).to_datum());
+    std::string body_data = serialize_http_response(token, &response);
+
+    /* With `stream=true` the remaining batches of a sequence are sent as further
+    chunks of the same response, so the client doesn't need a round trip (and we don't
+    need a connection cache lookup) per batch.  Chunked encoding needs HTTP/1.1. */
+    if (conn.has()
+        && response.type() == Response::SUCCESS_PARTIAL
+        && req.find_query_param("stream")
+        && req.version == "1.1") {
+        result->set_body_stream("application/octet-stream",
+            [this, conn, token, auto_drainer_lock, first = std::move(body_data)](
+                    std::string *chunk_out, signal_t *stream_interruptor) mutable {
+                if (!first.empty()) {
+                    chunk_out->swap(first);
+                    return true;
                 }
-            } catch (const interrupted_exc_t &ex) {
-                if (http_conn_cache.is_expired(*conn)) {
-                    response.fill_error(Response::RUNTIME_ERROR,
-                                        Response::OP_INDETERMINATE,
-                                        http_conn_cache.expired_error_message(),
-                                        ql::backtrace_registry_t::EMPTY_BACKTRACE);
-                } else if (interruptor->is_pulsed()) {
-                    response.fill_error(Response::RUNTIME_ERROR,
-                                        Response::OP_INDETERMINATE,
-                                        "This ReQL connection has been terminated.",
-                                        ql::backtrace_registry_t::EMPTY_BACKTRACE);
-                } else if (drainer.is_draining()) {
-                    response.fill_error(Response::RUNTIME_ERROR,
-                                        Response::OP_INDETERMINATE,
-                                        "Server is shutting down.",
-                                        ql::backtrace_registry_t::EMPTY_BACKTRACE);
-                } else if (conn->get_interruptor()->is_pulsed()) {
-                    response.fill_error(Response::RUNTIME_ERROR,
-                                        Response::OP_INDETERMINATE,
-                                        "This ReQL connection has been terminated.",
-                                        ql::backtrace_registry_t::EMPTY_BACKTRACE);
-                } else {
-                    throw;
+
+                ql::response_t next;
+                std::string continue_text = strprintf("[%d]", Query::CONTINUE);
+                scoped_array_t<char> continue_buf(continue_text.size() + 1);
+                memcpy(continue_buf.data(), continue_text.c_str(),
+                       continue_text.size() + 1);
+                scoped_ptr_t<ql::query_params_t> query =
+                    json_protocol_t::parse_query_from_buffer(std::move(continue_buf),
+                                                             0,
+                                                             conn->get_query_cache(),
+                                                             token,
+                                                             &next);
+                if (query.has()) {
+                    run_http_query(conn, query.get(), &next, stream_interruptor);
                 }
-            }
+                *chunk_out = serialize_http_response(token, &next);
+                return next.type() == Response::SUCCESS_PARTIAL;
+            });
+        result->code = http_status_code_t::OK;
+        return;
+    }
+
+    result->set_body("application/octet-stream", body_data);
+    result->code = http_status_code_t::OK;
+}
+
+void query_server_t::run_http_query(
+        const counted_t<http_conn_cache_t::http_conn_t> &conn,
+        ql::query_params_t *query,
+        ql::response_t *response,
+        signal_t *interruptor) {
+    wait_any_t true_interruptor(interruptor, conn->get_interruptor(),
+                                drainer.get_drain_signal());
+
+    try {
+        with_priority_t p(CORO_PRIORITY_CLIENT_QUERY);
+        ticks_t start = get_ticks();
+        // We don't throttle HTTP queries.
+        handler->run_query(query, response, &true_interruptor);
+        ticks_t ticks = ticks_t{get_ticks().nanos - start.nanos};
+
+        if (!response->profile()) {
+            ql::datum_array_builder_t array_builder(
+                ql::configured_limits_t::unlimited);
+            ql::datum_object_builder_t object_builder;
+            object_builder.overwrite("duration(ms)",
+                ql::datum_t(static_cast<double>(ticks.nanos) / MILLION));
+            array_builder.add(std::move(object_builder).to_datum());
+            response->set_profile(std::move(array_builder).to_datum());
+        }
+    } catch (const interrupted_exc_t &ex) {
+        if (http_conn_cache.is_expired(*conn)) {
+            response->fill_error(Response::RUNTIME_ERROR,
+                                 Response::OP_INDETERMINATE,
+                                 http_conn_cache.expired_error_message(),
+                                 ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        } else if (interruptor->is_pulsed()) {
+            response->fill_error(Response::RUNTIME_ERROR,
+                                 Response::OP_INDETERMINATE,
+                                 "This ReQL connection has been terminated.",
+                                 ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        } else if (drainer.is_draining()) {
+            response->fill_error(Response::RUNTIME_ERROR,
+                                 Response::OP_INDETERMINATE,
+                                 "Server is shutting down.",
+                                 ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        } else if (conn->get_interruptor()->is_pulsed()) {
+            response->fill_error(Response::RUNTIME_ERROR,
+                                 Response::OP_INDETERMINATE,
+                                 "This ReQL connection has been terminated.",
+                                 ql::backtrace_registry_t::EMPTY_BACKTRACE);
+        } else {
+            throw;
         }
     }
+}
 
+std::string query_server_t::serialize_http_response(int64_t token,
+                                                    ql::response_t *response) {
     rapidjson::StringBuffer buffer;
-    json_protocol_t::write_response_to_buffer(&response, &buffer);
+    json_protocol_t::write_response_to_buffer(response, &buffer);
 
     uint32_t size = static_cast<uint32_t>(buffer.GetSize());
 #ifdef __s390x__
@@ -765,6 +908,5 @@ void query_server_t::handle(const http_req_t &req,
     body_data.reserve(sizeof(header_buffer) + buffer.GetSize());
     body_data.append(&header_buffer[0], sizeof(header_buffer));
     body_data.append(buffer.GetString(), buffer.GetSize());
-    result->set_body("application/octet-stream", body_data);
-    result->code = http_status_code_t::OK;
+    return body_data;
 }
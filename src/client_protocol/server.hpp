@@ -2,6 +2,7 @@
 #ifndef CLIENT_PROTOCOL_SERVER_HPP_
 #define CLIENT_PROTOCOL_SERVER_HPP_
 
+#include <atomic>
 #include <set>
 #include <map>
 #include <memory>
@@ -13,8 +14,12 @@
 #include "arch/address.hpp"
 #include "arch/io/openssl.hpp"
 #include "arch/runtime/runtime.hpp"
+#include "arch/spinlock.hpp"
 #include "arch/timing.hpp"
+#include "clustering/administration/auth/username.hpp"
 #include "concurrency/auto_drainer.hpp"
+#include "concurrency/cache_line_padded.hpp"
+#include "concurrency/cross_thread_semaphore.hpp"
 #include "concurrency/cross_thread_signal.hpp"
 #include "containers/archive/archive.hpp"
 #include "containers/counted.hpp"
@@ -109,11 +114,24 @@ public:
     int get_port() const;
 
 private:
+    // Each query that a limited user starts holds one of these until it has returned
+    // its first batch, see `--max-concurrent-queries-per-user`.
+    class user_query_slot_t { };
+    typedef cross_thread_semaphore_t<user_query_slot_t> user_query_slots_t;
+
+    // Returns the slots shared by all of `username`'s connections to this server, or
+    // `nullptr` if the user's queries aren't limited.
+    user_query_slots_t *get_user_query_slots(const auth::username_t &username);
+
     void make_error_response(bool is_draining,
                              const tcp_conn_t &conn,
                              const std::string &err,
                              ql::response_t *response_out);
 
+    // Picks the thread that a new client connection will be handled on, and counts
+    // the connection towards it.
+    threadnum_t choose_thread();
+
     // For the client driver socket
     void handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn,
                      auto_drainer_t::lock_t);
@@ -122,6 +140,7 @@ private:
     template<class protocol_t>
     void connection_loop(tcp_conn_t *conn,
                          size_t max_concurrent_queries,
+                         user_query_slots_t *user_query_slots,
                          ql::query_cache_t *query_cache,
                          signal_t *interruptor);
 
@@ -129,16 +148,34 @@ private:
     void handle(const http_req_t &request,
                 http_res_t *result,
                 signal_t *interruptor);
+    void run_http_query(const counted_t<http_conn_cache_t::http_conn_t> &conn,
+                        ql::query_params_t *query,
+                        ql::response_t *response,
+                        signal_t *interruptor);
+    static std::string serialize_http_response(int64_t token,
+                                               ql::response_t *response);
 
     tls_ctx_t *tls_ctx;
     rdb_context_t *const rdb_ctx;
     query_handler_t *const handler;
 
+    // Connections can be on any thread, so the slots are shared between threads.
+    // Entries are never removed.  They are declared before `drainer` so that they
+    // outlive the connections that use them.
+    spinlock_t user_query_slots_lock;
+    std::map<auth::username_t, scoped_ptr_t<user_query_slots_t> > user_query_slots;
+
     /* WARNING: The order here is fragile. */
     auto_drainer_t drainer;
     http_conn_cache_t http_conn_cache;
     scoped_ptr_t<tcp_listener_t> tcp_listener;
 
+    // The number of open client connections on each thread.  A connection's
+    // coroutines stay on the thread that it was given, so instead of balancing
+    // work after the fact we always give new connections to the threads with the
+    // fewest.  They are only read and incremented on the listener's thread, but
+    // decremented on the connection's thread.
+    std::vector<cache_line_padded_t<std::atomic<int64_t> > > connections_per_thread;
     int next_thread;
 };
 
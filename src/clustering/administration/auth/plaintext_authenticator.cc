@@ -3,12 +3,55 @@
 
 #include "clustering/administration/auth/authentication_error.hpp"
 #include "clustering/administration/metadata.hpp"
+#include "containers/lru_cache.hpp"
 #include "crypto/compare_equal.hpp"
+#include "crypto/hmac.hpp"
 #include "crypto/pbkcs5_pbkdf2_hmac.hpp"
+#include "crypto/random.hpp"
 #include "crypto/saslprep.hpp"
+#include "thread_local.hpp"
 
 namespace auth {
 
+namespace {
+
+/* Deriving the hash takes `iteration_count` rounds of HMAC, which adds up when a
+client reconnects a lot.  So every thread remembers the passwords it has recently
+accepted.  We don't keep the passwords themselves, only an HMAC of them under a
+random key that never leaves the process, together with the salt and hash they were
+checked against, so changing the password invalidates the entry. */
+struct verified_password_t {
+    std::array<unsigned char, password_t::salt_length> salt;
+    uint32_t iteration_count;
+    std::array<unsigned char, SHA256_DIGEST_LENGTH> hash;
+    std::array<unsigned char, SHA256_DIGEST_LENGTH> password_digest;
+};
+
+class verified_passwords_t {
+public:
+    static const size_t max_size = 64;
+
+    verified_passwords_t()
+        : key(crypto::random_bytes<SHA256_DIGEST_LENGTH>()),
+          entries(max_size) { }
+
+    std::array<unsigned char, SHA256_DIGEST_LENGTH> key;
+    lru_cache_t<std::string, verified_password_t> entries;
+};
+
+TLS_with_init(verified_passwords_t *, verified_passwords, nullptr);
+
+verified_passwords_t *get_verified_passwords() {
+    verified_passwords_t *verified = TLS_get_verified_passwords();
+    if (verified == nullptr) {
+        verified = new verified_passwords_t();
+        TLS_set_verified_passwords(verified);
+    }
+    return verified;
+}
+
+}  // namespace
+
 plaintext_authenticator_t::plaintext_authenticator_t(
         clone_ptr_t<watchable_t<auth_semilattice_metadata_t>> auth_watchable,
         username_t const &username)
@@ -34,14 +77,38 @@ plaintext_authenticator_t::plaintext_authenticator_t(
         throw authentication_error_t(17, "Unknown user");
     }
 
-    std::array<unsigned char, SHA256_DIGEST_LENGTH> hash =
-        crypto::pbkcs5_pbkdf2_hmac_sha256(
-            crypto::saslprep(password),
-            user->get_password().get_salt(),
-            user->get_password().get_iteration_count());
+    password_t const &stored = user->get_password();
+    std::string prepared_password = crypto::saslprep(password);
+
+    verified_passwords_t *verified = get_verified_passwords();
+    std::array<unsigned char, SHA256_DIGEST_LENGTH> password_digest =
+        crypto::hmac_sha256(verified->key, prepared_password);
+    verified_password_t *entry;
+    if (!verified->entries.lookup(m_username.to_string(), &entry)
+            || entry->iteration_count != stored.get_iteration_count()
+            || entry->salt != stored.get_salt()
+            || entry->hash != stored.get_hash()
+            || !crypto::compare_equal(entry->password_digest, password_digest)) {
+        std::array<unsigned char, SHA256_DIGEST_LENGTH> hash =
+            crypto::pbkcs5_pbkdf2_hmac_sha256(
+                prepared_password,
+                stored.get_salt(),
+                stored.get_iteration_count());
+
+        if (!crypto::compare_equal(stored.get_hash(), hash)) {
+            throw authentication_error_t(12, "Wrong password");
+        }
 
-    if (!crypto::compare_equal(user->get_password().get_hash(), hash)) {
-        throw authentication_error_t(12, "Wrong password");
+        verified_password_t accepted;
+        accepted.salt = stored.get_salt();
+        accepted.iteration_count = stored.get_iteration_count();
+        accepted.hash = stored.get_hash();
+        accepted.password_digest = password_digest;
+        if (entry != nullptr) {
+            *entry = accepted;
+        } else {
+            verified->entries.insert(m_username.to_string(), accepted);
+        }
     }
 
     m_is_authenticated = true;
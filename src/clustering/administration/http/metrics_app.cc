@@ -0,0 +1,70 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "clustering/administration/http/metrics_app.hpp"
+
+#include <ctype.h>
+
+#include "perfmon/collect.hpp"
+#include "utils.hpp"
+
+void metrics_http_app_t::handle(const http_req_t &req,
+                                http_res_t *result,
+                                UNUSED signal_t *interruptor) {
+    if (req.method != http_method_t::GET) {
+        *result = http_res_t(http_status_code_t::METHOD_NOT_ALLOWED);
+        return;
+    }
+
+    std::set<std::string> seen;
+    std::string body;
+    format_stats(perfmon_get_stats(), "rethinkdb", &seen, &body);
+    body += "# EOF\n";
+
+    *result = http_res_t(http_status_code_t::OK,
+                         "application/openmetrics-text; version=1.0.0; charset=utf-8",
+                         body);
+    maybe_gzip_response(req, result);
+}
+
+void metrics_http_app_t::format_stats(const ql::datum_t &stats,
+                                      const std::string &prefix,
+                                      std::set<std::string> *seen,
+                                      std::string *out) {
+    double value;
+    switch (stats.get_type()) {
+    case ql::datum_t::R_OBJECT:
+        for (size_t i = 0; i < stats.obj_size(); ++i) {
+            std::pair<datum_string_t, ql::datum_t> pair = stats.get_pair(i);
+            // Metric names may only contain `[a-zA-Z0-9_:]`, but perfmon names
+            // contain dashes, dots and the like.
+            std::string name = prefix + "_";
+            for (char c : pair.first.to_std()) {
+                name += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+            }
+            format_stats(pair.second, name, seen, out);
+        }
+        return;
+    case ql::datum_t::R_NUM:
+        value = stats.as_num();
+        break;
+    case ql::datum_t::R_BOOL:
+        value = stats.as_bool() ? 1 : 0;
+        break;
+    case ql::datum_t::UNINITIALIZED: // fallthru
+    case ql::datum_t::R_ARRAY: // fallthru
+    case ql::datum_t::R_BINARY: // fallthru
+    case ql::datum_t::R_NULL: // fallthru
+    case ql::datum_t::R_STR: // fallthru
+    case ql::datum_t::MINVAL: // fallthru
+    case ql::datum_t::MAXVAL: // fallthru
+    default:
+        return;
+    }
+
+    // Every metric family may only appear once, so if two perfmon paths end up
+    // with the same name we only export the first one.
+    if (!seen->insert(prefix).second) {
+        return;
+    }
+    *out += strprintf("# TYPE %s gauge\n%s %.17g\n",
+                      prefix.c_str(), prefix.c_str(), value);
+}
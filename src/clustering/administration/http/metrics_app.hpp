@@ -0,0 +1,26 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_ADMINISTRATION_HTTP_METRICS_APP_HPP_
+#define CLUSTERING_ADMINISTRATION_HTTP_METRICS_APP_HPP_
+
+#include <set>
+#include <string>
+
+#include "http/http.hpp"
+#include "rdb_protocol/datum.hpp"
+
+/* This is an `http_app_t` that exports this server's perfmons in the OpenMetrics
+ * text format, so that they can be scraped without running ReQL queries against
+ * `rethinkdb.stats`. Every numeric stat becomes a gauge whose name is the path to
+ * the stat in the perfmon tree. */
+class metrics_http_app_t : public http_app_t {
+public:
+    void handle(const http_req_t &req, http_res_t *result, signal_t *interruptor);
+
+private:
+    static void format_stats(const ql::datum_t &stats,
+                             const std::string &prefix,
+                             std::set<std::string> *seen,
+                             std::string *out);
+};
+
+#endif /* CLUSTERING_ADMINISTRATION_HTTP_METRICS_APP_HPP_ */
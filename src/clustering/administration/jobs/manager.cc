@@ -100,7 +100,13 @@ void jobs_manager_t::on_get_job_reports(
                         server_id,
                         query_cache->get_client_addr_port(),
                         std::move(render),
-                        query_cache->get_user_context());
+                        query_cache->get_user_context(),
+                        pair.second->get_server_micros(),
+                        pair.second->rows_returned,
+                        pair.second->batches_served,
+                        pair.second->read_ahead_batch.has_value()
+                            ? pair.second->read_ahead_batch->size()
+                            : 0);
                 }
             }
         }
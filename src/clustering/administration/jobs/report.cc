@@ -227,11 +227,19 @@ query_job_report_t::query_job_report_t(
         server_id_t const &_server_id,
         ip_and_port_t const &_client_addr_port,
         std::string const &_query,
-        auth::user_context_t const &_user_context)
+        auth::user_context_t const &_user_context,
+        double _server_time,
+        int64_t _rows_returned,
+        int64_t _batches_served,
+        int64_t _buffered_rows)
     : job_report_base_t<query_job_report_t>("query", _id, _duration, _server_id),
       client_addr_port(_client_addr_port),
       query(_query),
-      user_context(_user_context) { }
+      user_context(_user_context),
+      server_time(_server_time),
+      rows_returned(_rows_returned),
+      batches_served(_batches_served),
+      buffered_rows(_buffered_rows) { }
 
 void query_job_report_t::merge_derived(query_job_report_t const &) { }
 
@@ -248,12 +256,30 @@ bool query_job_report_t::info_derived(
     info_builder_out->overwrite("query", convert_string_to_datum(query));
     info_builder_out->overwrite(
         "user", convert_string_to_datum(user_context.to_string()));
+    info_builder_out->overwrite("server_time_sec", ql::datum_t(server_time / 1e6));
+    info_builder_out->overwrite(
+        "rows_returned", ql::datum_t(static_cast<double>(rows_returned)));
+    info_builder_out->overwrite(
+        "batches_served", ql::datum_t(static_cast<double>(batches_served)));
+    info_builder_out->overwrite(
+        "buffered_rows", ql::datum_t(static_cast<double>(buffered_rows)));
 
     return true;
 }
 
-RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
-    query_job_report_t, type, id, duration, servers, client_addr_port, query, user_context);
+RDB_IMPL_SERIALIZABLE_11_FOR_CLUSTER(
+    query_job_report_t,
+    type,
+    id,
+    duration,
+    servers,
+    client_addr_port,
+    query,
+    user_context,
+    server_time,
+    rows_returned,
+    batches_served,
+    buffered_rows);
 
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(jobs_manager_business_card_t,
                                     get_job_reports_mailbox_address,
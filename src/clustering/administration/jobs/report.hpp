@@ -140,7 +140,11 @@ public:
             server_id_t const &server_id,
             ip_and_port_t const &client_addr_port,
             std::string const &query,
-            auth::user_context_t const &user_context);
+            auth::user_context_t const &user_context,
+            double server_time,
+            int64_t rows_returned,
+            int64_t batches_served,
+            int64_t buffered_rows);
 
     void merge_derived(query_job_report_t const &job_report);
 
@@ -154,6 +158,12 @@ public:
     ip_and_port_t client_addr_port;
     std::string query;
     auth::user_context_t user_context;
+    // What the query has cost so far, `server_time` is in microseconds like
+    // `duration`.  `buffered_rows` are read ahead but not yet sent to the client.
+    double server_time;
+    int64_t rows_returned;
+    int64_t batches_served;
+    int64_t buffered_rows;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(query_job_report_t);
 
@@ -235,6 +235,119 @@ bool get_proc_meminfo_available_memory_size(uint64_t *mem_avail_out) {
     return parse_meminfo_file(contents, mem_avail_out);
 }
 
+#if !defined(_WIN32)
+// Reads a cgroup file that holds a single number.  "max" (cgroup v2) and the huge
+// values that cgroup v1 uses mean that there's no limit, which we report as false.
+bool read_cgroup_number(const char *path, uint64_t *value_out) {
+    std::string contents;
+    bool ok;
+    thread_pool_t::run_in_blocker_pool([&]() {
+        ok = blocking_read_file(path, &contents);
+    });
+    if (!ok) {
+        return false;
+    }
+    while (!contents.empty() && contents.back() == '\n') {
+        contents.pop_back();
+    }
+    if (!strtou64_strict(contents, 10, value_out)) {
+        return false;
+    }
+    return *value_out < get_max_total_cache_size();
+}
+
+// Finds `name` in a memory.stat file.
+bool parse_cgroup_memory_stat(const std::string &contents, const std::string &name,
+                              uint64_t *value_out) {
+    size_t line_begin = 0;
+    while (line_begin < contents.size()) {
+        size_t line_end = contents.find('\n', line_begin);
+        if (line_end == std::string::npos) {
+            line_end = contents.size();
+        }
+        const std::string line = contents.substr(line_begin, line_end - line_begin);
+        if (line.compare(0, name.size() + 1, name + " ") == 0) {
+            return strtou64_strict(line.substr(name.size() + 1), 10, value_out);
+        }
+        line_begin = line_end + 1;
+    }
+    return false;
+}
+
+/* The memory that our cgroup can still use before it hits its limit.  The kernel can
+reclaim inactive file pages, so like `docker stats` we don't count them as used. */
+bool get_cgroup_available_memory(uint64_t *mem_avail_out) {
+    struct cgroup_files_t {
+        const char *limit;
+        const char *usage;
+        const char *stat;
+        const char *inactive_file;
+    };
+    static const cgroup_files_t versions[] = {
+        { "/sys/fs/cgroup/memory.max",
+          "/sys/fs/cgroup/memory.current",
+          "/sys/fs/cgroup/memory.stat",
+          "inactive_file" },
+        { "/sys/fs/cgroup/memory/memory.limit_in_bytes",
+          "/sys/fs/cgroup/memory/memory.usage_in_bytes",
+          "/sys/fs/cgroup/memory/memory.stat",
+          "total_inactive_file" } };
+    for (const cgroup_files_t &files : versions) {
+        uint64_t limit, usage;
+        if (!read_cgroup_number(files.limit, &limit)
+            || !read_cgroup_number(files.usage, &usage)) {
+            continue;
+        }
+        std::string stat;
+        bool ok;
+        thread_pool_t::run_in_blocker_pool([&]() {
+            ok = blocking_read_file(files.stat, &stat);
+        });
+        uint64_t inactive_file;
+        if (ok && parse_cgroup_memory_stat(stat, files.inactive_file, &inactive_file)) {
+            usage -= std::min(usage, inactive_file);
+        }
+        *mem_avail_out = limit - std::min(limit, usage);
+        return true;
+    }
+    return false;
+}
+
+// Parses the "some avg10=..." line of a pressure stall information file.
+bool parse_pressure_file(const std::string &contents, double *avg10_out) {
+    const std::string prefix = "some avg10=";
+    if (contents.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    const size_t end = contents.find(' ', prefix.size());
+    if (end == std::string::npos) {
+        return false;
+    }
+    const std::string number = contents.substr(prefix.size(), end - prefix.size());
+    char *number_end;
+    *avg10_out = strtod(number.c_str(), &number_end);
+    return number_end != number.c_str() && *number_end == '\0';
+}
+
+bool get_memory_pressure(double *pressure_out) {
+    // Our own cgroup's pressure if we're in a container, the whole host's otherwise.
+    static const char *const paths[] = {
+        "/sys/fs/cgroup/memory.pressure",
+        "/proc/pressure/memory" };
+    for (const char *path : paths) {
+        std::string contents;
+        bool ok;
+        thread_pool_t::run_in_blocker_pool([&]() {
+            ok = blocking_read_file(path, &contents);
+        });
+        if (ok && parse_pressure_file(contents, pressure_out)) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 #endif  // __MACH_
 
 #if defined(__MACH__)
@@ -313,16 +426,20 @@ uint64_t get_avail_mem_size() {
 	uint64_t page_size = sysconf(_SC_PAGESIZE);
 	{
         uint64_t memory;
-        if (get_proc_meminfo_available_memory_size(&memory)) {
-            return memory;
-        } else {
+        if (!get_proc_meminfo_available_memory_size(&memory)) {
             logERR("Could not parse /proc/meminfo, so we will treat cached file memory "
                 "as if it were unavailable.");
 
             // This just returns what /proc/meminfo would report as "MemFree".
             uint64_t avail_mem_pages = sysconf(_SC_AVPHYS_PAGES);
-            return avail_mem_pages * page_size;
+            memory = avail_mem_pages * page_size;
+        }
+        // In a container, the host's memory isn't all ours to use.
+        uint64_t cgroup_memory;
+        if (get_cgroup_available_memory(&cgroup_memory)) {
+            memory = std::min(memory, cgroup_memory);
         }
+        return memory;
     }
 #endif
 }
@@ -355,6 +472,42 @@ uint64_t get_default_total_cache_size() {
     return res;
 }
 
+uint64_t get_adjusted_total_cache_size(uint64_t current) {
+    const uint64_t min_size = 100 * MEGABYTE;
+    // What we leave to the server's other needs and the rest of the system.  Like
+    // the default, we only hand half of the memory beyond that to the cache.
+    const uint64_t reserve = GIGABYTE;
+    // If tasks were stalled waiting for memory for this percentage of the last ten
+    // seconds, the system is short on memory.
+    const double pressure_threshold = 10.0;
+
+    uint64_t target = current;
+#if !defined(__MACH__) && !defined(_WIN32)
+    double pressure;
+    if (get_memory_pressure(&pressure) && pressure >= pressure_threshold) {
+        // Back off quickly, it's better to lose some cache hits than the server.
+        return std::max(min_size, current - current / 4);
+    }
+#endif
+    const uint64_t available = get_avail_mem_size();
+    if (available < reserve / 2) {
+        // The cache itself is part of the used memory, so shrinking it gives back
+        // what we're short of.
+        target = current - std::min(current, reserve / 2 - available);
+    } else if (available > reserve) {
+        // Grow in steps, so that other processes get a chance to claim the memory
+        // too and we don't overshoot.
+        const uint64_t grow_by = std::min<uint64_t>(
+            (available - reserve) / DEFAULT_MAX_CACHE_RATIO,
+            current / 4 + 64 * MEGABYTE);
+        // Small changes aren't worth resizing the caches for.
+        if (grow_by >= current / 20) {
+            target = current + grow_by;
+        }
+    }
+    return std::min(std::max(target, min_size), get_max_total_cache_size());
+}
+
 void log_warnings_for_cache_size(uint64_t bytes) {
     const uint64_t available_memory = get_avail_mem_size();
     if (bytes > available_memory) {
@@ -7,6 +7,10 @@
 
 uint64_t get_max_total_cache_size();
 uint64_t get_default_total_cache_size();
+/* Where to take an automatically sized cache next: shrinks it when the system is
+under memory pressure or running out of memory (taking cgroup limits into account),
+and grows it when there's memory to spare.  Must be called in a coroutine. */
+uint64_t get_adjusted_total_cache_size(uint64_t current);
 void log_warnings_for_cache_size(uint64_t);
 
 #endif  // CLUSTERING_ADMINISTRATION_MAIN_CACHE_SIZE_HPP_
@@ -481,6 +481,71 @@ optional<int> parse_node_reconnect_timeout_secs_option(
     return optional<int>();
 }
 
+int parse_backfill_latency_target_ms_option(
+        const std::map<std::string, options::values_t> &opts) {
+    if (exists_option(opts, "--backfill-latency-target")) {
+        const std::string target_opt = get_single_option(opts, "--backfill-latency-target");
+        uint64_t target_ms;
+        if (!strtou64_strict(target_opt, 10, &target_ms)) {
+            throw std::runtime_error(strprintf(
+                    "ERROR: backfill-latency-target should be a number, got '%s'",
+                    target_opt.c_str()));
+        }
+        if (target_ms > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error(strprintf(
+                "ERROR: backfill-latency-target is too large. Must be at most %d",
+                std::numeric_limits<int>::max()));
+        }
+        return static_cast<int>(target_ms);
+    }
+
+    return 0;
+}
+
+int parse_slow_query_log_threshold_ms_option(
+        const std::map<std::string, options::values_t> &opts) {
+    if (exists_option(opts, "--slow-query-log-threshold")) {
+        const std::string threshold_opt =
+            get_single_option(opts, "--slow-query-log-threshold");
+        uint64_t threshold_ms;
+        if (!strtou64_strict(threshold_opt, 10, &threshold_ms)) {
+            throw std::runtime_error(strprintf(
+                    "ERROR: slow-query-log-threshold should be a number, got '%s'",
+                    threshold_opt.c_str()));
+        }
+        if (threshold_ms > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error(strprintf(
+                "ERROR: slow-query-log-threshold is too large. Must be at most %d",
+                std::numeric_limits<int>::max()));
+        }
+        return static_cast<int>(threshold_ms);
+    }
+
+    return 0;
+}
+
+int64_t parse_max_concurrent_queries_per_user_option(
+        const std::map<std::string, options::values_t> &opts) {
+    if (exists_option(opts, "--max-concurrent-queries-per-user")) {
+        const std::string limit_opt =
+            get_single_option(opts, "--max-concurrent-queries-per-user");
+        uint64_t limit;
+        if (!strtou64_strict(limit_opt, 10, &limit) || limit == 0) {
+            throw std::runtime_error(strprintf(
+                    "ERROR: max-concurrent-queries-per-user should be a positive "
+                    "number, got '%s'", limit_opt.c_str()));
+        }
+        if (limit > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error(strprintf(
+                "ERROR: max-concurrent-queries-per-user is too large. Must be at "
+                "most %d", std::numeric_limits<int>::max()));
+        }
+        return static_cast<int64_t>(limit);
+    }
+
+    return 0;
+}
+
 /* An empty outer `optional` means the `--cache-size` parameter is not present. An
 empty inner `optional` means the cache size is set to `auto`. */
 optional<optional<uint64_t> > parse_total_cache_size_option(
@@ -888,6 +953,13 @@ bool initialize_tls_ctx(
         tls_ctx_out->get(),
         SSL_OP_CIPHER_SERVER_PREFERENCE|SSL_OP_SINGLE_DH_USE|SSL_OP_SINGLE_ECDH_USE);
 
+#ifdef SSL_OP_ENABLE_KTLS
+    // Let OpenSSL hand record encryption over to the kernel after the handshake.
+    // That saves a copy of every record we send. OpenSSL silently carries on in
+    // user space if the kernel or the negotiated cipher doesn't support it.
+    SSL_CTX_set_options(tls_ctx_out->get(), SSL_OP_ENABLE_KTLS);
+#endif
+
     /* This is pretty important. We want to use the most secure TLS cipher
     suite that we can. Our default list only allows ciphers suites which employ
     ECDHE (Elliptic Curve Diffie-Hellman with Ephemeral keys) for encryption
@@ -1045,6 +1117,7 @@ void run_rethinkdb_create(const base_path_t &base_path,
                           optional<uint64_t> total_cache_size,
                           const file_direct_io_mode_t direct_io_mode,
                           const int max_concurrent_io_requests,
+                          const disk_backend_t disk_backend,
                           bool *const result_out) {
     server_id_t our_server_id = server_id_t::generate_server_id();
 
@@ -1058,7 +1131,7 @@ void run_rethinkdb_create(const base_path_t &base_path,
     server_config.config.cache_size_bytes = total_cache_size;
     server_config.version = 1;
 
-    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests);
+    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests, disk_backend);
 
     perfmon_collection_t metadata_perfmon_collection;
     perfmon_membership_t metadata_perfmon_membership(&get_global_perfmon_collection(), &metadata_perfmon_collection, "metadata");
@@ -1139,6 +1212,7 @@ void run_rethinkdb_serve(const base_path_t &base_path,
                          const std::string &initial_password,
                          const file_direct_io_mode_t direct_io_mode,
                          const int max_concurrent_io_requests,
+                         const disk_backend_t disk_backend,
                          const optional<optional<uint64_t> >
                             &total_cache_size,
                          const server_id_t *our_server_id,
@@ -1156,7 +1230,7 @@ void run_rethinkdb_serve(const base_path_t &base_path,
 
     logNTC("Loading data from directory %s\n", base_path.path().c_str());
 
-    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests);
+    io_backender_t io_backender(direct_io_mode, max_concurrent_io_requests, disk_backend);
 
     perfmon_collection_t metadata_perfmon_collection;
     perfmon_membership_t metadata_perfmon_membership(&get_global_perfmon_collection(), &metadata_perfmon_collection, "metadata");
@@ -1284,6 +1358,7 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
                              const std::string &initial_password,
                              const file_direct_io_mode_t direct_io_mode,
                              const int max_concurrent_io_requests,
+                             const disk_backend_t disk_backend,
                              const optional<optional<uint64_t> >
                                 &total_cache_size,
                              const bool new_directory,
@@ -1292,7 +1367,7 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
                              bool *const result_out) {
     if (!new_directory) {
         run_rethinkdb_serve(base_path, serve_info, initial_password, direct_io_mode,
-                            max_concurrent_io_requests, total_cache_size,
+                            max_concurrent_io_requests, disk_backend, total_cache_size,
                             nullptr, nullptr, nullptr, data_directory_lock,
                             result_out);
     } else {
@@ -1328,7 +1403,7 @@ void run_rethinkdb_porcelain(const base_path_t &base_path,
         server_config.version = 1;
 
         run_rethinkdb_serve(base_path, serve_info, initial_password, direct_io_mode,
-                            max_concurrent_io_requests,
+                            max_concurrent_io_requests, disk_backend,
                             optional<optional<uint64_t> >(),
                             &our_server_id, &server_config, &cluster_metadata,
                             data_directory_lock, result_out);
@@ -1368,6 +1443,12 @@ options::help_section_t get_server_options(std::vector<options::option_t> *optio
     help.add("-t [ --server-tag ] arg",
              "a tag for this server. Can be specified multiple times.");
 
+    options_out->push_back(options::option_t(options::names_t("--backfill-latency-target"),
+                                             options::OPTIONAL));
+    help.add("--backfill-latency-target ms",
+             "slow down backfills into this server while its 99th percentile query "
+             "latency is above this many milliseconds. Disabled if not specified.");
+
     return help;
 }
 
@@ -1380,6 +1461,13 @@ options::help_section_t get_auth_options(std::vector<options::option_t> *options
              "sets an initial password for the \"admin\" user on a new server.  If set "
              "to auto, a random password will be generated.");
 
+    options_out->push_back(options::option_t(
+        options::names_t("--max-concurrent-queries-per-user"), options::OPTIONAL));
+    help.add("--max-concurrent-queries-per-user n",
+             "start at most this many queries at once for each user other than "
+             "\"admin\" on this server.  Further queries wait until one of the "
+             "running ones returns its first batch.  Unlimited if not specified.");
+
     return help;
 }
 
@@ -1392,6 +1480,11 @@ options::help_section_t get_log_options(std::vector<options::option_t> *options_
                                             options::OPTIONAL_NO_PARAMETER));
     help.add("--no-update-check", "disable checking for available updates.  Also turns "
              "off anonymous usage data collection.");
+    options_out->push_back(options::option_t(options::names_t("--slow-query-log-threshold"),
+                                             options::OPTIONAL));
+    help.add("--slow-query-log-threshold ms",
+             "log queries that keep the server busy for longer than this many "
+             "milliseconds. Disabled if not specified.");
     return help;
 }
 
@@ -1407,6 +1500,14 @@ options::help_section_t get_file_options(std::vector<options::option_t> *options
                                              strprintf("%d", DEFAULT_MAX_CONCURRENT_IO_REQUESTS)));
     help.add("--io-threads n",
              "how many simultaneous I/O operations can happen at the same time");
+    options_out->push_back(options::option_t(options::names_t("--io-backend"),
+                                             options::OPTIONAL,
+                                             "pool"));
+#ifdef __linux__
+    help.add("--io-backend {pool | io_uring}",
+             "how to submit disk I/O: on a pool of blocking threads, or through "
+             "io_uring");
+#endif
 #ifndef _WIN32
     // TODO WINDOWS: accept this option, but error out if it is passed
     options_out->push_back(options::option_t(options::names_t("--direct-io"),
@@ -1887,6 +1988,20 @@ MUST_USE bool parse_io_threads_option(const std::map<std::string, options::value
     return true;
 }
 
+MUST_USE bool parse_io_backend_option(const std::map<std::string, options::values_t> &opts,
+                                      disk_backend_t *disk_backend_out) {
+    const std::string backend = get_single_option(opts, "--io-backend");
+    if (backend == "pool") {
+        *disk_backend_out = disk_backend_t::blocker_pool;
+    } else if (backend == "io_uring") {
+        *disk_backend_out = disk_backend_t::io_uring;
+    } else {
+        fprintf(stderr, "ERROR: io-backend must be either 'pool' or 'io_uring'\n");
+        return false;
+    }
+    return true;
+}
+
 update_check_t parse_update_checking_option(const std::map<std::string, options::values_t> &opts) {
     return exists_option(opts, "--no-update-check")
         ? update_check_t::do_not_perform
@@ -1929,6 +2044,11 @@ int main_rethinkdb_create(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        disk_backend_t disk_backend;
+        if (!parse_io_backend_option(opts, &disk_backend)) {
+            return EXIT_FAILURE;
+        }
+
         const int num_workers = get_cpu_count();
 
         bool is_new_directory = false;
@@ -1958,6 +2078,7 @@ int main_rethinkdb_create(int argc, char *argv[]) {
                                      total_cache_size,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     disk_backend,
                                      &result),
                            num_workers);
 
@@ -2057,6 +2178,11 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        disk_backend_t disk_backend;
+        if (!parse_io_backend_option(opts, &disk_backend)) {
+            return EXIT_FAILURE;
+        }
+
         update_check_t do_update_checking = parse_update_checking_option(opts);
 
         optional<optional<uint64_t> > total_cache_size =
@@ -2065,6 +2191,12 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
         optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
         optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
+        const int backfill_latency_target_ms =
+            parse_backfill_latency_target_ms_option(opts);
+        const int slow_query_log_threshold_ms =
+            parse_slow_query_log_threshold_ms_option(opts);
+        const int64_t max_concurrent_queries_per_user =
+            parse_max_concurrent_queries_per_user_option(opts);
 
         // Open and lock the directory, but do not create it
         bool is_new_directory = false;
@@ -2107,6 +2239,9 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                 std::vector<std::string>(argv, argv + argc),
                                 join_delay_secs.value_or(0),
                                 node_reconnect_timeout_secs.value_or(cluster_defaults::reconnect_timeout),
+                                backfill_latency_target_ms,
+                                slow_query_log_threshold_ms,
+                                max_concurrent_queries_per_user,
                                 tls_configs);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
@@ -2118,6 +2253,7 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                      initial_password,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     disk_backend,
                                      total_cache_size,
                                      static_cast<server_id_t*>(nullptr),
                                      static_cast<server_config_versioned_t *>(nullptr),
@@ -2210,6 +2346,9 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
                                 std::vector<std::string>(argv, argv + argc),
                                 join_delay_secs.value_or(0),
                                 node_reconnect_timeout_secs.value_or(cluster_defaults::reconnect_timeout),
+                                0,
+                                parse_slow_query_log_threshold_ms_option(opts),
+                                parse_max_concurrent_queries_per_user_option(opts),
                                 tls_configs);
 
         bool result;
@@ -2328,11 +2467,22 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
+        disk_backend_t disk_backend;
+        if (!parse_io_backend_option(opts, &disk_backend)) {
+            return EXIT_FAILURE;
+        }
+
         update_check_t do_update_checking = parse_update_checking_option(opts);
 
         optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
         optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
+        const int backfill_latency_target_ms =
+            parse_backfill_latency_target_ms_option(opts);
+        const int slow_query_log_threshold_ms =
+            parse_slow_query_log_threshold_ms_option(opts);
+        const int64_t max_concurrent_queries_per_user =
+            parse_max_concurrent_queries_per_user_option(opts);
 
         // Attempt to create the directory early so that the log file can use it.
         // If we create the file, it will be cleaned up unless directory_initialized()
@@ -2400,6 +2550,9 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                 std::vector<std::string>(argv, argv + argc),
                                 join_delay_secs.value_or(0),
                                 node_reconnect_timeout_secs.value_or(cluster_defaults::reconnect_timeout),
+                                backfill_latency_target_ms,
+                                slow_query_log_threshold_ms,
+                                max_concurrent_queries_per_user,
                                 tls_configs);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
@@ -2412,6 +2565,7 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                      initial_password,
                                      direct_io_mode,
                                      max_concurrent_io_requests,
+                                     disk_backend,
                                      total_cache_size,
                                      is_new_directory,
                                      &serve_info,
@@ -1,6 +1,7 @@
 // Copyright 2010-2016 RethinkDB, all rights reserved.
 #include "clustering/administration/main/memory_checker.hpp"
 
+#include <inttypes.h>
 #include <math.h>
 #ifndef _WIN32
 #include <sys/resource.h>
@@ -9,6 +10,8 @@
 #include "clustering/administration/metadata.hpp"
 #include "clustering/table_manager/table_meta_client.hpp"
 #include "logger.hpp"
+#include "memory_accounting.hpp"
+#include "perfmon/perfmon.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/pseudo_time.hpp"
 
@@ -17,11 +20,37 @@ static const int64_t reset_checks = 10;
 
 static const int64_t practice_runs = 2;
 
+ql::datum_t tagged_memory_perfmon_t::end_stats(void *) {
+    ql::datum_object_builder_t builder;
+    for (int i = 0; i < NUM_MEMORY_TAGS; ++i) {
+        memory_tag_t tag = static_cast<memory_tag_t>(i);
+        builder.overwrite(memory_tag_name(tag),
+                          ql::datum_t(static_cast<double>(get_tagged_memory(tag))));
+    }
+    return std::move(builder).to_datum();
+}
+
+// For example "page_cache 1024 MB, lba_index 12 MB, coroutine_stacks 64 MB".
+static std::string describe_tagged_memory() {
+    std::string res;
+    for (int i = 0; i < NUM_MEMORY_TAGS; ++i) {
+        memory_tag_t tag = static_cast<memory_tag_t>(i);
+        res += strprintf("%s%s %" PRIi64 " MB",
+                         i == 0 ? "" : ", ",
+                         memory_tag_name(tag),
+                         get_tagged_memory(tag) / MEGABYTE);
+    }
+    return res;
+}
+
 memory_checker_t::memory_checker_t() :
     checks_until_reset(0),
     swap_usage(0),
     print_log_message(true),
     practice_runs_remaining(practice_runs),
+    tagged_memory_membership(&get_global_perfmon_collection(),
+                             &tagged_memory_perfmon,
+                             "memory"),
     timer(delay_time, this)
 {
     coro_t::spawn_sometime(std::bind(&memory_checker_t::do_check,
@@ -50,13 +79,13 @@ void memory_checker_t::do_check(UNUSED auto_drainer_t::lock_t keepalive) {
 
     const std::string error_message =
         "RethinkDB has been accessing a lot of swap memory in the past ten"
-        " minutes. This may impact performace.";
+        " minutes. This may impact performace. Memory held by subsystem: "
+        + describe_tagged_memory() + ".";
 
     if (new_swap_usage > swap_usage + 200 && practice_runs_remaining == 0) {
         // We've started using more swap
         if (print_log_message) {
-            logWRN("RethinkDB has been accessing a lot of swap memory in the past ten"
-                   " minutes. This may impact performace.");
+            logWRN("%s", error_message.c_str());
 
             print_log_message = false;
         }
@@ -9,13 +9,24 @@
 #include "clustering/administration/issues/memory.hpp"
 #include "clustering/administration/main/cache_size.hpp"
 #include "concurrency/auto_drainer.hpp"
+#include "perfmon/core.hpp"
 #include "rdb_protocol/context.hpp"
 
 class table_meta_client_t;
 
+// Reports the memory held by each subsystem (see `memory_accounting.hpp`) in the
+// stats, so that they can be watched continuously.
+class tagged_memory_perfmon_t : public perfmon_t {
+public:
+    void *begin_stats() { return nullptr; }
+    void visit_stats(void *) { }
+    ql::datum_t end_stats(void *);
+};
+
 // memory_checker_t is created in serve.cc, and calls a repeating timer to
 // Periodically check if we're using swap by looking at the proc file or system calls.
 // If we're using swap, it creates an issue in a local issue tracker, and logs an error.
+// The issue says how much memory each subsystem holds.
 class memory_checker_t : private repeating_timer_callback_t {
 public:
     memory_checker_t();
@@ -39,6 +50,9 @@ private:
 
     int practice_runs_remaining;
 
+    tagged_memory_perfmon_t tagged_memory_perfmon;
+    perfmon_membership_t tagged_memory_membership;
+
     // Timer must be destructed before drainer, because on_ring aquires a lock on drainer.
     auto_drainer_t drainer;
     repeating_timer_t timer;
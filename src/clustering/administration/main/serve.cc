@@ -282,7 +282,11 @@ bool do_serve(io_backender_t *io_backender,
                               nullptr,   /* we'll fill this in later */
                               semilattice_manager_auth.get_root_view(),
                               &get_global_perfmon_collection(),
-                              serve_info.reql_http_proxy);
+                              serve_info.reql_http_proxy,
+                              io_backender,
+                              base_path,
+                              serve_info.slow_query_log_threshold_ms,
+                              serve_info.max_concurrent_queries_per_user);
         {
             /* Extract a subview of the directory with all the table meta manager
             business cards. */
@@ -322,7 +326,9 @@ bool do_serve(io_backender_t *io_backender,
                     table_persistence_interface.get(),
                     base_path,
                     io_backender,
-                    &perfmon_collection_repo));
+                    &perfmon_collection_repo,
+                    &rdb_ctx.stats.query_latency,
+                    serve_info.backfill_latency_target_ms));
             } else {
                 /* Proxies still need a `multi_table_manager_t` because it takes care of
                 receiving table names, databases, and primary keys from other servers and
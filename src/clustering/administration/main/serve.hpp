@@ -119,6 +119,9 @@ public:
                  std::vector<std::string> &&_argv,
                  const int _join_delay_secs,
                  const int _node_reconnect_timeout_secs,
+                 const int _backfill_latency_target_ms,
+                 const int _slow_query_log_threshold_ms,
+                 const int64_t _max_concurrent_queries_per_user,
                  tls_configs_t _tls_configs) :
         joins(std::move(_joins)),
         reql_http_proxy(std::move(_reql_http_proxy)),
@@ -128,7 +131,10 @@ public:
         config_file(_config_file),
         argv(std::move(_argv)),
         join_delay_secs(_join_delay_secs),
-        node_reconnect_timeout_secs(_node_reconnect_timeout_secs)
+        node_reconnect_timeout_secs(_node_reconnect_timeout_secs),
+        backfill_latency_target_ms(_backfill_latency_target_ms),
+        slow_query_log_threshold_ms(_slow_query_log_threshold_ms),
+        max_concurrent_queries_per_user(_max_concurrent_queries_per_user)
     {
         tls_configs = _tls_configs;
     }
@@ -149,6 +155,12 @@ public:
     std::vector<std::string> argv;
     int join_delay_secs;
     int node_reconnect_timeout_secs;
+    /* Zero if backfills shouldn't be slowed down for the sake of query latency. */
+    int backfill_latency_target_ms;
+    /* Zero if slow queries shouldn't be logged. */
+    int slow_query_log_threshold_ms;
+    /* Zero if the number of concurrent queries per user isn't limited. */
+    int64_t max_concurrent_queries_per_user;
     tls_configs_t tls_configs;
 };
 
@@ -172,7 +172,8 @@ metadata_file_t::read_txn_t::read_txn_t(
         write_access_t,
         signal_t *interruptor) :
     file(f),
-    txn(file->cache_conn.get(), write_durability_t::HARD, 1),
+    /* `write_txn_t::commit()` makes the changes durable with a shared sync. */
+    txn(file->cache_conn.get(), write_durability_t::SOFT, 1),
     rwlock_acq(&file->rwlock, access_t::write, interruptor)
     { }
 
@@ -301,7 +302,10 @@ metadata_file_t::metadata_file_t(
         const base_path_t &base_path,
         perfmon_collection_t *perfmon_parent,
         signal_t *interruptor) :
-    btree_stats(perfmon_parent, "metadata")
+    btree_stats(perfmon_parent, "metadata"),
+    sync_running(false),
+    syncs_started(0),
+    syncs_done(0)
 {
     filepath_file_opener_t file_opener(get_filename(base_path), io_backender);
     init_serializer(&file_opener, perfmon_parent);
@@ -391,7 +395,10 @@ metadata_file_t::metadata_file_t(
         perfmon_collection_t *perfmon_parent,
         const std::function<void(write_txn_t *, signal_t *)> &initializer,
         signal_t *interruptor) :
-    btree_stats(perfmon_parent, "metadata")
+    btree_stats(perfmon_parent, "metadata"),
+    sync_running(false),
+    syncs_started(0),
+    syncs_done(0)
 {
     filepath_file_opener_t file_opener(get_filename(base_path), io_backender);
     log_serializer_t::create(
@@ -437,6 +444,44 @@ void metadata_file_t::init_serializer(
         MERGER_SERIALIZER_MAX_ACTIVE_WRITES));
 }
 
+void metadata_file_t::sync_committed() {
+    /* A sync that's already running might have started before our changes were
+    committed, so we need the one after that. */
+    cond_t done;
+    sync_waiters.insert(std::make_pair(syncs_started + 1, &done));
+    if (sync_running) {
+        done.wait_lazily_unordered();
+        return;
+    }
+
+    /* Nobody is syncing, so we sync on behalf of everybody until there are no more
+    waiters. That includes ourselves. */
+    sync_running = true;
+    while (!sync_waiters.empty()) {
+        ++syncs_started;
+        do_sync();
+        ++syncs_done;
+        auto end = sync_waiters.upper_bound(syncs_done);
+        for (auto it = sync_waiters.begin(); it != end; ++it) {
+            it->second->pulse();
+        }
+        sync_waiters.erase(sync_waiters.begin(), end);
+    }
+    sync_running = false;
+    guarantee(done.is_pulsed());
+}
+
+void metadata_file_t::do_sync() {
+    /* All transactions go through `cache_conn`, so an empty transaction with hard
+    durability can't be flushed before the soft transactions that were committed
+    before it. We take the lock so that no write transaction is open while we create
+    ours. */
+    rwlock_acq_t rwlock_acq(&rwlock, access_t::write);
+    txn_t txn(cache_conn.get(), write_durability_t::HARD, 0);
+    rwlock_acq.reset();
+    txn.commit();
+}
+
 serializer_filepath_t metadata_file_t::get_filename(const base_path_t &path) {
     return serializer_filepath_t(path, "metadata");
 }
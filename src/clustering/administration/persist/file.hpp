@@ -2,9 +2,12 @@
 #ifndef CLUSTERING_ADMINISTRATION_PERSIST_FILE_HPP_
 #define CLUSTERING_ADMINISTRATION_PERSIST_FILE_HPP_
 
+#include <map>
+
 #include "btree/operations.hpp"
 #include "buffer_cache/alt.hpp"
 #include "buffer_cache/types.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/rwlock.hpp"
 #include "serializer/types.hpp"
 
@@ -140,8 +143,14 @@ public:
         // This acts as a safety check to make sure a transaction
         // is not interrupted in the middle, which could leave the
         // metadata in an inconsistent state.
+        // Blocks until the changes are on disk. The lock on the file is released
+        // before that, and the changes are made durable by a sync that's shared with
+        // the other writers that commit around the same time (for example the Raft
+        // logs of different tables), so that they don't each wait for a flush.
         void commit() {
+            rwlock_acq.reset();
             get_txn()->commit();
+            file->sync_committed();
         }
 
     private:
@@ -176,12 +185,25 @@ private:
 
     static serializer_filepath_t get_filename(const base_path_t &path);
 
+    /* Write transactions commit with soft durability and then call this, which blocks
+    until everything committed before the call is on disk. Only one sync runs at a
+    time; the writers that commit while it's running all share the next one. */
+    void sync_committed();
+    void do_sync();
+
     scoped_ptr_t<merger_serializer_t> serializer;
     scoped_ptr_t<cache_balancer_t> balancer;
     scoped_ptr_t<cache_t> cache;
     scoped_ptr_t<cache_conn_t> cache_conn;
     btree_stats_t btree_stats;
     rwlock_t rwlock;
+
+    bool sync_running;
+    uint64_t syncs_started;
+    uint64_t syncs_done;
+    /* Keyed by the number of syncs that need to finish before the waiter's changes are
+    on disk. */
+    std::multimap<uint64_t, cond_t *> sync_waiters;
 };
 
 #endif /* CLUSTERING_ADMINISTRATION_PERSIST_FILE_HPP_ */
@@ -4,16 +4,23 @@
 #include <algorithm>
 #include <array>
 
+#include "buffer_cache/warm_up_manifest.hpp"
 #include "clustering/administration/persist/branch_history_manager.hpp"
 #include "clustering/administration/persist/file_keys.hpp"
 #include "clustering/administration/persist/raft_storage_interface.hpp"
 #include "clustering/administration/perfmon_collection_repo.hpp"
+#include "concurrency/pmap.hpp"
 #include "logger.hpp"
 #include "rdb_protocol/store.hpp"
 #include "serializer/log/log_serializer.hpp"
 #include "serializer/merger.hpp"
 #include "serializer/translator.hpp"
 
+// Each CPU shard's cache gets its own warm-up manifest next to the table file.
+static std::string warm_up_manifest_path(const std::string &table_file, int shard) {
+    return strprintf("%s.warm-up-%d", table_file.c_str(), shard);
+}
+
 class real_multistore_ptr_t :
     public multistore_ptr_t {
 public:
@@ -32,6 +39,7 @@ public:
                 namespace_id_t, std::pair<real_multistore_ptr_t *, auto_drainer_t::lock_t>
             > *real_multistores) :
         branch_history_manager(std::move(bhm)),
+        table_file(path.permanent_path()),
         serializer_thread_allocation(std::move(serializer_thread)),
         store_thread_allocations(std::move(store_threads)),
         map_insertion_sentry(
@@ -111,6 +119,9 @@ public:
                     &write_token,
                     write_durability_t::HARD,
                     &non_interruptor);
+            } else {
+                stores[ix]->warm_up_cache(
+                    take_warm_up_manifest(warm_up_manifest_path(table_file, ix)));
             }
         });
 
@@ -127,6 +138,8 @@ public:
         pmap(CPU_SHARDING_FACTOR, [this](int ix) {
             if (stores[ix].has()) {
                 on_thread_t thread_switcher(stores[ix]->home_thread());
+                save_warm_up_manifest(warm_up_manifest_path(table_file, ix),
+                                      stores[ix]->warm_cache_block_ids());
                 stores[ix].reset();
             }
         });
@@ -166,6 +179,7 @@ public:
 
 private:
     scoped_ptr_t<real_branch_history_manager_t> branch_history_manager;
+    const std::string table_file;
     scoped_ptr_t<serializer_t> serializer;
     scoped_ptr_t<serializer_multiplexer_t> multiplexer;
     scoped_ptr_t<store_t> stores[CPU_SHARDING_FACTOR];
@@ -202,11 +216,29 @@ void real_table_persistence_interface_t::read_all_metadata(
         },
         interruptor);
     storage_interfaces.clear();
+    std::vector<std::pair<namespace_id_t, table_active_persistent_state_t> > to_load;
     for (const auto &pair : active_tables) {
         storage_interfaces[pair.first].init(new table_raft_storage_interface_t(
             metadata_file, &read_txn, pair.first, interruptor));
+        to_load.push_back(pair);
+    }
+
+    /* Opening a table's serializer and stores takes a while, mostly waiting for the
+    disk. With many tables, doing that one table at a time makes startup very slow. */
+    if (!to_load.empty()) {
+        logINF("Loading %zu tables...", to_load.size());
+    }
+    const ticks_t start_ticks = get_ticks();
+    throttled_pmap(0, to_load.size(), [&](int64_t i) {
         active_cb(
-            pair.first, pair.second, storage_interfaces[pair.first].get(), &read_txn);
+            to_load[i].first,
+            to_load[i].second,
+            storage_interfaces[to_load[i].first].get(),
+            &read_txn);
+    }, MAX_CONCURRENT_TABLE_LOADS);
+    if (!to_load.empty()) {
+        logINF("Loaded %zu tables in %.3f seconds.", to_load.size(),
+               (get_ticks().nanos - start_ticks.nanos) / static_cast<double>(BILLION));
     }
 
     read_txn.read_many<table_inactive_persistent_state_t>(
@@ -279,15 +311,19 @@ void real_table_persistence_interface_t::load_multistore(
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) {
-    scoped_ptr_t<real_branch_history_manager_t> bhm(
-        new real_branch_history_manager_t(
+    scoped_ptr_t<real_branch_history_manager_t> bhm;
+    {
+        new_mutex_acq_t mutex_acq(&metadata_read_txn_mutex, interruptor);
+        bhm.init(new real_branch_history_manager_t(
             table_id, metadata_file, metadata_read_txn, interruptor));
+    }
 
     scoped_ptr_t<thread_allocation_t> serializer_thread(
         new thread_allocation_t(&thread_allocator));
     std::vector<scoped_ptr_t<thread_allocation_t> > store_threads;
     for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
-        store_threads.emplace_back(new thread_allocation_t(&thread_allocator));
+        store_threads.emplace_back(new thread_allocation_t(
+            &thread_allocator, serializer_thread->get_thread()));
     }
 
     multistore_ptr_out->init(new real_multistore_ptr_t(
@@ -326,6 +362,12 @@ void real_table_persistence_interface_t::destroy_multistore(
     const int res = ::unlink(filepath.c_str());
     guarantee_err(res == 0 || get_errno() == ENOENT,
                   "unlink failed for file %s", filepath.c_str());
+    for (int i = 0; i < CPU_SHARDING_FACTOR; ++i) {
+        const std::string manifest = warm_up_manifest_path(filepath, i);
+        const int manifest_res = ::unlink(manifest.c_str());
+        guarantee_err(manifest_res == 0 || get_errno() == ENOENT,
+                      "unlink failed for file %s", manifest.c_str());
+    }
 }
 
 serializer_filepath_t real_table_persistence_interface_t::file_name_for(
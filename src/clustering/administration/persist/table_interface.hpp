@@ -5,6 +5,7 @@
 #include "clustering/administration/perfmon_collection_repo.hpp"
 #include "clustering/administration/persist/raft_storage_interface.hpp"
 #include "clustering/table_manager/table_metadata.hpp"
+#include "concurrency/new_mutex.hpp"
 
 class cache_balancer_t;
 class metadata_file_t;
@@ -91,6 +92,10 @@ private:
 
     /* Used to distribute objects evenly over threads */
     thread_allocator_t thread_allocator;
+
+    /* `read_all_metadata()` loads tables concurrently, but they all read their branch
+    history through the same metadata transaction, so we take turns doing that. */
+    new_mutex_t metadata_read_txn_mutex;
 };
 
 #endif /* CLUSTERING_ADMINISTRATION_PERSIST_TABLE_INTERFACE_HPP_ */
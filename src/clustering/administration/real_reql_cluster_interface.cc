@@ -1010,8 +1010,9 @@ void real_reql_cluster_interface_t::rebalance_internal(
         throw no_such_table_exc_t();
     }
 
-    std::map<store_key_t, int64_t> counts;
-    fetch_distribution(table_id, this, interruptor_on_home, &counts);
+    std::map<store_key_t, int64_t> counts, write_counts;
+    fetch_distribution(table_id, this, interruptor_on_home, &counts, &write_counts);
+    weight_distribution_by_writes(write_counts, &counts);
 
     /* If there's not enough data to rebalance, return `rebalanced: 0` but don't report
     an error */
@@ -4,6 +4,10 @@
 #include "clustering/administration/main/cache_size.hpp"
 #include "clustering/administration/persist/file.hpp"
 #include "clustering/administration/persist/file_keys.hpp"
+#include "logger.hpp"
+
+// How often an automatically sized cache is adjusted to the available memory.
+static const int64_t cache_size_retune_interval_ms = 30 * THOUSAND;
 
 server_config_server_t::server_config_server_t(
         mailbox_manager_t *_mailbox_manager,
@@ -14,7 +18,8 @@ server_config_server_t::server_config_server_t(
     actual_cache_size_bytes(0),
     set_config_mailbox(mailbox_manager,
         std::bind(&server_config_server_t::on_set_config, this,
-            ph::_1, ph::_2, ph::_3))
+            ph::_1, ph::_2, ph::_3)),
+    retune_timer(cache_size_retune_interval_ms, this)
 {
     cond_t non_interruptor;
     metadata_file_t::read_txn_t read_txn(file, &non_interruptor);
@@ -96,3 +101,28 @@ void server_config_server_t::update_actual_cache_size(
     actual_cache_size_bytes.set_value(actual_size);
 }
 
+void server_config_server_t::on_ring() {
+    coro_t::spawn_sometime(std::bind(&server_config_server_t::retune_cache_size,
+                                     this,
+                                     drainer.lock()));
+}
+
+void server_config_server_t::retune_cache_size(
+        UNUSED auto_drainer_t::lock_t keepalive) {
+    if (static_cast<bool>(my_config.get_ref().config.cache_size_bytes)) {
+        return;
+    }
+    const uint64_t old_size = actual_cache_size_bytes.get();
+    const uint64_t new_size = get_adjusted_total_cache_size(old_size);
+    // The setting may have changed while we were reading the memory statistics.
+    if (static_cast<bool>(my_config.get_ref().config.cache_size_bytes)
+            || actual_cache_size_bytes.get() != old_size
+            || new_size == old_size) {
+        return;
+    }
+    logINF("Automatically adjusting cache size from %" PRIu64 " MB to %" PRIu64 " MB",
+        old_size / static_cast<uint64_t>(MEGABYTE),
+        new_size / static_cast<uint64_t>(MEGABYTE));
+    actual_cache_size_bytes.set_value(new_size);
+}
+
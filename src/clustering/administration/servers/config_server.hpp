@@ -4,12 +4,16 @@
 
 #include <set>
 
+#include "arch/timing.hpp"
 #include "clustering/administration/metadata.hpp"
 #include "clustering/administration/servers/server_metadata.hpp"
+#include "concurrency/auto_drainer.hpp"
 
 class metadata_file_t;
 
-class server_config_server_t : public home_thread_mixin_t {
+class server_config_server_t :
+    public home_thread_mixin_t,
+    private repeating_timer_callback_t {
 public:
     server_config_server_t(
         mailbox_manager_t *_mailbox_manager,
@@ -23,7 +27,8 @@ public:
 
     /* Returns the actual cache size, not the cache size setting. If the cache size
     setting is "auto", the actual cache size will be some reasonable automatically
-    selected value; otherwise, the actual cache size will be the cache size setting. */
+    selected value that follows the available memory as it changes; otherwise, the
+    actual cache size will be the cache size setting. */
     clone_ptr_t<watchable_t<uint64_t> > get_actual_cache_size_bytes() {
         return actual_cache_size_bytes.get_watchable();
     }
@@ -37,6 +42,12 @@ private:
 
     void update_actual_cache_size(const optional<uint64_t> &setting);
 
+    /* Periodically re-evaluates an automatically sized cache against the memory that's
+    actually available, which changes as other processes (or the rest of the container)
+    allocate and free memory. */
+    void on_ring() final;
+    void retune_cache_size(auto_drainer_t::lock_t keepalive);
+
     mailbox_manager_t *const mailbox_manager;
     metadata_file_t *const file;
     server_id_t my_server_id;
@@ -44,6 +55,10 @@ private:
     watchable_variable_t<uint64_t> actual_cache_size_bytes;
 
     server_config_business_card_t::set_config_mailbox_t set_config_mailbox;
+
+    // Timer must be destructed before drainer, because on_ring aquires a lock on drainer.
+    auto_drainer_t drainer;
+    repeating_timer_t retune_timer;
 };
 
 #endif /* CLUSTERING_ADMINISTRATION_SERVERS_CONFIG_SERVER_HPP_ */
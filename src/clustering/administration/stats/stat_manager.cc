@@ -27,8 +27,7 @@ void stat_manager_t::on_stats_request(
         const return_address_t& reply_address,
         const std::set<std::vector<stat_id_t> >& requested_stats) {
     perfmon_filter_t request(requested_stats);
-    ql::datum_t perfmon_result(perfmon_get_stats());
-    perfmon_result = request.filter(perfmon_result);
+    ql::datum_t perfmon_result(perfmon_get_stats(request));
 
     // Add in our own server id so the other side does not need to perform lookups
     ql::datum_object_builder_t stats(perfmon_result);
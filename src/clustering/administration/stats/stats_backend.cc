@@ -98,12 +98,30 @@ void maybe_append_result(const stats_request_t &request,
 }
 
 bool stats_artificial_table_backend_t::read_all_rows_as_vector(
-        UNUSED auth::user_context_t const &user_context,
+        auth::user_context_t const &user_context,
         signal_t *interruptor_on_caller,
         std::vector<ql::datum_t> *rows_out,
-        UNUSED admin_err_t *error_out) {
+        admin_err_t *error_out) {
     cross_thread_signal_t interruptor_on_home(interruptor_on_caller, home_thread());
     on_thread_t rethreader(home_thread());
+
+    /* Monitoring tools tend to poll this table, and every read asks every server for
+    its stats, so we share the results between reads that happen close together. */
+    return read_all_rows_cached(
+        user_context,
+        1000,
+        &interruptor_on_home,
+        [&](std::vector<ql::datum_t> *rows, UNUSED admin_err_t *error) {
+            read_all_stats(&interruptor_on_home, rows);
+            return true;
+        },
+        rows_out,
+        error_out);
+}
+
+void stats_artificial_table_backend_t::read_all_stats(
+        signal_t *interruptor_on_home,
+        std::vector<ql::datum_t> *rows_out) {
     rows_out->clear();
 
     cluster_semilattice_metadata_t metadata = cluster_sl_view->get();
@@ -113,7 +131,7 @@ bool stats_artificial_table_backend_t::read_all_rows_as_vector(
         stats_request_t::all_peers(directory_view->get().get_inner());
 
     std::vector<ql::datum_t> results;
-    perform_stats_request(peers, filter, &results, &interruptor_on_home);
+    perform_stats_request(peers, filter, &results, interruptor_on_home);
     parsed_stats_t parsed_stats(results);
 
     // Start building results
@@ -133,7 +151,7 @@ bool stats_artificial_table_backend_t::read_all_rows_as_vector(
     std::map<namespace_id_t, table_config_and_shards_t> configs;
     std::map<namespace_id_t, table_basic_config_t> disconnected_configs;
     table_meta_client->list_configs(
-        &interruptor_on_home, &configs, &disconnected_configs);
+        interruptor_on_home, &configs, &disconnected_configs);
     for (const auto &table_pair : configs) {
         maybe_append_result(table_stats_request_t(table_pair.first), parsed_stats,
             metadata, server_config_client, table_meta_client, admin_format, rows_out);
@@ -148,8 +166,6 @@ bool stats_artificial_table_backend_t::read_all_rows_as_vector(
                 admin_format, rows_out);
         }
     }
-
-    return true;
 }
 
 template <class T>
@@ -53,6 +53,10 @@ public:
             admin_err_t *error_out);
 
 private:
+    /* Collects the stats from every server and builds the rows of the table. */
+    void read_all_stats(signal_t *interruptor_on_home,
+                        std::vector<ql::datum_t> *rows_out);
+
     void get_peer_stats(const peer_id_t &peer,
                         const std::set<std::vector<std::string> > &filter,
                         ql::datum_t *result_out,
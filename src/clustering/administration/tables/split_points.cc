@@ -1,5 +1,7 @@
 #include "clustering/administration/tables/split_points.hpp"
 
+#include <algorithm>
+
 #include "clustering/administration/real_reql_cluster_interface.hpp"
 #include "math.hpp"   /* for `clamp()` */
 #include "rdb_protocol/real_table.hpp"
@@ -89,7 +91,8 @@ void fetch_distribution(
         const namespace_id_t &table_id,
         real_reql_cluster_interface_t *reql_cluster_interface,
         signal_t *interruptor,
-        std::map<store_key_t, int64_t> *counts_out)
+        std::map<store_key_t, int64_t> *counts_out,
+        std::map<store_key_t, int64_t> *write_counts_out)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t, no_such_table_exc_t) {
     namespace_interface_access_t ns_if_access =
         reql_cluster_interface->get_namespace_repo()->get_namespace_interface(
@@ -113,8 +116,33 @@ void fetch_distribution(
         /* If `get_name()` didn't throw, the table exists but is inaccessible */
         throw failed_table_op_exc_t();
     }
-    *counts_out = std::move(
-        boost::get<distribution_read_response_t>(resp.response).key_counts);
+    distribution_read_response_t *dist_resp =
+        boost::get<distribution_read_response_t>(&resp.response);
+    *counts_out = std::move(dist_resp->key_counts);
+    if (write_counts_out != nullptr) {
+        *write_counts_out = std::move(dist_resp->write_counts);
+    }
+}
+
+void weight_distribution_by_writes(
+        const std::map<store_key_t, int64_t> &write_counts,
+        std::map<store_key_t, int64_t> *counts) {
+    int64_t total_count = 0;
+    for (const auto &pair : *counts) {
+        total_count += pair.second;
+    }
+    int64_t total_writes = 0;
+    for (const auto &pair : write_counts) {
+        total_writes += pair.second;
+    }
+    if (total_count == 0 || total_writes == 0) {
+        return;
+    }
+    double docs_per_write = total_count / static_cast<double>(total_writes);
+    for (const auto &pair : write_counts) {
+        (*counts)[pair.first] +=
+            std::max<int64_t>(1, static_cast<int64_t>(pair.second * docs_per_write));
+    }
 }
 
 bool calculate_split_points_with_distribution(
@@ -224,8 +252,10 @@ void calculate_split_points_intelligently(
         table_shard_scheme_t *split_points_out)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t, no_such_table_exc_t) {
     if (num_shards > old_split_points.num_shards()) {
-        std::map<store_key_t, int64_t> counts;
-        fetch_distribution(table_id, reql_cluster_interface, interruptor, &counts);
+        std::map<store_key_t, int64_t> counts, write_counts;
+        fetch_distribution(
+            table_id, reql_cluster_interface, interruptor, &counts, &write_counts);
+        weight_distribution_by_writes(write_counts, &counts);
         if (!calculate_split_points_with_distribution(
                 counts, num_shards, split_points_out)) {
             /* There aren't enough documents to calculate distribution. We'll just assume
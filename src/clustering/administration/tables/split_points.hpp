@@ -14,14 +14,24 @@ class real_reql_cluster_interface_t;
 class signal_t;
 class table_shard_scheme_t;
 
-/* `fetch_distribution` fetches the distribution information from the database. */
+/* `fetch_distribution` fetches the distribution information from the database. If
+`write_counts_out` isn't null, it also fetches the sample of recently written keys. */
 void fetch_distribution(
         const namespace_id_t &table_id,
         real_reql_cluster_interface_t *reql_cluster_interface,
         signal_t *interruptor,
-        std::map<store_key_t, int64_t> *counts_out)
+        std::map<store_key_t, int64_t> *counts_out,
+        std::map<store_key_t, int64_t> *write_counts_out = nullptr)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t, no_such_table_exc_t);
 
+/* `weight_distribution_by_writes` adds the sampled writes from `fetch_distribution()`
+to `counts`, scaled so that the writes weigh as much as the documents do. Split points
+calculated from the result balance both the data and the write load; a range that gets
+most of the writes ends up in fewer shards' worth of keys. */
+void weight_distribution_by_writes(
+        const std::map<store_key_t, int64_t> &write_counts,
+        std::map<store_key_t, int64_t> *counts);
+
 /* `calculate_split_points_with_distribution` generates a set of split points that are
 guaranteed to divide the data approximately evenly, using the results of
 `fetch_distribution()`. It returns `false` if there are too few documents in the
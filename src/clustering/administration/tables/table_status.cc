@@ -7,6 +7,7 @@
 #include "clustering/administration/servers/config_client.hpp"
 #include "clustering/table_contract/executor/exec_primary.hpp"
 #include "clustering/table_manager/table_meta_client.hpp"
+#include "concurrency/cross_thread_signal.hpp"
 
 table_status_artificial_table_backend_t::table_status_artificial_table_backend_t(
         rdb_context_t *rdb_context,
@@ -32,6 +33,29 @@ table_status_artificial_table_backend_t::~table_status_artificial_table_backend_
     begin_changefeed_destruction();
 }
 
+bool table_status_artificial_table_backend_t::read_all_rows_as_vector(
+        auth::user_context_t const &user_context,
+        signal_t *interruptor_on_caller,
+        std::vector<ql::datum_t> *rows_out,
+        admin_err_t *error_out) {
+    cross_thread_signal_t interruptor_on_home(interruptor_on_caller, home_thread());
+    on_thread_t thread_switcher(home_thread());
+
+    /* Every read asks the replicas of every table for their state, and monitoring tools
+    tend to poll this table, so we share the results between reads that happen close
+    together. */
+    return read_all_rows_cached(
+        user_context,
+        1000,
+        &interruptor_on_home,
+        [&](std::vector<ql::datum_t> *rows, admin_err_t *error) {
+            return common_table_artificial_table_backend_t::read_all_rows_as_vector(
+                user_context, &interruptor_on_home, rows, error);
+        },
+        rows_out,
+        error_out);
+}
+
 ql::datum_t convert_replica_status_to_datum(
         const server_id_t &server_id,
         const char *status,
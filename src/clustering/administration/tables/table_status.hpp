@@ -30,6 +30,12 @@ public:
             admin_identifier_format_t _identifier_format);
     ~table_status_artificial_table_backend_t();
 
+    bool read_all_rows_as_vector(
+            auth::user_context_t const &user_context,
+            signal_t *interruptor_on_caller,
+            std::vector<ql::datum_t> *rows_out,
+            admin_err_t *error_out);
+
     bool write_row(
             auth::user_context_t const &user_context,
             ql::datum_t primary_key,
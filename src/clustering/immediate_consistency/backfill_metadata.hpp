@@ -6,6 +6,7 @@
 #include "clustering/generic/registration_metadata.hpp"
 #include "clustering/immediate_consistency/backfill_item_seq.hpp"
 #include "clustering/immediate_consistency/history.hpp"
+#include "containers/archive/compressed.hpp"
 #include "rdb_protocol/distribution_progress.hpp"
 #include "rdb_protocol/protocol.hpp"
 #include "rpc/mailbox/typed.hpp"
@@ -167,9 +168,10 @@ public:
 
     typedef mailbox_t<
         fifo_enforcer_write_token_t,
-        /* The `region_map_t` and the `backfill_item_seq_t` have the same region. */
+        /* The `region_map_t` and the `backfill_item_seq_t` have the same region. The
+        items are deflated on their way over the network when that helps. */
         region_map_t<version_t>,
-        backfill_item_seq_t<backfill_item_t>
+        compressed_t<backfill_item_seq_t<backfill_item_t> >
         > items_mailbox_t;
 
     typedef mailbox_t<
@@ -423,14 +423,14 @@ void backfillee_t::on_items(
         signal_t *interruptor,
         const fifo_enforcer_write_token_t &fifo_token,
         region_map_t<version_t> &&version,
-        backfill_item_seq_t<backfill_item_t> &&chunk) {
+        compressed_t<backfill_item_seq_t<backfill_item_t> > &&chunk) {
     fifo_enforcer_sink_t::exit_write_t exit_write(&fifo_sink, fifo_token);
     wait_interruptible(&exit_write, interruptor);
     if (session_interrupted) {
         return;
     }
     guarantee(current_session != nullptr);
-    current_session->on_items(std::move(version), std::move(chunk));
+    current_session->on_items(std::move(version), std::move(chunk.value));
 }
 
 void backfillee_t::on_ack_end_session(
@@ -97,7 +97,7 @@ private:
         signal_t *interruptor,
         const fifo_enforcer_write_token_t &fifo_token,
         region_map_t<version_t> &&version,
-        backfill_item_seq_t<backfill_item_t> &&chunk);
+        compressed_t<backfill_item_seq_t<backfill_item_t> > &&chunk);
 
     void on_ack_end_session(
         signal_t *interruptor,
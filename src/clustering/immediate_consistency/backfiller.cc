@@ -375,10 +375,17 @@ private:
                     represent the state of the backfillee after it applies all the chunks
                     we've sent. */
                     try {
-                        /* Send the chunk over the network */
-                        send(parent->parent->mailbox_manager,
+                        /* Send the chunk over the network. There's no point in
+                        compressing it if the backfillee is on this server. */
+                        mailbox_manager_t *mailbox_manager =
+                            parent->parent->mailbox_manager;
+                        const bool compress = parent->intro.items_mailbox.get_peer()
+                            != mailbox_manager->get_me();
+                        send(mailbox_manager,
                             parent->intro.items_mailbox,
-                            parent->fifo_source.enter_write(), metainfo, chunk);
+                            parent->fifo_source.enter_write(), metainfo,
+                            compressed_t<backfill_item_seq_t<backfill_item_t> >(
+                                std::move(chunk), compress));
 
                         /* Update `common_version` to reflect the changes that will
                         happen on the backfillee in response to the chunk */
@@ -19,6 +19,11 @@ primary_dispatcher_t::dispatchee_registration_t::dispatchee_registration_t(
         &parent->perfmon_collection,
         &queue_count,
         uuid_to_str(server_id.get_uuid()) + "_broadcast_queue_count"),
+    ack_latency(secs_to_ticks(1)),
+    ack_latency_membership(
+        &parent->perfmon_collection,
+        &ack_latency,
+        uuid_to_str(server_id.get_uuid()) + "_ack_latency"),
     background_write_queue(&queue_count),
     background_write_workers(
         DISPATCH_WRITES_CORO_POOL_SIZE,
@@ -197,7 +202,8 @@ void primary_dispatcher_t::spawn_write(
 primary_dispatcher_t::incomplete_write_t::incomplete_write_t(
         const write_t &w, state_timestamp_t ts, order_token_t ot,
         write_durability_t dur, write_callback_t *cb) :
-    write(w), timestamp(ts), order_token(ot), durability(dur), callback(cb)
+    write(w), timestamp(ts), order_token(ot), durability(dur), callback(cb),
+    start_time(get_ticks())
     { }
 
 primary_dispatcher_t::incomplete_write_t::~incomplete_write_t() {
@@ -236,6 +242,8 @@ void primary_dispatcher_t::background_write(
             dispatchee->dispatchee->do_write_sync(
                 write->write, write->timestamp, write->order_token, write->durability,
                 dispatchee_lock.get_drain_signal(), &response);
+            dispatchee->ack_latency.record(
+                ticks_to_secs(ticks_t{get_ticks().nanos - write->start_time.nanos}));
 
             /* Update latest acked write on the distpatchee so we can route queries
             to the fastest replica and avoid blocking there. */
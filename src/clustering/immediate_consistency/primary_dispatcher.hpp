@@ -104,6 +104,11 @@ public:
         perfmon_counter_t queue_count;
         perfmon_membership_t queue_count_membership;
 
+        /* How long it takes from the start of a write until this dispatchee acks
+        it. */
+        perfmon_histogram_t ack_latency;
+        perfmon_membership_t ack_latency_membership;
+
         /* TODO: Maybe this should be a queue of `incomplete_write_t`s instead of a queue
         of `std::function`s. */
         unlimited_fifo_queue_t<std::function<void()> > background_write_queue;
@@ -191,6 +196,7 @@ private:
         order_token_t order_token;
         write_durability_t durability;
         write_callback_t *callback;
+        ticks_t start_time;
     };
 
     void background_write(
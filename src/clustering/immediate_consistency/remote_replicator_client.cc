@@ -4,6 +4,7 @@
 #include "clustering/immediate_consistency/backfill_throttler.hpp"
 #include "clustering/immediate_consistency/backfillee.hpp"
 #include "clustering/table_manager/backfill_progress_tracker.hpp"
+#include "concurrency/pmap.hpp"
 #include "stl_utils.hpp"
 #include "store_view.hpp"
 
@@ -448,22 +449,39 @@ void remote_replicator_client_t::on_write_async(
 
 void remote_replicator_client_t::on_write_sync(
         signal_t *interruptor,
-        const write_t &write,
-        state_timestamp_t timestamp,
-        order_token_t order_token,
-        write_durability_t durability,
-        const mailbox_t<write_response_t>::address_t &ack_addr)
+        const std::vector<write_t> &writes,
+        const std::vector<state_timestamp_t> &timestamps,
+        const std::vector<order_token_t> &order_tokens,
+        const std::vector<write_durability_t> &durabilities,
+        const mailbox_t<std::vector<write_response_t> >::address_t &ack_addr)
         THROWS_ONLY(interrupted_exc_t) {
+    guarantee(timestamps.size() == writes.size());
+    guarantee(order_tokens.size() == writes.size());
+    guarantee(durabilities.size() == writes.size());
+
     /* The current implementation of the dispatcher will never send us an async write
     once it's started sending sync writes, but we don't want to rely on that detail, so
     we pass sync writes through the timestamp enforcer too. */
-    timestamp_enforcer_->complete(timestamp);
+    for (state_timestamp_t timestamp : timestamps) {
+        timestamp_enforcer_->complete(timestamp);
+    }
 
-    write_response_t response;
-    replica_->do_write(
-        write, timestamp, order_token, durability,
-        interruptor, &response);
-    send(mailbox_manager_, ack_addr, response);
+    /* `replica_t::do_write()` makes the writes go in timestamp order, so we can start
+    all of them at once. */
+    std::vector<write_response_t> responses(writes.size());
+    pmap(writes.size(), [&](size_t i) {
+        try {
+            replica_->do_write(
+                writes[i], timestamps[i], order_tokens[i], durabilities[i],
+                interruptor, &responses[i]);
+        } catch (const interrupted_exc_t &) {
+            /* We check `interruptor` below. */
+        }
+    });
+    if (interruptor->is_pulsed()) {
+        throw interrupted_exc_t();
+    }
+    send(mailbox_manager_, ack_addr, responses);
 }
 
 void remote_replicator_client_t::on_dummy_write(
@@ -91,11 +91,11 @@ private:
 
     void on_write_sync(
             signal_t *interruptor,
-            const write_t &write,
-            state_timestamp_t timestamp,
-            order_token_t order_token,
-            write_durability_t durability,
-            const mailbox_t<write_response_t>::address_t &ack_addr)
+            const std::vector<write_t> &writes,
+            const std::vector<state_timestamp_t> &timestamps,
+            const std::vector<order_token_t> &order_tokens,
+            const std::vector<write_durability_t> &durabilities,
+            const mailbox_t<std::vector<write_response_t> >::address_t &ack_addr)
         THROWS_ONLY(interrupted_exc_t);
 
     void on_dummy_write(
@@ -2,6 +2,8 @@
 #ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_METADATA_HPP_
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_METADATA_HPP_
 
+#include <vector>
+
 #include "clustering/generic/registration_metadata.hpp"
 #include "clustering/immediate_consistency/history.hpp"
 #include "rdb_protocol/protocol.hpp"
@@ -25,9 +27,12 @@ public:
         write_t, state_timestamp_t, order_token_t,
         mailbox_t<>::address_t
         > write_async_mailbox_t;
+    /* Sync writes are sent in batches. The vectors are parallel, and the responses
+    come back in the same order as the writes. */
     typedef mailbox_t<
-        write_t, state_timestamp_t, order_token_t, write_durability_t,
-        mailbox_t<write_response_t>::address_t
+        std::vector<write_t>, std::vector<state_timestamp_t>,
+        std::vector<order_token_t>, std::vector<write_durability_t>,
+        mailbox_t<std::vector<write_response_t> >::address_t
         > write_sync_mailbox_t;
     typedef mailbox_t<
         mailbox_t<write_response_t>::address_t
@@ -1,6 +1,11 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "clustering/immediate_consistency/remote_replicator_server.hpp"
 
+#include "arch/runtime/coroutines.hpp"
+
+/* The most sync writes we send to a replica in a single message. */
+static const size_t max_write_sync_batch_size = 64;
+
 remote_replicator_server_t::remote_replicator_server_t(
         mailbox_manager_t *_mailbox_manager,
         primary_dispatcher_t *_primary) :
@@ -53,16 +58,46 @@ void remote_replicator_server_t::proxy_replica_t::do_write_sync(
         signal_t *interruptor,
         write_response_t *response_out) {
     guarantee(is_ready);
-    cond_t got_response;
-    mailbox_t<write_response_t> response_mailbox(
+    if (!pending_write_sync_batch
+            || pending_write_sync_batch->writes.size() >= max_write_sync_batch_size) {
+        pending_write_sync_batch = std::make_shared<write_sync_batch_t>();
+        coro_t::spawn_sometime(std::bind(
+            &proxy_replica_t::send_write_sync_batch, this,
+            pending_write_sync_batch, drainer.lock()));
+    }
+    std::shared_ptr<write_sync_batch_t> batch = pending_write_sync_batch;
+    size_t index = batch->writes.size();
+    batch->writes.push_back(write);
+    batch->timestamps.push_back(timestamp);
+    batch->order_tokens.push_back(order_token);
+    batch->durabilities.push_back(durability);
+
+    wait_interruptible(&batch->done, interruptor);
+    *response_out = batch->responses[index];
+}
+
+void remote_replicator_server_t::proxy_replica_t::send_write_sync_batch(
+        std::shared_ptr<write_sync_batch_t> batch,
+        auto_drainer_t::lock_t keepalive) {
+    /* No more writes can join the batch once we've sent it. */
+    if (pending_write_sync_batch == batch) {
+        pending_write_sync_batch.reset();
+    }
+    mailbox_t<std::vector<write_response_t> > response_mailbox(
         parent->mailbox_manager,
-        [&](signal_t *, const write_response_t &response) {
-            *response_out = response;
-            got_response.pulse();
+        [&](signal_t *, const std::vector<write_response_t> &responses) {
+            guarantee(responses.size() == batch->writes.size());
+            batch->responses = responses;
+            batch->done.pulse();
         });
     send(parent->mailbox_manager, client_bcard.write_sync_mailbox,
-        write, timestamp, order_token, durability, response_mailbox.get_address());
-    wait_interruptible(&got_response, interruptor);
+        batch->writes, batch->timestamps, batch->order_tokens, batch->durabilities,
+        response_mailbox.get_address());
+    try {
+        wait_interruptible(&batch->done, keepalive.get_drain_signal());
+    } catch (const interrupted_exc_t &) {
+        /* The writes in the batch have all been interrupted by now. */
+    }
 }
 
 void remote_replicator_server_t::proxy_replica_t::do_dummy_write(
@@ -2,6 +2,9 @@
 #ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
 
+#include <memory>
+#include <vector>
+
 #include "clustering/generic/registrar.hpp"
 #include "clustering/immediate_consistency/primary_dispatcher.hpp"
 #include "clustering/immediate_consistency/remote_replicator_metadata.hpp"
@@ -64,12 +67,37 @@ private:
             write_response_t *response_out);
 
     private:
+        /* Sync writes that arrive close together are sent to the client as a single
+        message, and it acknowledges them all at once. */
+        class write_sync_batch_t {
+        public:
+            std::vector<write_t> writes;
+            std::vector<state_timestamp_t> timestamps;
+            std::vector<order_token_t> order_tokens;
+            std::vector<write_durability_t> durabilities;
+            std::vector<write_response_t> responses;
+            cond_t done;
+        };
+
         void on_ready(signal_t *interruptor);
 
+        void send_write_sync_batch(
+            std::shared_ptr<write_sync_batch_t> batch,
+            auto_drainer_t::lock_t keepalive);
+
         remote_replicator_client_bcard_t client_bcard;
         remote_replicator_server_t *parent;
         bool is_ready;
 
+        /* The batch that new sync writes get added to. It gets sent out as soon as
+        the writes that are already queued on this thread have had a chance to join
+        it. */
+        std::shared_ptr<write_sync_batch_t> pending_write_sync_batch;
+
+        /* `registration` interrupts all writes that are still running when it's
+        destroyed, so it has to go before `drainer`. */
+        auto_drainer_t drainer;
+
         // The destruction order matters: The `ready_mailbox` callback assumes
         // that `registration` is still valid.
         scoped_ptr_t<primary_dispatcher_t::dispatchee_registration_t> registration;
@@ -1,23 +1,60 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "clustering/immediate_consistency/standard_backfill_throttler.hpp"
 
+#include <algorithm>
+
+#include "arch/runtime/coroutines.hpp"
 #include "concurrency/cross_thread_signal.hpp"
 #include "concurrency/wait_any.hpp"
+#include "perfmon/collect.hpp"
+#include "threading.hpp"
 
-static const size_t max_active_backfills = 8;
+/* Every backfill runs on the thread of the CPU shard it's filling, so on machines with
+more threads than CPU shards we can afford to run more of them at once. */
+static size_t compute_max_active_backfills() {
+    return std::max<size_t>(8, get_num_db_threads());
+}
+
+/* How often we compare the foreground latency to the target. */
+static const int64_t adjust_interval_ms = 1000;
+
+standard_backfill_throttler_t::standard_backfill_throttler_t() :
+    foreground_latency(nullptr),
+    latency_target_ms(0),
+    max_active_backfills(compute_max_active_backfills()),
+    max_active_non_critical(max_active_backfills) { }
+
+standard_backfill_throttler_t::standard_backfill_throttler_t(
+        perfmon_t *_foreground_latency,
+        int _latency_target_ms) :
+    foreground_latency(_foreground_latency),
+    latency_target_ms(_latency_target_ms),
+    max_active_backfills(compute_max_active_backfills()),
+    max_active_non_critical(max_active_backfills) {
+    if (foreground_latency != nullptr && latency_target_ms > 0) {
+        adjust_timer.init(new repeating_timer_t(adjust_interval_ms,
+            std::bind(&standard_backfill_throttler_t::on_adjust_timer, this)));
+    }
+}
 
 standard_backfill_throttler_t::~standard_backfill_throttler_t() {
     guarantee(active.empty());
     guarantee(waiting.empty());
 }
 
+size_t standard_backfill_throttler_t::limit_for(const priority_t &priority) const {
+    return priority.critical == priority_t::critical_t::YES
+        ? max_active_backfills
+        : max_active_non_critical;
+}
+
 void standard_backfill_throttler_t::enter(lock_t *lock, signal_t *interruptor_on_lock) {
     cross_thread_signal_t interruptor_on_home(interruptor_on_lock, home_thread());
     on_thread_t thread_switcher(home_thread());
     scoped_ptr_t<new_mutex_acq_t> mutex_acq(
         new new_mutex_acq_t(&mutex, &interruptor_on_home));
 
-    if (active.size() < max_active_backfills) {
+    if (active.size() < limit_for(lock->priority)) {
         /* There is no contention, so we can start right away */
         active.insert(std::make_pair(lock->priority, lock));
 
@@ -73,10 +110,17 @@ void standard_backfill_throttler_t::exit(lock_t *lock) {
     guarantee(it != active.end());
     active.erase(it);
 
-    /* Find the highest-priority backfill that's waiting to start */
-    auto jt = waiting.end();
-    if (jt != waiting.begin()) {
+    start_waiting();
+}
+
+void standard_backfill_throttler_t::start_waiting() {
+    /* Start the highest-priority backfills that are waiting, as long as there's room */
+    while (!waiting.empty()) {
+        auto jt = waiting.end();
         --jt;
+        if (active.size() >= limit_for(jt->first)) {
+            break;
+        }
 
         /* Pulse the `cond_t` so that `enter()` can return */
         jt->second.second->pulse();
@@ -87,3 +131,50 @@ void standard_backfill_throttler_t::exit(lock_t *lock) {
     }
 }
 
+void standard_backfill_throttler_t::on_adjust_timer() {
+    coro_t::spawn_sometime(std::bind(
+        &standard_backfill_throttler_t::adjust, this, drainer.lock()));
+}
+
+void standard_backfill_throttler_t::adjust(auto_drainer_t::lock_t keepalive) {
+    assert_thread();
+    ql::datum_t stats = perfmon_get_stats(foreground_latency);
+    ql::datum_t p99 = stats.get_field("p99", ql::NOTHROW);
+
+    try {
+        new_mutex_acq_t mutex_acq(&mutex, keepalive.get_drain_signal());
+
+        /* Back off quickly while queries are slow, and recover slowly. If there were no
+        queries, there's nothing to protect. */
+        if (p99.has() && p99.get_type() == ql::datum_t::R_NUM
+                && p99.as_num() * 1000 > latency_target_ms) {
+            max_active_non_critical = std::max<size_t>(1, max_active_non_critical / 2);
+        } else {
+            max_active_non_critical =
+                std::min(max_active_backfills, max_active_non_critical + 1);
+        }
+
+        start_waiting();
+
+        /* Preempt the lowest-priority non-critical backfills until we're within the
+        limit. Backfills that have already been preempted count too, because they're
+        about to leave. */
+        size_t excess = active.size() > max_active_non_critical
+            ? active.size() - max_active_non_critical : 0;
+        for (auto it = active.begin(); it != active.end() && excess > 0; ++it) {
+            if (it->first.critical == priority_t::critical_t::YES) {
+                continue;
+            }
+            {
+                on_thread_t thread_switcher(it->second->home_thread());
+                if (!it->second->get_preempt_signal()->is_pulsed()) {
+                    preempt(it->second);
+                }
+            }
+            --excess;
+        }
+    } catch (const interrupted_exc_t &) {
+        /* The throttler is being destroyed. */
+    }
+}
+
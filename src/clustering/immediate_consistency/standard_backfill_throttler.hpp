@@ -4,28 +4,63 @@
 
 #include <set>
 
+#include "arch/timing.hpp"
 #include "clustering/immediate_consistency/backfill_throttler.hpp"
+#include "concurrency/auto_drainer.hpp"
 #include "concurrency/new_mutex.hpp"
 
+class perfmon_t;
+
 /* `standard_backfill_throttler_t` is the `backfill_throttler_t` that is used in
-production. It allows a fixed number of backfills total (currently 8); if there are more
-than 8 backfills trying to run, it will always allow the highest-priority backfills to go
-first, preempting the lower-priority backfills if necessary. */
+production. It allows a fixed number of backfills total (8, or one per thread if there
+are more threads than that); if there are more backfills trying to run, it will always
+allow the highest-priority backfills to go first, preempting the lower-priority
+backfills if necessary.
+
+If it's given a `foreground_latency` perfmon and a latency target, it also checks the
+p99 of `foreground_latency` once a second. While that's above the target, it halves the
+number of non-critical backfills that may run (down to one), preempting the
+lowest-priority ones; once it's back below the target, it lets one more run every second.
+Critical backfills are only held back by the fixed limit, because the availability of a
+table depends on them. */
 
 class standard_backfill_throttler_t : public backfill_throttler_t {
 public:
-    standard_backfill_throttler_t() { }
+    standard_backfill_throttler_t();
+    /* `foreground_latency` must produce the stats of a `perfmon_histogram_t`. */
+    standard_backfill_throttler_t(
+        perfmon_t *foreground_latency,
+        int latency_target_ms);
     ~standard_backfill_throttler_t();
 
 private:
     void enter(lock_t *lock, signal_t *interruptor);
     void exit(lock_t *lock);
 
+    /* The number of backfills that may be active when a backfill with `priority` wants
+    to start. */
+    size_t limit_for(const priority_t &priority) const;
+    /* Pulses the highest-priority waiting backfills for as long as there's room. */
+    void start_waiting();
+
+    void on_adjust_timer();
+    void adjust(auto_drainer_t::lock_t keepalive);
+
     std::multimap<priority_t, std::pair<lock_t *, cond_t *> > waiting;
     std::set<std::pair<priority_t, lock_t *> > active;
 
     new_mutex_t mutex;
+
+    perfmon_t *const foreground_latency;
+    int const latency_target_ms;
+
+    size_t const max_active_backfills;
+
+    /* The current limit for non-critical backfills. */
+    size_t max_active_non_critical;
+
+    auto_drainer_t drainer;
+    scoped_ptr_t<repeating_timer_t> adjust_timer;
 };
 
 #endif /* CLUSTERING_IMMEDIATE_CONSISTENCY_STANDARD_BACKFILL_THROTTLER_HPP_ */
-
@@ -10,6 +10,13 @@
 #include "concurrency/fifo_enforcer.hpp"
 #include "concurrency/watchable.hpp"
 #include "rdb_protocol/env.hpp"
+#include "time.hpp"
+
+/* How much a single outdated read counts towards a replica's average latency. */
+static const double outdated_read_latency_weight = 0.2;
+
+/* One in this many outdated reads goes to a random replica instead of the fastest. */
+static const int outdated_read_exploration_interval = 16;
 
 table_query_client_t::table_query_client_t(
         const namespace_id_t &_table_id,
@@ -331,6 +338,29 @@ void table_query_client_t::perform_immediate_op(
     }
 }
 
+table_query_client_t::relationship_t *
+table_query_client_t::choose_outdated_read_replica(
+        const std::vector<relationship_t *> &candidates) {
+    guarantee(!candidates.empty());
+    /* Every so often we pick a replica at random, so that our estimates for the
+    replicas we aren't using don't go stale. */
+    if (randint(outdated_read_exploration_interval) == 0) {
+        return candidates[randint(candidates.size())];
+    }
+    relationship_t *best = nullptr;
+    for (relationship_t *candidate : candidates) {
+        /* Replicas that we haven't measured yet get tried first. */
+        if (candidate->outdated_read_latency < 0) {
+            return candidate;
+        }
+        if (best == nullptr
+                || candidate->outdated_read_latency < best->outdated_read_latency) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
 void table_query_client_t::dispatch_outdated_read(
     const read_t &op,
     read_response_t *response,
@@ -360,8 +390,8 @@ void table_query_client_t::dispatch_outdated_read(
                 }
             }
             if (!chosen_relationship && !potential_relationships.empty()) {
-                chosen_relationship
-                    = potential_relationships[randint(potential_relationships.size())];
+                chosen_relationship =
+                    choose_outdated_read_replica(potential_relationships);
             }
             if (!chosen_relationship) {
                 /* Don't bother looking for masters; if there are no direct
@@ -370,6 +400,7 @@ void table_query_client_t::dispatch_outdated_read(
                     "no replica is available",
                     query_state_t::FAILED);
             }
+            new_op_info->relationship = chosen_relationship;
             new_op_info->direct_bcard = chosen_relationship->direct_bcard;
             new_op_info->keepalive = auto_drainer_t::lock_t(
                 &chosen_relationship->drainer);
@@ -405,6 +436,7 @@ void table_query_client_t::perform_outdated_read(
     outdated_read_info_t *replica_to_contact = (*replicas_to_contact)[i].get();
 
     try {
+        ticks_t start_time = get_ticks();
         cond_t done;
         mailbox_t<read_response_t> cont(mailbox_manager,
             [&](signal_t *, const read_response_t &res) {
@@ -422,6 +454,13 @@ void table_query_client_t::perform_outdated_read(
             /* `wait_interruptible()` returned because
             `replica_to_contact->keepalive.get_drain_signal()` was pulsed */
             failures->at(i).assign("lost contact with replica");
+        } else {
+            /* The relationship can't go away while we hold `keepalive`. */
+            double latency = ticks_to_secs(ticks_t{get_ticks().nanos - start_time.nanos});
+            double *average = &replica_to_contact->relationship->outdated_read_latency;
+            *average = *average < 0 ? latency
+                : (1 - outdated_read_latency_weight) * *average
+                    + outdated_read_latency_weight * latency;
         }
     } catch (const interrupted_exc_t &) {
         /* Return immediately. `dispatch_immediate_op()` will notice that the
@@ -538,6 +577,7 @@ void table_query_client_t::relationship_coroutine(
         relationship_record.is_local =
             (key.first == mailbox_manager->get_connectivity_cluster()->get_me());
         relationship_record.region = bcard.region;
+        relationship_record.outdated_read_latency = -1;
 
         scoped_ptr_t<primary_query_client_t> primary_client;
         if (static_cast<bool>(bcard.primary)) {
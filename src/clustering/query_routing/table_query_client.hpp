@@ -74,6 +74,9 @@ private:
         region_t region;
         primary_query_client_t *primary_client;
         const direct_query_bcard_t *direct_bcard;
+        /* A moving average of how long outdated reads sent to this replica took, in
+        seconds, or a negative number if we haven't sent it any yet. */
+        double outdated_read_latency;
         auto_drainer_t drainer;
     };
 
@@ -93,6 +96,7 @@ private:
     class outdated_read_info_t {
     public:
         read_t sharded_op;
+        relationship_t *relationship;
         const direct_query_bcard_t *direct_bcard;
         auto_drainer_t::lock_t keepalive;
     };
@@ -123,6 +127,11 @@ private:
             signal_t *interruptor)
         THROWS_NOTHING;
 
+    /* Picks the replica that answered outdated reads fastest so far, so that
+    outdated reads stay close to us when there's a replica nearby. */
+    static relationship_t *choose_outdated_read_replica(
+            const std::vector<relationship_t *> &candidates);
+
     void dispatch_outdated_read(
             const read_t &op,
             read_response_t *response,
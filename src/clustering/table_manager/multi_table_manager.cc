@@ -18,7 +18,9 @@ multi_table_manager_t::multi_table_manager_t(
         table_persistence_interface_t *_persistence_interface,
         const base_path_t &_base_path,
         io_backender_t *_io_backender,
-        perfmon_collection_repo_t *_perfmon_collection_repo) :
+        perfmon_collection_repo_t *_perfmon_collection_repo,
+        perfmon_t *foreground_latency,
+        int backfill_latency_target_ms) :
     is_proxy_server(false),
     server_id(_server_id),
     mailbox_manager(_mailbox_manager),
@@ -29,9 +31,12 @@ multi_table_manager_t::multi_table_manager_t(
     persistence_interface(_persistence_interface),
     base_path(_base_path),
     io_backender(_io_backender),
-    perfmon_collection_repo(_perfmon_collection_repo) {
+    perfmon_collection_repo(_perfmon_collection_repo),
+    backfill_throttler(foreground_latency, backfill_latency_target_ms) {
 
-    /* Resurrect any tables that were sitting on disk from when we last shut down */
+    /* Resurrect any tables that were sitting on disk from when we last shut down. The
+    active tables are loaded concurrently, so the first callback must not assume that
+    the tables it doesn't see yet don't exist. */
     cond_t non_interruptor;
     persistence_interface->read_all_metadata(
         [&](const namespace_id_t &table_id,
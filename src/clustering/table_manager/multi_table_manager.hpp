@@ -80,7 +80,11 @@ public:
         table_persistence_interface_t *_persistence_interface,
         const base_path_t &_base_path,
         io_backender_t *_io_backender,
-        perfmon_collection_repo_t *_perfmon_collection_repo);
+        perfmon_collection_repo_t *_perfmon_collection_repo,
+        /* `standard_backfill_throttler_t` slows down backfills while the p99 of
+        `foreground_latency` is above `backfill_latency_target_ms`. */
+        perfmon_t *foreground_latency,
+        int backfill_latency_target_ms);
 
     /* This constructor is used on proxy servers. */
     multi_table_manager_t(
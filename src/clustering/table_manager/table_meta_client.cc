@@ -115,6 +115,45 @@ void table_meta_client_t::get_config(
     }
 }
 
+void table_meta_client_t::get_write_hook(
+        const namespace_id_t &table_id,
+        signal_t *interruptor,
+        optional<write_hook_config_t> *write_hook_out)
+        THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t) {
+    multi_table_manager_timestamp_t timestamp;
+    table_basic_configs.get_watchable()->read_key(table_id,
+        [&](const timestamped_basic_config_t *value) {
+            if (value == nullptr) {
+                throw no_such_table_exc_t();
+            }
+            timestamp = value->second;
+        });
+
+    std::map<namespace_id_t, cached_write_hook_t> *cache = write_hook_caches.get();
+    const ticks_t now = get_ticks();
+    auto it = cache->find(table_id);
+    if (it != cache->end()
+            && it->second.timestamp == timestamp
+            && now.nanos - it->second.fetched.nanos
+                < WRITE_HOOK_CACHE_MAX_AGE_MS * MILLION) {
+        *write_hook_out = it->second.write_hook;
+        return;
+    }
+
+    table_config_and_shards_t config;
+    try {
+        get_config(table_id, interruptor, &config);
+    } catch (const no_such_table_exc_t &) {
+        cache->erase(table_id);
+        throw;
+    }
+    cached_write_hook_t *entry = &(*cache)[table_id];
+    entry->timestamp = timestamp;
+    entry->fetched = now;
+    entry->write_hook = config.config.write_hook;
+    *write_hook_out = config.config.write_hook;
+}
+
 void table_meta_client_t::list_configs(
         signal_t *interruptor_on_caller,
         std::map<namespace_id_t, table_config_and_shards_t> *configs_out,
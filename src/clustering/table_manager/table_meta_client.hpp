@@ -2,9 +2,13 @@
 #ifndef CLUSTERING_TABLE_MANAGER_TABLE_META_CLIENT_HPP_
 #define CLUSTERING_TABLE_MANAGER_TABLE_META_CLIENT_HPP_
 
+#include <map>
+
 #include "clustering/table_manager/table_metadata.hpp"
 #include "concurrency/cross_thread_watchable.hpp"
+#include "concurrency/one_per_thread.hpp"
 #include "concurrency/watchable_map.hpp"
+#include "time.hpp"
 
 class multi_table_manager_t;
 class server_config_client_t;
@@ -116,6 +120,17 @@ public:
         table_config_and_shards_t *config_out)
         THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t);
 
+    /* `get_write_hook()` fetches the table's write hook, like `get_config()` does.
+    Every write batch needs it, so each thread caches the hooks it has fetched. A cached
+    hook is used while the table's timestamp in `table_basic_configs` doesn't change,
+    which happens with every Raft commit on servers that host the table, and for at
+    most `WRITE_HOOK_CACHE_MAX_AGE_MS`, for servers that don't. */
+    void get_write_hook(
+        const namespace_id_t &table_id,
+        signal_t *interruptor,
+        optional<write_hook_config_t> *write_hook_out)
+        THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t);
+
     /* `list_configs()` fetches the configurations of every table at once. It may block.
     If it can't find a config for a certain table, then it puts the table's name and info
     into `disconnected_configs_out` instead. */
@@ -269,6 +284,15 @@ private:
     `list_names()` can run without blocking. */
     all_thread_watchable_map_var_t<namespace_id_t, timestamped_basic_config_t>
         table_basic_configs;
+
+    static const int64_t WRITE_HOOK_CACHE_MAX_AGE_MS = 1000;
+    class cached_write_hook_t {
+    public:
+        multi_table_manager_timestamp_t timestamp;
+        ticks_t fetched;
+        optional<write_hook_config_t> write_hook;
+    };
+    one_per_thread_t<std::map<namespace_id_t, cached_write_hook_t> > write_hook_caches;
 };
 
 #endif /* CLUSTERING_TABLE_MANAGER_TABLE_META_CLIENT_HPP_ */
@@ -307,7 +307,9 @@ public:
     or `delete_metadata()` affecting that table. */
 
     /* Finds all tables stored in the metadata and calls the appropriate callback. Note
-    that this invalidates any existing `raft_storage_interface_t`s! */
+    that this invalidates any existing `raft_storage_interface_t`s! `active_cb` may be
+    called for several tables at once, from different coroutines on the calling
+    thread, so that slow table loads overlap. */
     virtual void read_all_metadata(
         const std::function<void(
             const namespace_id_t &table_id,
@@ -10,7 +10,13 @@
 
 /* coro_pool_t maintains a bunch of coroutines; when you give it tasks, it
 distributes them among the coroutines. It draws its tasks from a
-`passive_producer_t`. */
+`passive_producer_t`.
+
+The pool doesn't start all of its coroutines as soon as there is work.  It starts a
+new one only when there is more work and none of the running coroutines is about to
+pick it up, which is the case when they are all blocked in the callback.  So a pool
+whose callbacks rarely block gets by with one or two coroutines, and one whose
+callbacks wait a lot grows to `_worker_count` coroutines. */
 
 template <class T>
 class coro_pool_callback_t {
@@ -40,6 +46,7 @@ public:
     coro_pool_t(size_t _worker_count, passive_producer_t<T> *_source, coro_pool_callback_t<T> *_callback)
         : max_worker_count(_worker_count),
           active_worker_count(0),
+          ready_worker_count(0),
           source(_source),
           callback(_callback) {
         rassert(max_worker_count > 0);
@@ -61,17 +68,20 @@ public:
     }
 
 private:
-    void worker_run(T object, auto_drainer_t::lock_t coro_drain_semaphore_lock) THROWS_NOTHING {
+    void worker_run(auto_drainer_t::lock_t coro_drain_semaphore_lock) THROWS_NOTHING {
         assert_thread();
+        --ready_worker_count;
         try {
-            while (!coro_drain_semaphore_lock.get_drain_signal()->is_pulsed()) {
+            while (!coro_drain_semaphore_lock.get_drain_signal()->is_pulsed()
+                   && source->available->get()) {
+                T object = source->pop();
+                // If the callback blocks, somebody else has to take care of the
+                // remaining work.
+                maybe_spawn_worker();
                 callback->coro_pool_callback(object, coro_drain_semaphore_lock.get_drain_signal());
-                if (source->available->get()) {
-                    object = source->pop();
-                } else {
-                    break;
-                }
+                ++ready_worker_count;
                 coro_t::yield();
+                --ready_worker_count;
             }
         } catch (const interrupted_exc_t &) {
             rassert(coro_drain_semaphore_lock.get_drain_signal()->is_pulsed());
@@ -79,17 +89,27 @@ private:
         --active_worker_count;
     }
 
-    void on_source_availability_changed() {
-        assert_thread();
-        while (source->available->get() && active_worker_count < max_worker_count) {
+    void maybe_spawn_worker() {
+        if (source->available->get()
+            && ready_worker_count == 0
+            && active_worker_count < max_worker_count) {
             ++active_worker_count;
+            ++ready_worker_count;
             coro_t::spawn_sometime(std::bind(
                 &coro_pool_t::worker_run, this,
-                source->pop(), auto_drainer_t::lock_t(&coro_drain_semaphore)));
+                auto_drainer_t::lock_t(&coro_drain_semaphore)));
         }
     }
 
+    void on_source_availability_changed() {
+        assert_thread();
+        maybe_spawn_worker();
+    }
+
     int max_worker_count, active_worker_count;
+    // Workers that will look at `source` again without blocking first: the ones
+    // that haven't started yet, and the ones that are yielding between tasks.
+    int ready_worker_count;
     passive_producer_t<T> *source;
     coro_pool_callback_t<T> *callback;
     auto_drainer_t coro_drain_semaphore;
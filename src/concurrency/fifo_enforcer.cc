@@ -52,6 +52,10 @@ void fifo_enforcer_sink_t::exit_read_t::begin(fifo_enforcer_sink_t *p, fifo_enfo
     mutex_assertion_t::acq_t acq(&parent->internal_lock);
     parent->internal_read_queue.push(this);
     parent->internal_pump();
+    if (!is_pulsed()) {
+        wait_timer.start(lock_kind_t::fifo_enforcer,
+                         parent->internal_read_queue.size() - 1);
+    }
 }
 
 void fifo_enforcer_sink_t::exit_read_t::end() THROWS_NOTHING {
@@ -61,6 +65,7 @@ void fifo_enforcer_sink_t::exit_read_t::end() THROWS_NOTHING {
     if (is_pulsed()) {
         parent->internal_finish_a_reader(token);
     } else {
+        wait_timer.cancel();
         /* Swap us out for a dummy. The dummy is heap-allocated and it will
         delete itself when it's done. */
         class dummy_exit_read_t : public internal_exit_read_t {
@@ -112,8 +117,12 @@ void fifo_enforcer_sink_t::exit_write_t::begin(fifo_enforcer_sink_t *p, fifo_enf
 
     parent->assert_thread();
     mutex_assertion_t::acq_t acq(&parent->internal_lock);
-    parent->internal_write_queue.push(this);
+    parent->internal_write_queue.push(this, token.timestamp);
     parent->internal_pump();
+    if (!is_pulsed()) {
+        wait_timer.start(lock_kind_t::fifo_enforcer,
+                         parent->internal_write_queue.size() - 1);
+    }
 }
 
 void fifo_enforcer_sink_t::exit_write_t::end() THROWS_NOTHING {
@@ -122,6 +131,7 @@ void fifo_enforcer_sink_t::exit_write_t::end() THROWS_NOTHING {
     if (is_pulsed()) {
         parent->internal_finish_a_writer(token);
     } else {
+        wait_timer.cancel();
         /* Swap us out for a dummy. */
         class dummy_exit_write_t : public internal_exit_write_t {
         public:
@@ -131,7 +141,7 @@ void fifo_enforcer_sink_t::exit_write_t::end() THROWS_NOTHING {
                 return token;
             }
             void on_reached_head_of_queue() {
-                sink->internal_write_queue.remove(this);
+                sink->internal_write_queue.pop();
                 sink->internal_finish_a_writer(token);
                 delete this;
             }
@@ -141,7 +151,7 @@ void fifo_enforcer_sink_t::exit_write_t::end() THROWS_NOTHING {
             fifo_enforcer_write_token_t token;
             fifo_enforcer_sink_t *sink;
         };
-        parent->internal_write_queue.swap_in_place(this,
+        parent->internal_write_queue.swap_in_place(token.timestamp, this,
             new dummy_exit_write_t(token, parent));
     }
     ended = true;
@@ -159,11 +169,55 @@ fifo_enforcer_sink_t::~fifo_enforcer_sink_t() THROWS_NOTHING {
         read->on_early_shutdown();
     }
     while (!internal_write_queue.empty()) {
-        internal_exit_write_t *write = internal_write_queue.pop();
+        internal_exit_write_t *write = internal_write_queue.pop_any();
         write->on_early_shutdown();
     }
 }
 
+void fifo_enforcer_sink_t::internal_write_queue_t::push(
+        internal_exit_write_t *x, state_timestamp_t timestamp) THROWS_NOTHING {
+    rassert(x != nullptr);
+    guarantee(timestamp >= front_timestamp, "Write token was already popped.");
+    size_t offset = timestamp.count_changes(front_timestamp);
+    if (offset >= slots.size()) {
+        slots.resize(offset + 1, nullptr);
+    }
+    guarantee(slots[offset] == nullptr, "Write token was pushed twice.");
+    slots[offset] = x;
+    ++count;
+}
+
+void fifo_enforcer_sink_t::internal_write_queue_t::pop() THROWS_NOTHING {
+    rassert(peek() != nullptr);
+    slots.pop_front();
+    front_timestamp = front_timestamp.next();
+    --count;
+}
+
+void fifo_enforcer_sink_t::internal_write_queue_t::swap_in_place(
+        state_timestamp_t timestamp,
+        DEBUG_VAR internal_exit_write_t *to_remove,
+        internal_exit_write_t *to_insert) THROWS_NOTHING {
+    rassert(to_insert != nullptr);
+    rassert(timestamp >= front_timestamp);
+    size_t offset = timestamp.count_changes(front_timestamp);
+    rassert(offset < slots.size() && slots[offset] == to_remove);
+    slots[offset] = to_insert;
+}
+
+fifo_enforcer_sink_t::internal_exit_write_t *
+fifo_enforcer_sink_t::internal_write_queue_t::pop_any() THROWS_NOTHING {
+    while (!slots.empty()) {
+        internal_exit_write_t *x = slots.back();
+        slots.pop_back();
+        if (x != nullptr) {
+            --count;
+            return x;
+        }
+    }
+    return nullptr;
+}
+
 void fifo_enforcer_sink_t::internal_pump() THROWS_NOTHING {
     ASSERT_FINITE_CORO_WAITING;
     if (in_pump) {
@@ -180,7 +234,7 @@ void fifo_enforcer_sink_t::internal_pump() THROWS_NOTHING {
                 read->on_reached_head_of_queue();
             }
 
-            if (!internal_write_queue.empty() &&
+            if (internal_write_queue.peek() != nullptr &&
                 internal_write_queue.peek()->get_token().timestamp == finished_state.last_timestamp.next() &&
                 internal_write_queue.peek()->get_token().num_preceding_reads == finished_state.num_reads) {
                 internal_exit_write_t *write = internal_write_queue.peek();
@@ -2,9 +2,11 @@
 #ifndef CONCURRENCY_FIFO_ENFORCER_HPP_
 #define CONCURRENCY_FIFO_ENFORCER_HPP_
 
+#include <deque>
 #include <map>
 #include <utility>
 
+#include "concurrency/lock_contention.hpp"
 #include "concurrency/mutex_assertion.hpp"
 #include "concurrency/signal.hpp"
 #include "containers/intrusive_priority_queue.hpp"
@@ -135,25 +137,19 @@ public:
         virtual void on_early_shutdown() = 0;
     };
 
-    class internal_exit_write_t
-        : public intrusive_priority_queue_node_t<internal_exit_write_t> {
+    class internal_exit_write_t {
     protected:
         virtual ~internal_exit_write_t() { }
 
     private:
         friend class fifo_enforcer_sink_t;
-        friend bool left_is_higher_priority(
-            const fifo_enforcer_sink_t::internal_exit_write_t *left,
-            const fifo_enforcer_sink_t::internal_exit_write_t *right);
 
-        /* Returns the write token for this operation. It will be used to sort
-        the operation in the queue. */
+        /* Returns the write token for this operation. Its timestamp must be the
+        one that the operation was pushed onto the queue with. */
         virtual fifo_enforcer_write_token_t get_token() const = 0;
 
         /* Called when the operation has reached the head of the queue. It
-        should remove the operation from the queue. (Or change its token, which
-        is used to efficiently implement an object that stands for more than one
-        token.) */
+        should pop the operation from the queue. */
         virtual void on_reached_head_of_queue() = 0;
 
         /* Called when the FIFO enforcer is being destroyed. The operation will
@@ -189,6 +185,7 @@ public:
         void on_reached_head_of_queue() {
             parent->internal_read_queue.remove(this);
             pulse();
+            wait_timer.finish(lock_kind_t::fifo_enforcer);
         }
         void on_early_shutdown() {
             crash("illegal to destroy fifo_enforcer_sink_t while outstanding "
@@ -201,6 +198,8 @@ public:
         bool ended;
 
         fifo_enforcer_read_token_t token;
+
+        lock_wait_timer_t wait_timer;
     };
 
     class exit_write_t : public signal_t, public internal_exit_write_t {
@@ -221,8 +220,9 @@ public:
             return token;
         }
         void on_reached_head_of_queue() {
-            parent->internal_write_queue.remove(this);
+            parent->internal_write_queue.pop();
             pulse();
+            wait_timer.finish(lock_kind_t::fifo_enforcer);
         }
         void on_early_shutdown() {
             crash("illegal to destroy fifo_enforcer_sink_t while outstanding "
@@ -235,15 +235,62 @@ public:
         bool ended;
 
         fifo_enforcer_write_token_t token;
+
+        lock_wait_timer_t wait_timer;
+    };
+
+    /* Write tokens have consecutive timestamps, so waiting writers don't need to
+    be kept in a heap. Instead there is a slot for every timestamp after the last
+    write that was popped, and the front slot is the only one that can be popped
+    next. Pushing, peeking and popping are all O(1). */
+    class internal_write_queue_t {
+    public:
+        explicit internal_write_queue_t(state_timestamp_t last_popped) THROWS_NOTHING :
+            front_timestamp(last_popped.next()), count(0) { }
+        ~internal_write_queue_t() THROWS_NOTHING {
+            rassert(empty());
+        }
+
+        bool empty() const { return count == 0; }
+        size_t size() const { return count; }
+
+        void push(internal_exit_write_t *x, state_timestamp_t timestamp) THROWS_NOTHING;
+
+        /* Returns the operation for the write right after the last one that was
+        popped, or `nullptr` if it hasn't been pushed yet. */
+        internal_exit_write_t *peek() const {
+            return slots.empty() ? nullptr : slots.front();
+        }
+
+        /* Pops the operation returned by `peek()`. */
+        void pop() THROWS_NOTHING;
+
+        /* Replaces the operation that was pushed with `timestamp`. */
+        void swap_in_place(state_timestamp_t timestamp,
+                           internal_exit_write_t *to_remove,
+                           internal_exit_write_t *to_insert) THROWS_NOTHING;
+
+        /* Removes and returns any operation. Used to empty the queue on shutdown,
+        when the order doesn't matter. */
+        internal_exit_write_t *pop_any() THROWS_NOTHING;
+
+    private:
+        state_timestamp_t front_timestamp;
+        std::deque<internal_exit_write_t *> slots;
+        size_t count;
+
+        DISABLE_COPYING(internal_write_queue_t);
     };
 
     fifo_enforcer_sink_t() THROWS_NOTHING :
+        internal_write_queue(state_timestamp_t::zero()),
         popped_state(state_timestamp_t::zero(), 0),
         finished_state(state_timestamp_t::zero(), 0),
         in_pump(false)
         { }
 
     explicit fifo_enforcer_sink_t(fifo_enforcer_state_t init) THROWS_NOTHING :
+        internal_write_queue(init.last_timestamp),
         popped_state(init),
         finished_state(init),
         in_pump(false)
@@ -266,7 +313,7 @@ public:
 
     mutex_assertion_t internal_lock;
     intrusive_priority_queue_t<internal_exit_read_t> internal_read_queue;
-    intrusive_priority_queue_t<internal_exit_write_t> internal_write_queue;
+    internal_write_queue_t internal_write_queue;
 
 private:
     /* The difference between `popped_state` and `finished_state` is the
@@ -288,10 +335,5 @@ inline bool left_is_higher_priority(const fifo_enforcer_sink_t::internal_exit_re
     return left->get_token().timestamp < right->get_token().timestamp;
 }
 
-inline bool left_is_higher_priority(const fifo_enforcer_sink_t::internal_exit_write_t *left,
-                                    const fifo_enforcer_sink_t::internal_exit_write_t *right) {
-    return left->get_token().timestamp < right->get_token().timestamp;
-}
-
 
 #endif /* CONCURRENCY_FIFO_ENFORCER_HPP_ */
@@ -0,0 +1,64 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "concurrency/lock_contention.hpp"
+
+#include "arch/runtime/coro_profiler.hpp"
+#include "arch/runtime/runtime.hpp"
+#include "perfmon/perfmon.hpp"
+
+class lock_contention_stats_t {
+public:
+    lock_contention_stats_t(perfmon_collection_t *parent, const char *name)
+        : collection(threadnum_t(0)),
+          wait_duration(secs_to_ticks(1)),
+          queue_length(secs_to_ticks(1), false),
+          membership(parent, &collection, name),
+          stats_membership(&collection,
+                           &waits, "waits",
+                           &wait_duration, "wait_duration",
+                           &queue_length, "queue_length") { }
+
+    perfmon_collection_t collection;
+    perfmon_counter_t waits;
+    perfmon_histogram_t wait_duration;
+    perfmon_sampler_t queue_length;
+    perfmon_membership_t membership;
+    perfmon_multi_membership_t stats_membership;
+};
+
+// Like the coroutine stats, these are registered during static initialization, so
+// that registering them doesn't have to switch threads in the middle of a lock
+// operation.  Their home thread is the same as that of the global collection.
+static perfmon_collection_t pm_lock_contention(threadnum_t(0));
+static perfmon_membership_t pm_lock_contention_membership(
+    &get_global_perfmon_collection(), &pm_lock_contention, "lock_contention");
+static lock_contention_stats_t pm_lock_stats[] = {
+    {&pm_lock_contention, "rwlock"},
+    {&pm_lock_contention, "new_mutex"},
+    {&pm_lock_contention, "new_semaphore"},
+    {&pm_lock_contention, "page_acq"},
+    {&pm_lock_contention, "fifo_enforcer"}
+};
+
+static lock_contention_stats_t *stats_for(lock_kind_t kind) {
+    size_t index = static_cast<size_t>(kind);
+    rassert(index < sizeof(pm_lock_stats) / sizeof(pm_lock_stats[0]));
+    return &pm_lock_stats[index];
+}
+
+void lock_wait_timer_t::start(lock_kind_t kind, size_t queue_length) {
+    if (get_thread_id().threadnum < 0) {
+        return;
+    }
+    waiting_since_ = get_ticks();
+    lock_contention_stats_t *stats = stats_for(kind);
+    ++stats->waits;
+    stats->queue_length.record(queue_length);
+    PROFILER_RECORD_SAMPLE;
+}
+
+void lock_wait_timer_t::finish_waiting(lock_kind_t kind) {
+    const ticks_t now = get_ticks();
+    stats_for(kind)->wait_duration.record(
+        ticks_to_secs(ticks_t{now.nanos - waiting_since_.nanos}));
+    waiting_since_ = ticks_t{0};
+}
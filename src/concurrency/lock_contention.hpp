@@ -0,0 +1,48 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CONCURRENCY_LOCK_CONTENTION_HPP_
+#define CONCURRENCY_LOCK_CONTENTION_HPP_
+
+#include <stddef.h>
+
+#include "time.hpp"
+
+/* The coroutine locking primitives record how often acquirers have to wait in line,
+for how long, and how many acquirers were ahead of them.  The statistics are kept per
+kind of primitive, under `lock_contention` in the perfmon stats (and so in
+`rethinkdb._debug_stats`).  Acquisitions that don't have to wait don't touch them.
+
+If the server is built with `ENABLE_CORO_PROFILER`, every wait also records a coro
+profiler sample, so the profiler's report shows the execution points that end up
+waiting. */
+enum class lock_kind_t {
+    rwlock,
+    new_mutex,
+    new_semaphore,
+    page_acq,
+    fifo_enforcer
+};
+
+/* Each acquirer has one of these.  `start()` is called when the acquirer has to wait,
+and `finish()` when it gets the lock; `finish()` does nothing if the acquirer never
+waited, and neither records anything outside of the thread pool. */
+class lock_wait_timer_t {
+public:
+    lock_wait_timer_t() : waiting_since_(ticks_t{0}) { }
+
+    void start(lock_kind_t kind, size_t queue_length);
+    void finish(lock_kind_t kind) {
+        if (waiting_since_.nanos != 0) {
+            finish_waiting(kind);
+        }
+    }
+
+    // For acquirers that give up before they get the lock.
+    void cancel() { waiting_since_ = ticks_t{0}; }
+
+private:
+    void finish_waiting(lock_kind_t kind);
+
+    ticks_t waiting_since_;
+};
+
+#endif  // CONCURRENCY_LOCK_CONTENTION_HPP_
@@ -12,7 +12,7 @@
 
 class new_mutex_t {
 public:
-    new_mutex_t() { }
+    new_mutex_t() : rwlock_(rwlock_bias_t::fifo, lock_kind_t::new_mutex) { }
     ~new_mutex_t() { }
 
 private:
@@ -22,6 +22,9 @@ void new_semaphore_t::add_acquirer(new_semaphore_in_line_t *acq) {
     assert_thread();
     waiters_.push_back(acq);
     pulse_waiters();
+    if (!acq->cond_.is_pulsed()) {
+        acq->wait_timer_.start(lock_kind_t::new_semaphore, waiters_.size() - 1);
+    }
 }
 
 void new_semaphore_t::remove_acquirer(new_semaphore_in_line_t *acq) {
@@ -30,6 +33,7 @@ void new_semaphore_t::remove_acquirer(new_semaphore_in_line_t *acq) {
     if (acq->cond_.is_pulsed()) {
         current_ -= acq->count_;
     } else {
+        acq->wait_timer_.cancel();
         waiters_.remove(acq);
     }
     pulse_waiters();
@@ -42,6 +46,7 @@ void new_semaphore_t::pulse_waiters() {
             current_ += acq->count_;
             waiters_.remove(acq);
             acq->cond_.pulse();
+            acq->wait_timer_.finish(lock_kind_t::new_semaphore);
         } else {
             break;
         }
@@ -56,6 +61,7 @@ new_semaphore_in_line_t &new_semaphore_in_line_t::operator=(new_semaphore_in_lin
     new_semaphore_in_line_t tmp(std::move(movee));
     std::swap(semaphore_, tmp.semaphore_);
     std::swap(count_, tmp.count_);
+    std::swap(wait_timer_, tmp.wait_timer_);
     cond_.swap(tmp.cond_);
     return *this;
 }
@@ -90,7 +96,9 @@ new_semaphore_in_line_t::new_semaphore_in_line_t(new_semaphore_in_line_t &&movee
     : intrusive_list_node_t<new_semaphore_in_line_t>(std::move(movee)),
       semaphore_(movee.semaphore_),
       count_(movee.count_),
-      cond_(std::move(movee.cond_)) {
+      cond_(std::move(movee.cond_)),
+      wait_timer_(movee.wait_timer_) {
+    movee.wait_timer_.cancel();
     movee.semaphore_ = nullptr;
     movee.count_ = 0;
     movee.cond_.reset();
@@ -3,6 +3,7 @@
 #define CONCURRENCY_NEW_SEMAPHORE_HPP_
 
 #include "concurrency/cond_var.hpp"
+#include "concurrency/lock_contention.hpp"
 #include "containers/intrusive_list.hpp"
 
 // This semaphore obeys first-in-line/first-acquisition semantics.  The
@@ -99,6 +100,8 @@ private:
 
     // Gets pulsed when we have successfully acquired the semaphore.
     cond_t cond_;
+
+    lock_wait_timer_t wait_timer_;
     DISABLE_COPYING(new_semaphore_in_line_t);
 };
 
@@ -3,18 +3,52 @@
 #include "concurrency/interruptor.hpp"
 #include "valgrind.hpp"
 
-rwlock_t::rwlock_t() { }
+#define RWLOCK_MAX_READERS_OVERTAKING 64
+
+rwlock_t::rwlock_t(rwlock_bias_t bias, lock_kind_t kind)
+    : bias_(bias), kind_(kind), readers_overtaking_(0) { }
 
 rwlock_t::~rwlock_t() {
     guarantee(acqs_.empty());
 }
 
 void rwlock_t::add_acq(rwlock_in_line_t *acq) {
+    if (bias_ == rwlock_bias_t::readers
+        && acq->access_ == access_t::read
+        && readers_overtaking_ < RWLOCK_MAX_READERS_OVERTAKING) {
+        // Find the first acquirer that isn't a reader holding the lock.
+        rwlock_in_line_t *waiting = acqs_.head();
+        while (waiting != nullptr
+               && waiting->access_ == access_t::read
+               && waiting->read_cond_.is_pulsed()) {
+            waiting = acqs_.next(waiting);
+        }
+        if (waiting != nullptr && waiting != acqs_.head()) {
+            // The lock is held for read, and `waiting` is a write acquirer that
+            // waits for the readers.  We join them.  This doesn't change the
+            // situation of `waiting` or anything after it, so there is nothing else
+            // to pulse.
+            rassert(waiting->access_ == access_t::write);
+            acqs_.insert_before(acq, waiting);
+            acq->read_cond_.pulse();
+            ++readers_overtaking_;
+            return;
+        }
+    }
     acqs_.push_back(acq);
     pulse_pulsables(acq);
+    if (!(acq->access_ == access_t::read
+          ? acq->read_cond_.is_pulsed()
+          : acq->write_cond_.is_pulsed())) {
+        acq->wait_timer_.start(kind_, acqs_.size() - 1);
+    }
 }
 
 void rwlock_t::remove_acq(rwlock_in_line_t *acq) {
+    if (acq->access_ == access_t::write) {
+        readers_overtaking_ = 0;
+    }
+    acq->wait_timer_.cancel();
     rwlock_in_line_t *subsequent = acqs_.next(acq);
     acqs_.remove(acq);
     pulse_pulsables(subsequent);
@@ -34,6 +68,7 @@ void rwlock_t::pulse_pulsables(rwlock_in_line_t *p) {
         // read.)
         if (p->access_ == access_t::write && acqs_.prev(p) == nullptr) {
             p->write_cond_.pulse_if_not_already_pulsed();
+            p->wait_timer_.finish(kind_);
         }
         return;
     } else {
@@ -52,9 +87,11 @@ void rwlock_t::pulse_pulsables(rwlock_in_line_t *p) {
             if (p->access_ == access_t::write) {
                 if (prev == nullptr) {
                     p->write_cond_.pulse();
+                    p->wait_timer_.finish(kind_);
                 }
                 return;
             }
+            p->wait_timer_.finish(kind_);
             prev = p;
             p = acqs_.next(p);
         } while (p != nullptr);
@@ -74,7 +111,9 @@ rwlock_in_line_t::rwlock_in_line_t(rwlock_in_line_t &&other)
     : lock_(other.lock_),
       access_(other.access_),
       read_cond_(std::move(other.read_cond_)),
-      write_cond_(std::move(other.write_cond_)) {
+      write_cond_(std::move(other.write_cond_)),
+      wait_timer_(other.wait_timer_) {
+    other.wait_timer_.cancel();
     other.lock_ = nullptr;
     other.access_ = valgrind_undefined(access_t::read);
 }
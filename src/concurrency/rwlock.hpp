@@ -3,13 +3,30 @@
 
 #include "concurrency/access.hpp"
 #include "concurrency/cond_var.hpp"
+#include "concurrency/lock_contention.hpp"
 #include "containers/intrusive_list.hpp"
 
 class rwlock_in_line_t;
 
+/* By default, an `rwlock_t` grants the lock in the order in which acquirers got in
+line, so a read acquirer that arrives while the lock is held for read still waits for
+any write acquirer that is ahead of it.  With `rwlock_bias_t::readers`, a new read
+acquirer instead joins the readers that currently hold the lock, and overtakes the
+waiting write acquirer.  That keeps read-mostly locks from stalling all of their
+readers behind one rare writer.  So that the writer still gets its turn under a steady
+stream of readers, at most `RWLOCK_MAX_READERS_OVERTAKING` readers overtake it before
+the lock goes back to being FIFO.
+
+Don't use the reader bias for locks whose read acquirers rely on being ordered after
+earlier write acquirers, like the "spots" that changefeeds use to order updates. */
+enum class rwlock_bias_t { fifo, readers };
+
 class rwlock_t {
 public:
-    rwlock_t();
+    // `kind` only determines under which name waits for the lock show up in the
+    // lock contention stats.
+    explicit rwlock_t(rwlock_bias_t bias = rwlock_bias_t::fifo,
+                      lock_kind_t kind = lock_kind_t::rwlock);
     ~rwlock_t();
 
 private:
@@ -23,6 +40,13 @@ private:
     // current acquirer, the tail possibly containing a node that does not yet hold
     // the lock.
     intrusive_list_t<rwlock_in_line_t> acqs_;
+
+    const rwlock_bias_t bias_;
+    const lock_kind_t kind_;
+    // How many read acquirers have overtaken a waiting write acquirer since the last
+    // write acquirer left the line.
+    int readers_overtaking_;
+
     DISABLE_COPYING(rwlock_t);
 };
 
@@ -61,6 +85,7 @@ private:
     access_t access_;
     cond_t read_cond_;
     cond_t write_cond_;
+    lock_wait_timer_t wait_timer_;
 
     DISABLE_COPYING(rwlock_in_line_t);
 };
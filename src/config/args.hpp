@@ -31,6 +31,13 @@
 // decrease concurrency
 #define MAX_IO_EVENT_PROCESSING_BATCH_SIZE        50
 
+// After an event loop iteration that handled any events, the event queue keeps
+// polling without blocking for this long before it goes to sleep in the kernel.  Under
+// load the next event usually arrives within that window, and picking it up without a
+// sleep and a wakeup cuts latency.  An idle thread spins for at most this long.  Zero
+// turns busy polling off.
+#define EVENT_LOOP_BUSY_POLL_NSECS                20000
+
 // The io batch factor ensures a minimum number of i/o operations
 // which are picked from any specific i/o account consecutively.
 // A higher value might be advantageous for throughput if seek times
@@ -92,6 +99,11 @@
 // small values of this variable.
 #define MERGER_SERIALIZER_MAX_ACTIVE_WRITES       1
 
+// How many tables we open at the same time when the server starts up.  Opening a
+// table mostly waits for the serializer's LBA and metablock reads, so this keeps the
+// disk busy without flooding it when there are hundreds of tables.
+#define MAX_CONCURRENT_TABLE_LOADS                16
+
 // I/O priority of block writes in the merger_serializer_t
 #define MERGER_BLOCK_WRITE_IO_PRIORITY            64
 
@@ -130,6 +142,12 @@
 // It can't change unless you're very careful.)
 #define LBA_SHARD_FACTOR                          4
 
+// A serializer file can be striped over several files (see `striped_file_t`).  The
+// stripe unit defines the disk format of striped files, and must be a multiple of the
+// extent size.
+#define SERIALIZER_STRIPE_UNIT_SIZE               (8 * MEGABYTE)
+#define MAX_SERIALIZER_STRIPES                    64
+
 // How many bytes of buffering space we can use per disk when reading the LBA. If it's set
 // too high, then RethinkDB will eat a lot of memory at startup. This is bad because tcmalloc
 // doesn't return memory to the OS. If it's set too low, startup will take a longer time.
@@ -180,7 +198,11 @@
 // 2^(MESSAGE_SCHEDULER_MAX_PRIORITY - MESSAGE_SCHEDULER_MIN_PRIORITY + 1)
 #define MESSAGE_SCHEDULER_GRANULARITY           32
 
-// Priorities for specific tasks
+// Priorities for specific tasks.  Client queries run above the default priority, so
+// that the work a client is waiting for gets ahead of routine cluster bookkeeping on a
+// busy thread.  The coroutines a query spawns, and the ones it moves to other threads,
+// keep that priority.
+#define CORO_PRIORITY_CLIENT_QUERY              1
 #define CORO_PRIORITY_SINDEX_CONSTRUCTION       (-2)
 #define CORO_PRIORITY_BACKFILL_SENDER           (-2)
 #define CORO_PRIORITY_BACKFILL_RECEIVER         (-2)
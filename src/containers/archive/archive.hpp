@@ -176,6 +176,11 @@ struct serialize_universal_size_t;
         return archive_result_t::SUCCESS;                               \
     }
 
+// True for the types that are sent as their raw bytes, which means that an array of
+// them serializes to exactly its in-memory representation.
+template <class T>
+struct is_raw_serializable_t : public std::false_type { };
+
 // Designed for <stdint.h>'s u?int[0-9]+_t types, which are just sent
 // raw over the wire.
 //
@@ -225,7 +230,9 @@ struct serialize_universal_size_t;
         : public std::integral_constant<size_t, sizeof(typ)> { }; /* NOLINT(readability/braces) */       \
     template <>                                                         \
     struct serialize_universal_size_t<typ>                              \
-        : public std::integral_constant<size_t, sizeof(typ)> { }
+        : public std::integral_constant<size_t, sizeof(typ)> { }; /* NOLINT(readability/braces) */       \
+    template <>                                                         \
+    struct is_raw_serializable_t<typ> : public std::true_type { }
 
 
 ARCHIVE_PRIM_MAKE_RAW_SERIALIZABLE(unsigned char);  // NOLINT(runtime/int)
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "containers/archive/archive.hpp"
+#include "containers/archive/varint.hpp"
 
 // Reads from a buffer without taking ownership over it
 class buffer_read_stream_t : public read_stream_t {
@@ -37,6 +38,9 @@ public:
     int64_t tell() const { return pos_; }
 
 private:
+    friend archive_result_t deserialize_varint_uint64(
+        buffer_read_stream_t *s, uint64_t *value_out);
+
     int64_t pos_;
     const char *buf_;
     size_t size_;
@@ -44,5 +48,17 @@ private:
     DISABLE_COPYING(buffer_read_stream_t);
 };
 
+// Varints are read out of the buffer directly, rather than through a virtual `read()`
+// for every byte.
+inline archive_result_t deserialize_varint_uint64(
+        buffer_read_stream_t *s, uint64_t *value_out) {
+    size_t size;
+    archive_result_t res = decode_varint_uint64(
+        reinterpret_cast<const uint8_t *>(s->buf_ + s->pos_), s->size_ - s->pos_,
+        value_out, &size);
+    s->pos_ += size;
+    return res;
+}
+
 
 #endif  // CONTAINERS_ARCHIVE_BUFFER_STREAM_HPP_
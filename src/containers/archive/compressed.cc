@@ -0,0 +1,36 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "containers/archive/compressed.hpp"
+
+#include <zlib.h>
+
+bool deflate_message(const std::vector<char> &data, std::vector<char> *out) {
+    // Anything that doesn't come out smaller isn't worth it, so that's as much room
+    // as we give zlib.
+    out->resize(data.size());
+    uLongf deflated_size = out->size();
+    // Like `compress_block()`, we care more about speed than about the last few
+    // percent of compression.
+    const int res = compress2(reinterpret_cast<Bytef *>(out->data()),
+                              &deflated_size,
+                              reinterpret_cast<const Bytef *>(data.data()),
+                              data.size(),
+                              Z_BEST_SPEED);
+    if (res != Z_OK) {
+        // We only expect Z_BUF_ERROR, which means the data didn't compress well.
+        guarantee(res == Z_BUF_ERROR, "compress2 failed with error %d", res);
+        return false;
+    }
+    out->resize(deflated_size);
+    return true;
+}
+
+bool inflate_message(const char *data, size_t data_size,
+                     size_t size, std::vector<char> *out) {
+    out->resize(size);
+    uLongf inflated_size = size;
+    const int res = uncompress(reinterpret_cast<Bytef *>(out->data()),
+                               &inflated_size,
+                               reinterpret_cast<const Bytef *>(data),
+                               data_size);
+    return res == Z_OK && inflated_size == size;
+}
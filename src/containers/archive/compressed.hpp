@@ -0,0 +1,119 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_ARCHIVE_COMPRESSED_HPP_
+#define CONTAINERS_ARCHIVE_COMPRESSED_HPP_
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "containers/archive/archive.hpp"
+#include "containers/archive/buffer_stream.hpp"
+#include "containers/archive/varint.hpp"
+#include "containers/archive/vector_stream.hpp"
+
+/* `compressed_t<T>` holds a `T` whose serialization gets deflated before it goes over
+the network, if that makes it smaller. It's meant for big messages with compressible
+contents, such as chunks of backfill items.
+
+The serialized form is a `bool`, followed by either the serialized `T` if it's `false`,
+or by the size of the serialized `T` and its deflated version if it's `true`. Messages
+that are small or marked with `compress = false` (e.g. because they are going to the
+local server anyway) are sent as they are. */
+template <class T>
+class compressed_t {
+public:
+    compressed_t() : compress(true) { }
+    explicit compressed_t(T &&_value, bool _compress = true)
+        : value(std::move(_value)), compress(_compress) { }
+
+    T value;
+
+    /* Only used on the sending side */
+    bool compress;
+};
+
+/* Messages smaller than this aren't worth deflating. */
+static const size_t COMPRESSED_MIN_MESSAGE_SIZE = 1024;
+
+/* Sets `*out` to the deflated version of `data` and returns `true`, or returns `false`
+if that wouldn't be smaller than `data`. */
+bool deflate_message(const std::vector<char> &data, std::vector<char> *out);
+
+/* Inflates a message produced by `deflate_message()`. Returns `false` if `data` doesn't
+inflate to exactly `size` bytes. */
+MUST_USE bool inflate_message(const char *data, size_t data_size,
+                              size_t size, std::vector<char> *out);
+
+template <cluster_version_t W, class T>
+void serialize(write_message_t *wm, const compressed_t<T> &x) {
+    if (!x.compress) {
+        serialize<W>(wm, false);
+        serialize<W>(wm, x.value);
+        return;
+    }
+
+    write_message_t inner;
+    serialize<W>(&inner, x.value);
+    vector_stream_t stream;
+    stream.reserve(inner.size());
+    DEBUG_VAR int res = send_write_message(&stream, &inner);
+    rassert(res == 0);
+    std::vector<char> data;
+    stream.swap(&data);
+
+    std::vector<char> deflated;
+    if (data.size() >= COMPRESSED_MIN_MESSAGE_SIZE && deflate_message(data, &deflated)) {
+        serialize<W>(wm, true);
+        serialize_varint_uint64(wm, data.size());
+        serialize_varint_uint64(wm, deflated.size());
+        wm->append(deflated.data(), deflated.size());
+    } else {
+        serialize<W>(wm, false);
+        wm->append(data.data(), data.size());
+    }
+}
+
+template <cluster_version_t W, class T>
+MUST_USE archive_result_t deserialize(read_stream_t *s, compressed_t<T> *x) {
+    bool deflated;
+    archive_result_t res = deserialize<W>(s, &deflated);
+    if (bad(res)) { return res; }
+    if (!deflated) {
+        return deserialize<W>(s, &x->value);
+    }
+
+    uint64_t size, deflated_size;
+    res = deserialize_varint_uint64(s, &size);
+    if (bad(res)) { return res; }
+    res = deserialize_varint_uint64(s, &deflated_size);
+    if (bad(res)) { return res; }
+    // Deflate can't do any better than about 1032:1, so anything that claims to
+    // inflate by more than that is corrupted.
+    if (deflated_size > std::numeric_limits<size_t>::max()
+        || size / 1032 > deflated_size + 1) {
+        return archive_result_t::RANGE_ERROR;
+    }
+
+    std::vector<char> deflated_data(deflated_size);
+    int64_t num_read = force_read(s, deflated_data.data(), deflated_size);
+    if (num_read == -1) {
+        return archive_result_t::SOCK_ERROR;
+    }
+    if (num_read < static_cast<int64_t>(deflated_size)) {
+        return archive_result_t::SOCK_EOF;
+    }
+
+    std::vector<char> data;
+    if (!inflate_message(deflated_data.data(), deflated_data.size(), size, &data)) {
+        return archive_result_t::RANGE_ERROR;
+    }
+    buffer_read_stream_t stream(data.data(), data.size());
+    res = deserialize<W>(&stream, &x->value);
+    if (bad(res)) { return res; }
+    if (static_cast<uint64_t>(stream.tell()) != size) {
+        return archive_result_t::RANGE_ERROR;
+    }
+    return archive_result_t::SUCCESS;
+}
+
+#endif  // CONTAINERS_ARCHIVE_COMPRESSED_HPP_
@@ -136,26 +136,78 @@ MUST_USE archive_result_t deserialize(read_stream_t *s, std::string *out) {
 }
 
 
-// Think twice before using this function on vectors containing a primitive type --
-// it'll take O(n) time!
-// Keep in sync with serialize.
+// Vectors of types that are sent raw over the wire (see `is_raw_serializable_t`) are
+// serialized with a single copy; that produces the same bytes as serializing the
+// elements one by one.
+
 template <cluster_version_t W, class T>
-size_t serialized_size(const std::vector<T> &v) {
-    size_t ret = varint_uint64_serialized_size(v.size());
+size_t serialized_vector_elements_size(const std::vector<T> &v,
+                                       std::true_type /* raw */) {
+    return v.size() * sizeof(T);
+}
+
+template <cluster_version_t W, class T>
+size_t serialized_vector_elements_size(const std::vector<T> &v,
+                                       std::false_type /* raw */) {
+    size_t ret = 0;
     for (auto it = v.begin(), e = v.end(); it != e; ++it) {
         ret += serialized_size<W>(*it);
     }
     return ret;
 }
 
+// Keep in sync with serialize.
+template <cluster_version_t W, class T>
+size_t serialized_size(const std::vector<T> &v) {
+    return varint_uint64_serialized_size(v.size())
+        + serialized_vector_elements_size<W>(v, is_raw_serializable_t<T>());
+}
+
+template <cluster_version_t W, class T>
+void serialize_vector_elements(write_message_t *wm, const std::vector<T> &v,
+                               std::true_type /* raw */) {
+    wm->append(v.data(), v.size() * sizeof(T));
+}
+
+template <cluster_version_t W, class T>
+void serialize_vector_elements(write_message_t *wm, const std::vector<T> &v,
+                               std::false_type /* raw */) {
+    for (auto it = v.begin(), e = v.end(); it != e; ++it) {
+        serialize<W>(wm, *it);
+    }
+}
 
 // Keep in sync with serialized_size.
 template <cluster_version_t W, class T>
 void serialize(write_message_t *wm, const std::vector<T> &v) {
     serialize_varint_uint64(wm, v.size());
-    for (auto it = v.begin(), e = v.end(); it != e; ++it) {
-        serialize<W>(wm, *it);
+    serialize_vector_elements<W>(wm, v, is_raw_serializable_t<T>());
+}
+
+template <cluster_version_t W, class T>
+MUST_USE archive_result_t deserialize_vector_elements(read_stream_t *s,
+                                                      std::vector<T> *v,
+                                                      std::true_type /* raw */) {
+    const int64_t num_bytes = v->size() * sizeof(T);
+    int64_t res = force_read(s, v->data(), num_bytes);
+    if (res == -1) {
+        return archive_result_t::SOCK_ERROR;
+    }
+    if (res < num_bytes) {
+        return archive_result_t::SOCK_EOF;
+    }
+    return archive_result_t::SUCCESS;
+}
+
+template <cluster_version_t W, class T>
+MUST_USE archive_result_t deserialize_vector_elements(read_stream_t *s,
+                                                      std::vector<T> *v,
+                                                      std::false_type /* raw */) {
+    for (size_t i = 0; i < v->size(); ++i) {
+        archive_result_t res = deserialize<W>(s, &(*v)[i]);
+        if (bad(res)) { return res; }
     }
+    return archive_result_t::SUCCESS;
 }
 
 template <cluster_version_t W, class T>
@@ -171,12 +223,7 @@ MUST_USE archive_result_t deserialize(read_stream_t *s, std::vector<T> *v) {
     }
 
     v->resize(sz);
-    for (uint64_t i = 0; i < sz; ++i) {
-        res = deserialize<W>(s, &(*v)[i]);
-        if (bad(res)) { return res; }
-    }
-
-    return archive_result_t::SUCCESS;
+    return deserialize_vector_elements<W>(s, v, is_raw_serializable_t<T>());
 }
 
 template <cluster_version_t W, class T>
@@ -2,6 +2,10 @@
 #include "containers/archive/varint.hpp"
 
 size_t varint_uint64_serialized_size(uint64_t value) {
+#ifdef VARINT_WORD_AT_A_TIME
+    // One byte for every started group of seven significant bits.
+    return value == 0 ? 1 : (64 - __builtin_clzll(value) + 6) / 7;
+#else
     size_t count = 0;
 
     ++count;
@@ -13,6 +17,7 @@ size_t varint_uint64_serialized_size(uint64_t value) {
     }
 
     return count;
+#endif
 }
 
 void serialize_varint_uint64(write_message_t *wm, const uint64_t value) {
@@ -23,6 +28,20 @@ void serialize_varint_uint64(write_message_t *wm, const uint64_t value) {
 }
 
 size_t serialize_varint_uint64_into_buf(const uint64_t value, uint8_t *buf_out) {
+#ifdef VARINT_WORD_AT_A_TIME
+    if (value < (1ull << 56)) {
+        // Spread the 7-bit groups out into bytes, set the continuation bits and store
+        // the result in one go. This is the reverse of `decode_varint_uint64`.
+        const size_t size = varint_uint64_serialized_size(value);
+        uint64_t x = value;
+        x = (x & 0x000000000fffffffull) | ((x & 0x00fffffff0000000ull) << 4);
+        x = (x & 0x00003fff00003fffull) | ((x & 0x0fffc0000fffc000ull) << 2);
+        x = (x & 0x007f007f007f007full) | ((x & 0x3f803f803f803f80ull) << 1);
+        x |= 0x8080808080808080ull & ((1ull << (8 * (size - 1))) - 1);
+        memcpy(buf_out, &x, size);
+        return size;
+    }
+#endif
     size_t size = 0;
     if (value == 0) {
         buf_out[0] = 0;
@@ -2,8 +2,17 @@
 #ifndef CONTAINERS_ARCHIVE_VARINT_HPP_
 #define CONTAINERS_ARCHIVE_VARINT_HPP_
 
+#include <string.h>
+
 #include "containers/archive/archive.hpp"
 
+// On little-endian GCC-compatible builds, varints of up to eight bytes are encoded and
+// decoded a 64-bit word at a time instead of byte by byte.
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define VARINT_WORD_AT_A_TIME 1
+#endif
+
 // We don't use google::protobuf::io::CodedOutputStream::WriteVarint64ToArray because
 // we have no clean way of _reading_ varints without constructing a CodedInputStream,
 // which would require knowing the varint structure anyway in order to know how many
@@ -65,4 +74,53 @@ inline archive_result_t deserialize_varint_uint64(read_stream_t *s, uint64_t *va
     }
 }
 
+// Decodes a varint straight out of memory, where `available` bytes starting at `buf`
+// may be read. On success `*size_out` is the number of bytes the varint took up;
+// otherwise it's the number of bytes that were looked at. Returns the same results as
+// `deserialize_varint_uint64` would for a stream containing those bytes.
+inline archive_result_t decode_varint_uint64(const uint8_t *buf, size_t available,
+                                             uint64_t *value_out, size_t *size_out) {
+#ifdef VARINT_WORD_AT_A_TIME
+    if (available >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buf, sizeof(word));
+        // The high bit of each byte that ends a varint.
+        const uint64_t stops = ~word & 0x8080808080808080ull;
+        if (stops != 0) {
+            // Keep the bytes up to and including the first stop and drop the
+            // continuation bits, then squeeze the 7-bit groups together.
+            uint64_t x = word & (stops ^ (stops - 1)) & 0x7f7f7f7f7f7f7f7full;
+            x = (x & 0x007f007f007f007full) | ((x & 0x7f007f007f007f00ull) >> 1);
+            x = (x & 0x00003fff00003fffull) | ((x & 0x3fff00003fff0000ull) >> 2);
+            x = (x & 0x000000000fffffffull) | ((x & 0x0fffffff00000000ull) >> 4);
+            *value_out = x;
+            *size_out = (__builtin_ctzll(stops) + 1) / 8;
+            return archive_result_t::SUCCESS;
+        }
+    }
+#endif
+    uint64_t value = 0;
+    int offset = 0;
+    for (size_t i = 0; i < available; ++i) {
+        uint64_t x = (buf[i] & ((1 << 7) - 1));
+        value |= (x << offset);
+        if ((buf[i] & (1 << 7)) == 0) {
+            *size_out = i + 1;
+            if (offset == 63 && x > 1) {
+                return archive_result_t::RANGE_ERROR;
+            } else {
+                *value_out = value;
+                return archive_result_t::SUCCESS;
+            }
+        }
+        if (offset == 63) {
+            *size_out = i + 1;
+            return archive_result_t::RANGE_ERROR;
+        }
+        offset += 7;
+    }
+    *size_out = available;
+    return archive_result_t::SOCK_EOF;
+}
+
 #endif  // CONTAINERS_ARCHIVE_VARINT_HPP_
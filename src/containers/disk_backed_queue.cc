@@ -13,13 +13,37 @@
 
 internal_disk_backed_queue_t::internal_disk_backed_queue_t(io_backender_t *io_backender,
                                                            const serializer_filepath_t &filename,
-                                                           perfmon_collection_t *stats_parent)
+                                                           perfmon_collection_t *stats_parent,
+                                                           int64_t _memory_budget_bytes)
     : perfmon_membership(stats_parent, &perfmon_collection,
                          filename.permanent_path().c_str()),
       queue_size(0),
+      memory_queue_bytes(0),
+      memory_budget_bytes(_memory_budget_bytes),
+      disk_queue_size(0),
       head_block_id(NULL_BLOCK_ID),
       tail_block_id(NULL_BLOCK_ID),
-      file_opener(new filepath_file_opener_t(filename, io_backender)) {
+      file_opener(new filepath_file_opener_t(filename, io_backender)) { }
+
+internal_disk_backed_queue_t::~internal_disk_backed_queue_t() {
+    if (!serializer.has()) {
+        // We never spilled, so there is no file.
+        return;
+    }
+
+    /* First destroy the serializer, then remove the temporary file.
+    This avoids issues with certain file systems (specifically VirtualBox
+    shared folders), see https://github.com/rethinkdb/rethinkdb/issues/3791. */
+    cache_conn.reset();
+    cache.reset();
+    balancer.reset();
+    serializer.reset();
+
+    file_opener->unlink_serializer_file();
+}
+
+void internal_disk_backed_queue_t::create_disk_queue() {
+    guarantee(!serializer.has());
     log_serializer_t::create(file_opener.get(),
                                   log_serializer_t::static_config_t());
 
@@ -43,21 +67,35 @@ internal_disk_backed_queue_t::internal_disk_backed_queue_t(io_backender_t *io_ba
     txn.commit();
 }
 
-internal_disk_backed_queue_t::~internal_disk_backed_queue_t() {
-    /* First destroy the serializer, then remove the temporary file.
-    This avoids issues with certain file systems (specifically VirtualBox
-    shared folders), see https://github.com/rethinkdb/rethinkdb/issues/3791. */
-    cache_conn.reset();
-    cache.reset();
-    balancer.reset();
-    serializer.reset();
+bool internal_disk_backed_queue_t::push_to_memory(const write_message_t &wm) {
+    // Once something is on disk, everything after it has to go there too.
+    if (disk_queue_size != 0
+        || memory_queue_bytes + static_cast<int64_t>(wm.size()) > memory_budget_bytes) {
+        return false;
+    }
 
-    file_opener->unlink_serializer_file();
+    vector_stream_t stream;
+    stream.reserve(wm.size());
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    memory_queue.emplace_back();
+    stream.swap(&memory_queue.back());
+    memory_queue_bytes += memory_queue.back().size();
+
+    queue_size++;
+    return true;
 }
 
 void internal_disk_backed_queue_t::push(const write_message_t &wm) {
     mutex_t::acq_t mutex_acq(&mutex);
 
+    if (push_to_memory(wm)) {
+        return;
+    }
+    if (!serializer.has()) {
+        create_disk_queue();
+    }
+
     // There's no need for hard durability with an unlinked dbq file.
     txn_t txn(cache_conn.get(), write_durability_t::SOFT, 2);
 
@@ -69,10 +107,21 @@ void internal_disk_backed_queue_t::push(const write_message_t &wm) {
 void internal_disk_backed_queue_t::push(const scoped_array_t<write_message_t> &wms) {
     mutex_t::acq_t mutex_acq(&mutex);
 
+    size_t i = 0;
+    while (i < wms.size() && push_to_memory(wms[i])) {
+        ++i;
+    }
+    if (i == wms.size()) {
+        return;
+    }
+    if (!serializer.has()) {
+        create_disk_queue();
+    }
+
     // There's no need for hard durability with an unlinked dbq file.
     txn_t txn(cache_conn.get(), write_durability_t::SOFT, 2);
 
-    for (size_t i = 0; i < wms.size(); ++i) {
+    for (; i < wms.size(); ++i) {
         push_single(&txn, wms[i]);
     }
 
@@ -113,12 +162,25 @@ void internal_disk_backed_queue_t::push_single(txn_t *txn, const write_message_t
     head->data_size += blob.refsize(cache->max_block_size());
 
     queue_size++;
+    disk_queue_size++;
 }
 
 void internal_disk_backed_queue_t::pop(buffer_group_viewer_t *viewer) {
     guarantee(size() != 0);
     mutex_t::acq_t mutex_acq(&mutex);
 
+    if (!memory_queue.empty()) {
+        std::vector<char> data(std::move(memory_queue.front()));
+        memory_queue.pop_front();
+        memory_queue_bytes -= data.size();
+        queue_size--;
+
+        buffer_group_t group;
+        group.add_buffer(data.size(), data.data());
+        viewer->view_buffer_group(const_view(&group));
+        return;
+    }
+
     char buffer[DBQ_MAX_REF_SIZE];
     // No need for hard durability with an unlinked dbq file.
     txn_t txn(cache_conn.get(), write_durability_t::SOFT, 2);
@@ -165,6 +227,7 @@ void internal_disk_backed_queue_t::pop(buffer_group_viewer_t *viewer) {
     blob.clear(buf_parent_t(&_tail));
 
     queue_size--;
+    disk_queue_size--;
 
     _tail.reset_buf_lock();
 
@@ -2,6 +2,7 @@
 #ifndef CONTAINERS_DISK_BACKED_QUEUE_HPP_
 #define CONTAINERS_DISK_BACKED_QUEUE_HPP_
 
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -41,9 +42,13 @@ protected:
     DISABLE_COPYING(buffer_group_viewer_t);
 };
 
+/* Items are kept in memory for as long as they fit into `memory_budget_bytes`, and
+only spill into the serializer file once they don't.  The file itself is created on
+the first spill, so a queue that stays within its budget never touches the disk. */
 class internal_disk_backed_queue_t {
 public:
-    internal_disk_backed_queue_t(io_backender_t *io_backender, const serializer_filepath_t& filename, perfmon_collection_t *stats_parent);
+    internal_disk_backed_queue_t(io_backender_t *io_backender, const serializer_filepath_t& filename, perfmon_collection_t *stats_parent,
+                                 int64_t memory_budget_bytes = 0);
     ~internal_disk_backed_queue_t();
 
     void push(const write_message_t &value);
@@ -56,6 +61,8 @@ public:
     int64_t size();
 
 private:
+    bool push_to_memory(const write_message_t &value);
+    void create_disk_queue();
     void add_block_to_head(txn_t *txn);
     void remove_block_from_tail(txn_t *txn);
     void push_single(txn_t *txn, const write_message_t &value);
@@ -69,6 +76,13 @@ private:
 
     int64_t queue_size;
 
+    // The serialized items that haven't spilled, oldest first.  We only push onto
+    // this while nothing is on disk, so all of them are older than the items on disk.
+    std::deque<std::vector<char> > memory_queue;
+    int64_t memory_queue_bytes;
+    const int64_t memory_budget_bytes;
+    int64_t disk_queue_size;
+
     // The end we push onto.
     block_id_t head_block_id;
     // The end we pop from.
@@ -128,8 +142,9 @@ private:
 template <class T>
 class disk_backed_queue_t {
 public:
-    disk_backed_queue_t(io_backender_t *io_backender, const serializer_filepath_t& filename, perfmon_collection_t *stats_parent)
-        : internal_(io_backender, filename, stats_parent) { }
+    disk_backed_queue_t(io_backender_t *io_backender, const serializer_filepath_t& filename, perfmon_collection_t *stats_parent,
+                        int64_t memory_budget_bytes = 0)
+        : internal_(io_backender, filename, stats_parent, memory_budget_bytes) { }
 
     void push(const T &t) {
         // TODO: There's an unnecessary copying of data here (which would require a
@@ -143,6 +158,15 @@ public:
         internal_.push(wm);
     }
 
+    // Pushes all of `ts` in a single transaction.
+    void push(const std::vector<T> &ts) {
+        scoped_array_t<write_message_t> wms(ts.size());
+        for (size_t i = 0; i < ts.size(); ++i) {
+            serialize<cluster_version_t::LATEST_OVERALL>(&wms[i], ts[i]);
+        }
+        internal_.push(wms);
+    }
+
     void pop(T *out) {
         deserializing_viewer_t<T> viewer(out);
         internal_.pop(&viewer);
@@ -0,0 +1,68 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_LOSER_TREE_HPP_
+#define CONTAINERS_LOSER_TREE_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "errors.hpp"
+
+/* loser_tree_t is a tournament tree for k-way merges.  It tracks which of `n` inputs,
+identified by their index, currently has the best head.  `beats(a, b)` must be a strict
+total order on the inputs' current heads; callers that can have equal heads should
+break ties on the index.
+
+After the caller advances the winning input (and only that one), `replay_winner()`
+restores the tree with one comparison per level, i.e. O(log n) comparisons, instead
+of the n - 1 comparisons of rescanning all inputs. */
+
+template <class beats_t>
+class loser_tree_t {
+public:
+    loser_tree_t(size_t n, beats_t beats)
+        : n_(n), beats_(std::move(beats)), losers_(n) {
+        guarantee(n_ > 0);
+        // Leaf `i` is node `n + i`; internal node `j` has children `2j` and `2j + 1`.
+        // `winners[j]` is the input that won the match at node `j`.
+        std::vector<size_t> winners(2 * n_);
+        for (size_t i = 0; i < n_; ++i) {
+            winners[n_ + i] = i;
+        }
+        for (size_t j = n_ - 1; j >= 1; --j) {
+            size_t left = winners[2 * j];
+            size_t right = winners[2 * j + 1];
+            if (beats_(right, left)) {
+                std::swap(left, right);
+            }
+            winners[j] = left;
+            losers_[j] = right;
+        }
+        losers_[0] = n_ == 1 ? 0 : winners[1];
+    }
+
+    size_t winner() const {
+        return losers_[0];
+    }
+
+    // Call after the head of `winner()` has changed.
+    void replay_winner() {
+        size_t current = losers_[0];
+        for (size_t node = (n_ + current) / 2; node >= 1; node /= 2) {
+            if (beats_(losers_[node], current)) {
+                std::swap(losers_[node], current);
+            }
+        }
+        losers_[0] = current;
+    }
+
+private:
+    size_t n_;
+    beats_t beats_;
+    // `losers_[0]` is the overall winner, `losers_[j]` the loser of the last match at
+    // internal node `j`.
+    std::vector<size_t> losers_;
+
+    DISABLE_COPYING(loser_tree_t);
+};
+
+#endif  // CONTAINERS_LOSER_TREE_HPP_
@@ -1,7 +1,8 @@
 #ifndef CONTAINERS_RANGE_MAP_HPP_
 #define CONTAINERS_RANGE_MAP_HPP_
 
-#include <map>
+#include <utility>
+#include <vector>
 
 #include "debug.hpp"
 #include "rpc/serialize_macros.hpp"
@@ -10,7 +11,12 @@
 /* `range_map_t` maps from ranges delimited by `edge_t` to values of type `value_t`. The
 ranges must be contiguous and non-overlapping; adjacent ranges with the same value will
 be automatically coalesced. It can be thought of as a more efficient way of storing a
-mapping from `edge_t` to `value_t`. */
+mapping from `edge_t` to `value_t`.
+
+The zones are kept in a sorted `std::vector` rather than a `std::map`. The maps are small
+and are read far more often than they are modified (for example, every query is routed
+through one), so binary searches over contiguous memory beat walking a tree, and a whole
+map is a single allocation. Modifying a map costs time linear in its size. */
 template<class edge_t, class value_t>
 class range_map_t {
 public:
@@ -31,7 +37,7 @@ public:
     range_map_t(const edge_t &l, const edge_t &r, value_t &&v = value_t()) : left(l) {
         rassert(r >= l);
         if (r != l) {
-            zones.insert(std::make_pair(r, std::move(v)));
+            zones.emplace_back(r, std::move(v));
         }
         DEBUG_ONLY_CODE(validate());
     }
@@ -49,7 +55,7 @@ public:
     }
     const edge_t &right_edge() const {
         if (!zones.empty()) {
-            return (--zones.end())->first;
+            return zones.back().first;
         } else {
             return left;
         }
@@ -65,8 +71,7 @@ public:
     const value_t &lookup(const edge_t &before_point) const {
         rassert(before_point >= left_edge());
         rassert(before_point < right_edge());
-        auto it = zones.upper_bound(before_point);
-        return it->second;
+        return zones[upper_bound_index(before_point)].second;
     }
 
     /* Calls the given callback for every sub-range from `l` to `r`. If `l` or `r` lie
@@ -82,14 +87,14 @@ public:
         if (l == r) {
             return;
         }
-        auto it = zones.upper_bound(l);
+        size_t i = upper_bound_index(l);
         edge_t prev = l;
-        while (it->first < r) {
-            cb(prev, it->first, it->second);
-            prev = it->first;
-            ++it;
+        while (zones[i].first < r) {
+            cb(prev, zones[i].first, zones[i].second);
+            prev = zones[i].first;
+            ++i;
         }
-        cb(prev, r, it->second);
+        cb(prev, r, zones[i].second);
     }
 
     /* Derives a new `range_map_t` from some sub-range of this one by applying a function
@@ -162,7 +167,7 @@ public:
             return;
         }
         bool empty_before = empty_domain();
-        zones.insert(
+        zones.insert(zones.end(),
             std::make_move_iterator(other.zones.begin()),
             std::make_move_iterator(other.zones.end()));
         if (!empty_before) {
@@ -180,7 +185,7 @@ public:
             return;
         }
         bool empty_before = empty_domain();
-        zones.insert(std::make_pair(r, std::move(v)));
+        zones.emplace_back(r, std::move(v));
         if (!empty_before) {
             coalesce_at(l);
         }
@@ -195,7 +200,7 @@ public:
             return;
         }
         bool empty_before = empty_domain();
-        zones.insert(
+        zones.insert(zones.begin(),
             std::make_move_iterator(other.zones.begin()),
             std::make_move_iterator(other.zones.end()));
         if (!empty_before) {
@@ -211,7 +216,7 @@ public:
             return;
         }
         bool empty_before = empty_domain();
-        zones.insert(std::make_pair(r, std::move(v)));
+        zones.emplace(zones.begin(), r, std::move(v));
         if (!empty_before) {
             coalesce_at(r);
         }
@@ -231,13 +236,15 @@ public:
         /* If a single existing zone spans `other.left_edge(), then split it into two
         sub-zones at `other.right_edge()`. */
         if (other.left_edge() != left) {
-            auto split_it = zones.lower_bound(other.left_edge());
-            rassert(split_it != zones.end());
-            if (split_it->first == other.left_edge()) {
+            size_t split = lower_bound_index(other.left_edge());
+            rassert(split != zones.size());
+            if (zones[split].first == other.left_edge()) {
                 /* no need to split anything, `other.left_edge()` lies on a boundary
                 between two existing zones */
             } else {
-                zones.insert(std::make_pair(other.left_edge(), split_it->second));
+                value_t split_value = zones[split].second;
+                zones.emplace(zones.begin() + split,
+                    other.left_edge(), std::move(split_value));
             }
         } else {
             /* no need to split anything, `other.left_edge()` lies on the left edge of
@@ -248,14 +255,15 @@ public:
         dealt with the left edge case above. The right edge case will take care of itself
         naturally because one of `other`'s zones will implicitly split any existing zone
         that spans `other.right_edge()`. */
-        auto end = zones.lower_bound(other.right_edge());
-        if (end->first == other.right_edge()) {
+        size_t end = lower_bound_index(other.right_edge());
+        if (zones[end].first == other.right_edge()) {
             ++end;
         }
-        zones.erase(zones.upper_bound(other.left_edge()), end);
+        size_t begin = upper_bound_index(other.left_edge());
+        zones.erase(zones.begin() + begin, zones.begin() + end);
 
-        /* Move all the zones from `other` into us */
-        zones.insert(
+        /* Move all the zones from `other` into the gap we just made */
+        zones.insert(zones.begin() + begin,
             std::make_move_iterator(other.zones.begin()),
             std::make_move_iterator(other.zones.end()));
 
@@ -290,26 +298,26 @@ public:
         if (l == r) {
             return;
         }
-        auto it = zones.upper_bound(l);
-        if (l != left && zones.count(l) == 0) {
+        size_t i = upper_bound_index(l);
+        if (l != left && !(i > 0 && zones[i - 1].first == l)) {
             /* We need to chop off the part to the left of `l` */
-            DEBUG_VAR auto res = zones.insert(std::make_pair(l, it->second));
-            rassert(res.second);
+            value_t split_value = zones[i].second;
+            zones.emplace(zones.begin() + i, l, std::move(split_value));
+            ++i;
         }
         edge_t prev = l;
-        while (it->first < r) {
-            cb(prev, it->first, &it->second);
-            prev = it->first;
-            ++it;
+        while (zones[i].first < r) {
+            cb(prev, zones[i].first, &zones[i].second);
+            prev = zones[i].first;
+            ++i;
         }
-        if (it->first != r) {
+        if (zones[i].first != r) {
             /* We need to chop off the part to the right of `r` */
-            auto res = zones.insert(std::make_pair(r, it->second));
-            rassert(res.second);
-            it = res.first;
+            value_t split_value = zones[i].second;
+            zones.emplace(zones.begin() + i, r, std::move(split_value));
         }
-        rassert(it->first == r);
-        cb(prev, r, &it->second);
+        rassert(zones[i].first == r);
+        cb(prev, r, &zones[i].second);
         coalesce_range(l, r);
         DEBUG_ONLY_CODE(validate());
     }
@@ -322,16 +330,12 @@ private:
     left of `left`. */
     void validate() const {
         if (!zones.empty()) {
-            rassert(left < zones.begin()->first);
-            for (auto it = zones.begin();;) {
-                auto jt = it;
-                ++it;
-                if (it == zones.end()) {
-                    break;
-                }
+            rassert(left < zones.front().first);
+            for (size_t i = 1; i < zones.size(); ++i) {
+                rassert(zones[i - 1].first < zones[i].first);
                 /* Use `!(x == y)` instead of `x != y` because sometimes people are lazy
                 and don't define `!=` */
-                rassert(!(it->second == jt->second),
+                rassert(!(zones[i].second == zones[i - 1].second),
                     "adjacent equal values should have been coalesced");
             }
         }
@@ -342,13 +346,11 @@ private:
     merges them if they do. `edge` must correspond to an internal boundary between two
     sub-ranges. */
     void coalesce_at(const edge_t &edge) {
-        auto before_it = zones.find(edge);
-        rassert(before_it != zones.end());
-        auto after_it = before_it;
-        ++after_it;
-        rassert(after_it != zones.end());
-        if (before_it->second == after_it->second) {
-            zones.erase(before_it);
+        size_t before = find_index(edge);
+        rassert(before != zones.size());
+        rassert(before + 1 != zones.size());
+        if (zones[before].second == zones[before + 1].second) {
+            zones.erase(zones.begin() + before);
         }
     }
 
@@ -356,26 +358,61 @@ private:
     inclusive. `l` and `r` must be boundaries of sub-ranges, but they don't necessarily
     have to be internal boundaries; they can be the overall left and right edges. */
     void coalesce_range(const edge_t &l, const edge_t &r) {
-        auto it = (l == left) ? zones.begin() : zones.find(l);
-        while (it != zones.end() && it->first <= r) {
-            auto jt = it;
-            ++it;
-            if (it == zones.end()) {
+        size_t i = (l == left) ? 0 : find_index(l);
+        while (i < zones.size() && zones[i].first <= r) {
+            size_t j = i;
+            ++i;
+            if (i == zones.size()) {
                 break;
             }
-            if (jt->second == it->second) {
-                zones.erase(jt);
+            if (zones[j].second == zones[i].second) {
+                zones.erase(zones.begin() + j);
+                i = j;
             }
         }
     }
 
+    /* The index of the first zone whose right-hand edge is greater than `point`, or
+    `zones.size()` if there is none. The search narrows the range with conditional moves
+    instead of branches, since which way it goes is unpredictable. */
+    size_t upper_bound_index(const edge_t &point) const {
+        size_t base = 0, n = zones.size();
+        while (n > 0) {
+            size_t half = n / 2;
+            bool go_right = !(point < zones[base + half].first);
+            base = go_right ? base + half + 1 : base;
+            n = go_right ? n - half - 1 : half;
+        }
+        return base;
+    }
+
+    /* Like `upper_bound_index()`, but finds the first zone whose right-hand edge is
+    greater than or equal to `point`. */
+    size_t lower_bound_index(const edge_t &point) const {
+        size_t base = 0, n = zones.size();
+        while (n > 0) {
+            size_t half = n / 2;
+            bool go_right = zones[base + half].first < point;
+            base = go_right ? base + half + 1 : base;
+            n = go_right ? n - half - 1 : half;
+        }
+        return base;
+    }
+
+    /* The index of the zone whose right-hand edge is `edge`, or `zones.size()`. */
+    size_t find_index(const edge_t &edge) const {
+        size_t i = lower_bound_index(edge);
+        return (i != zones.size() && zones[i].first == edge) ? i : zones.size();
+    }
+
     /* Each sub-range corresponds to an entry in `zones`. The entry's key is the
     right-hand edge of the zone; the zone's left-hand edge is determined by the previous
-    entry's key. The first entry's left-hand edge is stored in `left`. Every method
-    coalesces adjacent zones before it returns. Sub-ranges always have non-zero width; if
-    the map has a zero-width domain then `zones` won't have any entries. */
+    entry's key. The entries are sorted by key, and the first entry's left-hand edge is
+    stored in `left`. Every method coalesces adjacent zones before it returns. Sub-ranges
+    always have non-zero width; if the map has a zero-width domain then `zones` won't
+    have any entries. */
     edge_t left;
-    std::map<edge_t, value_t> zones;
+    std::vector<std::pair<edge_t, value_t> > zones;
 };
 
 template<class E, class V>
@@ -366,6 +366,8 @@ TEMPLATE_ALIAS(scoped_page_aligned_ptr_t, scoped_alloc_t<T, raw_malloc_page_alig
 
 // A type for device-block-aligned pointers
 template <class T>
-TEMPLATE_ALIAS(scoped_device_block_aligned_ptr_t, scoped_alloc_t<T, raw_malloc_aligned<DEVICE_BLOCK_SIZE>, raw_free_aligned>);
+TEMPLATE_ALIAS(scoped_device_block_aligned_ptr_t,
+               scoped_alloc_t<T, raw_malloc_device_block_aligned,
+                              raw_free_device_block_aligned>);
 
 #endif  // CONTAINERS_SCOPED_HPP_
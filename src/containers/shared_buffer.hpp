@@ -60,6 +60,10 @@ public:
         rassert(buf.has());
     }
 
+    bool has() const {
+        return buf.has();
+    }
+
     const T *get() const {
         rassert(buf.has());
         rassert(buf->size() >= offset);
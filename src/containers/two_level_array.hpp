@@ -36,6 +36,7 @@ private:
         value_t values[CHUNK_SIZE];
     };
     std::vector<chunk_t *> chunks;
+    size_t allocated_chunks;
 
     static size_t chunk_for_key(size_t key) {
         size_t chunk_id = key / CHUNK_SIZE;
@@ -46,7 +47,7 @@ private:
     }
 
 public:
-    two_level_array_t() { }
+    two_level_array_t() : allocated_chunks(0) { }
     ~two_level_array_t() {
         for (auto it = chunks.begin(); it != chunks.end(); ++it) {
             delete *it;
@@ -62,6 +63,11 @@ public:
         }
     }
 
+    // The bytes allocated for the array, not counting the object itself.
+    size_t memory_usage() const {
+        return allocated_chunks * sizeof(chunk_t) + chunks.capacity() * sizeof(chunk_t *);
+    }
+
     void set(size_t key, value_t value) {
         const size_t chunk_id = chunk_for_key(key);
         if (chunk_id >= chunks.size() || chunks[chunk_id] == nullptr) {
@@ -72,6 +78,7 @@ public:
                     chunks.resize(chunk_id + 1, nullptr);
                 }
                 chunks[chunk_id] = new chunk_t;
+                ++allocated_chunks;
             }
         }
 
@@ -88,6 +95,7 @@ public:
         if (chunk->count == 0) {
             chunks[chunk_id] = nullptr;
             delete chunk;
+            --allocated_chunks;
 
             while (!chunks.empty() && chunks.back() == nullptr) {
                 chunks.pop_back();
@@ -2,6 +2,7 @@
 #include "extproc/extproc_job.hpp"
 #include "extproc/extproc_pool.hpp"
 #include "extproc/extproc_worker.hpp"
+#include "time.hpp"
 
 extproc_job_t::extproc_job_t(extproc_pool_t *_pool,
                              bool (*worker_fn) (read_stream_t *, write_stream_t *),
@@ -15,12 +16,15 @@ extproc_job_t::extproc_job_t(extproc_pool_t *_pool,
         combined_interruptor.add(user_interruptor);
     }
 
+    ticks_t wait_start = get_ticks();
     worker_lock.create(pool->get_worker_semaphore(), &combined_interruptor);
+    pool->on_job_started(ticks_t{get_ticks().nanos - wait_start.nanos});
 
     try {
         worker_lock.get()->get_value()->acquired(&combined_interruptor);
     } catch (...) {
         user_error = true;
+        pool->on_job_finished();
         throw;
     }
 
@@ -30,6 +34,7 @@ extproc_job_t::extproc_job_t(extproc_pool_t *_pool,
     } catch (...) {
         user_error = true;
         worker_lock.get()->get_value()->released(user_error, user_interruptor);
+        pool->on_job_finished();
         throw;
     }
 }
@@ -37,6 +42,7 @@ extproc_job_t::extproc_job_t(extproc_pool_t *_pool,
 extproc_job_t::~extproc_job_t() {
     assert_thread();
     worker_lock.get()->get_value()->released(user_error, user_interruptor);
+    pool->on_job_finished();
 }
 
 // All data written and read by the user must be accounted for, or things will break
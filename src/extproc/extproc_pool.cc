@@ -1,12 +1,26 @@
 // Copyright 2010-2013 RethinkDB, all rights reserved.
-#include "containers/object_buffer.hpp"
 #include "extproc/extproc_pool.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "containers/object_buffer.hpp"
 #include "extproc/extproc_spawner.hpp"
+#include "time.hpp"
+
+const size_t extproc_pool_t::MIN_WARM_WORKERS;
 
 extproc_pool_t::extproc_pool_t(size_t worker_count) :
     ct_interruptors(&interruptor),
     worker_cnt(0),
     prev_worker_cnt(0),
+    total_workers(worker_count),
+    busy_workers(0),
+    stats_membership(&get_global_perfmon_collection(), &stats_collection, "extproc"),
+    worker_wait_secs(secs_to_ticks(1), false),
+    stats_members(&stats_collection,
+                  &jobs_running, "jobs_running",
+                  &worker_wait_secs, "worker_wait_secs"),
     dealloc_timer(DEALLOC_TIMER_FREQ_MS, this),
     worker_semaphore(worker_count,
                      extproc_spawner_t::get_instance()),
@@ -46,6 +60,69 @@ void extproc_pool_t::dealloc_blocking(UNUSED signal_t *interruptor_) {
             worker_lock.get()->get_value()->kill_process();
         }
     }
+
+    warm_up_workers();
+}
+
+bool extproc_pool_t::warm_up_fn(UNUSED read_stream_t *stream_in,
+                                UNUSED write_stream_t *stream_out) {
+    return true;
+}
+
+void extproc_pool_t::warm_up_workers() {
+    size_t warm_count = std::min(MIN_WARM_WORKERS, total_workers);
+    if (busy_workers + warm_count > total_workers) {
+        // Most workers are busy, so they are alive anyway.  Don't make jobs wait
+        //  for us.
+        return;
+    }
+
+    // The semaphore hands out the most recently released workers first, so these
+    //  are the ones that the next jobs are going to get.
+    std::vector<scoped_ptr_t<cross_thread_semaphore_t<extproc_worker_t>::lock_t> >
+        worker_locks;
+    for (size_t i = 0; i < warm_count; ++i) {
+        worker_locks.push_back(
+            make_scoped<cross_thread_semaphore_t<extproc_worker_t>::lock_t>(
+                get_worker_semaphore(), get_shutdown_signal()));
+    }
+
+    for (const auto &worker_lock : worker_locks) {
+        extproc_worker_t *worker = worker_lock->get_value();
+        if (worker->is_process_alive()) {
+            continue;
+        }
+        bool errored = false;
+        try {
+            worker->acquired(get_shutdown_signal());
+        } catch (...) {
+            // Like in `extproc_job_t`, a worker that failed to be acquired doesn't
+            //  get released.
+            continue;
+        }
+        try {
+            worker->run_job(&warm_up_fn);
+        } catch (...) {
+            errored = true;
+        }
+        worker->released(errored, nullptr);
+    }
+
+    // Release the workers in reverse order, so they stay in the same order.
+    while (!worker_locks.empty()) {
+        worker_locks.pop_back();
+    }
+}
+
+void extproc_pool_t::on_job_started(ticks_t wait_ticks) {
+    ++busy_workers;
+    ++jobs_running;
+    worker_wait_secs.record(ticks_to_secs(wait_ticks));
+}
+
+void extproc_pool_t::on_job_finished() {
+    --busy_workers;
+    --jobs_running;
 }
 
 void extproc_pool_t::on_worker_acquired()
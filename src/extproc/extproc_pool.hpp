@@ -12,6 +12,7 @@
 #include "concurrency/cross_thread_semaphore.hpp"
 #include "concurrency/pump_coro.hpp"
 #include "extproc/extproc_worker.hpp"
+#include "perfmon/perfmon.hpp"
 
 // Extproc pool is used to acquire and release workers from any thread,
 //  must be created from within the thread pool
@@ -41,6 +42,11 @@ public:
         DISABLE_COPYING(worker_acq_t);
     };
 
+    // Called by `extproc_job_t` once it got hold of a worker after waiting for
+    //  `wait_ticks`, and once it is done with it.  Only used for the stats.
+    void on_job_started(ticks_t wait_ticks);
+    void on_job_finished();
+
 private:
     // The interruptor to be pulsed when shutting down
     cond_t interruptor;
@@ -63,6 +69,23 @@ private:
     void on_worker_acquired();
     void on_worker_released();
 
+    // The number of worker processes that we keep alive even while they are idle, so
+    //  that a burst of jobs doesn't have to wait for all of its workers to spawn.
+    static const size_t MIN_WARM_WORKERS = 2;
+    const size_t total_workers;
+    std::atomic<size_t> busy_workers;
+
+    // Spawns processes for idle workers until `MIN_WARM_WORKERS` of them are alive.
+    void warm_up_workers();
+    static bool warm_up_fn(read_stream_t *stream_in, write_stream_t *stream_out);
+
+    // These must outlive `worker_semaphore`, whose destructor waits for jobs to end.
+    perfmon_collection_t stats_collection;
+    perfmon_membership_t stats_membership;
+    perfmon_counter_t jobs_running;
+    perfmon_sampler_t worker_wait_secs;
+    perfmon_multi_membership_t stats_members;
+
     // Timer to trigger worker deallocation.
     repeating_timer_t dealloc_timer;
     static const int64_t DEALLOC_TIMER_FREQ_MS = 2000;
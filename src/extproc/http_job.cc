@@ -72,6 +72,25 @@ private:
     CURL *curl_handle;
 };
 
+// Shared by all requests that a worker process performs, so that they can reuse
+// connections, DNS lookups and TLS sessions from earlier `r.http` calls.  Workers
+// are single-threaded, so the share needs no lock callbacks.  Cookies are not
+// shared, every request only sees the cookies it was given.
+CURLSH *get_curl_share() {
+    static CURLSH *share = nullptr;
+    if (share == nullptr) {
+        share = curl_share_init();
+        if (share != nullptr) {
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
+    }
+    return share;
+}
+
 // Used for adding headers, which cannot be freed until after the request is done
 class scoped_curl_slist_t {
 public:
@@ -531,6 +550,18 @@ void set_default_opts(CURL *curl_handle,
 
     exc_setopt(curl_handle, CURLOPT_NOSIGNAL, 1, "NOSIGNAL");
 
+    CURLSH *share = get_curl_share();
+    if (share != nullptr) {
+        exc_setopt(curl_handle, CURLOPT_SHARE, share, "SHARE");
+    }
+    exc_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L, "TCP KEEPALIVE");
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    // Negotiate HTTP/2 for HTTPS requests if the server supports it.  This fails if
+    // libcurl was built without HTTP/2 support, in which case we stick to HTTP/1.1.
+    curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION,
+                     static_cast<long>(CURL_HTTP_VERSION_2TLS));  // NOLINT(runtime/int)
+#endif
+
     // Enable cookies - needed for multiple requests like redirects or digest auth
     exc_setopt(curl_handle, CURLOPT_COOKIEFILE, "", "COOKIEFILE");
 
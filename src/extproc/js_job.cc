@@ -151,6 +151,8 @@ public:
 enum js_task_t {
     TASK_EVAL,
     TASK_CALL,
+    TASK_EVAL_AND_CALL,
+    TASK_CALL_BATCH,
     TASK_RELEASE,
     TASK_EXIT
 };
@@ -209,6 +211,65 @@ js_result_t js_job_t::call(js_id_t id, const std::vector<ql::datum_t> &args) {
     return result;
 }
 
+js_result_t js_job_t::eval_and_call(const std::string &source,
+                                    const std::vector<ql::datum_t> &args,
+                                    js_result_t *eval_result_out) {
+    js_task_t task = js_task_t::TASK_EVAL_AND_CALL;
+    write_message_t wm;
+    wm.append(&task, sizeof(task));
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, source);
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, args);
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, limits);
+    {
+        int res = send_write_message(extproc_job.write_stream(), &wm);
+        if (res != 0) {
+            throw extproc_worker_exc_t("failed to send data to the worker");
+        }
+    }
+
+    js_result_t result;
+    archive_result_t res
+        = deserialize<cluster_version_t::LATEST_OVERALL>(extproc_job.read_stream(),
+                                                         eval_result_out);
+    if (!bad(res)) {
+        res = deserialize<cluster_version_t::LATEST_OVERALL>(extproc_job.read_stream(),
+                                                             &result);
+    }
+    if (bad(res)) {
+        throw extproc_worker_exc_t(strprintf("failed to deserialize eval and call "
+                                             "result from worker (%s)",
+                                             archive_result_as_str(res)));
+    }
+    return result;
+}
+
+std::vector<js_result_t> js_job_t::call_batch(
+        js_id_t id, const std::vector<std::vector<ql::datum_t> > &args) {
+    js_task_t task = js_task_t::TASK_CALL_BATCH;
+    write_message_t wm;
+    wm.append(&task, sizeof(task));
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, id);
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, args);
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, limits);
+    {
+        int res = send_write_message(extproc_job.write_stream(), &wm);
+        if (res != 0) {
+            throw extproc_worker_exc_t("failed to send data to the worker");
+        }
+    }
+
+    std::vector<js_result_t> results;
+    archive_result_t res
+        = deserialize<cluster_version_t::LATEST_OVERALL>(extproc_job.read_stream(),
+                                                         &results);
+    if (bad(res) || results.size() != args.size()) {
+        throw extproc_worker_exc_t(strprintf("failed to deserialize batched call "
+                                             "result from worker (%s)",
+                                             archive_result_as_str(res)));
+    }
+    return results;
+}
+
 void js_job_t::release(js_id_t id) {
     js_task_t task = js_task_t::TASK_RELEASE;
     write_message_t wm;
@@ -341,6 +402,87 @@ bool run_call(read_stream_t *stream_in,
     return send_js_result(stream_out, js_result);
 }
 
+bool run_eval_and_call(read_stream_t *stream_in,
+                       write_stream_t *stream_out,
+                       js_env_t *js_env,
+                       uint64_t task_counter) {
+    std::string source;
+    std::vector<ql::datum_t> args;
+    ql::configured_limits_t limits;
+    {
+        archive_result_t res
+            = deserialize<cluster_version_t::LATEST_OVERALL>(stream_in, &source);
+        if (bad(res)) { return false; }
+        res = deserialize<cluster_version_t::LATEST_OVERALL>(stream_in, &args);
+        if (bad(res)) { return false; }
+        res = deserialize<cluster_version_t::LATEST_OVERALL>(stream_in, &limits);
+        if (bad(res)) { return false; }
+    }
+
+    // If the evaluation doesn't result in a function, `call_result` is the same as
+    // `eval_result`.
+    js_result_t eval_result("");
+    js_result_t call_result("");
+    try {
+        eval_result = js_env->eval(source, limits);
+        call_result = eval_result;
+        js_id_t *fn_id = boost::get<js_id_t>(&eval_result);
+        if (fn_id != nullptr) {
+            call_result = js_env->call(*fn_id, args, limits);
+        }
+    } catch (const std::exception &e) {
+        call_result = e.what();
+    } catch (...) {
+        call_result = std::string("encountered an unknown exception");
+    }
+    if (boost::get<js_id_t>(&eval_result) == nullptr) {
+        eval_result = call_result;
+    }
+
+    js_env->run_other_tasks(task_counter);
+    write_message_t wm;
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, eval_result);
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, call_result);
+    return send_write_message(stream_out, &wm) == 0;
+}
+
+bool run_call_batch(read_stream_t *stream_in,
+                    write_stream_t *stream_out,
+                    js_env_t *js_env,
+                    uint64_t task_counter) {
+    js_id_t id;
+    std::vector<std::vector<ql::datum_t> > args;
+    ql::configured_limits_t limits;
+    {
+        archive_result_t res
+            = deserialize<cluster_version_t::LATEST_OVERALL>(stream_in, &id);
+        if (bad(res)) { return false; }
+        res = deserialize<cluster_version_t::LATEST_OVERALL>(stream_in, &args);
+        if (bad(res)) { return false; }
+        res = deserialize<cluster_version_t::LATEST_OVERALL>(stream_in, &limits);
+        if (bad(res)) { return false; }
+    }
+
+    std::vector<js_result_t> js_results;
+    js_results.reserve(args.size());
+    for (const auto &call_args : args) {
+        js_result_t js_result;
+        try {
+            js_result = js_env->call(id, call_args, limits);
+        } catch (const std::exception &e) {
+            js_result = e.what();
+        } catch (...) {
+            js_result = std::string("encountered an unknown exception");
+        }
+        js_results.push_back(std::move(js_result));
+    }
+
+    js_env->run_other_tasks(task_counter);
+    write_message_t wm;
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, js_results);
+    return send_write_message(stream_out, &wm) == 0;
+}
+
 bool run_release(read_stream_t *stream_in,
                  write_stream_t *stream_out,
                  js_env_t *js_env,
@@ -385,6 +527,16 @@ bool js_job_t::worker_fn(read_stream_t *stream_in, write_stream_t *stream_out) {
                 return false;
             }
             break;
+        case TASK_EVAL_AND_CALL:
+            if (!run_eval_and_call(stream_in, stream_out, &js_env, task_counter)) {
+                return false;
+            }
+            break;
+        case TASK_CALL_BATCH:
+            if (!run_call_batch(stream_in, stream_out, &js_env, task_counter)) {
+                return false;
+            }
+            break;
         case TASK_RELEASE:
             if (!run_release(stream_in, stream_out, &js_env, task_counter)) {
                 return false;
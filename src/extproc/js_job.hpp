@@ -21,6 +21,16 @@ public:
 
     js_result_t eval(const std::string &source);
     js_result_t call(js_id_t id, const std::vector<ql::datum_t> &args);
+    // Evaluates `source` and, if that results in a function, calls it with `args`,
+    // all in a single round trip to the worker.  The result of the evaluation is
+    // stored in `eval_result_out`.
+    js_result_t eval_and_call(const std::string &source,
+                              const std::vector<ql::datum_t> &args,
+                              js_result_t *eval_result_out);
+    // Calls the function `id` once for every element of `args`, in a single round
+    // trip to the worker.
+    std::vector<js_result_t> call_batch(
+        js_id_t id, const std::vector<std::vector<ql::datum_t> > &args);
     void release(js_id_t id);
     void exit();
 
@@ -3,7 +3,9 @@
 
 #include <inttypes.h>   // For PRIu64
 
+#include <deque>
 #include <map>
+#include <utility>
 
 #include "extproc/js_job.hpp"
 #include "time.hpp"
@@ -64,6 +66,10 @@ public:
     };
 
     std::map<std::string, func_info_t> id_cache;
+    // Results of `prefetch_calls`, in the order in which they are expected to be
+    //  requested, along with the arguments they were computed for.
+    std::string prefetched_source;
+    std::deque<std::pair<std::vector<ql::datum_t>, js_result_t> > prefetched;
     js_timeout_t js_timeout;
     wait_any_t combined_interruptor;
     js_job_t js_job;
@@ -82,11 +88,9 @@ void js_runner_t::end() {
     assert_thread();
     // Have the worker job exit its loop - if anything fails,
     //  don't worry, the worker will be cleaned up
+    // There is no need to release the cached functions one by one, exiting drops
+    //  the whole worker-side environment along with them.
     try {
-        for (auto it = job_data->id_cache.begin();
-             it != job_data->id_cache.end(); ++it) {
-            job_data->js_job.release(it->second.id);
-        }
         job_data->js_job.exit();
     } catch (...) {
         // Do nothing
@@ -172,24 +176,36 @@ js_result_t js_runner_t::call(const std::string &source,
     assert_thread();
     guarantee(job_data.has());
 
-    // This will retrieve the function from the cache if it's there, or re-eval it
-    js_result_t result = eval(source, config);
-    js_id_t *fn_id = boost::get<js_id_t>(&result);
-    if (fn_id == nullptr) {
-        if (boost::get<ql::datum_t>(&result) != nullptr) {
-            result = strprintf("Javascript query `%s` returned a value when it should "
-                               "have returned a function.", source.c_str());
+    if (!job_data->prefetched.empty()) {
+        if (job_data->prefetched_source == source
+            && job_data->prefetched.front().first == args) {
+            js_result_t result = std::move(job_data->prefetched.front().second);
+            job_data->prefetched.pop_front();
+            return result;
         }
-        return result;
+        job_data->prefetched.clear();
+    }
+
+    // If the function isn't cached yet, we evaluate and call it in one go, to save
+    //  a round trip to the worker.
+    auto it = job_data->id_cache.find(source);
+    js_result_t eval_result;
+    if (it != job_data->id_cache.end()) {
+        eval_result = it->second.id;
     }
 
+    js_result_t result;
     object_buffer_t<js_timeout_t::sentry_t> sentry;
     sentry.create(&job_data->js_timeout, config.timeout_ms);
 
     bool is_timeout = false;
     try {
         try {
-            result = job_data->js_job.call(*fn_id, args);
+            if (it != job_data->id_cache.end()) {
+                result = job_data->js_job.call(it->second.id, args);
+            } else {
+                result = job_data->js_job.eval_and_call(source, args, &eval_result);
+            }
         } catch (...) {
             // This inner try-catch block deals with cleanup after an exception, but due
             // to this we must store whether we triggered the timeout signal.
@@ -216,6 +232,19 @@ js_result_t js_runner_t::call(const std::string &source,
         }
     }
 
+    js_id_t *fn_id = boost::get<js_id_t>(&eval_result);
+    if (fn_id == nullptr) {
+        if (boost::get<ql::datum_t>(&eval_result) != nullptr) {
+            eval_result = strprintf("Javascript query `%s` returned a value when it "
+                                    "should have returned a function.",
+                                    source.c_str());
+        }
+        return eval_result;
+    }
+    if (it == job_data->id_cache.end()) {
+        cache_id(*fn_id, source);
+    }
+
     // If the call returned a function, cache it
     js_id_t *any_id = boost::get<js_id_t>(&result);
     if (any_id != nullptr) {
@@ -225,6 +254,57 @@ js_result_t js_runner_t::call(const std::string &source,
     return result;
 }
 
+void js_runner_t::prefetch_calls(const std::string &source,
+                                 const std::vector<std::vector<ql::datum_t> > &args,
+                                 const req_config_t &config) {
+    assert_thread();
+    guarantee(job_data.has());
+    job_data->prefetched.clear();
+
+    if (unbatchable_sources.count(source) != 0) {
+        return;
+    }
+
+    js_result_t eval_result = eval(source, config);
+    js_id_t *fn_id = boost::get<js_id_t>(&eval_result);
+    if (fn_id == nullptr || !job_data.has()) {
+        // The `call`s will report the error
+        return;
+    }
+
+    // The whole batch gets the timeout of a single call, so that a function that
+    //  never returns can't hold on to the worker for longer than it could before.
+    object_buffer_t<js_timeout_t::sentry_t> sentry;
+    sentry.create(&job_data->js_timeout, config.timeout_ms);
+
+    std::vector<js_result_t> results;
+    bool is_timeout = false;
+    try {
+        try {
+            results = job_data->js_job.call_batch(*fn_id, args);
+        } catch (...) {
+            // See the comments in `eval()`
+            is_timeout = job_data->js_timeout.get_signal()->is_pulsed();
+            sentry.reset();
+            job_data->js_job.worker_error();
+            job_data.reset();
+            throw;
+        }
+    } catch (interrupted_exc_t const &e) {
+        if (is_timeout) {
+            unbatchable_sources.insert(source);
+            return;
+        } else {
+            throw;
+        }
+    }
+
+    job_data->prefetched_source = source;
+    for (size_t i = 0; i < args.size(); ++i) {
+        job_data->prefetched.push_back(std::make_pair(args[i], std::move(results[i])));
+    }
+}
+
 void js_runner_t::cache_id(js_id_t id, const std::string &source) {
     guarantee(job_data.has());
     guarantee(id != INVALID_ID);
@@ -57,6 +57,15 @@ public:
                      const std::vector<ql::datum_t> &args,
                      const req_config_t &config);
 
+    // Calls the function given by `source` once for each element of `args` in a
+    // single round trip to the worker, and keeps the results for the `call`s with
+    // the same arguments that follow.  If the batch fails or doesn't finish within
+    // the timeout for a single call, nothing is kept and later `call`s run one at a
+    // time as usual.
+    void prefetch_calls(const std::string &source,
+                        const std::vector<std::vector<ql::datum_t> > &args,
+                        const req_config_t &config);
+
 private:
     static const size_t CACHE_SIZE;
 
@@ -71,6 +80,9 @@ private:
     class job_data_t;
     scoped_ptr_t<job_data_t> job_data;
 
+    // Functions that timed out in `prefetch_calls`; we don't batch their calls again.
+    std::set<std::string> unbatchable_sources;
+
     DISABLE_COPYING(js_runner_t);
 };
 
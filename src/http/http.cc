@@ -201,7 +201,24 @@ void http_res_t::set_body(const std::string& content_type, const std::string& co
     body = content;
 }
 
+void http_res_t::set_body_stream(const std::string &content_type,
+                                 body_stream_t stream) {
+    guarantee(header_lines.find("content-type") == header_lines.end());
+    guarantee(header_lines.find("content-length") == header_lines.end());
+    guarantee(body.size() == 0);
+
+    add_header_line("Content-Type", content_type);
+    add_header_line("Transfer-Encoding", "chunked");
+
+    body_stream = std::move(stream);
+}
+
 bool maybe_gzip_response(const http_req_t &req, http_res_t *res) {
+    // Streamed bodies are sent as they are produced.
+    if (res->body_stream) {
+        return false;
+    }
+
     // Don't bother zipping anything less than 0.5k
     size_t body_size = res->body.size();
     if (body_size < 512) {
@@ -402,7 +419,39 @@ void write_http_msg(tcp_conn_t *conn, const http_res_t &res, signal_t *closer) T
         conn->writef(closer, "%s: %s\r\n", line.first.c_str(), line.second.c_str());
     }
     conn->writef(closer, "\r\n");
-    conn->write(res.body.c_str(), res.body.size(), closer);
+    if (!res.body_stream) {
+        conn->write(res.body.c_str(), res.body.size(), closer);
+        return;
+    }
+
+    std::string chunk;
+    bool more;
+    do {
+        chunk.clear();
+        more = res.body_stream(&chunk, closer);
+        // An empty chunk would mark the end of the body.
+        if (!chunk.empty()) {
+            conn->writef(closer, "%zx\r\n", chunk.size());
+            conn->write(chunk.data(), chunk.size(), closer);
+            conn->writef(closer, "\r\n");
+        }
+    } while (more);
+    conn->writef(closer, "0\r\n\r\n");
+}
+
+/* Whether the connection can carry another request after this exchange.  HTTP/1.1
+defaults to keep-alive, older versions have to ask for it. */
+static bool keep_conn_alive(const http_req_t &req, const http_res_t &res) {
+    auto res_conn = res.header_lines.find("connection");
+    if (res_conn != res.header_lines.end() && boost::iequals(res_conn->second, "close")) {
+        return false;
+    }
+    optional<std::string> req_conn = req.find_header_line("connection");
+    if (req.version == "1.1") {
+        return !(req_conn && boost::iequals(*req_conn, "close"));
+    } else {
+        return req_conn && boost::iequals(*req_conn, "keep-alive");
+    }
 }
 
 void http_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn, auto_drainer_t::lock_t keepalive) {
@@ -419,33 +468,45 @@ void http_server_t::handle_conn(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn
         return;
     }
 
-    http_req_t req;
-    tcp_http_msg_parser_t http_msg_parser;
-
-    // Parse the request
+    // Serve requests until the client or we decide to close the connection
     try {
-        http_res_t res;
-        UNUSED bool peer_res = conn->getpeername(&req.peer);
-
-        if (http_msg_parser.parse(conn.get(), &req, keepalive.get_drain_signal())) {
-            application->handle(req, &res, keepalive.get_drain_signal());
-            res.version = req.version;
-            maybe_gzip_response(req, &res);
-        } else {
-            res = http_res_t(http_status_code_t::BAD_REQUEST);
-        }
+        bool keep_alive;
+        do {
+            http_req_t req;
+            tcp_http_msg_parser_t http_msg_parser;
+            http_res_t res;
+            UNUSED bool peer_res = conn->getpeername(&req.peer);
+
+            bool parsed =
+                http_msg_parser.parse(conn.get(), &req, keepalive.get_drain_signal());
+            if (parsed) {
+                application->handle(req, &res, keepalive.get_drain_signal());
+                res.version = req.version;
+                maybe_gzip_response(req, &res);
+            } else {
+                res = http_res_t(http_status_code_t::BAD_REQUEST);
+                // We don't know where the next request would start.
+                res.add_header_line("Connection", "close");
+            }
 
-        // Disable keepalive on Safari because it seems like a partial cause of #3983
-        auto user_agent = req.header_lines.find("user-agent");
-        if (user_agent != req.header_lines.end()) {
-            if (user_agent->second.find("Safari") != std::string::npos) {
-                // Chrome also has "Safari" in the user-agent string.
-                if (user_agent->second.find("Chrome") == std::string::npos) {
-                    res.add_header_line("Connection", "close");
+            // Disable keepalive on Safari because it seems like a partial cause of #3983
+            auto user_agent = req.header_lines.find("user-agent");
+            if (user_agent != req.header_lines.end()) {
+                if (user_agent->second.find("Safari") != std::string::npos) {
+                    // Chrome also has "Safari" in the user-agent string.
+                    if (user_agent->second.find("Chrome") == std::string::npos) {
+                        res.add_header_line("Connection", "close");
+                    }
                 }
             }
-        }
-        write_http_msg(conn.get(), res, keepalive.get_drain_signal());
+            // Responses without a length would be read until the connection closes.
+            if (!res.body_stream && res.header_lines.count("content-length") == 0) {
+                res.add_header_line("Content-Length",
+                                    strprintf("%zu", res.body.size()));
+            }
+            keep_alive = keep_conn_alive(req, res);
+            write_http_msg(conn.get(), res, keepalive.get_drain_signal());
+        } while (keep_alive);
     } catch (const interrupted_exc_t &) {
         // The query was interrupted, no response since we are shutting down
     } catch (const tcp_conn_read_closed_exc_t &) {
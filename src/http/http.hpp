@@ -2,6 +2,7 @@
 #ifndef HTTP_HTTP_HPP_
 #define HTTP_HTTP_HPP_
 
+#include <functional>
 #include <map>
 #include <string>
 #include <stdexcept>
@@ -96,8 +97,17 @@ public:
     std::map<std::string, std::string> header_lines;
     std::string body;
 
+    /* If set, the body is sent with chunked transfer encoding instead of from `body`.
+    The callback appends the next chunk to `chunk_out` and returns false once it has
+    produced the last one.  It runs after the application's `handle()` has returned,
+    so it must keep alive whatever it refers to. */
+    typedef std::function<bool(std::string *chunk_out, signal_t *interruptor)>
+        body_stream_t;
+    body_stream_t body_stream;
+
     void add_header_line(const std::string&, const std::string&);
     void set_body(const std::string&, const std::string&);
+    void set_body_stream(const std::string &content_type, body_stream_t stream);
 
     http_res_t();
     explicit http_res_t(http_status_code_t rescode);
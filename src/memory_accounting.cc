@@ -0,0 +1,50 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "memory_accounting.hpp"
+
+#include <atomic>
+
+#include "arch/runtime/runtime.hpp"
+#include "concurrency/cache_line_padded.hpp"
+#include "config/args.hpp"
+
+struct tagged_memory_t {
+    tagged_memory_t() {
+        for (int i = 0; i < NUM_MEMORY_TAGS; ++i) {
+            bytes[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    // Atomic because any thread may read it, and because threads outside of the
+    // thread pool share the last slot.
+    std::atomic<int64_t> bytes[NUM_MEMORY_TAGS];
+};
+
+static cache_line_padded_t<tagged_memory_t> tagged_memory[MAX_THREADS + 1];
+
+const char *memory_tag_name(memory_tag_t tag) {
+    switch (tag) {
+    case memory_tag_t::PAGE_CACHE: return "page_cache";
+    case memory_tag_t::LBA_INDEX: return "lba_index";
+    case memory_tag_t::COROUTINE_STACKS: return "coroutine_stacks";
+    default: unreachable();
+    }
+}
+
+void add_tagged_memory(memory_tag_t tag, int64_t bytes) {
+    int slot = get_thread_id().threadnum;
+    if (slot < 0 || slot >= MAX_THREADS) {
+        slot = MAX_THREADS;
+    }
+    tagged_memory[slot].value.bytes[static_cast<int>(tag)].fetch_add(
+        bytes, std::memory_order_relaxed);
+}
+
+int64_t get_tagged_memory(memory_tag_t tag) {
+    // Memory can be freed on a different thread than it was allocated on, so single
+    // slots can be negative, but the sum can't.
+    int64_t total = 0;
+    for (int slot = 0; slot <= MAX_THREADS; ++slot) {
+        total += tagged_memory[slot].value.bytes[static_cast<int>(tag)].load(
+            std::memory_order_relaxed);
+    }
+    return total;
+}
@@ -0,0 +1,51 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef MEMORY_ACCOUNTING_HPP_
+#define MEMORY_ACCOUNTING_HPP_
+
+#include <stdint.h>
+
+#include "errors.hpp"
+
+/* Keeps a running total of the memory that each of the big consumers holds, so that we
+can tell what a server's memory goes to (see `memory_checker_t`).  The totals are kept
+per thread and only added up when somebody asks for them, so that accounting an
+allocation is cheap. */
+
+enum class memory_tag_t {
+    PAGE_CACHE = 0,
+    LBA_INDEX,
+    COROUTINE_STACKS,
+};
+
+static const int NUM_MEMORY_TAGS = 3;
+
+const char *memory_tag_name(memory_tag_t tag);
+
+// `bytes` is negative for memory that was freed.  May be called on any thread.
+void add_tagged_memory(memory_tag_t tag, int64_t bytes);
+
+int64_t get_tagged_memory(memory_tag_t tag);
+
+/* For consumers that know how much memory they hold, but not when it changes.  Call
+`set()` with the current size every now and then; the destructor returns whatever
+was last reported. */
+class tagged_memory_reporter_t {
+public:
+    explicit tagged_memory_reporter_t(memory_tag_t _tag) : tag(_tag), reported(0) { }
+    ~tagged_memory_reporter_t() { set(0); }
+
+    void set(int64_t bytes) {
+        if (bytes != reported) {
+            add_tagged_memory(tag, bytes - reported);
+            reported = bytes;
+        }
+    }
+
+private:
+    const memory_tag_t tag;
+    int64_t reported;
+
+    DISABLE_COPYING(tagged_memory_reporter_t);
+};
+
+#endif  // MEMORY_ACCOUNTING_HPP_
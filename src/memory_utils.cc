@@ -14,6 +14,7 @@
 #endif  // _WIN32
 
 #include "errors.hpp"
+#include "slab_allocator.hpp"
 
 void *raw_malloc_aligned(size_t size, size_t alignment) {
     void *ptr = nullptr;
@@ -51,6 +52,28 @@ void raw_free_aligned(void *ptr) {
 #endif
 }
 
+void *raw_malloc_device_block_aligned(size_t size) {
+    if (size > 0 && size <= SLAB_MAX_BUFFER_SIZE) {
+        slab_allocator_t *slabs = slab_allocator_t::get();
+        if (slabs != nullptr) {
+            void *res = slabs->allocate(size);
+            if (res != nullptr) {
+                return res;
+            }
+        }
+    }
+    return raw_malloc_aligned(size, DEVICE_BLOCK_SIZE);
+}
+
+void raw_free_device_block_aligned(void *ptr) {
+    slab_allocator_t *slabs = slab_allocator_t::get();
+    if (slabs != nullptr && slabs->owns(ptr)) {
+        slabs->deallocate(ptr);
+    } else {
+        raw_free_aligned(ptr);
+    }
+}
+
 void *rmalloc(size_t size) {
     void *res = malloc(size);  // NOLINT(runtime/rethinkdb_fn)
     if (UNLIKELY(res == nullptr && size != 0)) {
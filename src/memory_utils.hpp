@@ -10,6 +10,12 @@ void raw_free_aligned(void *ptr);
 void *raw_malloc_page_aligned(size_t size);
 #endif
 
+/* For buffers aligned to DEVICE_BLOCK_SIZE, such as the cache's pages.  Small ones come
+from the `slab_allocator_t`.  Buffers from `raw_malloc_device_block_aligned()` must be
+freed with `raw_free_device_block_aligned()`. */
+void *raw_malloc_device_block_aligned(size_t size);
+void raw_free_device_block_aligned(void *ptr);
+
 /* Calls `malloc()` and checks its return value to crash if the allocation fails. */
 void *rmalloc(size_t size);
 /* Calls `realloc()` and checks its return value to crash if the allocation fails. */
@@ -3,10 +3,94 @@
 #include <string.h>
 #include <string>
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define UTF8_X86_KERNELS 1
+#else
+#define UTF8_X86_KERNELS 0
+#endif
+
 #include "rdb_protocol/datum_string.hpp"
 
 namespace utf8 {
 
+/* Most strings are mostly ASCII, which is always valid.  Validation skips runs of
+ASCII bytes with these kernels, which return the length of the ASCII prefix of the
+`n` bytes at `p`, and only decodes the other bytes one codepoint at a time.  That
+keeps the errors (and their positions) exactly those of `next_codepoint`. */
+
+static size_t ascii_prefix_length_scalar(const char *p, size_t n) {
+    const uint64_t high_bits = 0x8080808080808080ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(word));
+        if ((word & high_bits) != 0) {
+            break;
+        }
+    }
+    while (i < n && (p[i] & 0x80) == 0) {
+        ++i;
+    }
+    return i;
+}
+
+#if UTF8_X86_KERNELS
+
+// SSE2 is part of x86-64.
+static size_t ascii_prefix_length_sse2(const char *p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        const __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i + 16));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(a))
+            | (static_cast<uint32_t>(_mm_movemask_epi8(b)) << 16);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + ascii_prefix_length_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t ascii_prefix_length_avx2(const char *p, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const __m256i a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        const __m256i b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + 32));
+        const uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(a))
+            | (static_cast<uint64_t>(
+                   static_cast<uint32_t>(_mm256_movemask_epi8(b))) << 32);
+        if (mask != 0) {
+            return i + __builtin_ctzll(mask);
+        }
+    }
+    return i + ascii_prefix_length_sse2(p + i, n - i);
+}
+
+#endif  // UTF8_X86_KERNELS
+
+typedef size_t (*ascii_prefix_length_fn_t)(const char *, size_t);
+
+static ascii_prefix_length_fn_t pick_ascii_prefix_length_kernel() {
+#if UTF8_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return &ascii_prefix_length_avx2;
+    }
+    return &ascii_prefix_length_sse2;
+#else
+    return &ascii_prefix_length_scalar;
+#endif
+}
+
+static size_t ascii_prefix_length(const char *p, size_t n) {
+    static const ascii_prefix_length_fn_t kernel = pick_ascii_prefix_length_kernel();
+    return kernel(p, n);
+}
+
 static unsigned int HIGH_BIT = 0x80;
 static unsigned int HIGH_TWO_BITS = 0xC0;
 static unsigned int HIGH_THREE_BITS = 0xE0;
@@ -50,12 +134,17 @@ inline unsigned int extract_and_shift(char c, unsigned int bits, unsigned int am
     return extract_bits(c, bits) << amount;
 }
 
-template <class Iterator>
-inline bool is_valid_internal(Iterator begin, Iterator end, reason_t *reason) {
+inline bool is_valid_internal(const char *begin, const char *end, reason_t *reason) {
     char32_t codepoint;
-    Iterator cbegin = begin;
-    Iterator cend = begin;
+    const char *cbegin = begin;
+    const char *cend = begin;
     while (cbegin != end) {
+        if ((*cbegin & 0x80) == 0) {
+            cbegin += ascii_prefix_length(cbegin, end - cbegin);
+            if (cbegin == end) {
+                break;
+            }
+        }
         cend = next_codepoint(cbegin, end, &codepoint, reason);
         if (*(reason->explanation) != 0) {
             // need to correct offset, because `next_codepoint`
@@ -110,7 +199,7 @@ bool is_valid(const datum_string_t &str) {
 
 bool is_valid(const std::string &str) {
     reason_t reason;
-    return is_valid_internal(str.begin(), str.end(), &reason);
+    return is_valid_internal(str.data(), str.data() + str.size(), &reason);
 }
 
 bool is_valid(const char *start, const char *end) {
@@ -123,7 +212,7 @@ bool is_valid(const datum_string_t &str, reason_t *reason) {
 }
 
 bool is_valid(const std::string &str, reason_t *reason) {
-    return is_valid_internal(str.begin(), str.end(), reason);
+    return is_valid_internal(str.data(), str.data() + str.size(), reason);
 }
 
 bool is_valid(const char *start, const char *end, reason_t *reason) {
@@ -1,19 +1,30 @@
 // Copyright 2010-2012 RethinkDB, all rights reserved.
 #include "perfmon/collect.hpp"
 #include "concurrency/pmap.hpp"
+#include "perfmon/filter.hpp"
 
 /* This is the function that actually gathers the stats. It is illegal to create or destroy
 perfmon_t objects while perfmon_get_stats is active. */
-static void co_perfmon_visit(int thread, void *data) {
+static void co_perfmon_visit(int thread, perfmon_t *perfmon, void *data) {
     on_thread_t moving((threadnum_t(thread)));
-    get_global_perfmon_collection().visit_stats(data);
+    perfmon->visit_stats(data);
 }
 
 int get_num_threads();
 
 ql::datum_t perfmon_get_stats() {
-    void *data = get_global_perfmon_collection().begin_stats();
-    pmap(get_num_threads(), std::bind(&co_perfmon_visit, ph::_1, data));
-    return get_global_perfmon_collection().end_stats(data);
+    return perfmon_get_stats(&get_global_perfmon_collection());
 }
 
+ql::datum_t perfmon_get_stats(perfmon_t *perfmon) {
+    void *data = perfmon->begin_stats();
+    pmap(get_num_threads(), std::bind(&co_perfmon_visit, ph::_1, perfmon, data));
+    return perfmon->end_stats(data);
+}
+
+ql::datum_t perfmon_get_stats(const perfmon_filter_t &filter) {
+    perfmon_collection_t *perfmon = &get_global_perfmon_collection();
+    void *data = perfmon->begin_stats(filter, 0, filter.all_active());
+    pmap(get_num_threads(), std::bind(&co_perfmon_visit, ph::_1, perfmon, data));
+    return filter.filter(perfmon->end_stats(data));
+}
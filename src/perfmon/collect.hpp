@@ -4,10 +4,20 @@
 
 #include "perfmon/core.hpp"
 
+class perfmon_filter_t;
+
 /* `perfmon_get_stats()` collects all the stats about the server and puts them
  * into the `ql::datum_t` object. It must be run in a coroutine and it
  * blocks until it is done.
  */
 ql::datum_t perfmon_get_stats();
 
+/* Like `perfmon_get_stats()`, but only collects the stats of `perfmon`. */
+ql::datum_t perfmon_get_stats(perfmon_t *perfmon);
+
+/* Like `perfmon_get_stats()`, but only returns the stats that pass `filter`.
+ * Subtrees that don't match any of the filter's paths aren't collected at all.
+ */
+ql::datum_t perfmon_get_stats(const perfmon_filter_t &filter);
+
 #endif  // PERFMON_COLLECT_HPP_
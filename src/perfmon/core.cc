@@ -5,6 +5,7 @@
 #include "containers/scoped.hpp"
 #include "logger.hpp"
 #include "perfmon/core.hpp"
+#include "perfmon/filter.hpp"
 #include "utils.hpp"
 
 /* Constructor and destructor register and deregister the perfmon. */
@@ -20,12 +21,15 @@ private:
     cross_thread_mutex_t::acq_t lock_sentry;
 public:
     scoped_array_t<void *> contexts;
+    // False for the constituents that a filter left out.
+    std::vector<bool> collected;
 
     stats_collection_context_t(cross_thread_mutex_t *constituents_lock,
                                const intrusive_list_t<perfmon_membership_t> &constituents) :
         lock_sentry(constituents_lock),
         contexts(new void *[constituents.size()](),
-                 constituents.size()) { }
+                 constituents.size()),
+        collected(constituents.size(), true) { }
 
     ~stats_collection_context_t() { }
 };
@@ -47,11 +51,47 @@ void *perfmon_collection_t::begin_stats() {
     return ctx;
 }
 
+void *perfmon_collection_t::begin_stats(const perfmon_filter_t &filter,
+                                        size_t depth,
+                                        const std::vector<bool> &active) {
+    if (filter.matches_everything(depth, active)) {
+        return begin_stats();
+    }
+
+    stats_collection_context_t *ctx =
+        new stats_collection_context_t(&constituents_access, constituents);
+
+    size_t i = 0;
+    for (perfmon_membership_t *p = constituents.head(); p != nullptr; p = constituents.next(p), ++i) {
+        perfmon_collection_t *collection =
+            dynamic_cast<perfmon_collection_t *>(p->get());
+        if (p->splice()) {
+            // We can't tell which keys other perfmons splice in until we have
+            // collected them, so only collections get filtered here.
+            ctx->contexts[i] = collection != nullptr
+                ? collection->begin_stats(filter, depth, active)
+                : p->get()->begin_stats();
+            continue;
+        }
+        std::vector<bool> subactive;
+        if (!filter.matches_child(p->name, depth, active, &subactive)) {
+            ctx->collected[i] = false;
+        } else if (collection != nullptr) {
+            ctx->contexts[i] = collection->begin_stats(filter, depth + 1, subactive);
+        } else {
+            ctx->contexts[i] = p->get()->begin_stats();
+        }
+    }
+    return ctx;
+}
+
 void perfmon_collection_t::visit_stats(void *_context) {
     stats_collection_context_t *ctx = reinterpret_cast<stats_collection_context_t*>(_context);
     size_t i = 0;
     for (perfmon_membership_t *p = constituents.head(); p != nullptr; p = constituents.next(p), ++i) {
-        p->get()->visit_stats(ctx->contexts[i]);
+        if (ctx->collected[i]) {
+            p->get()->visit_stats(ctx->contexts[i]);
+        }
     }
 }
 
@@ -62,6 +102,9 @@ ql::datum_t perfmon_collection_t::end_stats(void *_context) {
 
     size_t i = 0;
     for (perfmon_membership_t *p = constituents.head(); p != nullptr; p = constituents.next(p), ++i) {
+        if (!ctx->collected[i]) {
+            continue;
+        }
         ql::datum_t stat = p->get()->end_stats(ctx->contexts[i]);
         if (p->splice()) {
             for (size_t j = 0; j < stat.obj_size(); ++j) {
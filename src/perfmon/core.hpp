@@ -15,6 +15,7 @@
 #include "threading.hpp"
 
 class perfmon_collection_t;
+class perfmon_filter_t;
 class scoped_regex_t;
 
 /* The perfmon (short for "PERFormance MONitor") is responsible for gathering
@@ -60,6 +61,13 @@ public:
     void visit_stats(void *_contexts);
     ql::datum_t end_stats(void *_contexts);
 
+    /* Like `begin_stats()`, but leaves out the constituents that `filter` would
+    drop from the result anyway, so that they don't get visited on every thread.
+    `depth` and `active` say where this collection is in the filter's paths. */
+    void *begin_stats(const perfmon_filter_t &filter,
+                      size_t depth,
+                      const std::vector<bool> &active);
+
 private:
     friend class perfmon_membership_t;
 
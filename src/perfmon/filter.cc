@@ -33,7 +33,41 @@ perfmon_filter_t::perfmon_filter_t(const std::set<std::vector<std::string> > &pa
 
 ql::datum_t perfmon_filter_t::filter(const ql::datum_t &stats) const {
     guarantee(stats.has(), "perfmon_filter_t::filter was passed an uninitialized datum");
-    return subfilter(stats, 0, std::vector<bool>(regexps.size(), true));
+    return subfilter(stats, 0, all_active());
+}
+
+std::vector<bool> perfmon_filter_t::all_active() const {
+    return std::vector<bool>(regexps.size(), true);
+}
+
+bool perfmon_filter_t::matches_everything(size_t depth,
+                                          const std::vector<bool> &active) const {
+    for (size_t j = 0; j < regexps.size(); ++j) {
+        if (active[j] && depth >= regexps[j].size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool perfmon_filter_t::matches_child(const std::string &name,
+                                     size_t depth,
+                                     const std::vector<bool> &active,
+                                     std::vector<bool> *subactive_out) const {
+    *subactive_out = active;
+    bool some_subpath = false;
+    for (size_t j = 0; j < regexps.size(); ++j) {
+        if (!active[j]) {
+            continue;
+        }
+        if (depth >= regexps[j].size()) {
+            some_subpath = true;
+            continue;
+        }
+        (*subactive_out)[j] = RE2::FullMatch(name, *regexps[j][depth]);
+        some_subpath |= (*subactive_out)[j];
+    }
+    return some_subpath;
 }
 
 /* Filter a perfmon result.  [depth] is how deep we are in the paths that
@@ -47,24 +81,11 @@ ql::datum_t perfmon_filter_t::subfilter(const ql::datum_t &stats,
         ql::datum_object_builder_t builder;
 
         for (size_t i = 0; i < stats.obj_size(); ++i) {
-            std::vector<bool> subactive = active;
+            std::vector<bool> subactive;
             std::pair<datum_string_t, ql::datum_t> pair = stats.get_pair(i);
 
-            bool some_subpath = false;
-            for (size_t j = 0; j < regexps.size(); ++j) {
-                if (!active[j]) {
-                    continue;
-                }
-                if (depth >= regexps[j].size()) {
-                    some_subpath = true;
-                    continue;
-                }
-                subactive[j] = RE2::FullMatch(pair.first.to_std(), *regexps[j][depth]);
-                some_subpath |= subactive[j];
-            }
-
             // Only write the stats if there was a match somewhere down the tree
-            if (some_subpath) {
+            if (matches_child(pair.first.to_std(), depth, active, &subactive)) {
                 ql::datum_t sub_stats = subfilter(pair.second, depth + 1, subactive);
                 if (sub_stats.get_type() != ql::datum_t::R_OBJECT ||
                     sub_stats.obj_size() > 0) {
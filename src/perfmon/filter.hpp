@@ -18,6 +18,17 @@ class perfmon_filter_t {
 public:
     explicit perfmon_filter_t(const std::set<std::vector<std::string> > &paths);
     ql::datum_t filter(const ql::datum_t &stats) const;
+
+    /* These let `perfmon_collection_t` skip subtrees that `filter` would drop
+    anyway.  `active` has one entry per path, like in `subfilter`. */
+    std::vector<bool> all_active() const;
+    // True if everything below `depth` passes the filter.
+    bool matches_everything(size_t depth, const std::vector<bool> &active) const;
+    // True if some path can still match below a child called `name`; sets
+    // `subactive_out` to the paths that are still active for that child.
+    bool matches_child(const std::string &name, size_t depth,
+                       const std::vector<bool> &active,
+                       std::vector<bool> *subactive_out) const;
 private:
     ql::datum_t subfilter(const ql::datum_t &stats,
                           size_t depth, std::vector<bool> active) const;
@@ -5,6 +5,7 @@
 
 #include <cmath>
 #include <map>
+#include <utility>
 
 #include "concurrency/pmap.hpp"
 #include "arch/arch.hpp"
@@ -16,6 +17,8 @@ static const char *stat_per_sec = "per_sec";
 static const char *stat_count = "count";
 static const char *stat_mean = "mean";
 static const char *stat_std_dev = "std_dev";
+static const std::pair<const char *, double> stat_percentiles[] = {
+    {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}};
 
 
 #ifdef FULL_PERFMON
@@ -302,11 +305,116 @@ ql::datum_t perfmon_rate_monitor_t::output_stat(const double &stat) {
     return ql::datum_t(stat / ticks_to_secs(length));
 }
 
+/* perfmon_histogram_t */
+
+perfmon_histogram_t::perfmon_histogram_t(ticks_t _length)
+    : perfmon_perthread_t<stats_t>(), length(_length) { }
+
+perfmon_histogram_t::thread_info_t *perfmon_histogram_t::update(ticks_t now) {
+    int64_t interval = now.nanos / length.nanos;
+    rassert(get_thread_id().threadnum >= 0);
+    std::unique_ptr<thread_info_t> &thread = thread_data[get_thread_id().threadnum];
+
+    if (!thread) {
+        thread.reset(new thread_info_t);
+        thread->current_interval = interval;
+    } else if (thread->current_interval == interval) {
+        /* We're up to date; nothing to do */
+    } else if (thread->current_interval + 1 == interval) {
+        /* We're one step behind */
+        thread->last_stats = thread->current_stats;
+        thread->current_stats = stats_t();
+        thread->current_interval++;
+    } else {
+        /* We're more than one step behind */
+        thread->last_stats = stats_t();
+        thread->current_stats = stats_t();
+        thread->current_interval = interval;
+    }
+    return thread.get();
+}
+
+int perfmon_histogram_t::bucket_for(double secs) {
+    using perfmon_histogram::SUB_BUCKETS;
+    using perfmon_histogram::NUM_BUCKETS;
+    double micros = secs * 1e6;
+    if (!(micros >= 1)) {
+        return 0;
+    }
+    // `micros` is `fraction * 2^exponent` with `fraction` in [0.5, 1).
+    int exponent;
+    double fraction = frexp(micros, &exponent);
+    int bucket = (exponent - 1) * SUB_BUCKETS
+        + static_cast<int>((2 * fraction - 1) * SUB_BUCKETS);
+    return std::min(bucket, NUM_BUCKETS - 1);
+}
+
+double perfmon_histogram_t::bucket_upper_bound(int bucket) {
+    using perfmon_histogram::SUB_BUCKETS;
+    double fraction = 1 + static_cast<double>(bucket % SUB_BUCKETS + 1) / SUB_BUCKETS;
+    return ldexp(fraction, bucket / SUB_BUCKETS) / 1e6;
+}
+
+void perfmon_histogram_t::record(double secs) {
+    thread_info_t *thread = update(get_ticks());
+    ++thread->current_stats.counts[bucket_for(secs)];
+    thread->current_stats.max = std::max(thread->current_stats.max, secs);
+}
+
+void perfmon_histogram_t::get_thread_stat(stats_t *stat) {
+    /* As in `perfmon_sampler_t`, we return the last complete interval. */
+    *stat = update(get_ticks())->last_stats;
+}
+
+perfmon_histogram_t::stats_t perfmon_histogram_t::combine_stats(const stats_t *stats) {
+    stats_t aggregated;
+    for (int i = 0; i < get_num_threads(); i++) {
+        aggregated.aggregate(stats[i]);
+    }
+    return aggregated;
+}
+
+ql::datum_t perfmon_histogram_t::output_stat(const stats_t &aggregated) {
+    uint64_t count = 0;
+    for (int i = 0; i < perfmon_histogram::NUM_BUCKETS; ++i) {
+        count += aggregated.counts[i];
+    }
+
+    ql::datum_object_builder_t builder;
+    builder.overwrite(stat_count, ql::datum_t(static_cast<double>(count)));
+    for (const auto &percentile : stat_percentiles) {
+        if (count == 0) {
+            builder.overwrite(percentile.first, ql::datum_t::null());
+            continue;
+        }
+        uint64_t rank = std::max<uint64_t>(1, ceil(percentile.second * count));
+        uint64_t seen = 0;
+        int bucket = 0;
+        for (; bucket < perfmon_histogram::NUM_BUCKETS - 1; ++bucket) {
+            seen += aggregated.counts[bucket];
+            if (seen >= rank) {
+                break;
+            }
+        }
+        // The top bucket is unbounded, and no percentile can exceed the maximum.
+        double value = bucket == perfmon_histogram::NUM_BUCKETS - 1
+            ? aggregated.max
+            : std::min(bucket_upper_bound(bucket), aggregated.max);
+        builder.overwrite(percentile.first, ql::datum_t(value));
+    }
+    builder.overwrite(stat_max, count == 0
+        ? ql::datum_t::null()
+        : ql::datum_t(aggregated.max));
+    return std::move(builder).to_datum();
+}
+
 perfmon_duration_sampler_t::perfmon_duration_sampler_t(ticks_t length, bool _ignore_global_full_perfmon)
-    : stat(), active(), total(), recent(length, true),
+    : stat(), active(), total(), recent(length, true), recent_histogram(length),
       active_membership(&stat, &active, "active_count"),
       total_membership(&stat, &total, "total"),
       recent_membership(&stat, &recent, "recent_duration"),
+      recent_histogram_membership(&stat, &recent_histogram,
+                                  "recent_duration_percentiles"),
       ignore_global_full_perfmon(_ignore_global_full_perfmon)
 { }
 
@@ -323,7 +431,9 @@ void perfmon_duration_sampler_t::begin(ticks_t *v) {
 void perfmon_duration_sampler_t::end(ticks_t *v) {
     --active;
     if (v->nanos != 0) {
-        recent.record(ticks_to_secs(ticks_t{get_ticks().nanos - v->nanos}));
+        double duration = ticks_to_secs(ticks_t{get_ticks().nanos - v->nanos});
+        recent.record(duration);
+        recent_histogram.record(duration);
     }
 }
 
@@ -339,6 +449,33 @@ ql::datum_t perfmon_duration_sampler_t::end_stats(void *data) {
     return stat.end_stats(data);
 }
 
+perfmon_ratio_t::perfmon_ratio_t(perfmon_counter_t *_numerator,
+                                 perfmon_counter_t *_denominator,
+                                 double _offset)
+    : numerator(_numerator), denominator(_denominator), offset(_offset) { }
+
+void *perfmon_ratio_t::begin_stats() {
+    return new std::pair<void *, void *>(numerator->begin_stats(),
+                                         denominator->begin_stats());
+}
+
+void perfmon_ratio_t::visit_stats(void *data) {
+    std::pair<void *, void *> *contexts = static_cast<std::pair<void *, void *> *>(data);
+    numerator->visit_stats(contexts->first);
+    denominator->visit_stats(contexts->second);
+}
+
+ql::datum_t perfmon_ratio_t::end_stats(void *data) {
+    std::unique_ptr<std::pair<void *, void *> > contexts(
+        static_cast<std::pair<void *, void *> *>(data));
+    const double num = numerator->end_stats(contexts->first).as_num();
+    const double den = denominator->end_stats(contexts->second).as_num();
+    if (den == 0) {
+        return ql::datum_t::null();
+    }
+    return ql::datum_t(offset + num / den);
+}
+
 std::string perfmon_duration_sampler_t::call(UNUSED int argc, UNUSED char **argv) {
     ignore_global_full_perfmon = !ignore_global_full_perfmon;
     if (ignore_global_full_perfmon) {
@@ -215,11 +215,66 @@ public:
     void record(double value = 1.0);
 };
 
+/* perfmon_histogram_t keeps a histogram of durations (in seconds) so that it can
+ * report percentiles, which a mean hides. Buckets are logarithmic: every power
+ * of two microseconds is split into `SUB_BUCKETS` buckets, so a percentile is
+ * at most 1 / `SUB_BUCKETS` above the true value. Like `perfmon_sampler_t`, it
+ * reports on the last complete interval of `length` ticks.
+ */
+namespace perfmon_histogram {
+
+static const int SUB_BUCKETS = 4;
+// Enough buckets for durations up to about an hour.
+static const int NUM_BUCKETS = 32 * SUB_BUCKETS;
+
+struct stats_t {
+    stats_t() : max(0) {
+        std::fill(counts, counts + NUM_BUCKETS, 0);
+    }
+    void aggregate(const stats_t &s) {
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            counts[i] += s.counts[i];
+        }
+        max = std::max(max, s.max);
+    }
+    uint64_t counts[NUM_BUCKETS];
+    double max;
+};
+
+}   /* namespace perfmon_histogram */
+
+class perfmon_histogram_t : public perfmon_perthread_t<perfmon_histogram::stats_t> {
+    typedef perfmon_histogram::stats_t stats_t;
+    struct thread_info_t {
+        stats_t current_stats, last_stats;
+        int64_t current_interval;
+    };
+
+    // Most histograms are only ever recorded to from a few threads, so the
+    // buckets for a thread are only allocated once it records something.
+    // Allocating them on demand is safe because `record()` and
+    // `get_thread_stat()` both run on the thread that the buckets belong to.
+    std::unique_ptr<thread_info_t> thread_data[MAX_THREADS];
+    ticks_t length;
+
+    thread_info_t *update(ticks_t now);
+
+    void get_thread_stat(stats_t *);
+    stats_t combine_stats(const stats_t *);
+    ql::datum_t output_stat(const stats_t &);
+
+    static int bucket_for(double secs);
+    static double bucket_upper_bound(int bucket);
+public:
+    explicit perfmon_histogram_t(ticks_t _length);
+    void record(double secs);
+};
+
 /* perfmon_duration_sampler_t is a perfmon_t that monitors events that have a
  * starting and ending time. When something starts, call begin(); when
  * something ends, call end() with the same value as begin. It will produce
- * stats for the number of active events, the average length of an event, and
- * so on. If `global_full_perfmon` is false, it won't report any timing-related
+ * stats for the number of active events, the average length of an event, the
+ * percentiles of the lengths, and so on. If `global_full_perfmon` is false, it won't report any timing-related
  * stats because `get_ticks()` is rather slow.
  *
  * Frequently we're in the case where we'd like to have a single slow perfmon
@@ -234,9 +289,11 @@ private:
     perfmon_counter_t active;
     perfmon_counter_t total;
     perfmon_sampler_t recent;
+    perfmon_histogram_t recent_histogram;
     perfmon_membership_t active_membership;
     perfmon_membership_t total_membership;
     perfmon_membership_t recent_membership;
+    perfmon_membership_t recent_histogram_membership;
 
     bool ignore_global_full_perfmon;
 public:
@@ -253,6 +310,27 @@ public:
     std::string call(UNUSED int argc, UNUSED char **argv);
 };
 
+/* perfmon_ratio_t reports `offset + numerator / denominator` for two
+ * perfmon_counter_t's, or null as long as the denominator is zero.  Both counters must
+ * outlive it.
+ */
+class perfmon_ratio_t : public perfmon_t {
+public:
+    perfmon_ratio_t(perfmon_counter_t *numerator, perfmon_counter_t *denominator,
+                    double offset);
+
+    void *begin_stats();
+    void visit_stats(void *data);
+    ql::datum_t end_stats(void *data);
+
+private:
+    perfmon_counter_t *const numerator;
+    perfmon_counter_t *const denominator;
+    const double offset;
+
+    DISABLE_COPYING(perfmon_ratio_t);
+};
+
 struct block_pm_duration {
     ticks_t time;
     bool ended;
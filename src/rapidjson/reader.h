@@ -368,6 +368,35 @@ template<> inline void SkipWhitespace(InsituStringStream& is) {
 template<> inline void SkipWhitespace(StringStream& is) {
     is.src_ = SkipWhitespace_SIMD(is.src_);
 }
+
+// RethinkDB modification: Helpers for `GenericReader::ScanCopyUnescapedString()`.
+
+//! Whether `c` ends a run of characters that can be copied out of a JSON string as-is.
+inline bool IsStringSpecialChar(char c) {
+    return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+//! Bit mask of the characters in `s` for which `IsStringSpecialChar()` is true.
+inline unsigned StringSpecialCharMask_SIMD(__m128i s) {
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i sp = _mm_set1_epi8(0x1F);
+    __m128i x = _mm_or_si128(_mm_cmpeq_epi8(s, dq), _mm_cmpeq_epi8(s, bs));
+    // `max(c, 0x1F) == 0x1F` is an unsigned `c <= 0x1F`.
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp));
+    return static_cast<unsigned>(_mm_movemask_epi8(x));
+}
+
+//! Index of the lowest set bit in the non-zero mask `r`.
+inline unsigned LowestSetBit_SIMD(unsigned r) {
+#ifdef _MSC_VER
+    unsigned long offset;
+    _BitScanForward(&offset, r);
+    return static_cast<unsigned>(offset);
+#else
+    return static_cast<unsigned>(__builtin_ctz(r));
+#endif
+}
 #endif // RAPIDJSON_SIMD
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -638,6 +667,11 @@ private:
             *stack_.template Push<Ch>() = c;
             ++length_;
         }
+        // RethinkDB modification: For `ScanCopyUnescapedString()`
+        RAPIDJSON_FORCEINLINE Ch* Push(SizeType count) {
+            length_ += count;
+            return stack_.template Push<Ch>(count);
+        }
         size_t Length() const { return length_; }
         Ch* Pop() {
             return stack_.template Pop<Ch>(length_);
@@ -699,6 +733,12 @@ private:
         is.Take();  // Skip '\"'
 
         for (;;) {
+            // RethinkDB modification: Skip over the characters that don't need any
+            // processing in bulk where we can.
+            if (!(parseFlags & kParseValidateEncodingFlag)
+                && internal::IsSame<SEncoding, TEncoding>::Value)
+                ScanCopyUnescapedString(is, os);
+
             Ch c = is.Peek();
             if (c == '\\') {    // Escape
                 is.Take();
@@ -740,6 +780,82 @@ private:
         }
     }
 
+    // RethinkDB modification: Copies the characters from `is` to `os` up to the next
+    // one that `ParseStringToStream()` has to look at. This generic version leaves
+    // everything to `ParseStringToStream()`, the overloads below do it 16 characters at
+    // a time. The caller makes sure that the source and target encodings are the same
+    // and that we don't need to validate them, so the characters are copied verbatim.
+    template<typename InputStream, typename OutputStream>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InputStream&, OutputStream&) { }
+
+#ifdef RAPIDJSON_SIMD
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+
+        // Go one character at a time up to the next 16 byte boundary, so that the
+        // aligned loads below never cross a page boundary.
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & ~static_cast<size_t>(15));
+        while (p != nextAligned) {
+            if (IsStringSpecialChar(*p)) {
+                is.src_ = p;
+                return;
+            }
+            os.Put(*p++);
+        }
+
+        for (;; p += 16) {
+            const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+            const unsigned r = StringSpecialCharMask_SIMD(s);
+            if (r != 0) {
+                const SizeType length = static_cast<SizeType>(LowestSetBit_SIMD(r));
+                if (length != 0)
+                    std::memcpy(os.Push(length), p, length);
+                p += length;
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(os.Push(16)), s);
+        }
+        is.src_ = p;
+    }
+
+    // In situ, `is` and `os` are the same stream, and its write position never gets
+    // ahead of its read position.
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+        char* p = is.src_;
+        char* q = is.dst_;
+
+        char* nextAligned = reinterpret_cast<char*>((reinterpret_cast<size_t>(p) + 15) & ~static_cast<size_t>(15));
+        while (p != nextAligned) {
+            if (IsStringSpecialChar(*p)) {
+                is.src_ = p;
+                is.dst_ = q;
+                return;
+            }
+            *q++ = *p++;
+        }
+
+        for (;; p += 16, q += 16) {
+            const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+            const unsigned r = StringSpecialCharMask_SIMD(s);
+            if (r != 0) {
+                const size_t length = LowestSetBit_SIMD(r);
+                if (q != p)
+                    std::memmove(q, p, length);
+                p += length;
+                q += length;
+                break;
+            }
+            // Until the string has had its first escape sequence, nothing moves.
+            if (q != p)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(q), s);
+        }
+        is.src_ = p;
+        is.dst_ = q;
+    }
+#endif // RAPIDJSON_SIMD
+
     template<typename InputStream, bool backup>
     class NumberStream;
 
@@ -99,6 +99,12 @@ inline void PutN(GenericStringBuffer<UTF8<> >& stream, char c, size_t n) {
     std::memset(stream.stack_.Push<char>(n), c, n * sizeof(c));
 }
 
+// RethinkDB addition: Specialized version of PutString() with memcpy().
+template<>
+inline void PutString(GenericStringBuffer<UTF8<> >& stream, const char* str, size_t n) {
+    std::memcpy(stream.stack_.Push<char>(n), str, n);
+}
+
 RAPIDJSON_NAMESPACE_END
 
 #endif // RAPIDJSON_STRINGBUFFER_H_
@@ -22,6 +22,7 @@
 #define RAPIDJSON_WRITER_H_
 
 #include "rapidjson/rapidjson.h"
+#include "rapidjson/internal/meta.h"
 #include "rapidjson/internal/stack.h"
 #include "rapidjson/internal/strfunc.h"
 #include "rapidjson/internal/dtoa.h"
@@ -289,6 +290,23 @@ protected:
         os_->Put('\"');
         GenericStringStream<SourceEncoding> is(str);
         while (is.Tell() < length) {
+            // RethinkDB modification: Copy runs of characters that don't need to be
+            // escaped in one go. Without a change of encoding, `Transcode()` below would
+            // copy them one at a time.
+            if (sizeof(Ch) == 1 && TargetEncoding::supportUnicode
+                && internal::IsSame<SourceEncoding, TargetEncoding>::Value) {
+                const Ch* run = is.src_;
+                const Ch* end = str + length;
+                const Ch* p = run;
+                while (p != end && !escape[static_cast<unsigned char>(*p)])
+                    ++p;
+                if (p != run) {
+                    PutString(*os_, run, static_cast<size_t>(p - run));
+                    is.src_ = p;
+                    continue;
+                }
+            }
+
             const Ch c = is.Peek();
             if (!TargetEncoding::supportUnicode && (unsigned)c >= 0x80) {
                 // Unicode escaping
@@ -3,6 +3,7 @@
 
 #include "clustering/administration/admin_op_exc.hpp"
 #include "rdb_protocol/env.hpp"
+#include "time.hpp"
 
 caching_cfeed_artificial_table_backend_t::caching_cfeed_artificial_table_backend_t(
         name_string_t const &table_name,
@@ -282,6 +283,38 @@ timer_cfeed_artificial_table_backend_t::timer_cfeed_artificial_table_backend_t(
     : caching_cfeed_artificial_table_backend_t(table_name, rdb_context, name_resolver) {
 }
 
+bool caching_cfeed_artificial_table_backend_t::read_all_rows_cached(
+        auth::user_context_t const &user_context,
+        int64_t max_age_ms,
+        signal_t *interruptor_on_home,
+        const std::function<bool(std::vector<ql::datum_t> *, admin_err_t *)> &read_all,
+        std::vector<ql::datum_t> *rows_out,
+        admin_err_t *error_out) {
+    assert_thread();
+    scoped_ptr_t<cached_rows_t> *cache = &cached_rows[user_context];
+    if (!cache->has()) {
+        cache->init(new cached_rows_t());
+    }
+    cached_rows_t *cached = cache->get();
+
+    new_mutex_in_line_t mutex_lock(&cached->mutex);
+    wait_interruptible(mutex_lock.acq_signal(), interruptor_on_home);
+    if (cached->valid
+            && current_microtime() < cached->read_time + max_age_ms * 1000) {
+        *rows_out = cached->rows;
+        return true;
+    }
+    cached->valid = false;
+    microtime_t read_time = current_microtime();
+    if (!read_all(rows_out, error_out)) {
+        return false;
+    }
+    cached->rows = *rows_out;
+    cached->read_time = read_time;
+    cached->valid = true;
+    return true;
+}
+
 scoped_ptr_t<cfeed_artificial_table_backend_t::machinery_t>
 caching_cfeed_artificial_table_backend_t::construct_changefeed_machinery(
         lifetime_t<name_resolver_t const &> name_resolver,
@@ -2,6 +2,10 @@
 #ifndef RDB_PROTOCOL_ARTIFICIAL_TABLE_CACHING_CFEED_BACKEND_HPP_
 #define RDB_PROTOCOL_ARTIFICIAL_TABLE_CACHING_CFEED_BACKEND_HPP_
 
+#include <functional>
+#include <map>
+#include <vector>
+
 #include "rdb_protocol/artificial_table/cfeed_backend.hpp"
 
 /* `caching_cfeed_artificial_table_backend_t` is a mixin for artificial table backends
@@ -37,6 +41,21 @@ protected:
     void notify_all();
     void notify_break();
 
+    /* `read_all_rows_cached()` is for subclasses whose `read_all_rows_as_vector()` is
+    expensive, like the ones that collect information from every server. If `read_all`
+    succeeded for the same user less than `max_age_ms` milliseconds ago, it returns a
+    copy of those rows. Otherwise it calls `read_all`, and callers that arrive in the
+    meantime wait for that call instead of making their own. So any number of clients
+    polling the table cost about one `read_all` per `max_age_ms`. Errors aren't cached.
+    It must be called on the home thread. */
+    bool read_all_rows_cached(
+        auth::user_context_t const &user_context,
+        int64_t max_age_ms,
+        signal_t *interruptor_on_home,
+        const std::function<bool(std::vector<ql::datum_t> *, admin_err_t *)> &read_all,
+        std::vector<ql::datum_t> *rows_out,
+        admin_err_t *error_out);
+
     /* Subclasses must remember to call `begin_changefeed_destruction()` in their
     destructors. */
 
@@ -104,6 +123,16 @@ private:
             signal_t *interruptor);
 
     std::map<auth::user_context_t, caching_machinery_t *> caching_machineries;
+
+    struct cached_rows_t {
+        cached_rows_t() : valid(false), read_time(0) { }
+        /* Held while calling `read_all`. */
+        new_mutex_t mutex;
+        bool valid;
+        microtime_t read_time;
+        std::vector<ql::datum_t> rows;
+    };
+    std::map<auth::user_context_t, scoped_ptr_t<cached_rows_t> > cached_rows;
 };
 
 /* `timer_cfeed_artificial_table_backend_t` implements changefeeds by simply setting a
@@ -1,11 +1,25 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/base64.hpp"
 
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BASE64_X86_KERNELS 1
+#else
+#define BASE64_X86_KERNELS 0
+#endif
+
 #include "rdb_protocol/error.hpp"
 #include "utils.hpp"
 
 const char base64_map[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+// The encoded output is broken into lines of this many characters, each but the last
+// followed by a CRLF.  That's 19 chunks, i.e. 57 bytes of input.
+const size_t BASE64_LINE_LENGTH = 76;
+const size_t BASE64_LINE_INPUT_BYTES = BASE64_LINE_LENGTH / 4 * 3;
+
 void binary_to_base64_chunk(const char *in, char *out) {
     CT_ASSERT(sizeof(base64_map) == 65);
     out[0] = base64_map[(in[0] & 0xFC) >> 2];
@@ -14,40 +28,199 @@ void binary_to_base64_chunk(const char *in, char *out) {
     out[3] = base64_map[in[2] & 0x3F];
 }
 
-std::string encode_base64(const char *data, size_t size) {
-    size_t remaining_bytes = size;
+/* The kernels below encode and decode whole chunks (three bytes, four characters)
+without padding, line breaks or whitespace.  Each returns how many input bytes or
+characters it consumed; the scalar kernels consume everything they can, while the
+vectorized ones stop where less than a full vector is left (or, when decoding, at a
+vector with something other than base64 characters in it) and leave the rest to the
+scalar kernels. */
 
-    if (remaining_bytes == 0) {
-        return std::string();
+static size_t encode_chunks_scalar(const char *in, size_t size, char *out) {
+    size_t consumed = 0;
+    for (; consumed + 3 <= size; consumed += 3) {
+        binary_to_base64_chunk(in + consumed, out);
+        out += 4;
     }
+    return consumed;
+}
 
-    std::string res;
-    // Scale output size for base64 encoding and account for a CRLF every 76 characters
-    res.reserve(((remaining_bytes * 52) + 39) / 38);
+// The 6-bit value of each base64 character, or 0xFF for other characters.
+struct base64_decode_table_t {
+    base64_decode_table_t() {
+        memset(values, 0xFF, sizeof(values));
+        for (uint8_t i = 0; i < 64; ++i) {
+            values[static_cast<uint8_t>(base64_map[i])] = i;
+        }
+    }
+    uint8_t values[256];
+};
 
-    char encoded_chunk[4];
-    const char *chunk = data;
+static const base64_decode_table_t base64_decode_table;
 
-    for (; remaining_bytes > 3;
-         remaining_bytes -= 3) {
-        binary_to_base64_chunk(chunk, encoded_chunk);
-        res.append(encoded_chunk, 4);
-        if (res.size() % 78 == 76) {
-            res.append("\r\n");
+static size_t decode_chunks_scalar(const char *in, size_t size, char *out) {
+    const uint8_t *values = base64_decode_table.values;
+    size_t consumed = 0;
+    for (; consumed + 4 <= size; consumed += 4) {
+        const uint8_t a = values[static_cast<uint8_t>(in[consumed])];
+        const uint8_t b = values[static_cast<uint8_t>(in[consumed + 1])];
+        const uint8_t c = values[static_cast<uint8_t>(in[consumed + 2])];
+        const uint8_t d = values[static_cast<uint8_t>(in[consumed + 3])];
+        if ((a | b | c | d) & 0xC0) {
+            break;
         }
-        chunk += 3;
+        const uint32_t bits = (a << 18) | (b << 12) | (c << 6) | d;
+        *out++ = static_cast<char>(bits >> 16);
+        *out++ = static_cast<char>(bits >> 8);
+        *out++ = static_cast<char>(bits);
+    }
+    return consumed;
+}
+
+#if BASE64_X86_KERNELS
+
+/* These follow the SSSE3 algorithms by Wojciech Muła, as used in e.g. the aklomp/base64
+library: twelve bytes are spread over the four bytes of each 32-bit lane, shifted
+into place with multiplications, and translated from and to characters with
+`pshufb` lookups. */
+
+__attribute__((target("ssse3")))
+static size_t encode_chunks_ssse3(const char *in, size_t size, char *out) {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                         4, 5, 3, 4, 1, 2, 0, 1);
+    // Added to each 6-bit value depending on its range: A-Z, a-z, 0-9, '+' and '/'.
+    const __m128i offsets = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4,
+                                          -4, -4, -4, -4, -19, -16, 0, 0);
+    size_t consumed = 0;
+    // Each step reads 16 bytes, of which it encodes 12.
+    for (; consumed + 16 <= size; consumed += 12) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+        v = _mm_shuffle_epi8(v, shuffle);
+        const __m128i t0 = _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(v, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        // Each byte is now one 6-bit value.
+        v = _mm_or_si128(t1, t3);
+
+        __m128i range = _mm_subs_epu8(v, _mm_set1_epi8(51));
+        range = _mm_sub_epi8(range, _mm_cmpgt_epi8(v, _mm_set1_epi8(25)));
+        v = _mm_add_epi8(v, _mm_shuffle_epi8(offsets, range));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), v);
+        out += 16;
+    }
+    return consumed;
+}
+
+// Writes 16 bytes to `out` for every 12 that it decodes.
+__attribute__((target("ssse3")))
+static size_t decode_chunks_ssse3(const char *in, size_t size, char *out) {
+    // Flags of the characters' low and high nibbles; a character is a base64
+    // character exactly when its two flags have no bit in common.
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    // Added to each character depending on its high nibble, with index 1 for '/'.
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                       8, 14, 13, 12, -1, -1, -1, -1);
+    size_t consumed = 0;
+    for (; consumed + 16 <= size; consumed += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + consumed));
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), nibble_mask);
+        const __m128i lo_nibbles = _mm_and_si128(v, nibble_mask);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero)) != 0xFFFF) {
+            break;
+        }
+        const __m128i roll = _mm_shuffle_epi8(
+            lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(v, slash), hi_nibbles));
+        v = _mm_add_epi8(v, roll);
+
+        // Merge the 6-bit values into 24 bits per 32-bit lane, then pack those.
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, pack);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), v);
+        out += 12;
     }
+    return consumed;
+}
+
+#endif  // BASE64_X86_KERNELS
+
+static bool use_ssse3_kernels() {
+#if BASE64_X86_KERNELS
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+static void encode_chunks(const char *in, size_t size, char *out) {
+    size_t consumed = 0;
+#if BASE64_X86_KERNELS
+    if (use_ssse3_kernels()) {
+        consumed = encode_chunks_ssse3(in, size, out);
+    }
+#endif
+    encode_chunks_scalar(in + consumed, size - consumed, out + consumed / 3 * 4);
+}
+
+// Decodes as many whole chunks as it can, stopping at any other character.  `out`
+// needs four bytes of room beyond the decoded data.
+static size_t decode_chunks(const char *in, size_t size, char *out) {
+    size_t consumed = 0;
+#if BASE64_X86_KERNELS
+    if (use_ssse3_kernels()) {
+        consumed = decode_chunks_ssse3(in, size, out);
+    }
+#endif
+    return consumed + decode_chunks_scalar(in + consumed, size - consumed,
+                                           out + consumed / 4 * 3);
+}
+
+std::string encode_base64(const char *data, size_t size) {
+    if (size == 0) {
+        return std::string();
+    }
+
+    const size_t encoded_size = (size + 2) / 3 * 4;
+    const size_t line_breaks = (encoded_size - 1) / BASE64_LINE_LENGTH;
+    std::string res(encoded_size + 2 * line_breaks, '\0');
+    char *out = &res[0];
+
+    while (size > BASE64_LINE_INPUT_BYTES) {
+        encode_chunks(data, BASE64_LINE_INPUT_BYTES, out);
+        out += BASE64_LINE_LENGTH;
+        *out++ = '\r';
+        *out++ = '\n';
+        data += BASE64_LINE_INPUT_BYTES;
+        size -= BASE64_LINE_INPUT_BYTES;
+    }
+
+    const size_t full_chunk_bytes = (size - 1) / 3 * 3;
+    encode_chunks(data, full_chunk_bytes, out);
+    out += full_chunk_bytes / 3 * 4;
+    data += full_chunk_bytes;
+    size -= full_chunk_bytes;
 
     char partial_chunk[4] = { 0, 0, 0, 0 };
-    for (size_t i = 0; i < remaining_bytes; ++i) {
-        partial_chunk[i] = chunk[i];
+    for (size_t i = 0; i < size; ++i) {
+        partial_chunk[i] = data[i];
     }
-    binary_to_base64_chunk(partial_chunk, encoded_chunk);
+    binary_to_base64_chunk(partial_chunk, out);
 
-    for (size_t i = remaining_bytes + 1; i < 4; ++i) {
-        encoded_chunk[i] = '=';
+    for (size_t i = size + 1; i < 4; ++i) {
+        out[i] = '=';
     }
-    res.append(encoded_chunk, 4);
+    rassert(out + 4 == res.data() + res.size());
     return res;
 }
 
@@ -91,20 +264,28 @@ const char* fill_chunk_values(const char *in, const char *in_end, char *out,
 }
 
 std::string decode_base64(const char *bdata, size_t bsize) {
-    // This assumes no whitespace in the input, so we may be overallocating a bit
-    std::string res;
-    res.reserve((bsize / 4) * 3);
+    // This assumes no whitespace in the input, so we may be overallocating a bit.  The
+    // extra four bytes are scratch space for `decode_chunks`.
+    std::string res((bsize + 3) / 4 * 3 + 4, '\0');
+    char *out = &res[0];
 
     bool done = false;
     size_t chars_filled;
     char chunk_values[4];
-    char decoded_chunk[3];
     const char *current_data = bdata;
     const char *data_end = bdata + bsize;
 
     while (!done) {
+        // Runs of whole chunks without whitespace or padding are decoded in bulk, the
+        // rest (including every error) goes one chunk at a time.
+        const size_t consumed = decode_chunks(current_data, data_end - current_data,
+                                              out);
+        current_data += consumed;
+        out += consumed / 4 * 3;
+
         current_data = fill_chunk_values(current_data, data_end, chunk_values,
                                          &done, &chars_filled);
+        char decoded_chunk[3];
         base64_chunk_to_binary(chunk_values, decoded_chunk);
 
         if (chars_filled == 1) {
@@ -112,7 +293,8 @@ std::string decode_base64(const char *bdata, size_t bsize) {
                         "Invalid base64 length: 1 character remaining, "
                         "cannot decode a full byte.");
         } else if (chars_filled != 0) {
-            res.append(decoded_chunk, chars_filled - 1);
+            memcpy(out, decoded_chunk, chars_filled - 1);
+            out += chars_filled - 1;
         }
     }
 
@@ -125,5 +307,6 @@ std::string decode_base64(const char *bdata, size_t bsize) {
         }
     }
 
+    res.resize(out - res.data());
     return res;
 }
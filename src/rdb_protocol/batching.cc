@@ -79,7 +79,10 @@ static bool set_if_present(const char *argname, env_t *env, datum_t * dest) {
     }
 }
 
-batchspec_t batchspec_t::user(batch_type_t batch_type, env_t *env) {
+batchspec_t batchspec_t::user(batch_type_t batch_type,
+                              env_t *env,
+                              int64_t size_factor) {
+    r_sanity_check(size_factor >= 1);
     const double SECS_TO_USECS = 1000 * 1000;
     // Kind of arbitrarily set to 1 day, but makes sure we don't overflow when
     // casting from double to int64_t
@@ -101,7 +104,9 @@ batchspec_t batchspec_t::user(batch_type_t batch_type, env_t *env) {
     int64_t min_els = min_els_d.has()
                       ? min_els_d.as_int()
                       : std::min<int64_t>(max_els, DEFAULT_MIN_ELS);
-    int64_t max_size = max_size_d.has() ? max_size_d.as_int() : DEFAULT_MAX_SIZE;
+    int64_t max_size = max_size_d.has()
+                       ? max_size_d.as_int()
+                       : DEFAULT_MAX_SIZE * size_factor;
     int64_t first_sd = first_scaledown_d.has()
                        ? first_scaledown_d.as_int()
                        : DEFAULT_FIRST_SCALEDOWN;
@@ -46,7 +46,10 @@ public:
         seen_one_el = true;
         els_left -= 1;
         min_els_left -= 1;
-        size_left -= serialized_size<cluster_version_t::CLUSTER>(t);
+        // The size limit is a soft one, so an estimate is good enough.  It also
+        // lets us skip most of the walk over rows that don't fit anyway.
+        size_left -= datum_approx_serialized_size(
+            t, size_left > 0 ? static_cast<size_t>(size_left) : 0);
         return should_send_batch();
     }
     bool should_send_batch(
@@ -79,7 +82,11 @@ private:
 
 class batchspec_t {
 public:
-    static batchspec_t user(batch_type_t batch_type, env_t *env);
+    // `size_factor` scales the default batch size limit, but not a limit that
+    // the user set with `max_batch_bytes`.
+    static batchspec_t user(batch_type_t batch_type,
+                            env_t *env,
+                            int64_t size_factor = 1);
     static batchspec_t all(); // Gimme everything.
     static batchspec_t empty() { return batchspec_t(); }
     static batchspec_t default_for(batch_type_t batch_type);
@@ -4,10 +4,12 @@
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <numeric>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "btree/bulk_load.hpp"
 #include "btree/concurrent_traversal.hpp"
 #include "btree/get_distribution.hpp"
 #include "btree/operations.hpp"
@@ -16,6 +18,7 @@
 #include "buffer_cache/serialize_onto_blob.hpp"
 #include "concurrency/coro_pool.hpp"
 #include "concurrency/new_mutex.hpp"
+#include "concurrency/pmap.hpp"
 #include "concurrency/queue/unlimited_fifo.hpp"
 #include "containers/archive/boost_types.hpp"
 #include "containers/archive/buffer_group_stream.hpp"
@@ -469,9 +472,18 @@ batched_replace_response_t rdb_batched_replace(
         // write operations depending on the presence of limit changefeeds.
         scoped_ptr_t<real_superblock_t> current_superblock(superblock->release());
         bool update_pkey_cfeeds = sindex_cb->has_pkey_cfeeds(keys);
+        // We apply the replaces in key order, so that consecutive replaces mostly
+        // go to the same leaf node, which is then still in the cache and usually
+        // already acquired by the previous replace.  The sort is stable, so that if
+        // the batch has the same key more than once, the writes still happen in the
+        // order they were given in.
+        std::vector<size_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
         {
             auto_drainer_t drainer;
-            for (size_t i = 0; i < keys.size(); ++i) {
+            for (size_t i : order) {
                 promise_t<superblock_t *> superblock_promise;
                 coro_queue.push(
                     std::bind(
@@ -555,6 +567,33 @@ void rdb_set(const store_key_t &key,
         (had_value ? point_write_result_t::DUPLICATE : point_write_result_t::STORED);
 }
 
+void rdb_append(const store_key_t &key,
+                ql::datum_t data,
+                btree_slice_t *slice,
+                repli_timestamp_t timestamp,
+                btree_bulk_appender_t *appender,
+                rdb_modification_info_t *mod_info) {
+    rassert(appender->can_append(key.btree_key()));
+    slice->stats.pm_keys_set.record();
+    slice->stats.pm_total_keys_set += 1;
+
+    scoped_malloc_t<rdb_value_t> new_value(blob::btree_maxreflen);
+    memset(new_value.get(), 0, blob::btree_maxreflen);
+    buf_parent_t leaf = appender->last_leaf();
+    const max_block_size_t block_size = leaf.cache()->max_block_size();
+    {
+        blob_t blob(block_size, new_value->value_ref(), blob::btree_maxreflen);
+        ql::serialization_result_t res = datum_serialize_onto_blob(leaf, &blob, data);
+        r_sanity_check(!ql::bad(res));
+    }
+
+    mod_info->added.first = data;
+    mod_info->added.second.assign(new_value->value_ref(),
+        new_value->value_ref() + new_value->inline_size(block_size));
+
+    appender->append(key.btree_key(), new_value.get(), timestamp);
+}
+
 void rdb_delete(const store_key_t &key, btree_slice_t *slice,
                 repli_timestamp_t timestamp,
                 real_superblock_t *superblock,
@@ -735,6 +774,47 @@ private:
     optional<std::string> skey_left;
 };
 
+// Like `rget_cb_wrapper_t`, but for a traversal that only wants the keys in `keys`,
+// each with its own number of copies.
+class rget_key_set_cb_wrapper_t : public concurrent_traversal_callback_t {
+public:
+    rget_key_set_cb_wrapper_t(
+            rget_cb_t *_cb,
+            const std::map<store_key_t, uint64_t> *_keys)
+        : cb(_cb), keys(_keys) { }
+    virtual void filter_range(
+            const btree_key_t *left_excl_or_null,
+            const btree_key_t *right_incl,
+            bool *skip_out) {
+        auto it = left_excl_or_null == nullptr
+            ? keys->begin()
+            : keys->upper_bound(store_key_t(left_excl_or_null));
+        *skip_out = it == keys->end()
+            || btree_key_cmp(it->first.btree_key(), right_incl) > 0;
+    }
+    virtual bool read_ahead_ok() {
+        return false;
+    }
+    virtual void filter_key(const btree_key_t *key, bool *skip_out) {
+        *skip_out = keys->count(store_key_t(key)) == 0;
+    }
+    virtual continue_bool_t handle_pair(
+        scoped_key_value_t &&keyvalue,
+        concurrent_traversal_fifo_enforcer_signal_t waiter)
+        THROWS_ONLY(interrupted_exc_t) {
+        auto it = keys->find(store_key_t(keyvalue.key()));
+        guarantee(it != keys->end());
+        return cb->handle_pair(
+            std::move(keyvalue),
+            it->second,
+            r_nullopt,
+            std::move(waiter));
+    }
+private:
+    rget_cb_t *cb;
+    const std::map<store_key_t, uint64_t> *keys;
+};
+
 rget_cb_t::rget_cb_t(rget_io_data_t &&_io,
                      job_data_t &&_job,
                      optional<rget_sindex_data_t> &&_sindex)
@@ -1007,6 +1087,62 @@ continue_bool_t rget_cb_t::handle_pair(
 }
 
 // TODO: Having two functions which are 99% the same sucks.
+/* Counts the rows of a primary range without going through `rget_cb_t`.  A plain
+`count()` doesn't look at the rows, so there's no need to hand every one of them to
+its own coroutine: this adds up the keys of each leaf as the traversal gets to it. */
+class count_leaves_cb_t : public depth_first_traversal_callback_t {
+public:
+    count_leaves_cb_t(const key_range_t &range, btree_slice_t *slice,
+                      profile::trace_t *trace)
+        : range_(range), slice_(slice), trace_(trace), count_(0) { }
+
+    continue_bool_t handle_pre_leaf(
+            const counted_t<counted_buf_lock_and_read_t> &buf,
+            UNUSED const btree_key_t *left_excl_or_null,
+            UNUSED const btree_key_t *right_incl,
+            signal_t *interruptor,
+            bool *skip_out) {
+        if (interruptor->is_pulsed()) {
+            throw interrupted_exc_t();
+        }
+        const leaf_node_t *node =
+            static_cast<const leaf_node_t *>(buf->read->get_data_read());
+        uint64_t leaf_count = 0;
+        for (auto it = leaf::inclusive_lower_bound(range_.left.btree_key(), *node);
+             it != leaf::end(*node); ++it) {
+            if (!range_.right.unbounded &&
+                btree_key_cmp((*it).first, range_.right.key().btree_key()) >= 0) {
+                break;
+            }
+            ++leaf_count;
+        }
+        count_ += leaf_count;
+        slice_->stats.pm_keys_read.record(leaf_count);
+        slice_->stats.pm_total_keys_read += leaf_count;
+        *skip_out = true;
+        return continue_bool_t::CONTINUE;
+    }
+
+    continue_bool_t handle_pair(UNUSED scoped_key_value_t &&keyvalue,
+                                UNUSED signal_t *interruptor) {
+        unreachable();
+    }
+
+    size_t read_ahead_limit() { return MAX_READ_AHEAD_CHILDREN; }
+
+    profile::trace_t *get_trace() THROWS_NOTHING { return trace_; }
+
+    uint64_t count() const { return count_; }
+
+private:
+    static const size_t MAX_READ_AHEAD_CHILDREN = 4;
+
+    const key_range_t range_;
+    btree_slice_t *const slice_;
+    profile::trace_t *const trace_;
+    uint64_t count_;
+};
+
 void rdb_rget_slice(
         btree_slice_t *slice,
         const region_t &shard,
@@ -1026,6 +1162,24 @@ void rdb_rget_slice(
         "Do range scan on primary index.",
         ql_env->trace);
 
+    if (!primary_keys.has_value()
+        && transforms.empty()
+        && terminal.has_value()
+        && boost::get<ql::count_wire_func_t>(&*terminal) != nullptr) {
+        count_leaves_cb_t count_cb(range, slice, ql_env->trace);
+        btree_depth_first_traversal(
+            superblock, range, &count_cb, access_t::read, FORWARD,
+            release_superblock, ql_env->interruptor);
+        // This is what the `count` terminal would have produced; it leaves out the
+        // group when there are no rows.
+        response->result = ql::grouped_t<uint64_t>();
+        if (count_cb.count() != 0) {
+            boost::get<ql::grouped_t<uint64_t> >(response->result).insert(
+                std::make_pair(ql::datum_t(), count_cb.count()));
+        }
+        return;
+    }
+
     rget_cb_t callback(
         rget_io_data_t(response, slice),
         job_data_t(ql_env,
@@ -1043,33 +1197,19 @@ void rdb_rget_slice(
     direction_t direction = reversed(sorting) ? BACKWARD : FORWARD;
     continue_bool_t cont = continue_bool_t::CONTINUE;
     if (primary_keys.has_value()) {
-        auto cb = [&](const std::pair<store_key_t, uint64_t> &pair, bool is_last) {
-            rget_cb_wrapper_t wrapper(&callback, pair.second, r_nullopt);
-            return btree_concurrent_traversal(
+        // A single traversal visits all the keys, instead of one traversal per key
+        // starting from the root.  It skips the subtrees that none of the keys are in.
+        if (!primary_keys->empty()) {
+            rget_key_set_cb_wrapper_t wrapper(&callback, &*primary_keys);
+            cont = btree_concurrent_traversal(
                 superblock,
-                key_range_t::one_key(pair.first),
+                key_range_t(key_range_t::bound_t::closed,
+                            primary_keys->begin()->first,
+                            key_range_t::bound_t::closed,
+                            primary_keys->rbegin()->first),
                 &wrapper,
                 direction,
-                is_last ? release_superblock : release_superblock_t::KEEP);
-        };
-        if (!reversed(sorting)) {
-            for (auto it = primary_keys->begin(); it != primary_keys->end();) {
-                auto this_it = it++;
-                if (cb(*this_it, it == primary_keys->end()) == continue_bool_t::ABORT) {
-                    // If required the superblock will get released further up the stack.
-                    cont = continue_bool_t::ABORT;
-                    break;
-                }
-            }
-        } else {
-            for (auto it = primary_keys->rbegin(); it != primary_keys->rend();) {
-                auto this_it = it++;
-                if (cb(*this_it, it == primary_keys->rend()) == continue_bool_t::ABORT) {
-                    // If required the superblock will get released further up the stack.
-                    cont = continue_bool_t::ABORT;
-                    break;
-                }
-            }
+                release_superblock);
         }
     } else {
         rget_cb_wrapper_t wrapper(&callback, 1, r_nullopt);
@@ -1256,11 +1396,11 @@ void rdb_get_nearest_slice(
 void rdb_distribution_get(int max_depth,
                           const store_key_t &left_key,
                           real_superblock_t *superblock,
+                          key_distribution_cache_t *cache,
                           distribution_read_response_t *response) {
     int64_t key_count_out;
     std::vector<store_key_t> key_splits;
-    get_btree_key_distribution(superblock, max_depth,
-                               &key_count_out, &key_splits);
+    cache->get(superblock, max_depth, &key_count_out, &key_splits);
 
     int64_t keys_per_bucket;
     if (key_splits.size() == 0) {
@@ -1735,6 +1875,80 @@ void deserialize_sindex_info_or_crash(
         });
 }
 
+/* Whether `a` and `b` are the same down to the bits of their numbers, so that any
+function returns the same for both.  `datum_t::operator==` isn't enough for that, it
+treats e.g. `0` and `-0`, or the same time in different timezones, as equal. */
+bool datums_identical(const ql::datum_t &a, const ql::datum_t &b) {
+    if (a.get_type() != b.get_type()) {
+        return false;
+    }
+    switch (a.get_type()) {
+    case ql::datum_t::UNINITIALIZED: // fallthru
+    case ql::datum_t::MINVAL: // fallthru
+    case ql::datum_t::MAXVAL: // fallthru
+    case ql::datum_t::R_NULL:
+        return true;
+    case ql::datum_t::R_BOOL:
+        return a.as_bool() == b.as_bool();
+    case ql::datum_t::R_NUM: {
+        const double a_num = a.as_num();
+        const double b_num = b.as_num();
+        return memcmp(&a_num, &b_num, sizeof(double)) == 0;
+    }
+    case ql::datum_t::R_STR:
+        return a.as_str() == b.as_str();
+    case ql::datum_t::R_BINARY:
+        return a.as_binary() == b.as_binary();
+    case ql::datum_t::R_ARRAY:
+        if (a.arr_size() != b.arr_size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.arr_size(); ++i) {
+            if (!datums_identical(a.get(i), b.get(i))) {
+                return false;
+            }
+        }
+        return true;
+    case ql::datum_t::R_OBJECT:
+        if (a.obj_size() != b.obj_size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.obj_size(); ++i) {
+            auto a_pair = a.get_pair(i);
+            auto b_pair = b.get_pair(i);
+            if (a_pair.first != b_pair.first
+                || !datums_identical(a_pair.second, b_pair.second)) {
+                return false;
+            }
+        }
+        return true;
+    default:
+        unreachable();
+    }
+}
+
+/* Whether the index function gives the same result for `old_doc` and `new_doc`,
+because it only reads top-level fields that are identical in both. */
+bool sindex_keys_unchanged(const sindex_disk_info_t &sindex_info,
+                           const ql::datum_t &old_doc,
+                           const ql::datum_t &new_doc) {
+    std::set<datum_string_t> fields;
+    if (!sindex_info.mapping.compile_wire_func()->field_dependencies(&fields)
+        || old_doc.get_type() != ql::datum_t::R_OBJECT
+        || new_doc.get_type() != ql::datum_t::R_OBJECT) {
+        return false;
+    }
+    for (const auto &field : fields) {
+        ql::datum_t old_val = old_doc.get_field(field, ql::NOTHROW);
+        ql::datum_t new_val = new_doc.get_field(field, ql::NOTHROW);
+        if (old_val.has() != new_val.has()
+            || (old_val.has() && !datums_identical(old_val, new_val))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* Used below by rdb_update_sindexes. */
 void rdb_update_single_sindex(
         store_t *store,
@@ -1770,6 +1984,24 @@ void rdb_update_single_sindex(
 
     auto cserver = store->changefeed_server(modification->primary_key);
 
+    // If the sindex is being deleted, we don't add any new values to the sindex tree.
+    // This is so we don't race against any sindex erase about who is faster
+    // (we with inserting new entries, or the erase with removing them).
+    const bool sindex_is_being_deleted = sindex->sindex.being_deleted;
+
+    // If an update didn't change any of the fields that the index function reads, the
+    // new document has the same index keys as the old one.  Then we only compute the
+    // keys once, and overwrite their entries (which have to point to the new value)
+    // instead of deleting them first.
+    const bool keys_unchanged =
+        !sindex_is_being_deleted
+        && modification->info.deleted.first.has()
+        && modification->info.added.first.has()
+        && sindex_keys_unchanged(sindex_info,
+                                 modification->info.deleted.first,
+                                 modification->info.added.first);
+    optional<std::vector<std::pair<store_key_t, ql::datum_t> > > unchanged_keys;
+
     if (modification->info.deleted.first.has()) {
         guarantee(!modification->info.deleted.second.empty());
         try {
@@ -1779,6 +2011,12 @@ void rdb_update_single_sindex(
             compute_keys(
                 modification->primary_key, deleted, sindex_info,
                 &keys, cfeed_old_keys_out);
+            if (keys_unchanged) {
+                unchanged_keys.set(keys);
+                if (cfeed_old_keys_out != nullptr && cfeed_new_keys_out != nullptr) {
+                    *cfeed_new_keys_out = *cfeed_old_keys_out;
+                }
+            }
             if (cserver.first != nullptr) {
                 cserver.first->foreach_limit(
                     make_optional(sindex->name.name),
@@ -1795,7 +2033,7 @@ void rdb_update_single_sindex(
                         }
                     }, cserver.second);
             }
-            for (auto it = keys.begin(); it != keys.end(); ++it) {
+            for (auto it = keys.begin(); it != keys.end() && !keys_unchanged; ++it) {
                 promise_t<superblock_t *> return_superblock_local;
                 {
                     keyvalue_location_t kv_location;
@@ -1833,11 +2071,6 @@ void rdb_update_single_sindex(
         }
     }
 
-    // If the secondary index is being deleted, we don't add any new values to
-    // the sindex tree.
-    // This is so we don't race against any sindex erase about who is faster
-    // (we with inserting new entries, or the erase with removing them).
-    const bool sindex_is_being_deleted = sindex->sindex.being_deleted;
     if (!sindex_is_being_deleted && modification->info.added.first.has()) {
         bool decremented_updates_left = false;
         try {
@@ -1845,9 +2078,13 @@ void rdb_update_single_sindex(
 
             std::vector<std::pair<store_key_t, ql::datum_t> > keys;
 
-            compute_keys(
-                modification->primary_key, added, sindex_info,
-                &keys, cfeed_new_keys_out);
+            if (unchanged_keys) {
+                keys = std::move(*unchanged_keys);
+            } else {
+                compute_keys(
+                    modification->primary_key, added, sindex_info,
+                    &keys, cfeed_new_keys_out);
+            }
             if (keys_available_cond != nullptr) {
                 guarantee(*updates_left > 0);
                 decremented_updates_left = true;
@@ -2011,11 +2248,21 @@ void rdb_update_sindexes(
     }
 }
 
+/* Post construction reads a range of the primary btree, computes the secondary index
+entries for it and buffers them.  After the traversal, it sorts the buffered entries by
+secondary index key and inserts them in that order.  Entries that follow each other in
+the sorted order mostly go into the same leaf, which is then still in the cache, so each
+leaf gets loaded and written about once per pass.  Inserting in the order of the primary
+keys instead would touch a random leaf of the secondary index for every row.
+
+Buffering the entries is safe, because the writes to the range that's being constructed
+go into the modification queue until the pass is over, and get applied after the
+entries have been inserted (see `post_construct_and_drain_queue()`). */
 class post_construct_traversal_helper_t : public concurrent_traversal_callback_t {
 public:
     post_construct_traversal_helper_t(
             store_t *store,
-            const std::set<uuid_u> &sindexes_to_post_construct,
+            const std::map<uuid_u, sindex_disk_info_t> &sindexes_to_post_construct,
             cond_t *on_indexes_deleted,
             const std::function<bool(int64_t)> &check_should_abort,
             signal_t *interruptor)
@@ -2026,19 +2273,7 @@ public:
           check_should_abort_(check_should_abort),
           pairs_constructed_(0),
           stopped_before_completion_(false),
-          current_chunk_size_(0) {
-        // Start an initial write transaction for the first chunk.
-        // (this acquisition should never block)
-        new_mutex_acq_t wtxn_acq(&wtxn_lock_);
-        start_write_transaction(&wtxn_acq);
-    }
-
-    ~post_construct_traversal_helper_t() {
-        sindexes_.clear();
-        if (wtxn_.has()) {
-            wtxn_->commit();
-        }
-    }
+          buffered_bytes_(0) { }
 
     continue_bool_t handle_pair(
             scoped_key_value_t &&keyvalue,
@@ -2053,67 +2288,45 @@ public:
         store_->btree->stats.pm_keys_read.record();
         store_->btree->stats.pm_total_keys_read += 1;
 
-        // Grab the key and value and construct a modification report for the key/value
-        // pair.
+        // Grab the key and value, and compute the secondary index entries for them.
         const store_key_t primary_key(keyvalue.key());
         const rdb_value_t *rdb_value =
             static_cast<const rdb_value_t *>(keyvalue.value());
-        rdb_modification_report_t mod_report(primary_key);
         const max_block_size_t block_size =
             keyvalue.expose_buf().cache()->max_block_size();
-        mod_report.info.added
-            = std::make_pair(
-                get_data(rdb_value, buf_parent_t(keyvalue.expose_buf())),
-                std::vector<char>(rdb_value->value_ref(),
-                    rdb_value->value_ref() + rdb_value->inline_size(block_size)));
+        const ql::datum_t doc =
+            get_data(rdb_value, buf_parent_t(keyvalue.expose_buf()));
+        const std::vector<char> value_ref(
+            rdb_value->value_ref(),
+            rdb_value->value_ref() + rdb_value->inline_size(block_size));
 
-        // Store the value into the secondary indexes
-        {
-            // We need this mutex because we don't want `wtxn` to be destructed,
-            // but also because only one coroutine can be traversing the indexes
-            // through `rdb_update_sindexes` at a time (or else the btree will get
-            // corrupted!).
-            new_mutex_acq_t wtxn_acq(&wtxn_lock_, interruptor_);
-            guarantee(wtxn_.has());
-            const rdb_post_construction_deletion_context_t deletion_context;
-            rdb_update_sindexes(store_,
-                                sindexes_,
-                                &mod_report,
-                                wtxn_.get(),
-                                &deletion_context,
-                                nullptr,
-                                nullptr,
-                                nullptr);
+        for (const auto &pair : sindexes_to_post_construct_) {
+            std::vector<std::pair<store_key_t, ql::datum_t> > keys;
+            try {
+                compute_keys(primary_key, doc, pair.second, &keys, nullptr);
+            } catch (const ql::base_exc_t &) {
+                // Do nothing (we just drop the row from the index).
+                continue;
+            }
+            std::vector<entry_t> *entries = &entries_[pair.first];
+            for (auto &&key : keys) {
+                buffered_bytes_ += key.first.size() + value_ref.size();
+                entries->push_back(entry_t{std::move(key.first), value_ref});
+            }
         }
 
-        // Account for the sindex writes in the stats
-        store_->btree->stats.pm_keys_set.record(sindexes_.size());
-        store_->btree->stats.pm_total_keys_set += sindexes_.size();
-
         // Update the traversed range boundary (everything below here will happen in
         // key order).
-        // This can't be interrupted, because we have already called rdb_update_sindexes,
+        // This can't be interrupted, because we have already buffered the entries,
         // so now we /must/ update traversed_right_bound.
         waiter.wait();
         traversed_right_bound_ = primary_key;
 
-        // Release the write transaction and secondary index locks once we've reached the
-        // designated chunk size. Then acquire a new transaction once the previous one
-        // has been flushed.
-        {
-            new_mutex_acq_t wtxn_acq(&wtxn_lock_, interruptor_);
-            ++current_chunk_size_;
-            if (current_chunk_size_ >= MAX_CHUNK_SIZE) {
-                current_chunk_size_ = 0;
-                sindexes_.clear();
-                wtxn_->commit();
-                wtxn_.reset();
-                start_write_transaction(&wtxn_acq);
-            }
-        }
-
         ++pairs_constructed_;
-        if (check_should_abort_(pairs_constructed_)) {
+        // We also stop early once the buffered entries take up too much memory.  The
+        // next pass starts where this one stopped.
+        if (check_should_abort_(pairs_constructed_)
+            || buffered_bytes_ >= MAX_BUFFERED_BYTES) {
             stopped_before_completion_ = true;
             return continue_bool_t::ABORT;
         } else {
@@ -2121,6 +2334,45 @@ public:
         }
     }
 
+    // Sorts the buffered entries and inserts them into the secondary indexes.
+    void insert_entries() THROWS_ONLY(interrupted_exc_t) {
+        size_t num_entries = 0;
+        for (auto &&pair : entries_) {
+            std::sort(pair.second.begin(), pair.second.end(),
+                      [](const entry_t &a, const entry_t &b) {
+                          return a.key < b.key;
+                      });
+            num_entries = std::max(num_entries, pair.second.size());
+        }
+
+        // Each chunk of entries gets its own write transaction.  The chunks still go
+        // into the indexes one after the other, because the transactions acquire the
+        // sindex superblocks in the order of their write tokens.  But a transaction
+        // can start inserting as soon as the one before it has released them, instead
+        // of waiting for it to be flushed to disk, which is what takes most of the
+        // time with `HARD` durability.
+        const int64_t num_chunks = (num_entries + MAX_CHUNK_SIZE - 1) / MAX_CHUNK_SIZE;
+        bool interrupted = false;
+        throttled_pmap(num_chunks, [&](int64_t chunk) {
+            if (interrupted || interruptor_->is_pulsed()) {
+                interrupted = true;
+                return;
+            }
+            try {
+                insert_chunk(chunk * MAX_CHUNK_SIZE);
+            } catch (const interrupted_exc_t &) {
+                /* don't throw since we're in throttled_pmap() */
+                interrupted = true;
+            }
+        }, MAX_CONCURRENT_CHUNKS);
+        if (interrupted) {
+            throw interrupted_exc_t();
+        }
+
+        entries_.clear();
+        buffered_bytes_ = 0;
+    }
+
     store_key_t get_traversed_right_bound() const {
         return traversed_right_bound_;
     }
@@ -2130,15 +2382,88 @@ public:
     }
 
 private:
-    // Number of key/value pairs we process before releasing the write transaction
-    // and waiting for the secondary index data to be flushed to disk.
-    // Also see the comment above `scoped_ptr_t<txn_t> wtxn;` below.
-    static const int MAX_CHUNK_SIZE = 32;
+    struct entry_t {
+        store_key_t key;
+        std::vector<char> value_ref;
+    };
+
+    // Number of secondary index entries we insert before releasing the write
+    // transaction and waiting for the secondary index data to be flushed to disk.
+    // We reset the transaction after each chunk because large write transactions can
+    // cause the cache to go into throttling, and that would interfere with other
+    // transactions on this table.
+    // Another aspect to keep in mind is that if we hold the write lock on the sindexes
+    // for too long, other concurrent writes to parts of the secondary index that
+    // are already live will also be delayed.
+    static const size_t MAX_CHUNK_SIZE = 32;
+
+    // How many chunks can be in flight at the same time.
+    static const int64_t MAX_CONCURRENT_CHUNKS = 4;
+
+    // How much memory the buffered entries may use before we stop the pass.
+    static const size_t MAX_BUFFERED_BYTES = 8 * MEGABYTE;
+
+    // Inserts the entries from `chunk_begin` up to `chunk_begin + MAX_CHUNK_SIZE`
+    // into each index, in a write transaction of their own.
+    void insert_chunk(size_t chunk_begin) THROWS_ONLY(interrupted_exc_t) {
+        scoped_ptr_t<txn_t> txn;
+        store_t::sindex_access_vector_t sindexes;
+        start_write_transaction(&txn, &sindexes);
+        if (sindexes.empty()) {
+            // All indexes have been deleted.
+            txn->commit();
+            on_indexes_deleted_->pulse_if_not_already_pulsed();
+            throw interrupted_exc_t();
+        }
 
-    void start_write_transaction(new_mutex_acq_t *wtxn_acq) {
-        wtxn_acq->guarantee_is_holding(&wtxn_lock_);
-        guarantee(!wtxn_.has());
+        const rdb_post_construction_deletion_context_t deletion_context;
+        for (auto &&access : sindexes) {
+            const std::vector<entry_t> &entries = entries_[access->sindex.id];
+            const size_t chunk_end =
+                std::min(entries.size(), chunk_begin + MAX_CHUNK_SIZE);
+            sindex_superblock_t *superblock = access->superblock.get();
+            for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                promise_t<superblock_t *> return_superblock_local;
+                {
+                    keyvalue_location_t kv_location;
+                    rdb_value_sizer_t sizer(superblock->cache()->max_block_size());
+                    find_keyvalue_location_for_write(
+                        &sizer,
+                        superblock,
+                        entries[i].key.btree_key(),
+                        repli_timestamp_t::distant_past,
+                        deletion_context.balancing_detacher(),
+                        &kv_location,
+                        nullptr,
+                        &return_superblock_local);
 
+                    ql::serialization_result_t res =
+                        kv_location_set(&kv_location, entries[i].key,
+                                        entries[i].value_ref,
+                                        repli_timestamp_t::distant_past,
+                                        &deletion_context);
+                    // this particular context cannot fail AT THE MOMENT.
+                    guarantee(!bad(res));
+                    // The keyvalue location gets destroyed here.
+                }
+                superblock = static_cast<sindex_superblock_t *>(
+                    return_superblock_local.wait());
+            }
+
+            // Account for the sindex writes in the stats
+            if (chunk_end > chunk_begin) {
+                store_->btree->stats.pm_keys_set.record(chunk_end - chunk_begin);
+                store_->btree->stats.pm_total_keys_set += chunk_end - chunk_begin;
+            }
+        }
+
+        // Releasing the sindex superblocks lets the next chunk start.
+        sindexes.clear();
+        txn->commit();
+    }
+
+    void start_write_transaction(scoped_ptr_t<txn_t> *txn_out,
+                                 store_t::sindex_access_vector_t *sindexes_out) {
         // Start a write transaction and acquire the secondary indexes
         write_token_t token;
         store_->new_write_token(&token);
@@ -2151,10 +2476,10 @@ private:
         // needed here.
         scoped_ptr_t<real_superblock_t> superblock;
         store_->acquire_superblock_for_write(
-                2 + MAX_CHUNK_SIZE,
+                2 + MAX_CHUNK_SIZE * sindexes_to_post_construct_.size(),
                 write_durability_t::HARD,
                 &token,
-                &wtxn_,
+                txn_out,
                 &superblock,
                 interruptor_);
 
@@ -2163,35 +2488,28 @@ private:
         buf_lock_t sindex_block(superblock->expose_buf(), sindex_block_id,
                                 access_t::write);
         superblock.reset();
+        std::set<uuid_u> sindex_ids;
+        for (const auto &pair : sindexes_to_post_construct_) {
+            sindex_ids.insert(pair.first);
+        }
         store_t::sindex_access_vector_t all_sindexes;
         store_->acquire_sindex_superblocks_for_write(
-            make_optional(sindexes_to_post_construct_),
+            make_optional(sindex_ids),
             &sindex_block,
             &all_sindexes);
 
         // Filter out indexes that are being deleted. No need to keep post-constructing
         // those.
-        guarantee(sindexes_.empty());
+        guarantee(sindexes_out->empty());
         for (auto &&access : all_sindexes) {
             if (!access->sindex.being_deleted) {
-                sindexes_.emplace_back(std::move(access));
+                sindexes_out->emplace_back(std::move(access));
             }
         }
-        if (sindexes_.empty()) {
-            // All indexes have been deleted. Interrupt the traversal.
-            on_indexes_deleted_->pulse_if_not_already_pulsed();
-        }
-
-        // We pretend that the indexes have been fully constructed, so that when we call
-        // `rdb_update_sindexes` above, it actually updates the range we're currently
-        // constructing. This is a bit hacky, but works.
-        for (auto &&access : sindexes_) {
-            access->sindex.needs_post_construction_range = key_range_t::empty();
-        }
     }
 
     store_t *store_;
-    const std::set<uuid_u> sindexes_to_post_construct_;
+    const std::map<uuid_u, sindex_disk_info_t> sindexes_to_post_construct_;
     cond_t *on_indexes_deleted_;
     signal_t *interruptor_;
 
@@ -2202,19 +2520,9 @@ private:
     store_key_t traversed_right_bound_;
     bool stopped_before_completion_;
 
-    // We re-use a single write transaction and secondary index acquisition for a chunk
-    // of writes to get better efficiency when flushing the index writes to disk.
-    // We reset the transaction  after each chunk because large write transactions can
-    // cause the cache to go into throttling, and that would interfere with other
-    // transactions on this table.
-    // Another aspect to keep in mind is that if we hold the write lock on the sindexes
-    // for too long, other concurrent writes to parts of the secondary index that
-    // are already live will also be delayed.
-    scoped_ptr_t<txn_t> wtxn_;
-    store_t::sindex_access_vector_t sindexes_;
-    int current_chunk_size_;
-    // Controls access to `sindexes_` and `wtxn_`.
-    new_mutex_t wtxn_lock_;
+    // The entries that `insert_entries()` will insert, by index.
+    std::map<uuid_u, std::vector<entry_t> > entries_;
+    size_t buffered_bytes_;
 };
 
 void post_construct_secondary_index_range(
@@ -2247,13 +2555,33 @@ void post_construct_secondary_index_range(
         interruptor,
         true /* USE_SNAPSHOT */);
 
-    // Note: This starts a write transaction, which might get throttled.
-    // It is important that we construct the `traversal_cb` *after* we've started
-    // the snapshotted read transaction, or otherwise we might deadlock in the presence
-    // of additional (unrelated) write transactions..
+    // Get the definitions of the indexes, so that we can compute their entries.
+    std::map<uuid_u, sindex_disk_info_t> sindexes_to_post_construct;
+    {
+        buf_lock_t sindex_block(superblock->expose_buf(),
+                                superblock->get_sindex_block_id(),
+                                access_t::read);
+        for (const uuid_u &id : sindex_ids_to_post_construct) {
+            secondary_index_t sindex;
+            if (get_secondary_index(&sindex_block, id, &sindex)
+                && !sindex.being_deleted) {
+                try {
+                    deserialize_sindex_info_or_crash(
+                        sindex.opaque_definition, &sindexes_to_post_construct[id]);
+                } catch (const archive_exc_t &e) {
+                    crash("%s", e.what());
+                }
+            }
+        }
+    }
+    if (sindexes_to_post_construct.empty()) {
+        // All indexes have been deleted.
+        throw interrupted_exc_t();
+    }
+
     post_construct_traversal_helper_t traversal_cb(
         store,
-        sindex_ids_to_post_construct,
+        sindexes_to_post_construct,
         &on_index_deleted_interruptor,
         check_should_abort,
         interruptor);
@@ -2273,6 +2601,11 @@ void post_construct_secondary_index_range(
         throw interrupted_exc_t();
     }
 
+    // Note: This starts write transactions, which might get throttled.  We still hold
+    // the snapshotted read transaction at this point, which is fine because the
+    // traversal has already released the superblock.
+    traversal_cb.insert_entries();
+
     // Update the left bound of the construction range
     if (!traversal_cb.stopped_before_completion()) {
         // The construction is done. Set the remaining range to empty.
@@ -2287,4 +2620,82 @@ void post_construct_secondary_index_range(
     }
 }
 
+class first_key_finder_t : public depth_first_traversal_callback_t {
+public:
+    first_key_finder_t() : found(false) { }
+    continue_bool_t handle_pair(scoped_key_value_t &&keyvalue, signal_t *) {
+        key.assign(keyvalue.key());
+        found = true;
+        return continue_bool_t::ABORT;
+    }
+    bool found;
+    store_key_t key;
+};
+
+void compact_secondary_index(
+        store_t *store,
+        const uuid_u &sindex_id,
+        signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t) {
+    std::set<uuid_u> sindex_ids;
+    sindex_ids.insert(sindex_id);
+    rdb_value_sizer_t sizer(store->cache->max_block_size());
+    rdb_live_deletion_context_t deletion_context;
+
+    // Every step gets a transaction of its own, so that we never hold up the live
+    // writes to the index for long.
+    store_key_t key = store_key_t::min();
+    for (;;) {
+        if (interruptor->is_pulsed()) {
+            throw interrupted_exc_t();
+        }
+        write_token_t token;
+        store->new_write_token(&token);
+        scoped_ptr_t<txn_t> txn;
+        scoped_ptr_t<real_superblock_t> superblock;
+        store->acquire_superblock_for_write(
+            3, write_durability_t::SOFT, &token, &txn, &superblock, interruptor);
+        buf_lock_t sindex_block(superblock->expose_buf(),
+                                superblock->get_sindex_block_id(),
+                                access_t::write);
+        superblock.reset();
+        store_t::sindex_access_vector_t sindexes;
+        store->acquire_sindex_superblocks_for_write(
+            make_optional(sindex_ids), &sindex_block, &sindexes);
+        sindex_block.reset_buf_lock();
+        if (sindexes.empty() || sindexes[0]->sindex.being_deleted) {
+            sindexes.clear();
+            txn->commit();
+            return;
+        }
+
+        store_key_t last_key;
+        promise_t<superblock_t *> return_superblock;
+        const bool has_keys = merge_leaf_if_possible(
+            &sizer, sindexes[0]->superblock.get(), key.btree_key(),
+            deletion_context.balancing_detacher(), &last_key, &return_superblock);
+
+        // The next step starts in the leaf after this one, which is where the next
+        // key after `last_key` is.
+        first_key_finder_t finder;
+        if (has_keys) {
+            btree_depth_first_traversal(
+                return_superblock.wait(),
+                key_range_t(key_range_t::bound_t::open, last_key,
+                            key_range_t::bound_t::none, store_key_t()),
+                &finder,
+                access_t::read,
+                direction_t::FORWARD,
+                release_superblock_t::RELEASE,
+                interruptor);
+        }
+        sindexes.clear();
+        txn->commit();
+        if (!finder.found) {
+            return;
+        }
+        key = finder.key;
+    }
+}
+
 void noop_value_deleter_t::delete_value(buf_parent_t, const void *) const { }
@@ -15,9 +15,11 @@
 #include "rdb_protocol/protocol.hpp"
 #include "rdb_protocol/store.hpp"
 
+class btree_bulk_appender_t;
 class btree_slice_t;
 enum class delete_mode_t;
 class deletion_context_t;
+class key_distribution_cache_t;
 class key_tester_t;
 template <class> class promise_t;
 struct rdb_value_t;
@@ -131,6 +133,13 @@ void rdb_set(const store_key_t &key, ql::datum_t data,
              profile::trace_t *trace,
              promise_t<superblock_t *> *pass_back_superblock = nullptr);
 
+/* Like `rdb_set()`, but puts `data` into the btree through `appender` instead of
+looking up the key. `key` must be one that `appender->can_append()`. */
+void rdb_append(const store_key_t &key, ql::datum_t data,
+                btree_slice_t *slice, repli_timestamp_t timestamp,
+                btree_bulk_appender_t *appender,
+                rdb_modification_info_t *mod_info);
+
 void rdb_delete(const store_key_t &key, btree_slice_t *slice, repli_timestamp_t
                 timestamp, real_superblock_t *superblock,
                 const deletion_context_t *deletion_context,
@@ -201,6 +210,7 @@ void rdb_get_nearest_slice(
 void rdb_distribution_get(int max_depth,
                           const store_key_t &left_key,
                           real_superblock_t *superblock,
+                          key_distribution_cache_t *cache,
                           distribution_read_response_t *response);
 
 /* Secondary Indexes */
@@ -345,6 +355,15 @@ void post_construct_secondary_index_range(
         signal_t *interruptor)
     THROWS_ONLY(interrupted_exc_t);
 
+/* Merges neighboring leaves of the secondary index that fit into one leaf, going
+through the index from left to right.  Post construction inserts the entries of each
+pass in sorted order, which leaves many leaves half full. */
+void compact_secondary_index(
+        store_t *store,
+        const uuid_u &sindex_id,
+        signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t);
+
 /* This deleter actually deletes the value and all associated blocks. */
 class rdb_value_deleter_t : public value_deleter_t {
 public:
@@ -93,6 +93,7 @@ store_t::store_t(const region_t &_region,
       io_backender_(io_backender), base_path_(base_path),
       perfmon_collection_membership(parent_perfmon_collection, &perfmon_collection, perfmon_name),
       ctx(_ctx),
+      changefeed_servers_lock(rwlock_bias_t::readers),
       table_id(_table_id),
       write_superblock_acq_semaphore(WRITE_SUPERBLOCK_ACQ_WAITERS_LIMIT)
 {
@@ -239,6 +240,10 @@ void store_t::write(
     txn->commit();
 }
 
+// How many keys `reset_data()` erases per transaction.
+static const uint64_t max_erased_per_pass = 100;
+static const uint64_t max_erased_per_pass_without_sindexes = 1000;
+
 void store_t::reset_data(
         const binary_blob_t &zero_metainfo,
         const region_t &subregion,
@@ -251,7 +256,6 @@ void store_t::reset_data(
 
     // Erase the data in small chunks
     always_true_key_tester_t key_tester;
-    const uint64_t max_erased_per_pass = 100;
     for (continue_bool_t done_erasing = continue_bool_t::CONTINUE;
          done_erasing == continue_bool_t::CONTINUE;) {
         scoped_ptr_t<txn_t> txn;
@@ -271,6 +275,13 @@ void store_t::reset_data(
                                 superblock->get_sindex_block_id(),
                                 access_t::write);
 
+        /* The modification reports are only needed to update the secondary indexes and
+        the queues of the ones under construction. Without those, we can skip loading
+        each document and erase more keys per transaction. */
+        std::map<sindex_name_t, secondary_index_t> sindexes;
+        get_secondary_indexes(&sindex_block, &sindexes);
+        const bool need_mod_reports = !sindexes.empty() || !sindex_queues.empty();
+
         /* Note we don't allow interruption during this step; it's too easy to end up in
         an inconsistent state. */
         cond_t non_interruptor;
@@ -284,8 +295,10 @@ void store_t::reset_data(
                                              superblock.get(),
                                              &deletion_context,
                                              &non_interruptor,
-                                             max_erased_per_pass,
-                                             &mod_reports,
+                                             need_mod_reports
+                                                 ? max_erased_per_pass
+                                                 : max_erased_per_pass_without_sindexes,
+                                             need_mod_reports ? &mod_reports : nullptr,
                                              &deleted_range);
 
         region_t deleted_region(subregion.beg, subregion.end, deleted_range);
@@ -491,6 +504,20 @@ void store_t::configure_flush_interval(flush_interval_t interval) {
     cache->configure_flush_interval(interval);
 }
 
+void store_t::configure_cache_priority(double priority) {
+    cache->configure_cache_priority(priority);
+}
+
+std::vector<block_id_t> store_t::warm_cache_block_ids() const {
+    assert_thread();
+    return cache->warm_block_ids();
+}
+
+void store_t::warm_up_cache(std::vector<block_id_t> &&block_ids) {
+    assert_thread();
+    cache->warm_up(std::move(block_ids));
+}
+
 new_mutex_in_line_t store_t::get_in_line_for_sindex_queue(buf_lock_t *sindex_block) {
     assert_thread();
     // The line for the sindex queue is there to guarantee that we push things to
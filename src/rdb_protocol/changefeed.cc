@@ -9,6 +9,8 @@
 #include "concurrency/cross_thread_signal.hpp"
 #include "concurrency/interruptor.hpp"
 #include "containers/archive/boost_types.hpp"
+#include "containers/archive/stl_types.hpp"
+#include "containers/archive/vector_stream.hpp"
 #include "rdb_protocol/artificial_table/backend.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/env.hpp"
@@ -497,7 +499,22 @@ struct stamped_msg_t {
     msg_t submsg;
 };
 
-RDB_MAKE_SERIALIZABLE_3(stamped_msg_t, server_uuid, stamp, submsg);
+// The messages from one server to one client that got batched together.
+struct stamped_msgs_t {
+    stamped_msgs_t() { }
+    stamped_msgs_t(uuid_u _server_uuid,
+                   std::vector<std::pair<uint64_t, msg_t> > &&_msgs)
+        : server_uuid(std::move(_server_uuid)),
+          msgs(std::move(_msgs)) { }
+    uuid_u server_uuid;
+    // The messages with their stamps.
+    std::vector<std::pair<uint64_t, msg_t> > msgs;
+};
+
+RDB_MAKE_SERIALIZABLE_2(stamped_msgs_t, server_uuid, msgs);
+
+// The most messages `server_t::send_all` puts into one mailbox message.
+const size_t max_pending_msgs = 1000;
 
 // This function takes a `lock_t` to make sure you have one.  (We can't just
 // always acquire a drainer lock before sending because we sometimes send a
@@ -515,7 +532,13 @@ void server_t::send_one_with_lock(
         ASSERT_NO_CORO_WAITING;
         stamp = client->second.stamp++;
     }
-    send(manager, client->first, stamped_msg_t(uuid, stamp, std::move(msg)));
+    auto it = pending.find(client->first);
+    if (it == pending.end()) {
+        it = pending.insert(std::make_pair(
+            client->first, std::vector<std::pair<uint64_t, msg_t> >())).first;
+    }
+    it->second.push_back(std::make_pair(stamp, std::move(msg)));
+    send_pending(client->first);
 }
 
 void server_t::send_all(
@@ -542,10 +565,35 @@ void server_t::send_all(
     acq.reset();
     stamp_spot->reset(); // Done stamping, no need to hold onto it while we send.
     for (const auto &pair : stamps) {
-        send(manager, pair.first, stamped_msg_t(uuid, pair.second, msg));
+        std::vector<std::pair<uint64_t, msg_t> > *msgs = &pending[pair.first];
+        msgs->push_back(std::make_pair(pair.second, msg));
+        if (msgs->size() >= max_pending_msgs) {
+            send_pending(pair.first);
+        } else if (msgs->size() == 1) {
+            // This runs after the coroutines that are already waiting to run,
+            // which includes other writes that are about to call `send_all`.
+            coro_t::spawn_sometime(
+                std::bind(&server_t::send_pending_cb, this, pair.first, keepalive));
+        }
     }
 }
 
+void server_t::send_pending(const client_t::addr_t &addr) {
+    auto it = pending.find(addr);
+    if (it == pending.end()) {
+        return;
+    }
+    stamped_msgs_t msgs(uuid, std::move(it->second));
+    pending.erase(it);
+    send(manager, addr, msgs);
+}
+
+void server_t::send_pending_cb(
+        const client_t::addr_t &addr, auto_drainer_t::lock_t lock) {
+    lock.assert_is_holding(&drainer);
+    send_pending(addr);
+}
+
 server_t::addr_t server_t::get_stop_addr() {
     return stop_mailbox.get_address();
 }
@@ -872,6 +920,7 @@ limit_manager_t::limit_manager_t(
       spec(std::move(_spec)),
       gt(std::move(_gt)),
       item_queue(gt),
+      reserve(gt),
       aborted(false) {
     guarantee(clients_lock->read_signal()->is_pulsed());
 
@@ -941,14 +990,16 @@ public:
                   const keyspec_t::limit_t *_spec,
                   sorting_t _sorting,
                   optional<item_t> _start,
-                  const item_queue_t *_item_queue)
+                  const item_queue_t *_item_queue,
+                  size_t _extra)
         : env(_env),
           ops(_ops),
           pk_range(_pk_range),
           spec(_spec),
           sorting(_sorting),
           start(std::move(_start)),
-          item_queue(_item_queue) { }
+          item_queue(_item_queue),
+          extra(_extra) { }
 
     std::vector<item_t> operator()(const primary_ref_t &ref) {
         rget_read_response_t resp;
@@ -971,7 +1022,7 @@ public:
         case sorting_t::UNORDERED: // fallthru
         default: unreachable();
         }
-        size_t n = spec->limit - item_queue->size();
+        size_t n = spec->limit - item_queue->size() + extra;
         rdb_rget_slice(
             ref.btree,
             region_t(),
@@ -1026,7 +1077,7 @@ public:
                 [](const datum_range_t &) { return true; },
                 [](const std::map<datum_t, uint64_t> &) { return false; }));
         datum_range_t srange = spec->range.datumspec.covering_range();
-        size_t n = spec->limit - item_queue->size();
+        size_t n = spec->limit - item_queue->size() + extra;
         if (start) {
             datum_t dstart = start->second.first;
             switch (sorting) {
@@ -1104,14 +1155,19 @@ private:
     sorting_t sorting;
     optional<item_t> start;
     const item_queue_t *item_queue;
+    // How many rows to read beyond the ones that fit into `item_queue`.
+    size_t extra;
 };
 
 std::vector<item_t> limit_manager_t::read_more(
     const boost::variant<primary_ref_t, sindex_ref_t> &ref,
     const optional<item_t> &start) {
     guarantee(item_queue.size() < spec.limit);
+    guarantee(reserve.size() == 0);
+    // We read enough to also fill `reserve`.
     ref_visitor_t visitor(
-        env.get(), &ops, &region.inner, &spec, spec.range.sorting, start, &item_queue);
+        env.get(), &ops, &region.inner, &spec, spec.range.sorting, start, &item_queue,
+        spec.limit);
     return boost::apply_visitor(visitor, ref);
 }
 
@@ -1132,6 +1188,13 @@ void limit_manager_t::commit(
     if (item_queue_it != item_queue.end()) {
         active_boundary.set(**item_queue_it);
     }
+    // Similarly, anything <= the last row of `reserve` belongs into `reserve`
+    // if it doesn't make it into the active set.
+    optional<item_t> reserve_boundary;
+    auto reserve_it = reserve.begin();
+    if (reserve_it != reserve.end()) {
+        reserve_boundary.set(**reserve_it);
+    }
 
     item_queue_t real_added(gt);
     std::set<std::string> real_deleted;
@@ -1140,6 +1203,8 @@ void limit_manager_t::commit(
         if (data_deleted) {
             bool inserted = real_deleted.insert(id).second;
             guarantee(inserted);
+        } else {
+            UNUSED bool reserve_deleted = reserve.del_id(id);
         }
     }
     deleted.clear();
@@ -1156,13 +1221,18 @@ void limit_manager_t::commit(
             guarantee(inserted);
             inserted = real_added.insert(pair).second;
             guarantee(inserted);
+        } else if (reserve_boundary && !gt(item_t(pair), *reserve_boundary)) {
+            bool inserted = reserve.insert(pair).second;
+            guarantee(inserted);
         } else {
             added_on_disk = true;
         }
     }
     added.clear();
 
-    std::vector<std::string> truncated = item_queue.truncate_top(spec.limit);
+    // The rows that drop out of the active set are the ones right after it.
+    std::vector<std::string> truncated =
+        item_queue.truncate_top_into(spec.limit, &reserve);
     for (auto &&id : truncated) {
         auto it = real_added.find_id(id);
         if (it != real_added.end()) {
@@ -1173,8 +1243,30 @@ void limit_manager_t::commit(
         }
     }
 
+    reserve.truncate_top(spec.limit);
+
+    // Replace the rows that dropped out of the active set from `reserve`, best
+    // rows first.
+    bool refilled = false;
+    while (item_queue.size() < spec.limit && reserve.size() != 0) {
+        auto it = reserve.end();
+        --it;
+        item_t item(**it);
+        reserve.erase(it);
+        bool inserted = item_queue.insert(item).second;
+        guarantee(inserted);
+        inserted = real_added.insert(std::move(item)).second;
+        guarantee(inserted);
+        refilled = true;
+    }
+
     bool anything_on_disk = real_deleted.size() != 0 || added_on_disk;
     if (item_queue.size() < spec.limit && anything_on_disk) {
+        // Everything up to the last row we took from `reserve` is already in
+        // the active set.
+        if (refilled) {
+            active_boundary.set(**item_queue.begin());
+        }
         std::vector<item_t> s;
         optional<exc_t> exc;
         try {
@@ -1196,9 +1288,11 @@ void limit_manager_t::commit(
                 guarantee(added_insert);
             }
         }
-        // We need to truncate again because `read_more` may read too much in
-        // the secondary index case.
-        std::vector<std::string> read_trunc = item_queue.truncate_top(spec.limit);
+        // We need to truncate again because `read_more` reads enough for
+        // `reserve` as well.
+        std::vector<std::string> read_trunc =
+            item_queue.truncate_top_into(spec.limit, &reserve);
+        reserve.truncate_top(spec.limit);
         for (auto &&id : read_trunc) {
             auto it = real_added.find_id(id);
             if (it != real_added.end()) {
@@ -1602,6 +1696,13 @@ class empty_sub_t;
 class point_sub_t;
 class limit_sub_t;
 
+// The old and new value of a change after applying some range subscription's
+// transformations, keyed by `range_sub_t::get_ops_key`.  Many subscriptions
+// often use the same transformations (think of thousands of clients watching
+// `filter({room: X}).changes()` for the same `X`), and those only need to be
+// applied once per change.
+typedef std::map<std::string, std::pair<datum_t, datum_t> > ops_results_t;
+
 class feed_t : public home_thread_mixin_t, public slow_atomic_countable_t<feed_t> {
 public:
     feed_t(namespace_id_t const &, lifetime_t<name_resolver_t const &>);
@@ -1619,8 +1720,15 @@ public:
     void add_limit_sub(limit_sub_t *sub, const uuid_u &uuid) THROWS_NOTHING;
     void del_limit_sub(limit_sub_t *sub, const uuid_u &uuid) THROWS_NOTHING;
 
-    void each_range_sub(const auto_drainer_t::lock_t &lock,
-                        const std::function<void(range_sub_t *)> &f) THROWS_NOTHING;
+    // Calls `f` for every range subscription that might be interested in a
+    // change from `old_val` to `new_val` (either of which may be empty).  `f`
+    // gets passed the results shared with the other subscriptions on the same
+    // thread.
+    void each_range_sub(
+        const auto_drainer_t::lock_t &lock,
+        const datum_t &old_val,
+        const datum_t &new_val,
+        const std::function<void(range_sub_t *, ops_results_t *)> &f) THROWS_NOTHING;
     void update_stamps(uuid_u server_uuid, uint64_t stamp);
     std::map<uuid_u, uint64_t> get_stamps();
     void on_point_sub(
@@ -1685,6 +1793,11 @@ private:
     std::vector<std::set<empty_sub_t *> > empty_subs;
     rwlock_t empty_subs_lock;
     std::vector<std::set<range_sub_t *> > range_subs;
+    // Range subscriptions with a `get_filter_key`, by field and value.  These
+    // are protected by `range_subs_lock` as well.
+    std::map<datum_string_t,
+             std::map<datum_t, std::vector<std::set<range_sub_t *> > > >
+        filtered_range_subs;
     rwlock_t range_subs_lock;
     std::map<uuid_u, std::vector<std::set<limit_sub_t *> > > limit_subs;
     rwlock_t limit_subs_lock;
@@ -1740,14 +1853,14 @@ private:
     virtual void maybe_remove_feed() { client->maybe_remove_feed(client_lock, table_id); }
     virtual void stop_limit_sub(limit_sub_t *sub);
 
-    void mailbox_cb(signal_t *interruptor, stamped_msg_t msg);
+    void mailbox_cb(signal_t *interruptor, stamped_msgs_t msgs);
     void constructor_cb();
 
     auto_drainer_t::lock_t client_lock;
     client_t *client;
     namespace_id_t table_id;
     mailbox_manager_t *manager;
-    mailbox_t<stamped_msg_t> mailbox;
+    mailbox_t<stamped_msgs_t> mailbox;
     std::vector<server_t::addr_t> stop_addrs;
     std::vector<scoped_ptr_t<disconnect_watcher_t> > disconnect_watchers;
 
@@ -2185,6 +2298,30 @@ public:
         for (const auto &transform : spec.transforms) {
             ops.push_back(make_op(transform));
         }
+        if (has_ops()) {
+            // The transformations are deterministic, so they only depend on the
+            // value and on the limits they run with.
+            write_message_t wm;
+            serialize<cluster_version_t::CLUSTER>(&wm, spec.transforms);
+            serialize<cluster_version_t::CLUSTER>(&wm, env->limits());
+            vector_stream_t stream;
+            int res = send_write_message(&stream, &wm);
+            guarantee(res == 0);
+            ops_key.assign(stream.vector().begin(), stream.vector().end());
+
+            // Without a default, rows for which the filter fails with an error
+            // are dropped just like rows that don't pass it.
+            const filter_wire_func_t *filter =
+                boost::get<filter_wire_func_t>(&spec.transforms[0]);
+            datum_string_t field;
+            datum_t value;
+            if (filter != nullptr
+                && !filter->default_filter_val.has_value()
+                && filter->filter_func.compile_wire_func()->equality_filter(
+                    &field, &value)) {
+                filter_key.set(std::make_pair(std::move(field), std::move(value)));
+            }
+        }
         store_keys = spec.datumspec.primary_key_map();
         if (!store_keys.has_value()) {
             store_key_range.set(spec.datumspec.covering_range().to_primary_keyrange());
@@ -2223,6 +2360,13 @@ public:
     }
 
     bool has_ops() { return ops.size() != 0; }
+    // Subscriptions with the same key get the same results from `apply_ops`.
+    const std::string &get_ops_key() const { return ops_key; }
+    // Set if our first transformation only passes rows whose top-level field
+    // `first` equals `second`, which `feed_t` uses to skip us for other rows.
+    const optional<std::pair<datum_string_t, datum_t> > &get_filter_key() const {
+        return filter_key;
+    }
 
     optional<datum_t> apply_ops(datum_t val) {
         guarantee(active());
@@ -2398,6 +2542,8 @@ private:
 
     scoped_ptr_t<env_t> env;
     std::vector<scoped_ptr_t<op_t> > ops;
+    std::string ops_key;
+    optional<std::pair<datum_string_t, datum_t> > filter_key;
 
     // The stamp (see `stamped_msg_t`) associated with our `changefeed_stamp_t`
     // read.  We use these to make sure we don't see changes from writes before
@@ -2838,23 +2984,33 @@ public:
     void operator()(const msg_t::change_t &change) const {
         datum_t null = datum_t::null();
 
-        feed->each_range_sub(*lock, [&](range_sub_t *sub) {
+        feed->each_range_sub(
+            *lock, change.old_val, change.new_val,
+            [&](range_sub_t *sub, ops_results_t *results) {
             datum_t new_val = null, old_val = null;
             if (!sub->active()) return;
             bool trivial = false;
             if (sub->has_ops()) {
-                if (change.new_val.has()) {
-                    if (optional<datum_t> d = sub->apply_ops(change.new_val)) {
-                        new_val = *d;
+                auto it = results->find(sub->get_ops_key());
+                if (it != results->end()) {
+                    new_val = it->second.first;
+                    old_val = it->second.second;
+                } else {
+                    if (change.new_val.has()) {
+                        if (optional<datum_t> d = sub->apply_ops(change.new_val)) {
+                            new_val = *d;
+                        }
                     }
-                }
-                if (!sub->active()) return;
-                if (change.old_val.has()) {
-                    if (optional<datum_t> d = sub->apply_ops(change.old_val)) {
-                        old_val = *d;
+                    if (!sub->active()) return;
+                    if (change.old_val.has()) {
+                        if (optional<datum_t> d = sub->apply_ops(change.old_val)) {
+                            old_val = *d;
+                        }
                     }
+                    if (!sub->active()) return;
+                    results->insert(std::make_pair(
+                        sub->get_ops_key(), std::make_pair(new_val, old_val)));
                 }
-                if (!sub->active()) return;
                 // Duplicate values are caught before being written to disk and
                 // don't generate a `mod_report`, but if we have transforms the
                 // values might have changed.
@@ -2962,7 +3118,7 @@ void msg_visit(feed_t *feed,
     feed->update_stamps(server_uuid, stamp);
 }
 
-void real_feed_t::mailbox_cb(signal_t *, stamped_msg_t msg) {
+void real_feed_t::mailbox_cb(signal_t *, stamped_msgs_t msgs) {
     // We stop receiving messages when detached (we're only receiving
     // messages because we haven't managed to get a message to the
     // stop mailboxes for some of the primary replicas yet).  This also stops
@@ -2979,7 +3135,7 @@ void real_feed_t::mailbox_cb(signal_t *, stamped_msg_t msg) {
         if (!lock.get_drain_signal()->is_pulsed()) {
             // We don't need a lock for this because the set of `uuid_u`s never
             // changes after it's initialized.
-            auto it = queues.find(msg.server_uuid);
+            auto it = queues.find(msgs.server_uuid);
             guarantee(it != queues.end());
             queue_t *queue = it->second.get();
             guarantee(queue != NULL);
@@ -2989,8 +3145,11 @@ void real_feed_t::mailbox_cb(signal_t *, stamped_msg_t msg) {
             if (detached) return;
 
             // Add us to the queue.
-            guarantee(msg.stamp >= queue->next);
-            queue->map.push(std::move(msg));
+            for (auto &&pair : msgs.msgs) {
+                guarantee(pair.first >= queue->next);
+                queue->map.push(stamped_msg_t(
+                    msgs.server_uuid, pair.first, std::move(pair.second)));
+            }
 
             // Read as much as we can from the queue (this enforces ordering.)
             while (queue->map.size() != 0 && queue->map.top().stamp == queue->next) {
@@ -3068,7 +3227,14 @@ private:
             }
             if (!src->is_exhausted() && !batcher.should_send_batch()) {
                 // Sorting must be UNORDERED for our last_read range calculation to work.
+                // Every read of the initial values descends into the btree of
+                // every shard again, so we don't scale down the first batch
+                // like we do for ordinary reads: clients of `include_initial`
+                // feeds wait for all of the initial values anyway.
                 batchspec_t new_bs = bs.with_lazy_sorting_override(sorting_t::UNORDERED);
+                if (new_bs.get_batch_type() == batch_type_t::NORMAL_FIRST) {
+                    new_bs = new_bs.with_new_batch_type(batch_type_t::NORMAL);
+                }
                 std::vector<datum_t> batch = src->next_batch(env, new_bs);
                 update_ranges();
                 r_sanity_check(active_state);
@@ -3516,14 +3682,31 @@ void feed_t::del_point_sub(point_sub_t *sub, const store_key_t &key) THROWS_NOTH
 // If this throws we might leak the increment to `num_subs`.
 void feed_t::add_range_sub(range_sub_t *sub) THROWS_NOTHING {
     add_sub_with_lock(&range_subs_lock, [this, sub]() {
-            auto pair = range_subs[sub->home_thread().threadnum].insert(sub);
-            guarantee(pair.second);
+            if (const auto &filter_key = sub->get_filter_key()) {
+                map_add_sub(&filtered_range_subs[filter_key->first],
+                            filter_key->second,
+                            sub);
+            } else {
+                auto pair = range_subs[sub->home_thread().threadnum].insert(sub);
+                guarantee(pair.second);
+            }
         });
 }
 
 // Can't throw because it's called in a destructor.
 void feed_t::del_range_sub(range_sub_t *sub) THROWS_NOTHING {
-    del_sub_with_lock(&range_subs_lock, [this, sub]() {
+    del_sub_with_lock(&range_subs_lock, [this, sub]() -> size_t {
+            if (const auto &filter_key = sub->get_filter_key()) {
+                auto it = filtered_range_subs.find(filter_key->first);
+                if (it == filtered_range_subs.end()) {
+                    return 0;
+                }
+                size_t erased = map_del_sub(&it->second, filter_key->second, sub);
+                if (it->second.empty()) {
+                    filtered_range_subs.erase(it);
+                }
+                return erased;
+            }
             return range_subs[sub->home_thread().threadnum].erase(sub);
         });
 }
@@ -3586,10 +3769,60 @@ void feed_t::each_sub_in_vec(
 
 void feed_t::each_range_sub(
     const auto_drainer_t::lock_t &lock,
-    const std::function<void(range_sub_t *)> &f) THROWS_NOTHING {
+    const datum_t &old_val,
+    const datum_t &new_val,
+    const std::function<void(range_sub_t *, ops_results_t *)> &f) THROWS_NOTHING {
     assert_thread();
+    guarantee(lock.has_lock());
     rwlock_in_line_t spot(&range_subs_lock, access_t::read);
-    each_sub_in_vec(range_subs, &spot, lock, f);
+    spot.read_signal()->wait_lazily_unordered();
+
+    // Subscriptions that filter on `field == value` can only produce anything if
+    // the old or the new value matches, so we only look at those.
+    std::vector<const std::vector<std::set<range_sub_t *> > *> vecs{&range_subs};
+    for (const auto &field_pair : filtered_range_subs) {
+        datum_t old_key, new_key;
+        if (old_val.has() && old_val.get_type() == datum_t::R_OBJECT) {
+            old_key = old_val.get_field(field_pair.first, NOTHROW);
+            if (old_key.has()) {
+                auto it = field_pair.second.find(old_key);
+                if (it != field_pair.second.end()) {
+                    vecs.push_back(&it->second);
+                }
+            }
+        }
+        if (new_val.has() && new_val.get_type() == datum_t::R_OBJECT) {
+            new_key = new_val.get_field(field_pair.first, NOTHROW);
+            if (new_key.has() && !(old_key.has() && old_key == new_key)) {
+                auto it = field_pair.second.find(new_key);
+                if (it != field_pair.second.end()) {
+                    vecs.push_back(&it->second);
+                }
+            }
+        }
+    }
+
+    std::vector<int> subscription_threads;
+    for (int i = 0; i < get_num_threads(); ++i) {
+        for (const auto *vec : vecs) {
+            if ((*vec)[i].size() != 0) {
+                subscription_threads.push_back(i);
+                break;
+            }
+        }
+    }
+    pmap(subscription_threads.size(),
+         [&f, &vecs, &subscription_threads](int i) {
+             on_thread_t th((threadnum_t(subscription_threads[i])));
+             // Every thread has its own results so that we don't need to
+             // synchronize access to them.
+             ops_results_t results;
+             for (const auto *vec : vecs) {
+                 for (range_sub_t *sub : (*vec)[subscription_threads[i]]) {
+                     f(sub, &results);
+                 }
+             }
+         });
 }
 
 void feed_t::each_point_sub_cb(const std::function<void(point_sub_t *)> &f, int i) {
@@ -3687,6 +3920,15 @@ void feed_t::stop_subs(const auto_drainer_t::lock_t &lock) {
             num_subs -= set.size();
             set.clear();
         }
+        for (auto &&field_pair : filtered_range_subs) {
+            for (auto &&pair : field_pair.second) {
+                each_sub_in_vec<range_sub_t>(pair.second, &spot, lock, f);
+                for (auto &&set : pair.second) {
+                    num_subs -= set.size();
+                }
+            }
+        }
+        filtered_range_subs.clear();
     }
     {
         rwlock_in_line_t spot(&empty_subs_lock, access_t::write);
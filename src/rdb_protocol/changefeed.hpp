@@ -130,9 +130,9 @@ struct msg_t {
 RDB_DECLARE_SERIALIZABLE(msg_t);
 
 class real_feed_t;
-struct stamped_msg_t;
+struct stamped_msgs_t;
 
-typedef mailbox_addr_t<stamped_msg_t> client_addr_t;
+typedef mailbox_addr_t<stamped_msgs_t> client_addr_t;
 
 struct keyspec_t {
     struct range_t {
@@ -360,6 +360,20 @@ public:
         guarantee(data.size() == index.size());
         return ret;
     }
+    // Like `truncate_top`, but moves the removed entries into `out`.
+    std::vector<Id> truncate_top_into(size_t n, index_queue_t *out) {
+        std::vector<Id> ret;
+        while (index.size() > n) {
+            diterator it = *index.begin();
+            ret.push_back(it->first);
+            auto pair = out->insert(it->first, it->second.first, it->second.second);
+            guarantee(pair.second);
+            index.erase(index.begin());
+            data.erase(it);
+        }
+        guarantee(data.size() == index.size());
+        return ret;
+    }
 };
 
 class limit_order_t {
@@ -449,6 +463,11 @@ private:
 
     limit_order_t gt;
     item_queue_t item_queue;
+    // The up to `spec.limit` rows that come right after the ones in
+    // `item_queue`.  There are no other rows in between, so when rows drop out
+    // of `item_queue` we can replace them from here instead of reading them
+    // from disk.
+    item_queue_t reserve;
 
     std::map<std::string, std::pair<datum_t, datum_t> > added;
     std::set<std::string> deleted;
@@ -551,6 +570,14 @@ private:
     void send_one_with_lock(std::pair<const client_t::addr_t, client_info_t> *client,
                             msg_t msg,
                             const auto_drainer_t::lock_t &lock);
+    // Sends the messages in `pending` for `addr`, if any.
+    void send_pending(const client_t::addr_t &addr);
+    void send_pending_cb(const client_t::addr_t &addr, auto_drainer_t::lock_t lock);
+
+    // Stamped messages that `send_all` hasn't sent yet.  Under a high write
+    // load many changes arrive before `send_pending_cb` gets to run, and those
+    // all go out in a single mailbox message.
+    std::map<client_t::addr_t, std::vector<std::pair<uint64_t, msg_t> > > pending;
 
     // Controls access to `clients`.  A `server_t` needs to read `clients` when:
     // * `send_all` is called
@@ -72,13 +72,23 @@ rdb_context_t::stats_t::stats_t(perfmon_collection_t *global_stats)
       queries_per_sec_membership(&qe_stats_collection,
                                  &queries_per_sec, "queries_per_sec"),
       queries_total_membership(&qe_stats_collection,
-                               &queries_total, "queries_total") { }
+                               &queries_total, "queries_total"),
+      query_latency(secs_to_ticks(1)),
+      query_latency_membership(&qe_stats_collection,
+                               &query_latency, "query_latency"),
+      regex_cache_hits_membership(&qe_stats_collection,
+                                  &regex_cache_hits, "regex_cache_hits"),
+      regex_cache_misses_membership(&qe_stats_collection,
+                                    &regex_cache_misses, "regex_cache_misses") { }
 
 rdb_context_t::rdb_context_t()
     : extproc_pool(nullptr),
       cluster_interface(nullptr),
       manager(nullptr),
       reql_http_proxy(),
+      io_backender(nullptr),
+      slow_query_log_threshold_ms(0),
+      max_concurrent_queries_per_user(0),
       stats(&get_global_perfmon_collection()) { }
 
 rdb_context_t::rdb_context_t(
@@ -90,6 +100,9 @@ rdb_context_t::rdb_context_t(
       cluster_interface(_cluster_interface),
       manager(nullptr),
       reql_http_proxy(),
+      io_backender(nullptr),
+      slow_query_log_threshold_ms(0),
+      max_concurrent_queries_per_user(0),
       stats(&get_global_perfmon_collection()) {
     init_auth_watchables(auth_semilattice_view);
 }
@@ -101,11 +114,19 @@ rdb_context_t::rdb_context_t(
         std::shared_ptr<semilattice_read_view_t<auth_semilattice_metadata_t>>
             auth_semilattice_view,
         perfmon_collection_t *global_stats,
-        const std::string &_reql_http_proxy)
+        const std::string &_reql_http_proxy,
+        io_backender_t *_io_backender,
+        const base_path_t &_base_path,
+        int64_t _slow_query_log_threshold_ms,
+        int64_t _max_concurrent_queries_per_user)
     : extproc_pool(_extproc_pool),
       cluster_interface(_cluster_interface),
       manager(_mailbox_manager),
       reql_http_proxy(_reql_http_proxy),
+      io_backender(_io_backender),
+      base_path(_base_path),
+      slow_query_log_threshold_ms(_slow_query_log_threshold_ms),
+      max_concurrent_queries_per_user(_max_concurrent_queries_per_user),
       stats(global_stats) {
     init_auth_watchables(auth_semilattice_view);
 }
@@ -15,6 +15,7 @@
 #include "containers/optional.hpp"
 #include "containers/scoped.hpp"
 #include "containers/uuid.hpp"
+#include "paths.hpp"
 #include "perfmon/perfmon.hpp"
 #include "protocol_api.hpp"
 #include "rdb_protocol/changefeed.hpp"
@@ -45,6 +46,7 @@ ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(
 class auth_semilattice_metadata_t;
 class ellipsoid_spec_t;
 class extproc_pool_t;
+class io_backender_t;
 class name_string_t;
 class namespace_interface_t;
 template <class> class cross_thread_watchable_variable_t;
@@ -468,7 +470,11 @@ public:
         std::shared_ptr<semilattice_read_view_t<auth_semilattice_metadata_t>>
             auth_semilattice_view,
         perfmon_collection_t *global_stats,
-        const std::string &_reql_http_proxy);
+        const std::string &_reql_http_proxy,
+        io_backender_t *_io_backender,
+        const base_path_t &_base_path,
+        int64_t _slow_query_log_threshold_ms,
+        int64_t _max_concurrent_queries_per_user);
 
     ~rdb_context_t();
 
@@ -479,6 +485,20 @@ public:
 
     const std::string reql_http_proxy;
 
+    // Used for spilling query results that don't fit into memory to disk.  These
+    // are only set on servers; proxies don't have a data directory, and neither
+    // do unit tests.
+    io_backender_t *io_backender;
+    const base_path_t base_path;
+
+    // Queries that keep the server busy for longer than this are written to the log,
+    // see `query_cache_t`.  Zero disables the slow query log.
+    const int64_t slow_query_log_threshold_ms;
+
+    // How many queries each user other than "admin" may start at once on this
+    // server, see `query_server_t`.  Zero means there is no limit.
+    const int64_t max_concurrent_queries_per_user;
+
     class stats_t {
     public:
         explicit stats_t(perfmon_collection_t *global_stats);
@@ -493,6 +513,12 @@ public:
         perfmon_membership_t queries_per_sec_membership;
         perfmon_counter_t queries_total;
         perfmon_membership_t queries_total_membership;
+        perfmon_histogram_t query_latency;
+        perfmon_membership_t query_latency_membership;
+        perfmon_counter_t regex_cache_hits;
+        perfmon_membership_t regex_cache_hits_membership;
+        perfmon_counter_t regex_cache_misses;
+        perfmon_membership_t regex_cache_misses_membership;
     private:
         DISABLE_COPYING(stats_t);
     } stats;
@@ -5,11 +5,13 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
 #include <cmath>
 #include <functional>
 #include <iterator>
+#include <stdexcept>
 
 #include "errors.hpp"
 #include <boost/detail/endian.hpp>
@@ -476,8 +478,8 @@ datum_t to_datum(const rapidjson::Value &json, const configured_limits_t &limits
                  ++it) {
                 fail_if_invalid(it->name.GetString(),
                                 it->name.GetStringLength());
-                datum_string_t key(it->name.GetStringLength(),
-                                   it->name.GetString());
+                datum_string_t key = datum_string_t::intern(
+                    it->name.GetStringLength(), it->name.GetString());
                 bool dup = builder.add(key, to_datum(it->value, limits, reql_version));
                 rcheck_datum(!dup, base_exc_t::LOGIC,
                              strprintf("Duplicate key %s in JSON.",
@@ -1486,24 +1488,61 @@ std::pair<datum_string_t, datum_t> datum_t::unchecked_get_pair(size_t index) con
     }
 }
 
+datum_string_t datum_t::get_key(size_t index) const {
+    // Calling `obj_size()` here also makes sure this this is actually an R_OBJECT.
+    guarantee(index < obj_size());
+    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT) {
+        const size_t offset = datum_get_element_offset(data.buf_ref, index);
+        return datum_deserialize_key_from_buf(data.buf_ref, offset);
+    } else {
+        r_sanity_check(data.get_internal_type() == internal_type_t::R_OBJECT);
+        return (*data.r_object)[index].first;
+    }
+}
+
 datum_t datum_t::get_field(const datum_string_t &key, throw_bool_t throw_bool) const {
-    // Use binary search on top of unchecked_get_pair()
+    // Use binary search over the (sorted) keys
     size_t range_beg = 0;
     // The obj_size() also makes sure that this has the right type (R_OBJECT)
     size_t range_end = obj_size();
-    while (range_beg < range_end) {
-        const size_t center = range_beg + ((range_end - range_beg) / 2);
-        auto center_pair = unchecked_get_pair(center);
-        const int cmp_res = key.compare(center_pair.first);
-        if (cmp_res == 0) {
-            // Found it
-            return center_pair.second;
-        } else if (cmp_res < 0) {
-            range_end = center;
-        } else {
-            range_beg = center + 1;
+    if (data.get_internal_type() == internal_type_t::BUF_R_OBJECT) {
+        // Only parse the offset table once, and only deserialize the value of the
+        // pair that we're looking for.
+        const datum_array_header_t header = datum_get_array_header(data.buf_ref);
+        while (range_beg < range_end) {
+            const size_t center = range_beg + ((range_end - range_beg) / 2);
+            const size_t offset =
+                datum_get_element_offset(data.buf_ref, header, center);
+            const datum_string_t center_key =
+                datum_deserialize_key_from_buf(data.buf_ref, offset);
+            const int cmp_res = key.compare(center_key);
+            if (cmp_res == 0) {
+                // Found it
+                return datum_deserialize_from_buf(
+                    data.buf_ref, offset + datum_serialized_size(center_key));
+            } else if (cmp_res < 0) {
+                range_end = center;
+            } else {
+                range_beg = center + 1;
+            }
+            rassert(range_beg <= range_end);
+        }
+    } else {
+        r_sanity_check(data.get_internal_type() == internal_type_t::R_OBJECT);
+        const auto &pairs = *data.r_object;
+        while (range_beg < range_end) {
+            const size_t center = range_beg + ((range_end - range_beg) / 2);
+            const int cmp_res = key.compare(pairs[center].first);
+            if (cmp_res == 0) {
+                // Found it
+                return pairs[center].second;
+            } else if (cmp_res < 0) {
+                range_end = center;
+            } else {
+                range_beg = center + 1;
+            }
+            rassert(range_beg <= range_end);
         }
-        rassert(range_beg <= range_end);
     }
 
     // Didn't find it
@@ -1771,6 +1810,16 @@ int derived_cmp(T a, T b) {
 }
 
 int datum_t::cmp_unchecked_stack(const datum_t &rhs) const {
+    // Two views of the same serialized array or object are equal, and we can tell
+    // without decoding either of them.  This happens a lot when comparing a stored
+    // document against an unmodified copy of itself.
+    if (data.get_internal_type() == rhs.data.get_internal_type()
+        && (data.get_internal_type() == internal_type_t::BUF_R_ARRAY
+            || data.get_internal_type() == internal_type_t::BUF_R_OBJECT)
+        && data.buf_ref.get() == rhs.data.buf_ref.get()) {
+        return 0;
+    }
+
     bool lhs_ptype = is_ptype() && !pseudo_compares_as_obj();
     bool rhs_ptype = rhs.is_ptype() && !rhs.pseudo_compares_as_obj();
     if (lhs_ptype && rhs_ptype) {
@@ -1840,6 +1889,78 @@ int datum_t::cmp(const datum_t &rhs) const {
         });
 }
 
+// FNV-1a, folded into a running hash.
+static size_t hash_bytes(size_t h, const char *data, size_t size) {
+    uint64_t acc = 14695981039346656037ULL ^ h;
+    for (size_t i = 0; i < size; ++i) {
+        acc ^= static_cast<uint8_t>(data[i]);
+        acc *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(acc);
+}
+
+static size_t hash_combine(size_t h, size_t v) {
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+static size_t hash_num(double d) {
+    // `cmp` considers 0.0 and -0.0 equal.
+    if (d == 0.0) {
+        d = 0.0;
+    }
+    return hash_bytes(datum_t::R_NUM, reinterpret_cast<const char *>(&d), sizeof(d));
+}
+
+size_t datum_t::hash_unchecked_stack() const {
+    // This has to mirror the equivalence classes of `cmp_unchecked_stack`.
+    if (is_ptype() && !pseudo_compares_as_obj()) {
+        if (get_type() == R_BINARY) {
+            const datum_string_t &data = as_binary();
+            return hash_bytes(R_BINARY, data.data(), data.size());
+        } else if (get_reql_type() == pseudo::time_string) {
+            // Times compare by their epoch time alone.
+            return hash_combine(R_OBJECT, hash_num(pseudo::time_to_epoch_time(*this)));
+        }
+        return hash_bytes(R_OBJECT, nullptr, 0);
+    }
+
+    switch (get_type()) {
+    case R_NULL: // fallthru
+    case MINVAL: // fallthru
+    case MAXVAL: return get_type();
+    case R_BOOL: return hash_combine(R_BOOL, as_bool());
+    case R_NUM: return hash_num(as_num());
+    case R_STR: return hash_bytes(R_STR, as_str().data(), as_str().size());
+    case R_ARRAY: {
+        size_t h = R_ARRAY;
+        const size_t sz = arr_size();
+        for (size_t i = 0; i < sz; ++i) {
+            h = hash_combine(h, unchecked_get(i).hash());
+        }
+        return h;
+    } unreachable();
+    case R_OBJECT: {
+        size_t h = R_OBJECT;
+        const size_t sz = obj_size();
+        for (size_t i = 0; i < sz; ++i) {
+            auto pair = unchecked_get_pair(i);
+            h = hash_bytes(h, pair.first.data(), pair.first.size());
+            h = hash_combine(h, pair.second.hash());
+        }
+        return h;
+    } unreachable();
+    case R_BINARY: // This should be handled by the ptype code above
+    case UNINITIALIZED: // fallthru
+    default: unreachable();
+    }
+}
+
+size_t datum_t::hash() const {
+    return call_with_enough_stack_datum<size_t>([&] {
+            return this->hash_unchecked_stack();
+        });
+}
+
 bool datum_t::operator==(const datum_t &rhs) const { return cmp(rhs) == 0; }
 bool datum_t::operator!=(const datum_t &rhs) const { return cmp(rhs) != 0; }
 bool datum_t::operator<(const datum_t &rhs) const { return cmp(rhs) < 0; }
@@ -2044,37 +2165,71 @@ datum_t stats_merge(UNUSED const datum_string_t &key,
 }
 
 datum_object_builder_t::datum_object_builder_t(const datum_t &copy_from) {
+    // Objects keep their fields sorted by key, so we can just append them.
     const size_t copy_from_sz = copy_from.obj_size();
+    fields.reserve(copy_from_sz);
     for (size_t i = 0; i < copy_from_sz; ++i) {
-        map.insert(copy_from.get_pair(i));
+        fields.push_back(copy_from.get_pair(i));
     }
 }
 
+datum_object_builder_t::fields_t::iterator
+datum_object_builder_t::lower_bound(const datum_string_t &key) {
+    return std::lower_bound(
+        fields.begin(), fields.end(), key,
+        [](const std::pair<datum_string_t, datum_t> &field,
+           const datum_string_t &k) {
+            return field.first < k;
+        });
+}
+
+datum_object_builder_t::fields_t::const_iterator
+datum_object_builder_t::lower_bound(const datum_string_t &key) const {
+    return std::lower_bound(
+        fields.begin(), fields.end(), key,
+        [](const std::pair<datum_string_t, datum_t> &field,
+           const datum_string_t &k) {
+            return field.first < k;
+        });
+}
+
+datum_t *datum_object_builder_t::get_or_insert(const datum_string_t &key) {
+    auto it = lower_bound(key);
+    if (it == fields.end() || it->first != key) {
+        it = fields.insert(it, std::make_pair(key, datum_t()));
+    }
+    return &it->second;
+}
+
 bool datum_object_builder_t::add(const datum_string_t &key, datum_t val) {
     r_sanity_check(val.has());
-    auto res = map.insert(std::make_pair(key, std::move(val)));
-    // Return _false_ if the insertion actually happened.  Because we are being
-    // backwards to the C++ convention.
-    return !res.second;
+    auto it = lower_bound(key);
+    if (it != fields.end() && it->first == key) {
+        // Return _true_ if the insertion did not happen.  Because we are being
+        // backwards to the C++ convention.
+        return true;
+    }
+    fields.insert(it, std::make_pair(key, std::move(val)));
+    return false;
 }
 
 bool datum_object_builder_t::add(const char *key, datum_t val) {
-    return add(datum_string_t(key), val);
+    return add(datum_string_t::intern(strlen(key), key), val);
 }
 
 void datum_object_builder_t::overwrite(const datum_string_t &key,
                                        datum_t val) {
     r_sanity_check(val.has());
-    map[key] = std::move(val);
+    *get_or_insert(key) = std::move(val);
 }
 
 void datum_object_builder_t::overwrite(const char *key,
                                        datum_t val) {
-    return overwrite(datum_string_t(key), val);
+    return overwrite(datum_string_t::intern(strlen(key), key), val);
 }
 
 void datum_object_builder_t::add_warning(const char *msg, const configured_limits_t &limits) {
-    datum_t *warnings_entry = &map[warnings_field];
+    datum_t *warnings_entry = get_or_insert(warnings_field);
     if (warnings_entry->has()) {
         // assume here that the warnings array will "always" be small.
         const size_t warnings_entry_sz = warnings_entry->arr_size();
@@ -2098,7 +2253,7 @@ void datum_object_builder_t::add_warning(const char *msg, const configured_limit
 
 void datum_object_builder_t::add_warnings(const std::set<std::string> &msgs, const configured_limits_t &limits) {
     if (msgs.empty()) return;
-    datum_t *warnings_entry = &map[warnings_field];
+    datum_t *warnings_entry = get_or_insert(warnings_field);
     if (warnings_entry->has()) {
         rcheck_datum(
             warnings_entry->arr_size() + msgs.size() <= limits.array_size_limit(),
@@ -2132,17 +2287,22 @@ void datum_object_builder_t::add_warnings(const std::set<std::string> &msgs, con
 void datum_object_builder_t::add_error(const char *msg) {
     // Insert or update the "errors" entry.
     {
-        datum_t *errors_entry = &map[errors_field];
+        datum_t *errors_entry = get_or_insert(errors_field);
         double ecount = (errors_entry->has() ? (*errors_entry).as_num() : 0) + 1;
         *errors_entry = datum_t(ecount);
     }
 
     // If first_error already exists, nothing gets inserted.
-    map.insert(std::make_pair(first_error_field, datum_t(msg)));
+    UNUSED bool dup = add(first_error_field, datum_t(msg));
 }
 
 MUST_USE bool datum_object_builder_t::delete_field(const datum_string_t &key) {
-    return 0 != map.erase(key);
+    auto it = lower_bound(key);
+    if (it == fields.end() || it->first != key) {
+        return false;
+    }
+    fields.erase(it);
+    return true;
 }
 
 MUST_USE bool datum_object_builder_t::delete_field(const char *key) {
@@ -2151,21 +2311,25 @@ MUST_USE bool datum_object_builder_t::delete_field(const char *key) {
 
 
 datum_t datum_object_builder_t::at(const datum_string_t &key) const {
-    return map.at(key);
+    auto it = lower_bound(key);
+    if (it == fields.end() || it->first != key) {
+        throw std::out_of_range("datum_object_builder_t::at");
+    }
+    return it->second;
 }
 
 datum_t datum_object_builder_t::try_get(const datum_string_t &key) const {
-    auto it = map.find(key);
-    return it == map.end() ? datum_t() : it->second;
+    auto it = lower_bound(key);
+    return it == fields.end() || it->first != key ? datum_t() : it->second;
 }
 
 datum_t datum_object_builder_t::to_datum() RVALUE_THIS {
-    return datum_t(std::move(map));
+    return datum_t(std::move(fields));
 }
 
 datum_t datum_object_builder_t::to_datum(
         const std::set<std::string> &permissible_ptypes) RVALUE_THIS {
-    return datum_t(std::move(map), permissible_ptypes);
+    return datum_t(std::move(fields), permissible_ptypes);
 }
 
 datum_array_builder_t::datum_array_builder_t(const datum_t &copy_from,
@@ -280,6 +280,8 @@ public:
     // get_pair does not perform boundary checking. Its primary use is for
     // iterating over the object in combination with num_pairs().
     std::pair<datum_string_t, datum_t> get_pair(size_t index) const;
+    // Like `get_pair(index).first`, but doesn't deserialize the value.
+    datum_string_t get_key(size_t index) const;
     datum_t get_field(const datum_string_t &key,
                       throw_bool_t throw_bool = THROW) const;
     datum_t get_field(const char *key,
@@ -327,6 +329,10 @@ public:
     bool operator>(const datum_t &rhs) const;
     bool operator>=(const datum_t &rhs) const;
 
+    // A hash that is consistent with operator==, i.e. data that compare equal
+    // hash to the same value.  Used for hash-based grouping.
+    size_t hash() const;
+
     NORETURN void runtime_fail(base_exc_t::type_t exc_type,
                                const char *test, const char *file, int line,
                                std::string msg) const;
@@ -400,6 +406,7 @@ private:
         std::string *str_out) const;
 
     int cmp_unchecked_stack(const datum_t &rhs) const;
+    size_t hash_unchecked_stack() const;
 
     int pseudo_cmp(const datum_t &rhs) const;
     bool pseudo_compares_as_obj() const;
@@ -489,7 +496,7 @@ public:
     explicit datum_object_builder_t(const datum_t &copy_from);
 
     bool empty() const {
-        return map.empty();
+        return fields.empty();
     }
 
     // Returns true if the insertion did _not_ happen because the key was already in
@@ -518,7 +525,17 @@ public:
             const std::set<std::string> &permissible_ptypes) RVALUE_THIS;
 
 private:
-    std::map<datum_string_t, datum_t> map;
+    typedef std::vector<std::pair<datum_string_t, datum_t> > fields_t;
+
+    // Returns the position of `key`, or where it would have to be inserted.
+    fields_t::iterator lower_bound(const datum_string_t &key);
+    fields_t::const_iterator lower_bound(const datum_string_t &key) const;
+    // Returns the value for `key`, inserting an empty datum if there is none.
+    datum_t *get_or_insert(const datum_string_t &key);
+
+    // Sorted by key, which is the layout that `datum_t` uses for objects, so
+    // `to_datum` can hand the vector over as it is.
+    fields_t fields;
     DISABLE_COPYING(datum_object_builder_t);
 };
 
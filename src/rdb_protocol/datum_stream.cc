@@ -1,12 +1,17 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/datum_stream.hpp"
 
+#include <iterator>
 #include <map>
 
+#include "containers/loser_tree.hpp"
 #include "rdb_protocol/batching.hpp"
 #include "rdb_protocol/datum_stream/array.hpp"
 #include "rdb_protocol/datum_stream/eq_join.hpp"
+#include "rdb_protocol/datum_stream/external_sort.hpp"
 #include "rdb_protocol/datum_stream/fold.hpp"
+#include "rdb_protocol/datum_stream/grouped_changes.hpp"
+#include "rdb_protocol/datum_stream/hash_join.hpp"
 #include "rdb_protocol/datum_stream/indexed_sort.hpp"
 #include "rdb_protocol/datum_stream/lazy.hpp"
 #include "rdb_protocol/datum_stream/map.hpp"
@@ -17,6 +22,7 @@
 #include "rdb_protocol/datum_stream/readers.hpp"
 #include "rdb_protocol/datum_stream/readgens.hpp"
 #include "rdb_protocol/datum_stream/slice.hpp"
+#include "rdb_protocol/datum_stream/sort.hpp"
 #include "rdb_protocol/datum_stream/union.hpp"
 #include "rdb_protocol/datum_stream/vector.hpp"
 #include "rdb_protocol/env.hpp"
@@ -460,27 +466,33 @@ raw_stream_t rget_response_reader_t::unshard(
 
     // Do the unsharding.
     if (sorting != sorting_t::UNORDERED) {
+        // Only the shard we pop from changes its best key, so we keep the keys in
+        // a loser tree and replay a single path per item instead of rescanning
+        // every pseudoshard.  Ties go to the lower index, as in a linear scan.
+        std::vector<const store_key_t *> best_keys;
+        best_keys.reserve(pseudoshards.size());
+        for (const auto &ps : pseudoshards) {
+            best_keys.push_back(ps.best_unpopped_key());
+        }
+        auto beats = [&](size_t a, size_t b) {
+            return is_better(*best_keys[a], *best_keys[b], sorting)
+                || (a < b && !is_better(*best_keys[b], *best_keys[a], sorting));
+        };
+        loser_tree_t<decltype(beats)> tree(pseudoshards.size(), beats);
         size_t num_iters = 0;
         for (;;) {
             const size_t YIELD_INTERVAL = 2000;
             if (++num_iters % YIELD_INTERVAL == 0) {
                 coro_t::yield();
             }
-            pseudoshard_t *best_shard = &pseudoshards[0];
-            const store_key_t *best_key = best_shard->best_unpopped_key();
-            for (size_t i = 1; i < pseudoshards.size(); ++i) {
-                pseudoshard_t *cur_shard = &pseudoshards[i];
-                const store_key_t *cur_key = cur_shard->best_unpopped_key();
-                if (is_better(*cur_key, *best_key, sorting)) {
-                    best_shard = cur_shard;
-                    best_key = cur_key;
-                }
-            }
-            if (auto maybe_item = best_shard->pop()) {
+            size_t best = tree.winner();
+            if (auto maybe_item = pseudoshards[best].pop()) {
                 ret.push_back(*maybe_item);
             } else {
                 break;
             }
+            best_keys[best] = pseudoshards[best].best_unpopped_key();
+            tree.replay_winner();
         }
     } else {
         std::vector<size_t> active;
@@ -1585,10 +1597,7 @@ bool array_datum_stream_t::is_array() const {
 // INDEXED_SORT_DATUM_STREAM_T
 indexed_sort_datum_stream_t::indexed_sort_datum_stream_t(
     counted_t<datum_stream_t> stream,
-    std::function<bool(env_t *,  // NOLINT(readability/casting)
-                       profile::sampler_t *,
-                       const datum_t &,
-                       const datum_t &)> _lt_cmp)
+    const lt_cmp_t &_lt_cmp)
     : wrapper_datum_stream_t(stream), lt_cmp(_lt_cmp), index(0) { }
 
 std::vector<datum_t>
@@ -1611,8 +1620,7 @@ indexed_sort_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batch
             if (index >= data.size()) {
                 return ret;
             }
-            std::stable_sort(data.begin(), data.end(),
-                             std::bind(lt_cmp, env, &sampler, ph::_1, ph::_2));
+            lt_cmp.sort(env, &sampler, &data);
         }
         for (; index < data.size() && !batcher.should_send_batch(); ++index) {
             batcher.note_el(data[index]);
@@ -1622,6 +1630,267 @@ indexed_sort_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batch
     return ret;
 }
 
+// EXTERNAL_SORT_DATUM_STREAM_T
+external_sort_datum_stream_t::external_sort_datum_stream_t(
+    backtrace_id_t _bt,
+    const lt_cmp_t &_lt_cmp)
+    : eager_datum_stream_t(_bt), lt_cmp(_lt_cmp), started(false) { }
+
+bool external_sort_datum_stream_t::can_spill(env_t *env) {
+    return env->get_rdb_ctx() != nullptr
+        && env->get_rdb_ctx()->io_backender != nullptr;
+}
+
+void external_sort_datum_stream_t::add_run(env_t *env, std::vector<datum_t> &&rows) {
+    guarantee(!started);
+    rdb_context_t *ctx = env->get_rdb_ctx();
+    r_sanity_check(can_spill(env));
+
+    {
+        profile::sampler_t sampler("Sorting in-memory.", env->trace);
+        lt_cmp.sort(env, &sampler, &rows);
+    }
+
+    profile::sampler_t sampler("Writing sorted rows to disk.", env->trace);
+    scoped_ptr_t<run_t> run(new run_t());
+    run->queue.init(new disk_backed_queue_t<datum_t>(
+        ctx->io_backender,
+        serializer_filepath_t(ctx->base_path,
+                              "sort_" + uuid_to_str(generate_uuid())),
+        &perfmon_collection));
+    // Writing rows in chunks saves a transaction per row, without keeping a
+    // serialized copy of the whole run in memory.
+    const size_t ROWS_PER_WRITE = 1000;
+    std::vector<datum_t> chunk;
+    for (size_t i = 0; i < rows.size(); i += ROWS_PER_WRITE) {
+        const size_t end = std::min(rows.size(), i + ROWS_PER_WRITE);
+        chunk.assign(std::make_move_iterator(rows.begin() + i),
+                     std::make_move_iterator(rows.begin() + end));
+        run->queue->push(chunk);
+        sampler.new_sample();
+    }
+    rows.clear();
+    runs.push_back(std::move(run));
+}
+
+void external_sort_datum_stream_t::advance(env_t *env, run_t *run) {
+    if (run->queue.has() && !run->queue->empty()) {
+        run->queue->pop(&run->head);
+        run->head_key = lt_cmp.sort_key(env, run->head);
+    } else {
+        run->head.reset();
+        run->head_key.clear();
+        // Deletes the run's file as soon as we no longer need it.
+        run->queue.reset();
+    }
+}
+
+std::vector<datum_t>
+external_sort_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
+    if (!started) {
+        for (auto &&run : runs) {
+            advance(env, run.get());
+        }
+        started = true;
+    }
+
+    std::vector<datum_t> ret;
+    batcher_t batcher = batchspec.to_batcher();
+    profile::sampler_t sampler("Merging sorted runs.", env->trace);
+    while (!batcher.should_send_batch()) {
+        // There are only a few runs of `array_limit` rows each, so a linear
+        // scan over their heads is cheaper than maintaining a heap.  Ties go
+        // to the earlier run, which keeps the sort stable.
+        run_t *min_run = nullptr;
+        for (auto &&run : runs) {
+            if (run->head.has()
+                && (min_run == nullptr
+                    || lt_cmp.keys_lt(run->head_key, min_run->head_key))) {
+                min_run = run.get();
+            }
+        }
+        if (min_run == nullptr) {
+            break;
+        }
+        batcher.note_el(min_run->head);
+        ret.push_back(std::move(min_run->head));
+        advance(env, min_run);
+        sampler.new_sample();
+    }
+    return ret;
+}
+
+bool external_sort_datum_stream_t::is_exhausted() const {
+    if (!started) {
+        return runs.empty();
+    }
+    for (auto &&run : runs) {
+        if (run->head.has()) {
+            return false;
+        }
+    }
+    return true;
+}
+feed_type_t external_sort_datum_stream_t::cfeed_type() const {
+    return feed_type_t::not_feed;
+}
+bool external_sort_datum_stream_t::is_array() const {
+    return false;
+}
+bool external_sort_datum_stream_t::is_infinite() const {
+    return false;
+}
+
+// SORT_DATUM_STREAM_T
+sort_datum_stream_t::sort_datum_stream_t(
+    backtrace_id_t _bt,
+    counted_t<datum_stream_t> _source,
+    const lt_cmp_t &_lt_cmp)
+    : eager_datum_stream_t(_bt),
+      source(_source),
+      lt_cmp(_lt_cmp),
+      sorted(false),
+      index(0) { }
+
+counted_t<datum_stream_t> sort_datum_stream_t::slice(size_t l, size_t r) {
+    // Rows past `r` can never be returned, unless a transformation that was
+    // added after the sort changes which rows end up at which position.
+    if (!sorted && !ops_to_do()) {
+        bound.set(bound.has_value() ? std::min(*bound, r) : r);
+    }
+    return datum_stream_t::slice(l, r);
+}
+
+void sort_datum_stream_t::sort(env_t *env) {
+    const size_t array_limit = env->limits().array_size_limit();
+    if (bound.has_value() && *bound <= array_limit) {
+        sort_bounded(env, *bound);
+        return;
+    }
+
+    // Only set once `rows` has outgrown the array size limit, in which case we
+    // sort it in runs that get spilled to disk.
+    counted_t<external_sort_datum_stream_t> external_sort;
+    const bool can_spill = external_sort_datum_stream_t::can_spill(env);
+    batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env);
+    for (;;) {
+        std::vector<datum_t> data = source->next_batch(env, batchspec);
+        if (data.size() == 0) {
+            break;
+        }
+        std::move(data.begin(), data.end(), std::back_inserter(rows));
+        if (can_spill && rows.size() > array_limit) {
+            if (!external_sort.has()) {
+                external_sort = make_counted<external_sort_datum_stream_t>(
+                    backtrace(), lt_cmp);
+            }
+            external_sort->add_run(env, std::move(rows));
+            rows.clear();
+        }
+        rcheck_array_size(rows, env->limits());
+    }
+    if (external_sort.has()) {
+        if (!rows.empty()) {
+            external_sort->add_run(env, std::move(rows));
+            rows.clear();
+        }
+        spilled = external_sort;
+    } else {
+        profile::sampler_t sampler("Sorting in-memory.", env->trace);
+        lt_cmp.sort(env, &sampler, &rows);
+    }
+}
+
+void sort_datum_stream_t::sort_bounded(env_t *env, size_t limit) {
+    if (limit == 0) {
+        return;
+    }
+    profile::sampler_t sampler("Selecting the smallest rows.", env->trace);
+    // Rows are tagged with their sort key, so that we only evaluate the order
+    // functions once per row, and with their position in `source` so that ties
+    // come out in their original order, like they do from `std::stable_sort`.
+    struct tagged_row_t {
+        std::vector<datum_t> key;
+        datum_t row;
+        uint64_t position;
+    };
+    auto cmp = [&](const tagged_row_t &l, const tagged_row_t &r) {
+        sampler.new_sample();
+        if (lt_cmp.keys_lt(l.key, r.key)) {
+            return true;
+        }
+        return !lt_cmp.keys_lt(r.key, l.key) && l.position < r.position;
+    };
+    // A max-heap of the `limit` smallest rows seen so far.
+    std::vector<tagged_row_t> heap;
+    uint64_t position = 0;
+    batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env);
+    for (;;) {
+        std::vector<datum_t> data = source->next_batch(env, batchspec);
+        if (data.size() == 0) {
+            break;
+        }
+        for (auto &&row : data) {
+            tagged_row_t tagged_row{
+                lt_cmp.sort_key(env, row), std::move(row), position};
+            ++position;
+            if (heap.size() < limit) {
+                heap.push_back(std::move(tagged_row));
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            } else if (lt_cmp.keys_lt(tagged_row.key, heap.front().key)) {
+                // `row` comes after everything in the heap, so it only replaces
+                // the largest row if it's strictly smaller.
+                std::pop_heap(heap.begin(), heap.end(), cmp);
+                heap.back() = std::move(tagged_row);
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), cmp);
+    rows.reserve(heap.size());
+    for (auto &&tagged_row : heap) {
+        rows.push_back(std::move(tagged_row.row));
+    }
+}
+
+std::vector<datum_t>
+sort_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
+    if (!sorted) {
+        sort(env);
+        sorted = true;
+    }
+    if (spilled.has()) {
+        return spilled->next_batch(env, batchspec);
+    }
+
+    std::vector<datum_t> ret;
+    batcher_t batcher = batchspec.to_batcher();
+    for (; index < rows.size() && !batcher.should_send_batch(); ++index) {
+        batcher.note_el(rows[index]);
+        ret.push_back(std::move(rows[index]));
+    }
+    return ret;
+}
+
+bool sort_datum_stream_t::is_exhausted() const {
+    if (!sorted) {
+        return source->is_exhausted() && batch_cache_exhausted();
+    }
+    if (spilled.has()) {
+        return spilled->is_exhausted() && batch_cache_exhausted();
+    }
+    return index >= rows.size() && batch_cache_exhausted();
+}
+feed_type_t sort_datum_stream_t::cfeed_type() const {
+    return feed_type_t::not_feed;
+}
+bool sort_datum_stream_t::is_array() const {
+    return source->is_array();
+}
+bool sort_datum_stream_t::is_infinite() const {
+    return false;
+}
+
 // ORDERED_DISTINCT_DATUM_STREAM_T
 ordered_distinct_datum_stream_t::ordered_distinct_datum_stream_t(
     counted_t<datum_stream_t> _source) : wrapper_datum_stream_t(_source) { }
@@ -2408,6 +2677,198 @@ bool eq_join_datum_stream_t::is_exhausted() const {
     return false;
 }
 
+hash_join_datum_stream_t::hash_join_datum_stream_t(
+        counted_t<datum_stream_t> _stream,
+        hash_table_t &&_right,
+        counted_t<const func_t> _left_key)
+    : wrapper_datum_stream_t(std::move(_stream)),
+      right(std::move(_right)),
+      left_key(std::move(_left_key)) { }
+
+std::vector<datum_t>
+hash_join_datum_stream_t::next_raw_batch(env_t *env, const batchspec_t &batchspec) {
+    const datum_string_t left_str("left");
+    const datum_string_t right_str("right");
+    std::vector<datum_t> res;
+    batcher_t batcher = batchspec.to_batcher();
+    profile::sampler_t sampler("Probing hash join.", env->trace);
+    // We always finish the left hand batch that we've read, so the result might
+    // be somewhat larger than `batchspec` asks for.
+    while (!batcher.should_send_batch()) {
+        std::vector<datum_t> left_batch = source->next_batch(env, batchspec);
+        if (left_batch.empty()) {
+            break;
+        }
+        if (right.empty()) {
+            // The join function never gets called, so neither does `left_key`.
+            continue;
+        }
+        for (auto &&row : left_batch) {
+            sampler.new_sample();
+            datum_t key = left_key->call(env, row)->as_datum();
+            auto it = right.find(key);
+            if (it == right.end()) {
+                continue;
+            }
+            for (const datum_t &match : it->second) {
+                datum_object_builder_t res_item;
+                bool conflict = false;
+                conflict |= res_item.add(left_str, row);
+                conflict |= res_item.add(right_str, match);
+                guarantee(!conflict);
+                datum_t res_datum = std::move(res_item).to_datum();
+                batcher.note_el(res_datum);
+                res.push_back(std::move(res_datum));
+            }
+        }
+    }
+    return res;
+}
+
+grouped_changes_datum_stream_t::grouped_changes_datum_stream_t(
+        counted_t<datum_stream_t> _feed,
+        std::vector<datum_string_t> &&_fields,
+        optional<datum_string_t> &&_sum_field,
+        bool _include_initial,
+        bool _include_states)
+    : wrapper_datum_stream_t(std::move(_feed)),
+      fields(std::move(_fields)),
+      sum_field(std::move(_sum_field)),
+      include_initial(_include_initial),
+      include_states(_include_states),
+      ready(false) {
+    r_sanity_check(fields.size() >= 1);
+}
+
+datum_t grouped_changes_datum_stream_t::group_of(const datum_t &row) const {
+    // Like `group`, rows that don't have a field end up in the `null` group.
+    if (fields.size() == 1) {
+        datum_t val = row.get_field(fields[0], NOTHROW);
+        return val.has() ? val : datum_t::null();
+    }
+    std::vector<datum_t> vals;
+    vals.reserve(fields.size());
+    for (const datum_string_t &field : fields) {
+        datum_t val = row.get_field(field, NOTHROW);
+        vals.push_back(val.has() ? val : datum_t::null());
+    }
+    return datum_t(std::move(vals), datum_t::no_array_size_limit_check_t());
+}
+
+datum_t grouped_changes_datum_stream_t::value_of(const total_t &total) const {
+    if (total.rows == 0) {
+        return datum_t::null();
+    }
+    return sum_field.has_value()
+        ? datum_t(total.sum)
+        : datum_t(static_cast<double>(total.rows));
+}
+
+void grouped_changes_datum_stream_t::apply(
+        const datum_t &row, int sign, totals_t *touched) {
+    if (!row.has() || row.get_type() == datum_t::R_NULL) {
+        return;
+    }
+    datum_t group = group_of(row);
+    auto it = totals.find(group);
+    if (touched->count(group) == 0) {
+        (*touched)[group] = it == totals.end() ? total_t() : it->second;
+    }
+    double delta = 0;
+    if (sum_field.has_value()) {
+        datum_t val = row.get_field(*sum_field, NOTHROW);
+        if (val.has()) {
+            delta = val.as_num();
+        }
+    }
+    if (sign > 0) {
+        total_t *total = &totals[group];
+        total->rows += 1;
+        total->sum += delta;
+    } else {
+        r_sanity_check(it != totals.end() && it->second.rows != 0);
+        it->second.rows -= 1;
+        it->second.sum -= delta;
+        if (it->second.rows == 0) {
+            totals.erase(it);
+        }
+    }
+}
+
+std::vector<datum_t>
+grouped_changes_datum_stream_t::next_raw_batch(
+        env_t *env, const batchspec_t &batchspec) {
+    const datum_string_t state_str("state");
+    const datum_string_t old_val_str("old_val");
+    const datum_string_t new_val_str("new_val");
+    const datum_string_t group_str("group");
+    std::vector<datum_t> res;
+    profile::sampler_t sampler("Updating grouped changefeed totals.", env->trace);
+
+    // We only read one batch from the feed, so that we pass on the feed's
+    // latency instead of waiting for more changes.
+    std::vector<datum_t> changes = source->next_batch(env, batchspec);
+    totals_t touched;
+    bool became_ready = false;
+    for (const datum_t &change : changes) {
+        sampler.new_sample();
+        datum_t state = change.get_field(state_str, NOTHROW);
+        if (state.has()) {
+            if (state.get_type() == datum_t::R_STR
+                && state.as_str() == datum_string_t("ready")) {
+                became_ready = true;
+            }
+            if (include_states) {
+                res.push_back(change);
+            }
+            continue;
+        }
+        apply(change.get_field(old_val_str, NOTHROW), -1, &touched);
+        apply(change.get_field(new_val_str, NOTHROW), 1, &touched);
+    }
+
+    if (!ready) {
+        if (!became_ready) {
+            return res;
+        }
+        ready = true;
+        if (!include_initial) {
+            return res;
+        }
+        // Hand out the totals we've accumulated so far as the initial values,
+        // before the `ready` state that we may have already pushed.
+        std::vector<datum_t> initial;
+        initial.reserve(totals.size() + res.size());
+        for (auto it = totals.begin(); it != totals.end(); ++it) {
+            datum_object_builder_t item;
+            bool conflict = false;
+            conflict |= item.add(group_str, it->first);
+            conflict |= item.add(new_val_str, value_of(it->second));
+            guarantee(!conflict);
+            initial.push_back(std::move(item).to_datum());
+        }
+        std::move(res.begin(), res.end(), std::back_inserter(initial));
+        return initial;
+    }
+
+    for (auto &&pair : touched) {
+        datum_t old_val = value_of(pair.second);
+        auto it = totals.find(pair.first);
+        datum_t new_val = value_of(it == totals.end() ? total_t() : it->second);
+        if (old_val == new_val) {
+            continue;
+        }
+        datum_object_builder_t item;
+        bool conflict = false;
+        conflict |= item.add(group_str, pair.first);
+        conflict |= item.add(old_val_str, std::move(old_val));
+        conflict |= item.add(new_val_str, std::move(new_val));
+        guarantee(!conflict);
+        res.push_back(std::move(item).to_datum());
+    }
+    return res;
+}
+
 fold_datum_stream_t::fold_datum_stream_t(
     counted_t<datum_stream_t> &&_stream,
     datum_t _base,
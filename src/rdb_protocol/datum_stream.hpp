@@ -77,7 +77,7 @@ public:
     scoped_ptr_t<val_t> to_array(env_t *env);
 
     // stream -> stream (always eager)
-    counted_t<datum_stream_t> slice(size_t l, size_t r);
+    virtual counted_t<datum_stream_t> slice(size_t l, size_t r);
     counted_t<datum_stream_t> offsets_of(counted_t<const func_t> f);
     counted_t<datum_stream_t> ordered_distinct();
 
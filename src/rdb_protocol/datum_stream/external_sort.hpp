@@ -0,0 +1,60 @@
+#ifndef RDB_PROTOCOL_DATUM_STREAM_EXTERNAL_SORT_HPP_
+#define RDB_PROTOCOL_DATUM_STREAM_EXTERNAL_SORT_HPP_
+
+#include <vector>
+
+#include "containers/disk_backed_queue.hpp"
+#include "perfmon/core.hpp"
+#include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/order_util.hpp"
+
+namespace ql {
+
+// Sorts sequences that are too large to be sorted in memory.  Rows are handed
+// over in runs of at most `array_limit` rows; each run gets sorted and written
+// to its own disk backed queue.  Reading from the stream then merges the runs.
+class external_sort_datum_stream_t : public eager_datum_stream_t {
+public:
+    external_sort_datum_stream_t(
+        backtrace_id_t bt,
+        const lt_cmp_t &lt_cmp);
+
+    // Returns false if `env` has no data directory that we could spill to, for
+    // example on proxies.
+    static bool can_spill(env_t *env);
+
+    // Sorts `rows` and writes them to disk as a new run.  All runs have to be
+    // added before reading from the stream.
+    void add_run(env_t *env, std::vector<datum_t> &&rows);
+
+private:
+    class run_t {
+    public:
+        scoped_ptr_t<disk_backed_queue_t<datum_t> > queue;
+        // The smallest row of the run that hasn't been returned yet, or an
+        // empty datum if the run is exhausted.
+        datum_t head;
+        // `lt_cmp`'s sort key for `head`.
+        std::vector<datum_t> head_key;
+    };
+
+    void advance(env_t *env, run_t *run);
+
+    virtual std::vector<datum_t>
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    bool is_exhausted() const;
+    virtual feed_type_t cfeed_type() const;
+    bool is_array() const;
+    bool is_infinite() const;
+
+    const lt_cmp_t lt_cmp;
+    // Keeps the queues' stats out of the global stats.
+    perfmon_collection_t perfmon_collection;
+    std::vector<scoped_ptr_t<run_t> > runs;
+    bool started;
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_DATUM_STREAM_EXTERNAL_SORT_HPP_
@@ -0,0 +1,59 @@
+#ifndef RDB_PROTOCOL_DATUM_STREAM_GROUPED_CHANGES_HPP_
+#define RDB_PROTOCOL_DATUM_STREAM_GROUPED_CHANGES_HPP_
+
+#include <unordered_map>
+#include <vector>
+
+#include "containers/optional.hpp"
+#include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/datum_utils.hpp"
+
+namespace ql {
+
+// Maintains `group(fields...).count()` or `group(fields...).sum(sum_field)` over
+// a changefeed.  `feed` has to be a changefeed that was opened with
+// `include_initial` and `include_states`, so that we can seed the totals from
+// the initial rows.  Every batch we read from `feed` is folded into the totals,
+// and for every group whose total changed we emit
+// `{group: ..., old_val: ..., new_val: ...}`, where a missing group has a value
+// of `null`.
+class grouped_changes_datum_stream_t : public wrapper_datum_stream_t {
+public:
+    grouped_changes_datum_stream_t(counted_t<datum_stream_t> feed,
+                                   std::vector<datum_string_t> &&fields,
+                                   optional<datum_string_t> &&sum_field,
+                                   bool include_initial,
+                                   bool include_states);
+
+private:
+    struct total_t {
+        total_t() : rows(0), sum(0) { }
+        uint64_t rows;
+        double sum;
+    };
+    typedef std::unordered_map<datum_t,
+                               total_t,
+                               optional_datum_hash_t,
+                               optional_datum_equal_t> totals_t;
+
+    virtual std::vector<datum_t>
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    datum_t group_of(const datum_t &row) const;
+    datum_t value_of(const total_t &total) const;
+    // Adds `row` to (or, if `sign` is negative, removes it from) its group's
+    // total.  `touched` remembers the value every group had before the batch.
+    void apply(const datum_t &row, int sign, totals_t *touched);
+
+    const std::vector<datum_string_t> fields;
+    const optional<datum_string_t> sum_field;
+    const bool include_initial;
+    const bool include_states;
+    totals_t totals;
+    // True once the feed told us that all the initial rows have been sent.
+    bool ready;
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_DATUM_STREAM_GROUPED_CHANGES_HPP_
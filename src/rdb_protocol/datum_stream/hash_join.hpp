@@ -0,0 +1,37 @@
+#ifndef RDB_PROTOCOL_DATUM_STREAM_HASH_JOIN_HPP_
+#define RDB_PROTOCOL_DATUM_STREAM_HASH_JOIN_HPP_
+
+#include <unordered_map>
+#include <vector>
+
+#include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/datum_utils.hpp"
+
+namespace ql {
+
+// Joins the rows of `stream` with the rows of a right hand side that has already
+// been read into memory and hashed by its join key.  For every left row we look
+// up `left_key(row)` and emit `{left: row, right: match}` for every match, in the
+// order the matches were added to the table.
+class hash_join_datum_stream_t : public wrapper_datum_stream_t {
+public:
+    typedef std::unordered_map<datum_t,
+                               std::vector<datum_t>,
+                               optional_datum_hash_t,
+                               optional_datum_equal_t> hash_table_t;
+
+    hash_join_datum_stream_t(counted_t<datum_stream_t> stream,
+                             hash_table_t &&right,
+                             counted_t<const func_t> left_key);
+
+private:
+    virtual std::vector<datum_t>
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    const hash_table_t right;
+    const counted_t<const func_t> left_key;
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_DATUM_STREAM_HASH_JOIN_HPP_
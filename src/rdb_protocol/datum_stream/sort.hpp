@@ -0,0 +1,51 @@
+#ifndef RDB_PROTOCOL_DATUM_STREAM_SORT_HPP_
+#define RDB_PROTOCOL_DATUM_STREAM_SORT_HPP_
+
+#include <vector>
+
+#include "containers/optional.hpp"
+#include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/order_util.hpp"
+
+namespace ql {
+
+// Sorts `source` without an index.  The source is only read once the first batch
+// gets requested, so that a `limit` applied directly to the sorted stream can
+// bound the number of rows we keep: with a bound of `k` we only hold on to the
+// `k` smallest rows seen so far instead of the whole sequence.
+class sort_datum_stream_t : public eager_datum_stream_t {
+public:
+    sort_datum_stream_t(
+        backtrace_id_t bt,
+        counted_t<datum_stream_t> source,
+        const lt_cmp_t &lt_cmp);
+
+    virtual counted_t<datum_stream_t> slice(size_t l, size_t r);
+
+private:
+    // Reads all of `source`.  Leaves the result either in `rows` or, if it didn't
+    // fit into the array size limit, in `spilled`.
+    void sort(env_t *env);
+    void sort_bounded(env_t *env, size_t limit);
+
+    virtual std::vector<datum_t>
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    virtual bool is_exhausted() const;
+    virtual feed_type_t cfeed_type() const;
+    virtual bool is_array() const;
+    virtual bool is_infinite() const;
+
+    const counted_t<datum_stream_t> source;
+    const lt_cmp_t lt_cmp;
+    // The number of rows anyone is going to read from this stream, if known.
+    optional<size_t> bound;
+    bool sorted;
+    std::vector<datum_t> rows;
+    size_t index;
+    counted_t<datum_stream_t> spilled;
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_DATUM_STREAM_SORT_HPP_
@@ -13,8 +13,25 @@
 #include "containers/archive/varint.hpp"
 #include "containers/scoped.hpp"
 #include "debug.hpp"
+#include "thread_local.hpp"
 #include "utils.hpp"
 
+namespace {
+
+// Longer strings are unlikely to repeat often enough to be worth it.
+const size_t MAX_INTERNED_SIZE = 32;
+const size_t INTERN_TABLE_SLOTS = 1024;
+
+// A direct mapped cache: a string whose slot is taken simply replaces the
+// previous occupant, so both the memory use and the cost of a lookup are fixed.
+struct intern_table_t {
+    shared_buf_ref_t<char> slots[INTERN_TABLE_SLOTS];
+};
+
+}  // namespace
+
+TLS_with_init(intern_table_t *, intern_table, nullptr);
+
 datum_string_t::datum_string_t() {
     init(0, "");
 }
@@ -37,6 +54,33 @@ datum_string_t::datum_string_t(const std::string &str) {
     init(str.size(), str.data());
 }
 
+datum_string_t datum_string_t::intern(size_t _size, const char *_data) {
+    if (_size > MAX_INTERNED_SIZE) {
+        return datum_string_t(_size, _data);
+    }
+    intern_table_t *table = TLS_get_intern_table();
+    if (table == nullptr) {
+        table = new intern_table_t();
+        TLS_set_intern_table(table);
+    }
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < _size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(_data[i])) * 1099511628211ULL;
+    }
+    shared_buf_ref_t<char> *slot = &table->slots[hash % INTERN_TABLE_SLOTS];
+    if (slot->has()) {
+        datum_string_t existing(*slot);
+        if (existing.compare(_size, _data) == 0) {
+            return existing;
+        }
+    }
+    datum_string_t ret(_size, _data);
+    *slot = ret.data_;
+    return ret;
+}
+
 void datum_string_t::init(size_t _size, const char *_data) {
     const size_t str_offset = varint_uint64_serialized_size(_size);
     counted_t<shared_buf_t> buffer = shared_buf_t::create(str_offset + _size);
@@ -97,6 +141,10 @@ bool datum_string_t::operator!=(const char *other) const {
 }
 
 bool datum_string_t::operator==(const datum_string_t &other) const {
+    // Interned strings share their buffer.
+    if (data_.get() == other.data_.get()) {
+        return true;
+    }
     if (size() != other.size()) {
         return false;
     }
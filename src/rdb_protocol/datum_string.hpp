@@ -35,6 +35,11 @@ public:
     explicit datum_string_t(const shared_buf_ref_t<char> &_ref);
     explicit datum_string_t(shared_buf_ref_t<char> &&_ref);
 
+    // Like `datum_string_t(_size, _data)`, but short strings are first looked up
+    // in a small per-thread table.  Strings that keep coming back, like object
+    // keys, then share one buffer instead of getting a new allocation each time.
+    static datum_string_t intern(size_t _size, const char *_data);
+
     // The result of data() is not automatically null terminated. Do not use
     // as a C string.
     const char *data() const;
@@ -6,10 +6,11 @@
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/minidriver.hpp"
 #include "rdb_protocol/term_walker.hpp"
+#include "thread_local.hpp"
 
 #include "debug.hpp"
 
-// This is a totally arbitrary constant limiting the size of the regex cache.  1000
+// This is a totally arbitrary constant limiting the size of each thread's regex cache.  1000
 // was chosen out of a hat; if you have a good argument for it being something else
 // (apart from cache line concerns, which are irrelevant due to the implementation)
 // you're probably right.
@@ -48,6 +49,18 @@ extproc_pool_t *env_t::get_extproc_pool() {
     return rdb_ctx_->extproc_pool;
 }
 
+TLS_with_init(regex_cache_t *, regex_cache, nullptr);
+
+regex_cache_t &env_t::regex_cache() {
+    assert_thread();
+    regex_cache_t *cache = TLS_get_regex_cache();
+    if (cache == nullptr) {
+        cache = new regex_cache_t(LRU_CACHE_SIZE);
+        TLS_set_regex_cache(cache);
+    }
+    return *cache;
+}
+
 js_runner_t *env_t::get_js_runner() {
     assert_thread();
     extproc_pool_t *extproc_pool = get_extproc_pool();
@@ -72,7 +85,6 @@ env_t::env_t(rdb_context_t *ctx,
       limits_(from_optargs(ctx, _interruptor, &serializable_.global_optargs,
                            serializable_.deterministic_time)),
       reql_version_(reql_version_t::LATEST),
-      regex_cache_(LRU_CACHE_SIZE),
       return_empty_normal_batches(_return_empty_normal_batches),
       interruptor(_interruptor),
       trace(_trace),
@@ -108,7 +120,6 @@ env_t::env_t(signal_t *_interruptor,
         auth::user_context_t(auth::permissions_t(tribool::False, tribool::False, tribool::False, tribool::False)),
         datum_t()},
       reql_version_(_reql_version),
-      regex_cache_(LRU_CACHE_SIZE),
       return_empty_normal_batches(_return_empty_normal_batches),
       interruptor(_interruptor),
       trace(NULL),
@@ -126,7 +126,8 @@ public:
         }
     }
 
-    regex_cache_t &regex_cache() { return regex_cache_; }
+    // Shared by all queries on the current thread.
+    regex_cache_t &regex_cache();
 
     reql_version_t reql_version() const { return reql_version_; }
 
@@ -141,9 +142,6 @@ private:
     // earlier value.
     const reql_version_t reql_version_;
 
-    // query specific cache parameters; for example match regexes.
-    regex_cache_t regex_cache_;
-
 public:
     const return_empty_normal_batches_t return_empty_normal_batches;
 
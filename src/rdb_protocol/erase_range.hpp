@@ -42,6 +42,11 @@ It returns a number of modification reports that should be applied to secondary
 separately. Blobs are detached, and should be deleted later if required (passing the
 modification reports to store_t::update_sindexes() takes care of that).
 
+If nothing needs the modification reports (there are no secondary indexes, and none
+are being constructed), `mod_reports_out` can be `nullptr`. Then the old values aren't
+loaded at all and their blobs are deleted right away through the deletion context's
+post deleter.
+
 Returns `CONTINUE` if it stopped because it collected `max_keys_to_erase` and `ABORT` if
 it stopped because it hit the end of the range. */
 continue_bool_t rdb_erase_small_range(
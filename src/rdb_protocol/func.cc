@@ -1,12 +1,16 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/func.hpp"
 
+#include <algorithm>
+
 #include "pprint/js_pprint.hpp"
 #include "pprint/pprint.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/minidriver.hpp"
 #include "rdb_protocol/pseudo_literal.hpp"
 #include "rdb_protocol/ql2proto.hpp"
+#include "rdb_protocol/simple_arith.hpp"
+#include "rdb_protocol/simple_predicate.hpp"
 #include "rdb_protocol/term_walker.hpp"
 #include "stl_utils.hpp"
 
@@ -45,7 +49,9 @@ reql_func_t::reql_func_t(const var_scope_t &_captured_scope,
     : func_t(_body->backtrace()),
       captured_scope(_captured_scope),
       arg_names(std::move(_arg_names)),
-      body(std::move(_body)) { }
+      body(std::move(_body)) {
+    init_simple_predicate();
+}
 
 reql_func_t::reql_func_t(scoped_ptr_t<term_storage_t> &&_storage,
                          const var_scope_t &_captured_scope,
@@ -55,10 +61,28 @@ reql_func_t::reql_func_t(scoped_ptr_t<term_storage_t> &&_storage,
       captured_scope(_captured_scope),
       arg_names(std::move(_arg_names)),
       term_storage(std::move(_storage)),
-      body(std::move(_body)) { }
+      body(std::move(_body)) {
+    init_simple_predicate();
+}
 
 reql_func_t::~reql_func_t() { }
 
+void reql_func_t::init_simple_predicate() {
+    if (arg_names.size() == 1) {
+        simple_predicate = simple_predicate_t::compile(body->get_src(), arg_names[0]);
+        if (!simple_predicate_t::compile_field_path(
+                body->get_src(), arg_names[0], &field_path)) {
+            field_path.clear();
+        }
+        simple_arith = simple_arith_t::compile(body->get_src(), arg_names[0]);
+        std::set<datum_string_t> deps;
+        if (simple_predicate_t::compile_field_deps(
+                body->get_src(), arg_names[0], &deps)) {
+            field_deps.set(std::move(deps));
+        }
+    }
+}
+
 scoped_ptr_t<val_t> reql_func_t::call(env_t *env,
                                       const std::vector<datum_t> &args,
                                       eval_flags_t eval_flags) const {
@@ -99,6 +123,69 @@ bool reql_func_t::is_simple_selector() const {
     return body->is_simple_selector();
 }
 
+bool reql_func_t::field_dependencies(std::set<datum_string_t> *fields_out) const {
+    if (!field_deps) {
+        return false;
+    }
+    *fields_out = *field_deps;
+    return true;
+}
+
+datum_t reql_func_t::call_directly(const datum_t &arg) const {
+    if (!field_path.empty()) {
+        return simple_predicate_t::eval_field_path(field_path, arg);
+    }
+    if (simple_arith.has()) {
+        optional<double> res = simple_arith->eval(arg);
+        if (res.has_value()) {
+            return datum_t(*res);
+        }
+    }
+    return datum_t();
+}
+
+bool reql_func_t::equality_filter(
+        datum_string_t *field_out, datum_t *value_out) const {
+    if (simple_predicate.has()) {
+        return simple_predicate->equality_field(field_out, value_out);
+    }
+    if (arg_names.size() != 1) {
+        return false;
+    }
+    // Object predicates like `{room: 'a'}` are matched by `filter_match`, which
+    // compares nested objects field by field, so we only use other fields.
+    const raw_term_t &src = body->get_src();
+    if (src.type() == Term::DATUM) {
+        datum_t obj = src.datum();
+        if (obj.get_type() != datum_t::R_OBJECT || obj.is_ptype()) {
+            return false;
+        }
+        for (size_t i = 0; i < obj.obj_size(); ++i) {
+            auto pair = obj.get_pair(i);
+            if (pair.second.get_type() != datum_t::R_OBJECT) {
+                *field_out = pair.first;
+                *value_out = pair.second;
+                return true;
+            }
+        }
+    } else if (src.type() == Term::MAKE_OBJ) {
+        bool found = false;
+        src.each_optarg([&](const raw_term_t &val, const std::string &key) {
+                if (found || val.type() != Term::DATUM) {
+                    return;
+                }
+                datum_t d = val.datum();
+                if (d.get_type() != datum_t::R_OBJECT) {
+                    *field_out = datum_string_t(key);
+                    *value_out = d;
+                    found = true;
+                }
+            });
+        return found;
+    }
+    return false;
+}
+
 js_func_t::js_func_t(const std::string &_js_source,
                      uint64_t timeout_ms,
                      backtrace_id_t _backtrace)
@@ -136,6 +223,28 @@ scoped_ptr_t<val_t> js_func_t::call(
     }
 }
 
+void js_func_t::prefetch_calls(env_t *env,
+                               const std::vector<datum_t> &args,
+                               size_t offset) const {
+    size_t end = std::min(args.size(), offset + PREFETCH_CALLS);
+    if (end <= offset + 1) {
+        return;
+    }
+    std::vector<std::vector<datum_t> > calls;
+    calls.reserve(end - offset);
+    for (size_t i = offset; i < end; ++i) {
+        calls.push_back(make_vector(args[i]));
+    }
+
+    js_runner_t::req_config_t config;
+    config.timeout_ms = js_timeout_ms;
+    try {
+        env->get_js_runner()->prefetch_calls(js_source, calls, config);
+    } catch (const extproc_worker_exc_t &e) {
+        // `call` will run into the same problem and report it.
+    }
+}
+
 optional<size_t> js_func_t::arity() const {
     return r_nullopt;
 }
@@ -261,6 +370,12 @@ bool filter_match(datum_t predicate, datum_t value,
 }
 
 bool reql_func_t::filter_helper(env_t *env, datum_t arg) const {
+    if (simple_predicate.has()) {
+        optional<bool> res = simple_predicate->eval(arg);
+        if (res.has_value()) {
+            return *res;
+        }
+    }
     datum_t d = call(env, make_vector(arg), NO_FLAGS)->as_datum();
     if (d.get_type() == datum_t::R_OBJECT &&
         (body->get_src().type() == Term::MAKE_OBJ ||
@@ -3,6 +3,7 @@
 #define RDB_PROTOCOL_FUNC_HPP_
 
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,6 +26,8 @@ class js_runner_t;
 namespace ql {
 
 class func_visitor_t;
+class simple_arith_t;
+class simple_predicate_t;
 
 class func_t : public slow_atomic_countable_t<func_t>, public bt_rcheckable_t {
 public:
@@ -69,6 +72,40 @@ public:
         return false;
     }
 
+    // If the function's result can only depend on the top-level fields
+    // `*fields_out` of its single argument, fills in `*fields_out` and returns true.
+    // Returns false if it may look at its argument in other ways.
+    virtual bool field_dependencies(UNUSED std::set<datum_string_t> *fields_out) const {
+        return false;
+    }
+
+    // If the function only selects a (nested) field of its argument, like
+    // `r.row('a')('b')`, or only does arithmetic on numbers, like
+    // `r.row('a').mul(2)`, returns its result for `arg` without going through
+    // the interpreter.  Returns an empty datum otherwise, or if the result can't
+    // be computed directly; callers then have to `call` the function to get its
+    // result or the proper error.
+    virtual datum_t call_directly(UNUSED const datum_t &arg) const {
+        return datum_t();
+    }
+
+    // Called before `call`ing the function on each of `args[offset]`,
+    // `args[offset + 1]`, ... in order, so that the function can evaluate up to
+    // `PREFETCH_CALLS` of those calls up front.  `js_func_t` uses this to evaluate
+    // them in a single round trip to its worker.
+    static const size_t PREFETCH_CALLS = 64;
+    virtual void prefetch_calls(UNUSED env_t *env,
+                                UNUSED const std::vector<datum_t> &args,
+                                UNUSED size_t offset) const { }
+
+    // Returns true if the function, used as a filter predicate without a
+    // default, can only pass rows whose top-level field `*field_out` equals
+    // `*value_out`, like `{room: 'a'}` or `r.row('room').eq('a')`.
+    virtual bool equality_filter(UNUSED datum_string_t *field_out,
+                                 UNUSED datum_t *value_out) const {
+        return false;
+    }
+
 protected:
     explicit func_t(backtrace_id_t bt);
 
@@ -108,10 +145,14 @@ public:
     void visit(func_visitor_t *visitor) const;
 
     bool is_simple_selector() const final;
+    bool field_dependencies(std::set<datum_string_t> *fields_out) const final;
+    datum_t call_directly(const datum_t &arg) const final;
+    bool equality_filter(datum_string_t *field_out, datum_t *value_out) const final;
 
 private:
     template <cluster_version_t> friend class wire_func_serialization_visitor_t;
     bool filter_helper(env_t *env, datum_t arg) const;
+    void init_simple_predicate();
 
     // Only contains the parts of the scope that `body` uses.
     var_scope_t captured_scope;
@@ -126,6 +167,16 @@ private:
     // The body of the function, which gets ->eval(...) called when call(...) is called.
     counted_t<const term_t> body;
 
+    // Set if `body` is simple enough for `filter_helper` to skip the interpreter.
+    scoped_ptr_t<const simple_predicate_t> simple_predicate;
+    // Non-empty if `body` only selects a field of the function's argument.
+    std::vector<datum_string_t> field_path;
+    // Set if `body` only does arithmetic on numbers.
+    scoped_ptr_t<const simple_arith_t> simple_arith;
+    // The top-level fields of the argument that `body` reads, if that's all it
+    // does with the argument.
+    optional<std::set<datum_string_t> > field_deps;
+
     DISABLE_COPYING(reql_func_t);
 };
 
@@ -142,6 +193,10 @@ public:
                              const std::vector<datum_t> &args,
                              eval_flags_t eval_flags) const;
 
+    void prefetch_calls(env_t *env,
+                        const std::vector<datum_t> &args,
+                        size_t offset) const;
+
     optional<size_t> arity() const;
 
     deterministic_t is_deterministic() const;
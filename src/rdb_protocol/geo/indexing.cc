@@ -347,6 +347,13 @@ void geo_index_traversal_helper_t::filter_range(
     *skip_out = !any_query_cell_intersects(left_excl_or_null, right_incl);
 }
 
+bool geo_index_traversal_helper_t::skip_read_ahead(
+        const btree_key_t *left_excl_or_null,
+        const btree_key_t *right_incl) {
+    guarantee(is_initialized_);
+    return !any_query_cell_intersects(left_excl_or_null, right_incl);
+}
+
 bool geo_index_traversal_helper_t::any_query_cell_intersects(
         const btree_key_t *left_excl_or_null, const btree_key_t *right_incl) const {
     std::pair<S2CellId, bool> left =
@@ -74,6 +74,11 @@ public:
             const btree_key_t *left_excl_or_null,
             const btree_key_t *right_incl,
             bool *skip_out);
+    // `filter_range()` skips everything outside of the query cells.  Reading ahead
+    // skips the same ranges, so that the blocks of different query cells get loaded
+    // in parallel without loading any that we don't need.
+    bool skip_read_ahead(const btree_key_t *left_excl_or_null,
+                         const btree_key_t *right_incl);
 
 private:
     static bool cell_intersects_with_range(const geo::S2CellId c,
@@ -6,6 +6,7 @@
 #include "rdb_protocol/geo/geojson.hpp"
 #include "rdb_protocol/geo/geo_visitor.hpp"
 #include "rdb_protocol/geo/s2/s2.h"
+#include "rdb_protocol/geo/s2/s2latlngrect.h"
 #include "rdb_protocol/geo/s2/s2polygon.h"
 #include "rdb_protocol/geo/s2/s2polyline.h"
 #include "rdb_protocol/datum.hpp"
@@ -70,6 +71,42 @@ bool geo_does_intersect(const ql::datum_t &g1,
     return visit_geojson(&tester, g1);
 }
 
+geo_intersection_tester_t::geo_intersection_tester_t(const ql::datum_t &_geojson)
+    : geojson(_geojson) {
+    datum_string_t type = geojson.get_field("type").as_str();
+    ql::datum_t coordinates = geojson.get_field("coordinates");
+    if (type == "Point") {
+        point = coordinates_to_s2point(coordinates);
+    } else if (type == "LineString") {
+        line = coordinates_to_s2polyline(coordinates);
+    } else if (type == "Polygon") {
+        polygon = coordinates_to_s2polygon(coordinates);
+    } else if (type == "$reql_LatLngRect$") {
+        rect = coordinates_to_s2latlngrect(coordinates);
+    }
+}
+
+geo_intersection_tester_t::~geo_intersection_tester_t() { }
+
+bool geo_intersection_tester_t::intersects(const ql::datum_t &other) const {
+    if (point.has()) {
+        inner_intersection_tester_t<S2Point> tester(point.get());
+        return visit_geojson(&tester, other);
+    } else if (line.has()) {
+        inner_intersection_tester_t<S2Polyline> tester(line.get());
+        return visit_geojson(&tester, other);
+    } else if (polygon.has()) {
+        inner_intersection_tester_t<S2Polygon> tester(polygon.get());
+        return visit_geojson(&tester, other);
+    } else if (rect.has()) {
+        inner_intersection_tester_t<S2LatLngRect> tester(rect.get());
+        return visit_geojson(&tester, other);
+    } else {
+        // This throws the appropriate error for unsupported types.
+        return geo_does_intersect(geojson, other);
+    }
+}
+
 bool geo_does_intersect(const S2Point &point,
                         const S2Point &other_point) {
     return point == other_point;
@@ -3,6 +3,8 @@
 #define RDB_PROTOCOL_GEO_INTERSECTION_HPP_
 
 #include "containers/counted.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/geo/s2/util/math/vector3.h"
 
 namespace geo {
@@ -12,14 +14,31 @@ class S2Polyline;
 class S2Polygon;
 }
 
-namespace ql {
-class datum_t;
-}
-
 /* A variant that works on two GeoJSON objects */
 bool geo_does_intersect(const ql::datum_t &g1,
                         const ql::datum_t &g2);
 
+/* Converts a GeoJSON object to its S2 representation once, so that it can be tested
+against many other GeoJSON objects without converting it again for each of them. */
+class geo_intersection_tester_t {
+public:
+    explicit geo_intersection_tester_t(const ql::datum_t &geojson);
+    ~geo_intersection_tester_t();
+
+    bool intersects(const ql::datum_t &other) const;
+
+private:
+    // At most one of these is set, depending on the type of `geojson`.  If none is,
+    // we fall back to `geo_does_intersect(geojson, other)`.
+    ql::datum_t geojson;
+    scoped_ptr_t<geo::S2Point> point;
+    scoped_ptr_t<geo::S2Polyline> line;
+    scoped_ptr_t<geo::S2Polygon> polygon;
+    scoped_ptr_t<geo::S2LatLngRect> rect;
+
+    DISABLE_COPYING(geo_intersection_tester_t);
+};
+
 /* Variants for each pair of S2 geometry */
 bool geo_does_intersect(const geo::S2Point &point,
                         const geo::S2Point &other_point);
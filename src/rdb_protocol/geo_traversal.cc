@@ -100,6 +100,7 @@ geo_intersecting_cb_t::geo_intersecting_cb_t(
 
 void geo_intersecting_cb_t::init_query(const ql::datum_t &_query_geometry) {
     query_geometry = _query_geometry;
+    query_tester.init(new geo_intersection_tester_t(query_geometry));
     std::vector<geo::S2CellId> covering(
         compute_cell_covering(query_geometry, QUERYING_GOAL_GRID_CELLS));
     geo_index_traversal_helper_t::init_query(
@@ -174,9 +175,7 @@ continue_bool_t geo_intersecting_cb_t::on_candidate(
             }
         }
 
-        // TODO (daniel): This is a little inefficient because we re-parse
-        // the query_geometry for each test.
-        if ((definitely_intersects || geo_does_intersect(query_geometry, sindex_val))
+        if ((definitely_intersects || query_tester->intersects(sindex_val))
             && post_filter(sindex_val, val)) {
             if (distinct_emitted->size() >= env->limits().array_size_limit()) {
                 emit_error(ql::exc_t(ql::base_exc_t::RESOURCE,
@@ -319,7 +318,10 @@ nearest_traversal_cb_t::nearest_traversal_cb_t(
         ql::env_t *_env,
         nearest_traversal_state_t *_state) :
     geo_intersecting_cb_t(_slice, std::move(_sindex), _env, &_state->distinct_emitted),
-    state(_state) {
+    state(_state),
+    s2center(S2LatLng::FromDegrees(state->center.latitude,
+                                   state->center.longitude).ToPoint()),
+    last_distance(0.0) {
     init_query_geometry();
 }
 
@@ -380,23 +382,19 @@ bool nearest_traversal_cb_t::post_filter(
         THROWS_ONLY(interrupted_exc_t, ql::base_exc_t, geo_exception_t) {
 
     // Filter out results that are outside of the current inradius
-    const S2Point s2center =
-        S2LatLng::FromDegrees(state->center.latitude, state->center.longitude).ToPoint();
-    const double dist = geodesic_distance(s2center, sindex_val, state->reference_ellipsoid);
-    return dist <= state->current_inradius;
+    last_distance =
+        geodesic_distance(s2center, sindex_val, state->reference_ellipsoid);
+    return last_distance <= state->current_inradius;
 }
 
 continue_bool_t nearest_traversal_cb_t::emit_result(
-        ql::datum_t &&sindex_val,
+        UNUSED ql::datum_t &&sindex_val,
         UNUSED store_key_t &&key,
         ql::datum_t &&val)
         THROWS_ONLY(interrupted_exc_t, ql::base_exc_t, geo_exception_t) {
-    // TODO (daniel): Could we avoid re-computing the distance? We have already
-    //   done it in post_filter().
-    const S2Point s2center =
-        S2LatLng::FromDegrees(state->center.latitude, state->center.longitude).ToPoint();
-    const double dist = geodesic_distance(s2center, sindex_val, state->reference_ellipsoid);
-    result_acc.push_back(std::make_pair(dist, std::move(val)));
+    // `on_candidate()` only calls us right after `post_filter()` accepted the
+    // document, without blocking in between.
+    result_acc.push_back(std::make_pair(last_distance, std::move(val)));
 
     return continue_bool_t::CONTINUE;
 }
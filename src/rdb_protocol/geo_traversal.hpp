@@ -17,6 +17,7 @@
 #include "rdb_protocol/geo/ellipsoid.hpp"
 #include "rdb_protocol/geo/exceptions.hpp"
 #include "rdb_protocol/geo/indexing.hpp"
+#include "rdb_protocol/geo/intersection.hpp"
 #include "rdb_protocol/geo/lon_lat_types.hpp"
 #include "rdb_protocol/protocol.hpp"
 #include "rdb_protocol/shards.hpp"
@@ -115,6 +116,9 @@ private:
     btree_slice_t *slice;
     geo_sindex_data_t sindex;
     ql::datum_t query_geometry;
+    // `query_geometry` in its S2 representation, so that we don't have to convert
+    // it again for every candidate.
+    scoped_ptr_t<geo_intersection_tester_t> query_tester;
 
     ql::env_t *env;
 
@@ -230,6 +234,12 @@ private:
     optional<ql::exc_t> error;
 
     nearest_traversal_state_t *state;
+
+    // `state->center` as an S2Point
+    const geo::S2Point s2center;
+    // The distance that `post_filter()` computed for the document that it accepted
+    // last, so that `emit_result()`, which gets called right after, can reuse it.
+    double last_distance;
 };
 
 #endif  // RDB_PROTOCOL_GEO_TRAVERSAL_HPP_
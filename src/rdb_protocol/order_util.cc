@@ -1,8 +1,10 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/order_util.hpp"
 
+#include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "rdb_protocol/datum_stream.hpp"
 #include "rdb_protocol/error.hpp"
@@ -94,51 +96,86 @@ build_comparisons_from_optional_terms(const term_t *target,
 lt_cmp_t::lt_cmp_t(std::vector<std::pair<order_direction_t, counted_t<const func_t> > > _comparisons)
             : comparisons(std::move(_comparisons)) { }
 
-bool lt_cmp_t::operator()(env_t *env,
-                          profile::sampler_t *sampler,
-                          datum_t l,
-                          datum_t r) const {
-
-    if (sampler != nullptr) {
-        sampler->new_sample();
-    }
-
+std::vector<datum_t> lt_cmp_t::sort_key(env_t *env, const datum_t &row) const {
+    std::vector<datum_t> key;
+    key.reserve(comparisons.size());
     for (auto it = comparisons.begin(); it != comparisons.end(); ++it) {
-        datum_t lval;
-        datum_t rval;
+        datum_t val;
         try {
-            lval = it->second->call(env, l)->as_datum();
-        } catch (const base_exc_t &e) {
-            if (e.get_type() != base_exc_t::NON_EXISTENCE) {
-                throw;
-            }
-        }
-
-        try {
-            rval = it->second->call(env, r)->as_datum();
+            val = it->second->call(env, row)->as_datum();
         } catch (const base_exc_t &e) {
             if (e.get_type() != base_exc_t::NON_EXISTENCE) {
                 throw;
             }
         }
+        key.push_back(std::move(val));
+    }
+    return key;
+}
 
+bool lt_cmp_t::keys_lt(const std::vector<datum_t> &l,
+                       const std::vector<datum_t> &r) const {
+    r_sanity_check(l.size() == comparisons.size() && r.size() == comparisons.size());
+    for (size_t i = 0; i < comparisons.size(); ++i) {
+        const datum_t &lval = l[i];
+        const datum_t &rval = r[i];
+        const bool desc = comparisons[i].first == DESC;
         if (!lval.has() && !rval.has()) {
             continue;
         }
         if (!lval.has()) {
-            return true != (it->first == DESC);
+            return true != desc;
         }
         if (!rval.has()) {
-            return false != (it->first == DESC);
+            return false != desc;
         }
         int cmp_res = lval.cmp(rval);
         if (cmp_res == 0) {
             continue;
         }
-        return (cmp_res < 0) != (it->first == DESC);
+        return (cmp_res < 0) != desc;
     }
 
     return false;
 }
 
+bool lt_cmp_t::operator()(env_t *env,
+                          profile::sampler_t *sampler,
+                          datum_t l,
+                          datum_t r) const {
+
+    if (sampler != nullptr) {
+        sampler->new_sample();
+    }
+    return keys_lt(sort_key(env, l), sort_key(env, r));
+}
+
+void lt_cmp_t::sort(env_t *env,
+                    profile::sampler_t *sampler,
+                    std::vector<datum_t> *rows) const {
+    // `std::stable_sort` doesn't compare anything if there's only one row, so
+    // neither do we evaluate any of the functions.
+    if (rows->size() < 2) {
+        return;
+    }
+    std::vector<std::pair<std::vector<datum_t>, datum_t> > keyed;
+    keyed.reserve(rows->size());
+    for (auto &&row : *rows) {
+        std::vector<datum_t> key = sort_key(env, row);
+        keyed.push_back(std::make_pair(std::move(key), std::move(row)));
+    }
+    std::stable_sort(
+        keyed.begin(), keyed.end(),
+        [&](const std::pair<std::vector<datum_t>, datum_t> &l,
+            const std::pair<std::vector<datum_t>, datum_t> &r) {
+            if (sampler != nullptr) {
+                sampler->new_sample();
+            }
+            return keys_lt(l.first, r.first);
+        });
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        (*rows)[i] = std::move(keyed[i].second);
+    }
+}
+
 } // namespace ql
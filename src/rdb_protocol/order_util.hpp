@@ -5,6 +5,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "errors.hpp"
 
@@ -54,6 +55,17 @@ public:
                     datum_t l,
                     datum_t r) const;
 
+    // The values that `row` gets ordered by.  Values that don't exist are left
+    // empty.  Comparing precomputed keys with `keys_lt` evaluates the order
+    // functions once per row instead of twice per comparison.
+    std::vector<datum_t> sort_key(env_t *env, const datum_t &row) const;
+    bool keys_lt(const std::vector<datum_t> &l, const std::vector<datum_t> &r) const;
+
+    // Stably sorts `rows`, computing every row's key only once.
+    void sort(env_t *env,
+              profile::sampler_t *sampler,
+              std::vector<datum_t> *rows) const;
+
 private:
     const std::vector<std::pair<order_direction_t, counted_t<const func_t> > >
         comparisons;
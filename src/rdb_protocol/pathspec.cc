@@ -140,6 +140,43 @@ void pathspec_t::init_from(const pathspec_t &other) {
 }
 
 
+/* Adds the fields of `datum` selected by `pathspec` to `res`.  Multi-path
+pathspecs (as in `pluck('a', 'b', 'c')`) write straight into the caller's builder,
+so only the selected fields get copied, and no intermediate one-field objects are
+built. */
+void project_helper(const datum_t &datum,
+                    const pathspec_t &pathspec,
+                    recurse_flag_t recurse,
+                    const configured_limits_t &limits,
+                    datum_object_builder_t *res) {
+    if (pathspec.as_str() != NULL) {
+        datum_string_t str(*pathspec.as_str());
+        const datum_t val = datum.get_field(str, NOTHROW);
+        if (val.has()) {
+            res->overwrite(std::move(str), val);
+        }
+    } else if (const std::vector<pathspec_t> *vec = pathspec.as_vec()) {
+        for (auto it = vec->begin(); it != vec->end(); ++it) {
+            project_helper(datum, *it, recurse, limits, res);
+        }
+    } else if (const std::map<datum_string_t, pathspec_t> *map = pathspec.as_map()) {
+        for (auto it = map->begin(); it != map->end(); ++it) {
+            const datum_t val = datum.get_field(it->first, NOTHROW);
+            if (val.has()) {
+                try {
+                    datum_t sub_result =
+                        project(val, it->second, RECURSE, limits);
+                    res->overwrite(it->first, sub_result);
+                } catch (const datum_exc_t &e) {
+                    // do nothing
+                }
+            }
+        }
+    } else {
+        unreachable();
+    }
+}
+
 /* Limit the datum to only the paths specified by the pathspec. */
 datum_t project(datum_t datum,
                 const pathspec_t &pathspec, recurse_flag_t recurse,
@@ -153,36 +190,7 @@ datum_t project(datum_t datum,
         return std::move(res).to_datum();
     } else {
         datum_object_builder_t res;
-        if (pathspec.as_str() != NULL) {
-            datum_string_t str(*pathspec.as_str());
-            const datum_t val = datum.get_field(str, NOTHROW);
-            if (val.has()) {
-                res.overwrite(std::move(str), val);
-            }
-        } else if (const std::vector<pathspec_t> *vec = pathspec.as_vec()) {
-            for (auto it = vec->begin(); it != vec->end(); ++it) {
-                datum_t sub_result = project(datum, *it, recurse, limits);
-                for (size_t i = 0; i < sub_result.obj_size(); ++i) {
-                    auto pair = sub_result.get_pair(i);
-                    res.overwrite(pair.first, pair.second);
-                }
-            }
-        } else if (const std::map<datum_string_t, pathspec_t> *map = pathspec.as_map()) {
-            for (auto it = map->begin(); it != map->end(); ++it) {
-                const datum_t val = datum.get_field(it->first, NOTHROW);
-                if (val.has()) {
-                    try {
-                        datum_t sub_result =
-                            project(val, it->second, RECURSE, limits);
-                        res.overwrite(it->first, sub_result);
-                    } catch (const datum_exc_t &e) {
-                        // do nothing
-                    }
-                }
-            }
-        } else {
-            unreachable();
-        }
+        project_helper(datum, pathspec, recurse, limits, &res);
         return std::move(res).to_datum();
     }
 }
@@ -175,6 +175,18 @@ void resume_construct_sindex(
         // Update the progress value
         current_progress = progress_estimator.estimate_progress(remaining_range.left);
     }
+
+    /* The index is ready. Now that it's complete, we merge the leaves that the sorted
+    inserts of the construction have left half full. This doesn't need to hold up
+    backfills, or show up as part of the construction. */
+    backfill_lock_acq.reset();
+    sindex_context_sentry.reset();
+    try {
+        compact_secondary_index(
+            store, sindex_to_construct, store_keepalive.get_drain_signal());
+    } catch (const interrupted_exc_t &) {
+        // The compaction is only an optimization, so it's fine to stop early.
+    }
 }
 
 /* This function is used by resume_construct_sindex. It traverses the primary btree
@@ -979,6 +991,11 @@ void rdb_r_unshard_visitor_t::operator()(const distribution_read_t &dg) {
         size_t total_range_keys = 0;
 
         while (i < results.size() && results[i].region.inner == range) {
+            // Every hash shard sees different writes, so we keep all of them.
+            for (const auto &pair : results[i].write_counts) {
+                res.write_counts[pair.first] += pair.second;
+            }
+
             size_t tmp_total_keys = 0;
             for (auto mit = results[i].key_counts.begin();
                  mit != results[i].key_counts.end();
@@ -1470,7 +1487,8 @@ ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(
 RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
     rget_read_response_t, stamp_response, result, reql_version);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(nearest_geo_read_response_t, results_or_error);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(distribution_read_response_t, region, key_counts);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(distribution_read_response_t,
+                                    region, key_counts, write_counts);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
     changefeed_subscribe_response_t, server_uuids, addrs);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
@@ -161,6 +161,9 @@ struct distribution_read_response_t {
     // key_counts[kn] = the number of keys in [kn, right_key)
     region_t region;
     std::map<store_key_t, int64_t> key_counts;
+    // The keys that recent writes went to, with the number of sampled writes to each.
+    // Unlike `key_counts`, these are not scaled to the size of the table.
+    std::map<store_key_t, int64_t> write_counts;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(distribution_read_response_t);
 
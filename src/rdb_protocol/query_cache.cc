@@ -1,13 +1,43 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/query_cache.hpp"
 
+#include <limits>
+
+#include "logger.hpp"
+#include "pprint/js_pprint.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/pseudo_time.hpp"
 #include "rdb_protocol/response.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
 #include "rdb_protocol/term_walker.hpp"
+#include "thread_local.hpp"
 
 namespace ql {
 
+// The sum of `read_ahead_bytes` over all entries on this thread.
+TLS_with_init(int64_t, read_ahead_bytes, 0);
+
+// Adds the time until it's destroyed to `*total_micros`, and marks the meantime as
+// busy in `*busy_since_micros`.
+class server_time_counter_t {
+public:
+    server_time_counter_t(int64_t *_total_micros, int64_t *_busy_since_micros)
+        : total_micros(_total_micros),
+          busy_since_micros(_busy_since_micros),
+          start(get_kiloticks()) {
+        *busy_since_micros = start.micros;
+    }
+    ~server_time_counter_t() {
+        *total_micros += get_kiloticks().micros - start.micros;
+        *busy_since_micros = 0;
+    }
+private:
+    int64_t *const total_micros;
+    int64_t *const busy_since_micros;
+    const kiloticks_t start;
+    DISABLE_COPYING(server_time_counter_t);
+};
+
 query_cache_t::query_cache_t(
             rdb_context_t *_rdb_ctx,
             ip_and_port_t _client_addr_port,
@@ -17,6 +47,7 @@ query_cache_t::query_cache_t(
         client_addr_port(_client_addr_port),
         return_empty_normal_batches(_return_empty_normal_batches),
         user_context(std::move(_user_context)),
+        compiled_queries(MAX_COMPILED_QUERIES),
         next_query_id(0),
         oldest_outstanding_query_id(0) {
     auto res = rdb_ctx->get_query_caches_for_this_thread()->insert(this);
@@ -47,27 +78,45 @@ scoped_ptr_t<query_cache_t::ref_t> query_cache_t::create(query_params_t *query_p
             backtrace_registry_t::EMPTY_BACKTRACE);
     }
 
+    std::shared_ptr<const term_storage_t> term_storage;
     global_optargs_t global_optargs;
     counted_t<const term_t> term_tree;
-    try {
-        query_params->term_storage->preprocess();
-        global_optargs = query_params->term_storage->global_optargs();
-
-        compile_env_t compile_env((var_visibility_t()));
-        term_tree = compile_term(&compile_env, query_params->term_storage->root_term());
-
-    } catch (const exc_t &e) {
-        throw bt_exc_t(Response::COMPILE_ERROR,
-            e.get_error_type(),
-            e.what(),
-            query_params->term_storage->backtrace_registry().datum_backtrace(e));
-    } catch (const datum_exc_t &e) {
-        throw bt_exc_t(Response::COMPILE_ERROR,
-                       e.get_error_type(),
-                       e.what(),
-                       backtrace_registry_t::EMPTY_BACKTRACE);
+    optional<std::string> cache_key = query_params->term_storage->cache_key();
+    compiled_query_t *compiled;
+    if (cache_key.has_value() && compiled_queries.lookup(*cache_key, &compiled)) {
+        term_storage = compiled->term_storage;
+        global_optargs = compiled->global_optargs;
+        term_tree = compiled->term_tree;
+    } else {
+        try {
+            query_params->term_storage->preprocess();
+            global_optargs = query_params->term_storage->global_optargs();
+
+            compile_env_t compile_env((var_visibility_t()));
+            term_tree = compile_term(&compile_env,
+                                     query_params->term_storage->root_term());
+
+        } catch (const exc_t &e) {
+            throw bt_exc_t(Response::COMPILE_ERROR,
+                e.get_error_type(),
+                e.what(),
+                query_params->term_storage->backtrace_registry().datum_backtrace(e));
+        } catch (const datum_exc_t &e) {
+            throw bt_exc_t(Response::COMPILE_ERROR,
+                           e.get_error_type(),
+                           e.what(),
+                           backtrace_registry_t::EMPTY_BACKTRACE);
+        }
+        term_storage.reset(query_params->term_storage.release());
+        if (cache_key.has_value()) {
+            compiled_queries.insert(std::move(*cache_key),
+                                    compiled_query_t{term_storage,
+                                                     global_optargs,
+                                                     term_tree});
+        }
     }
     scoped_ptr_t<entry_t> entry(new entry_t(query_params,
+                                            std::move(term_storage),
                                             std::move(global_optargs),
                                             std::move(deterministic_time),
                                             std::move(term_tree)));
@@ -160,6 +209,34 @@ void query_cache_t::async_destroy_entry(query_cache_t::entry_t *entry) {
     delete entry;
 }
 
+void query_cache_t::maybe_log_slow_query(const entry_t &entry) const {
+    const int64_t threshold_ms = rdb_ctx->slow_query_log_threshold_ms;
+    if (threshold_ms == 0 || entry.server_micros < threshold_ms * 1000) {
+        return;
+    }
+    // The wide page keeps the query on one line.  Long queries are truncated, so
+    // that one query can't flood the log.
+    const size_t ONE_LINE_WIDTH = 1024 * 1024;
+    const size_t MAX_LOGGED_QUERY_SIZE = 1024;
+    std::string query = pprint::pretty_print_as_js(
+        ONE_LINE_WIDTH, entry.term_storage->root_term());
+    if (query.size() > MAX_LOGGED_QUERY_SIZE) {
+        query.resize(MAX_LOGGED_QUERY_SIZE);
+        query += "...";
+    }
+    const int64_t total_micros = get_kiloticks().micros - entry.start_time.micros;
+    logNTC("Slow query %s from %s took %" PRIi64 " ms of server time (%" PRIi64
+           " ms total), returned %" PRIi64 " rows in %" PRIi64 " batches%s: %s",
+           uuid_to_str(entry.job_id).c_str(),
+           client_addr_port.to_string().c_str(),
+           entry.server_micros / 1000,
+           total_micros / 1000,
+           entry.rows_returned,
+           entry.batches_served,
+           entry.persistent_interruptor.is_pulsed() ? " before it was stopped" : "",
+           query.c_str());
+}
+
 query_cache_t::ref_t::~ref_t() {
     query_cache->assert_thread();
 
@@ -171,6 +248,7 @@ query_cache_t::ref_t::~ref_t() {
         //     removed, including the one in this reference
         // We remove the entry from the cache so no new queries can acquire it
         entry->state = entry_t::state_t::DELETING;
+        query_cache->maybe_log_slow_query(*entry);
 
         auto it = query_cache->queries.find(token);
         guarantee(it != query_cache->queries.end());
@@ -194,6 +272,8 @@ void query_cache_t::ref_t::fill_response(response_t *res) {
             backtrace_registry_t::EMPTY_BACKTRACE);
     }
 
+    server_time_counter_t server_time(&entry->server_micros,
+                                      &entry->busy_since_micros);
     try {
         serializable_env_t serializable{
                 entry->global_optargs,
@@ -214,6 +294,7 @@ void query_cache_t::ref_t::fill_response(response_t *res) {
         if (entry->state == entry_t::state_t::STREAM) {
             serve(&env, res);
         }
+        ++entry->batches_served;
 
         if (trace.has()) {
             res->set_profile(trace->as_datum());
@@ -276,12 +357,14 @@ void query_cache_t::ref_t::run(env_t *env, response_t *res) {
     if (val->get_type().is_convertible(val_t::type_t::DATUM)) {
         res->set_type(Response::SUCCESS_ATOM);
         res->set_data(val->as_datum());
+        entry->rows_returned = 1;
         entry->state = entry_t::state_t::DONE;
     } else if (counted_t<grouped_data_t> gd =
             val->maybe_as_promiscuous_grouped_data(scope_env.env)) {
         datum_t d = to_datum_for_client_serialization(std::move(*gd), env->limits());
         res->set_type(Response::SUCCESS_ATOM);
         res->set_data(d);
+        entry->rows_returned = 1;
         entry->state = entry_t::state_t::DONE;
     } else if (val->get_type().is_convertible(val_t::type_t::SEQUENCE)) {
         counted_t<datum_stream_t> seq = val->as_seq(env);
@@ -289,6 +372,7 @@ void query_cache_t::ref_t::run(env_t *env, response_t *res) {
         if (arr.has()) {
             res->set_type(Response::SUCCESS_ATOM);
             res->set_data(arr);
+            entry->rows_returned = arr.arr_size();
             entry->state = entry_t::state_t::DONE;
         } else {
             entry->stream = seq;
@@ -312,12 +396,42 @@ void query_cache_t::ref_t::serve(env_t *env, response_t *res) {
         throttler.reset();
     }
 
+    if (cfeed_type == feed_type_t::not_feed && entry->has_sent_batch) {
+        // A client that asks for the next batch right after receiving the last
+        // one is bound by round trips, so we send it larger batches.  Once it
+        // takes its time again we go back towards the default size, which keeps
+        // memory use and latency down for slow consumers.
+        const int64_t FAST_CONTINUE_MICROS = 20 * 1000;
+        const int64_t SLOW_CONTINUE_MICROS = 200 * 1000;
+        const int64_t MAX_BATCH_SIZE_FACTOR = 4;
+        const int64_t gap = get_kiloticks().micros - entry->last_batch_time.micros;
+        if (gap < FAST_CONTINUE_MICROS
+            && entry->batch_size_factor < MAX_BATCH_SIZE_FACTOR) {
+            entry->batch_size_factor *= 2;
+        } else if (gap > SLOW_CONTINUE_MICROS && entry->batch_size_factor > 1) {
+            entry->batch_size_factor /= 2;
+        }
+    }
+
     batch_type_t batch_type = entry->has_sent_batch
                                   ? batch_type_t::NORMAL
                                   : batch_type_t::NORMAL_FIRST;
-    std::vector<datum_t> ds = entry->stream->next_batch(
-            env, batchspec_t::user(batch_type, env));
+    std::vector<datum_t> ds;
+    if (entry->read_ahead_batch.has_value()) {
+        ds = std::move(*entry->read_ahead_batch);
+        entry->read_ahead_batch.reset();
+        entry->release_read_ahead_bytes();
+    } else if (entry->read_ahead_error) {
+        std::exception_ptr error = entry->read_ahead_error;
+        entry->read_ahead_error = nullptr;
+        std::rethrow_exception(error);
+    } else {
+        ds = entry->stream->next_batch(
+            env, batchspec_t::user(batch_type, env, entry->batch_size_factor));
+    }
     entry->has_sent_batch = true;
+    entry->last_batch_time = get_kiloticks();
+    entry->rows_returned += ds.size();
     res->set_data(std::move(ds));
 
     // Note that `SUCCESS_SEQUENCE` is possible for feeds if you call `.limit`
@@ -354,9 +468,86 @@ void query_cache_t::ref_t::serve(env_t *env, response_t *res) {
     default: unreachable();
     }
     entry->stream->set_notes(res);
+
+    // Feeds can block indefinitely, and profiles would miss the work done in the
+    // background, so we only read ahead on plain streams.
+    if (res->type() == Response::SUCCESS_PARTIAL
+        && cfeed_type == feed_type_t::not_feed
+        && !trace.has()) {
+        query_cache->start_read_ahead(entry);
+    }
+}
+
+class query_cache_t::read_ahead_t {
+public:
+    read_ahead_t(query_cache_t *query_cache, entry_t *_entry)
+        : entry(_entry),
+          rdb_ctx(query_cache->rdb_ctx),
+          return_empty_normal_batches(query_cache->return_empty_normal_batches),
+          user_context(query_cache->get_user_context()),
+          drainer_lock(&entry->drainer),
+          mutex_in_line(&entry->mutex) { }
+
+    entry_t *const entry;
+    rdb_context_t *const rdb_ctx;
+    const return_empty_normal_batches_t return_empty_normal_batches;
+    const auth::user_context_t user_context;
+    auto_drainer_t::lock_t drainer_lock;
+    new_mutex_in_line_t mutex_in_line;
+};
+
+void query_cache_t::start_read_ahead(entry_t *entry) {
+    coro_t::spawn_sometime(std::bind(&query_cache_t::read_ahead,
+                                     new read_ahead_t(this, entry)));
+}
+
+void query_cache_t::read_ahead(read_ahead_t *_read_ahead) {
+    scoped_ptr_t<read_ahead_t> read_ahead(_read_ahead);
+    entry_t *entry = read_ahead->entry;
+    wait_any_t interruptor(&entry->persistent_interruptor,
+                           read_ahead->drainer_lock.get_drain_signal());
+    try {
+        wait_interruptible(read_ahead->mutex_in_line.acq_signal(), &interruptor);
+        if (entry->state != entry_t::state_t::STREAM
+            || entry->read_ahead_batch.has_value()
+            || entry->read_ahead_error) {
+            return;
+        }
+        if (TLS_get_read_ahead_bytes() >= MAX_READ_AHEAD_BYTES_PER_THREAD) {
+            // Too many batches are waiting for idle clients already.
+            return;
+        }
+        server_time_counter_t server_time(&entry->server_micros,
+                                          &entry->busy_since_micros);
+        env_t env(read_ahead->rdb_ctx,
+                  read_ahead->return_empty_normal_batches,
+                  &interruptor,
+                  entry->global_optargs,
+                  read_ahead->user_context,
+                  entry->deterministic_time,
+                  nullptr);
+        entry->read_ahead_batch.set(entry->stream->next_batch(
+            &env,
+            batchspec_t::user(batch_type_t::NORMAL, &env, entry->batch_size_factor)));
+        int64_t bytes = 0;
+        for (const datum_t &d : *entry->read_ahead_batch) {
+            bytes += datum_approx_serialized_size(
+                d, std::numeric_limits<size_t>::max());
+        }
+        entry->read_ahead_bytes = bytes;
+        TLS_set_read_ahead_bytes(TLS_get_read_ahead_bytes() + bytes);
+    } catch (const interrupted_exc_t &) {
+        // The query was stopped or is being deleted, and whoever did that also
+        // takes care of the entry.
+    } catch (...) {
+        // Errors get reported in response to the next CONTINUE, just like if we
+        // had read the batch then.
+        entry->read_ahead_error = std::current_exception();
+    }
 }
 
 query_cache_t::entry_t::entry_t(query_params_t *query_params,
+                                std::shared_ptr<const term_storage_t> &&_term_storage,
                                 global_optargs_t &&_global_optargs,
                                 ql::datum_t && _deterministic_time,
                                 counted_t<const term_t> &&_term_tree) :
@@ -366,13 +557,34 @@ query_cache_t::entry_t::entry_t(query_params_t *query_params,
         noreply(query_params->noreply),
         profile(query_params->profile ? profile_bool_t::PROFILE :
                                         profile_bool_t::DONT_PROFILE),
-        term_storage(std::move(query_params->term_storage)),
+        term_storage(std::move(_term_storage)),
         global_optargs(std::move(_global_optargs)),
         deterministic_time(_deterministic_time),
         start_time(get_kiloticks()),
         term_tree(std::move(_term_tree)),
-        has_sent_batch(false) { }
+        has_sent_batch(false),
+        last_batch_time(start_time),
+        batch_size_factor(1),
+        read_ahead_bytes(0),
+        server_micros(0),
+        batches_served(0),
+        rows_returned(0),
+        busy_since_micros(0) { }
+
+query_cache_t::entry_t::~entry_t() {
+    release_read_ahead_bytes();
+}
 
-query_cache_t::entry_t::~entry_t() { }
+void query_cache_t::entry_t::release_read_ahead_bytes() {
+    TLS_set_read_ahead_bytes(TLS_get_read_ahead_bytes() - read_ahead_bytes);
+    read_ahead_bytes = 0;
+}
+
+int64_t query_cache_t::entry_t::get_server_micros() const {
+    if (busy_since_micros == 0) {
+        return server_micros;
+    }
+    return server_micros + (get_kiloticks().micros - busy_since_micros);
+}
 
 } // namespace ql
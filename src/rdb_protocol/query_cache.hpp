@@ -6,8 +6,10 @@
 
 #include <exception>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "arch/address.hpp"
 #include "clustering/administration/auth/user_context.hpp"
@@ -19,7 +21,9 @@
 #include "containers/scoped.hpp"
 #include "containers/counted.hpp"
 #include "containers/intrusive_list.hpp"
+#include "containers/lru_cache.hpp"
 #include "containers/object_buffer.hpp"
+#include "containers/optional.hpp"
 #include "rdb_protocol/datum_stream.hpp"
 #include "rdb_protocol/rdb_backtrace.hpp"
 #include "rdb_protocol/error.hpp"
@@ -102,10 +106,19 @@ public:
 
     auth::user_context_t const &get_user_context() const;
 
+    // Queries up to this size are kept compiled, for reuse by identical queries.
+    static const size_t MAX_COMPILED_QUERY_SIZE = 4096;
+
+    // Read-ahead batches sit in memory until their client asks for them, which for
+    // idle cursors may be never.  Once the read-ahead batches of all query caches on
+    // a thread add up to this much, cursors only read when the client asks them to.
+    static const int64_t MAX_READ_AHEAD_BYTES_PER_THREAD = 64 * MEGABYTE;
+
 private:
     class entry_t {
     public:
         entry_t(query_params_t *query_params,
+                std::shared_ptr<const term_storage_t> &&_term_storage,
                 global_optargs_t &&_global_optargs,
                 ql::datum_t &&_deterministic_time,
                 counted_t<const term_t> &&_term_tree);
@@ -117,7 +130,8 @@ private:
         const uuid_u job_id;
         const bool noreply;
         const profile_bool_t profile;
-        const scoped_ptr_t<const term_storage_t> term_storage;
+        // Shared with other queries of the same text, see `compiled_queries`.
+        const std::shared_ptr<const term_storage_t> term_storage;
         const global_optargs_t global_optargs;
         // TODO: deterministic_time and start_time represent approximately the same
         // time, but we can't compute one from the other because pseudo::time_now() uses
@@ -135,6 +149,32 @@ private:
         // stream is finished
         counted_t<datum_stream_t> stream;
         bool has_sent_batch;
+        // When we sent the last batch, and how much we currently scale the
+        // default batch size by.  See `serve`.
+        kiloticks_t last_batch_time;
+        int64_t batch_size_factor;
+        // The next batch of `stream`, if `read_ahead` already read it before the
+        // client asked for it, or the error that reading it threw.
+        optional<std::vector<datum_t> > read_ahead_batch;
+        std::exception_ptr read_ahead_error;
+        // The approximate size of `read_ahead_batch`, counted against
+        // `MAX_READ_AHEAD_BYTES_PER_THREAD` until the batch is served or dropped.
+        int64_t read_ahead_bytes;
+
+        // For the slow query log: the time the server spent evaluating the query,
+        // not counting the time it waited for the client, and what it sent back.
+        int64_t server_micros;
+        int64_t batches_served;
+        int64_t rows_returned;
+        // When the server started working on the query, or zero if it's waiting for
+        // the client.  `server_micros` doesn't include that work until it's done.
+        int64_t busy_since_micros;
+
+        // `server_micros` including the work that's still in progress.
+        int64_t get_server_micros() const;
+
+        // Stops counting `read_ahead_bytes` against the thread's budget.
+        void release_read_ahead_bytes();
 
         // The order of these is very important, do not move them around
         new_mutex_t mutex; // Only one coroutine may be using this query at a time
@@ -146,12 +186,36 @@ private:
 
     static void async_destroy_entry(entry_t *entry);
 
+    // Writes `entry` to the log if it took longer than the slow query threshold.
+    void maybe_log_slow_query(const entry_t &entry) const;
+
+    // Starts reading the next batch of `entry`'s stream in the background, so that
+    // the client's next CONTINUE doesn't have to wait for the shards.  The read
+    // gets in line for the entry's mutex before this returns, so the next `ref_t`
+    // waits for it and then serves its result.
+    class read_ahead_t;
+    void start_read_ahead(entry_t *entry);
+    static void read_ahead(read_ahead_t *read_ahead);
+
     rdb_context_t *const rdb_ctx;
     ip_and_port_t client_addr_port;
     return_empty_normal_batches_t return_empty_normal_batches;
     auth::user_context_t user_context;
     std::map<int64_t, scoped_ptr_t<entry_t> > queries;
 
+    // Applications tend to send the same few queries over and over again.  We keep
+    // the compiled term trees of recent queries, keyed by the query text, so that
+    // repeated queries skip preprocessing and compilation.  Term trees don't change
+    // when they're evaluated, so entries can share them.
+    class compiled_query_t {
+    public:
+        std::shared_ptr<const term_storage_t> term_storage;
+        global_optargs_t global_optargs;
+        counted_t<const term_t> term_tree;
+    };
+    static const size_t MAX_COMPILED_QUERIES = 256;
+    lru_cache_t<std::string, compiled_query_t> compiled_queries;
+
     // Used for noreply waiting, this contains all allocated-but-incomplete query ids
     friend class query_params_t::query_id_t;
     uint64_t next_query_id;
@@ -223,13 +223,17 @@ optional<counted_t<const ql::func_t> > real_table_t::get_write_hook(
     ql::env_t *env,
     ignore_write_hook_t ignore_write_hook) {
     optional<counted_t<const ql::func_t> > write_hook;
-    table_config_and_shards_t config;
+    // Fetching the config asks another server for the whole table config, so
+    // don't bother if we're going to ignore the hook anyway.
+    if (ignore_write_hook == ignore_write_hook_t::YES) {
+        return write_hook;
+    }
 
-    m_table_meta_client->get_config(uuid, env->interruptor, &config);
+    optional<write_hook_config_t> config;
+    m_table_meta_client->get_write_hook(uuid, env->interruptor, &config);
 
-    if (config.config.write_hook &&
-        ignore_write_hook == ignore_write_hook_t::NO) {
-        write_hook.set(config.config.write_hook->func.compile_wire_func());
+    if (config) {
+        write_hook.set(config->func.compile_wire_func());
     }
     return write_hook;
 }
@@ -438,6 +438,56 @@ serialization_result_t datum_object_serialize(
     return res;
 }
 
+// Reads the contents of a string of size `sz`, after its size has been read.
+static MUST_USE archive_result_t datum_deserialize_string_contents(
+        read_stream_t *s,
+        uint64_t sz,
+        datum_string_t *out) {
+    if (sz > std::numeric_limits<size_t>::max()) {
+        return archive_result_t::RANGE_ERROR;
+    }
+
+    const size_t str_offset = varint_uint64_serialized_size(sz);
+    counted_t<shared_buf_t> buf =
+        shared_buf_t::create(str_offset + static_cast<size_t>(sz));
+    serialize_varint_uint64_into_buf(sz, reinterpret_cast<uint8_t *>(buf->data()));
+    int64_t num_read = force_read(s, buf->data() + str_offset, sz);
+    if (num_read == -1) {
+        return archive_result_t::SOCK_ERROR;
+    }
+    if (static_cast<uint64_t>(num_read) < sz) {
+        return archive_result_t::SOCK_EOF;
+    }
+
+    *out = datum_string_t(shared_buf_ref_t<char>(std::move(buf), 0));
+
+    return archive_result_t::SUCCESS;
+}
+
+// Object keys repeat from one object to the next, so short ones get interned.
+static MUST_USE archive_result_t datum_deserialize_key(
+        read_stream_t *s,
+        datum_string_t *out) {
+    const size_t MAX_BUFFERED_KEY_SIZE = 64;
+    uint64_t sz;
+    archive_result_t res = deserialize_varint_uint64(s, &sz);
+    if (bad(res)) { return res; }
+    if (sz > MAX_BUFFERED_KEY_SIZE) {
+        return datum_deserialize_string_contents(s, sz, out);
+    }
+
+    char key[MAX_BUFFERED_KEY_SIZE];
+    int64_t num_read = force_read(s, key, sz);
+    if (num_read == -1) {
+        return archive_result_t::SOCK_ERROR;
+    }
+    if (static_cast<uint64_t>(num_read) < sz) {
+        return archive_result_t::SOCK_EOF;
+    }
+    *out = datum_string_t::intern(static_cast<size_t>(sz), key);
+    return archive_result_t::SUCCESS;
+}
+
 // For legacy R_OBJECT datums. BUF_R_OBJECT datums are not deserialized through this.
 MUST_USE archive_result_t datum_deserialize_object(
         read_stream_t *s,
@@ -456,7 +506,7 @@ MUST_USE archive_result_t datum_deserialize_object(
 
     for (uint64_t i = 0; i < sz; ++i) {
         std::pair<datum_string_t, datum_t> p;
-        res = datum_deserialize(s, &p.first);
+        res = datum_deserialize_key(s, &p.first);
         if (bad(res)) { return res; }
         res = datum_deserialize(s, &p.second);
         if (bad(res)) { return res; }
@@ -527,6 +577,65 @@ size_t datum_serialized_size(const datum_t &datum,
     return sz;
 }
 
+size_t datum_approx_serialized_size(const datum_t &datum, size_t cap) {
+    // We assume 32 bit offset table entries for in-memory arrays and objects,
+    // which overestimates the size of all but huge ones.
+    const size_t APPROX_OFFSET_SIZE = 4;
+    size_t sz = 1; // 1 byte for the type
+    switch (datum.get_type()) {
+    case datum_t::MINVAL: break;
+    case datum_t::R_BINARY: {
+        sz += datum_serialized_size(datum.as_binary());
+    } break;
+    case datum_t::R_BOOL: {
+        sz += serialize_universal_size_t<bool>::value;
+    } break;
+    case datum_t::R_NULL: break;
+    case datum_t::R_NUM: {
+        sz += serialize_universal_size_t<double>::value;
+    } break;
+    case datum_t::R_STR: {
+        sz += datum_serialized_size(datum.as_str());
+    } break;
+    case datum_t::R_ARRAY: // fallthru
+    case datum_t::R_OBJECT: {
+        const shared_buf_ref_t<char> *existing_buf_ref = datum.get_buf_ref();
+        if (existing_buf_ref != NULL) {
+            const size_t inner_sz = read_inner_serialized_size_from_buf(*existing_buf_ref);
+            sz += varint_uint64_serialized_size(inner_sz) + inner_sz;
+            break;
+        }
+        sz += call_with_enough_stack<size_t>([&] () {
+                const bool is_array = datum.get_type() == datum_t::R_ARRAY;
+                const size_t num_elements =
+                    is_array ? datum.arr_size() : datum.obj_size();
+                // The inner serialized size and the number of elements
+                size_t inner_sz = 2 * varint_uint64_serialized_size(num_elements);
+                for (size_t i = 0; i < num_elements && sz + inner_sz <= cap; ++i) {
+                    inner_sz += APPROX_OFFSET_SIZE;
+                    const size_t remaining =
+                        cap > sz + inner_sz ? cap - (sz + inner_sz) : 0;
+                    if (is_array) {
+                        inner_sz += datum_approx_serialized_size(datum.get(i),
+                                                                 remaining);
+                    } else {
+                        auto pair = datum.get_pair(i);
+                        inner_sz += datum_serialized_size(pair.first);
+                        inner_sz += datum_approx_serialized_size(pair.second,
+                                                                 remaining);
+                    }
+                }
+                return inner_sz;
+            }, MIN_DATUM_SERIALIZATION_STACK_SPACE);
+    } break;
+    case datum_t::MAXVAL: break;
+    case datum_t::UNINITIALIZED: break;
+    default:
+        unreachable();
+    }
+    return sz;
+}
+
 serialization_result_t datum_serialize(
         write_message_t *wm,
         const datum_t &datum,
@@ -853,9 +962,14 @@ datum_t datum_deserialize_from_buf(const shared_buf_ref_t<char> &buf, size_t at_
     }
 }
 
+datum_string_t datum_deserialize_key_from_buf(
+        const shared_buf_ref_t<char> &buf, size_t at_offset) {
+    return datum_string_t(buf.make_child(at_offset));
+}
+
 std::pair<datum_string_t, datum_t> datum_deserialize_pair_from_buf(
         const shared_buf_ref_t<char> &buf, size_t at_offset) {
-    datum_string_t key(buf.make_child(at_offset));
+    datum_string_t key(datum_deserialize_key_from_buf(buf, at_offset));
     // Relies on the fact that the datum_string_t serialization format hasn't
     // changed, specifically that we would still get the same size if we re-serialized
     // the datum_string_t now.
@@ -887,22 +1001,21 @@ size_t datum_get_array_size(const shared_buf_ref_t<char> &array) {
      varint num_elements
      uint*_t offsets[num_elements - 1] // counted from `data`, first element omitted
      T data[num_elements] */
-size_t datum_get_element_offset(const shared_buf_ref_t<char> &array, size_t index) {
+datum_array_header_t datum_get_array_header(const shared_buf_ref_t<char> &array) {
     buffer_read_stream_t sz_read_stream(array.get(), array.get_safety_boundary());
     uint64_t ser_size = 0;
     guarantee_deserialization(deserialize_varint_uint64(&sz_read_stream, &ser_size),
                               "datum decode array");
-    const datum_offset_size_t offset_size = get_offset_size_from_inner_size(ser_size);
-    size_t serialized_offset_size;
-    switch (offset_size) {
+    datum_array_header_t header;
+    switch (get_offset_size_from_inner_size(ser_size)) {
     case datum_offset_size_t::U8BIT:
-        serialized_offset_size = serialize_universal_size_t<uint8_t>::value; break;
+        header.offset_width = serialize_universal_size_t<uint8_t>::value; break;
     case datum_offset_size_t::U16BIT:
-        serialized_offset_size = serialize_universal_size_t<uint16_t>::value; break;
+        header.offset_width = serialize_universal_size_t<uint16_t>::value; break;
     case datum_offset_size_t::U32BIT:
-        serialized_offset_size = serialize_universal_size_t<uint32_t>::value; break;
+        header.offset_width = serialize_universal_size_t<uint32_t>::value; break;
     case datum_offset_size_t::U64BIT:
-        serialized_offset_size = serialize_universal_size_t<uint64_t>::value; break;
+        header.offset_width = serialize_universal_size_t<uint64_t>::value; break;
     default:
         unreachable();
     }
@@ -911,59 +1024,66 @@ size_t datum_get_element_offset(const shared_buf_ref_t<char> &array, size_t inde
     guarantee_deserialization(deserialize_varint_uint64(&sz_read_stream, &num_elements),
                               "datum decode array");
     guarantee(num_elements <= std::numeric_limits<size_t>::max());
-    const size_t sz = static_cast<size_t>(num_elements);
-
-    guarantee(index < sz);
-
-    rassert(sz > 0);
-    const size_t data_offset =
-        static_cast<size_t>(sz_read_stream.tell())
-        + (num_elements - 1) * serialized_offset_size;
+    header.num_elements = static_cast<size_t>(num_elements);
+    header.offsets_offset = static_cast<size_t>(sz_read_stream.tell());
+    header.data_offset = num_elements == 0
+        ? header.offsets_offset
+        : header.offsets_offset + (num_elements - 1) * header.offset_width;
+    return header;
+}
 
+size_t datum_get_element_offset(const shared_buf_ref_t<char> &array,
+                                const datum_array_header_t &header,
+                                size_t index) {
+    guarantee(index < header.num_elements);
     if (index == 0) {
-        return data_offset;
-    } else {
-        const size_t element_offset_offset =
-            static_cast<size_t>(sz_read_stream.tell())
-            + (index - 1) * serialized_offset_size;
-
-        array.guarantee_in_boundary(element_offset_offset);
-        buffer_read_stream_t read_stream(
-            array.get() + element_offset_offset,
-            array.get_safety_boundary() - element_offset_offset);
+        return header.data_offset;
+    }
 
-        uint64_t element_offset;
-        switch (offset_size) {
-        case datum_offset_size_t::U8BIT: {
-            uint8_t off;
-            guarantee_deserialization(deserialize_universal(&read_stream, &off),
-                                      "datum decode array offset");
-            element_offset = off;
-        } break;
-        case datum_offset_size_t::U16BIT: {
-            uint16_t off;
-            guarantee_deserialization(deserialize_universal(&read_stream, &off),
-                                      "datum decode array offset");
-            element_offset = off;
-        } break;
-        case datum_offset_size_t::U32BIT: {
-            uint32_t off;
-            guarantee_deserialization(deserialize_universal(&read_stream, &off),
-                                      "datum decode array offset");
-            element_offset = off;
-        } break;
-        case datum_offset_size_t::U64BIT: {
-            uint64_t off;
-            guarantee_deserialization(deserialize_universal(&read_stream, &off),
-                                      "datum decode array offset");
-            element_offset = off;
-        } break;
-        }
-        guarantee(element_offset <= std::numeric_limits<size_t>::max(),
-                  "Datum too large for this architecture.");
-
-        return data_offset + static_cast<size_t>(element_offset);
+    const size_t element_offset_offset =
+        header.offsets_offset + (index - 1) * header.offset_width;
+    array.guarantee_in_boundary(element_offset_offset);
+    buffer_read_stream_t read_stream(
+        array.get() + element_offset_offset,
+        array.get_safety_boundary() - element_offset_offset);
+
+    uint64_t element_offset;
+    switch (header.offset_width) {
+    case serialize_universal_size_t<uint8_t>::value: {
+        uint8_t off;
+        guarantee_deserialization(deserialize_universal(&read_stream, &off),
+                                  "datum decode array offset");
+        element_offset = off;
+    } break;
+    case serialize_universal_size_t<uint16_t>::value: {
+        uint16_t off;
+        guarantee_deserialization(deserialize_universal(&read_stream, &off),
+                                  "datum decode array offset");
+        element_offset = off;
+    } break;
+    case serialize_universal_size_t<uint32_t>::value: {
+        uint32_t off;
+        guarantee_deserialization(deserialize_universal(&read_stream, &off),
+                                  "datum decode array offset");
+        element_offset = off;
+    } break;
+    case serialize_universal_size_t<uint64_t>::value: {
+        uint64_t off;
+        guarantee_deserialization(deserialize_universal(&read_stream, &off),
+                                  "datum decode array offset");
+        element_offset = off;
+    } break;
+    default:
+        unreachable();
     }
+    guarantee(element_offset <= std::numeric_limits<size_t>::max(),
+              "Datum too large for this architecture.");
+
+    return header.data_offset + static_cast<size_t>(element_offset);
+}
+
+size_t datum_get_element_offset(const shared_buf_ref_t<char> &array, size_t index) {
+    return datum_get_element_offset(array, datum_get_array_header(array), index);
 }
 
 size_t datum_serialized_size(const datum_string_t &s) {
@@ -985,25 +1105,7 @@ MUST_USE archive_result_t datum_deserialize(
     archive_result_t res = deserialize_varint_uint64(s, &sz);
     if (res != archive_result_t::SUCCESS) { return res; }
 
-    if (sz > std::numeric_limits<size_t>::max()) {
-        return archive_result_t::RANGE_ERROR;
-    }
-
-    const size_t str_offset = varint_uint64_serialized_size(sz);
-    counted_t<shared_buf_t> buf =
-        shared_buf_t::create(str_offset + static_cast<size_t>(sz));
-    serialize_varint_uint64_into_buf(sz, reinterpret_cast<uint8_t *>(buf->data()));
-    int64_t num_read = force_read(s, buf->data() + str_offset, sz);
-    if (num_read == -1) {
-        return archive_result_t::SOCK_ERROR;
-    }
-    if (static_cast<uint64_t>(num_read) < sz) {
-        return archive_result_t::SOCK_EOF;
-    }
-
-    *out = datum_string_t(shared_buf_ref_t<char>(std::move(buf), 0));
-
-    return archive_result_t::SUCCESS;
+    return datum_deserialize_string_contents(s, sz, out);
 }
 
 }  // namespace ql
@@ -49,11 +49,37 @@ serialization_result_t datum_serialize(write_message_t *wm, const datum_t &datum
                                        check_datum_serialization_errors_t check_errors);
 archive_result_t datum_deserialize(read_stream_t *s, datum_t *datum);
 
+// A cheaper estimate of `datum_serialized_size`, for when the exact size doesn't
+// matter (like for batching).  It doesn't allocate, and it stops walking the datum
+// once the estimate exceeds `cap`.
+size_t datum_approx_serialized_size(const datum_t &datum, size_t cap);
+
 datum_t datum_deserialize_from_buf(const shared_buf_ref_t<char> &buf, size_t at_offset);
 std::pair<datum_string_t, datum_t> datum_deserialize_pair_from_buf(
         const shared_buf_ref_t<char> &buf, size_t at_offset);
 
+// Reads only the key of the object pair at `at_offset`.  The value starts right
+// after it, at `at_offset + datum_serialized_size(key)`.
+datum_string_t datum_deserialize_key_from_buf(
+        const shared_buf_ref_t<char> &buf, size_t at_offset);
+
+// The parsed header of a serialized array or object.  Code that looks up several
+// elements of the same array should parse it once and pass it to
+// `datum_get_element_offset` instead of having it reparsed for every element.
+struct datum_array_header_t {
+    size_t num_elements;
+    // Width in bytes of each entry in the offset table.
+    size_t offset_width;
+    // Where the offset table and the first element start in the buffer.
+    size_t offsets_offset;
+    size_t data_offset;
+};
+datum_array_header_t datum_get_array_header(const shared_buf_ref_t<char> &array);
+
 // Finds the offset of the given array element in the buffer
+size_t datum_get_element_offset(const shared_buf_ref_t<char> &array,
+                                const datum_array_header_t &header,
+                                size_t index);
 size_t datum_get_element_offset(const shared_buf_ref_t<char> &array, size_t index);
 // Reads the number of elements in the array stored in the buffer
 size_t datum_get_array_size(const shared_buf_ref_t<char> &array);
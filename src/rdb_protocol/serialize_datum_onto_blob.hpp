@@ -1,6 +1,7 @@
 #ifndef RDB_PROTOCOL_SERIALIZE_DATUM_ONTO_BLOB_HPP_
 #define RDB_PROTOCOL_SERIALIZE_DATUM_ONTO_BLOB_HPP_
 
+#include "buffer_cache/blob_read_stream.hpp"
 #include "rdb_protocol/serialize_datum.hpp"
 
 inline ql::serialization_result_t
@@ -32,12 +33,14 @@ inline void datum_deserialize_from_group(const const_buffer_group_t *group,
 }
 
 
-inline void datum_deserialize_from_blob(buf_parent_t parent, blob_t *blob,
-                                        ql::datum_t *value_out) {
-    buffer_group_t group;
-    blob_acq_t acq;
-    blob->expose_all(parent, access_t::read, &group, &acq);
-    datum_deserialize_from_group(const_view(&group), value_out);
+inline void datum_deserialize_from_blob(buf_parent_t parent, const char *ref,
+                                        int maxreflen, ql::datum_t *value_out) {
+    blob_read_stream_t stream(parent, parent.cache()->max_block_size(),
+                              ref, maxreflen);
+    archive_result_t res = datum_deserialize(&stream, value_out);
+    guarantee_deserialization(res, "datum_t (from a blob)");
+    guarantee(stream.entire_stream_consumed(),
+              "Corrupted value in storage (deserialization terminated early).");
 }
 
 
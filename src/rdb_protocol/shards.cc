@@ -1,6 +1,7 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "rdb_protocol/shards.hpp"
 
+#include <unordered_map>
 #include <utility>
 
 #include "errors.hpp"
@@ -77,6 +78,7 @@ protected:
     virtual void finish_impl(continue_bool_t, result_t *out) {
         *out = grouped_t<T>();
         boost::get<grouped_t<T> >(*out).swap(acc);
+        clear_group_index();
         guarantee(acc.size() == 0);
     }
 private:
@@ -86,14 +88,14 @@ private:
             const store_key_t &key,
             const std::function<datum_t()> &lazy_sindex_val) {
         for (auto it = groups->begin(); it != groups->end(); ++it) {
-            auto pair = acc.insert(std::make_pair(it->first, default_val));
+            auto pair = find_or_insert_group(it->first);
             auto t_it = pair.first;
             bool keep = !pair.second;
             for (auto el = it->second.begin(); el != it->second.end(); ++el) {
                 keep |= accumulate(env, *el, &t_it->second, key, lazy_sindex_val);
             }
             if (!keep) {
-                acc.erase(t_it);
+                erase_group(t_it);
             }
         }
         return should_send_batch() ? continue_bool_t::ABORT : continue_bool_t::CONTINUE;
@@ -126,11 +128,40 @@ private:
     virtual void unshard_impl(env_t *env, T *acc, const std::vector<T *> &ts) = 0;
 
 protected:
+    typedef typename std::map<datum_t, T, optional_datum_less_t>::iterator
+        acc_iterator_t;
+
+    // Looks up the accumulated value for the group `key`, inserting a copy of
+    // the default value if the group is new.  With many distinct groups the
+    // ordered `acc` costs O(log G) datum comparisons per row, so we first look
+    // in a hash index, which only requires a hash and a single comparison.
+    // The second element of the result is true if the group was inserted.
+    std::pair<acc_iterator_t, bool> find_or_insert_group(const datum_t &key) {
+        auto index_it = group_index.find(key);
+        if (index_it != group_index.end()) {
+            return std::make_pair(index_it->second, false);
+        }
+        // The index is only a cache, so the group might still be in `acc`.
+        auto pair = acc.insert(std::make_pair(key, default_val));
+        group_index.insert(std::make_pair(key, pair.first));
+        return pair;
+    }
+    void erase_group(acc_iterator_t it) {
+        group_index.erase(it->first);
+        acc.erase(it);
+    }
+    // Must be called whenever `acc` is cleared or swapped.
+    void clear_group_index() {
+        group_index.clear();
+    }
+
     const T *get_default_val() { return &default_val; }
     grouped_t<T> *get_acc() { return &acc; }
 private:
     const T default_val;
     grouped_t<T> acc;
+    std::unordered_map<datum_t, acc_iterator_t,
+                       optional_datum_hash_t, optional_datum_equal_t> group_index;
 };
 
 class append_t : public grouped_acc_t<stream_t> {
@@ -511,17 +542,15 @@ protected:
     explicit terminal_t(T &&t) : grouped_acc_t<T>(std::move(t)) { }
 private:
     virtual void operator()(env_t *env, groups_t *groups) {
-        grouped_t<T> *_acc = grouped_acc_t<T>::get_acc();
-        const T *_default_val = grouped_acc_t<T>::get_default_val();
         for (auto it = groups->begin(); it != groups->end(); ++it) {
-            auto pair = _acc->insert(std::make_pair(it->first, *_default_val));
+            auto pair = grouped_acc_t<T>::find_or_insert_group(it->first);
             auto t_it = pair.first;
             bool keep = !pair.second;
             for (auto el = it->second.begin(); el != it->second.end(); ++el) {
                 keep |= accumulate(env, *el, &t_it->second);
             }
             if (!keep) {
-                _acc->erase(t_it);
+                grouped_acc_t<T>::erase_group(t_it);
             }
         }
         groups->clear();
@@ -551,13 +580,13 @@ private:
             retval = make_scoped<val_t>(unpack(&_acc->begin()->second), bt);
         }
         _acc->clear();
+        grouped_acc_t<T>::clear_group_index();
         return retval;
     }
     virtual datum_t unpack(T *t) = 0;
 
     virtual void add_res(env_t *env, result_t *res, sorting_t) {
         grouped_t<T> *_acc = grouped_acc_t<T>::get_acc();
-        const T *_default_val = grouped_acc_t<T>::get_default_val();
         if (auto e = boost::get<exc_t>(res)) {
             throw *e;
         }
@@ -565,12 +594,13 @@ private:
         r_sanity_check(gres);
         if (_acc->size() == 0) {
             _acc->swap(*gres);
+            grouped_acc_t<T>::clear_group_index();
         } else {
             // Order in fact does NOT matter here.  The reason is, each `kv->first`
             // value is different, which means each operation works on a different
             // key/value pair of `acc`.
             for (auto kv = gres->begin(); kv != gres->end(); ++kv) {
-                auto t_it = _acc->insert(std::make_pair(kv->first, *_default_val)).first;
+                auto t_it = grouped_acc_t<T>::find_or_insert_group(kv->first).first;
                 unshard_impl(env, &t_it->second, &kv->second);
             }
         }
@@ -621,7 +651,13 @@ class acc_func_t {
 public:
     explicit acc_func_t(const counted_t<const func_t> &_f) : f(_f) { }
     datum_t operator()(env_t *env, const datum_t &el) const {
-        return f.has() ? f->call(env, el)->as_datum() : el;
+        if (!f.has()) {
+            return el;
+        }
+        // Aggregations like `sum('field')` only select a field, which we can do
+        // without the interpreter.
+        datum_t res = f->call_directly(el);
+        return res.has() ? res : f->call(env, el)->as_datum();
     }
 private:
     counted_t<const func_t> f;
@@ -988,7 +1024,12 @@ private:
         env_t *env, datums_t *lst, const std::function<datum_t()> &) {
         try {
             for (auto it = lst->begin(); it != lst->end(); ++it) {
-                *it = f->call(env, *it)->as_datum();
+                size_t offset = it - lst->begin();
+                if (offset % func_t::PREFETCH_CALLS == 0) {
+                    f->prefetch_calls(env, *lst, offset);
+                }
+                datum_t res = f->call_directly(*it);
+                *it = res.has() ? std::move(res) : f->call(env, *it)->as_datum();
             }
         } catch (const datum_exc_t &e) {
             throw exc_t(e, f->backtrace(), 1);
@@ -1043,6 +1084,11 @@ private:
         auto loc = it;
         try {
             for (it = lst->begin(); it != lst->end(); ++it) {
+                // Rows from `it` onwards haven't been moved yet.
+                size_t offset = it - lst->begin();
+                if (offset % func_t::PREFETCH_CALLS == 0) {
+                    f->prefetch_calls(env, *lst, offset);
+                }
                 if (f->filter_call(env, *it, default_val)) {
                     std::swap(*loc, *it);
                     ++loc;
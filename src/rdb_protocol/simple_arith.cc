@@ -0,0 +1,127 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "rdb_protocol/simple_arith.hpp"
+
+#include <cmath>
+#include <utility>
+
+#include "rdb_protocol/simple_predicate.hpp"
+#include "rdb_protocol/term_storage.hpp"
+
+namespace ql {
+
+scoped_ptr_t<simple_arith_t> simple_arith_t::compile(
+        const raw_term_t &body, sym_t arg) {
+    switch (static_cast<int>(body.type())) {
+    case Term::ADD: // fallthru
+    case Term::SUB: // fallthru
+    case Term::MUL: // fallthru
+    case Term::DIV:
+        break;
+    default:
+        // A bare field or literal isn't worth it, see `func_t::call_directly`.
+        return scoped_ptr_t<simple_arith_t>();
+    }
+    scoped_ptr_t<simple_arith_t> ret(new simple_arith_t());
+    if (!ret->compile_op(body, arg, 0)) {
+        return scoped_ptr_t<simple_arith_t>();
+    }
+    return ret;
+}
+
+bool simple_arith_t::compile_op(const raw_term_t &term, sym_t arg, size_t depth) {
+    if (term.num_optargs() != 0) {
+        return false;
+    }
+    op_t op;
+    switch (static_cast<int>(term.type())) {
+    case Term::ADD: op = op_t::ADD; break;
+    case Term::SUB: op = op_t::SUB; break;
+    case Term::MUL: op = op_t::MUL; break;
+    case Term::DIV: op = op_t::DIV; break;
+    default:
+        return false;
+    }
+    if (term.num_args() == 0 || !compile_operand(term.arg(0), arg, depth)) {
+        return false;
+    }
+    for (size_t i = 1; i < term.num_args(); ++i) {
+        if (!compile_operand(term.arg(i), arg, depth + 1)) {
+            return false;
+        }
+        program.push_back(instr_t{op, 0, 0});
+    }
+    return true;
+}
+
+bool simple_arith_t::compile_operand(
+        const raw_term_t &term, sym_t arg, size_t depth) {
+    if (depth >= MAX_STACK_DEPTH) {
+        return false;
+    }
+    if (term.type() == Term::DATUM) {
+        datum_t d = term.datum(configured_limits_t::unlimited, reql_version_t::LATEST);
+        if (d.get_type() != datum_t::R_NUM) {
+            return false;
+        }
+        program.push_back(instr_t{op_t::LITERAL, 0, d.as_num()});
+        return true;
+    }
+    std::vector<datum_string_t> path;
+    if (simple_predicate_t::compile_field_path(term, arg, &path)) {
+        program.push_back(instr_t{op_t::FIELD, paths.size(), 0});
+        paths.push_back(std::move(path));
+        return true;
+    }
+    return compile_op(term, arg, depth);
+}
+
+optional<double> simple_arith_t::eval(const datum_t &row) const {
+    double stack[MAX_STACK_DEPTH];
+    size_t size = 0;
+    for (const instr_t &instr : program) {
+        switch (instr.op) {
+        case op_t::LITERAL:
+            stack[size++] = instr.value;
+            continue;
+        case op_t::FIELD: {
+            const std::vector<datum_string_t> &path = paths[instr.path_index];
+            datum_t field = path.empty()
+                ? row
+                : simple_predicate_t::eval_field_path(path, row);
+            if (!field.has() || field.get_type() != datum_t::R_NUM) {
+                // Times, strings and arrays have their own arithmetic.
+                return r_nullopt;
+            }
+            stack[size++] = field.as_num();
+            continue;
+        }
+        default: break;
+        }
+
+        rassert(size >= 2);
+        const double rhs = stack[--size];
+        double *acc = &stack[size - 1];
+        switch (instr.op) {
+        case op_t::ADD: *acc += rhs; break;
+        case op_t::SUB: *acc -= rhs; break;
+        case op_t::MUL: *acc *= rhs; break;
+        case op_t::DIV:
+            if (rhs == 0) {
+                return r_nullopt;
+            }
+            *acc /= rhs;
+            break;
+        case op_t::FIELD: // fallthru
+        case op_t::LITERAL: // fallthru
+        default: unreachable();
+        }
+        // The interpreter fails on the first non-finite intermediate result.
+        if (!std::isfinite(*acc)) {
+            return r_nullopt;
+        }
+    }
+    rassert(size == 1);
+    return make_optional(stack[0]);
+}
+
+}  // namespace ql
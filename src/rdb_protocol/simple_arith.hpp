@@ -0,0 +1,69 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_SIMPLE_ARITH_HPP_
+#define RDB_PROTOCOL_SIMPLE_ARITH_HPP_
+
+#include <vector>
+
+#include "containers/optional.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/sym.hpp"
+
+namespace ql {
+
+class raw_term_t;
+
+// A function body that only does arithmetic on its argument, fields of its
+// argument and number literals, like `r.row.mul(2).add(1)` or
+// `r.row('price').mul(1.1)`.  Mapping such functions over generated or stored
+// data is common, and computing them straight on doubles skips the term
+// interpreter and the `val_t`s it allocates for every intermediate result.
+//
+// The body is lowered once into a flat postfix program, so that evaluating it for
+// each row is a single loop over the instructions with the intermediate results
+// on a small stack of doubles.
+class simple_arith_t {
+public:
+    // Returns an empty pointer if `body` is not simple arithmetic over `arg`.
+    static scoped_ptr_t<simple_arith_t> compile(const raw_term_t &body, sym_t arg);
+
+    // Returns `r_nullopt` if one of the operands isn't a number or one of the
+    // results isn't finite, in which case the caller has to evaluate the full
+    // function to get the proper result or error.
+    optional<double> eval(const datum_t &row) const;
+
+private:
+    enum class op_t { ADD, SUB, MUL, DIV, FIELD, LITERAL };
+
+    // FIELD and LITERAL push a number.  The others pop the right hand side and
+    // replace the left hand side with the result, so an n-ary `add` becomes
+    // n - 1 ADDs that fold its operands from the left like the interpreter does.
+    struct instr_t {
+        op_t op;
+        // For FIELD: the index of the fields to follow in `paths`.
+        size_t path_index;
+        // For LITERAL.
+        double value;
+    };
+
+    // Deeper expressions are left to the interpreter, so that `eval` can keep its
+    // stack in an array.
+    static const size_t MAX_STACK_DEPTH = 16;
+
+    simple_arith_t() { }
+
+    // Appends the instructions for `term` to `program`, given that `depth` values
+    // are on the stack before it runs.
+    bool compile_op(const raw_term_t &term, sym_t arg, size_t depth);
+    bool compile_operand(const raw_term_t &term, sym_t arg, size_t depth);
+
+    std::vector<instr_t> program;
+    // The fields to follow from the argument for each FIELD, which may be none.
+    std::vector<std::vector<datum_string_t> > paths;
+
+    DISABLE_COPYING(simple_arith_t);
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_SIMPLE_ARITH_HPP_
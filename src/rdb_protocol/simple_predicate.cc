@@ -0,0 +1,245 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "rdb_protocol/simple_predicate.hpp"
+
+#include <utility>
+
+#include "rdb_protocol/term_storage.hpp"
+
+namespace ql {
+
+scoped_ptr_t<simple_predicate_t> simple_predicate_t::compile(
+        const raw_term_t &body, sym_t arg) {
+    if (body.num_optargs() != 0) {
+        return scoped_ptr_t<simple_predicate_t>();
+    }
+    op_t op;
+    switch (static_cast<int>(body.type())) {
+    case Term::AND: op = op_t::AND; break;
+    case Term::OR: op = op_t::OR; break;
+    case Term::NOT: op = op_t::NOT; break;
+    default:
+        return compile_comparison(body, arg);
+    }
+    if (body.num_args() == 0 || (op == op_t::NOT && body.num_args() != 1)) {
+        return scoped_ptr_t<simple_predicate_t>();
+    }
+    scoped_ptr_t<simple_predicate_t> ret(new simple_predicate_t(op));
+    for (size_t i = 0; i < body.num_args(); ++i) {
+        scoped_ptr_t<simple_predicate_t> child = compile(body.arg(i), arg);
+        if (!child.has()) {
+            return scoped_ptr_t<simple_predicate_t>();
+        }
+        ret->children.push_back(std::move(child));
+    }
+    return ret;
+}
+
+scoped_ptr_t<simple_predicate_t> simple_predicate_t::compile_comparison(
+        const raw_term_t &body, sym_t arg) {
+    // `flipped` is the operator to use if the literal is on the left hand side.
+    op_t op, flipped;
+    switch (static_cast<int>(body.type())) {
+    case Term::EQ: op = op_t::EQ; flipped = op_t::EQ; break;
+    case Term::NE: op = op_t::NE; flipped = op_t::NE; break;
+    case Term::LT: op = op_t::LT; flipped = op_t::GT; break;
+    case Term::LE: op = op_t::LE; flipped = op_t::GE; break;
+    case Term::GT: op = op_t::GT; flipped = op_t::LT; break;
+    case Term::GE: op = op_t::GE; flipped = op_t::LE; break;
+    default:
+        return scoped_ptr_t<simple_predicate_t>();
+    }
+    if (body.num_args() != 2) {
+        return scoped_ptr_t<simple_predicate_t>();
+    }
+
+    raw_term_t lhs = body.arg(0);
+    raw_term_t rhs = body.arg(1);
+    if (lhs.type() == Term::DATUM) {
+        std::swap(lhs, rhs);
+        op = flipped;
+    }
+    if (rhs.type() != Term::DATUM) {
+        return scoped_ptr_t<simple_predicate_t>();
+    }
+    scoped_ptr_t<simple_predicate_t> ret(new simple_predicate_t(op));
+    if (!compile_field_path(lhs, arg, &ret->path) || ret->path.empty()) {
+        ret->path.clear();
+        ret->arith = simple_arith_t::compile(lhs, arg);
+        if (!ret->arith.has()) {
+            return scoped_ptr_t<simple_predicate_t>();
+        }
+    }
+    // This is what `datum_term_t` evaluates to.
+    ret->value = rhs.datum(configured_limits_t::unlimited, reql_version_t::LATEST);
+    return ret;
+}
+
+bool simple_predicate_t::compile_field_path(
+        const raw_term_t &term, sym_t arg, std::vector<datum_string_t> *path_out) {
+    if (term.num_optargs() != 0) {
+        return false;
+    }
+    switch (static_cast<int>(term.type())) {
+    case Term::VAR: {
+        if (term.num_args() != 1 || term.arg(0).type() != Term::DATUM) {
+            return false;
+        }
+        datum_t var = term.arg(0).datum();
+        return var.get_type() == datum_t::R_NUM && var.as_num() == arg.value;
+    }
+    case Term::BRACKET: // fallthru
+    case Term::GET_FIELD: {
+        if (term.num_args() != 2 || term.arg(1).type() != Term::DATUM) {
+            return false;
+        }
+        datum_t key = term.arg(1).datum();
+        if (key.get_type() != datum_t::R_STR
+            || !compile_field_path(term.arg(0), arg, path_out)) {
+            return false;
+        }
+        path_out->push_back(key.as_str());
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool simple_predicate_t::compile_field_deps(
+        const raw_term_t &term, sym_t arg, std::set<datum_string_t> *fields_out) {
+    std::vector<datum_string_t> path;
+    if (compile_field_path(term, arg, &path)) {
+        if (path.empty()) {
+            // `arg` itself.
+            return false;
+        }
+        fields_out->insert(path[0]);
+        return true;
+    }
+    switch (static_cast<int>(term.type())) {
+    case Term::DATUM:
+        return true;
+    case Term::VAR: {
+        if (term.num_args() != 1 || term.arg(0).type() != Term::DATUM) {
+            return false;
+        }
+        // Variables of enclosing or nested functions don't depend on `arg`.
+        datum_t var = term.arg(0).datum();
+        return !(var.get_type() == datum_t::R_NUM && var.as_num() == arg.value);
+    }
+    case Term::IMPLICIT_VAR:
+        return false;
+    default:
+        break;
+    }
+    for (size_t i = 0; i < term.num_args(); ++i) {
+        if (!compile_field_deps(term.arg(i), arg, fields_out)) {
+            return false;
+        }
+    }
+    bool ok = true;
+    term.each_optarg([&](const raw_term_t &optarg, const std::string &) {
+            ok = ok && compile_field_deps(optarg, arg, fields_out);
+        });
+    return ok;
+}
+
+datum_t simple_predicate_t::eval_field_path(const std::vector<datum_string_t> &path,
+                                            const datum_t &row) {
+    // Arrays and other non-objects have different `bracket` semantics, so we
+    // leave them to the interpreter.
+    datum_t field = row;
+    for (const auto &key : path) {
+        if (field.get_type() != datum_t::R_OBJECT) {
+            return datum_t();
+        }
+        field = field.get_field(key, NOTHROW);
+        if (!field.has()) {
+            return datum_t();
+        }
+    }
+    return field;
+}
+
+bool simple_predicate_t::equality_field(
+        datum_string_t *field_out, datum_t *value_out) const {
+    switch (op) {
+    case op_t::EQ:
+        if (path.size() != 1) {
+            return false;
+        }
+        *field_out = path[0];
+        *value_out = value;
+        return true;
+    case op_t::AND:
+        for (const auto &child : children) {
+            if (child->equality_field(field_out, value_out)) {
+                return true;
+            }
+        }
+        return false;
+    case op_t::NE: // fallthru
+    case op_t::LT: // fallthru
+    case op_t::LE: // fallthru
+    case op_t::GT: // fallthru
+    case op_t::GE: // fallthru
+    case op_t::OR: // fallthru
+    case op_t::NOT: // fallthru
+    default:
+        return false;
+    }
+}
+
+optional<bool> simple_predicate_t::eval(const datum_t &row) const {
+    switch (op) {
+    case op_t::AND: // fallthru
+    case op_t::OR: {
+        // Like `and` and `or`, we stop at the first argument that decides the
+        // result.
+        const bool is_and = op == op_t::AND;
+        for (const auto &child : children) {
+            optional<bool> res = child->eval(row);
+            if (!res.has_value()) {
+                return r_nullopt;
+            }
+            if (*res != is_and) {
+                return make_optional(!is_and);
+            }
+        }
+        return make_optional(is_and);
+    }
+    case op_t::NOT: {
+        optional<bool> res = children[0]->eval(row);
+        return res.has_value() ? make_optional(!*res) : res;
+    }
+    default: break;
+    }
+
+    datum_t field;
+    if (arith.has()) {
+        optional<double> res = arith->eval(row);
+        if (!res.has_value()) {
+            return r_nullopt;
+        }
+        field = datum_t(*res);
+    } else {
+        field = eval_field_path(path, row);
+        if (!field.has()) {
+            return r_nullopt;
+        }
+    }
+    switch (op) {
+    case op_t::EQ: return make_optional(field == value);
+    case op_t::NE: return make_optional(field != value);
+    case op_t::LT: return make_optional(field.cmp(value) < 0);
+    case op_t::LE: return make_optional(field.cmp(value) <= 0);
+    case op_t::GT: return make_optional(field.cmp(value) > 0);
+    case op_t::GE: return make_optional(field.cmp(value) >= 0);
+    case op_t::AND: // fallthru
+    case op_t::OR: // fallthru
+    case op_t::NOT: // fallthru
+    default: unreachable();
+    }
+}
+
+}  // namespace ql
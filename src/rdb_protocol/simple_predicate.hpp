@@ -0,0 +1,79 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_SIMPLE_PREDICATE_HPP_
+#define RDB_PROTOCOL_SIMPLE_PREDICATE_HPP_
+
+#include <set>
+#include <vector>
+
+#include "containers/optional.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/simple_arith.hpp"
+#include "rdb_protocol/sym.hpp"
+
+namespace ql {
+
+class raw_term_t;
+
+// A filter predicate that only compares fields of its argument, or simple
+// arithmetic on them, against literals, like
+// `r.row('age').gt(30).and(r.row('name').ne('Bob'))` or
+// `r.row('price').mul(r.row('qty')).ge(100)`.  Such predicates are
+// common enough that it pays off to evaluate them straight on the row, without
+// going through the term interpreter and allocating a `val_t` for every
+// intermediate result.
+class simple_predicate_t {
+public:
+    // Returns an empty pointer if `body` is not a simple predicate over `arg`.
+    static scoped_ptr_t<simple_predicate_t> compile(const raw_term_t &body, sym_t arg);
+
+    // Returns `r_nullopt` if the row doesn't have one of the compared fields, in
+    // which case the caller has to evaluate the full function to get the proper
+    // error.
+    optional<bool> eval(const datum_t &row) const;
+
+    // Returns true if the predicate can only pass rows whose top-level field
+    // `*field_out` equals `*value_out`, like `arg('room').eq('a')`, possibly
+    // `and`ed with other conditions.
+    bool equality_field(datum_string_t *field_out, datum_t *value_out) const;
+
+    // Appends the fields that `term` selects from `arg` to `path_out`, like
+    // `["a", "b"]` for `arg('a')('b')`.  Returns false if `term` is anything
+    // other than a chain of field accesses on `arg`.
+    static bool compile_field_path(
+        const raw_term_t &term, sym_t arg, std::vector<datum_string_t> *path_out);
+    // Adds the top-level fields of `arg` that `term` reads to `fields_out`, like
+    // `"a"` and `"c"` for `arg('a')('b').add(arg('c'))`.  Returns false if `term`
+    // uses `arg` in any other way, e.g. passes it to a function or takes its keys.
+    static bool compile_field_deps(
+        const raw_term_t &term, sym_t arg, std::set<datum_string_t> *fields_out);
+    // Follows `path` into `row`.  Returns an empty datum if one of the fields is
+    // missing or isn't an object, which the interpreter may treat differently.
+    static datum_t eval_field_path(const std::vector<datum_string_t> &path,
+                                   const datum_t &row);
+
+private:
+    enum class op_t { EQ, NE, LT, LE, GT, GE, AND, OR, NOT };
+
+    explicit simple_predicate_t(op_t _op) : op(_op) { }
+
+    static scoped_ptr_t<simple_predicate_t> compile_comparison(
+        const raw_term_t &body, sym_t arg);
+
+    op_t op;
+
+    // For comparisons: the field path or the arithmetic on the left hand side,
+    // and the literal on the right hand side.
+    std::vector<datum_string_t> path;
+    scoped_ptr_t<simple_arith_t> arith;
+    datum_t value;
+
+    // For AND, OR and NOT.
+    std::vector<scoped_ptr_t<simple_predicate_t> > children;
+
+    DISABLE_COPYING(simple_predicate_t);
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_SIMPLE_PREDICATE_HPP_
@@ -650,7 +650,7 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         response->response = distribution_read_response_t();
         distribution_read_response_t *res = boost::get<distribution_read_response_t>(&response->response);
         rdb_distribution_get(dg.max_depth, dg.region.inner.left,
-                             superblock, res);
+                             superblock, &store->distribution_cache, res);
         for (std::map<store_key_t, int64_t>::iterator it = res->key_counts.begin(); it != res->key_counts.end(); ) {
             if (!dg.region.inner.contains_key(store_key_t(it->first))) {
                 std::map<store_key_t, int64_t>::iterator tmp = it;
@@ -666,6 +666,8 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
             scale_down_distribution(dg.result_limit, &res->key_counts);
         }
 
+        store->write_key_sample.get(dg.region.inner, &res->write_counts);
+
         res->region = dg.region;
     }
 
@@ -825,6 +827,9 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
                                  write_hook,
                                  br.return_changes);
 
+        for (const store_key_t &key : br.keys) {
+            store->write_key_sample.record(key);
+        }
         response->response =
             rdb_batched_replace(
                 btree_info_t(btree, timestamp, datum_string_t(br.pkey)),
@@ -853,6 +858,7 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
         keys.reserve(bi.inserts.size());
         for (auto it = bi.inserts.begin(); it != bi.inserts.end(); ++it) {
             keys.emplace_back(it->get_field(datum_string_t(bi.pkey)).print_primary());
+            store->write_key_sample.record(keys.back());
         }
         response->response =
             rdb_batched_replace(
@@ -873,6 +879,7 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
             boost::get<point_write_response_t>(&response->response);
 
         backfill_debug_key(w.key, strprintf("upsert %" PRIu64, timestamp.longtime));
+        store->write_key_sample.record(w.key);
 
         rdb_live_deletion_context_t deletion_context;
         rdb_modification_report_t mod_report(w.key);
@@ -889,6 +896,7 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
             boost::get<point_delete_response_t>(&response->response);
 
         backfill_debug_key(d.key, strprintf("delete %" PRIu64, timestamp.longtime));
+        store->write_key_sample.record(d.key);
 
         rdb_live_deletion_context_t deletion_context;
         rdb_modification_report_t mod_report(d.key);
@@ -1081,6 +1089,14 @@ std::pair<ql::changefeed::server_t *, auto_drainer_t::lock_t> store_t::changefee
 
 std::pair<ql::changefeed::server_t *, auto_drainer_t::lock_t>
         store_t::get_or_make_changefeed_server(const region_t &_region) {
+    {
+        // The server usually exists already, and finding it only needs a read lock.
+        rwlock_acq_t read_acq(&changefeed_servers_lock, access_t::read);
+        auto existing = changefeed_server(_region, &read_acq);
+        if (existing.first != nullptr) {
+            return existing;
+        }
+    }
     rwlock_acq_t acq(&changefeed_servers_lock, access_t::write);
     // We assume that changefeeds use MAX_KEY instead of `unbounded` right bounds.
     // If this ever changes, `note_reshard` will need to be updated.
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "btree/get_distribution.hpp"
 #include "btree/node.hpp"
 #include "btree/parallel_traversal.hpp"
 #include "btree/secondary_operations.hpp"
@@ -201,6 +202,11 @@ public:
             THROWS_ONLY(interrupted_exc_t);
 
     void configure_flush_interval(flush_interval_t interval);
+    void configure_cache_priority(double priority);
+
+    // For the cache warm-up manifest, see `buffer_cache/warm_up_manifest.hpp`.
+    std::vector<block_id_t> warm_cache_block_ids() const;
+    void warm_up_cache(std::vector<block_id_t> &&block_ids);
 
     new_mutex_in_line_t get_in_line_for_sindex_queue(buf_lock_t *sindex_block);
     rwlock_in_line_t get_in_line_for_cfeed_stamp(access_t access);
@@ -385,6 +391,10 @@ public:
 
     std::map<uuid_u, scoped_ptr_t<btree_slice_t> > secondary_index_slices;
 
+    // Used by distribution reads on the primary btree.
+    key_distribution_cache_t distribution_cache;
+    write_key_sample_t write_key_sample;
+
     // We construct secondary indexes by starting with a `universe()` construction_range,
     // and then making the range increasingly smaller until it is `empty()`.
     // While we are in that process, we must put any write for a primary key that is in
@@ -409,6 +419,8 @@ private:
     // future we may use these `region_t`s instead of the `uuid_u`s in the
     // changefeed server.
     std::map<region_t, scoped_ptr_t<ql::changefeed::server_t> > changefeed_servers;
+    // Reader-biased, because the write path holds this for read while it updates
+    // limit changefeeds, and servers only get added or removed once in a while.
     rwlock_t changefeed_servers_lock;
 
     std::pair<ql::changefeed::server_t *, auto_drainer_t::lock_t> changefeed_server(
@@ -62,10 +62,17 @@ void store_metainfo_manager_t::update(
 
     cache.update(new_values);
 
-    std::vector<std::vector<char> > keys;
+    std::vector<region_t> regions;
     std::vector<binary_blob_t> values;
     cache.visit(region_t::universe(),
         [&](const region_t &region, const binary_blob_t &value) {
+            regions.push_back(region);
+            values.push_back(value);
+        });
+
+    if (regions != serialized_regions) {
+        serialized_keys.clear();
+        for (const region_t &region : regions) {
             vector_stream_t key;
             write_message_t wm;
             serialize_for_metainfo(&wm, region);
@@ -73,11 +80,12 @@ void store_metainfo_manager_t::update(
             DEBUG_VAR int res = send_write_message(&key, &wm);
             rassert(!res);
 
-            keys.push_back(std::move(key.vector()));
-            values.push_back(value);
-        });
+            serialized_keys.push_back(std::move(key.vector()));
+        }
+        serialized_regions = std::move(regions);
+    }
 
-    set_superblock_metainfo(superblock, keys, values, cache_version);
+    set_superblock_metainfo(superblock, serialized_keys, values, cache_version);
 }
 
 void store_metainfo_manager_t::migrate(
@@ -3,6 +3,7 @@
 #define RDB_PROTOCOL_STORE_METAINFO_HPP_
 
 #include <functional>
+#include <vector>
 
 #include "containers/binary_blob.hpp"
 #include "region/region_map.hpp"
@@ -38,6 +39,12 @@ public:
 private:
     cluster_version_t cache_version;
     region_map_t<binary_blob_t> cache;
+
+    /* The regions of `cache` as of the last `update()`, and their serialized forms.
+    Writes usually change the versions but not the regions, so the keys can be
+    reused. */
+    std::vector<region_t> serialized_regions;
+    std::vector<std::vector<char> > serialized_keys;
 };
 
 #endif /* RDB_PROTOCOL_STORE_METAINFO_HPP_ */
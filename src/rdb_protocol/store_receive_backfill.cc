@@ -1,6 +1,7 @@
 #include "rdb_protocol/store.hpp"
 
 #include "btree/backfill.hpp"
+#include "btree/bulk_load.hpp"
 #include "btree/reql_specific.hpp"
 #include "rdb_protocol/btree.hpp"
 
@@ -14,6 +15,11 @@ backfill faster, but it will also cause the backfill-related transactions to hol
 superblock for a longer time. */
 static const int MAX_CHANGES_PER_TXN = 16;
 
+/* `MAX_APPENDS_PER_TXN` is like `MAX_CHANGES_PER_TXN`, but for keys that we can append
+to the right edge of the B-tree. Those don't need a lookup each, so a transaction can
+afford more of them. */
+static const int MAX_APPENDS_PER_TXN = 64;
+
 /* `MAX_UNSAVED_CHANGES` is the maximum number of keys we'll modify or delete before
 flushing our changes out to disk. This prevents the backfill from using too much of the
 cache's unsaved data limit, which would slow down queries on other shards. */
@@ -92,7 +98,7 @@ class receive_backfill_info_t {
 public:
     receive_backfill_info_t(
             cache_conn_t *c, btree_slice_t *s, unsaved_data_limiter_t *l) :
-        cache_conn(c), slice(s), limiter(l),
+        cache_conn(c), slice(s), limiter(l), appending(true),
         semaphore(MAX_CONCURRENT_BACKFILL_ITEMS) { }
 
     /* `cache_conn` and `slice` are just copied from the corresponding fields of the
@@ -103,6 +109,13 @@ public:
     /* `limiter` lives on the stack in `receive_backfill()` */
     unsaved_data_limiter_t *limiter;
 
+    /* `appending` is true as long as the B-tree had nothing to the right of each
+    multi-key item that we've applied, which is the case when we're filling up a new
+    replica. Then `apply_multi_key_item()` appends the item's pairs to the right edge of
+    the B-tree instead of erasing the range and setting the keys one by one. Only
+    `apply_multi_key_item()` uses this, and it runs exclusively. */
+    bool appending;
+
     /* `semaphore` limits how many coroutines can be running at once. */
     new_semaphore_t semaphore;
 
@@ -211,6 +224,23 @@ void apply_item_pair(
     }
 }
 
+/* `append_item_pair()` is like `apply_item_pair()`, but for pairs with a value that
+`appender` can append. */
+void append_item_pair(
+        btree_slice_t *slice,
+        btree_bulk_appender_t *appender,
+        backfill_item_t::pair_t &&pair,
+        std::vector<rdb_modification_report_t> *mod_reports_out) {
+    mod_reports_out->resize(mod_reports_out->size() + 1);
+    mod_reports_out->back().primary_key = pair.key;
+    vector_read_stream_t read_stream(std::move(*pair.value));
+    ql::datum_t datum;
+    archive_result_t res = datum_deserialize(&read_stream, &datum);
+    guarantee(res == archive_result_t::SUCCESS);
+    rdb_append(pair.key, datum, slice, pair.recency, appender,
+        &mod_reports_out->back().info);
+}
+
 /* `apply_single_key_item()` applies a `backfill_item_t` whose range is a single key wide
 and which has a `backfill_item_t::pair_t` for that key. This eliminates the need to erase
 the previous contents of the range.
@@ -297,9 +327,11 @@ void apply_multi_key_item(
             std::vector<rdb_modification_report_t> mod_reports;
 
             /* Block until there's not too much unsaved data. Note that
-            `MAX_CHANGES_PER_TXN` might be an overestimate, but that's OK. */
+            `MAX_CHANGES_PER_TXN` or `MAX_APPENDS_PER_TXN` might be an overestimate, but
+            that's OK. */
             tokens.info->limiter->prepare_for_changes(
-                MAX_CHANGES_PER_TXN, tokens.keepalive.get_drain_signal());
+                tokens.info->appending ? MAX_APPENDS_PER_TXN : MAX_CHANGES_PER_TXN,
+                tokens.keepalive.get_drain_signal());
 
             /* We must not throw within the transaction. So we check the
             drain signal now. */
@@ -328,44 +360,84 @@ void apply_multi_key_item(
                 is_first = false;
             }
 
-            /* Establish an upper limit on how much of the range we're willing to delete
-            in this cycle. We choose the upper limit such that it contains no more than
-            `MAX_CHANGES_PER_TXN / 2` of the pairs in the backfill item. */
-            key_range_t range_to_delete;
-            range_to_delete.left = threshold.key();
-            if (next_pair + MAX_CHANGES_PER_TXN / 2 + 1 < item.pairs.size()) {
-                range_to_delete.right = key_range_t::right_bound_t(
-                    item.pairs[next_pair + MAX_CHANGES_PER_TXN / 2 + 1].key);
-            } else {
-                range_to_delete.right = item.range.right;
+            /* If nothing in the B-tree comes at or after `threshold`, then there's
+            nothing to delete, and we can append the next few pairs to the right edge of
+            the B-tree. Deletions still go through `rdb_erase_small_range()` and
+            `apply_item_pair()`, so the pairs we append stop at the first one. */
+            bool appended = false;
+            if (tokens.info->appending) {
+                size_t append_end = next_pair;
+                while (append_end < item.pairs.size()
+                        && append_end < next_pair + MAX_APPENDS_PER_TXN
+                        && static_cast<bool>(item.pairs[append_end].value)) {
+                    ++append_end;
+                }
+                if (append_end != next_pair || next_pair == item.pairs.size()) {
+                    repli_timestamp_t max_recency = repli_timestamp_t::distant_past;
+                    for (size_t i = next_pair; i < append_end; ++i) {
+                        max_recency =
+                            superceding_recency(max_recency, item.pairs[i].recency);
+                    }
+                    rdb_value_sizer_t sizer(superblock->cache()->max_block_size());
+                    btree_bulk_appender_t appender(
+                        &sizer, superblock.get(), max_recency);
+                    if (appender.can_append(threshold.key().btree_key())) {
+                        for (; next_pair < append_end; ++next_pair) {
+                            append_item_pair(tokens.info->slice, &appender,
+                                std::move(item.pairs[next_pair]), &mod_reports);
+                        }
+                        threshold = next_pair < item.pairs.size()
+                            ? key_range_t::right_bound_t(item.pairs[next_pair].key)
+                            : item.range.right;
+                        appended = true;
+                    } else {
+                        tokens.info->appending = false;
+                    }
+                }
             }
 
-            /* Delete a chunk of the range, making sure to do no more than
-            `MAX_CHANGES_PER_TXN / 2` changes at once. */
-            always_true_key_tester_t key_tester;
-            key_range_t range_deleted;
-            rdb_live_deletion_context_t deletion_context;
-            continue_bool_t res = rdb_erase_small_range(tokens.info->slice, &key_tester,
-                range_to_delete, superblock.get(), &deletion_context,
-                &non_interruptor, MAX_CHANGES_PER_TXN / 2,
-                &mod_reports, &range_deleted);
-            guarantee(range_deleted.right == range_to_delete.right
-                || res == continue_bool_t::CONTINUE);
-
-            /* Apply any pairs from the item that fall within the deleted region */
-            while (next_pair < item.pairs.size() &&
-                    range_deleted.contains_key(item.pairs[next_pair].key)) {
-                promise_t<superblock_t *> pass_back_superblock;
-                apply_item_pair(tokens.info->slice, superblock.get(),
-                    std::move(item.pairs[next_pair]), &mod_reports,
-                    &pass_back_superblock);
-                guarantee(superblock.get() == pass_back_superblock.assert_get_value());
-                ++next_pair;
+            if (!appended) {
+                /* Establish an upper limit on how much of the range we're willing to
+                delete in this cycle. We choose the upper limit such that it contains no
+                more than `MAX_CHANGES_PER_TXN / 2` of the pairs in the backfill item. */
+                key_range_t range_to_delete;
+                range_to_delete.left = threshold.key();
+                if (next_pair + MAX_CHANGES_PER_TXN / 2 + 1 < item.pairs.size()) {
+                    range_to_delete.right = key_range_t::right_bound_t(
+                        item.pairs[next_pair + MAX_CHANGES_PER_TXN / 2 + 1].key);
+                } else {
+                    range_to_delete.right = item.range.right;
+                }
+
+                /* Delete a chunk of the range, making sure to do no more than
+                `MAX_CHANGES_PER_TXN / 2` changes at once. */
+                always_true_key_tester_t key_tester;
+                key_range_t range_deleted;
+                rdb_live_deletion_context_t deletion_context;
+                continue_bool_t res = rdb_erase_small_range(tokens.info->slice,
+                    &key_tester, range_to_delete, superblock.get(), &deletion_context,
+                    &non_interruptor, MAX_CHANGES_PER_TXN / 2,
+                    &mod_reports, &range_deleted);
+                guarantee(range_deleted.right == range_to_delete.right
+                    || res == continue_bool_t::CONTINUE);
+
+                /* Apply any pairs from the item that fall within the deleted
+                region */
+                while (next_pair < item.pairs.size() &&
+                        range_deleted.contains_key(item.pairs[next_pair].key)) {
+                    promise_t<superblock_t *> pass_back_superblock;
+                    apply_item_pair(tokens.info->slice, superblock.get(),
+                        std::move(item.pairs[next_pair]), &mod_reports,
+                        &pass_back_superblock);
+                    guarantee(
+                        superblock.get() == pass_back_superblock.assert_get_value());
+                    ++next_pair;
+                }
+
+                /* Update `threshold` to reflect the changes we've made */
+                threshold = range_deleted.right;
             }
 
-            /* Update `threshold` to reflect the changes we've made */
-            threshold = range_deleted.right;
-
             /* Acquire the sindex block and update the metainfo */
             buf_lock_t sindex_block(superblock->expose_buf(),
                 superblock->get_sindex_block_id(), access_t::write);
@@ -3,6 +3,7 @@
 #include "btree/backfill.hpp"
 #include "btree/reql_specific.hpp"
 #include "btree/operations.hpp"
+#include "buffer_cache/blob_read_stream.hpp"
 #include "rdb_protocol/blob_wrapper.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/lazy_btree_val.hpp"
@@ -180,22 +181,13 @@ public:
             std::vector<char> *value_out) {
         const rdb_value_t *v =
             static_cast<const rdb_value_t *>(value_in_leaf_node);
-        rdb_blob_wrapper_t blob_wrapper(
-            parent.cache()->max_block_size(),
-            const_cast<rdb_value_t *>(v)->value_ref(),
+        blob_read_stream_t stream(
+            parent, parent.cache()->max_block_size(), v->value_ref(),
             blob::btree_maxreflen);
-        blob_acq_t acq_group;
-        buffer_group_t buffer_group;
-        blob_wrapper.expose_all(
-            parent, access_t::read, &buffer_group, &acq_group);
-        value_out->resize(buffer_group.get_size());
-        size_t offset = 0;
-        for (size_t i = 0; i < buffer_group.num_buffers(); ++i) {
-            buffer_group_t::buffer_t b = buffer_group.get_buffer(i);
-            memcpy(value_out->data() + offset, b.data, b.size);
-            offset += b.size;
-        }
-        guarantee(offset == value_out->size());
+        value_out->resize(blob::value_size(v->value_ref(), blob::btree_maxreflen));
+        int64_t res = force_read(&stream, value_out->data(), value_out->size());
+        guarantee(res == static_cast<int64_t>(value_out->size()));
+        guarantee(stream.entire_stream_consumed());
     }
     int64_t size_value(
             buf_parent_t parent,
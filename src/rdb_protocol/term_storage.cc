@@ -235,14 +235,20 @@ global_optargs_t term_storage_t::global_optargs() {
     unreachable();
 }
 
+optional<std::string> term_storage_t::cache_key() const {
+    return r_nullopt;
+}
+
 const backtrace_registry_t &term_storage_t::backtrace_registry() const {
     return bt_reg;
 }
 
 json_term_storage_t::json_term_storage_t(scoped_array_t<char> &&_original_data,
-                                         rapidjson::Document &&_query_json) :
+                                         rapidjson::Document &&_query_json,
+                                         optional<std::string> &&_query_text) :
         original_data(std::move(_original_data)),
-        query_json(std::move(_query_json)) {
+        query_json(std::move(_query_json)),
+        query_text(std::move(_query_text)) {
     // We throw `bt_exc_t`s here because we cannot use backtrace IDs until the
     // `preprocess` step has completed.
     if (!query_json.IsArray()) {
@@ -281,6 +287,10 @@ json_term_storage_t::json_term_storage_t(scoped_array_t<char> &&_original_data,
     }
 }
 
+optional<std::string> json_term_storage_t::cache_key() const {
+    return query_text;
+}
+
 Query::QueryType json_term_storage_t::query_type() const {
     return static_cast<Query::QueryType>(query_json[0].GetInt());
 }
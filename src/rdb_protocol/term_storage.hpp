@@ -133,6 +133,9 @@ public:
                                        bool default_value) const;
     virtual void preprocess();
     virtual global_optargs_t global_optargs();
+    // Queries with equal cache keys compile to the same term tree.  Returns
+    // `r_nullopt` if the query shouldn't be cached.
+    virtual optional<std::string> cache_key() const;
 
 protected:
     backtrace_registry_t bt_reg;
@@ -141,16 +144,21 @@ protected:
 class json_term_storage_t : public term_storage_t {
 public:
     json_term_storage_t(scoped_array_t<char> &&_original_data,
-                        rapidjson::Document &&_query_json);
+                        rapidjson::Document &&_query_json,
+                        optional<std::string> &&_query_text = r_nullopt);
     Query::QueryType query_type() const;
     bool static_optarg_as_bool(const std::string &key,
                                bool default_value) const;
     void preprocess();
     raw_term_t root_term() const;
     global_optargs_t global_optargs();
+    optional<std::string> cache_key() const;
 private:
     scoped_array_t<char> original_data;
     rapidjson::Document query_json;
+    // The unparsed query, which `original_data` no longer holds after in-situ
+    // parsing.  Only kept for queries that are small enough to be cached.
+    const optional<std::string> query_text;
 };
 
 class wire_term_storage_t : public term_storage_t {
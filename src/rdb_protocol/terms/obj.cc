@@ -24,7 +24,7 @@ private:
         std::vector<datum_t> arr;
         arr.reserve(d.obj_size());
         for (size_t i = 0; i < d.obj_size(); ++i) {
-            arr.push_back(datum_t(d.get_pair(i).first));
+            arr.push_back(datum_t(d.get_key(i)));
         }
 
         return new_val(datum_t(std::move(arr), env->env->limits()));
@@ -2,8 +2,12 @@
 #include "rdb_protocol/terms/terms.hpp"
 
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "rdb_protocol/datum_stream/hash_join.hpp"
 #include "rdb_protocol/error.hpp"
+#include "rdb_protocol/func.hpp"
 #include "rdb_protocol/minidriver.hpp"
 #include "rdb_protocol/op.hpp"
 #include "rdb_protocol/term_walker.hpp"
@@ -39,18 +43,45 @@ private:
         return real->is_deterministic();
     }
 
+protected:
     virtual scoped_ptr_t<val_t> term_eval(scope_env_t *env, eval_flags_t) const {
         return real->eval(env);
     }
 
+private:
     raw_term_t rewrite_src;
     counted_t<const term_t> real;
 };
 
+// Whether `term` refers to the variable `var` anywhere.
+static bool references_var(const raw_term_t &term, sym_t var) {
+    if (term.type() == Term::VAR) {
+        if (term.num_args() != 1 || term.arg(0).type() != Term::DATUM) {
+            // Let's not guess.
+            return true;
+        }
+        datum_t id = term.arg(0).datum();
+        return id.get_type() != datum_t::R_NUM || id.as_num() == var.value;
+    }
+    if (term.type() == Term::DATUM) {
+        return false;
+    }
+    bool found = false;
+    for (size_t i = 0; i < term.num_args() && !found; ++i) {
+        found = references_var(term.arg(i), var);
+    }
+    term.each_optarg([&](const raw_term_t &optarg, const std::string &) {
+            found = found || references_var(optarg, var);
+        });
+    return found;
+}
+
 class inner_join_term_t : public rewrite_term_t {
 public:
     inner_join_term_t(compile_env_t *env, const raw_term_t &term)
-        : rewrite_term_t(env, term, argspec_t(3), rewrite) { }
+        : rewrite_term_t(env, term, argspec_t(3), rewrite) {
+        init_hash_join(env, term);
+    }
 
     static minidriver_t::reql_t rewrite(const raw_term_t &in) {
         minidriver_t r(in.bt());
@@ -77,6 +108,140 @@ public:
     }
 
     virtual const char *name() const { return "inner_join"; }
+
+private:
+    // If the join function is `fn(l, r) { return f(l).eq(g(r)); }`, we can hash
+    // the right hand side on `g(r)` once and look up `f(l)` for every left row,
+    // instead of evaluating the function for every pair of rows.
+    void init_hash_join(compile_env_t *env, const raw_term_t &in) {
+        raw_term_t func = in.arg(2);
+        if (in.num_optargs() != 0
+            || func.type() != Term::FUNC
+            || func.num_args() != 2) {
+            return;
+        }
+        std::vector<sym_t> vars;
+        raw_term_t raw_vars = func.arg(0);
+        if (raw_vars.type() == Term::DATUM) {
+            datum_t d = raw_vars.datum();
+            if (d.get_type() != datum_t::R_ARRAY) {
+                return;
+            }
+            for (size_t i = 0; i < d.arr_size(); ++i) {
+                if (d.get(i).get_type() != datum_t::R_NUM) {
+                    return;
+                }
+                vars.push_back(sym_t(d.get(i).as_num()));
+            }
+        } else if (raw_vars.type() == Term::MAKE_ARRAY) {
+            for (size_t i = 0; i < raw_vars.num_args(); ++i) {
+                raw_term_t v = raw_vars.arg(i);
+                if (v.type() != Term::DATUM
+                    || v.datum().get_type() != datum_t::R_NUM) {
+                    return;
+                }
+                vars.push_back(sym_t(v.datum().as_num()));
+            }
+        }
+        raw_term_t body = func.arg(1);
+        if (vars.size() != 2
+            || body.type() != Term::EQ
+            || body.num_args() != 2
+            || body.num_optargs() != 0) {
+            return;
+        }
+
+        sym_t l = vars[0];
+        sym_t r = vars[1];
+        raw_term_t lhs = body.arg(0);
+        raw_term_t rhs = body.arg(1);
+        if (references_var(lhs, r) || references_var(rhs, l)) {
+            std::swap(lhs, rhs);
+        }
+        if (references_var(lhs, r) || references_var(rhs, l)) {
+            return;
+        }
+
+        minidriver_t md(func.bt());
+        counted_t<const term_t> left_key_term =
+            compile_term(env, md.array(static_cast<double>(l.value))
+                                  .call(Term::FUNC, lhs).root_term());
+        counted_t<const term_t> right_key_term =
+            compile_term(env, md.array(static_cast<double>(r.value))
+                                  .call(Term::FUNC, rhs).root_term());
+        // We evaluate the keys once per row rather than once per pair.
+        if (!left_key_term->is_deterministic().test(single_server_t::yes,
+                                                    constant_now_t::yes)
+            || !right_key_term->is_deterministic().test(single_server_t::yes,
+                                                        constant_now_t::yes)) {
+            return;
+        }
+        left = compile_term(env, in.arg(0));
+        right = compile_term(env, in.arg(1));
+        left_key = left_key_term;
+        right_key = right_key_term;
+    }
+
+    virtual scoped_ptr_t<val_t> term_eval(scope_env_t *env, eval_flags_t flags) const {
+        if (left_key.has()) {
+            scoped_ptr_t<val_t> res = eval_hash_join(env);
+            if (res.has()) {
+                return res;
+            }
+        }
+        return rewrite_term_t::term_eval(env, flags);
+    }
+
+    // Returns an empty pointer if the right hand side doesn't fit into memory, or if
+    // evaluating it fails.  In that case the nested loop join takes over, which
+    // also takes care of reporting errors exactly like it always did.
+    scoped_ptr_t<val_t> eval_hash_join(scope_env_t *env) const {
+        hash_join_datum_stream_t::hash_table_t table;
+        try {
+            counted_t<datum_stream_t> right_seq =
+                right->eval(env)->as_seq(env->env);
+            if (right_seq->is_infinite()) {
+                return scoped_ptr_t<val_t>();
+            }
+            counted_t<const func_t> right_key_func =
+                right_key->eval(env)->as_func();
+            const size_t array_limit = env->env->limits().array_size_limit();
+            size_t num_rows = 0;
+            batchspec_t batchspec =
+                batchspec_t::user(batch_type_t::TERMINAL, env->env);
+            profile::sampler_t sampler("Building hash join table.", env->env->trace);
+            for (;;) {
+                std::vector<datum_t> batch = right_seq->next_batch(env->env, batchspec);
+                if (batch.empty()) {
+                    break;
+                }
+                num_rows += batch.size();
+                if (num_rows > array_limit) {
+                    return scoped_ptr_t<val_t>();
+                }
+                for (auto &&row : batch) {
+                    datum_t key = right_key_func->call(env->env, row)->as_datum();
+                    table[key].push_back(std::move(row));
+                    sampler.new_sample();
+                }
+            }
+        } catch (const base_exc_t &) {
+            return scoped_ptr_t<val_t>();
+        }
+
+        scoped_ptr_t<val_t> left_val = left->eval(env);
+        if (left_val->get_type().is_convertible(val_t::type_t::GROUPED_DATA)) {
+            // `concat_map` joins every group separately.
+            return scoped_ptr_t<val_t>();
+        }
+        counted_t<datum_stream_t> left_seq = left_val->as_seq(env->env);
+        counted_t<datum_stream_t> joined = make_counted<hash_join_datum_stream_t>(
+            left_seq, std::move(table), left_key->eval(env)->as_func());
+        return new_val(env->env, joined);
+    }
+
+    // Only set if the join function allows a hash join.
+    counted_t<const term_t> left, right, left_key, right_key;
 };
 
 class outer_join_term_t : public rewrite_term_t {
@@ -1,18 +1,22 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/terms/terms.hpp"
 
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "clustering/administration/admin_op_exc.hpp"
 #include "parsing/utf8.hpp"
 #include "rdb_protocol/datum_stream/eq_join.hpp"
 #include "rdb_protocol/datum_stream/fold.hpp"
+#include "rdb_protocol/datum_stream/grouped_changes.hpp"
 #include "rdb_protocol/datum_stream/map.hpp"
 #include "rdb_protocol/datum_stream/ordered_union.hpp"
 #include "rdb_protocol/datum_stream/range.hpp"
 #include "rdb_protocol/datum_stream/union.hpp"
 #include "rdb_protocol/datum_stream/vector.hpp"
+#include "rdb_protocol/datumspec.hpp"
 #include "rdb_protocol/error.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/math_utils.hpp"
@@ -432,6 +436,19 @@ private:
             defval.set(wire_func_t(default_filter_term->eval_to_func(env->scope)));
         }
 
+        if (v0->get_type().get_raw_type() == val_t::type_t::TABLE
+            && v1->get_type().is_convertible(val_t::type_t::DATUM)
+            && !defval.has_value()) {
+            counted_t<table_t> table = v0->as_table();
+            counted_t<datum_stream_t> stream =
+                read_through_index(env, table, v1->as_datum());
+            if (stream.has()) {
+                stream->add_transformation(
+                        filter_wire_func_t(f, defval), backtrace());
+                return new_val(make_counted<selection_t>(table, stream));
+            }
+        }
+
         if (v0->get_type().is_convertible(val_t::type_t::SELECTION)) {
             counted_t<selection_t> ts = v0->as_selection(env->env);
             ts->seq->add_transformation(filter_wire_func_t(f, defval), backtrace());
@@ -444,6 +461,78 @@ private:
         }
     }
 
+    // `table.filter({field: value, ...})` would scan the whole table.  If one of
+    // the fields has a ready secondary index on exactly `row(field)`, we read the
+    // candidate rows with `get_all` instead.  The caller still applies the full
+    // filter to them, so this only relies on `get_all` returning a superset of
+    // the matching rows.  Returns an empty stream if no index fits.
+    counted_t<datum_stream_t> read_through_index(
+            scope_env_t *env,
+            const counted_t<table_t> &table,
+            const datum_t &predicate) const {
+        if (predicate.get_type() != datum_t::R_OBJECT || predicate.is_ptype()) {
+            return counted_t<datum_stream_t>();
+        }
+
+        std::map<std::string, std::pair<sindex_config_t, sindex_status_t> >
+            sindexes;
+        admin_err_t error;
+        if (!env->env->reql_cluster_interface()->sindex_list(
+                table->db, name_string_t::guarantee_valid(table->name.c_str()),
+                env->env->interruptor, &error, &sindexes)) {
+            // We can always fall back to the table scan.
+            return counted_t<datum_stream_t>();
+        }
+
+        for (size_t i = 0; i < predicate.obj_size(); ++i) {
+            std::pair<datum_string_t, datum_t> pair = predicate.get_pair(i);
+            // Objects are matched as subsets rather than compared for equality,
+            // and `get_all` doesn't accept `null` keys.
+            if (pair.second.get_type() == datum_t::R_OBJECT
+                || pair.second.get_type() == datum_t::R_NULL) {
+                continue;
+            }
+            for (const auto &sindex : sindexes) {
+                if (index_selects_field(env->env, sindex.second, pair.first)) {
+                    std::map<datum_t, uint64_t> keys;
+                    keys.insert(std::make_pair(pair.second, 1));
+                    return table->get_all(env->env,
+                                          datumspec_t(std::move(keys)),
+                                          sindex.first,
+                                          backtrace());
+                }
+            }
+        }
+        return counted_t<datum_stream_t>();
+    }
+
+    // Checks whether the index function is `row(field)`.  A simple selector only
+    // consists of field accesses and literals, so if it maps `{field: probe}` to
+    // `probe` it has to be that exact field access.
+    static bool index_selects_field(
+            env_t *env,
+            const std::pair<sindex_config_t, sindex_status_t> &sindex,
+            const datum_string_t &field) {
+        const sindex_config_t &config = sindex.first;
+        if (!sindex.second.ready
+            || sindex.second.outdated
+            || config.multi == sindex_multi_bool_t::MULTI
+            || config.geo == sindex_geo_bool_t::GEO
+            || !config.func.is_simple_selector()) {
+            return false;
+        }
+        datum_t probe(datum_string_t("filter_index_probe"));
+        datum_object_builder_t row;
+        row.overwrite(field, probe);
+        try {
+            datum_t res = config.func.compile_wire_func()->call(
+                env, std::move(row).to_datum())->as_datum();
+            return res == probe;
+        } catch (const base_exc_t &) {
+            return false;
+        }
+    }
+
     virtual const char *name() const { return "filter"; }
 
     counted_t<const func_term_t> default_filter_term;
@@ -539,8 +628,99 @@ public:
                           "include_initial",
                           "include_offsets",
                           "include_states",
-                          "include_types"})) { }
+                          "include_types"})) {
+        init_grouped(env, term.arg(0));
+    }
 private:
+    // `changes` on `seq.group(fields...).count()` or `.sum(field)` would
+    // otherwise evaluate the whole aggregation and then fail because the result
+    // isn't a stream.  Instead we remember `seq` and the grouping, open a
+    // changefeed on `seq` and keep the totals up to date as changes arrive.
+    void init_grouped(compile_env_t *env, const raw_term_t &reduction) {
+        if (reduction.num_optargs() != 0) {
+            return;
+        }
+        if (reduction.type() == Term::SUM && reduction.num_args() == 2) {
+            raw_term_t field = reduction.arg(1);
+            if (field.type() != Term::DATUM
+                || field.datum().get_type() != datum_t::R_STR) {
+                return;
+            }
+            grouped_sum_field.set(field.datum().as_str());
+        } else if (reduction.type() != Term::COUNT || reduction.num_args() != 1) {
+            return;
+        }
+        raw_term_t group = reduction.arg(0);
+        if (group.type() != Term::GROUP
+            || group.num_args() < 2
+            || group.num_optargs() != 0) {
+            grouped_sum_field.reset();
+            return;
+        }
+        std::vector<datum_string_t> fields;
+        for (size_t i = 1; i < group.num_args(); ++i) {
+            raw_term_t field = group.arg(i);
+            if (field.type() != Term::DATUM
+                || field.datum().get_type() != datum_t::R_STR) {
+                grouped_sum_field.reset();
+                return;
+            }
+            fields.push_back(field.datum().as_str());
+        }
+        grouped_fields = std::move(fields);
+        grouped_source = compile_term(env, group.arg(0));
+    }
+
+    scoped_ptr_t<val_t> eval_grouped(scope_env_t *env,
+                                     const configured_limits_t &limits,
+                                     datum_t squash,
+                                     bool include_initial,
+                                     bool include_states,
+                                     bool include_types,
+                                     bool include_offsets) const {
+        rcheck(!include_offsets && !include_types, base_exc_t::LOGIC,
+               "Cannot include offsets or types for changefeeds on "
+               "grouped reductions.");
+        rcheck(squash.get_type() == datum_t::R_BOOL && !squash.as_bool(),
+               base_exc_t::LOGIC,
+               "Cannot squash changefeeds on grouped reductions.");
+        counted_t<datum_stream_t> seq =
+            grouped_source->eval(env)->as_seq(env->env);
+        std::vector<changespec_t> changespecs = seq->get_changespecs();
+        rcheck(changespecs.size() == 1, base_exc_t::LOGIC,
+               ".changes() on grouped reductions is only supported on a "
+               "single table or selection.");
+        changespec_t &changespec = changespecs[0];
+        r_sanity_check(changespec.stream.has());
+        boost::apply_visitor(rcheck_spec_visitor_t(env->env, backtrace()),
+                             changespec.keyspec.spec);
+        // We always need the initial rows and the `ready` state to seed the
+        // totals, whether or not the user asked for them.
+        counted_t<datum_stream_t> feed = changespec.keyspec.table->read_changes(
+            env->env,
+            changefeed::streamspec_t(
+                std::move(changespec.stream),
+                changespec.keyspec.table_name,
+                false,
+                true,
+                false,
+                limits,
+                squash,
+                std::move(changespec.keyspec.spec)),
+            backtrace());
+        std::vector<datum_string_t> fields = grouped_fields;
+        optional<datum_string_t> sum_field = grouped_sum_field;
+        return new_val(
+            env->env,
+            counted_t<datum_stream_t>(
+                make_counted<grouped_changes_datum_stream_t>(
+                    std::move(feed),
+                    std::move(fields),
+                    std::move(sum_field),
+                    include_initial,
+                    include_states)));
+    }
+
     virtual scoped_ptr_t<val_t> eval_impl(
         scope_env_t *env, args_t *args, eval_flags_t) const {
 
@@ -576,9 +756,13 @@ private:
             include_offsets = v->as_bool();
         }
 
-        scoped_ptr_t<val_t> v = args->arg(env, 0);
         configured_limits_t limits = env->env->limits_with_changefeed_queue_size(
                 args->optarg(env, "changefeed_queue_size"));
+        if (grouped_source.has()) {
+            return eval_grouped(env, limits, squash, include_initial,
+                                include_states, include_types, include_offsets);
+        }
+        scoped_ptr_t<val_t> v = args->arg(env, 0);
         if (v->get_type().is_convertible(val_t::type_t::SEQUENCE)) {
             counted_t<datum_stream_t> seq = v->as_seq(env->env);
             std::vector<counted_t<datum_stream_t> > streams;
@@ -645,6 +829,12 @@ private:
               ".changes() not yet supported on range selections");
     }
     virtual const char *name() const { return "changes"; }
+
+    // Set by `init_grouped` if our argument is a grouped reduction that we can
+    // maintain incrementally.
+    counted_t<const term_t> grouped_source;
+    std::vector<datum_string_t> grouped_fields;
+    optional<datum_string_t> grouped_sum_field;
 };
 
 class minval_term_t final : public op_term_t {
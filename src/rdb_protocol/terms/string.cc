@@ -66,7 +66,11 @@ private:
         std::shared_ptr<re2::RE2> regexp;
         regex_cache_t &cache = env->env->regex_cache();
         std::shared_ptr<re2::RE2> *found;
+        rdb_context_t *rdb_ctx = env->env->get_rdb_ctx();
         if (!cache.regexes.lookup(re, &found)) {
+            if (rdb_ctx != nullptr) {
+                ++rdb_ctx->stats.regex_cache_misses;
+            }
             regexp.reset(new re2::RE2(re, re2::RE2::Quiet));
             if (!regexp->ok()) {
                 rfail(base_exc_t::LOGIC,
@@ -77,6 +81,9 @@ private:
             }
             cache.regexes.insert(re, regexp);
         } else {
+            if (rdb_ctx != nullptr) {
+                ++rdb_ctx->stats.regex_cache_hits;
+            }
             regexp = *found;
         }
         r_sanity_check(static_cast<bool>(regexp));
@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "rdb_protocol/var_types.hpp"
 
+#include <algorithm>
+
 #include "containers/archive/stl_types.hpp"
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/error.hpp"
@@ -55,7 +57,11 @@ var_scope_t var_scope_t::with_func_arg_list(
     const std::vector<sym_t> &arg_names,
     const std::vector<datum_t> &arg_values) const {
     r_sanity_check(arg_names.size() == arg_values.size());
-    var_scope_t ret = *this;
+    var_scope_t ret;
+    ret.vars.reserve(vars.size() + arg_names.size());
+    ret.vars = vars;
+    ret.implicit_depth = implicit_depth;
+    ret.maybe_implicit = maybe_implicit;
     if (function_emits_implicit_variable(arg_names)) {
         if (ret.implicit_depth == 0) {
             ret.maybe_implicit = arg_values[0];
@@ -67,17 +73,27 @@ var_scope_t var_scope_t::with_func_arg_list(
 
     for (size_t i = 0; i < arg_names.size(); ++i) {
         r_sanity_check(arg_values[i].has());
-        ret.vars.insert(std::make_pair(arg_names[i], arg_values[i]));
+        auto it = std::lower_bound(
+            ret.vars.begin(), ret.vars.end(), arg_names[i],
+            [](const std::pair<sym_t, datum_t> &var, sym_t name) {
+                return var.first < name;
+            });
+        // Like `std::map::insert`, this doesn't replace an existing variable.
+        if (it == ret.vars.end() || arg_names[i] < it->first) {
+            ret.vars.insert(it, std::make_pair(arg_names[i], arg_values[i]));
+        }
     }
     return ret;
 }
 
 var_scope_t var_scope_t::filtered_by_captures(const var_captures_t &captures) const {
     var_scope_t ret;
+    ret.vars.reserve(captures.vars_captured.size());
+    // `vars_captured` is sorted, so `ret.vars` ends up sorted too.
     for (auto it = captures.vars_captured.begin(); it != captures.vars_captured.end(); ++it) {
-        auto vars_it = vars.find(*it);
+        auto vars_it = find_var(*it);
         r_sanity_check(vars_it != vars.end());
-        ret.vars.insert(*vars_it);
+        ret.vars.push_back(*vars_it);
     }
     ret.implicit_depth = implicit_depth;
     if (captures.implicit_is_captured) {
@@ -87,8 +103,17 @@ var_scope_t var_scope_t::filtered_by_captures(const var_captures_t &captures) co
     return ret;
 }
 
+var_scope_t::vars_t::const_iterator var_scope_t::find_var(sym_t varname) const {
+    auto it = std::lower_bound(
+        vars.begin(), vars.end(), varname,
+        [](const std::pair<sym_t, datum_t> &var, sym_t name) {
+            return var.first < name;
+        });
+    return it != vars.end() && !(varname < it->first) ? it : vars.end();
+}
+
 datum_t var_scope_t::lookup_var(sym_t varname) const {
-    auto it = vars.find(varname);
+    auto it = find_var(varname);
     // This is a sanity check because we should never have constructed an expression
     // with an invalid variable name.
     r_sanity_check(it != vars.end());
@@ -172,7 +197,7 @@ archive_result_t deserialize(read_stream_t *s, var_scope_t *vs) {
         }
     }
 
-    vs->vars = std::move(local_vars);
+    vs->vars.assign(local_vars.begin(), local_vars.end());
     vs->implicit_depth = local_implicit_depth;
     vs->maybe_implicit = std::move(local_maybe_implicit);
     return archive_result_t::SUCCESS;
@@ -77,7 +77,13 @@ public:
     friend archive_result_t deserialize(read_stream_t *s, var_scope_t *);
 
 private:
-    std::map<sym_t, datum_t> vars;
+    typedef std::vector<std::pair<sym_t, datum_t> > vars_t;
+    vars_t::const_iterator find_var(sym_t varname) const;
+
+    // Sorted by variable name.  Every function call copies the scope, and a flat
+    // vector only takes a single allocation to copy while a `std::map` takes one
+    // per variable.
+    vars_t vars;
 
     uint32_t implicit_depth;
 
@@ -28,6 +28,9 @@
 // Number of messages after which the message handling loop yields
 #define MESSAGE_HANDLER_MAX_BATCH_SIZE           16
 
+// Messages at least this large bypass the connection's write buffer
+#define CLUSTER_MESSAGE_DIRECT_WRITE_SIZE        (64 * KILOBYTE)
+
 // The cluster communication protocol version.
 static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_5_is_latest,
               "We need to update CLUSTER_VERSION_STRING when we add a new cluster "
@@ -141,6 +144,9 @@ connectivity_cluster_t::connection_t::connection_t(
         // We need to acquire the send_mutex because flushing the buffer
         // must not interleave with other writes (restriction of linux_tcp_conn_t).
         mutex_t::acq_t acq(&this->send_mutex);
+        // Anyone who called `notify()` before we got the mutex has already buffered
+        // their message, so this flush takes care of all of them at once.
+        this->flusher.include_latest_notifications();
         // We ignore the return value of flush_buffer(). Closed connections
         // must be handled elsewhere.
         this->conn->flush_buffer();
@@ -1482,6 +1488,23 @@ void connectivity_cluster_t::send_message(connection_t *connection,
     vector_stream_t buffer;
     // Reserve some space to reduce overhead (especially for small messages)
     buffer.reserve(1024);
+
+    /* Messages to other servers start with the tag, which goes into the same buffer
+    so that the whole message makes it to the connection in one piece. */
+    size_t tag_size = 0;
+    if (!connection->is_loopback()) {
+        // All cluster versions use a uint8_t tag here.
+        write_message_t wm;
+        static_assert(std::is_same<message_tag_t, uint8_t>::value,
+                      "We expect to be serializing a uint8_t -- if this has "
+                      "changed, the cluster communication format has changed and "
+                      "you need to ask yourself whether live cluster upgrades work.");
+        serialize_universal(&wm, tag);
+        DEBUG_VAR int res = send_write_message(&buffer, &wm);
+        rassert(res == 0);
+        tag_size = buffer.vector().size();
+    }
+
     {
         ASSERT_FINITE_CORO_WAITING;
         callback->write(&buffer);
@@ -1509,7 +1532,7 @@ void connectivity_cluster_t::send_message(connection_t *connection,
     }
 #endif
 
-    size_t bytes_sent = buffer.vector().size();
+    size_t bytes_sent = buffer.vector().size() - tag_size;
 
 #ifdef ENABLE_MESSAGE_PROFILER
     std::pair<uint64_t, uint64_t> *stats =
@@ -1528,6 +1551,13 @@ void connectivity_cluster_t::send_message(connection_t *connection,
     } else {
         on_thread_t threader(connection->conn->home_thread());
 
+        /* Large messages gain nothing from being copied into the connection's write
+        buffer, so they are handed to the connection as they are. `write()` sends out
+        everything that was buffered before them, and only returns once the message is
+        on its way, so there's no need to go through the flusher. */
+        const bool write_directly = buffer.vector().size()
+            >= static_cast<size_t>(CLUSTER_MESSAGE_DIRECT_WRITE_SIZE);
+
         /* Acquire the send-mutex so we don't collide with other things trying
         to send on the same connection. */
         {
@@ -1535,47 +1565,32 @@ void connectivity_cluster_t::send_message(connection_t *connection,
             optimization in this case. */
             mutex_t::acq_t acq(&connection->send_mutex, true);
 
-            /* Write the tag to the network */
-            {
-                // All cluster versions use a uint8_t tag here.
-                write_message_t wm;
-                static_assert(std::is_same<message_tag_t, uint8_t>::value,
-                              "We expect to be serializing a uint8_t -- if this has "
-                              "changed, the cluster communication format has changed and "
-                              "you need to ask yourself whether live cluster upgrades work."
-                              );
-                serialize_universal(&wm, tag);
-                make_buffered_tcp_conn_stream_wrapper_t buffered_conn(connection->conn);
-                int res = send_write_message(&buffered_conn, &wm);
-                if (res == -1) {
-                    /* Close the other half of the connection to make sure that
-                       `connectivity_cluster_t::run_t::handle()` notices that something is
-                       up */
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
-                    }
-                    return;
-                }
-            }
-
-            /* Write the message itself to the network */
-            {
-                int64_t res = connection->conn->write_buffered(buffer.vector().data(),
-                                                               buffer.vector().size());
-                if (res == -1) {
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
-                    }
-                    return;
-                } else {
-                    guarantee(res == static_cast<int64_t>(buffer.vector().size()));
+            /* Write the tag and the message to the network */
+            int64_t res = write_directly
+                ? connection->conn->write(buffer.vector().data(),
+                                          buffer.vector().size())
+                : connection->conn->write_buffered(buffer.vector().data(),
+                                                   buffer.vector().size());
+            if (res == -1) {
+                /* Close the other half of the connection to make sure that
+                   `connectivity_cluster_t::run_t::handle()` notices that something is
+                   up */
+                if (connection->conn->is_read_open()) {
+                    connection->conn->shutdown_read();
                 }
+                return;
+            } else {
+                guarantee(res == static_cast<int64_t>(buffer.vector().size()));
             }
         } /* Releases the send_mutex */
 
-        connection->flusher.notify();
-        cond_t dummy_interruptor;
-        connection->flusher.flush(&dummy_interruptor);
+        if (!write_directly) {
+            /* Other messages that are sent while the flusher is busy get buffered
+            behind this one, and go out together with the next flush. */
+            connection->flusher.notify();
+            cond_t dummy_interruptor;
+            connection->flusher.flush(&dummy_interruptor);
+        }
         if (!connection->conn->is_write_open()) {
             if (connection->conn->is_read_open()) {
                 connection->conn->shutdown_read();
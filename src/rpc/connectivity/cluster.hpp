@@ -83,7 +83,13 @@ down. Messages cannot be duplicated.
 
 Can messages be reordered? I think the current implementation doesn't ever reorder
 messages, but don't rely on this guarantee. However, some old code may rely on this
-guarantee (I'm not sure) so don't break this property without checking first. */
+guarantee (I'm not sure) so don't break this property without checking first.
+
+This is also why there is exactly one TCP connection per peer. Spreading the messages
+for a peer over several connections would reorder them whenever one connection gets
+ahead of another, and the handshake, heartbeat and `connection_t` lifetime all assume a
+single connection. Throughput to a single peer instead comes from batching the writes
+on that connection (see `send_message()`). */
 
 class connectivity_cluster_t :
     public home_thread_mixin_debug_only_t
@@ -25,6 +25,9 @@ private:
 
     class update_writer_t;
 
+    /* The most key-value pairs we put in a single message. */
+    static const size_t max_keys_per_message = 64;
+
     class conn_info_t {
     public:
         conn_info_t() : pulse_on_dirty(nullptr) { }
@@ -4,6 +4,9 @@
 
 #include "rpc/directory/map_write_manager.hpp"
 
+#include <utility>
+#include <vector>
+
 #include "concurrency/wait_any.hpp"
 #include "containers/archive/optional.hpp"
 
@@ -42,14 +45,19 @@ class directory_map_write_manager_t<key_t, value_t>::update_writer_t :
 {
 public:
     update_writer_t(
-            uint64_t _timestamp, const key_t &_key, optional<value_t> &&_value) :
-        timestamp(_timestamp), key(_key), value(std::move(_value)) { }
+            uint64_t _timestamp,
+            std::vector<std::pair<key_t, optional<value_t> > > &&_updates) :
+        timestamp(_timestamp), updates(std::move(_updates)) { }
 
     void write(write_stream_t *s) {
         write_message_t wm;
         serialize<cluster_version_t::CLUSTER>(&wm, timestamp);
-        serialize<cluster_version_t::CLUSTER>(&wm, key);
-        serialize<cluster_version_t::CLUSTER>(&wm, value);
+        uint64_t num_updates = updates.size();
+        serialize<cluster_version_t::CLUSTER>(&wm, num_updates);
+        for (const auto &update : updates) {
+            serialize<cluster_version_t::CLUSTER>(&wm, update.first);
+            serialize<cluster_version_t::CLUSTER>(&wm, update.second);
+        }
         int res = send_write_message(s, &wm);
         if (res) {
             throw fake_archive_exc_t();
@@ -66,8 +74,7 @@ public:
 
 private:
     uint64_t timestamp;
-    key_t key;
-    optional<value_t> value;
+    std::vector<std::pair<key_t, optional<value_t> > > updates;
 };
 
 template<class key_t, class value_t>
@@ -114,16 +121,24 @@ void directory_map_write_manager_t<key_t, value_t>::stream_to_conn(
             issues. */
             std::set<key_t> dirty_keys;
             std::swap(dirty_keys, conns_entry->second.dirty_keys);
-            for (const key_t &key : dirty_keys) {
+            auto it = dirty_keys.begin();
+            while (it != dirty_keys.end()) {
                 if (interruptor.is_pulsed()) {
                     throw interrupted_exc_t();
                 }
-                /* If the key changed again since we copied `dirty_keys`, we'll be
-                sending the newest value, because we didn't copy the value at the same
-                time as we copied `dirty_keys`. So it's OK to remove the key from
-                `dirty_keys` to prevent sending a redundant message. */
-                conns_entry->second.dirty_keys.erase(key);
-                update_writer_t writer(timestamp, key, value->get_key(key));
+                /* Send the dirty keys in batches, so that a burst of changes (or the
+                initial contents of the map) doesn't cost one message per key. */
+                std::vector<std::pair<key_t, optional<value_t> > > updates;
+                for (; it != dirty_keys.end() && updates.size() < max_keys_per_message;
+                        ++it) {
+                    /* If the key changed again since we copied `dirty_keys`, we'll be
+                    sending the newest value, because we didn't copy the value at the
+                    same time as we copied `dirty_keys`. So it's OK to remove the key
+                    from `dirty_keys` to prevent sending a redundant message. */
+                    conns_entry->second.dirty_keys.erase(*it);
+                    updates.push_back(std::make_pair(*it, value->get_key(*it)));
+                }
+                update_writer_t writer(timestamp, std::move(updates));
                 connectivity_cluster->send_message(
                     connection, connection_keepalive, message_tag, &writer);
             }
@@ -129,6 +129,30 @@ void send_write(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
         src->get_message_tag(), &writer);
 }
 
+bool is_on_this_thread(mailbox_manager_t *src, const raw_mailbox_t::address_t &dest) {
+    return dest.thread == get_thread_id().threadnum
+        && dest.peer == src->get_connectivity_cluster()->get_me();
+}
+
+void send_local(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
+                const std::shared_ptr<mailbox_local_message_t> &message) {
+    guarantee(is_on_this_thread(src, dest));
+    raw_mailbox_t::id_t dest_mailbox_id = dest.mailbox_id;
+    /* Like `mailbox_read_coroutine()` does for local messages, we don't call the
+    mailbox before the caller yields, to avoid problems with reentrancy. */
+    coro_t::spawn_sometime([src, dest_mailbox_id, message]() {
+        raw_mailbox_t *mbox = src->mailbox_tables.get()->find_mailbox(dest_mailbox_id);
+        if (mbox != nullptr) {
+            try {
+                auto_drainer_t::lock_t keepalive(&mbox->drainer);
+                message->deliver(mbox->callback, keepalive.get_drain_signal());
+            } catch (const interrupted_exc_t &) {
+                /* Do nothing; see `mailbox_read_coroutine()`. */
+            }
+        }
+    });
+}
+
 static const int MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD = 4;
 
 mailbox_manager_t::mailbox_manager_t(connectivity_cluster_t *_connectivity_cluster,
@@ -137,27 +161,120 @@ mailbox_manager_t::mailbox_manager_t(connectivity_cluster_t *_connectivity_clust
     semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD)
     { }
 
-mailbox_manager_t::mailbox_table_t::mailbox_table_t() {
+static const size_t MIN_MAILBOX_TABLE_SLOTS = 64;
+
+mailbox_manager_t::mailbox_table_t::mailbox_table_t() :
+    slots(MIN_MAILBOX_TABLE_SLOTS, std::make_pair(0, nullptr)),
+    num_mailboxes(0) {
     next_mailbox_id = (UINT64_MAX / get_num_threads()) * get_thread_id().threadnum;
 }
 
 mailbox_manager_t::mailbox_table_t::~mailbox_table_t() {
 #ifndef NDEBUG
-    for (const auto &pair : mailboxes) {
-        debugf("ERROR: stray mailbox %p\n%s\n",
-               pair.second, pair.second->bt.lines().c_str());
+    for (const auto &pair : slots) {
+        if (pair.first != 0) {
+            debugf("ERROR: stray mailbox %p\n%s\n",
+                   pair.second, pair.second->bt.lines().c_str());
+        }
     }
 #endif
-    guarantee(mailboxes.empty(),
+    guarantee(num_mailboxes == 0,
               "Please destroy all mailboxes before destroying the cluster");
 }
 
-raw_mailbox_t *mailbox_manager_t::mailbox_table_t::find_mailbox(raw_mailbox_t::id_t id) {
-    std::map<raw_mailbox_t::id_t, raw_mailbox_t *>::iterator it = mailboxes.find(id);
-    if (it == mailboxes.end()) {
+size_t mailbox_manager_t::mailbox_table_t::home_slot(raw_mailbox_t::id_t id) const {
+    // Ids are handed out sequentially, so we mix the bits before masking them.
+    return (id * 0x9E3779B97F4A7C15ull >> 17) & (slots.size() - 1);
+}
+
+raw_mailbox_t *mailbox_manager_t::mailbox_table_t::find_mailbox(
+        raw_mailbox_t::id_t id) const {
+    if (id == 0) {
         return nullptr;
-    } else {
-        return it->second;
+    }
+    for (size_t i = home_slot(id); slots[i].first != 0; i = (i + 1) & (slots.size() - 1)) {
+        if (slots[i].first == id) {
+            return slots[i].second;
+        }
+    }
+    return nullptr;
+}
+
+void mailbox_manager_t::mailbox_table_t::insert(
+        raw_mailbox_t::id_t id, raw_mailbox_t *mailbox) {
+    guarantee(id != 0);
+    if (2 * (num_mailboxes + 1) > slots.size()) {
+        resize(2 * slots.size());
+    }
+    size_t i = home_slot(id);
+    while (slots[i].first != 0) {
+        guarantee(slots[i].first != id);
+        i = (i + 1) & (slots.size() - 1);
+    }
+    slots[i] = std::make_pair(id, mailbox);
+    ++num_mailboxes;
+}
+
+void mailbox_manager_t::mailbox_table_t::erase(raw_mailbox_t::id_t id) {
+    const size_t mask = slots.size() - 1;
+    size_t i = home_slot(id);
+    while (slots[i].first != id) {
+        guarantee(slots[i].first != 0, "Unregistering an unknown mailbox");
+        i = (i + 1) & mask;
+    }
+    /* Instead of leaving a tombstone, we move later entries of the same probe
+    sequence back into the hole, so that lookups can still stop at the first empty
+    slot. */
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; slots[j].first != 0; j = (j + 1) & mask) {
+        const size_t home = home_slot(slots[j].first);
+        // The entry at `j` can move to `hole` unless its home slot lies cyclically
+        // in `(hole, j]`.
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole] = std::make_pair(0, nullptr);
+    --num_mailboxes;
+    if (slots.size() > MIN_MAILBOX_TABLE_SLOTS && 8 * num_mailboxes < slots.size()) {
+        resize(slots.size() / 2);
+    }
+}
+
+void mailbox_manager_t::mailbox_table_t::resize(size_t new_num_slots) {
+    std::vector<std::pair<raw_mailbox_t::id_t, raw_mailbox_t *> > old_slots(
+        new_num_slots, std::make_pair(0, nullptr));
+    old_slots.swap(slots);
+    num_mailboxes = 0;
+    for (const auto &pair : old_slots) {
+        if (pair.first != 0) {
+            insert(pair.first, pair.second);
+        }
+    }
+}
+
+// We only keep buffers that are small enough, so that the pools don't hold on to a lot
+// of memory after a burst of large messages.
+static const size_t MAX_POOLED_RECEIVE_BUFFER_SIZE = 64 * KILOBYTE;
+static const size_t MAX_POOLED_RECEIVE_BUFFERS_PER_THREAD = 32;
+
+std::vector<char> mailbox_manager_t::take_receive_buffer() {
+    std::vector<std::vector<char> > *pool = receive_buffers.get();
+    std::vector<char> buffer;
+    if (!pool->empty()) {
+        buffer.swap(pool->back());
+        pool->pop_back();
+    }
+    return buffer;
+}
+
+void mailbox_manager_t::return_receive_buffer(std::vector<char> &&buffer) {
+    std::vector<std::vector<char> > *pool = receive_buffers.get();
+    if (buffer.capacity() <= MAX_POOLED_RECEIVE_BUFFER_SIZE
+        && pool->size() < MAX_POOLED_RECEIVE_BUFFERS_PER_THREAD) {
+        buffer.clear();
+        pool->push_back(std::move(buffer));
     }
 }
 
@@ -226,7 +343,7 @@ void mailbox_manager_t::on_message(
 
     // Read the data from the read stream, so it can be deallocated before we continue
     // in a coroutine
-    std::vector<char> stream_data;
+    std::vector<char> stream_data = take_receive_buffer();
     stream_data.resize(mbox_header.data_length);
     int64_t bytes_read = force_read(stream, stream_data.data(), mbox_header.data_length);
     if (bytes_read != static_cast<int64_t>(mbox_header.data_length)) {
@@ -280,6 +397,12 @@ void mailbox_manager_t::mailbox_read_coroutine(
             logWRN("Received an invalid cluster message from a peer.");
         }
     }
+
+    // We're back on the thread that received the message.
+    std::vector<char> buffer;
+    int64_t unused_offset;
+    stream.swap(&buffer, &unused_offset);
+    return_receive_buffer(std::move(buffer));
 }
 
 raw_mailbox_t::id_t mailbox_manager_t::generate_mailbox_id() {
@@ -289,17 +412,12 @@ raw_mailbox_t::id_t mailbox_manager_t::generate_mailbox_id() {
 
 raw_mailbox_t::id_t mailbox_manager_t::register_mailbox(raw_mailbox_t *mb) {
     raw_mailbox_t::id_t id = generate_mailbox_id();
-    std::map<raw_mailbox_t::id_t, raw_mailbox_t *> *mailboxes =
-        &mailbox_tables.get()->mailboxes;
-    std::pair<std::map<raw_mailbox_t::id_t, raw_mailbox_t *>::iterator, bool> res
-        = mailboxes->insert(std::make_pair(id, mb));
-    guarantee(res.second);  // Assert a new element was inserted.
+    mailbox_tables.get()->insert(id, mb);
     return id;
 }
 
 void mailbox_manager_t::unregister_mailbox(raw_mailbox_t::id_t id) {
-    size_t num_elements_erased = mailbox_tables.get()->mailboxes.erase(id);
-    guarantee(num_elements_erased == 1);
+    mailbox_tables.get()->erase(id);
 }
 
 disconnect_watcher_t::disconnect_watcher_t(mailbox_manager_t *mailbox_manager,
@@ -3,7 +3,9 @@
 #define RPC_MAILBOX_MAILBOX_HPP_
 
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "backtrace.hpp"
@@ -41,6 +43,15 @@ public:
         signal_t *interruptor) = 0;
 };
 
+/* `mailbox_local_message_t` is a message that is delivered to a mailbox on the same
+thread that sent it. It hands its contents to the mailbox's read callback directly
+instead of going through a stream. */
+class mailbox_local_message_t {
+public:
+    virtual ~mailbox_local_message_t() { }
+    virtual void deliver(mailbox_read_callback_t *callback, signal_t *interruptor) = 0;
+};
+
 struct raw_mailbox_t : public home_thread_mixin_t {
 public:
     struct address_t;
@@ -54,6 +65,8 @@ private:
     friend class mailbox_manager_t;
     friend class raw_mailbox_writer_t;
     friend void send_write(mailbox_manager_t *, address_t, mailbox_write_callback_t *);
+    friend void send_local(mailbox_manager_t *, address_t,
+                           const std::shared_ptr<mailbox_local_message_t> &);
 
     mailbox_manager_t *manager;
 
@@ -99,6 +112,10 @@ public:
 
     private:
         friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+        friend bool is_on_this_thread(mailbox_manager_t *,
+                                      const raw_mailbox_t::address_t &);
+        friend void send_local(mailbox_manager_t *, raw_mailbox_t::address_t,
+                               const std::shared_ptr<mailbox_local_message_t> &);
         friend struct raw_mailbox_t;
         friend class mailbox_manager_t;
 
@@ -133,6 +150,17 @@ void send_write(mailbox_manager_t *src,
                 raw_mailbox_t::address_t dest,
                 mailbox_write_callback_t *callback);
 
+/* `is_on_this_thread()` returns `true` if `dest` lives on this server and on the
+calling thread. */
+bool is_on_this_thread(mailbox_manager_t *src, const raw_mailbox_t::address_t &dest);
+
+/* `send_local()` is like `send_write()`, but for mailboxes for which
+`is_on_this_thread()` is `true`. The message doesn't get serialized; instead, a new
+coroutine hands it to the mailbox once the caller yields. */
+void send_local(mailbox_manager_t *src,
+                raw_mailbox_t::address_t dest,
+                const std::shared_ptr<mailbox_local_message_t> &message);
+
 /* `mailbox_manager_t` is a `cluster_message_handler_t` that takes care
 of actually routing messages to mailboxes. */
 
@@ -144,17 +172,34 @@ public:
 private:
     friend struct raw_mailbox_t;
     friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+    friend void send_local(mailbox_manager_t *, raw_mailbox_t::address_t,
+                           const std::shared_ptr<mailbox_local_message_t> &);
 
+    /* Every incoming message gets looked up here, so rather than a `std::map` this
+    is an open-addressing hash table with linear probing. Mailbox ids are never reused
+    and never 0, so 0 marks an empty slot. The number of slots is a power of two, and
+    at most half of them are in use. */
     struct mailbox_table_t {
         mailbox_table_t();
         ~mailbox_table_t();
         raw_mailbox_t::id_t next_mailbox_id;
-        // TODO: use a buffered structure to reduce dynamic allocation
-        std::map<raw_mailbox_t::id_t, raw_mailbox_t *> mailboxes;
-        raw_mailbox_t *find_mailbox(raw_mailbox_t::id_t);
+        raw_mailbox_t *find_mailbox(raw_mailbox_t::id_t id) const;
+        void insert(raw_mailbox_t::id_t id, raw_mailbox_t *mailbox);
+        void erase(raw_mailbox_t::id_t id);
+    private:
+        size_t home_slot(raw_mailbox_t::id_t id) const;
+        void resize(size_t new_num_slots);
+        std::vector<std::pair<raw_mailbox_t::id_t, raw_mailbox_t *> > slots;
+        size_t num_mailboxes;
     };
     one_per_thread_t<mailbox_table_t> mailbox_tables;
 
+    /* The buffers that received messages are read into. We keep a few around on each
+    thread, so that a message doesn't usually cost an allocation. */
+    one_per_thread_t<std::vector<std::vector<char> > > receive_buffers;
+    std::vector<char> take_receive_buffer();
+    void return_receive_buffer(std::vector<char> &&buffer);
+
     /* We must acquire one of these semaphores whenever we want to send a message over a
     mailbox. This prevents mailbox messages from starving directory and semilattice
     messages. */
@@ -3,6 +3,7 @@
 #define RPC_MAILBOX_TYPED_HPP_
 
 #include <functional>
+#include <memory>
 #include <tuple>
 
 #include "containers/archive/versioned.hpp"
@@ -12,6 +13,7 @@
 #include "rpc/semilattice/joins/macros.hpp"
 
 template <class...> class mailbox_t;
+template <class...> class mailbox_local_message_impl_t;
 
 template <class... Args>
 class mailbox_addr_t {
@@ -53,6 +55,8 @@ class mailbox_t {
         mailbox_t<Args...> *parent;
     };
 
+    template <class...> friend class mailbox_local_message_impl_t;
+
     read_impl_t reader;
 public:
     typedef mailbox_addr_t<Args...> address_t;
@@ -99,8 +103,30 @@ public:
 #endif
 };
 
+template <class... Args>
+class mailbox_local_message_impl_t : public mailbox_local_message_t {
+public:
+    explicit mailbox_local_message_impl_t(const Args &... _args) : args(_args...) { }
+    void deliver(mailbox_read_callback_t *callback, signal_t *interruptor) {
+        /* The address had type `mailbox_addr_t<Args...>`, so the mailbox must be a
+        `mailbox_t<Args...>`. */
+        static_cast<typename mailbox_t<Args...>::read_impl_t *>(callback)->read_helper(
+            interruptor, std::move(args), make_rindex_sequence<sizeof...(Args)>());
+    }
+private:
+    std::tuple<Args...> args;
+};
+
 template <class... Args>
 void send(mailbox_manager_t *src, mailbox_addr_t<Args...> dest, const Args &... args) {
+    if (is_on_this_thread(src, dest.addr)) {
+        /* Copying the arguments is much cheaper than serializing and deserializing
+        them. We can't do this across threads, because many of the types we send
+        aren't safe to share between threads. */
+        send_local(src, dest.addr,
+            std::make_shared<mailbox_local_message_impl_t<Args...> >(args...));
+        return;
+    }
     mailbox_write_impl<Args...> writer(args...);
     send_write(src, dest.addr, &writer);
 }
@@ -1,8 +1,19 @@
 #include "serializer/checksum.hpp"
 
+#include <algorithm>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CHECKSUM_X86_KERNELS 1
+#else
+#define CHECKSUM_X86_KERNELS 0
+#endif
+
+namespace {
+
 // The return value of this function or its behavior can't be changed -- the on-disk
 // format obviously requires a specific checksum algorithm.
-serializer_checksum compute_checksum(const void *word32s, size_t wordcount) {
+serializer_checksum compute_checksum_scalar(const void *word32s, size_t wordcount) {
     const uint32_t *p = static_cast<const uint32_t *>(word32s);
 
     // This is the Fletcher-64 algorithm, applied to the input whose words are xored with
@@ -29,8 +40,10 @@ serializer_checksum compute_checksum(const void *word32s, size_t wordcount) {
 
     // We go through a minor shenanigan here to handle very large buffers.
     for (;;) {
-        // 0xFFFFul is low enough that a and b can't overflow.
-        const size_t n = wordcount & 0xFFFFul;
+        // 0xFFFFul is low enough that a and b can't overflow.  (This used to be
+        // `wordcount & 0xFFFFul`, which never terminated once the remaining count was
+        // a positive multiple of 0x10000.)
+        const size_t n = std::min<size_t>(wordcount, 0xFFFFul);
 
         // At this point, a and b are <= 0x1_FFFF_FFFE and non-zero.
 
@@ -60,6 +73,165 @@ serializer_checksum compute_checksum(const void *word32s, size_t wordcount) {
     return serializer_checksum{(b << 32) | a};
 }
 
+#if CHECKSUM_X86_KERNELS
+
+/* The vectorized kernels compute the same two sums, but keep one running sum per
+vector lane.  The scalar kernel's output only depends on A and B modulo 2**32 - 1 (it
+never outputs zero, so the residue 0 comes out as 0xFFFFFFFF), so we are free to
+reduce the sums whenever it's convenient.
+
+After k iterations over vectors v_0, ..., v_(k-1) of L words each, lane l holds
+s_l = sum_j v_j[l] and p_l = sum_j (k - j) v_j[l].  The B contribution of those
+n = k * L words is then sum_l (L * p_l - l * s_l). */
+
+const uint64_t FLETCHER_MOD = 0xFFFFFFFFull;
+
+// p_l is at most k * (k + 1) / 2 * 0xFFFFFFFF, which must fit in 64 bits.
+const size_t MAX_VECTOR_ITERATIONS = 0x8000;
+
+class fletcher_state_t {
+public:
+    // Starting from 0xFFFFFFFF is the same as starting from 0.
+    fletcher_state_t() : a(0), b(0) { }
+
+    void add_lanes(const uint64_t *s, const uint64_t *p, size_t lanes,
+                   size_t iterations) {
+        uint64_t sum = 0;
+        uint64_t weighted = 0;
+        for (size_t l = 0; l < lanes; ++l) {
+            const uint64_t s_mod = s[l] % FLETCHER_MOD;
+            sum += s_mod;
+            weighted += lanes * (p[l] % FLETCHER_MOD) + l * (FLETCHER_MOD - s_mod);
+        }
+        const uint64_t n = lanes * iterations;
+        b = (b + n * a + weighted % FLETCHER_MOD) % FLETCHER_MOD;
+        a = (a + sum) % FLETCHER_MOD;
+    }
+
+    // For the few words left over at the end.
+    void add_words(const uint32_t *words, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            a = (a + (words[i] ^ 1u)) % FLETCHER_MOD;
+            b = (b + a) % FLETCHER_MOD;
+        }
+    }
+
+    serializer_checksum result() const {
+        const uint64_t a_out = a == 0 ? FLETCHER_MOD : a;
+        const uint64_t b_out = b == 0 ? FLETCHER_MOD : b;
+        return serializer_checksum{(b_out << 32) | a_out};
+    }
+
+private:
+    uint64_t a;
+    uint64_t b;
+};
+
+const size_t SSE2_LANES = 4;
+
+serializer_checksum compute_checksum_sse2(const void *word32s, size_t wordcount) {
+    const uint32_t *words = static_cast<const uint32_t *>(word32s);
+    fletcher_state_t state;
+
+    const __m128i xorer = _mm_set1_epi32(1);
+    const __m128i zero = _mm_setzero_si128();
+    while (wordcount >= SSE2_LANES) {
+        const size_t k = std::min(wordcount / SSE2_LANES, MAX_VECTOR_ITERATIONS);
+        // Lanes 0 and 1 live in s_lo and p_lo, lanes 2 and 3 in s_hi and p_hi.
+        __m128i s_lo = zero, s_hi = zero, p_lo = zero, p_hi = zero;
+        for (size_t i = 0; i < k; ++i) {
+            const __m128i v = _mm_xor_si128(
+                _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(words + i * SSE2_LANES)),
+                xorer);
+            s_lo = _mm_add_epi64(s_lo, _mm_unpacklo_epi32(v, zero));
+            s_hi = _mm_add_epi64(s_hi, _mm_unpackhi_epi32(v, zero));
+            p_lo = _mm_add_epi64(p_lo, s_lo);
+            p_hi = _mm_add_epi64(p_hi, s_hi);
+        }
+        uint64_t s[SSE2_LANES], p[SSE2_LANES];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(s), s_lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(s + 2), s_hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), p_lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 2), p_hi);
+        state.add_lanes(s, p, SSE2_LANES, k);
+
+        words += k * SSE2_LANES;
+        wordcount -= k * SSE2_LANES;
+    }
+    state.add_words(words, wordcount);
+    return state.result();
+}
+
+const size_t AVX2_LANES = 8;
+
+__attribute__((target("avx2")))
+serializer_checksum compute_checksum_avx2(const void *word32s, size_t wordcount) {
+    const uint32_t *words = static_cast<const uint32_t *>(word32s);
+    fletcher_state_t state;
+
+    const __m256i xorer = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+    while (wordcount >= AVX2_LANES) {
+        const size_t k = std::min(wordcount / AVX2_LANES, MAX_VECTOR_ITERATIONS);
+        // Lanes 0-3 live in s_lo and p_lo, lanes 4-7 in s_hi and p_hi.
+        __m256i s_lo = zero, s_hi = zero, p_lo = zero, p_hi = zero;
+        for (size_t i = 0; i < k; ++i) {
+            const __m256i v = _mm256_xor_si256(
+                _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(words + i * AVX2_LANES)),
+                xorer);
+            s_lo = _mm256_add_epi64(
+                s_lo, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+            s_hi = _mm256_add_epi64(
+                s_hi, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+            p_lo = _mm256_add_epi64(p_lo, s_lo);
+            p_hi = _mm256_add_epi64(p_hi, s_hi);
+        }
+        uint64_t s[AVX2_LANES], p[AVX2_LANES];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(s), s_lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(s + 4), s_hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), p_lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p + 4), p_hi);
+        state.add_lanes(s, p, AVX2_LANES, k);
+
+        words += k * AVX2_LANES;
+        wordcount -= k * AVX2_LANES;
+    }
+    state.add_words(words, wordcount);
+    return state.result();
+}
+
+#endif  // CHECKSUM_X86_KERNELS
+
+typedef serializer_checksum (*checksum_fn_t)(const void *, size_t);
+
+checksum_fn_t pick_checksum_kernel() {
+    std::vector<checksum_kernel_t> kernels = available_checksum_kernels();
+    // The last one is the fastest.
+    return kernels.back().fn;
+}
+
+}  // namespace
+
+std::vector<checksum_kernel_t> available_checksum_kernels() {
+    std::vector<checksum_kernel_t> kernels;
+    kernels.push_back(checksum_kernel_t{"scalar", &compute_checksum_scalar});
+#if CHECKSUM_X86_KERNELS
+    // SSE2 is part of x86-64.
+    kernels.push_back(checksum_kernel_t{"sse2", &compute_checksum_sse2});
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(checksum_kernel_t{"avx2", &compute_checksum_avx2});
+    }
+#endif
+    return kernels;
+}
+
+serializer_checksum compute_checksum(const void *word32s, size_t wordcount) {
+    static const checksum_fn_t kernel = pick_checksum_kernel();
+    return kernel(word32s, wordcount);
+}
+
 serializer_checksum compute_checksum_concat(serializer_checksum left,
                                             serializer_checksum right,
                                             uint64_t right_wordcount) {
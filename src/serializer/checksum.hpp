@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include "arch/compiler.hpp"
 
 // A valid checksum can never be zero, or have a zero-valued 32-bit word.  If value &
@@ -22,6 +24,17 @@ ATTR_PACKED(struct serializer_checksum {
 // The checksum is never zero.
 serializer_checksum compute_checksum(const void *word32s, size_t wordcount);
 
+// One implementation of `compute_checksum`.  All of them produce exactly the same
+// values; `compute_checksum` uses the fastest one the CPU supports.
+struct checksum_kernel_t {
+    const char *name;
+    serializer_checksum (*fn)(const void *word32s, size_t wordcount);
+};
+
+// The kernels that can run on this CPU, the plain C++ one first.  Used by tests and
+// benchmarks.
+std::vector<checksum_kernel_t> available_checksum_kernels();
+
 // Combines checksums into the checksum of the concatenated buffer.  Given two buffers,
 // s, and t, serializer_checksum_concat(serializer_checksum(s), serializer_checksum(t),
 // t.wordcount) computes serializer_checksum(concat(s, t)).
@@ -0,0 +1,59 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "serializer/log/block_compression.hpp"
+
+#include <zlib.h>
+
+#include "errors.hpp"
+#include "math.hpp"
+
+buf_ptr_t compress_block(const ser_buffer_t *buf, block_size_t block_size) {
+    const uint16_t aligned_size = buf_ptr_t::compute_aligned_block_size(block_size);
+    if (aligned_size <= DEVICE_BLOCK_SIZE) {
+        return buf_ptr_t();
+    }
+    // Anything that doesn't fit into this many bytes still takes up as many device
+    // blocks as the uncompressed block, so we let zlib fail on it.
+    const uint16_t max_ser_size = aligned_size - DEVICE_BLOCK_SIZE;
+    if (max_ser_size <= sizeof(ls_buf_data_t)) {
+        return buf_ptr_t();
+    }
+
+    buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(
+        block_size_t::unsafe_make(max_ser_size));
+    uLongf compressed_size = max_ser_size - sizeof(ls_buf_data_t);
+    // The fastest level gets most of the benefit on btree nodes, and this runs on
+    // every block write.
+    const int res = compress2(reinterpret_cast<Bytef *>(ret.cache_data()),
+                              &compressed_size,
+                              reinterpret_cast<const Bytef *>(buf->cache_data),
+                              block_size.value(),
+                              Z_BEST_SPEED);
+    if (res != Z_OK) {
+        // We only expect Z_BUF_ERROR, which means the block didn't compress well.
+        guarantee(res == Z_BUF_ERROR, "compress2 failed with error %d", res);
+        return buf_ptr_t();
+    }
+
+    ret.ser_buffer()->ser_header = buf->ser_header;
+    ret.resize_fill_zero(
+        block_size_t::unsafe_make(sizeof(ls_buf_data_t) + compressed_size));
+    return ret;
+}
+
+buf_ptr_t decompress_block(const ser_buffer_t *buf,
+                           block_size_t compressed_block_size,
+                           block_size_t block_size) {
+    buf_ptr_t ret = buf_ptr_t::alloc_uninitialized(block_size);
+    ret.ser_buffer()->ser_header = buf->ser_header;
+    uLongf size = block_size.value();
+    const int res = uncompress(reinterpret_cast<Bytef *>(ret.cache_data()),
+                               &size,
+                               reinterpret_cast<const Bytef *>(buf->cache_data),
+                               compressed_block_size.value());
+    guarantee(res == Z_OK && size == block_size.value(),
+              "Could not decompress block %" PRIu64 " (zlib error %d).  The "
+              "database file is corrupted.",
+              buf->ser_header.block_id, res);
+    ret.fill_padding_zero();
+    return ret;
+}
@@ -0,0 +1,27 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_LOG_BLOCK_COMPRESSION_HPP_
+#define SERIALIZER_LOG_BLOCK_COMPRESSION_HPP_
+
+#include "serializer/buf_ptr.hpp"
+#include "serializer/types.hpp"
+
+/* When compression is enabled in `log_serializer_dynamic_config_t`, blocks get
+stored as their `ls_buf_data_t` header followed by the deflated cache data.  The LBA
+remembers the block's uncompressed size, which is how we know that a block has to be
+inflated after reading it.
+
+Compression only pays off if the block ends up taking fewer device blocks on disk,
+so `compress_block` gives up on blocks that wouldn't shrink by at least one
+DEVICE_BLOCK_SIZE. */
+
+// Returns the compressed version of `buf`, or an empty `buf_ptr_t` if compressing
+// it wouldn't save any space on disk.
+buf_ptr_t compress_block(const ser_buffer_t *buf, block_size_t block_size);
+
+// Inflates a block produced by `compress_block`.  `block_size` is the size `buf` had
+// before it was compressed.  Crashes if the block is corrupted.
+buf_ptr_t decompress_block(const ser_buffer_t *buf,
+                           block_size_t compressed_block_size,
+                           block_size_t block_size);
+
+#endif  // SERIALIZER_LOG_BLOCK_COMPRESSION_HPP_
@@ -17,6 +17,8 @@ struct log_serializer_dynamic_config_t {
         // This is probably too low, thanks to status quo bias (the status quo having
         // been to never compute checksums).
         checksum_threshold = 65536;
+        compress_blocks = false;
+        metablock_group_commit_delay_ms = 0;
     }
 
     /* Enable reading more data than requested to let the cache warmup more quickly
@@ -26,6 +28,13 @@ struct log_serializer_dynamic_config_t {
        writing the serializer superblock.  Designed to make single-document writes
        fast. */
     uint32_t checksum_threshold;
+    /* Compress blocks before writing them, when that makes them take up fewer device
+       blocks.  Files can always be read regardless of this setting. */
+    bool compress_blocks;
+    /* How long an index write may wait for others to share its metablock write with,
+    on top of waiting for the previous metablock write.  Trades commit latency for
+    fewer fdatasyncs under many small concurrent writes. */
+    uint32_t metablock_group_commit_delay_ms;
 };
 
 /* This is equivalent to log_serializer_static_config_t below, but is an on-disk
@@ -13,6 +13,7 @@
 #include "errors.hpp"
 #include "perfmon/perfmon.hpp"
 #include "serializer/buf_ptr.hpp"
+#include "serializer/log/block_compression.hpp"
 #include "serializer/log/log_serializer.hpp"
 #include "stl_utils.hpp"
 
@@ -23,9 +24,6 @@ const int64_t APPROXIMATE_READ_AHEAD_SIZE = 32 * DEFAULT_BTREE_BLOCK_SIZE;
  * GC Parameters *
  *****************/
 
-// How many GC routines to launch concurrently, at maximum
-const size_t MAX_CONCURRENT_GCS = 64;
-
 // Garbage Collection uses its own two IO accounts.
 // There is one low-priority account that is meant to guarantee
 // (performance-wise) unintrusive garbage collection.
@@ -38,13 +36,7 @@ const int GC_IO_PRIORITY_NICE = 8;
 // 4 times the priority of all caches combined
 const int GC_IO_PRIORITY_HIGH = 4 * MERGER_BLOCK_WRITE_IO_PRIORITY;
 
-// The ratio at which we start GCing.
-constexpr double GC_START_RATIO = 0.1;
-// The ratio at which we don't want to keep GC'ing.
-constexpr double GC_STOP_RATIO = 0.05;
-// The ratio at which we start taking more serious measures to get the garbage
-// rate down.
-constexpr double GC_HIGH_RATIO = 0.3;
+// See gc_scheduler.cc for the ratios at which we start and stop GCing.
 
 // What's the maximum number of "young" extents we can have?
 const size_t GC_YOUNG_EXTENT_MAX_SIZE = 50;
@@ -409,6 +401,9 @@ data_block_manager_t::data_block_manager_t(
       gc_index_write_semaphore(1),
       gc_stats(stats)
 {
+    for (size_t i = 0; i < NUM_WRITE_CLASSES; ++i) {
+        active_extents[i] = nullptr;
+    }
     rassert(static_config != nullptr);
     rassert(extent_manager != nullptr);
     rassert(serializer != nullptr);
@@ -468,7 +463,7 @@ void data_block_manager_t::start_existing(
             reconstructed_extents.push_back(e);
         }
 
-        active_extent = entries.get(offset / extent_manager->extent_size);
+        gc_entry_t *active_extent = entries.get(offset / extent_manager->extent_size);
         guarantee(active_extent != nullptr);
 
         /* Turn the extent from a reconstructing extent into an active extent */
@@ -476,9 +471,10 @@ void data_block_manager_t::start_existing(
         reconstructed_extents.remove(active_extent);
 
         active_extent->make_active();
-    } else {
-        active_extent = nullptr;
+        active_extents[static_cast<size_t>(write_class_t::foreground)] = active_extent;
     }
+    /* The metablock only remembers the foreground's active extent.  Any extent that
+    the GC was writing to is treated like an old extent below. */
 
     /* Convert any extents that we found live blocks in, but that are not active
     extents, into old extents */
@@ -663,16 +659,23 @@ public:
                     continue;
                 }
 
-                const block_size_t block_size
-                    = block_size_t::unsafe_make(info.ser_block_size);
-                buf_ptr_t buf = buf_ptr_t::alloc_uninitialized(block_size);
-                memcpy(buf.ser_buffer(), current_buf, info.ser_block_size);
-                buf.fill_padding_zero();
+                const block_size_t disk_block_size = info.disk_block_size();
                 guarantee(info.ser_block_size <= *(lower_it + 1) - *lower_it);
+                buf_ptr_t buf;
+                if (info.uncompressed_ser_block_size != 0) {
+                    buf = decompress_block(
+                        reinterpret_cast<const ser_buffer_t *>(current_buf),
+                        disk_block_size, info.block_size());
+                } else {
+                    buf = buf_ptr_t::alloc_uninitialized(disk_block_size);
+                    memcpy(buf.ser_buffer(), current_buf, info.ser_block_size);
+                    buf.fill_padding_zero();
+                }
 
                 counted_t<block_token_t> token
                     = parent->serializer->generate_block_token(current_offset,
-                                                               block_size);
+                                                               disk_block_size,
+                                                               info.block_size());
 
                 parent->serializer->offer_buf_to_read_ahead_callbacks(
                         block_id,
@@ -740,16 +743,24 @@ buf_ptr_t data_block_manager_t::read(int64_t off_in, block_size_t block_size,
 std::vector<counted_t<block_token_t>>
 data_block_manager_t::many_writes(const buf_write_info_t *writes,
                                   size_t writes_count,
+                                  write_class_t write_class,
                                   file_account_t *io_account,
                                   iocallback_t *cb) {
     // These tokens are grouped by extent.  You can do a contiguous write in each
     // extent.
     uint64_t cumulative_aligned_size;
     std::vector<std::vector<counted_t<block_token_t>>> token_groups
-        = gimme_some_new_offsets(writes, writes_count, &cumulative_aligned_size);
+        = gimme_some_new_offsets(writes, writes_count, write_class,
+                                 &cumulative_aligned_size);
     const bool wants_checksum
         = cumulative_aligned_size <= serializer->dynamic_config.checksum_threshold;
 
+    if (write_class == write_class_t::gc) {
+        stats->pm_serializer_gc_written_block_bytes += cumulative_aligned_size;
+    } else {
+        stats->pm_serializer_foreground_written_block_bytes += cumulative_aligned_size;
+    }
+
     for (size_t i = 0; i < writes_count; ++i) {
         writes[i].buf->ser_header.block_id = writes[i].block_id;
     }
@@ -778,7 +789,7 @@ data_block_manager_t::many_writes(const buf_write_info_t *writes,
     for (const std::vector<counted_t<block_token_t>> &group : token_groups) {
         const int64_t front_offset = group.front()->offset();
         const int64_t back_offset = group.back()->offset()
-            + gc_entry_t::aligned_value(group.back()->block_size());
+            + gc_entry_t::aligned_value(group.back()->disk_block_size());
 
         guarantee(divides(DEVICE_BLOCK_SIZE, front_offset));
 
@@ -792,7 +803,7 @@ data_block_manager_t::many_writes(const buf_write_info_t *writes,
         for (size_t j = 0, je = group.size(); j < je; ++j) {
             block_token_t *token = group[j].get();
             const int64_t j_offset = token->offset();
-            const block_size_t j_block_size = token->block_size();
+            const block_size_t j_block_size = token->disk_block_size();
             guarantee(j_offset == last_written_offset);
             const size_t j_aligned_size = gc_entry_t::aligned_value(j_block_size);
             total_aligned_size += j_aligned_size;
@@ -838,6 +849,90 @@ data_block_manager_t::many_writes(const buf_write_info_t *writes,
     return ret;
 }
 
+std::vector<counted_t<block_token_t>>
+data_block_manager_t::many_foreground_writes(const buf_write_info_t *writes,
+                                             size_t writes_count,
+                                             file_account_t *io_account,
+                                             iocallback_t *cb) {
+    std::vector<size_t> class_indices[NUM_WRITE_CLASSES];
+    for (size_t i = 0; i < writes_count; ++i) {
+        const write_class_t write_class = classify_foreground_write(writes[i].block_id);
+        class_indices[static_cast<size_t>(write_class)].push_back(i);
+    }
+    stats->pm_serializer_cold_block_writes
+        += class_indices[static_cast<size_t>(write_class_t::foreground_cold)].size();
+
+    for (size_t c = 0; c < NUM_WRITE_CLASSES; ++c) {
+        if (class_indices[c].size() == writes_count) {
+            return many_writes(writes, writes_count, static_cast<write_class_t>(c),
+                               io_account, cb);
+        }
+    }
+
+    struct split_cb_t : public iocallback_t {
+        void on_io_complete() {
+            --ops_remaining;
+            if (ops_remaining == 0) {
+                iocallback_t *local_cb = cb;
+                delete this;
+                local_cb->on_io_complete();
+            }
+        }
+
+        size_t ops_remaining;
+        iocallback_t *cb;
+    };
+
+    split_cb_t *const split_cb = new split_cb_t;
+    // We add 1 so that split_cb can't fire before we've issued all the writes.
+    split_cb->ops_remaining = 1;
+    split_cb->cb = cb;
+
+    std::vector<counted_t<block_token_t>> ret(writes_count);
+    for (size_t c = 0; c < NUM_WRITE_CLASSES; ++c) {
+        const std::vector<size_t> &indices = class_indices[c];
+        if (indices.empty()) {
+            continue;
+        }
+        std::vector<buf_write_info_t> class_writes;
+        class_writes.reserve(indices.size());
+        for (size_t i : indices) {
+            class_writes.push_back(writes[i]);
+        }
+        ++split_cb->ops_remaining;
+        std::vector<counted_t<block_token_t>> tokens
+            = many_writes(class_writes.data(), class_writes.size(),
+                          static_cast<write_class_t>(c), io_account, split_cb);
+        guarantee(tokens.size() == indices.size());
+        for (size_t j = 0; j < indices.size(); ++j) {
+            ret[indices[j]] = std::move(tokens[j]);
+        }
+    }
+    split_cb->on_io_complete();
+
+    return ret;
+}
+
+data_block_manager_t::write_class_t
+data_block_manager_t::classify_foreground_write(block_id_t block_id) {
+    const flagged_off64_t offset = serializer->lba_index->get_block_offset(block_id);
+    if (!offset.has_value()) {
+        // A new block.  We don't know anything about it, so it goes with the other
+        // recently written blocks.
+        return write_class_t::foreground;
+    }
+    const gc_entry_t *entry
+        = entries.get(static_config->extent_index(offset.get_value()));
+    // Old extents have been around for longer than GC_YOUNG_EXTENT_TIMELIMIT, or
+    // more than GC_YOUNG_EXTENT_MAX_SIZE extents have been written since.
+    if (entry != nullptr
+        && (entry->state == gc_entry_t::state_old
+            || entry->state == gc_entry_t::state_in_gc)) {
+        return write_class_t::foreground_cold;
+    }
+    return write_class_t::foreground;
+}
+
 void data_block_manager_t::destroy_entry(gc_entry_t *entry) {
     rassert(entry != nullptr);
     entry->destroy();
@@ -851,6 +946,7 @@ void data_block_manager_t::check_and_handle_empty_extent(uint64_t extent_id) {
 
     if (entry->all_garbage() && entry->state != gc_entry_t::state_active) {
         /* Every block in the extent is now garbage. */
+        gc_scheduler.note_reclaimed(static_config->extent_size(), get_ticks());
         switch (entry->state) {
             case gc_entry_t::state_reconstructing:
                 unreachable("Marking something as garbage during startup.");
@@ -902,56 +998,32 @@ void data_block_manager_t::check_and_handle_empty_extent(uint64_t extent_id) {
 }
 
 size_t data_block_manager_t::compute_gc_concurrency() const {
-    // Ok, what we do here is the following:
-    // As long as the GC ratio is not increasing, i.e. below GC_START_RATIO,
-    // we only start 1 GC coroutine.
-    // When it turns out that the GC ratio has increased since we have started
-    // GCing, we linearly increase the number of concurrent GCs, until reaching
-    // the maximum at GC_HIGH_RATIO.
-    // (If the GC ratio still keeps growing at that point, there's probably
-    // not much we can do. Unless we would be ok with throttling writes.)
-    //
     // Also see `choose_gc_io_account()` for the second component in the automatic
     // GC scaling process.
-
-    CT_ASSERT(GC_HIGH_RATIO > GC_START_RATIO);
-    CT_ASSERT(GC_START_RATIO > GC_STOP_RATIO);
-
-    const double gc_ratio = garbage_ratio();
-    if (gc_ratio < GC_START_RATIO) {
-        return 1;
-    } else if (gc_ratio >= GC_HIGH_RATIO) {
-        return MAX_CONCURRENT_GCS;
-    } else {
-        rassert(gc_ratio >= GC_START_RATIO);
-        rassert(gc_ratio < GC_HIGH_RATIO);
-        rassert(GC_HIGH_RATIO - GC_START_RATIO > 0.0);
-        double linear_factor = (gc_ratio - GC_START_RATIO)
-            / (GC_HIGH_RATIO - GC_START_RATIO);
-        size_t total_concurrency =
-            1 + static_cast<size_t>(linear_factor * MAX_CONCURRENT_GCS);
-        // std::min to avoid rounding errors leading to illegal return values
-        return std::min(total_concurrency, MAX_CONCURRENT_GCS);
-    }
+    return gc_scheduler.concurrency(garbage_ratio(), get_ticks());
 }
 
 file_account_t *data_block_manager_t::choose_gc_io_account() {
-    // Start going into high priority as soon as the garbage ratio is more than
-    // GC_HIGH_RATIO.
-    // The idea is that we use the nice i/o account whenever possible, except
-    // if it proves insufficient to maintain an acceptable garbage ratio, in
-    // which case we switch over to the high priority account until the situation
-    // has improved.
-
-    // Note that this means that we can end up oscillating between both accounts,
-    // which is fine.
-    if (garbage_ratio() > GC_HIGH_RATIO) {
+    if (gc_scheduler.wants_high_priority(garbage_ratio(), get_ticks())) {
         return gc_io_account_high.get();
     } else {
         return gc_io_account_nice.get();
     }
 }
 
+void data_block_manager_t::note_foreground_read(ticks_t latency) {
+    gc_scheduler.note_foreground_read(latency);
+}
+
+void data_block_manager_t::note_new_garbage(gc_entry_t *entry,
+                                            unsigned int block_index) {
+    const int64_t bytes = gc_entry_t::aligned_value(entry->block_size(block_index));
+    if (entry->state == gc_entry_t::state_old) {
+        gc_stats.old_garbage_block_bytes += bytes;
+    }
+    gc_scheduler.note_garbage(bytes, get_ticks());
+}
+
 void data_block_manager_t::mark_garbage(int64_t offset, extent_transaction_t *txn) {
     uint64_t extent_id = static_config->extent_index(offset);
     gc_entry_t *entry = entries.get(extent_id);
@@ -966,8 +1038,8 @@ void data_block_manager_t::mark_garbage(int64_t offset, extent_transaction_t *tx
 
     // Add to old garbage count if necessary (works because of the
     // !entry->block_is_garbage(block_index) assertion above).
-    if (entry->state == gc_entry_t::state_old && entry->block_is_garbage(block_index)) {
-        gc_stats.old_garbage_block_bytes += gc_entry_t::aligned_value(entry->block_size(block_index));
+    if (entry->block_is_garbage(block_index)) {
+        note_new_garbage(entry, block_index);
     }
 
     check_and_handle_empty_extent(extent_id);
@@ -996,9 +1068,8 @@ void data_block_manager_t::mark_garbage_tokenwise_with_offset(int64_t offset) {
 
     // Add to old garbage count if necessary (works because of the
     // !entry->block_is_garbage(block_index) assertion above).
-    if (entry->state == gc_entry_t::state_old && entry->block_is_garbage(block_index)) {
-        gc_stats.old_garbage_block_bytes
-            += gc_entry_t::aligned_value(entry->block_size(block_index));
+    if (entry->block_is_garbage(block_index)) {
+        note_new_garbage(entry, block_index);
     }
 
     check_and_handle_empty_extent(extent_id);
@@ -1139,7 +1210,7 @@ void data_block_manager_t::gc_one_extent(gc_state_t *gc_state) {
                                 gc_blocks.get() + current_interval_begin,
                                 choose_gc_io_account(),
                                 &read_cb);
-                        total_bytes_read += current_interval_end - current_interval_end;
+                        total_bytes_read += current_interval_end - current_interval_begin;
                     }
 
                     current_interval_begin = beg;
@@ -1157,7 +1228,7 @@ void data_block_manager_t::gc_one_extent(gc_state_t *gc_state) {
                 gc_blocks.get() + current_interval_begin,
                 choose_gc_io_account(),
                 &read_cb);
-        total_bytes_read += current_interval_end - current_interval_end;
+        total_bytes_read += current_interval_end - current_interval_begin;
 
         // Ok, all reads have been issued. Call `on_io_complete()` once to allow
         // `read_cb` to be pulsed (see comment above).
@@ -1272,6 +1343,7 @@ void data_block_manager_t::write_gcs(
         }
 
         new_block_tokens = many_writes(the_writes.data(), the_writes.size(),
+                                       write_class_t::gc,
                                        choose_gc_io_account(),
                                        &block_write_cond);
 
@@ -1337,6 +1409,12 @@ void data_block_manager_t::flush_gc_index_writes(signal_t *) {
                 if (iw.gc_state->current_entry->block_referenced_by_index(block_index)) {
                     block_id_t block_id = write.buf->ser_header.block_id;
 
+                    // The GC copies blocks byte for byte, so a compressed block
+                    // stays compressed.  Only the index knows its original size.
+                    const index_block_info_t info
+                        = serializer->lba_index->get_block_info(block_id);
+                    iw.new_block_tokens[i]->block_size_ = info.block_size();
+
                     index_write_ops.push_back(
                         index_write_op_t(block_id,
                             make_optional(iw.new_block_tokens[i])));
@@ -1387,6 +1465,8 @@ void data_block_manager_t::flush_gc_index_writes(signal_t *) {
 void data_block_manager_t::prepare_metablock(dbm_metablock_mixin_t *metablock) {
     guarantee(state == state_ready || state == state_shutting_down);
 
+    const gc_entry_t *active_extent
+        = active_extents[static_cast<size_t>(write_class_t::foreground)];
     if (active_extent != nullptr) {
         metablock->active_extent = active_extent->extent_ref.offset();
     } else {
@@ -1419,10 +1499,12 @@ void data_block_manager_t::actually_shutdown() {
 
     guarantee(reconstructed_extents.head() == nullptr);
 
-    if (active_extent != nullptr) {
-        UNUSED int64_t extent = active_extent->extent_ref.release();
-        delete active_extent;
-        active_extent = nullptr;
+    for (size_t i = 0; i < NUM_WRITE_CLASSES; ++i) {
+        if (active_extents[i] != nullptr) {
+            UNUSED int64_t extent = active_extents[i]->extent_ref.release();
+            delete active_extents[i];
+            active_extents[i] = nullptr;
+        }
     }
 
     while (gc_entry_t *entry = young_extent_queue.head()) {
@@ -1447,9 +1529,12 @@ void data_block_manager_t::actually_shutdown() {
 std::vector<std::vector<counted_t<block_token_t>>>
 data_block_manager_t::gimme_some_new_offsets(const buf_write_info_t *writes,
                                              size_t writes_count,
+                                             write_class_t write_class,
                                              uint64_t *cumulative_aligned_size_out) {
     ASSERT_NO_CORO_WAITING;
 
+    gc_entry_t *&active_extent = active_extents[static_cast<size_t>(write_class)];
+
     // Start a new extent if necessary.
     if (active_extent == nullptr) {
         active_extent = new gc_entry_t(this);
@@ -1553,9 +1638,9 @@ void data_block_manager_t::remove_last_unyoung_entry() {
 
 // Answers the following question: We're in the middle of gc'ing, and
 // look, it's the next largest entry.  Should we keep gc'ing?  Returns
-// false when the garbage ratio is lower than GC_STOP_RATIO.
+// false when the garbage ratio is low enough for the gc_scheduler_t.
 bool data_block_manager_t::should_we_keep_gcing() const {
-    return gc_enabled && garbage_ratio() > GC_STOP_RATIO;
+    return gc_enabled && gc_scheduler.should_keep_going(garbage_ratio());
 }
 
 bool data_block_manager_t::should_terminate_one_gc_thread() const {
@@ -1564,10 +1649,9 @@ bool data_block_manager_t::should_terminate_one_gc_thread() const {
 }
 
 // Answers the following question: Do we want to bother gc'ing?
-// Returns true when our garbage_ratio is greater than
-// GC_THRESHOLD_RATIO_*.
+// Returns true when our garbage_ratio is high enough for the gc_scheduler_t.
 bool data_block_manager_t::do_we_want_to_start_gcing() const {
-    return gc_enabled && garbage_ratio() > GC_START_RATIO;
+    return gc_enabled && gc_scheduler.should_start(garbage_ratio());
 }
 
 bool gc_entry_less_t::operator()(const gc_entry_t *x, const gc_entry_t *y) {
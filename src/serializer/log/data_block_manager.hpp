@@ -16,6 +16,7 @@
 #include "serializer/checksum.hpp"
 #include "serializer/log/config.hpp"
 #include "serializer/log/extent_manager.hpp"
+#include "serializer/log/gc_scheduler.hpp"
 #include "serializer/types.hpp"
 
 class buf_ptr_t;
@@ -38,6 +39,19 @@ class data_block_manager_t {
     friend class dbm_read_ahead_t;
 
 public:
+    /* Blocks that the GC moves have already outlived the rest of their extent, so we
+    expect them to stay live longer than freshly written blocks.  The same goes for
+    foreground writes of blocks whose previous version sat in an old extent, i.e.
+    blocks that get rewritten rarely.  Each class of writes fills its own active
+    extent.  That way extents full of frequently rewritten blocks turn into garbage
+    quickly and are cheap to collect, while the other extents stay mostly live. */
+    enum class write_class_t {
+        foreground = 0,
+        foreground_cold = 1,
+        gc = 2
+    };
+    static const size_t NUM_WRITE_CLASSES = 3;
+
     data_block_manager_t(extent_manager_t *em, log_serializer_t *serializer,
                          const log_serializer_on_disk_static_config_t *static_config,
                          log_serializer_stats_t *parent);
@@ -84,16 +98,28 @@ public:
     // ratio of garbage to blocks in the system
     double garbage_ratio() const;
 
+    // Tells the GC scheduler how long a foreground block read took.
+    void note_foreground_read(ticks_t latency);
+
     // Potentially computes a checksum of the blocks to be written, depending on config.
     // Caller may ignore that information, or use it to save an fdatasync.
     std::vector<counted_t<block_token_t> >
     many_writes(const buf_write_info_t *writes,
                 size_t writes_count,
+                write_class_t write_class,
                 file_account_t *io_account,
                 iocallback_t *cb);
 
+    // Like many_writes, but sorts the blocks into the foreground write classes.
+    std::vector<counted_t<block_token_t> >
+    many_foreground_writes(const buf_write_info_t *writes,
+                           size_t writes_count,
+                           file_account_t *io_account,
+                           iocallback_t *cb);
+
     std::vector<std::vector<counted_t<block_token_t> > >
     gimme_some_new_offsets(const buf_write_info_t *writes, size_t writes_count,
+                           write_class_t write_class,
                            uint64_t *cumulative_aligned_size_out);
 
     bool is_gc_active() const;
@@ -144,6 +170,13 @@ private:
     // Picks an i/o account for GC to use, based on the current garbage rate
     file_account_t *choose_gc_io_account();
 
+    // Picks the write class for a new version of the given block, based on where its
+    // current version lives.
+    write_class_t classify_foreground_write(block_id_t block_id);
+
+    // Updates the GC statistics for a block that just became garbage.
+    void note_new_garbage(gc_entry_t *entry, unsigned int block_index);
+
     // Checks whether the extent is empty and if it is, notifies the extent manager
     // and cleans up
     void check_and_handle_empty_extent(uint64_t extent_id);
@@ -198,8 +231,9 @@ private:
     /* Contains every extent in the gc_entry_t::state_reconstructing state */
     intrusive_list_t<gc_entry_t> reconstructed_extents;
 
-    /* Contains the extent in the gc_entry_t::state_active state. */
-    gc_entry_t *active_extent;
+    /* Contains the extents in the gc_entry_t::state_active state, indexed by
+    write_class_t. */
+    gc_entry_t *active_extents[NUM_WRITE_CLASSES];
 
     /* Contains every extent in the gc_entry_t::state_young state */
     intrusive_list_t<gc_entry_t> young_extent_queue;
@@ -221,6 +255,8 @@ private:
         int64_t get() const { return val; }
     };
 
+    gc_scheduler_t gc_scheduler;
+
     /* The state of all currently active GC coroutines */
     intrusive_list_t<gc_state_t> active_gcs;
 
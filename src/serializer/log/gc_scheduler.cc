@@ -0,0 +1,146 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "serializer/log/gc_scheduler.hpp"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "errors.hpp"
+
+// The ratio at which we start GCing.
+constexpr double GC_START_RATIO = 0.1;
+// The ratio at which we don't want to keep GC'ing.
+constexpr double GC_STOP_RATIO = 0.05;
+// The ratio at which we start taking more serious measures to get the garbage
+// rate down.  Above this ratio, foreground latency no longer holds the GC back.
+constexpr double GC_HIGH_RATIO = 0.3;
+
+// Over how many seconds we average the garbage and reclaim rates.
+const time_t GC_RATE_TIME_CONSTANT_SECS = 10;
+
+// Weights of a new sample in the two latency moving averages.
+constexpr double RECENT_LATENCY_WEIGHT = 1.0 / 16;
+constexpr double BASELINE_LATENCY_WEIGHT = 1.0 / 1024;
+// Foreground reads count as slow once they take this many times longer than usual...
+constexpr double SLOW_FOREGROUND_FACTOR = 3.0;
+// ... and longer than this many seconds.  Faster reads don't need protection.
+constexpr double SLOW_FOREGROUND_MIN_LATENCY = 0.0005;
+
+decaying_rate_t::decaying_rate_t(ticks_t time_constant)
+    : time_constant_secs(ticks_to_secs(time_constant)),
+      sum(0),
+      last_update(ticks_t{0}) {
+    guarantee(time_constant_secs > 0);
+}
+
+double decaying_rate_t::decayed_sum(ticks_t now) const {
+    if (now.nanos <= last_update.nanos) {
+        return sum;
+    }
+    const double elapsed = ticks_to_secs(ticks_t{now.nanos - last_update.nanos});
+    return sum * exp(-elapsed / time_constant_secs);
+}
+
+void decaying_rate_t::record(double amount, ticks_t now) {
+    sum = decayed_sum(now) + amount;
+    last_update = ticks_t{std::max(now.nanos, last_update.nanos)};
+}
+
+double decaying_rate_t::rate(ticks_t now) const {
+    return decayed_sum(now) / time_constant_secs;
+}
+
+gc_scheduler_t::gc_scheduler_t()
+    : garbage_rate(secs_to_ticks(GC_RATE_TIME_CONSTANT_SECS)),
+      reclaim_rate(secs_to_ticks(GC_RATE_TIME_CONSTANT_SECS)),
+      recent_latency(0),
+      baseline_latency(0),
+      have_latency(false) { }
+
+void gc_scheduler_t::note_foreground_read(ticks_t latency) {
+    const double secs = ticks_to_secs(latency);
+    if (!have_latency) {
+        recent_latency = baseline_latency = secs;
+        have_latency = true;
+    } else {
+        recent_latency += RECENT_LATENCY_WEIGHT * (secs - recent_latency);
+        baseline_latency += BASELINE_LATENCY_WEIGHT * (secs - baseline_latency);
+    }
+}
+
+void gc_scheduler_t::note_garbage(int64_t bytes, ticks_t now) {
+    garbage_rate.record(bytes, now);
+}
+
+void gc_scheduler_t::note_reclaimed(int64_t bytes, ticks_t now) {
+    reclaim_rate.record(bytes, now);
+}
+
+bool gc_scheduler_t::should_start(double garbage_ratio) const {
+    return garbage_ratio > GC_START_RATIO;
+}
+
+bool gc_scheduler_t::should_keep_going(double garbage_ratio) const {
+    return garbage_ratio > GC_STOP_RATIO;
+}
+
+size_t gc_scheduler_t::concurrency(double garbage_ratio, ticks_t now) const {
+    // As long as the GC ratio is below GC_START_RATIO, we only run 1 GC coroutine.
+    // Above it, we linearly increase the number of concurrent GCs, reaching the
+    // maximum at GC_HIGH_RATIO.  That's the space-driven part.
+    //
+    // We then double that if the GC is not keeping up with the rate at which garbage
+    // is created, or halve it when foreground reads suffer, so that the garbage
+    // ratio mostly stays between the start and high ratios without GC bursts.
+    //
+    // Also see `wants_high_priority()` for the second component in the automatic
+    // GC scaling process.
+
+    CT_ASSERT(GC_HIGH_RATIO > GC_START_RATIO);
+    CT_ASSERT(GC_START_RATIO > GC_STOP_RATIO);
+
+    if (garbage_ratio >= GC_HIGH_RATIO) {
+        return MAX_CONCURRENT_GCS;
+    }
+
+    size_t base = 1;
+    if (garbage_ratio >= GC_START_RATIO) {
+        const double linear_factor = (garbage_ratio - GC_START_RATIO)
+            / (GC_HIGH_RATIO - GC_START_RATIO);
+        base = 1 + static_cast<size_t>(linear_factor * MAX_CONCURRENT_GCS);
+    }
+
+    if (is_falling_behind(now)) {
+        base *= 2;
+    } else if (foreground_is_slow()) {
+        base /= 2;
+    }
+    // Clamp to avoid rounding errors leading to illegal return values
+    return std::max<size_t>(1, std::min(base, MAX_CONCURRENT_GCS));
+}
+
+bool gc_scheduler_t::wants_high_priority(double garbage_ratio, ticks_t now) const {
+    // We use the nice i/o account whenever possible.  Past the midpoint between the
+    // start and high ratios we switch to the high priority account if the GC is
+    // falling behind and the foreground isn't suffering, and past GC_HIGH_RATIO we
+    // switch unconditionally, so that the database can't grow indefinitely.
+
+    // Note that this means that we can end up oscillating between both accounts,
+    // which is fine.
+    if (garbage_ratio > GC_HIGH_RATIO) {
+        return true;
+    }
+    return garbage_ratio > (GC_START_RATIO + GC_HIGH_RATIO) / 2
+        && is_falling_behind(now)
+        && !foreground_is_slow();
+}
+
+bool gc_scheduler_t::is_falling_behind(ticks_t now) const {
+    return garbage_rate.rate(now) > reclaim_rate.rate(now);
+}
+
+bool gc_scheduler_t::foreground_is_slow() const {
+    return have_latency
+        && recent_latency > SLOW_FOREGROUND_MIN_LATENCY
+        && recent_latency > SLOW_FOREGROUND_FACTOR * baseline_latency;
+}
@@ -0,0 +1,71 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_LOG_GC_SCHEDULER_HPP_
+#define SERIALIZER_LOG_GC_SCHEDULER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "time.hpp"
+
+// How many GC routines to launch concurrently, at maximum
+const size_t MAX_CONCURRENT_GCS = 64;
+
+/* An exponentially decaying sum of the amounts passed to `record()`.  `rate()`
+approximates the amount per second over the last `time_constant`. */
+class decaying_rate_t {
+public:
+    explicit decaying_rate_t(ticks_t time_constant);
+
+    void record(double amount, ticks_t now);
+    double rate(ticks_t now) const;
+
+private:
+    double decayed_sum(ticks_t now) const;
+
+    const double time_constant_secs;
+    double sum;
+    ticks_t last_update;
+};
+
+/* `gc_scheduler_t` decides how hard the data block GC works.  Besides the garbage
+ratio, it looks at
+
+ - how quickly the foreground creates garbage compared with how quickly the GC
+   reclaims it.  If the GC is falling behind, it gets more concurrency and the high
+   priority i/o account before the garbage ratio gets out of hand.
+ - the latency of foreground block reads.  If they get much slower than usual, the
+   GC backs off, as long as the garbage ratio leaves us room to do so. */
+class gc_scheduler_t {
+public:
+    gc_scheduler_t();
+
+    // Inputs
+    void note_foreground_read(ticks_t latency);
+    void note_garbage(int64_t bytes, ticks_t now);
+    void note_reclaimed(int64_t bytes, ticks_t now);
+
+    // Decisions
+    bool should_start(double garbage_ratio) const;
+    bool should_keep_going(double garbage_ratio) const;
+    // Returns a number between 1 and MAX_CONCURRENT_GCS.
+    size_t concurrency(double garbage_ratio, ticks_t now) const;
+    bool wants_high_priority(double garbage_ratio, ticks_t now) const;
+
+    // True if garbage is being created faster than the GC can reclaim it.
+    bool is_falling_behind(ticks_t now) const;
+    // True if recent foreground reads are much slower than they usually are.
+    bool foreground_is_slow() const;
+
+private:
+    decaying_rate_t garbage_rate;
+    decaying_rate_t reclaim_rate;
+
+    // Moving averages of the foreground read latency, in seconds.  `recent_latency`
+    // follows changes quickly, `baseline_latency` reflects what's normal for this
+    // device.
+    double recent_latency;
+    double baseline_latency;
+    bool have_latency;
+};
+
+#endif  // SERIALIZER_LOG_GC_SCHEDULER_HPP_
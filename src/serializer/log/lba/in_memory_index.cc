@@ -5,8 +5,31 @@
 
 #include "serializer/log/lba/disk_format.hpp"
 
+// Offsets have to fit into the upper 48 bits after adding one.
+const int64_t MAX_COMPACT_OFFSET = (static_cast<int64_t>(1) << 48) - 2;
+
+compact_block_location_t::compact_block_location_t(flagged_off64_t offset,
+                                                   uint16_t ser_block_size) {
+    guarantee(offset.the_value_ >= -1 && offset.the_value_ <= MAX_COMPACT_OFFSET,
+              "Offset %" PRIi64 " is too large for the in-memory index.",
+              offset.the_value_);
+    bits_ = (static_cast<uint64_t>(offset.the_value_ + 1) << 16) | ser_block_size;
+}
+
+flagged_off64_t compact_block_location_t::offset() const {
+    flagged_off64_t ret;
+    ret.the_value_ = static_cast<int64_t>(bits_ >> 16) - 1;
+    return ret;
+}
+
 in_memory_index_t::in_memory_index_t()
-    : end_block_id_(0), end_aux_block_id_(FIRST_AUX_BLOCK_ID) { }
+    : end_block_id_(0),
+      end_aux_block_id_(FIRST_AUX_BLOCK_ID),
+      memory_reporter_(memory_tag_t::LBA_INDEX) {
+    for (int i = 0; i < LBA_SHARD_FACTOR; ++i) {
+        live_entries_[i] = 0;
+    }
+}
 
 block_id_t in_memory_index_t::end_block_id() {
     return end_block_id_;
@@ -16,21 +39,41 @@ block_id_t in_memory_index_t::end_aux_block_id() {
     return end_aux_block_id_;
 }
 
+int64_t in_memory_index_t::live_entries(int lba_shard) const {
+    rassert(lba_shard >= 0 && lba_shard < LBA_SHARD_FACTOR);
+    return live_entries_[lba_shard];
+}
+
 index_block_info_t in_memory_index_t::get_block_info(block_id_t id) {
     if (is_aux_block_id(id)) {
-        index_aux_block_info_t aux_info
-            = aux_infos_.get(make_aux_block_id_relative(id));
-        return index_block_info_t(aux_info.offset,
+        const size_t relative_id = make_aux_block_id_relative(id);
+        const compact_block_location_t location = aux_infos_.get(relative_id);
+        return index_block_info_t(location.offset(),
                                   repli_timestamp_t::invalid,
-                                  aux_info.ser_block_size);
+                                  location.ser_block_size(),
+                                  aux_uncompressed_sizes_.get(relative_id));
     } else {
-        return infos_.get(id);
+        const compact_block_info_t info = infos_.get(id);
+        repli_timestamp_t recency;
+        recency.longtime = info.recency_plus_one - 1;
+        return index_block_info_t(info.location.offset(),
+                                  recency,
+                                  info.location.ser_block_size(),
+                                  uncompressed_sizes_.get(id));
     }
 }
 
 void in_memory_index_t::set_block_info(block_id_t id, repli_timestamp_t recency,
                                        flagged_off64_t offset,
-                                       uint16_t ser_block_size) {
+                                       uint16_t ser_block_size,
+                                       uint16_t uncompressed_ser_block_size) {
+    // Both maps are sharded the same way, see `lba_list_t::gc()`.
+    CT_ASSERT(FIRST_AUX_BLOCK_ID % LBA_SHARD_FACTOR == 0);
+    const bool was_live = get_block_info(id).offset.has_value();
+    if (was_live != offset.has_value()) {
+        live_entries_[id % LBA_SHARD_FACTOR] += offset.has_value() ? 1 : -1;
+    }
+
     if (is_aux_block_id(id)) {
         if (id >= end_aux_block_id_) {
             end_aux_block_id_ = id + 1;
@@ -39,14 +82,21 @@ void in_memory_index_t::set_block_info(block_id_t id, repli_timestamp_t recency,
         // other than `invalid`, you might be doing something wrong. It will be
         // discarded anyway.
         rassert(recency == repli_timestamp_t::invalid);
-        index_aux_block_info_t info(offset, ser_block_size);
-        aux_infos_.set(make_aux_block_id_relative(id), info);
+        const size_t relative_id = make_aux_block_id_relative(id);
+        aux_infos_.set(relative_id, compact_block_location_t(offset, ser_block_size));
+        aux_uncompressed_sizes_.set(relative_id, uncompressed_ser_block_size);
     } else {
         if (id >= end_block_id_) {
             end_block_id_ = id + 1;
         }
-        index_block_info_t info(offset, recency, ser_block_size);
+        compact_block_info_t info;
+        info.location = compact_block_location_t(offset, ser_block_size);
+        info.recency_plus_one = recency.longtime + 1;
         infos_.set(id, info);
+        uncompressed_sizes_.set(id, uncompressed_ser_block_size);
     }
+    memory_reporter_.set(infos_.memory_usage()
+                         + uncompressed_sizes_.memory_usage()
+                         + aux_infos_.memory_usage()
+                         + aux_uncompressed_sizes_.memory_usage());
 }
-
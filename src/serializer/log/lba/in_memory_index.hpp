@@ -5,64 +5,98 @@
 #include "arch/compiler.hpp"
 #include "containers/two_level_array.hpp"
 #include "config/args.hpp"
+#include "memory_accounting.hpp"
 #include "serializer/serializer.hpp"
 #include "serializer/log/lba/disk_format.hpp"
 
-ATTR_PACKED(struct index_block_info_t {
+struct index_block_info_t {
     index_block_info_t()
         : offset(flagged_off64_t::unused()),
           recency(repli_timestamp_t::invalid),
-          ser_block_size(0) { }
+          ser_block_size(0),
+          uncompressed_ser_block_size(0) { }
 
     index_block_info_t(flagged_off64_t _offset,
                        repli_timestamp_t _recency,
-                       uint16_t _ser_block_size)
+                       uint16_t _ser_block_size,
+                       uint16_t _uncompressed_ser_block_size)
         : offset(_offset),
           recency(_recency),
-          ser_block_size(_ser_block_size) { }
+          ser_block_size(_ser_block_size),
+          uncompressed_ser_block_size(_uncompressed_ser_block_size) { }
 
-    // For two_level_array_t.
-    bool operator==(const index_block_info_t &other) const {
-        return offset == other.offset &&
-            recency == other.recency &&
-            ser_block_size == other.ser_block_size;
+    // The size of the block as it is stored on disk.
+    block_size_t disk_block_size() const {
+        return block_size_t::unsafe_make(ser_block_size);
+    }
+
+    // The size of the block once it has been decompressed.
+    block_size_t block_size() const {
+        return block_size_t::unsafe_make(uncompressed_ser_block_size != 0
+                                         ? uncompressed_ser_block_size
+                                         : ser_block_size);
     }
 
     flagged_off64_t offset;
     repli_timestamp_t recency;
     uint16_t ser_block_size;
-});
+    // Zero unless the block is stored compressed, see `lba_entry_t`.
+    uint16_t uncompressed_ser_block_size;
+};
 
-/* This is a reduced-size block info for auxiliary blocks (currently
-blob blocks used for large values). It doesn't store a replication
-timestamp, because we don't need it for those blocks. */
-ATTR_PACKED(struct index_aux_block_info_t {
-    index_aux_block_info_t()
-        : offset(flagged_off64_t::unused()),
-          ser_block_size(0) { }
+/* The index keeps an entry for every block id that was ever used, so the way we store
+entries determines how much memory the serializer needs.  A block's offset and size
+share a single word (see `compact_block_location_t`), and the uncompressed sizes live
+in separate arrays that stay empty unless compression is in use.  All-zero values
+stand for unused blocks, which lets two_level_array_t free chunks of deleted blocks.
 
-    index_aux_block_info_t(flagged_off64_t _offset,
-                           uint16_t _ser_block_size)
-        : offset(_offset),
-          ser_block_size(_ser_block_size) { }
+We can't fit the recency into the remaining bits, so a regular block takes 16 bytes,
+and an auxiliary block (which doesn't have a recency) takes 8 bytes. */
+class compact_block_location_t {
+public:
+    compact_block_location_t() : bits_(0) { }
+    compact_block_location_t(flagged_off64_t offset, uint16_t ser_block_size);
+
+    flagged_off64_t offset() const;
+    uint16_t ser_block_size() const {
+        return static_cast<uint16_t>(bits_ & 0xFFFF);
+    }
 
     // For two_level_array_t.
-    bool operator==(const index_aux_block_info_t &other) const {
-        return offset == other.offset &&
-            ser_block_size == other.ser_block_size;
+    bool operator==(const compact_block_location_t &other) const {
+        return bits_ == other.bits_;
     }
 
-    flagged_off64_t offset;
-    uint16_t ser_block_size;
-});
+private:
+    // The upper 48 bits hold the offset plus one (so that flagged_off64_t::unused()
+    // becomes zero), the lower 16 bits hold the ser_block_size.
+    uint64_t bits_;
+};
 
+struct compact_block_info_t {
+    compact_block_info_t() : recency_plus_one(0) { }
 
+    // For two_level_array_t.
+    bool operator==(const compact_block_info_t &other) const {
+        return location == other.location
+            && recency_plus_one == other.recency_plus_one;
+    }
+
+    compact_block_location_t location;
+    // repli_timestamp_t::invalid is UINT64_MAX, which this turns into zero.
+    uint64_t recency_plus_one;
+};
 
 class in_memory_index_t {
-    two_level_array_t<index_block_info_t> infos_;
+    two_level_array_t<compact_block_info_t> infos_;
+    two_level_array_t<uint16_t> uncompressed_sizes_;
     block_id_t end_block_id_;
-    two_level_array_t<index_aux_block_info_t> aux_infos_;
+    two_level_array_t<compact_block_location_t> aux_infos_;
+    two_level_array_t<uint16_t> aux_uncompressed_sizes_;
     block_id_t end_aux_block_id_;
+    // How many blocks of each LBA shard currently have an offset.
+    int64_t live_entries_[LBA_SHARD_FACTOR];
+    tagged_memory_reporter_t memory_reporter_;
 
 public:
     in_memory_index_t();
@@ -73,8 +107,13 @@ public:
 
     index_block_info_t get_block_info(block_id_t id);
     void set_block_info(block_id_t id, repli_timestamp_t recency,
-                        flagged_off64_t offset, uint16_t ser_block_size);
+                        flagged_off64_t offset, uint16_t ser_block_size,
+                        uint16_t uncompressed_ser_block_size);
 
+    /* The number of entries that a fully compacted copy of the given LBA shard
+    consists of.  The LBA GC compares this to the shard's on-disk size, which bounds
+    how many entries we have to replay when the serializer starts up. */
+    int64_t live_entries(int lba_shard) const;
 };
 
 #endif  // SERIALIZER_LOG_LBA_IN_MEMORY_INDEX_HPP_
@@ -105,11 +105,14 @@ public:
                 // We've never actually used them, and we now use 16 bit block sizes
                 // for the in-memory index to save a few bytes.
                 guarantee(e->ser_block_size <= std::numeric_limits<uint16_t>::max());
+                guarantee(e->uncompressed_ser_block_size
+                          <= std::numeric_limits<uint16_t>::max());
                 owner->in_memory_index.set_block_info(
                         e->block_id,
                         e->recency,
                         e->offset,
-                        static_cast<uint16_t>(e->ser_block_size));
+                        static_cast<uint16_t>(e->ser_block_size),
+                        static_cast<uint16_t>(e->uncompressed_ser_block_size));
             }
 
             owner->state = lba_list_t::state_ready;
@@ -192,11 +195,13 @@ segmented_vector_t<repli_timestamp_t> lba_list_t::get_block_recencies(block_id_t
 
 void lba_list_t::set_block_info(block_id_t block, repli_timestamp_t recency,
                                 flagged_off64_t offset, uint16_t ser_block_size,
+                                uint16_t uncompressed_ser_block_size,
                                 file_account_t *io_account, extent_transaction_t *txn,
                                 optional<std::vector<checksum_filerange>> *checksums) {
     rassert(state == state_ready || state == state_gc_shutting_down);
 
-    in_memory_index.set_block_info(block, recency, offset, ser_block_size);
+    in_memory_index.set_block_info(block, recency, offset, ser_block_size,
+                                   uncompressed_ser_block_size);
 
     // If the inline LBA is full, free it up first by moving its entries to
     // the LBA extents
@@ -205,7 +210,8 @@ void lba_list_t::set_block_info(block_id_t block, repli_timestamp_t recency,
         rassert(!check_inline_lba_full());
     }
     // Then store the entry inline
-    add_inline_entry(block, recency, offset, ser_block_size);
+    add_inline_entry(block, recency, offset, ser_block_size,
+                     uncompressed_ser_block_size);
 }
 
 bool lba_list_t::check_inline_lba_full() const {
@@ -245,6 +251,7 @@ void lba_list_t::move_inline_entries_to_extents(
                 e.recency,
                 e.offset,
                 e.ser_block_size,
+                e.uncompressed_ser_block_size,
                 io_account,
                 txn,
                 checksums);
@@ -254,11 +261,13 @@ void lba_list_t::move_inline_entries_to_extents(
 }
 
 void lba_list_t::add_inline_entry(block_id_t block, repli_timestamp_t recency,
-                                flagged_off64_t offset, uint16_t ser_block_size) {
+                                  flagged_off64_t offset, uint16_t ser_block_size,
+                                  uint16_t uncompressed_ser_block_size) {
 
     rassert(!check_inline_lba_full());
     inline_lba_entries[inline_lba_entries_count++] =
-            lba_entry_t::make(block, recency, offset, ser_block_size);
+            lba_entry_t::make(block, recency, offset, ser_block_size,
+                              uncompressed_ser_block_size);
 }
 
 class lba_writer_t :
@@ -359,13 +368,13 @@ void lba_list_t::gc(int lba_shard, auto_drainer_t::lock_t) {
             break;
         }
 
-        flagged_off64_t off = get_block_offset(id);
-        if (off.has_value()) {
-            uint16_t ser_block_size = get_ser_block_size(id);
+        const index_block_info_t info = get_block_info(id);
+        if (info.offset.has_value()) {
             disk_structures[lba_shard]->add_entry(id,
-                                                  get_block_recency(id),
-                                                  off,
-                                                  ser_block_size,
+                                                  info.recency,
+                                                  info.offset,
+                                                  info.ser_block_size,
+                                                  info.uncompressed_ser_block_size,
                                                   gc_io_account.get(),
                                                   txns.back().get(),
                                                   &checksums);
@@ -476,8 +485,10 @@ bool lba_list_t::we_want_to_gc(int i) {
     // need, don't GC
     int entries_per_extent = disk_structures[i]->num_entries_that_can_fit_in_an_extent();
     int64_t entries_total = disk_structures[i]->extents_in_superblock.size() * entries_per_extent;
-    int64_t entries_live = end_block_id() / LBA_SHARD_FACTOR
-                            + make_aux_block_id_relative(end_aux_block_id()) / LBA_SHARD_FACTOR;
+    // Deleted blocks don't count, since the GC doesn't rewrite them.  This makes the
+    // GC a checkpoint of the live index, and keeps the number of entries that we
+    // replay on startup within a constant factor of it.
+    int64_t entries_live = in_memory_index.live_entries(i);
     if ((entries_live / static_cast<double>(entries_total)) > LBA_MIN_UNGARBAGE_FRACTION) {  // TODO: multiply both sides by common denominator
         return false;
     }
@@ -7,22 +7,30 @@
 #include <unistd.h>
 
 #include <functional>
+#include <memory>
 
 #include "arch/io/disk.hpp"
 #include "arch/runtime/runtime.hpp"
 #include "arch/runtime/coroutines.hpp"
+#include "arch/timing.hpp"
 #include "buffer_cache/types.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "logger.hpp"
 #include "perfmon/perfmon.hpp"
 #include "serializer/buf_ptr.hpp"
+#include "serializer/log/block_compression.hpp"
 #include "serializer/log/data_block_manager.hpp"
+#include "serializer/log/striped_file.hpp"
 
 filepath_file_opener_t::filepath_file_opener_t(const serializer_filepath_t &filepath,
-                                               io_backender_t *backender)
+                                               io_backender_t *backender,
+                                               int num_stripes)
     : filepath_(filepath),
       backender_(backender),
-      opened_temporary_(false) { }
+      num_stripes_(num_stripes),
+      opened_temporary_(false) {
+    guarantee(num_stripes_ >= 1 && num_stripes_ <= MAX_SERIALIZER_STRIPES);
+}
 
 filepath_file_opener_t::~filepath_file_opener_t() { }
 
@@ -30,6 +38,24 @@ std::string filepath_file_opener_t::file_name() const {
     return filepath_.permanent_path();
 }
 
+std::string filepath_file_opener_t::stripe_file_name(const std::string &name, int i,
+                                                     int num_stripes) {
+    rassert(i >= 0 && i < num_stripes);
+    if (i == 0) {
+        return name;
+    }
+    return strprintf("%s.stripe-%d-of-%d", name.c_str(), i, num_stripes);
+}
+
+int filepath_file_opener_t::count_stripes(const std::string &path) {
+    for (int n = 2; n <= MAX_SERIALIZER_STRIPES; ++n) {
+        if (access(stripe_file_name(path, 1, n).c_str(), F_OK) == 0) {
+            return n;
+        }
+    }
+    return 1;
+}
+
 std::string filepath_file_opener_t::temporary_file_name() const {
 #ifdef _WIN32
     // TODO WINDOWS: use temporary files
@@ -64,10 +90,25 @@ void filepath_file_opener_t::open_serializer_file(const std::string &path,
     }
 }
 
+void filepath_file_opener_t::open_striped_file(const std::string &path,
+                                               int extra_flags,
+                                               scoped_ptr_t<file_t> *file_out) {
+    if (num_stripes_ == 1) {
+        open_serializer_file(path, extra_flags, file_out);
+        return;
+    }
+    std::vector<scoped_ptr_t<file_t> > stripes(num_stripes_);
+    for (int i = 0; i < num_stripes_; ++i) {
+        open_serializer_file(stripe_file_name(path, i, num_stripes_), extra_flags,
+                             &stripes[i]);
+    }
+    file_out->init(new striped_file_t(std::move(stripes)));
+}
+
 void filepath_file_opener_t::open_serializer_file_create_temporary(
         scoped_ptr_t<file_t> *file_out) {
     mutex_assertion_t::acq_t acq(&reentrance_mutex_);
-    open_serializer_file(temporary_file_name(),
+    open_striped_file(temporary_file_name(),
                          linux_file_t::mode_create | linux_file_t::mode_truncate,
                          file_out);
     opened_temporary_ = true;
@@ -85,15 +126,20 @@ void filepath_file_opener_t::move_serializer_file_to_permanent_location() {
     // TODO WINDOWS: temporary files are not used because, by default,
     // files cannot be renamed while still open
 #else
-    const int res = ::rename(temporary_file_name().c_str(), file_name().c_str());
+    // Stripe 0 goes last, so that the file doesn't show up in its permanent location
+    // until all of its stripes are there.
+    for (int i = num_stripes_ - 1; i >= 0; --i) {
+        const std::string from = stripe_file_name(temporary_file_name(), i, num_stripes_);
+        const std::string to = stripe_file_name(file_name(), i, num_stripes_);
+        const int res = ::rename(from.c_str(), to.c_str());
+
+        if (res != 0) {
+            crash("Could not rename database file %s to permanent location %s (%s)\n",
+                  from.c_str(), to.c_str(), errno_string(errno).c_str());
+        }
 
-    if (res != 0) {
-        crash("Could not rename database file %s to permanent location %s (%s)\n",
-              temporary_file_name().c_str(), file_name().c_str(),
-              errno_string(errno).c_str());
+        warn_fsync_parent_directory(to.c_str());
     }
-
-    warn_fsync_parent_directory(file_name().c_str());
 #endif
 
     opened_temporary_ = false;
@@ -101,7 +147,16 @@ void filepath_file_opener_t::move_serializer_file_to_permanent_location() {
 
 void filepath_file_opener_t::open_serializer_file_existing(scoped_ptr_t<file_t> *file_out) {
     mutex_assertion_t::acq_t acq(&reentrance_mutex_);
-    open_serializer_file(current_file_name(), 0, file_out);
+    num_stripes_ = count_stripes(current_file_name());
+    // A missing stripe would silently shift the data of all later ones.
+    for (int i = 1; i < num_stripes_; ++i) {
+        const std::string stripe = stripe_file_name(current_file_name(), i, num_stripes_);
+        if (access(stripe.c_str(), F_OK) != 0) {
+            crash("Stripe %d of database file %s is missing (expected it at %s).\n",
+                  i, current_file_name().c_str(), stripe.c_str());
+        }
+    }
+    open_striped_file(current_file_name(), 0, file_out);
 }
 
 void filepath_file_opener_t::unlink_serializer_file() {
@@ -110,19 +165,26 @@ void filepath_file_opener_t::unlink_serializer_file() {
 
     mutex_assertion_t::acq_t acq(&reentrance_mutex_);
     guarantee(opened_temporary_);
-    const int res = ::unlink(current_file_name().c_str());
-    guarantee_err(res == 0, "unlink() failed");
+    for (int i = 0; i < num_stripes_; ++i) {
+        const int res = ::unlink(
+            stripe_file_name(current_file_name(), i, num_stripes_).c_str());
+        guarantee_err(res == 0, "unlink() failed");
+    }
 }
 
 
 
 log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
     : serializer_collection(),
-      pm_serializer_block_reads(secs_to_ticks(1)),
+      pm_serializer_block_reads(secs_to_ticks(1), true),
       pm_serializer_index_reads(),
       pm_serializer_block_writes(),
+      pm_serializer_compressed_block_writes(),
+      pm_serializer_compression_saved_bytes(),
       pm_serializer_index_writes(secs_to_ticks(1)),
       pm_serializer_index_writes_size(secs_to_ticks(1), false),
+      pm_serializer_metablock_writes(),
+      pm_serializer_coalesced_metablock_writes(),
       pm_serializer_read_bytes_per_sec(secs_to_ticks(1)),
       pm_serializer_read_bytes_total(),
       pm_serializer_written_bytes_per_sec(secs_to_ticks(1)),
@@ -135,14 +197,28 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
       pm_serializer_data_extents_gced(),
       pm_serializer_old_garbage_block_bytes(),
       pm_serializer_old_total_block_bytes(),
+      pm_serializer_foreground_written_block_bytes(),
+      pm_serializer_gc_written_block_bytes(),
+      pm_serializer_cold_block_writes(),
+      pm_serializer_write_amplification(
+          &pm_serializer_gc_written_block_bytes,
+          &pm_serializer_foreground_written_block_bytes,
+          1.0),
       pm_serializer_lba_gcs(),
       parent_collection_membership(parent, &serializer_collection, "serializer"),
       stats_membership(&serializer_collection,
           &pm_serializer_block_reads, "serializer_block_reads",
           &pm_serializer_index_reads, "serializer_index_reads",
           &pm_serializer_block_writes, "serializer_block_writes",
+          &pm_serializer_compressed_block_writes,
+          "serializer_compressed_block_writes",
+          &pm_serializer_compression_saved_bytes,
+          "serializer_compression_saved_bytes",
           &pm_serializer_index_writes, "serializer_index_writes",
           &pm_serializer_index_writes_size, "serializer_index_writes_size",
+          &pm_serializer_metablock_writes, "serializer_metablock_writes",
+          &pm_serializer_coalesced_metablock_writes,
+          "serializer_coalesced_metablock_writes",
           &pm_serializer_read_bytes_per_sec, "serializer_read_bytes_per_sec",
           &pm_serializer_read_bytes_total, "serializer_read_bytes_total",
           &pm_serializer_written_bytes_per_sec, "serializer_written_bytes_per_sec",
@@ -155,6 +231,11 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
           &pm_serializer_data_extents_gced, "serializer_data_extents_gced",
           &pm_serializer_old_garbage_block_bytes, "serializer_old_garbage_block_bytes",
           &pm_serializer_old_total_block_bytes, "serializer_old_total_block_bytes",
+          &pm_serializer_foreground_written_block_bytes,
+          "serializer_foreground_written_block_bytes",
+          &pm_serializer_gc_written_block_bytes, "serializer_gc_written_block_bytes",
+          &pm_serializer_cold_block_writes, "serializer_cold_block_writes",
+          &pm_serializer_write_amplification, "serializer_write_amplification",
           &pm_serializer_lba_gcs, "serializer_lba_gcs")
 { }
 
@@ -462,8 +543,15 @@ buf_ptr_t log_serializer_t::block_read(const counted_t<block_token_t> &token,
     ticks_t pm_time;
     stats->pm_serializer_block_reads.begin(&pm_time);
 
-    buf_ptr_t ret = data_block_manager->read(token->offset_, token->block_size(),
+    const ticks_t start_time = get_ticks();
+    buf_ptr_t ret = data_block_manager->read(token->offset_, token->disk_block_size(),
                                              io_account);
+    data_block_manager->note_foreground_read(
+        ticks_t{get_ticks().nanos - start_time.nanos});
+    if (token->is_compressed()) {
+        ret = decompress_block(ret.ser_buffer(), token->disk_block_size(),
+                               token->block_size());
+    }
 
     stats->pm_serializer_block_reads.end(&pm_time);
     return ret;
@@ -495,8 +583,10 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
              write_op_it != write_ops.end();
              ++write_op_it) {
             const index_write_op_t &op = *write_op_it;
-            flagged_off64_t offset = lba_index->get_block_offset(op.block_id);
-            uint16_t ser_block_size = lba_index->get_ser_block_size(op.block_id);
+            const index_block_info_t old_info = lba_index->get_block_info(op.block_id);
+            flagged_off64_t offset = old_info.offset;
+            uint16_t ser_block_size = old_info.ser_block_size;
+            uint16_t uncompressed_ser_block_size = old_info.uncompressed_ser_block_size;
 
             if (op.token) {
                 // Update the offset pointed to, and mark garbage/liveness as necessary.
@@ -510,7 +600,10 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
                 // Write new token to index, or remove from index as appropriate.
                 if (token.has()) {
                     offset = flagged_off64_t::make(token->offset_);
-                    ser_block_size = token->block_size().ser_value();
+                    ser_block_size = token->disk_block_size().ser_value();
+                    uncompressed_ser_block_size = token->is_compressed()
+                        ? token->block_size().ser_value()
+                        : 0;
 
                     if (checksums) {
                         serializer_checksum checksum = token->checksum_;
@@ -530,18 +623,20 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
 
                     /* mark the life */
                     data_block_manager->mark_live(offset.get_value(),
-                                                  token->block_size());
+                                                  token->disk_block_size());
                 } else {
                     offset = flagged_off64_t::unused();
                     ser_block_size = 0;
+                    uncompressed_ser_block_size = 0;
                 }
             }
 
             repli_timestamp_t recency = op.recency ? op.recency.get()
-                : lba_index->get_block_recency(op.block_id);
+                : old_info.recency;
 
             lba_index->set_block_info(op.block_id, recency,
                                       offset, ser_block_size,
+                                      uncompressed_ser_block_size,
                                       index_writes_io_account.get(), &txn,
                                       &checksums);
         }
@@ -621,6 +716,38 @@ void log_serializer_t::index_write_finish(
     }
 }
 
+/* A metablock write that several index writes can share.  The first index write
+that doesn't find an open group creates one and writes it.  Later ones replace its
+metablock with their newer one until the group gets closed. */
+struct log_serializer_t::metablock_group_t {
+    metablock_group_t(scoped_device_block_aligned_ptr_t<crc_metablock_t> &&_crc_mb,
+                      optional<std::vector<checksum_filerange>> &&_checksums,
+                      const signal_t *safe_to_write_cond)
+        : crc_mb(std::move(_crc_mb)), checksums(std::move(_checksums)),
+          safe_to_write_conds(1, safe_to_write_cond) { }
+
+    void add(scoped_device_block_aligned_ptr_t<crc_metablock_t> &&newer_crc_mb,
+             optional<std::vector<checksum_filerange>> &&more_checksums,
+             const signal_t *safe_to_write_cond) {
+        crc_mb = std::move(newer_crc_mb);
+        // The metablock must cover the blocks of every member.  If one of them
+        // needs datasyncs instead, so does the whole group.
+        if (checksums.has_value() && more_checksums.has_value()) {
+            checksums->insert(checksums->end(),
+                              more_checksums->begin(), more_checksums->end());
+        } else {
+            checksums.reset();
+        }
+        safe_to_write_conds.push_back(safe_to_write_cond);
+    }
+
+    scoped_device_block_aligned_ptr_t<crc_metablock_t> crc_mb;
+    optional<std::vector<checksum_filerange>> checksums;
+    // The LBA writes of all members have to be on disk before the metablock.
+    std::vector<const signal_t *> safe_to_write_conds;
+    cond_t written;
+};
+
 void log_serializer_t::write_metablock(
         new_mutex_in_line_t *mutex_acq,
         const signal_t *safe_to_write_cond,
@@ -635,37 +762,65 @@ void log_serializer_t::write_metablock(
     finish waiting on `safe_to_write_cond`. */
     prepare_metablock(&crc_mb->metablock);
 
+    /* If there's a group that's still waiting for its turn, our metablock supersedes
+    the one that it was going to write, so we just ride along. */
+    if (open_metablock_group) {
+        std::shared_ptr<metablock_group_t> group = open_metablock_group;
+        group->add(std::move(crc_mb), std::move(checksums), safe_to_write_cond);
+        ++stats->pm_serializer_coalesced_metablock_writes;
+        mutex_acq->reset();
+        group->written.wait();
+        return;
+    }
+
+    std::shared_ptr<metablock_group_t> group = std::make_shared<metablock_group_t>(
+        std::move(crc_mb), std::move(checksums), safe_to_write_cond);
+    open_metablock_group = group;
+
     /* Get in line for the metablock manager */
     bool waiting_for_prev_write = !metablock_waiter_queue.empty();
-    cond_t on_prev_write_submitted_metablock;
-    metablock_waiter_queue.push_back(&on_prev_write_submitted_metablock);
+    cond_t on_prev_write_done;
+    metablock_waiter_queue.push_back(&on_prev_write_done);
 
     // This operation is in line with the metablock manager.  Now another index write
     // may commence.
     mutex_acq->reset();
 
-    safe_to_write_cond->wait();
+    // Index writes that come in while the previous metablock is being written join
+    // our group.  If that isn't enough, we can also wait a little longer.
     if (waiting_for_prev_write) {
-        on_prev_write_submitted_metablock.wait();
+        on_prev_write_done.wait();
+    }
+    if (dynamic_config.metablock_group_commit_delay_ms > 0) {
+        nap(dynamic_config.metablock_group_commit_delay_ms);
+    }
+    guarantee(metablock_waiter_queue.front() == &on_prev_write_done);
+    guarantee(open_metablock_group == group);
+    open_metablock_group.reset();
+
+    for (const signal_t *cond : group->safe_to_write_conds) {
+        cond->wait();
     }
-    guarantee(metablock_waiter_queue.front() == &on_prev_write_submitted_metablock);
 
     struct : public cond_t, public metablock_manager_t::metablock_write_callback_t {
         void on_metablock_write() { pulse(); }
     } on_metablock_write;
-    metablock_manager->write_metablock(crc_mb, io_account, std::move(checksums),
+    metablock_manager->write_metablock(group->crc_mb, io_account,
+                                       std::move(group->checksums),
                                        &on_metablock_write);
+    ++stats->pm_serializer_metablock_writes;
+    on_metablock_write.wait();
 
     /* Remove ourselves from the list of metablock waiters. */
     metablock_waiter_queue.pop_front();
 
-    /* If there was another transaction waiting for us to write our metablock so it
-    could write its metablock, notify it now so it can write its metablock. */
+    /* If there was another group waiting for us to write our metablock so it could
+    write its metablock, notify it now so it can write its metablock. */
     if (!metablock_waiter_queue.empty()) {
         metablock_waiter_queue.front()->pulse();
     }
 
-    on_metablock_write.wait();
+    group->written.pulse();
 }
 
 void log_serializer_t::write_metablock_sans_pipelining(
@@ -679,8 +834,15 @@ void log_serializer_t::write_metablock_sans_pipelining(
 
 counted_t<block_token_t>
 log_serializer_t::generate_block_token(int64_t offset, block_size_t block_size) {
+    return generate_block_token(offset, block_size, block_size);
+}
+
+counted_t<block_token_t>
+log_serializer_t::generate_block_token(int64_t offset, block_size_t disk_block_size,
+                                       block_size_t block_size) {
     assert_thread();
-    counted_t<block_token_t> token(new block_token_t(this, offset, block_size));
+    counted_t<block_token_t> token(
+        new block_token_t(this, offset, disk_block_size, block_size));
 
     auto location = offset_tokens.find(offset);
     if (location == offset_tokens.end()) {
@@ -699,9 +861,58 @@ log_serializer_t::block_writes(const buf_write_info_t *write_infos,
     assert_thread();
     stats->pm_serializer_block_writes += write_infos_count;
 
+    if (!dynamic_config.compress_blocks) {
+        std::vector<counted_t<block_token_t> > result
+            = data_block_manager->many_foreground_writes(write_infos, write_infos_count,
+                                                         io_account, cb);
+        guarantee(result.size() == write_infos_count);
+        return result;
+    }
+
+    // The compressed buffers have to stay around until the writes are complete, so
+    // they are owned by the callback.
+    struct compressed_writes_cb_t : public iocallback_t {
+        void on_io_complete() {
+            iocallback_t *local_cb = cb;
+            delete this;
+            local_cb->on_io_complete();
+        }
+        std::vector<buf_ptr_t> compressed_bufs;
+        iocallback_t *cb;
+    };
+
+    compressed_writes_cb_t *compressed_cb = new compressed_writes_cb_t;
+    compressed_cb->cb = cb;
+    compressed_cb->compressed_bufs.reserve(write_infos_count);
+
+    std::vector<buf_write_info_t> disk_write_infos;
+    disk_write_infos.reserve(write_infos_count);
+    for (size_t i = 0; i < write_infos_count; ++i) {
+        const buf_write_info_t &info = write_infos[i];
+        buf_ptr_t compressed = compress_block(info.buf, info.block_size);
+        if (compressed.has()) {
+            ++stats->pm_serializer_compressed_block_writes;
+            stats->pm_serializer_compression_saved_bytes
+                += buf_ptr_t::compute_aligned_block_size(info.block_size)
+                - compressed.aligned_block_size();
+            disk_write_infos.push_back(buf_write_info_t(compressed.ser_buffer(),
+                                                        compressed.block_size(),
+                                                        info.block_id));
+        } else {
+            disk_write_infos.push_back(info);
+        }
+        compressed_cb->compressed_bufs.push_back(std::move(compressed));
+    }
+
     std::vector<counted_t<block_token_t> > result
-        = data_block_manager->many_writes(write_infos, write_infos_count, io_account, cb);
+        = data_block_manager->many_foreground_writes(disk_write_infos.data(),
+                                                     disk_write_infos.size(),
+                                                     io_account, compressed_cb);
     guarantee(result.size() == write_infos_count);
+    // The tokens describe what's on disk; the cache needs to see the original size.
+    for (size_t i = 0; i < write_infos_count; ++i) {
+        result[i]->block_size_ = write_infos[i].block_size;
+    }
     return result;
 }
 
@@ -821,7 +1032,8 @@ counted_t<block_token_t> log_serializer_t::index_read(block_id_t block_id) {
     index_block_info_t info = lba_index->get_block_info(block_id);
     if (info.offset.has_value()) {
         return generate_block_token(info.offset.get_value(),
-                                    block_size_t::unsafe_make(info.ser_block_size));
+                                    info.disk_block_size(),
+                                    info.block_size());
     } else {
         return counted_t<block_token_t>();
     }
@@ -1016,9 +1228,11 @@ bool log_serializer_t::should_perform_read_ahead() {
 
 block_token_t::block_token_t(log_serializer_t *serializer,
                              int64_t initial_offset,
+                             block_size_t initial_disk_block_size,
                              block_size_t initial_block_size)
     : serializer_(serializer), ref_count_(0),
       block_size_(initial_block_size),
+      disk_block_size_(initial_disk_block_size),
       checksum_(no_checksum()),
       offset_(initial_offset) {
     serializer_->assert_thread();
@@ -3,6 +3,7 @@
 #define SERIALIZER_LOG_LOG_SERIALIZER_HPP_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <list>
@@ -46,16 +47,26 @@ struct shutdown_callback_t {
  * respect that it deserves.
  */
 
-// Used to open a file (with the given filepath) for the log serializer.
+// Used to open a file (with the given filepath) for the log serializer.  With more
+// than one stripe, the serializer file is striped over the file itself and
+// `num_stripes - 1` files next to it (see `stripe_file_name()`), which may be symlinks
+// to other devices.  Existing files are opened with the number of stripes that they
+// were created with.
 class filepath_file_opener_t : public serializer_file_opener_t {
 public:
     filepath_file_opener_t(const serializer_filepath_t &filepath,
-                           io_backender_t *backender);
+                           io_backender_t *backender,
+                           int num_stripes = 1);
     ~filepath_file_opener_t();
 
     // The path of the final position of the file.
     std::string file_name() const;
 
+    // The name of stripe `i` of a file that is striped over `num_stripes` files.
+    // Stripe 0 is the file itself.
+    static std::string stripe_file_name(const std::string &name, int i,
+                                        int num_stripes);
+
     void open_serializer_file_create_temporary(scoped_ptr_t<file_t> *file_out);
     void move_serializer_file_to_permanent_location();
     void open_serializer_file_existing(scoped_ptr_t<file_t> *file_out);
@@ -63,6 +74,11 @@ public:
 
 private:
     void open_serializer_file(const std::string &path, int extra_flags, scoped_ptr_t<file_t> *file_out);
+    // Opens all stripes of the given file.
+    void open_striped_file(const std::string &path, int extra_flags,
+                           scoped_ptr_t<file_t> *file_out);
+    // Figures out how many stripes an existing file has.
+    static int count_stripes(const std::string &path);
 
     // The path of the temporary file.  This is file_name() with some suffix appended.
     std::string temporary_file_name() const;
@@ -76,6 +92,10 @@ private:
 
     io_backender_t *const backender_;
 
+    // Set by the constructor for new files, and by count_stripes() when we open an
+    // existing one.
+    int num_stripes_;
+
     // Makes sure that only one member function gets called at a time.  Some of them are
     // blocking, and we don't want to have to worry about stuff like what the value of
     // opened_temporary_ should be during the blocking call to
@@ -159,7 +179,11 @@ private:
     void unregister_block_token(block_token_t *token);
     void remap_block_to_new_offset(int64_t current_offset, int64_t new_offset);
     counted_t<block_token_t> generate_block_token(int64_t offset,
-                                                             block_size_t block_size);
+                                                  block_size_t block_size);
+    // For blocks that are stored compressed.
+    counted_t<block_token_t> generate_block_token(int64_t offset,
+                                                  block_size_t disk_block_size,
+                                                  block_size_t block_size);
 
     void offer_buf_to_read_ahead_callbacks(
             block_id_t block_id,
@@ -190,7 +214,10 @@ private:
     complete.  This function writes the metablock in the state that it has when
     called, i.e.  it does not block between calling and preparing the new metablock.
     Use mutex_acq with a mutex you control if you want to extra-safely pipeline
-    operations from your caller. */
+    operations from your caller.
+
+    Calls that arrive while an earlier metablock is still being written are grouped,
+    and only the newest metablock of a group is written (group commit). */
     void write_metablock(new_mutex_in_line_t *mutex_acq,
                          const signal_t *safe_to_write_cond,
                          file_account_t *io_account,
@@ -264,6 +291,10 @@ private:
     oldest transaction that started but did not finish. */
     std::list<cond_t *> metablock_waiter_queue;
 
+    // The group that new calls to `write_metablock()` join, if any.
+    struct metablock_group_t;
+    std::shared_ptr<metablock_group_t> open_metablock_group;
+
     int active_write_count;
 
     DISABLE_COPYING(log_serializer_t);
@@ -14,8 +14,13 @@ struct log_serializer_stats_t {
     perfmon_duration_sampler_t pm_serializer_block_reads;
     perfmon_counter_t pm_serializer_index_reads;
     perfmon_counter_t pm_serializer_block_writes;
+    perfmon_counter_t pm_serializer_compressed_block_writes;
+    perfmon_counter_t pm_serializer_compression_saved_bytes;
     perfmon_duration_sampler_t pm_serializer_index_writes;
     perfmon_sampler_t pm_serializer_index_writes_size;
+    perfmon_counter_t pm_serializer_metablock_writes;
+    // Index writes that shared the metablock write of another one.
+    perfmon_counter_t pm_serializer_coalesced_metablock_writes;
 
     perfmon_rate_monitor_t pm_serializer_read_bytes_per_sec;
     perfmon_counter_t pm_serializer_read_bytes_total;
@@ -35,6 +40,12 @@ struct log_serializer_stats_t {
     perfmon_counter_t pm_serializer_data_extents_gced;
     perfmon_counter_t pm_serializer_old_garbage_block_bytes;
     perfmon_counter_t pm_serializer_old_total_block_bytes;
+    perfmon_counter_t pm_serializer_foreground_written_block_bytes;
+    perfmon_counter_t pm_serializer_gc_written_block_bytes;
+    // Foreground block writes that went to the cold active extent.
+    perfmon_counter_t pm_serializer_cold_block_writes;
+    // (foreground + GC written bytes) / foreground written bytes
+    perfmon_ratio_t pm_serializer_write_amplification;
 
     /* used in serializer/log/lba/lba_list.cc */
     perfmon_counter_t pm_serializer_lba_gcs;
@@ -0,0 +1,224 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "serializer/log/striped_file.hpp"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "config/args.hpp"
+
+namespace {
+
+/* Runs `done` once `count` operations have completed successfully.  If any of them
+fails, `cb` gets the first failure instead. */
+class counting_iocallback_t : public linux_iocallback_t {
+public:
+    counting_iocallback_t(size_t count, linux_iocallback_t *cb,
+                          std::function<void()> &&done)
+        : remaining_(count), cb_(cb), done_(std::move(done)), failed_(false),
+          errsv_(0), offset_(0), count_(0) {
+        guarantee(remaining_ > 0);
+    }
+
+    void on_io_complete() {
+        finish();
+    }
+
+    void on_io_failure(int errsv, int64_t offset, int64_t count) {
+        if (!failed_) {
+            failed_ = true;
+            errsv_ = errsv;
+            offset_ = offset;
+            count_ = count;
+        }
+        finish();
+    }
+
+private:
+    void finish() {
+        guarantee(remaining_ > 0);
+        --remaining_;
+        if (remaining_ == 0) {
+            if (failed_) {
+                cb_->on_io_failure(errsv_, offset_, count_);
+            } else {
+                done_();
+            }
+            delete this;
+        }
+    }
+
+    size_t remaining_;
+    linux_iocallback_t *const cb_;
+    const std::function<void()> done_;
+    bool failed_;
+    int errsv_;
+    int64_t offset_;
+    int64_t count_;
+
+    DISABLE_COPYING(counting_iocallback_t);
+};
+
+}  // namespace
+
+struct striped_file_t::account_t {
+    std::vector<scoped_ptr_t<file_account_t> > stripe_accounts;
+};
+
+striped_file_t::striped_file_t(std::vector<scoped_ptr_t<file_t> > &&stripes)
+    : stripes_(std::move(stripes)) {
+    guarantee(stripes_.size() >= 1 && stripes_.size() <= MAX_SERIALIZER_STRIPES);
+}
+
+striped_file_t::~striped_file_t() { }
+
+size_t striped_file_t::stripe_of(int64_t offset, size_t num_stripes) {
+    return (offset / SERIALIZER_STRIPE_UNIT_SIZE) % num_stripes;
+}
+
+int64_t striped_file_t::stripe_offset(int64_t offset, size_t num_stripes) {
+    const int64_t unit = offset / SERIALIZER_STRIPE_UNIT_SIZE;
+    return (unit / num_stripes) * SERIALIZER_STRIPE_UNIT_SIZE
+        + offset % SERIALIZER_STRIPE_UNIT_SIZE;
+}
+
+int64_t striped_file_t::stripe_size(int64_t size, size_t i, size_t num_stripes) {
+    const int64_t round_size = SERIALIZER_STRIPE_UNIT_SIZE * num_stripes;
+    const int64_t rest = size % round_size - static_cast<int64_t>(i)
+        * SERIALIZER_STRIPE_UNIT_SIZE;
+    return (size / round_size) * SERIALIZER_STRIPE_UNIT_SIZE
+        + std::min<int64_t>(std::max<int64_t>(rest, 0), SERIALIZER_STRIPE_UNIT_SIZE);
+}
+
+size_t striped_file_t::stripe_of_range(int64_t offset, size_t length) const {
+    guarantee(length == 0
+              || offset / SERIALIZER_STRIPE_UNIT_SIZE
+                 == (offset + static_cast<int64_t>(length) - 1)
+                    / SERIALIZER_STRIPE_UNIT_SIZE,
+              "An i/o request crosses a stripe boundary.  Striped serializer files "
+              "need an extent size that divides %" PRIi64 ".",
+              static_cast<int64_t>(SERIALIZER_STRIPE_UNIT_SIZE));
+    return stripe_of(offset, stripes_.size());
+}
+
+file_account_t *striped_file_t::stripe_account(file_account_t *account,
+                                               size_t i) const {
+    if (account == DEFAULT_DISK_ACCOUNT) {
+        return DEFAULT_DISK_ACCOUNT;
+    }
+    return static_cast<account_t *>(account->get_account())->stripe_accounts[i].get();
+}
+
+int64_t striped_file_t::get_file_size() {
+    // The stripes can be larger than we asked for, because files grow in chunks.
+    // The logical file ends where the first stripe runs out.
+    int64_t size = INT64_MAX;
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        const int64_t stripe_size = stripes_[i]->get_file_size();
+        const int64_t full_units = stripe_size / SERIALIZER_STRIPE_UNIT_SIZE;
+        const int64_t covered =
+            (full_units * stripes_.size() + i) * SERIALIZER_STRIPE_UNIT_SIZE
+            + stripe_size % SERIALIZER_STRIPE_UNIT_SIZE;
+        size = std::min(size, covered);
+    }
+    return size;
+}
+
+void striped_file_t::set_file_size(int64_t size) {
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        stripes_[i]->set_file_size(stripe_size(size, i, stripes_.size()));
+    }
+}
+
+void striped_file_t::set_file_size_at_least(int64_t size, int64_t extent_size) {
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        stripes_[i]->set_file_size_at_least(stripe_size(size, i, stripes_.size()),
+                                            extent_size);
+    }
+}
+
+void striped_file_t::read_async(int64_t offset, size_t length, void *buf,
+                                file_account_t *account, linux_iocallback_t *cb) {
+    const size_t i = stripe_of_range(offset, length);
+    stripes_[i]->read_async(stripe_offset(offset, stripes_.size()), length, buf,
+                            stripe_account(account, i), cb);
+}
+
+void striped_file_t::write_async(int64_t offset, size_t length, const void *buf,
+                                 file_account_t *account, linux_iocallback_t *cb,
+                                 datasync_op ds_op) {
+    const size_t i = stripe_of_range(offset, length);
+    const int64_t local_offset = stripe_offset(offset, stripes_.size());
+    file_t *stripe = stripes_[i].get();
+    file_account_t *local_account = stripe_account(account, i);
+    if (ds_op == datasync_op::no_datasyncs || stripes_.size() == 1) {
+        stripe->write_async(local_offset, length, buf, local_account, cb, ds_op);
+    } else if (ds_op == datasync_op::wrap_in_datasyncs) {
+        // The write itself syncs its own stripe first.
+        datasync_stripes(i, account, new counting_iocallback_t(1, cb,
+            [=]() {
+                stripe->write_async(local_offset, length, buf, local_account, cb,
+                                    datasync_op::wrap_in_datasyncs);
+            }));
+    } else {
+        counting_iocallback_t *all_done = new counting_iocallback_t(2, cb,
+            [cb]() { cb->on_io_complete(); });
+        stripe->write_async(local_offset, length, buf, local_account, all_done,
+                            datasync_op::datasync_after);
+        datasync_stripes(i, account, all_done);
+    }
+}
+
+void striped_file_t::writev_async(int64_t offset, size_t length,
+                                  scoped_array_t<iovec> &&bufs,
+                                  file_account_t *account, linux_iocallback_t *cb) {
+    const size_t i = stripe_of_range(offset, length);
+    stripes_[i]->writev_async(stripe_offset(offset, stripes_.size()), length,
+                              std::move(bufs), stripe_account(account, i), cb);
+}
+
+void striped_file_t::datasync_async(file_account_t *account, linux_iocallback_t *cb) {
+    datasync_stripes(stripes_.size(), account, cb);
+}
+
+void striped_file_t::datasync_stripes(size_t except, file_account_t *account,
+                                      linux_iocallback_t *cb) {
+    const size_t count = except < stripes_.size()
+        ? stripes_.size() - 1
+        : stripes_.size();
+    if (count == 0) {
+        cb->on_io_complete();
+        return;
+    }
+    counting_iocallback_t *all_done = new counting_iocallback_t(count, cb,
+        [cb]() { cb->on_io_complete(); });
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        if (i != except) {
+            stripes_[i]->datasync_async(stripe_account(account, i), all_done);
+        }
+    }
+}
+
+void *striped_file_t::create_account(int priority, int outstanding_requests_limit) {
+    account_t *account = new account_t;
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        account->stripe_accounts.push_back(make_scoped<file_account_t>(
+            stripes_[i].get(), priority, outstanding_requests_limit));
+    }
+    return account;
+}
+
+void striped_file_t::destroy_account(void *account) {
+    delete static_cast<account_t *>(account);
+}
+
+bool striped_file_t::coop_lock_and_check() {
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        if (!stripes_[i]->coop_lock_and_check()) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_LOG_STRIPED_FILE_HPP_
+#define SERIALIZER_LOG_STRIPED_FILE_HPP_
+
+#include <vector>
+
+#include "arch/types.hpp"
+#include "containers/scoped.hpp"
+
+/* A `striped_file_t` spreads a single serializer file over several files, which can
+live on different devices, so that the i/o of a single table's serializer runs on all
+of them in parallel.
+
+The logical file is cut into units of `SERIALIZER_STRIPE_UNIT_SIZE` bytes.  Unit `k`
+is stored in stripe `k % n`, at offset `(k / n) * SERIALIZER_STRIPE_UNIT_SIZE`.  The
+serializer never reads or writes across an extent boundary, so as long as the extent
+size divides the stripe unit, every request goes to exactly one stripe.
+
+A write that is wrapped in datasyncs (that's how the serializer writes its
+metablocks) must not reach the disk before the writes that it refers to, which may be
+on the other stripes.  So we datasync the other stripes first. */
+class striped_file_t : public file_t {
+public:
+    explicit striped_file_t(std::vector<scoped_ptr_t<file_t> > &&stripes);
+    ~striped_file_t();
+
+    int64_t get_file_size();
+    void set_file_size(int64_t size);
+    void set_file_size_at_least(int64_t size, int64_t extent_size);
+
+    void read_async(int64_t offset, size_t length, void *buf,
+                    file_account_t *account, linux_iocallback_t *cb);
+    void write_async(int64_t offset, size_t length, const void *buf,
+                     file_account_t *account, linux_iocallback_t *cb,
+                     datasync_op ds_op);
+    void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
+                      file_account_t *account, linux_iocallback_t *cb);
+    void datasync_async(file_account_t *account, linux_iocallback_t *cb);
+
+    void *create_account(int priority, int outstanding_requests_limit);
+    void destroy_account(void *account);
+
+    bool coop_lock_and_check();
+
+    // These are public for the unit tests.
+    static size_t stripe_of(int64_t offset, size_t num_stripes);
+    static int64_t stripe_offset(int64_t offset, size_t num_stripes);
+    // How many bytes of a logical file of the given size stripe `i` holds.
+    static int64_t stripe_size(int64_t size, size_t i, size_t num_stripes);
+
+private:
+    struct account_t;
+
+    // Returns the stripe that holds [offset, offset + length).
+    size_t stripe_of_range(int64_t offset, size_t length) const;
+    file_account_t *stripe_account(file_account_t *account, size_t i) const;
+    // Datasyncs all stripes except `except`, then calls `cb`.
+    void datasync_stripes(size_t except, file_account_t *account,
+                          linux_iocallback_t *cb);
+
+    std::vector<scoped_ptr_t<file_t> > stripes_;
+
+    DISABLE_COPYING(striped_file_t);
+};
+
+#endif  // SERIALIZER_LOG_STRIPED_FILE_HPP_
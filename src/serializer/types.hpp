@@ -134,6 +134,8 @@ class log_serializer_t;
 class block_token_t {
 public:
     int64_t offset() const { return offset_; }
+    // The size of the block as the cache sees it, even if the serializer stores it
+    // compressed.
     block_size_t block_size() const { return block_size_; }
 
 private:
@@ -146,14 +148,27 @@ private:
 
     block_token_t(log_serializer_t *serializer,
                   int64_t initial_offset,
-                  block_size_t initial_ser_block_size);
+                  block_size_t initial_disk_block_size,
+                  block_size_t initial_block_size);
+
+    // The size the block takes up on disk, which is what the serializer's space
+    // accounting is concerned with.
+    block_size_t disk_block_size() const { return disk_block_size_; }
+    // Compressed blocks always save at least a device block, so the sizes differ.
+    bool is_compressed() const {
+        return disk_block_size_.ser_value() != block_size_.ser_value();
+    }
 
     log_serializer_t *const serializer_;
     std::atomic<intptr_t> ref_count_;
 
-    // The block's size.
+    // The block's (uncompressed) size.
     block_size_t block_size_;
 
+    // The block's size on disk.  Equal to block_size_ unless the block is
+    // compressed.
+    block_size_t disk_block_size_;
+
     // Either (a.) a checksum of what the block's on-disk contents should be, (b.)(i.)
     // the value datasync_checksum(), which means the block's write has been datasynced,
     // or (b.)(ii.) the value no_checksum(), which means the block is not known to have
@@ -0,0 +1,235 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "slab_allocator.hpp"
+
+#include <stdint.h>
+
+#if defined(__linux__) && !defined(VALGRIND)
+#include <sys/mman.h>
+#define SLAB_ALLOCATOR_AVAILABLE 1
+#else
+#define SLAB_ALLOCATOR_AVAILABLE 0
+#endif
+
+#include <vector>
+
+#include "arch/spinlock.hpp"
+
+namespace {
+
+/* How much address space we reserve for the slabs.  The reservation itself doesn't
+cost any memory.  If the cache ever needs more than this, the rest of its buffers
+come from malloc. */
+const size_t SLAB_REGION_SIZE = 256 * GIGABYTE;
+const size_t NUM_SIZE_CLASSES = SLAB_MAX_BUFFER_SIZE / DEVICE_BLOCK_SIZE;
+
+// Each chunk starts with its `chunk_t`, its buffers come after that.
+const size_t CHUNK_HEADER_SIZE = DEVICE_BLOCK_SIZE;
+
+size_t size_class_of(size_t size) {
+    return (size + DEVICE_BLOCK_SIZE - 1) / DEVICE_BLOCK_SIZE - 1;
+}
+
+size_t buffer_size_of(size_t size_class) {
+    return (size_class + 1) * DEVICE_BLOCK_SIZE;
+}
+
+}  // namespace
+
+struct slab_allocator_t::chunk_t {
+    char *buffers() {
+        return reinterpret_cast<char *>(this) + CHUNK_HEADER_SIZE;
+    }
+
+    size_t size_class;
+    size_t capacity;
+    size_t num_used;
+    // Buffers past the first `num_carved` ones have never been handed out.
+    size_t num_carved;
+    // The buffers that have been freed, linked through their first bytes.
+    void *free_list;
+
+    // Chunks that have free buffers are in their size class's list.
+    bool is_listed;
+    chunk_t *prev;
+    chunk_t *next;
+};
+
+struct slab_allocator_t::size_class_t {
+    size_class_t() : chunks_with_room(nullptr) { }
+
+    void list(chunk_t *chunk) {
+        rassert(!chunk->is_listed);
+        chunk->is_listed = true;
+        chunk->prev = nullptr;
+        chunk->next = chunks_with_room;
+        if (chunks_with_room != nullptr) {
+            chunks_with_room->prev = chunk;
+        }
+        chunks_with_room = chunk;
+    }
+
+    void unlist(chunk_t *chunk) {
+        rassert(chunk->is_listed);
+        chunk->is_listed = false;
+        if (chunk->prev != nullptr) {
+            chunk->prev->next = chunk->next;
+        } else {
+            chunks_with_room = chunk->next;
+        }
+        if (chunk->next != nullptr) {
+            chunk->next->prev = chunk->prev;
+        }
+    }
+
+    spinlock_t lock;
+    chunk_t *chunks_with_room;
+};
+
+struct slab_allocator_t::chunk_pool_t {
+    chunk_pool_t() : num_fresh_used(0) { }
+
+    spinlock_t lock;
+    // Chunks that have been given back to the kernel.
+    std::vector<chunk_t *> free_chunks;
+    // Chunks past the first `num_fresh_used` have never been used.
+    size_t num_fresh_used;
+};
+
+slab_allocator_t *slab_allocator_t::get() {
+#if SLAB_ALLOCATOR_AVAILABLE
+    static slab_allocator_t *const allocator = []() -> slab_allocator_t * {
+        // We reserve one more chunk than we need, so that we can align the region.
+        void *res = mmap(nullptr, SLAB_REGION_SIZE + SLAB_CHUNK_SIZE, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (res == MAP_FAILED) {
+            return nullptr;
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(res);
+        const uintptr_t aligned = (begin + SLAB_CHUNK_SIZE - 1) & ~(SLAB_CHUNK_SIZE - 1);
+        return new slab_allocator_t(reinterpret_cast<char *>(aligned),
+                                    SLAB_REGION_SIZE / SLAB_CHUNK_SIZE);
+    }();
+    return allocator;
+#else
+    return nullptr;
+#endif
+}
+
+slab_allocator_t::slab_allocator_t(char *region, size_t num_chunks)
+    : region_(region),
+      num_chunks_(num_chunks),
+      size_classes_(new size_class_t[NUM_SIZE_CLASSES]),
+      pool_(new chunk_pool_t) { }
+
+void *slab_allocator_t::allocate(size_t size) {
+    guarantee(size > 0 && size <= SLAB_MAX_BUFFER_SIZE);
+    const size_t size_class = size_class_of(size);
+    const size_t buffer_size = buffer_size_of(size_class);
+    size_class_t *sc = &size_classes_[size_class];
+
+    spinlock_acq_t acq(&sc->lock);
+    chunk_t *chunk = sc->chunks_with_room;
+    if (chunk == nullptr) {
+        chunk = take_chunk();
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+        chunk->size_class = size_class;
+        chunk->capacity = (SLAB_CHUNK_SIZE - CHUNK_HEADER_SIZE) / buffer_size;
+        chunk->num_used = 0;
+        chunk->num_carved = 0;
+        chunk->free_list = nullptr;
+        chunk->is_listed = false;
+        sc->list(chunk);
+    }
+
+    void *buffer;
+    if (chunk->free_list != nullptr) {
+        buffer = chunk->free_list;
+        chunk->free_list = *static_cast<void **>(buffer);
+    } else {
+        rassert(chunk->num_carved < chunk->capacity);
+        buffer = chunk->buffers() + chunk->num_carved * buffer_size;
+        ++chunk->num_carved;
+    }
+    ++chunk->num_used;
+    if (chunk->num_used == chunk->capacity) {
+        sc->unlist(chunk);
+    }
+    return buffer;
+}
+
+void slab_allocator_t::deallocate(void *ptr) {
+    rassert(owns(ptr));
+    const size_t chunk_index =
+        (static_cast<char *>(ptr) - region_) / SLAB_CHUNK_SIZE;
+    chunk_t *chunk = reinterpret_cast<chunk_t *>(region_ + chunk_index * SLAB_CHUNK_SIZE);
+    // The chunk can't change its size class while one of its buffers is in use.
+    size_class_t *sc = &size_classes_[chunk->size_class];
+
+    bool give_back = false;
+    {
+        spinlock_acq_t acq(&sc->lock);
+        *static_cast<void **>(ptr) = chunk->free_list;
+        chunk->free_list = ptr;
+        rassert(chunk->num_used > 0);
+        --chunk->num_used;
+        if (!chunk->is_listed) {
+            sc->list(chunk);
+        }
+        // We keep one empty chunk around, so that a size class that allocates and
+        // frees a single buffer over and over doesn't keep mapping a chunk in and
+        // out.
+        if (chunk->num_used == 0
+            && !(sc->chunks_with_room == chunk && chunk->next == nullptr)) {
+            sc->unlist(chunk);
+            give_back = true;
+        }
+    }
+    if (give_back) {
+        give_back_chunk(chunk);
+    }
+}
+
+slab_allocator_t::chunk_t *slab_allocator_t::take_chunk() {
+    char *chunk;
+    {
+        spinlock_acq_t acq(&pool_->lock);
+        if (!pool_->free_chunks.empty()) {
+            chunk_t *res = pool_->free_chunks.back();
+            pool_->free_chunks.pop_back();
+            return res;
+        }
+        if (pool_->num_fresh_used == num_chunks_) {
+            return nullptr;
+        }
+        chunk = region_ + pool_->num_fresh_used * SLAB_CHUNK_SIZE;
+        ++pool_->num_fresh_used;
+    }
+#if SLAB_ALLOCATOR_AVAILABLE
+    int res = mprotect(chunk, SLAB_CHUNK_SIZE, PROT_READ | PROT_WRITE);
+    guarantee_err(res == 0, "mprotect failed on a slab chunk");
+#ifdef MADV_HUGEPAGE
+    // This is only a hint.  It fails if the kernel doesn't have transparent huge
+    // pages, and then we simply get normal pages.
+    UNUSED int advise_res = madvise(chunk, SLAB_CHUNK_SIZE, MADV_HUGEPAGE);
+#endif
+#endif
+    return reinterpret_cast<chunk_t *>(chunk);
+}
+
+void slab_allocator_t::give_back_chunk(chunk_t *chunk) {
+#if SLAB_ALLOCATOR_AVAILABLE
+    // The mapping stays, but the kernel can reclaim the memory.  It reads as zeros
+    // afterwards.
+    int res = madvise(chunk, SLAB_CHUNK_SIZE, MADV_DONTNEED);
+    guarantee_err(res == 0, "madvise failed on a slab chunk");
+#endif
+    spinlock_acq_t acq(&pool_->lock);
+    pool_->free_chunks.push_back(chunk);
+}
+
+size_t slab_allocator_t::chunks_in_use() const {
+    spinlock_acq_t acq(&pool_->lock);
+    return pool_->num_fresh_used - pool_->free_chunks.size();
+}
@@ -0,0 +1,68 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef SLAB_ALLOCATOR_HPP_
+#define SLAB_ALLOCATOR_HPP_
+
+#include <stddef.h>
+
+#include "config/args.hpp"
+#include "errors.hpp"
+
+/* `slab_allocator_t` hands out the DEVICE_BLOCK_SIZE-aligned buffers that hold the
+cache's pages and the serializer's i/o.  Those are allocated and freed all the time,
+in a handful of sizes, and the cache keeps gigabytes of them around.  With malloc,
+every 4 KB page we touch costs its own TLB entry.
+
+Buffers of up to `SLAB_MAX_BUFFER_SIZE` bytes are carved out of 2 MB chunks, one size
+class per chunk, and we ask the kernel to back the chunks with transparent huge
+pages.  The chunks live in one range of address space that we reserve up front, so
+that `deallocate()` can recognize slab buffers by their address.  Chunks that become
+empty are given back to the kernel.
+
+The allocator is thread safe: buffers often get allocated on one thread and freed on
+another (the serializer and the cache run on different threads). */
+
+const size_t SLAB_CHUNK_SIZE = 2 * MEGABYTE;
+const size_t SLAB_MAX_BUFFER_SIZE = 64 * KILOBYTE;
+
+class slab_allocator_t {
+public:
+    // Returns null if we couldn't reserve the address space, or on platforms without
+    // the needed support.
+    static slab_allocator_t *get();
+
+    // `size` must be at most `SLAB_MAX_BUFFER_SIZE`.  The buffer is DEVICE_BLOCK_SIZE
+    // aligned.  Returns null if all of the reserved address space is in use.
+    void *allocate(size_t size);
+    // `ptr` must satisfy `owns()`.
+    void deallocate(void *ptr);
+
+    bool owns(const void *ptr) const {
+        return static_cast<const char *>(ptr) >= region_
+            && static_cast<const char *>(ptr) < region_ + num_chunks_ * SLAB_CHUNK_SIZE;
+    }
+
+    // The number of chunks that are currently in use.
+    size_t chunks_in_use() const;
+
+private:
+    struct chunk_t;
+    struct size_class_t;
+    struct chunk_pool_t;
+
+    slab_allocator_t(char *region, size_t num_chunks);
+    // We never destroy the allocator, buffers can be freed during shutdown.
+    ~slab_allocator_t() = delete;
+
+    // Takes a chunk from the pool, or returns null if there are none left.
+    chunk_t *take_chunk();
+    void give_back_chunk(chunk_t *chunk);
+
+    char *const region_;
+    const size_t num_chunks_;
+    size_class_t *const size_classes_;
+    chunk_pool_t *const pool_;
+
+    DISABLE_COPYING(slab_allocator_t);
+};
+
+#endif  // SLAB_ALLOCATOR_HPP_
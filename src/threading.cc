@@ -66,14 +66,33 @@ thread_allocator_t::~thread_allocator_t() {
 thread_allocation_t::thread_allocation_t(thread_allocator_t *p)
     : thread(0), /* temporary, will be overwritten below */
       parent(p) {
+    allocate([](threadnum_t) { return true; });
+}
+
+thread_allocation_t::thread_allocation_t(thread_allocator_t *p, threadnum_t near)
+    : thread(0), /* temporary, will be overwritten below */
+      parent(p) {
+    const int near_node = get_thread_numa_node(near);
+    allocate([near_node](threadnum_t t) {
+        return get_thread_numa_node(t) == near_node;
+    });
+}
+
+void thread_allocation_t::allocate(const std::function<bool(threadnum_t)> &is_near) {
     parent->assert_thread();
     int32_t best_thread = 0;
+    bool best_is_near = is_near(threadnum_t(0));
     for (int32_t i = 1; static_cast<size_t>(i) < parent->num_allocated.size(); ++i) {
+        const bool i_is_near = is_near(threadnum_t(i));
         if (parent->num_allocated[i] < parent->num_allocated[best_thread]) {
             best_thread = i;
+            best_is_near = i_is_near;
         } else if (parent->num_allocated[i] == parent->num_allocated[best_thread] &&
-                   parent->secondary_lt(threadnum_t(i), threadnum_t(best_thread))) {
+                   (i_is_near != best_is_near
+                    ? i_is_near
+                    : parent->secondary_lt(threadnum_t(i), threadnum_t(best_thread)))) {
             best_thread = i;
+            best_is_near = i_is_near;
         }
     }
     thread = threadnum_t(best_thread);
@@ -111,9 +111,15 @@ private:
 class thread_allocation_t {
 public:
     explicit thread_allocation_t(thread_allocator_t *p);
+    // Among the least loaded threads, prefers the ones on the same NUMA node as
+    // `near`.  Objects that talk to each other a lot, such as a table's cache and
+    // its serializer, should then share memory that is local to both of them.
+    thread_allocation_t(thread_allocator_t *p, threadnum_t near);
     ~thread_allocation_t();
     threadnum_t get_thread() const;
 private:
+    void allocate(const std::function<bool(threadnum_t)> &is_near);
+
     threadnum_t thread;
     thread_allocator_t *parent;
     DISABLE_COPYING(thread_allocation_t);
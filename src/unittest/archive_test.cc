@@ -1,10 +1,14 @@
 // Copyright 2010-2012 RethinkDB, all rights reserved.
 #include <string>
+#include <vector>
 
 #include "unittest/gtest.hpp"
 
 #include "containers/archive/boost_types.hpp"
+#include "containers/archive/buffer_stream.hpp"
+#include "containers/archive/compressed.hpp"
 #include "containers/archive/stl_types.hpp"
+#include "random.hpp"
 
 namespace unittest {
 
@@ -34,6 +38,75 @@ TEST(WriteMessageTest, Variant) {
     ASSERT_EQ(15u, s.size());
 }
 
+/* Serializes `value` wrapped in a `compressed_t`, checks that it comes back unchanged
+and returns the size of its serialization. */
+size_t round_trip_compressed(const std::string &value, bool compress) {
+    write_message_t wm;
+    serialize<cluster_version_t::LATEST_OVERALL>(
+        &wm, compressed_t<std::string>(std::string(value), compress));
+    std::string s;
+    dump_to_string(&wm, &s);
+
+    buffer_read_stream_t stream(s.data(), s.size());
+    compressed_t<std::string> out;
+    archive_result_t res =
+        deserialize<cluster_version_t::LATEST_OVERALL>(&stream, &out);
+    EXPECT_EQ(archive_result_t::SUCCESS, res);
+    EXPECT_EQ(static_cast<int64_t>(s.size()), stream.tell());
+    EXPECT_EQ(value, out.value);
+    return s.size();
+}
+
+TEST(WriteMessageTest, Compressed) {
+    std::string repetitive;
+    while (repetitive.size() < 100000) {
+        repetitive += "{\"id\": 17, \"name\": \"some value\"} ";
+    }
+    // Small or incompressible messages are sent as they are, behind a `false`.
+    ASSERT_EQ(1 + 1 + 5u, round_trip_compressed("hello", true));
+    ASSERT_EQ(1 + 3 + repetitive.size(), round_trip_compressed(repetitive, false));
+    std::string random;
+    for (int i = 0; i < 5000; ++i) {
+        random.push_back(static_cast<char>(randint(256)));
+    }
+    ASSERT_EQ(1 + 2 + random.size(), round_trip_compressed(random, true));
+
+    ASSERT_LT(round_trip_compressed(repetitive, true), repetitive.size() / 10);
+}
+
+TEST(WriteMessageTest, RawVector) {
+    std::vector<int64_t> v;
+    for (int i = 0; i < 2000; ++i) {
+        v.push_back(randint(1000000) - 500000);
+    }
+
+    // Copying the whole vector at once must give the same bytes as serializing the
+    // elements one by one.
+    write_message_t wm;
+    serialize<cluster_version_t::LATEST_OVERALL>(&wm, v);
+    std::string s;
+    dump_to_string(&wm, &s);
+    write_message_t expected_wm;
+    serialize_varint_uint64(&expected_wm, v.size());
+    for (int64_t x : v) {
+        serialize<cluster_version_t::LATEST_OVERALL>(&expected_wm, x);
+    }
+    std::string expected;
+    dump_to_string(&expected_wm, &expected);
+    ASSERT_EQ(expected, s);
+    ASSERT_EQ(s.size(), serialized_size<cluster_version_t::LATEST_OVERALL>(v));
+
+    buffer_read_stream_t stream(s.data(), s.size());
+    std::vector<int64_t> out;
+    ASSERT_EQ(archive_result_t::SUCCESS,
+              deserialize<cluster_version_t::LATEST_OVERALL>(&stream, &out));
+    ASSERT_EQ(v, out);
+
+    buffer_read_stream_t truncated(s.data(), s.size() - 1);
+    ASSERT_EQ(archive_result_t::SOCK_EOF,
+              deserialize<cluster_version_t::LATEST_OVERALL>(&truncated, &out));
+}
+
 
 
 }  // namespace unittest
@@ -0,0 +1,66 @@
+// Copyright 2010-2015 RethinkDB, all rights reserved.
+#include "rdb_protocol/base64.hpp"
+#include "rdb_protocol/error.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+TEST(Base64, KnownValues) {
+    EXPECT_EQ("", encode_base64("", 0));
+    EXPECT_EQ("Zg==", encode_base64("f", 1));
+    EXPECT_EQ("Zm8=", encode_base64("fo", 2));
+    EXPECT_EQ("Zm9v", encode_base64("foo", 3));
+    EXPECT_EQ("Zm9vYmFy", encode_base64("foobar", 6));
+    EXPECT_EQ("+/+/", encode_base64("\xfb\xff\xbf", 3));
+
+    EXPECT_EQ("foobar", decode_base64("Zm9vYmFy", 8));
+    EXPECT_EQ("fo", decode_base64("Zm8=", 4));
+    EXPECT_EQ("fo", decode_base64("Zm8", 3));
+}
+
+TEST(Base64, RoundTrip) {
+    // Long enough for several lines, at every length mod the vector sizes.
+    for (size_t size = 0; size < 300; ++size) {
+        std::string data;
+        for (size_t i = 0; i < size; ++i) {
+            data.push_back(static_cast<char>(randint(256)));
+        }
+        std::string encoded = encode_base64(data.data(), data.size());
+
+        // Lines of 76 characters separated by CRLFs.
+        size_t line_start = 0;
+        for (;;) {
+            size_t line_end = encoded.find("\r\n", line_start);
+            if (line_end == std::string::npos) {
+                EXPECT_LE(encoded.size() - line_start, 76u);
+                break;
+            }
+            EXPECT_EQ(76u, line_end - line_start);
+            line_start = line_end + 2;
+        }
+
+        EXPECT_EQ(data, decode_base64(encoded.data(), encoded.size()));
+    }
+}
+
+TEST(Base64, Whitespace) {
+    std::string encoded = "QUJD REVG\tR0hJ\nSktM\r\nTU5P UFFS U1RV VldY WVph YmNk"
+        "ZWZn aGlq a2xt bm8=";
+    EXPECT_EQ("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmno",
+              decode_base64(encoded.data(), encoded.size()));
+}
+
+TEST(Base64, Errors) {
+    // Put the bad character behind enough valid ones for the bulk decoder.
+    std::string prefix(64, 'A');
+    std::string invalid = prefix + "AB!D";
+    EXPECT_THROW(decode_base64(invalid.data(), invalid.size()), ql::base_exc_t);
+    std::string one_left = prefix + "A";
+    EXPECT_THROW(decode_base64(one_left.data(), one_left.size()), ql::base_exc_t);
+    std::string after_padding = prefix + "AB==CD";
+    EXPECT_THROW(decode_base64(after_padding.data(), after_padding.size()),
+                 ql::base_exc_t);
+}
+
+}  // namespace unittest
@@ -0,0 +1,59 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "client_protocol/binary.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/datum_string.hpp"
+#include "rdb_protocol/error.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+std::string encode(const ql::datum_t &datum) {
+    std::string out;
+    binary_protocol_t::write_datum(datum, &out);
+    return out;
+}
+
+TPTEST(BinaryProtocolTest, Scalars) {
+    ASSERT_EQ(std::string("\x00", 1), encode(ql::datum_t::null()));
+    ASSERT_EQ("\x01", encode(ql::datum_t::boolean(false)));
+    ASSERT_EQ("\x02", encode(ql::datum_t::boolean(true)));
+
+    // Integers are zigzag varints.
+    ASSERT_EQ(std::string("\x03\x00", 2), encode(ql::datum_t(0.0)));
+    ASSERT_EQ("\x03\x0a", encode(ql::datum_t(5.0)));
+    ASSERT_EQ("\x03\x01", encode(ql::datum_t(-1.0)));
+    ASSERT_EQ("\x03\xac\x02", encode(ql::datum_t(150.0)));
+
+    // Other numbers, including -0.0, are little-endian doubles.
+    ASSERT_EQ(std::string("\x04\x00\x00\x00\x00\x00\x00\xe0\x3f", 9),
+              encode(ql::datum_t(0.5)));
+    ASSERT_EQ(std::string("\x04\x00\x00\x00\x00\x00\x00\x00\x80", 9),
+              encode(ql::datum_t(-0.0)));
+
+    ASSERT_EQ("\x05\x02" "ab", encode(ql::datum_t("ab")));
+    ASSERT_EQ(std::string("\x09\x03" "a\x00" "b", 5),
+              encode(ql::datum_t::binary(datum_string_t(std::string("a\x00" "b", 3)))));
+}
+
+TPTEST(BinaryProtocolTest, ArraysAndObjects) {
+    std::vector<ql::datum_t> array;
+    array.push_back(ql::datum_t(1.0));
+    array.push_back(ql::datum_t("x"));
+    ASSERT_EQ("\x06\x03\x02\x05\x01x\x08",
+              encode(ql::datum_t(std::move(array), ql::configured_limits_t())));
+
+    std::vector<std::pair<datum_string_t, ql::datum_t> > object;
+    object.push_back(std::make_pair(datum_string_t("a"), ql::datum_t::boolean(true)));
+    ASSERT_EQ("\x07\x01" "a\x02\x08", encode(ql::datum_t(std::move(object))));
+}
+
+TPTEST(BinaryProtocolTest, MinvalIsAnError) {
+    ASSERT_THROW(encode(ql::datum_t::minval()), ql::base_exc_t);
+}
+
+}  // namespace unittest
@@ -1,6 +1,7 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "buffer_cache/alt.hpp"
 #include "buffer_cache/blob.hpp"
+#include "buffer_cache/blob_read_stream.hpp"
 #include "buffer_cache/cache_balancer.hpp"
 #include "containers/buffer_group.hpp"
 #include "containers/scoped.hpp"
@@ -81,8 +82,28 @@ public:
         }
     }
 
+    void check_stream(txn_t *txn) {
+        SCOPED_TRACE("check_stream");
+        blob_read_stream_t stream(buf_parent_t(txn), txn->cache()->max_block_size(),
+                                  buf_.data(), buf_.size());
+        // An odd read size, so that reads straddle leaf and chunk boundaries.
+        std::string contents;
+        char piece[1001];
+        for (;;) {
+            int64_t res = stream.read(piece, sizeof(piece));
+            ASSERT_LE(0, res);
+            if (res == 0) {
+                break;
+            }
+            contents.append(piece, res);
+        }
+        ASSERT_TRUE(stream.entire_stream_consumed());
+        ASSERT_EQ(expected_, contents);
+    }
+
     void check(txn_t *txn) {
         check_region(txn, 0, expected_.size());
+        check_stream(txn);
         check_normalization(txn);
     }
 
@@ -2,6 +2,7 @@
 
 #include "arch/io/disk.hpp"
 #include "arch/types.hpp"
+#include "btree/bulk_load.hpp"
 #include "btree/reql_specific.hpp"
 #include "buffer_cache/cache_balancer.hpp"
 #include "rdb_protocol/btree.hpp"
@@ -174,6 +175,34 @@ public:
         set(key, value, repli_timestamp_t::distant_past);
     }
 
+    // The keys must be in order, and after every key that's in the btree already.
+    void bulk_append(const std::vector<std::pair<store_key_t, std::string> > &kvs) {
+        run_txn_fn(true, [&](scoped_ptr_t<real_superblock_t> &&superblock){
+            btree_bulk_appender_t appender(
+                sizer.get(), superblock.get(), repli_timestamp_t::distant_past);
+            for (const auto &pair : kvs) {
+                short_value_buffer_t buf(pair.second);
+                appender.append(pair.first.btree_key(), buf.data());
+            }
+            EXPECT_EQ(static_cast<int64_t>(kvs.size()), appender.num_appended());
+        });
+
+        for (const auto &pair : kvs) {
+            kv[pair.first] = pair.second;
+        }
+    }
+
+    void merge_leaf(const store_key_t &key) {
+        run_txn_fn(true, [&](scoped_ptr_t<real_superblock_t> &&superblock){
+            noop_value_deleter_t deleter;
+            store_key_t last_key;
+            if (merge_leaf_if_possible(sizer.get(), superblock.get(), key.btree_key(),
+                                       &deleter, &last_key)) {
+                EXPECT_TRUE(kv.empty() || last_key <= kv.rbegin()->first);
+            }
+        });
+    }
+
     void remove(const store_key_t &key, repli_timestamp_t timestamp) {
         EXPECT_TRUE(should_have(key));
 
@@ -507,4 +536,61 @@ TPTEST(BTree, RemoveRandomOrder) {
     ctx.verify();
 }
 
+TPTEST(BTree, BulkAppend) {
+    BTreeTestContext ctx;
+    rng_t rng;
+
+    for (int i = 0; i < 20; i++) {
+        ctx.set(store_key_t("a" + random_letter_string(&rng, 1, 100)),
+                random_letter_string(&rng, 0, 250));
+    }
+
+    // The keys share a long prefix, so that the separators in the internal nodes are
+    // long too and the internal nodes fill up quickly.
+    const std::string prefix(200, 'b');
+    int next_key = 0;
+    for (int batch = 0; batch < 10; batch++) {
+        std::vector<std::pair<store_key_t, std::string> > kvs;
+        for (int i = 0; i < 500; i++) {
+            kvs.push_back(std::make_pair(
+                store_key_t(prefix + strprintf("%06d", next_key++)),
+                random_letter_string(&rng, 0, 250)));
+        }
+        ctx.bulk_append(kvs);
+        ctx.verify();
+    }
+
+    // The btree must still work normally afterwards.
+    for (int i = 0; i < 500; i++) {
+        ctx.get(ctx.pick_random_key(&rng));
+        ctx.remove(ctx.pick_random_key(&rng));
+        ctx.set(store_key_t(random_letter_string(&rng, 1, 250)),
+                random_letter_string(&rng, 0, 250));
+    }
+    ctx.verify();
+}
+
+TPTEST(BTree, MergeLeaves) {
+    BTreeTestContext ctx;
+    rng_t rng;
+
+    std::vector<store_key_t> keys;
+    for (int i = 0; i < 1000; i++) {
+        keys.push_back(store_key_t(random_letter_string(&rng, 1, 250)));
+        ctx.set(keys.back(), random_letter_string(&rng, 0, 250));
+    }
+    // Removing every other key leaves most leaves about half full.
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        if (ctx.should_have(keys[i])) {
+            ctx.remove(keys[i]);
+        }
+    }
+    ctx.verify();
+
+    for (const store_key_t &key : keys) {
+        ctx.merge_leaf(key);
+    }
+    ctx.verify();
+}
+
 } // namespace unittest
@@ -0,0 +1,67 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <algorithm>
+#include <set>
+
+#include "arch/runtime/coroutines.hpp"
+#include "arch/timing.hpp"
+#include "concurrency/coro_pool.hpp"
+#include "concurrency/queue/unlimited_fifo.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+TPTEST(CoroPoolTest, NonBlockingCallbacksUseFewWorkers) {
+    const int num_tasks = 100;
+    std::set<coro_t *> workers;
+    int done = 0;
+    cond_t all_done;
+    std_function_callback_t<int> callback([&](int, signal_t *) {
+        workers.insert(coro_t::self());
+        if (++done == num_tasks) {
+            all_done.pulse();
+        }
+    });
+
+    unlimited_fifo_queue_t<int> queue;
+    coro_pool_t<int> pool(10, &queue, &callback);
+    for (int i = 0; i < num_tasks; ++i) {
+        queue.push(i);
+    }
+    all_done.wait();
+    ASSERT_LE(workers.size(), 2u);
+}
+
+TPTEST(CoroPoolTest, BlockingCallbacksUseAllWorkers) {
+    const int num_tasks = 50;
+    const int max_workers = 10;
+    int running = 0;
+    int max_running = 0;
+    int done = 0;
+    cond_t unblock;
+    cond_t all_done;
+    std_function_callback_t<int> callback([&](int, signal_t *) {
+        ++running;
+        max_running = std::max(max_running, running);
+        unblock.wait();
+        --running;
+        if (++done == num_tasks) {
+            all_done.pulse();
+        }
+    });
+
+    unlimited_fifo_queue_t<int> queue;
+    coro_pool_t<int> pool(max_workers, &queue, &callback);
+    for (int i = 0; i < num_tasks; ++i) {
+        queue.push(i);
+    }
+    for (int i = 0; i < 100 && running < max_workers; ++i) {
+        nap(1);
+    }
+    ASSERT_EQ(max_workers, running);
+    unblock.pulse();
+    all_done.wait();
+    ASSERT_EQ(max_workers, max_running);
+}
+
+}  // namespace unittest
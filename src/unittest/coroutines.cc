@@ -2,6 +2,7 @@
 
 #include "arch/runtime/coroutines.hpp"
 #include "arch/runtime/runtime.hpp"
+#include "arch/timing.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "config/args.hpp"
 #include "unittest/gtest.hpp"
@@ -106,6 +107,22 @@ TEST(CoroutinesTest, NotifyNow) {
     });
 }
 
+TEST(CoroutinesTest, TimeAccounting) {
+    run_in_thread_pool([&]() {
+        coro_t *self = coro_t::self();
+        self->enable_time_accounting();
+
+        const int64_t busy_nanos = 20 * MILLION;
+        const ticks_t busy_start = get_ticks();
+        while (get_ticks().nanos - busy_start.nanos < busy_nanos) { }
+        nap(50);
+
+        ASSERT_GE(self->get_running_time().nanos, busy_nanos);
+        ASSERT_LT(self->get_running_time().nanos, get_ticks().nanos - busy_start.nanos);
+        ASSERT_GE(self->get_waiting_time().nanos, 50 * MILLION);
+    });
+}
+
 // The following test does not work on 32 bit architectures because it will exceed
 // their virtual memory.
 #if defined (__x86_64__) || defined (_WIN64)
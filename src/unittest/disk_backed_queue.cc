@@ -1,4 +1,5 @@
 // Copyright 2010-2013 RethinkDB, all rights reserved.
+#include <functional>
 #include <queue>
 
 #include "arch/io/disk.hpp"
@@ -18,9 +19,11 @@ serializer_filepath_t dbq_serializer_path() {
     return manual_serializer_filepath(DBQ_TEST_PATH, std::string(DBQ_TEST_PATH) + ".create");
 }
 
-void run_many_ints_test() {
+void run_many_ints_test(disk_backend_t disk_backend) {
     static const int NUM_ELTS_IN_QUEUE = 1000;
-    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired,
+                                DEFAULT_MAX_CONCURRENT_IO_REQUESTS,
+                                disk_backend);
 
     const serializer_filepath_t serializer_path = dbq_serializer_path();
 
@@ -42,7 +45,14 @@ void run_many_ints_test() {
 }
 
 TEST(DiskBackedQueue, ManyInts) {
-    unittest::run_in_thread_pool(&run_many_ints_test, 2);
+    unittest::run_in_thread_pool(
+        std::bind(&run_many_ints_test, disk_backend_t::blocker_pool), 2);
+}
+
+// Falls back to the blocker pool if the kernel doesn't support io_uring.
+TEST(DiskBackedQueue, ManyIntsIoUring) {
+    unittest::run_in_thread_pool(
+        std::bind(&run_many_ints_test, disk_backend_t::io_uring), 2);
 }
 
 void run_big_values_test() {
@@ -74,6 +84,51 @@ TEST(DiskBackedQueue, BigVals) {
     unittest::run_in_thread_pool(&run_big_values_test, 2);
 }
 
+void run_memory_budget_test() {
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+
+    const serializer_filepath_t serializer_path = dbq_serializer_path();
+
+    // Room for roughly 100 ints in memory, the rest spills to disk.
+    disk_backed_queue_t<int> queue(&io_backender, serializer_path,
+                                   &get_global_perfmon_collection(),
+                                   100 * sizeof(int));
+    std::queue<int> ref_queue;
+
+    // Interleave pushes and pops so that the queue goes back and forth between
+    // fitting into memory and spilling.
+    int next = 0;
+    for (int round = 0; round < 20; ++round) {
+        int pushes = randint(300);
+        for (int i = 0; i < pushes; ++i) {
+            queue.push(next);
+            ref_queue.push(next);
+            ++next;
+        }
+        int pops = randint(300);
+        for (int i = 0; i < pops && !ref_queue.empty(); ++i) {
+            ASSERT_FALSE(queue.empty());
+            int x;
+            queue.pop(&x);
+            EXPECT_EQ(ref_queue.front(), x);
+            ref_queue.pop();
+        }
+        EXPECT_EQ(static_cast<int64_t>(ref_queue.size()), queue.size());
+    }
+
+    while (!ref_queue.empty()) {
+        int x;
+        queue.pop(&x);
+        EXPECT_EQ(ref_queue.front(), x);
+        ref_queue.pop();
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(DiskBackedQueue, MemoryBudget) {
+    unittest::run_in_thread_pool(&run_memory_budget_test, 2);
+}
+
 static void randomly_delay(int, signal_t *) {
     nap(randint(100));
 }
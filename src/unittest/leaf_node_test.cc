@@ -126,7 +126,7 @@ public:
 
         store_key_t replacement;
         bool can_level = leaf::level(&sizer_, nodecmp_value, node(), sibling->node(),
-                                     replacement.btree_key(), nullptr);
+                                     replacement.writable_btree_key(), nullptr);
 
         if (can_level) {
             ASSERT_TRUE(!sibling->kv_.empty());
@@ -172,7 +172,7 @@ public:
         ASSERT_TRUE(leaf::is_empty(right->node()));
 
         store_key_t median;
-        leaf::split(&sizer_, node(), right->node(), median.btree_key());
+        leaf::split(&sizer_, node(), right->node(), median.writable_btree_key());
 
         std::map<store_key_t, std::string>::iterator p = kv_.end();
         --p;
@@ -701,6 +701,24 @@ TEST(LeafNodeTest, Splitting) {
     left.Split(&right);
 }
 
+std::string shortest_separator(const std::string &left, const std::string &right) {
+    store_key_t separator;
+    leaf::shortest_separator(store_key_t(left).btree_key(),
+                             store_key_t(right).btree_key(),
+                             separator.writable_btree_key());
+    return key_to_unescaped_str(separator);
+}
+
+TEST(LeafNodeTest, ShortestSeparator) {
+    ASSERT_EQ("b", shortest_separator("abc", "bcd"));
+    ASSERT_EQ("abd", shortest_separator("abcdef", "abdxyz"));
+    // No prefix of the right key is shorter than the left key.
+    ASSERT_EQ("ab", shortest_separator("ab", "abc"));
+    ASSERT_EQ("abc", shortest_separator("abc", "abd"));
+    ASSERT_EQ("abcdef", shortest_separator("abcdef", "abd"));
+    ASSERT_EQ("", shortest_separator("", "a"));
+}
+
 TEST(LeafNodeTest, Fullness) {
     LeafNodeTracker node;
     int i;
@@ -0,0 +1,71 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "containers/loser_tree.hpp"
+#include "random.hpp"
+#include "unittest/gtest.hpp"
+
+namespace unittest {
+
+/* Merges `inputs` with a loser tree, checking every step against a linear scan that
+picks the first input with the smallest head, and returns the merged sequence. */
+static std::vector<int> merge_and_check(const std::vector<std::vector<int> > &inputs) {
+    const int exhausted = std::numeric_limits<int>::max();
+    std::vector<size_t> positions(inputs.size(), 0);
+    auto head = [&](size_t i) {
+        return positions[i] < inputs[i].size() ? inputs[i][positions[i]] : exhausted;
+    };
+    auto beats = [&](size_t a, size_t b) {
+        return head(a) < head(b) || (head(a) == head(b) && a < b);
+    };
+    loser_tree_t<decltype(beats)> tree(inputs.size(), beats);
+    std::vector<int> merged;
+    for (;;) {
+        size_t expected = 0;
+        for (size_t i = 1; i < inputs.size(); ++i) {
+            if (head(i) < head(expected)) {
+                expected = i;
+            }
+        }
+        EXPECT_EQ(expected, tree.winner());
+        if (head(tree.winner()) == exhausted) {
+            break;
+        }
+        merged.push_back(head(tree.winner()));
+        ++positions[tree.winner()];
+        tree.replay_winner();
+    }
+    return merged;
+}
+
+TEST(LoserTree, Single) {
+    std::vector<int> merged = merge_and_check({{1, 2, 3}});
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), merged);
+}
+
+TEST(LoserTree, Ties) {
+    std::vector<int> merged = merge_and_check({{1, 1}, {1}, {0, 1}});
+    EXPECT_EQ((std::vector<int>{0, 1, 1, 1, 1}), merged);
+}
+
+TEST(LoserTree, Random) {
+    rng_t rng(0);
+    for (size_t n = 1; n <= 40; ++n) {
+        std::vector<std::vector<int> > inputs(n);
+        std::vector<int> all;
+        for (auto &&input : inputs) {
+            size_t size = rng.randint(20);
+            for (size_t i = 0; i < size; ++i) {
+                input.push_back(rng.randint(50));
+            }
+            std::sort(input.begin(), input.end());
+            all.insert(all.end(), input.begin(), input.end());
+        }
+        std::sort(all.begin(), all.end());
+        EXPECT_EQ(all, merge_and_check(inputs));
+    }
+}
+
+}  // namespace unittest
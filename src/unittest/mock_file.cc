@@ -71,6 +71,12 @@ void mock_file_t::writev_async(int64_t offset, size_t length, scoped_array_t<iov
     write_async(offset, length, buf.get(), account, cb, datasync_op::no_datasyncs);
 }
 
+void mock_file_t::datasync_async(UNUSED file_account_t *account,
+                                 linux_iocallback_t *cb) {
+    // Everything we write is immediately durable.
+    coro_t::spawn_sometime(std::bind(&linux_iocallback_t::on_io_complete, cb));
+}
+
 bool mock_file_t::coop_lock_and_check() {
     // We don't actually implement the locking behavior.
     return true;
@@ -31,6 +31,7 @@ public:
                      datasync_op ds_op);
     void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                       file_account_t *account, linux_iocallback_t *cb);
+    void datasync_async(file_account_t *account, linux_iocallback_t *cb);
 
     void *create_account(UNUSED int priority, UNUSED int outstanding_requests_limit) {
         // We don't care about accounts.  Return an arbitrary non-null pointer.
@@ -0,0 +1,32 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "unittest/gtest.hpp"
+
+#include "arch/runtime/numa.hpp"
+
+namespace unittest {
+
+TEST(NumaTest, ParseCpuList) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(parse_cpu_list("0-3,8,10-11\n", &cpus));
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 8, 10, 11}), cpus);
+
+    // Memory-only nodes have an empty list.
+    ASSERT_TRUE(parse_cpu_list("\n", &cpus));
+    EXPECT_TRUE(cpus.empty());
+
+    EXPECT_FALSE(parse_cpu_list("3-1", &cpus));
+    EXPECT_FALSE(parse_cpu_list("0,,2", &cpus));
+    EXPECT_FALSE(parse_cpu_list("a-b", &cpus));
+}
+
+TEST(NumaTest, NodeOfThread) {
+    numa_topology_t topology({{0, 1}, {2, 3}});
+    EXPECT_EQ(2, topology.num_nodes());
+    // Contiguous blocks of threads share a node.
+    EXPECT_EQ(0, topology.node_of_thread(0, 5));
+    EXPECT_EQ(0, topology.node_of_thread(2, 5));
+    EXPECT_EQ(1, topology.node_of_thread(3, 5));
+    EXPECT_EQ(1, topology.node_of_thread(4, 5));
+}
+
+}  // namespace unittest
@@ -1,4 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
+#include <string.h>
+
+#include <vector>
+
 #include "arch/runtime/coroutines.hpp"
 #include "arch/timing.hpp"
 #include "buffer_cache/page_cache.hpp"
@@ -264,6 +268,43 @@ TPTEST(PageTest, ReadAfterWrite, 4) {
     pmap(2, std::bind(&ReadAfterWrite_cases, &s, &page_cache, ph::_1));
 }
 
+TPTEST(PageTest, CompressedTier, 4) {
+    mock_ser_t mock;
+    // Small enough that most of the blocks get evicted.
+    dummy_cache_balancer_t balancer(16 * KILOBYTE);
+    test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+    const size_t num_blocks = 32;
+    const uint16_t block_size = page_cache.max_block_size().value();
+
+    std::vector<block_id_t> block_ids;
+    {
+        auto txn = make_scoped<test_txn_t>(&page_cache);
+        for (size_t i = 0; i < num_blocks; ++i) {
+            current_test_acq_t acq(txn.get(), alt_create_t::create);
+            block_ids.push_back(acq.block_id());
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_write(), &page_cache);
+            // These compress very well.
+            memset(page_acq.get_buf_write(), 'a' + i, block_size);
+        }
+        page_cache.flush(std::move(txn));
+    }
+
+    // The second round should find some of the blocks in the compressed tier.
+    for (int round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < num_blocks; ++i) {
+            current_test_acq_t acq(&page_cache, block_ids[i], read_access_t::read);
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_read(), &page_cache);
+            const char *buf = static_cast<const char *>(page_acq.get_buf_read());
+            for (uint16_t j = 0; j < block_size; ++j) {
+                ASSERT_EQ(static_cast<char>('a' + i), buf[j]);
+            }
+        }
+        ASSERT_GT(page_cache.evicter().compressed_tier()->num_entries(), 0u);
+    }
+}
+
 struct WriteWaitForFlush_state_t {
     block_id_t block_id;
     cond_t coro_1_begin;
@@ -0,0 +1,75 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+/* Parses `json` at every offset into a 16 byte block, so that the string parsing code
+hits every position relative to the blocks it scans in bulk. */
+void check_parses_string(const std::string &json, bool valid, const std::string &expected) {
+    for (size_t offset = 0; offset < 16; ++offset) {
+        std::vector<char> buffer(offset + json.size() + 1 + 16);
+        char *start = buffer.data() + offset;
+        memcpy(start, json.c_str(), json.size() + 1);
+
+        rapidjson::Document doc;
+        doc.Parse(start);
+        ASSERT_EQ(valid, !doc.HasParseError()) << json << " at offset " << offset;
+        if (valid) {
+            ASSERT_TRUE(doc.IsString());
+            ASSERT_EQ(expected, std::string(doc.GetString(), doc.GetStringLength()));
+        }
+
+        rapidjson::Document insitu_doc;
+        insitu_doc.ParseInsitu(start);
+        ASSERT_EQ(valid, !insitu_doc.HasParseError()) << json << " at offset " << offset;
+        if (valid) {
+            ASSERT_TRUE(insitu_doc.IsString());
+            ASSERT_EQ(expected,
+                      std::string(insitu_doc.GetString(), insitu_doc.GetStringLength()));
+        }
+    }
+}
+
+TPTEST(RapidjsonTest, StringEscapes) {
+    std::string plain;
+    for (size_t i = 0; i < 40; ++i) {
+        plain.push_back('a' + i % 26);
+    }
+    for (size_t length = 0; length <= plain.size(); ++length) {
+        std::string left = plain.substr(0, length);
+        std::string right = plain.substr(length);
+        check_parses_string("\"" + left + right + "\"", true, left + right);
+        check_parses_string("\"" + left + "\\n\\u00e9\\\"" + right + "\\\\\"",
+                            true, left + "\n\xc3\xa9\"" + right + "\\");
+        check_parses_string("\"" + left + "\xc3\xa9" + right + "\"",
+                            true, left + "\xc3\xa9" + right);
+        // Control characters must be escaped, and strings must be terminated.
+        check_parses_string("\"" + left + "\t" + right + "\"", false, "");
+        check_parses_string("\"" + left + "\\n" + right, false, "");
+    }
+}
+
+std::string write_string(const std::string &str) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.String(str.data(), str.size());
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+TPTEST(RapidjsonTest, WriteString) {
+    ASSERT_EQ("\"\"", write_string(""));
+    ASSERT_EQ("\"abc\"", write_string("abc"));
+    ASSERT_EQ("\"a\\\"b\\\\c\\nd\\u0001\xc3\xa9\\u0000e\"",
+              write_string(std::string("a\"b\\c\nd\x01\xc3\xa9\0e", 11)));
+}
+
+}  // namespace unittest
@@ -1,5 +1,6 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include <functional>
+#include <vector>
 
 #include "arch/runtime/coroutines.hpp"
 #include "concurrency/pmap.hpp"
@@ -58,4 +59,52 @@ TEST(RwlockTest, ReadAfterWrite) {
 
 
 
+TPTEST(RwlockTest, ReaderBias) {
+    for (rwlock_bias_t bias : {rwlock_bias_t::fifo, rwlock_bias_t::readers}) {
+        rwlock_t lock(bias);
+        rwlock_in_line_t first_reader(&lock, access_t::read);
+        ASSERT_TRUE(first_reader.read_signal()->is_pulsed());
+        rwlock_in_line_t writer(&lock, access_t::write);
+        ASSERT_FALSE(writer.write_signal()->is_pulsed());
+
+        // With the reader bias, a new reader joins the first one instead of waiting
+        // behind the writer.
+        rwlock_in_line_t second_reader(&lock, access_t::read);
+        ASSERT_EQ(bias == rwlock_bias_t::readers,
+                  second_reader.read_signal()->is_pulsed());
+
+        first_reader.reset();
+        if (bias == rwlock_bias_t::readers) {
+            ASSERT_FALSE(writer.write_signal()->is_pulsed());
+            second_reader.reset();
+        }
+        ASSERT_TRUE(writer.write_signal()->is_pulsed());
+    }
+}
+
+TPTEST(RwlockTest, ReaderBiasLetsWriterThrough) {
+    rwlock_t lock(rwlock_bias_t::readers);
+    std::vector<scoped_ptr_t<rwlock_in_line_t> > readers;
+    readers.push_back(make_scoped<rwlock_in_line_t>(&lock, access_t::read));
+    rwlock_in_line_t writer(&lock, access_t::write);
+
+    // Readers keep overtaking the writer until there have been too many of them.
+    for (;;) {
+        readers.push_back(make_scoped<rwlock_in_line_t>(&lock, access_t::read));
+        if (!readers.back()->read_signal()->is_pulsed()) {
+            break;
+        }
+        ASSERT_LT(readers.size(), 1000u);
+    }
+    ASSERT_GT(readers.size(), 2u);
+
+    scoped_ptr_t<rwlock_in_line_t> last_reader = std::move(readers.back());
+    readers.pop_back();
+    readers.clear();
+    ASSERT_TRUE(writer.write_signal()->is_pulsed());
+    ASSERT_FALSE(last_reader->read_signal()->is_pulsed());
+    writer.reset();
+    ASSERT_TRUE(last_reader->read_signal()->is_pulsed());
+}
+
 }  // namespace unittest
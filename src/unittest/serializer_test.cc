@@ -1,9 +1,19 @@
 #include <functional>
 
+#include "arch/arch.hpp"
 #include "arch/runtime/starter.hpp"
 #include "concurrency/new_mutex.hpp"
+#include "concurrency/pmap.hpp"
+#include "config/args.hpp"
+#include "random.hpp"
 #include "serializer/buf_ptr.hpp"
+#include "serializer/checksum.hpp"
+#include "serializer/log/block_compression.hpp"
+#include "serializer/log/gc_scheduler.hpp"
+#include "serializer/log/lba/in_memory_index.hpp"
 #include "serializer/log/log_serializer.hpp"
+#include "serializer/log/striped_file.hpp"
+#include "time.hpp"
 #include "unittest/mock_file.hpp"
 #include "unittest/gtest.hpp"
 #include "unittest/unittest_utils.hpp"
@@ -90,5 +100,319 @@ TEST(SerializerTest, AddDeleteRepeatedlyWithIndex) {
     run_in_thread_pool(std::bind(run_AddDeleteRepeatedly, true), 4);
 }
 
+void run_CompressedBlocks() {
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    log_serializer_t::dynamic_config_t dynamic_config;
+    dynamic_config.compress_blocks = true;
+    log_serializer_t ser(dynamic_config,
+                         &file_opener,
+                         &get_global_perfmon_collection());
+
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+
+    // Block 0 compresses well, block 1 doesn't compress at all.
+    std::vector<buf_ptr_t> bufs;
+    for (int i = 0; i < 2; ++i) {
+        buf_ptr_t buf = buf_ptr_t::alloc_zeroed(ser.max_block_size());
+        char *data = static_cast<char *>(buf.cache_data());
+        for (size_t j = 0; j < buf.block_size().value(); ++j) {
+            data[j] = i == 0 ? static_cast<char>(j % 7) : randint(256);
+        }
+        bufs.push_back(std::move(buf));
+    }
+    ASSERT_TRUE(compress_block(bufs[0].ser_buffer(), bufs[0].block_size()).has());
+    ASSERT_FALSE(compress_block(bufs[1].ser_buffer(), bufs[1].block_size()).has());
+
+    std::vector<buf_write_info_t> infos;
+    for (size_t i = 0; i < bufs.size(); ++i) {
+        infos.push_back(buf_write_info_t(bufs[i].ser_buffer(), bufs[i].block_size(), i));
+    }
+
+    struct : public iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } cb;
+    std::vector<counted_t<block_token_t>> tokens
+        = ser.block_writes(infos.data(), infos.size(), account.get(), &cb);
+    cb.wait();
+
+    std::vector<index_write_op_t> write_ops;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        EXPECT_EQ(bufs[i].block_size().ser_value(), tokens[i]->block_size().ser_value());
+        write_ops.push_back(index_write_op_t(i, make_optional(tokens[i]),
+            make_optional(repli_timestamp_t::distant_past)));
+    }
+    {
+        new_mutex_in_line_t dummy_acq;
+        ser.index_write(&dummy_acq, []{ }, write_ops);
+    }
+    tokens.clear();
+
+    // The index has to remember the uncompressed size.
+    for (size_t i = 0; i < bufs.size(); ++i) {
+        counted_t<block_token_t> token = ser.index_read(i);
+        ASSERT_TRUE(token.has());
+        ASSERT_EQ(bufs[i].block_size().ser_value(), token->block_size().ser_value());
+        buf_ptr_t read = ser.block_read(token, account.get());
+        ASSERT_EQ(bufs[i].block_size().ser_value(), read.block_size().ser_value());
+        EXPECT_EQ(0, memcmp(bufs[i].cache_data(), read.cache_data(),
+                            bufs[i].block_size().value()));
+    }
+}
+
+TEST(SerializerTest, CompressedBlocks) {
+    run_in_thread_pool(run_CompressedBlocks, 4);
+}
+
+void run_GroupCommit() {
+    mock_file_opener_t file_opener;
+    log_serializer_t::create(&file_opener, log_serializer_t::static_config_t());
+    const int num_writes = 20;
+    {
+        log_serializer_t::dynamic_config_t dynamic_config;
+        dynamic_config.metablock_group_commit_delay_ms = 5;
+        log_serializer_t ser(dynamic_config,
+                             &file_opener,
+                             &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+        buf_ptr_t buf = buf_ptr_t::alloc_zeroed(ser.max_block_size());
+
+        // Concurrent index writes get grouped, but each of them must still be on disk
+        // when it returns.
+        new_mutex_t mutex;
+        pmap(num_writes, [&](int i) {
+            std::vector<buf_write_info_t> infos;
+            infos.push_back(buf_write_info_t(buf.ser_buffer(), buf.block_size(), i));
+            struct : public iocallback_t, public cond_t {
+                void on_io_complete() {
+                    pulse();
+                }
+            } cb;
+            std::vector<counted_t<block_token_t>> tokens
+                = ser.block_writes(infos.data(), infos.size(), account.get(), &cb);
+            cb.wait();
+
+            std::vector<index_write_op_t> write_ops;
+            write_ops.push_back(index_write_op_t(i, make_optional(tokens[0]),
+                make_optional(repli_timestamp_t::distant_past)));
+            new_mutex_in_line_t acq(&mutex);
+            acq.acq_signal()->wait();
+            ser.index_write(&acq, []{ }, write_ops);
+        });
+    }
+
+    log_serializer_t ser(log_serializer_t::dynamic_config_t(),
+                         &file_opener,
+                         &get_global_perfmon_collection());
+    EXPECT_EQ(static_cast<block_id_t>(num_writes), ser.end_block_id());
+    for (int i = 0; i < num_writes; ++i) {
+        EXPECT_TRUE(ser.index_read(i).has());
+    }
+}
+
+TEST(SerializerTest, GroupCommit) {
+    run_in_thread_pool(run_GroupCommit, 4);
+}
+
+TEST(SerializerTest, GcSchedulerFollowsRates) {
+    const ticks_t start = ticks_t{secs_to_ticks(1000).nanos};
+    const ticks_t later = ticks_t{start.nanos + secs_to_ticks(1).nanos};
+
+    gc_scheduler_t idle;
+    EXPECT_FALSE(idle.should_start(0.05));
+    EXPECT_TRUE(idle.should_start(0.2));
+    EXPECT_EQ(1u, idle.concurrency(0.05, later));
+    EXPECT_EQ(MAX_CONCURRENT_GCS, idle.concurrency(0.5, later));
+    EXPECT_TRUE(idle.wants_high_priority(0.5, later));
+    const size_t base = idle.concurrency(0.25, later);
+    EXPECT_LT(1u, base);
+    EXPECT_FALSE(idle.wants_high_priority(0.25, later));
+
+    // Garbage piles up faster than it's reclaimed.
+    gc_scheduler_t behind;
+    behind.note_garbage(100 * MEGABYTE, start);
+    behind.note_reclaimed(10 * MEGABYTE, start);
+    EXPECT_TRUE(behind.is_falling_behind(later));
+    EXPECT_EQ(std::min(2 * base, MAX_CONCURRENT_GCS), behind.concurrency(0.25, later));
+    EXPECT_TRUE(behind.wants_high_priority(0.25, later));
+
+    // Foreground reads get a lot slower than usual.
+    gc_scheduler_t slow;
+    for (int i = 0; i < 1000; ++i) {
+        slow.note_foreground_read(ticks_t{100 * 1000});
+    }
+    EXPECT_FALSE(slow.foreground_is_slow());
+    for (int i = 0; i < 100; ++i) {
+        slow.note_foreground_read(ticks_t{10 * 1000 * 1000});
+    }
+    EXPECT_TRUE(slow.foreground_is_slow());
+    EXPECT_EQ(std::max<size_t>(1, base / 2), slow.concurrency(0.25, later));
+    // The garbage ratio still wins eventually.
+    EXPECT_EQ(MAX_CONCURRENT_GCS, slow.concurrency(0.5, later));
+}
+
+TEST(SerializerTest, InMemoryIndexRoundTrip) {
+    EXPECT_EQ(16u, sizeof(compact_block_info_t));
+    EXPECT_EQ(8u, sizeof(compact_block_location_t));
+
+    in_memory_index_t index;
+    const int64_t big_offset = (static_cast<int64_t>(1) << 47) + 512;
+    repli_timestamp_t recency;
+    recency.longtime = 12345;
+    index.set_block_info(3, recency, flagged_off64_t::make(big_offset), 4096, 0);
+    index.set_block_info(FIRST_AUX_BLOCK_ID + 1, repli_timestamp_t::invalid,
+                         flagged_off64_t::make(0), 1000, 4096);
+
+    const index_block_info_t info = index.get_block_info(3);
+    EXPECT_EQ(big_offset, info.offset.get_value());
+    EXPECT_EQ(recency, info.recency);
+    EXPECT_EQ(4096, info.ser_block_size);
+    EXPECT_EQ(0, info.uncompressed_ser_block_size);
+
+    const index_block_info_t aux_info = index.get_block_info(FIRST_AUX_BLOCK_ID + 1);
+    EXPECT_EQ(0, aux_info.offset.get_value());
+    EXPECT_EQ(repli_timestamp_t::invalid, aux_info.recency);
+    EXPECT_EQ(1000, aux_info.ser_block_size);
+    EXPECT_EQ(4096, aux_info.uncompressed_ser_block_size);
+
+    // Blocks that were never set, and deleted blocks, read as unused.
+    for (block_id_t id : { static_cast<block_id_t>(2), FIRST_AUX_BLOCK_ID }) {
+        const index_block_info_t unused = index.get_block_info(id);
+        EXPECT_FALSE(unused.offset.has_value());
+        EXPECT_EQ(repli_timestamp_t::invalid, unused.recency);
+        EXPECT_EQ(0, unused.ser_block_size);
+    }
+    index.set_block_info(3, repli_timestamp_t::invalid, flagged_off64_t::unused(), 0, 0);
+    EXPECT_FALSE(index.get_block_info(3).offset.has_value());
+    EXPECT_EQ(4u, index.end_block_id());
+}
+
+TEST(SerializerTest, InMemoryIndexCountsLiveEntries) {
+    in_memory_index_t index;
+    for (block_id_t id = 0; id < 10; ++id) {
+        index.set_block_info(id, repli_timestamp_t::distant_past,
+                             flagged_off64_t::make(id * 4096), 4096, 0);
+    }
+    index.set_block_info(FIRST_AUX_BLOCK_ID + 1, repli_timestamp_t::invalid,
+                         flagged_off64_t::make(0), 1000, 0);
+    // Rewriting a block doesn't change the count, deleting it does.
+    index.set_block_info(4, repli_timestamp_t::distant_past,
+                         flagged_off64_t::make(1 << 20), 4096, 0);
+    index.set_block_info(8, repli_timestamp_t::invalid, flagged_off64_t::unused(), 0, 0);
+    index.set_block_info(8, repli_timestamp_t::invalid, flagged_off64_t::unused(), 0, 0);
+
+    // Shard 0 has blocks 0 and 4, shard 1 has 1, 5, 9 and the aux block.
+    EXPECT_EQ(2, index.live_entries(0));
+    EXPECT_EQ(4, index.live_entries(1));
+    EXPECT_EQ(2, index.live_entries(2));
+    EXPECT_EQ(2, index.live_entries(3));
+}
+
+TPTEST(SerializerTest, StripedFile) {
+    const int64_t unit = SERIALIZER_STRIPE_UNIT_SIZE;
+    std::vector<std::vector<char> > datas(3);
+    std::vector<scoped_ptr_t<file_t> > stripes;
+    for (auto &data : datas) {
+        stripes.push_back(make_scoped<mock_file_t>(mock_file_t::mode_rw, &data));
+    }
+    striped_file_t file(std::move(stripes));
+
+    // 4.5 units: stripe 0 gets units 0 and 3, stripe 1 gets unit 1 and half of
+    // unit 4, stripe 2 gets unit 2.
+    file.set_file_size(4 * unit + unit / 2);
+    EXPECT_EQ(static_cast<size_t>(2 * unit), datas[0].size());
+    EXPECT_EQ(static_cast<size_t>(unit + unit / 2), datas[1].size());
+    EXPECT_EQ(static_cast<size_t>(unit), datas[2].size());
+    EXPECT_EQ(4 * unit + unit / 2, file.get_file_size());
+
+    // A stripe that grew further than needed doesn't make the file look larger.
+    datas[2].resize(3 * unit);
+    EXPECT_EQ(4 * unit + unit / 2, file.get_file_size());
+
+    scoped_device_block_aligned_ptr_t<char> buf(DEVICE_BLOCK_SIZE);
+    for (int64_t k = 0; k < 5; ++k) {
+        memset(buf.get(), 'a' + k, DEVICE_BLOCK_SIZE);
+        const int64_t offset = k * unit + DEVICE_BLOCK_SIZE;
+        co_write(&file, offset, DEVICE_BLOCK_SIZE, buf.get(), DEFAULT_DISK_ACCOUNT,
+                 k == 4 ? datasync_op::wrap_in_datasyncs : datasync_op::no_datasyncs);
+        EXPECT_EQ('a' + k, datas[striped_file_t::stripe_of(offset, 3)]
+                              [striped_file_t::stripe_offset(offset, 3)]);
+    }
+    for (int64_t k = 0; k < 5; ++k) {
+        co_read(&file, k * unit + DEVICE_BLOCK_SIZE, DEVICE_BLOCK_SIZE, buf.get(),
+                DEFAULT_DISK_ACCOUNT);
+        EXPECT_EQ('a' + k, buf.get()[DEVICE_BLOCK_SIZE - 1]);
+    }
+    EXPECT_EQ('b', datas[1][DEVICE_BLOCK_SIZE]);
+    EXPECT_EQ('e', datas[1][unit + DEVICE_BLOCK_SIZE]);
+}
+
+// The checksum is part of the disk format, so every kernel must agree with the plain
+// C++ one.  Lengths around the vector widths and the kernels' chunk sizes are the
+// interesting ones.
+TEST(SerializerTest, ChecksumKernelsAgree) {
+    const std::vector<checksum_kernel_t> kernels = available_checksum_kernels();
+    ASSERT_FALSE(kernels.empty());
+
+    const size_t max_words = 3 * 0x10000 + 13;
+    std::vector<uint32_t> words(max_words);
+    const std::vector<size_t> lengths = {
+        0, 1, 3, 4, 5, 7, 8, 9, 17, 1023, 1024, 0xFFFF, 0x10000, 0x10001,
+        2 * 0x8000 * 8 + 7, max_words };
+
+    // Random words, and the words whose xor with 1 is zero or all ones.
+    for (int pattern = 0; pattern < 3; ++pattern) {
+        for (uint32_t &w : words) {
+            w = pattern == 0 ? static_cast<uint32_t>(randuint64(UINT32_MAX))
+                : pattern == 1 ? 1u
+                : 0xFFFFFFFEu;
+        }
+        for (size_t length : lengths) {
+            const serializer_checksum expected
+                = kernels[0].fn(words.data(), length);
+            EXPECT_EQ(expected.value,
+                      compute_checksum(words.data(), length).value);
+            for (const checksum_kernel_t &kernel : kernels) {
+                EXPECT_EQ(expected.value, kernel.fn(words.data(), length).value)
+                    << kernel.name << ", length " << length;
+            }
+        }
+    }
+}
+
+// Not really a test; prints each kernel's throughput on 4KB blocks (the default
+// btree block size) compared with the plain C++ kernel.
+TEST(SerializerTest, ChecksumKernelThroughput) {
+    const std::vector<checksum_kernel_t> kernels = available_checksum_kernels();
+    const size_t block_words = 4096 / serializer_checksum::word_size;
+    const size_t num_blocks = 1024;
+    const int rounds = 20;
+    std::vector<uint32_t> words(block_words * num_blocks);
+    for (uint32_t &w : words) {
+        w = static_cast<uint32_t>(randuint64(UINT32_MAX));
+    }
+
+    double scalar_secs = 0;
+    for (const checksum_kernel_t &kernel : kernels) {
+        uint64_t sink = 0;
+        const ticks_t start = get_ticks();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t b = 0; b < num_blocks; ++b) {
+                sink += kernel.fn(words.data() + b * block_words, block_words).value;
+            }
+        }
+        const double secs = ticks_to_secs(ticks_t{get_ticks().nanos - start.nanos});
+        if (scalar_secs == 0) {
+            scalar_secs = secs;
+        }
+        const double mb = static_cast<double>(words.size()) * sizeof(uint32_t)
+            * rounds / MEGABYTE;
+        printf("checksum kernel %-6s: %8.1f MB/s (%.2fx scalar, sink %" PRIx64 ")\n",
+               kernel.name, mb / secs, scalar_secs / secs, sink);
+    }
+}
+
 
 }  // namespace unittest
@@ -0,0 +1,67 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "containers/scoped.hpp"
+#include "slab_allocator.hpp"
+#include "unittest/gtest.hpp"
+
+namespace unittest {
+
+TEST(SlabAllocatorTest, AllocateAndFree) {
+    slab_allocator_t *slabs = slab_allocator_t::get();
+    if (slabs == nullptr) {
+        // Not available on this platform.
+        return;
+    }
+    const size_t chunks_before = slabs->chunks_in_use();
+
+    // Enough 4 KB buffers to need several chunks.
+    std::vector<void *> buffers;
+    for (size_t i = 0; i < 3 * SLAB_CHUNK_SIZE / (4 * KILOBYTE); ++i) {
+        void *buf = slabs->allocate(4 * KILOBYTE);
+        ASSERT_TRUE(buf != nullptr);
+        ASSERT_TRUE(slabs->owns(buf));
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(buf) % DEVICE_BLOCK_SIZE);
+        memset(buf, static_cast<int>(i), 4 * KILOBYTE);
+        buffers.push_back(buf);
+    }
+    EXPECT_LE(chunks_before + 3, slabs->chunks_in_use());
+
+    // No buffer overlaps another one.
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        const unsigned char *p = static_cast<const unsigned char *>(buffers[i]);
+        ASSERT_EQ(static_cast<unsigned char>(i), p[0]);
+        ASSERT_EQ(static_cast<unsigned char>(i), p[4 * KILOBYTE - 1]);
+    }
+
+    // Other sizes come from other chunks.
+    void *small = slabs->allocate(DEVICE_BLOCK_SIZE);
+    void *odd = slabs->allocate(3 * DEVICE_BLOCK_SIZE - 1);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(odd) % DEVICE_BLOCK_SIZE);
+    slabs->deallocate(small);
+    slabs->deallocate(odd);
+
+    for (void *buf : buffers) {
+        slabs->deallocate(buf);
+    }
+    // Empty chunks go back to the kernel, except one per size class.
+    EXPECT_GE(chunks_before + 3, slabs->chunks_in_use());
+
+    EXPECT_FALSE(slabs->owns(&chunks_before));
+}
+
+TEST(SlabAllocatorTest, DeviceBlockAlignedPtr) {
+    std::vector<scoped_device_block_aligned_ptr_t<char> > bufs;
+    for (size_t size : {size_t(1), size_t(4 * KILOBYTE), SLAB_MAX_BUFFER_SIZE,
+                        SLAB_MAX_BUFFER_SIZE + 1, size_t(4 * MEGABYTE)}) {
+        scoped_device_block_aligned_ptr_t<char> buf(size);
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(buf.get()) % DEVICE_BLOCK_SIZE);
+        memset(buf.get(), 1, size);
+        bufs.push_back(std::move(buf));
+    }
+}
+
+}  // namespace unittest
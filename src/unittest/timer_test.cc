@@ -1,5 +1,6 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include <algorithm>
+#include <vector>
 
 #include "arch/timing.hpp"
 #include "concurrency/pmap.hpp"
@@ -93,5 +94,31 @@ TPTEST(TimerTest, TestChangeInterval) {
     nap(70);
 }
 
+TPTEST(TimerTest, TestManyTimers) {
+    // The delays span a few levels of the timer wheel, and every other timer gets
+    // canceled before it rings.
+    const int num_timers = 200;
+    ticks_t start = get_ticks();
+    std::vector<scoped_ptr_t<signal_timer_t> > timers;
+    std::vector<int64_t> delays_ms;
+    for (int i = 0; i < num_timers; ++i) {
+        delays_ms.push_back((i * 37) % 300 + 1);
+        timers.push_back(make_scoped<signal_timer_t>(delays_ms.back()));
+    }
+    for (int i = 0; i < num_timers; i += 2) {
+        EXPECT_TRUE(timers[i]->cancel());
+    }
+    for (int i = 1; i < num_timers; i += 2) {
+        timers[i]->wait_lazily_unordered();
+        int64_t elapsed_ns = get_ticks().nanos - start.nanos;
+        EXPECT_GE(elapsed_ns, delays_ms[i] * MILLION);
+    }
+    int64_t total_ns = get_ticks().nanos - start.nanos;
+    EXPECT_LT(total_ns, (300 + max_error_ms) * MILLION);
+    for (int i = 0; i < num_timers; i += 2) {
+        EXPECT_FALSE(timers[i]->is_pulsed());
+    }
+}
+
 
 }  // namespace unittest
@@ -142,6 +142,35 @@ TEST(UTF8ValidationTest, IllegalCharacters) {
 }
 
 // Stress test per http://www.w3.org/2001/06/utf-8-wrong/UTF-8-test.html
+TEST(UTF8ValidationTest, LongStrings) {
+    // Validation skips runs of ASCII in blocks of up to 64 bytes, so put the
+    // interesting bytes at every offset across a few blocks.
+    utf8::reason_t reason;
+    for (size_t pos = 0; pos < 200; ++pos) {
+        std::string s(256, 'a');
+        s.replace(pos, 2, "\xc2\xa2");
+        ASSERT_TRUE(utf8::is_valid(s));
+
+        s.replace(pos, 2, "\xff""a");
+        ASSERT_FALSE(utf8::is_valid(s, &reason));
+        ASSERT_EQ(pos, reason.position);
+        ASSERT_STREQ("Invalid initial byte seen", reason.explanation);
+
+        s.replace(pos, 2, "\xc2""a");
+        ASSERT_FALSE(utf8::is_valid(s, &reason));
+        ASSERT_EQ(pos, reason.position);
+        ASSERT_STREQ("Expected continuation byte, saw something else",
+                     reason.explanation);
+
+        // A truncated sequence right at the end of the string.
+        std::string truncated = std::string(pos, 'a') + "\xe2\x82";
+        ASSERT_FALSE(utf8::is_valid(truncated, &reason));
+        ASSERT_EQ(pos + 1, reason.position);
+        ASSERT_STREQ("Expected continuation byte, saw end of string",
+                     reason.explanation);
+    }
+}
+
 TEST(UTF8ValidationStressTest, CorrectString) {
     ASSERT_TRUE(utf8::is_valid(u8"κόσμε"));
 }
@@ -1,8 +1,13 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include <inttypes.h>
 
+#include <string>
+#include <vector>
+
+#include "containers/archive/buffer_stream.hpp"
 #include "containers/archive/string_stream.hpp"
 #include "containers/archive/varint.hpp"
+#include "random.hpp"
 #include "unittest/gtest.hpp"
 #include "utils.hpp"
 
@@ -85,4 +90,59 @@ TEST(VarintTest, RangeError) {
     }
 }
 
+// The straightforward encoding, to check the word-at-a-time paths against.
+std::string reference_varint(uint64_t value) {
+    std::string s;
+    do {
+        uint8_t b = value & 127;
+        value >>= 7;
+        s.push_back(static_cast<char>(value != 0 ? (b | 128) : b));
+    } while (value != 0);
+    return s;
+}
+
+TEST(VarintTest, BufferMatchesReference) {
+    std::vector<uint64_t> vals;
+    for (int bits = 0; bits <= 64; ++bits) {
+        const uint64_t p = bits == 64 ? 0 : (uint64_t(1) << bits);
+        vals.push_back(p - 1);
+        vals.push_back(p);
+        vals.push_back(p + 1);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        vals.push_back(randint(1 << 30) * static_cast<uint64_t>(randint(1 << 30))
+                       >> randint(60));
+    }
+    for (uint64_t value : vals) {
+        SCOPED_TRACE("value = " + strprintf("%" PRIu64, value));
+        const std::string expected = reference_varint(value);
+
+        uint8_t buf[16];
+        size_t size = serialize_varint_uint64_into_buf(value, buf);
+        ASSERT_EQ(expected, std::string(reinterpret_cast<char *>(buf), size));
+        ASSERT_EQ(expected.size(), varint_uint64_serialized_size(value));
+
+        // Decode from a buffer that ends right after the varint, and from one with
+        // more data after it, so that both the byte-wise and the word-wise paths run.
+        for (size_t padding : { 0, 8 }) {
+            std::string data = expected + std::string(padding, '\xff');
+            buffer_read_stream_t stream(data.data(), data.size());
+            uint64_t output_value;
+            ASSERT_EQ(archive_result_t::SUCCESS,
+                      deserialize_varint_uint64(&stream, &output_value));
+            ASSERT_EQ(value, output_value);
+            ASSERT_EQ(static_cast<int64_t>(expected.size()), stream.tell());
+        }
+
+        // A truncated varint is an EOF.
+        if (expected.size() > 1) {
+            std::string data = expected.substr(0, expected.size() - 1);
+            buffer_read_stream_t stream(data.data(), data.size());
+            uint64_t output_value;
+            ASSERT_EQ(archive_result_t::SOCK_EOF,
+                      deserialize_varint_uint64(&stream, &output_value));
+        }
+    }
+}
+
 }  // namespace unittest
@@ -0,0 +1,40 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "buffer_cache/warm_up_manifest.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+TPTEST(WarmUpManifestTest, RoundTrip) {
+    temp_directory_t dir;
+    const std::string path = dir.path().path() + "/manifest";
+
+    std::vector<block_id_t> block_ids;
+    for (block_id_t i = 0; i < 1000; ++i) {
+        block_ids.push_back(i * 7 + 3);
+    }
+    block_ids.push_back(FIRST_AUX_BLOCK_ID + 5);
+    save_warm_up_manifest(path, block_ids);
+
+    ASSERT_EQ(block_ids, take_warm_up_manifest(path));
+    // Taking the manifest removes it.
+    ASSERT_TRUE(take_warm_up_manifest(path).empty());
+}
+
+TPTEST(WarmUpManifestTest, Invalid) {
+    temp_directory_t dir;
+    const std::string path = dir.path().path() + "/manifest";
+
+    FILE *f = fopen(path.c_str(), "w");
+    ASSERT_TRUE(f != nullptr);
+    fputs("not a manifest", f);
+    fclose(f);
+    ASSERT_TRUE(take_warm_up_manifest(path).empty());
+}
+
+}  // namespace unittest
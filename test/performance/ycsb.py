@@ -0,0 +1,364 @@
+#!/usr/bin/env python
+# Copyright 2010-2016 RethinkDB, all rights reserved.
+
+'''Reproducible YCSB-style workloads, for comparing builds under load.
+
+Runs the YCSB core workloads A-F, plus a changefeed fan-out and a bulk import
+scenario, against a server that this script starts (or an existing one, with
+`--host`).  Keys, operations and documents come from a seeded random generator, so two
+runs with the same options issue the same queries.
+
+For every workload it prints one JSON object with the throughput and the latency
+percentiles per operation type.  To attribute a regression, it also snapshots
+`rethinkdb._debug_stats` (the server's full perfmon tree) before and after the
+workload and includes every counter that changed.  If the server was built with
+`make CORO_PROFILING=1`, the coroutine profiler's output files are listed as well.'''
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import random
+import sys
+import threading
+import time
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, utils
+
+r = utils.import_python_driver()
+
+# Proportions of the operations in the YCSB core workloads, and the distribution that
+# picks the keys they operate on.
+workloads = {
+    'a': {'ops': {'read': 0.5, 'update': 0.5}, 'distribution': 'zipfian'},
+    'b': {'ops': {'read': 0.95, 'update': 0.05}, 'distribution': 'zipfian'},
+    'c': {'ops': {'read': 1.0}, 'distribution': 'zipfian'},
+    'd': {'ops': {'read': 0.95, 'insert': 0.05}, 'distribution': 'latest'},
+    'e': {'ops': {'scan': 0.95, 'insert': 0.05}, 'distribution': 'zipfian'},
+    'f': {'ops': {'read': 0.5, 'read_modify_write': 0.5}, 'distribution': 'zipfian'},
+}
+
+field_count = 10
+field_length = 100
+max_scan_length = 100
+
+def fnv_hash64(value):
+    '''Spreads the popular keys of the zipfian distribution over the key space.'''
+    h = 0xCBF29CE484222325
+    for _ in range(8):
+        h ^= value & 0xff
+        h = (h * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+        value >>= 8
+    return h
+
+def key_for(i):
+    return 'user%020d' % fnv_hash64(i)
+
+class ZipfianGenerator(object):
+    '''Gray et al., "Quickly Generating Billion-Record Synthetic Databases", the same
+    generator YCSB uses.'''
+
+    theta = 0.99
+
+    def __init__(self, items, rng):
+        self.rng = rng
+        self.items = items
+        self.zeta2 = self.zeta(2)
+        self.alpha = 1.0 / (1.0 - self.theta)
+        self.zetan = self.zeta(items)
+        self.eta = (1 - pow(2.0 / items, 1 - self.theta)) / (1 - self.zeta2 / self.zetan)
+
+    def zeta(self, n):
+        return sum(1.0 / pow(i + 1, self.theta) for i in range(n))
+
+    def grow(self, items):
+        # Incremental update of zeta, so that `latest` stays cheap while inserting.
+        for i in range(self.items, items):
+            self.zetan += 1.0 / pow(i + 1, self.theta)
+        self.items = items
+        self.eta = (1 - pow(2.0 / items, 1 - self.theta)) / (1 - self.zeta2 / self.zetan)
+
+    def next(self):
+        u = self.rng.random()
+        uz = u * self.zetan
+        if uz < 1.0:
+            return 0
+        if uz < 1.0 + pow(0.5, self.theta):
+            return 1
+        return int(self.items * pow(self.eta * u - self.eta + 1, self.alpha))
+
+def make_doc(rng, key):
+    doc = {'id': key}
+    for i in range(field_count):
+        doc['field%d' % i] = ''.join(rng.choice('abcdefghijklmnopqrstuvwxyz') for _ in range(field_length))
+    return doc
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return None
+    index = min(len(sorted_values) - 1, int(len(sorted_values) * p))
+    return sorted_values[index]
+
+def summarize(latencies, elapsed):
+    result = {'ops': 0, 'ops_per_sec': 0.0, 'latency_ms': {}}
+    for op, values in latencies.items():
+        values.sort()
+        result['ops'] += len(values)
+        result['latency_ms'][op] = {
+            'count': len(values),
+            'p50': percentile(values, 0.50) * 1000,
+            'p95': percentile(values, 0.95) * 1000,
+            'p99': percentile(values, 0.99) * 1000,
+            'max': values[-1] * 1000}
+    result['ops_per_sec'] = result['ops'] / elapsed if elapsed > 0 else 0.0
+    return result
+
+def numeric_leaves(value, path=()):
+    if isinstance(value, dict):
+        for k, v in value.items():
+            for leaf in numeric_leaves(v, path + (str(k),)):
+                yield leaf
+    elif isinstance(value, (int, float)) and not isinstance(value, bool):
+        yield ('.'.join(path), value)
+
+def perfmon_snapshot(conn):
+    snapshot = {}
+    for row in r.db('rethinkdb').table('_debug_stats').run(conn):
+        name = str(row.get('name', row.get('id')))
+        snapshot.update(('%s.%s' % (name, k), v) for k, v in numeric_leaves(row.get('stats', row)))
+    return snapshot
+
+def perfmon_delta(before, after):
+    return dict((k, v - before.get(k, 0)) for k, v in after.items() if v != before.get(k, 0))
+
+class Runner(object):
+    def __init__(self, options, host, port):
+        self.options = options
+        self.host = host
+        self.port = port
+        self.table = r.db(options.db).table(options.table)
+        self.inserted = options.records
+        self.lock = threading.Lock()
+
+    def connect(self):
+        return r.connect(host=self.host, port=self.port)
+
+    def setup(self, conn):
+        if self.options.db not in r.db_list().run(conn):
+            r.db_create(self.options.db).run(conn)
+        if self.options.table in r.db(self.options.db).table_list().run(conn):
+            r.db(self.options.db).table_drop(self.options.table).run(conn)
+        r.db(self.options.db).table_create(self.options.table, durability=self.options.durability).run(conn)
+        self.load(conn, self.options.records, self.options.batch_size)
+
+    def load(self, conn, count, batch_size, start=0):
+        rng = random.Random(self.options.seed)
+        batch = []
+        for i in range(start, start + count):
+            batch.append(make_doc(rng, key_for(i)))
+            if len(batch) == batch_size:
+                self.table.insert(batch).run(conn, durability=self.options.durability)
+                batch = []
+        if batch:
+            self.table.insert(batch).run(conn, durability=self.options.durability)
+
+    def next_insert_index(self):
+        with self.lock:
+            index = self.inserted
+            self.inserted += 1
+            return index
+
+    def run_client(self, spec, ops, seed, latencies):
+        rng = random.Random(seed)
+        conn = self.connect()
+        keys = ZipfianGenerator(self.options.records, rng)
+        choices = sorted(spec['ops'].items())
+        durability = self.options.durability
+        for _ in range(ops):
+            x = rng.random()
+            op = choices[-1][0]
+            for name, proportion in choices:
+                if x < proportion:
+                    op = name
+                    break
+                x -= proportion
+
+            if spec['distribution'] == 'latest':
+                inserted = self.inserted
+                keys.grow(inserted)
+                index = inserted - 1 - keys.next()
+            else:
+                index = keys.next() % self.options.records
+            key = key_for(max(0, index))
+
+            start = time.time()
+            if op == 'read':
+                self.table.get(key).run(conn)
+            elif op == 'update':
+                self.table.get(key).update({'field0': make_doc(rng, key)['field0']}).run(conn, durability=durability)
+            elif op == 'insert':
+                self.table.insert(make_doc(rng, key_for(self.next_insert_index()))).run(conn, durability=durability)
+            elif op == 'scan':
+                self.table.between(key, r.maxval).order_by(index='id').limit(rng.randint(1, max_scan_length)).run(conn)
+            elif op == 'read_modify_write':
+                doc = self.table.get(key).run(conn)
+                if doc is not None:
+                    self.table.get(key).replace(dict(doc, field0=make_doc(rng, key)['field0'])).run(conn, durability=durability)
+            latencies.setdefault(op, []).append(time.time() - start)
+        conn.close()
+
+    def run_clients(self, target, args_for_client):
+        per_client = [{} for _ in range(self.options.clients)]
+        threads = [threading.Thread(target=target, args=args_for_client(i) + (per_client[i],))
+                   for i in range(self.options.clients)]
+        start = time.time()
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        elapsed = time.time() - start
+        latencies = {}
+        for client in per_client:
+            for op, values in client.items():
+                latencies.setdefault(op, []).extend(values)
+        return latencies, elapsed
+
+    def run_workload(self, name):
+        spec = workloads[name]
+        ops = self.options.operations // self.options.clients
+        return self.run_clients(self.run_client,
+                                lambda i: (spec, ops, self.options.seed * 1000 + i))
+
+    def run_changefeeds(self, conn):
+        '''Writes `--operations` updates while `--feeds` changefeeds watch the table, and
+        measures how long it takes until a change reaches each feed.'''
+        latencies = {'change': []}
+        ready = threading.Semaphore(0)
+        lock = threading.Lock()
+        feed_conns = [self.connect() for _ in range(self.options.feeds)]
+
+        def watch(feed_conn):
+            feed = self.table.changes(squash=False).run(feed_conn)
+            ready.release()
+            try:
+                for change in feed:
+                    new_val = change.get('new_val') or {}
+                    if new_val.get('stop'):
+                        break
+                    if 'sent' in new_val:
+                        with lock:
+                            latencies['change'].append(time.time() - new_val['sent'])
+            except r.ReqlDriverError:
+                pass
+
+        threads = [threading.Thread(target=watch, args=(c,)) for c in feed_conns]
+        for t in threads:
+            t.start()
+        for _ in threads:
+            ready.acquire()
+
+        rng = random.Random(self.options.seed)
+        start = time.time()
+        for _ in range(self.options.operations):
+            key = key_for(rng.randrange(self.options.records))
+            self.table.get(key).update({'sent': r.expr(time.time())}).run(conn, durability=self.options.durability)
+        self.table.get(key_for(0)).update({'stop': True}).run(conn)
+        for t in threads:
+            t.join(timeout=60)
+        elapsed = time.time() - start
+        for c in feed_conns:
+            c.close()
+        return latencies, elapsed
+
+    def run_import(self, conn):
+        latencies = {'insert_batch': []}
+        rng = random.Random(self.options.seed)
+        start = time.time()
+        batch_count = max(1, self.options.operations // self.options.batch_size)
+        for _ in range(batch_count):
+            batch = [make_doc(rng, key_for(self.next_insert_index())) for _ in range(self.options.batch_size)]
+            batch_start = time.time()
+            self.table.insert(batch).run(conn, durability=self.options.durability)
+            latencies['insert_batch'].append(time.time() - batch_start)
+        return latencies, time.time() - start
+
+def coro_profiler_outputs(server):
+    if server is None:
+        return []
+    found = []
+    for directory in set([server.data_path, os.path.dirname(server.data_path)]):
+        if os.path.isdir(directory):
+            found.extend(os.path.join(directory, f) for f in os.listdir(directory)
+                         if f.startswith('coro_profiler_out_'))
+    return sorted(found)
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('workloads', nargs='*', default=['a', 'b', 'c', 'f', 'd', 'e', 'changefeeds', 'import'],
+                        help='any of a-f, changefeeds and import (default: all of them)')
+    parser.add_argument('--build', help='build directory with the server to start')
+    parser.add_argument('--host', help='use an existing server instead of starting one')
+    parser.add_argument('--port', type=int, default=28015)
+    parser.add_argument('--cache-size', type=int, default=1024, help='in MB, for the started server')
+    parser.add_argument('--db', default='ycsb')
+    parser.add_argument('--table', default='usertable')
+    parser.add_argument('--records', type=int, default=100000)
+    parser.add_argument('--operations', type=int, default=100000, help='per workload')
+    parser.add_argument('--clients', type=int, default=16)
+    parser.add_argument('--feeds', type=int, default=32, help='changefeeds for the changefeeds workload')
+    parser.add_argument('--batch-size', type=int, default=200, help='documents per insert when loading or importing')
+    parser.add_argument('--durability', choices=['hard', 'soft'], default='hard')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--output', help='also append the results to this file')
+    options = parser.parse_args()
+
+    for name in options.workloads:
+        if name not in workloads and name not in ('changefeeds', 'import'):
+            parser.error('unknown workload: %s' % name)
+
+    server = None
+    if options.host is None:
+        executable_path = utils.find_rethinkdb_executable() if options.build is None \
+            else os.path.realpath(os.path.join(options.build, 'rethinkdb'))
+        server = driver.Process(executable_path=executable_path,
+                                extra_options=['--cache-size', str(options.cache_size)])
+        host, port = 'localhost', server.driver_port
+    else:
+        host, port = options.host, options.port
+
+    try:
+        runner = Runner(options, host, port)
+        conn = runner.connect()
+        for name in options.workloads:
+            runner.setup(conn)
+            before = perfmon_snapshot(conn)
+            if name == 'changefeeds':
+                latencies, elapsed = runner.run_changefeeds(conn)
+            elif name == 'import':
+                latencies, elapsed = runner.run_import(conn)
+            else:
+                latencies, elapsed = runner.run_workload(name)
+            result = summarize(latencies, elapsed)
+            result['workload'] = name
+            result['seed'] = options.seed
+            result['records'] = options.records
+            result['clients'] = options.clients
+            result['durability'] = options.durability
+            result['perfmon_delta'] = perfmon_delta(before, perfmon_snapshot(conn))
+            line = json.dumps(result, sort_keys=True)
+            print(line)
+            sys.stdout.flush()
+            if options.output:
+                with open(options.output, 'a') as f:
+                    f.write(line + '\n')
+        conn.close()
+    finally:
+        if server is not None:
+            server.stop()
+            for path in coro_profiler_outputs(server):
+                print(json.dumps({'coro_profiler_output': path}))
+
+if __name__ == '__main__':
+    main()